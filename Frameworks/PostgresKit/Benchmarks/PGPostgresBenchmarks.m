@@ -0,0 +1,284 @@
+//
+//  $Id$
+//
+//  PGPostgresBenchmarks.m
+//  PostgresKit
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "PGPostgresBenchmarks.h"
+
+#import <mach/mach_time.h>
+
+// Environment variable specifying the file to append results to
+static NSString *PGBenchmarkOutputEnvironmentKey = @"PGKIT_BENCHMARK_OUTPUT";
+
+// Iteration and size defaults
+static const NSUInteger PGBenchmarkConnectIterations = 20;
+static const NSUInteger PGBenchmarkRoundTripIterations = 1000;
+static const NSUInteger PGBenchmarkPreparedIterations = 1000;
+static const NSUInteger PGBenchmarkLargeResultRows = 100000;
+
+// Connection timeout in seconds
+static const double PGBenchmarkConnectTimeout = 10.0;
+
+static double _PGBenchmarkCurrentTime(void);
+
+@interface PGPostgresBenchmarks ()
+
+- (void)_decodeResult:(PGPostgresResult *)result;
+- (void)_benchmarkDecodeOfQuery:(NSString *)query named:(NSString *)name;
+- (void)_recordBenchmark:(NSString *)name iterations:(NSUInteger)iterations rows:(unsigned long long)rows seconds:(double)seconds;
+- (PGPostgresConnection *)_newConnection;
+
+@end
+
+@implementation PGPostgresBenchmarks
+
+#pragma mark -
+#pragma mark Setup & Teardown
+
+- (void)setUp
+{
+	[super setUp];
+	
+	NSString *path = [[[NSProcessInfo processInfo] environment] objectForKey:PGBenchmarkOutputEnvironmentKey];
+	
+	_output = path ? fopen([path fileSystemRepresentation], "a") : NULL;
+}
+
+- (void)tearDown
+{
+	if (_output) fclose(_output), _output = NULL;
+	
+	[super tearDown];
+}
+
+#pragma mark -
+#pragma mark Benchmarks
+
+/**
+ * Time taken from requesting a connection until it's usable.
+ */
+- (void)testConnectLatency
+{
+	double totalTime = 0;
+	
+	for (NSUInteger i = 0; i < PGBenchmarkConnectIterations; i++)
+	{
+		PGPostgresConnection *connection = [self _newConnection];
+		
+		double start = _PGBenchmarkCurrentTime();
+		
+		STAssertTrue([connection connect], @"Request to establish connection failed.");
+		
+		while (![connection isConnected] && (_PGBenchmarkCurrentTime() - start) < PGBenchmarkConnectTimeout) usleep(100);
+		
+		totalTime += _PGBenchmarkCurrentTime() - start;
+		
+		STAssertTrue([connection isConnected], @"Connection was not established within the timeout.");
+		
+		[connection disconnect];
+		[connection release];
+	}
+	
+	[self _recordBenchmark:@"connect_latency" iterations:PGBenchmarkConnectIterations rows:0 seconds:totalTime];
+}
+
+/**
+ * Round trip time of a trivial query.
+ */
+- (void)testSmallQueryRoundTrip
+{
+	double start = _PGBenchmarkCurrentTime();
+	
+	for (NSUInteger i = 0; i < PGBenchmarkRoundTripIterations; i++)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		
+		[self _decodeResult:[[self connection] execute:@"SELECT 1"]];
+		
+		[pool release];
+	}
+	
+	[self _recordBenchmark:@"small_query_round_trip" iterations:PGBenchmarkRoundTripIterations rows:PGBenchmarkRoundTripIterations seconds:_PGBenchmarkCurrentTime() - start];
+}
+
+/**
+ * Decode throughput of large results, one benchmark per type handler.
+ */
+- (void)testLargeResultDecodeThroughput
+{
+	[self _benchmarkDecodeOfQuery:@"SELECT md5(i::text), md5(i::text)::varchar, 'text'::char(4) FROM generate_series(1, %lu) i" named:@"decode_string_handler"];
+	[self _benchmarkDecodeOfQuery:@"SELECT i, (i %% 100)::smallint, i::bigint, i::float8, i::numeric(12, 3) FROM generate_series(1, %lu) i" named:@"decode_number_handler"];
+	[self _benchmarkDecodeOfQuery:@"SELECT '2000-01-01'::date + i %% 1000, '2000-01-01'::timestamp + i * interval '1 second', now() + i * interval '1 second' FROM generate_series(1, %lu) i" named:@"decode_datetime_handler"];
+	[self _benchmarkDecodeOfQuery:@"SELECT decode(md5(i::text), 'hex') FROM generate_series(1, %lu) i" named:@"decode_binary_handler"];
+}
+
+/**
+ * Execution of a prepared statement compared to the equivalent unprepared query.
+ */
+- (void)testPreparedVersusUnpreparedExecution
+{
+	NSString *query = @"SELECT \"int_field\", \"varchar_field\" FROM \"data_types\" WHERE \"int_field\" = 12345";
+	
+	double start = _PGBenchmarkCurrentTime();
+	
+	for (NSUInteger i = 0; i < PGBenchmarkPreparedIterations; i++)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		
+		[self _decodeResult:[[self connection] execute:query]];
+		
+		[pool release];
+	}
+	
+	[self _recordBenchmark:@"execute_unprepared" iterations:PGBenchmarkPreparedIterations rows:PGBenchmarkPreparedIterations seconds:_PGBenchmarkCurrentTime() - start];
+	
+	PGPostgresStatement *statement = [[self connection] prepare:query];
+	
+	STAssertNotNil(statement, nil);
+	
+	start = _PGBenchmarkCurrentTime();
+	
+	for (NSUInteger i = 0; i < PGBenchmarkPreparedIterations; i++)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		
+		[self _decodeResult:[[self connection] executePrepared:statement]];
+		
+		[pool release];
+	}
+	
+	[self _recordBenchmark:@"execute_prepared" iterations:PGBenchmarkPreparedIterations rows:PGBenchmarkPreparedIterations seconds:_PGBenchmarkCurrentTime() - start];
+}
+
+#pragma mark -
+#pragma mark Private API
+
+/**
+ * Converts every value in the supplied result to its native object.
+ *
+ * @param result The result to decode.
+ */
+- (void)_decodeResult:(PGPostgresResult *)result
+{
+	STAssertNotNil(result, @"Query failed: %@", [[[self connection] lastError] errorPrimaryMessage]);
+	
+	while ([result rowAsArray]);
+}
+
+/**
+ * Benchmarks the execution and decoding of the supplied query, which should contain a %lu 
+ * placeholder for the number of rows to return.  As the query is used as a format, any
+ * modulo operators must be written as %%.
+ *
+ * @param query The query format to run.
+ * @param name  The name to record the benchmark under.
+ */
+- (void)_benchmarkDecodeOfQuery:(NSString *)query named:(NSString *)name
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	
+	double start = _PGBenchmarkCurrentTime();
+	
+	PGPostgresResult *result = [[self connection] executeWithFormat:query, (unsigned long)PGBenchmarkLargeResultRows];
+	
+	double executed = _PGBenchmarkCurrentTime();
+	
+	[self _decodeResult:result];
+	
+	double decoded = _PGBenchmarkCurrentTime();
+	
+	[self _recordBenchmark:[name stringByAppendingString:@"_execute"] iterations:1 rows:[result numberOfRows] seconds:executed - start];
+	[self _recordBenchmark:name iterations:1 rows:[result numberOfRows] seconds:decoded - executed];
+	
+	[pool release];
+}
+
+/**
+ * Writes a single line of JSON describing the supplied benchmark result.
+ *
+ * @param name       The name of the benchmark.
+ * @param iterations The number of iterations that were timed.
+ * @param rows       The number of rows processed across all iterations.
+ * @param seconds    The total time taken in seconds.
+ */
+- (void)_recordBenchmark:(NSString *)name iterations:(NSUInteger)iterations rows:(unsigned long long)rows seconds:(double)seconds
+{
+	NSString *line = [NSString stringWithFormat:@"{\"benchmark\": \"%@\", \"server_version\": %lu, \"client_version\": %lu, \"iterations\": %lu, \"rows\": %llu, \"total_seconds\": %.6f, \"mean_milliseconds\": %.6f, \"rows_per_second\": %.1f, \"timestamp\": %.0f}",
+					  name,
+					  (unsigned long)[[self connection] serverVersion],
+					  (unsigned long)[[self connection] clientVersion],
+					  (unsigned long)iterations,
+					  rows,
+					  seconds,
+					  iterations ? (seconds * 1000) / iterations : 0,
+					  seconds > 0 ? rows / seconds : 0,
+					  [[NSDate date] timeIntervalSince1970]];
+	
+	if (_output) {
+		fprintf(_output, "%s\n", [line UTF8String]);
+		fflush(_output);
+	}
+	else {
+		NSLog(@"%@", line);
+	}
+}
+
+/**
+ * Creates a new, unconnected connection with the same details as the one used by the test case.
+ *
+ * @return The connection, which the caller is responsible for releasing.
+ */
+- (PGPostgresConnection *)_newConnection
+{
+	PGPostgresConnection *connection = [[PGPostgresConnection alloc] init];
+	
+	[connection setHost:[[self connection] host]];
+	[connection setUser:[[self connection] user]];
+	[connection setPort:[[self connection] port]];
+	[connection setDatabase:[[self connection] database]];
+	[connection setPassword:[[self connection] password]];
+	
+	return connection;
+}
+
+#pragma mark -
+#pragma mark Utilities
+
+/**
+ * Returns a monotonic time in seconds, suitable for measuring intervals.
+ */
+static double _PGBenchmarkCurrentTime(void)
+{
+	static mach_timebase_info_data_t timebase;
+	
+	if (!timebase.denom) mach_timebase_info(&timebase);
+	
+	return (double)mach_absolute_time() * timebase.numer / timebase.denom / 1e9;
+}
+
+@end
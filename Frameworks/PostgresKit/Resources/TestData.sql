@@ -16,6 +16,9 @@ SET client_encoding = 'UNICODE';
 BEGIN;
 
 DROP TABLE IF EXISTS data_types;
+DROP DOMAIN IF EXISTS varchar_domain;
+
+CREATE DOMAIN varchar_domain AS VARCHAR(32) CHECK (VALUE <> '');
 
 CREATE TABLE data_types
 (
@@ -31,7 +34,8 @@ CREATE TABLE data_types
 	time_field        TIME NOT NULL,
 	timetz_field      TIME WITH TIME ZONE NOT NULL,
 	timestamp_field   TIMESTAMP NOT NULL,
-	timestamptz_field TIMESTAMP WITH TIME ZONE NOT NULL
+	timestamptz_field TIMESTAMP WITH TIME ZONE NOT NULL,
+	domain_field      varchar_domain NOT NULL
 );
 
 INSERT INTO data_types (
@@ -47,7 +51,8 @@ INSERT INTO data_types (
 	time_field, 
 	timetz_field, 
 	timestamp_field, 
-	timestamptz_field)
+	timestamptz_field,
+	domain_field)
 VALUES (
 	12345, 
 	2,
@@ -61,7 +66,8 @@ VALUES (
 	'02:02:02',
 	'02:02:02 +1000',
 	'08-04-1987 02:02:02',
-	'08-04-1987 02:02:02 +0000');
+	'08-04-1987 02:02:02 +0000',
+	'DOMAIN');
 
 COMMIT;
 
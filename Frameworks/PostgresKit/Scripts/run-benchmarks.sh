@@ -0,0 +1,90 @@
+#! /bin/ksh
+
+#
+#  $Id$
+#
+#  run-benchmarks.sh
+#  sequel-pro
+#
+#  Created by the Sequel Pro team on October 19, 2026.
+#  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+#
+#  Permission is hereby granted, free of charge, to any person
+#  obtaining a copy of this software and associated documentation
+#  files (the "Software"), to deal in the Software without
+#  restriction, including without limitation the rights to use,
+#  copy, modify, merge, publish, distribute, sublicense, and/or sell
+#  copies of the Software, and to permit persons to whom the
+#  Software is furnished to do so, subject to the following
+#  conditions:
+#
+#  The above copyright notice and this permission notice shall be
+#  included in all copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+#  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+#  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+#  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+#  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+#  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+#  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+#  OTHER DEALINGS IN THE SOFTWARE.
+#
+#  More info at <http://code.google.com/p/sequel-pro/>
+
+#  Runs PostgresKit's benchmarks against a throwaway server which is created in a
+#  temporary directory, started on PGKIT_BENCHMARK_PORT (default 54329) and removed
+#  once the benchmarks have finished. Results are appended as JSON lines to
+#  PGKIT_BENCHMARK_OUTPUT (default ${BUILT_PRODUCTS_DIR}/PostgresKitBenchmarks.json).
+
+if [ "${BUILT_PRODUCTS_DIR}x" == 'x' ]
+then
+	echo 'This script should only be run by Xcode. Exiting...'
+	exit 1
+fi
+
+PG_BIN_DIR="${PG_BIN_DIR:-/Library/PostgreSQL/bin}"
+PG_PORT="${PGKIT_BENCHMARK_PORT:-54329}"
+
+if [ ! -f "${PG_BIN_DIR}/initdb" ]
+then
+	echo "error: can't find Postgres binaries at path '${PG_BIN_DIR}'. No benchmarks will be run."
+	exit 1
+fi
+
+TEST_DATA_FILE="${SRCROOT}/Resources/TestData.sql"
+
+if [ ! -f "$TEST_DATA_FILE" ]
+then
+	echo "error: Test data file does not exist at path '${TEST_DATA_FILE}'. No benchmarks will be run."
+	exit 1
+fi
+
+DATA_DIR=$(mktemp -d -t pgkit_benchmarks)
+
+cleanup()
+{
+	"${PG_BIN_DIR}/pg_ctl" -D "$DATA_DIR" -m immediate stop > /dev/null 2>&1
+	rm -rf "$DATA_DIR"
+}
+
+trap cleanup EXIT
+
+echo 'Creating throwaway server...'
+
+"${PG_BIN_DIR}/initdb" -D "$DATA_DIR" -U pgkit_test -A trust -E UTF8 > /dev/null 2>&1 || { echo 'error: Failed to initialise server data directory.'; exit 1; }
+
+"${PG_BIN_DIR}/pg_ctl" -D "$DATA_DIR" -w -l "${DATA_DIR}/server.log" -o "-p ${PG_PORT} -k ${DATA_DIR} -c listen_addresses=localhost -c fsync=off" start > /dev/null 2>&1 || { echo 'error: Failed to start server.'; exit 1; }
+
+"${PG_BIN_DIR}/createdb" -h localhost -p "$PG_PORT" -U pgkit_test pgkit_test || { echo 'error: Failed to create benchmark database.'; exit 1; }
+
+"${PG_BIN_DIR}/psql" -h localhost -p "$PG_PORT" -U pgkit_test -d pgkit_test -q < "$TEST_DATA_FILE" > /dev/null 2>&1 || { echo 'error: Failed to load benchmark data.'; exit 1; }
+
+export PGKIT_TEST_PORT="$PG_PORT"
+export PGKIT_BENCHMARK_OUTPUT="${PGKIT_BENCHMARK_OUTPUT:-${BUILT_PRODUCTS_DIR}/PostgresKitBenchmarks.json}"
+
+echo "Running benchmarks, results will be written to '${PGKIT_BENCHMARK_OUTPUT}'..."
+
+"${SYSTEM_DEVELOPER_DIR}/Tools/RunUnitTests"
+
+exit $?
@@ -57,6 +57,10 @@
 	BOOL _delegateSupportsWillExecute;
 	
 	NSMutableDictionary *_typeMap;
+	NSMutableDictionary *_resolvedTypeMap;
+	
+	void **_typeHandlerTable;
+	PGPostgresOid _typeHandlerTableSize;
 	
 	PGPostgresError *_lastError;
 	PGPostgresConnectionParameters *_parameters;
@@ -107,6 +107,10 @@ static void _PGPostgresConnectionNoticeProcessor(void *arg, const char *message)
 		_delegateSupportsWillExecute = [_delegate respondsToSelector:@selector(connection:willExecute:withValues:)];
 		
 		_typeMap = [[NSMutableDictionary alloc] init];
+		_resolvedTypeMap = [[NSMutableDictionary alloc] init];
+		
+		_typeHandlerTable = NULL;
+		_typeHandlerTableSize = 0;
 		
 		[self registerTypeHandlers];
 	}
@@ -175,6 +179,9 @@ static void _PGPostgresConnectionNoticeProcessor(void *arg, const char *message)
 	
 	[self _createConnectionParameters];
 	
+	// Type OIDs outside of the built-in range are specific to the database we're connecting to
+	[self clearResolvedTypes];
+	
 	// Perform the connection
 	_connection = PQconnectStartParams(_connectionParamNames, _connectionParamValues, 0);
 	
@@ -465,7 +472,10 @@ static void _PGPostgresConnectionNoticeProcessor(void *arg, const char *message)
 
 - (void)dealloc 
 {
+	[self _clearTypeHandlerTable];
+	
 	[_typeMap release];
+	[_resolvedTypeMap release];
 	
 	[self disconnect];
 	
@@ -28,6 +28,9 @@
 
 - (id <PGPostgresTypeHandlerProtocol>)typeHandlerForClass:(Class)class;
 - (id <PGPostgresTypeHandlerProtocol>)typeHandlerForRemoteType:(PGPostgresOid)type;
+- (id <PGPostgresTypeHandlerProtocol>)typeHandlerForRemoteType:(PGPostgresOid)type resolvedType:(PGPostgresOid *)resolvedType;
+
+- (void)clearResolvedTypes;
 
 - (void)registerTypeHandler:(Class)handlerClass;
 
@@ -26,6 +26,20 @@
 #import "PGPostgresTypeBinaryHandler.h"
 #import "PGPostgresException.h"
 
+// Domains may be layered on top of other domains, but not indefinitely
+static const NSUInteger PGPostgresMaxTypeResolutionDepth = 16;
+
+// Catalog lookup used to resolve types we don't have a handler for
+static const char *PGPostgresTypeResolutionQuery = "SELECT typtype, typbasetype FROM pg_catalog.pg_type WHERE oid = $1";
+
+@interface PGPostgresConnection ()
+
+- (PGPostgresOid)_resolveRemoteType:(PGPostgresOid)type;
+- (PGPostgresOid)_baseTypeForRemoteType:(PGPostgresOid)type lookupSucceeded:(BOOL *)succeeded;
+- (void)_setTypeHandler:(id <PGPostgresTypeHandlerProtocol>)handler forRemoteType:(PGPostgresOid)type;
+
+@end
+
 @implementation PGPostgresConnection (PGPostgresConnectionTypeHandling)
 
 /**
@@ -39,6 +53,9 @@
 		_typeMap = [[NSMutableDictionary alloc] init];
 	}
 	
+	[self _clearTypeHandlerTable];
+	[self clearResolvedTypes];
+	
 	[self registerTypeHandler:[PGPostgresTypeStringHandler class]];
 	[self registerTypeHandler:[PGPostgresTypeNumberHandler class]];
 	[self registerTypeHandler:[PGPostgresTypeDateTimeHandler class]];
@@ -66,7 +83,44 @@
  */
 - (id <PGPostgresTypeHandlerProtocol>)typeHandlerForRemoteType:(PGPostgresOid)type 
 {		
-	return [_typeMap objectForKey:[NSNumber numberWithUnsignedInteger:type]];
+	return [self typeHandlerForRemoteType:type resolvedType:NULL];
+}
+
+/**
+ * Get the data type handler for the supplied PostgreSQL type, resolving types we don't directly
+ * handle (i.e. domains) through their base type in pg_type the first time they are seen.
+ *
+ * @note Handlers should be given the resolved type rather than the original one, as that is the
+ *       representation the server sends the data in.
+ *
+ * @param type         The PostgreSQL type to get the handler for.
+ * @param resolvedType Populated with the type the handler was found for (may be NULL).
+ *
+ * @return The handler or nil if there's none associated with the type.
+ */
+- (id <PGPostgresTypeHandlerProtocol>)typeHandlerForRemoteType:(PGPostgresOid)type resolvedType:(PGPostgresOid *)resolvedType
+{
+	// Fast path - a type we have a handler for
+	if (type < _typeHandlerTableSize && _typeHandlerTable[type]) {
+		if (resolvedType) *resolvedType = type;
+		
+		return _typeHandlerTable[type];
+	}
+	
+	PGPostgresOid baseType = [self _resolveRemoteType:type];
+	
+	if (resolvedType) *resolvedType = baseType;
+	
+	return (baseType && baseType < _typeHandlerTableSize) ? _typeHandlerTable[baseType] : nil;
+}
+
+/**
+ * Clears the cache of types resolved via pg_type. Should be called whenever the connection is
+ * established against a (potentially) different database.
+ */
+- (void)clearResolvedTypes
+{
+	[_resolvedTypeMap removeAllObjects];
 }
 
 /**
@@ -100,10 +154,146 @@
 	
 	for (NSUInteger i = 0; remoteTypes[i]; i++) 
 	{		
-		NSNumber *key = [NSNumber numberWithUnsignedInteger:remoteTypes[i]];
+		[self _setTypeHandler:handler forRemoteType:remoteTypes[i]];
+	}
+	
+	// A new handler may make previously unresolvable types resolvable
+	[self clearResolvedTypes];
+}
+
+#pragma mark -
+#pragma mark Private API
+
+/**
+ * Adds the supplied handler to the OID indexed dispatch table, growing it as required.
+ *
+ * @param handler The handler to add.
+ * @param type    The remote type the handler should be used for.
+ */
+- (void)_setTypeHandler:(id <PGPostgresTypeHandlerProtocol>)handler forRemoteType:(PGPostgresOid)type
+{
+	if (type >= _typeHandlerTableSize) {
+		PGPostgresOid newSize = type + 1;
+		
+		void **newTable = realloc(_typeHandlerTable, sizeof(void *) * newSize);
+		
+		if (!newTable) {
+			[PGPostgresException raise:PGPostgresConnectionErrorDomain reason:@"Memory allocation error"];
+			
+			return;
+		}
+		
+		memset(newTable + _typeHandlerTableSize, 0, sizeof(void *) * (newSize - _typeHandlerTableSize));
+		
+		_typeHandlerTable = newTable;
+		_typeHandlerTableSize = newSize;
+	}
+	
+	id existingHandler = _typeHandlerTable[type];
+	
+	_typeHandlerTable[type] = [(id)handler retain];
+	
+	if (existingHandler) [existingHandler release];
+}
+
+/**
+ * Releases all the handlers in the dispatch table and frees it.
+ */
+- (void)_clearTypeHandlerTable
+{
+	if (!_typeHandlerTable) return;
+	
+	for (PGPostgresOid i = 0; i < _typeHandlerTableSize; i++) 
+	{
+		if (_typeHandlerTable[i]) [(id)_typeHandlerTable[i] release];
+	}
+	
+	free(_typeHandlerTable);
+	
+	_typeHandlerTable = NULL;
+	_typeHandlerTableSize = 0;
+}
+
+/**
+ * Resolves the supplied type, which we don't have a handler for, to one that we do, caching the result.
+ * If a lookup fails, for example because the connection is in an aborted transaction, the type is
+ * left uncached so that it is looked up again next time.
+ *
+ * @param type The remote type to resolve.
+ *
+ * @return The resolved type or 0 if it can't be resolved to a type we support.
+ */
+- (PGPostgresOid)_resolveRemoteType:(PGPostgresOid)type
+{
+	NSNumber *key = [NSNumber numberWithUnsignedInt:type];
+	NSNumber *cachedType = [_resolvedTypeMap objectForKey:key];
+	
+	if (cachedType) return [cachedType unsignedIntValue];
+	
+	if (![self isConnected]) return 0;
+	
+	PGPostgresOid resolvedType = type;
+	BOOL lookupSucceeded = YES;
+	
+	for (NSUInteger depth = 0; resolvedType; depth++)
+	{
+		if (resolvedType < _typeHandlerTableSize && _typeHandlerTable[resolvedType]) break;
+		
+		if (depth == PGPostgresMaxTypeResolutionDepth) {
+			resolvedType = 0;
+			break;
+		}
 		
-		[_typeMap setObject:handler forKey:key];
+		resolvedType = [self _baseTypeForRemoteType:resolvedType lookupSucceeded:&lookupSucceeded];
+		
+		if (!lookupSucceeded) return 0;
 	}
+	
+	// Cache unresolvable types as well, so we only ever look them up once
+	[_resolvedTypeMap setObject:[NSNumber numberWithUnsignedInt:resolvedType] forKey:key];
+	
+	return resolvedType;
+}
+
+/**
+ * Looks up the base type of the supplied type in pg_type.
+ *
+ * @note Array types are deliberately not resolved to their element type. Results are requested in
+ *       binary format, and none of our handlers understand the binary array representation.
+ *
+ * @param type      The remote type to look up.
+ * @param succeeded On return, whether the lookup query returned a result.
+ *
+ * @return The base type or 0 if the type isn't a domain or can't be found.
+ */
+- (PGPostgresOid)_baseTypeForRemoteType:(PGPostgresOid)type lookupSucceeded:(BOOL *)succeeded
+{
+	char typeString[16];
+	
+	snprintf(typeString, sizeof(typeString), "%u", type);
+	
+	const char *values[1] = { typeString };
+	
+	PGresult *result = PQexecParams(_connection, PGPostgresTypeResolutionQuery, 1, NULL, values, NULL, NULL, 0);
+	
+	*succeeded = (result && PQresultStatus(result) == PGRES_TUPLES_OK);
+	
+	if (!result) return 0;
+	
+	PGPostgresOid baseType = 0;
+	
+	if (*succeeded && PQntuples(result) == 1) {
+		
+		char typeType = *PQgetvalue(result, 0, 0);
+		
+		if (typeType == 'd') {
+			baseType = (PGPostgresOid)strtoul(PQgetvalue(result, 0, 1), NULL, 10);
+		}
+	}
+	
+	PQclear(result);
+	
+	return baseType;
 }
 
 @end
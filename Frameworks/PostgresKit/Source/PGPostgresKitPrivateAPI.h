@@ -35,6 +35,12 @@
 
 @end
 
+@interface PGPostgresConnection (PGPostgresConnectionTypeHandlingPrivateAPI)
+
+- (void)_clearTypeHandlerTable;
+
+@end
+
 @interface PGPostgresTimeInterval ()
 
 + (id)intervalWithPGInterval:(PGinterval *)interval;
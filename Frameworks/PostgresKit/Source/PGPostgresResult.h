@@ -35,6 +35,8 @@ PGPostgresResultRowType;
 	void *_result;
 	void **_typeHandlers;
 	
+	PGPostgresOid *_types;
+	
 	unsigned long long _row;
 	unsigned long long _numberOfRows;
 	
@@ -29,7 +29,7 @@
 
 - (void)_populateFields;
 - (id)_objectForRow:(NSUInteger)row column:(NSUInteger)column; 
-- (id <PGPostgresTypeHandlerProtocol>)_typeHandlerForColumn:(NSUInteger)column withType:(PGPostgresOid)type;
+- (id <PGPostgresTypeHandlerProtocol>)_typeHandlerForColumn:(NSUInteger)column resolvedType:(PGPostgresOid *)resolvedType;
 
 @end
 
@@ -77,6 +77,7 @@
 		_defaultRowType = PGPostgresResultRowAsDictionary;
 		
 		_typeHandlers = (void **)calloc(sizeof(void *), _numberOfFields);
+		_types = (PGPostgresOid *)calloc(sizeof(PGPostgresOid), _numberOfFields);
 		
 		unsigned long long affectedRows = (unsigned long long)[[NSString stringWithUTF8String:PQcmdTuples(_result)] longLongValue];
 		
@@ -239,13 +240,13 @@
 	// Check for null
 	if (PQgetisnull(_result, (int)row, (int)column)) return [NSNull null];
 	
-	PGPostgresOid type = PQftype(_result, (int)column);
+	PGPostgresOid type = 0;
 	
-	// Get handler for this type
-	id <PGPostgresTypeHandlerProtocol> handler = [self _typeHandlerForColumn:column withType:type];
+	// Get handler for this column's type
+	id <PGPostgresTypeHandlerProtocol> handler = [self _typeHandlerForColumn:column resolvedType:&type];
 	
 	if (!handler) {
-		NSLog(@"PostgresKit: Warning: No type handler found for type %d, returning NSData.", type);
+		NSLog(@"PostgresKit: Warning: No type handler found for type %d, returning NSData.", PQftype(_result, (int)column));
 		
 		const void *bytes = PQgetvalue(_result, (int)row, (int)column);
 		NSUInteger length = PQgetlength(_result, (int)row, (int)column);
@@ -270,22 +271,25 @@
 /**
  * Get the data type handler for the supplied column index.
  *
- * @param column The column index to get the handler for.
+ * @param column       The column index to get the handler for.
+ * @param resolvedType Populated with the type the handler should be asked to convert.
  *
  * @return The type handler or nil if out of this result's range.
  */
-- (id <PGPostgresTypeHandlerProtocol>)_typeHandlerForColumn:(NSUInteger)column withType:(PGPostgresOid)type
+- (id <PGPostgresTypeHandlerProtocol>)_typeHandlerForColumn:(NSUInteger)column resolvedType:(PGPostgresOid *)resolvedType
 {
 	if (column >= _numberOfFields) return nil;
 	
 	id handler = _typeHandlers[column];
 		
 	if (!handler) {		
-		handler = [_connection typeHandlerForRemoteType:type];
+		handler = [_connection typeHandlerForRemoteType:PQftype(_result, (int)column) resolvedType:&_types[column]];
 		
 		_typeHandlers[column] = handler;
 	}
 	
+	*resolvedType = _types[column];
+	
 	return handler;
 }
 
@@ -322,6 +326,7 @@
 	
 	free(_fields);
 	free(_typeHandlers);
+	free(_types);
 	
 	if (_connection) [_connection release], _connection = nil;
 	
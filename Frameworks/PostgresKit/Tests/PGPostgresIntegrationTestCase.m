@@ -37,6 +37,9 @@ static NSString *PGTestDatabasePassword = @"pgkit";
 
 static NSUInteger PGTestDatabasePort = 5432;
 
+// Allows the tests and benchmarks to be run against a throwaway server
+static NSString *PGTestDatabasePortEnvironmentKey = @"PGKIT_TEST_PORT";
+
 @interface PGPostgresIntegrationTestCase ()
 
 - (void)_establishConnection;
@@ -62,9 +65,11 @@ static NSUInteger PGTestDatabasePort = 5432;
 
 - (void)_establishConnection
 {		
+	NSString *port = [[[NSProcessInfo processInfo] environment] objectForKey:PGTestDatabasePortEnvironmentKey];
+	
 	[_connection setHost:PGTestDatabaseHost];
 	[_connection setUser:PGTestDatabaseUser];
-	[_connection setPort:PGTestDatabasePort];
+	[_connection setPort:port ? (NSUInteger)[port integerValue] : PGTestDatabasePort];
 	[_connection setDatabase:PGTestDatabaseName];
 	[_connection setPassword:PGTestDatabasePassword];
 	
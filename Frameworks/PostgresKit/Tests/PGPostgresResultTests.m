@@ -53,6 +53,7 @@
 		"\"bool_field\" = 1;"
 		"\"char_field\" = CHAR;"
 		"\"date_field\" = \"1987-04-08 00:00:00 +0100\";"
+		"\"domain_field\" = DOMAIN;"
 		"\"float_field\" = \"12345.68\";"
 		"\"int_field\" = 12345;"
 		"\"numeric_field\" = \"12345.678\";"
@@ -70,6 +71,7 @@
 		"\"bool_field\" = 1;"
 		"\"char_field\" = CHAR;"
 		"\"date_field\" = \"1987-04-08 00:00:00 +0100\";"
+		"\"domain_field\" = DOMAIN;"
 		"\"float_field\" = \"12345.68\";"
 		"\"int_field\" = 12345;"
 		"\"numeric_field\" = \"12345.678\";"
@@ -32,6 +32,8 @@
 #import "QKQueryDatabases.h"
 #import "QKQueryOperators.h"
 
+#import "QKQueryTemplate.h"
+
 @class QKQueryOrderBy;
 @class QKQueryParameter;
 @class QKQueryUpdateParameter;
@@ -56,11 +58,19 @@
 	NSMutableArray *_updateParameters;
 	NSMutableArray *_groupByFields;
 	NSMutableArray *_orderByFields;
+	NSMutableArray *_insertRows;
+	NSMutableArray *_duplicateKeyUpdateFields;
+	
+	NSArray *_conflictFields;
 	
 	QKQueryType _queryType;
 	QKQueryDatabase _queryDatabase;
 	
 	BOOL _useQuotedIdentifiers;
+	
+	QKQueryTemplate *_template;
+	NSArray *_templateArities;
+	BOOL _templateNeedsCompiling;
 }
 
 /**
@@ -113,6 +123,21 @@
  */
 @property(readonly) NSMutableArray *orderByFields;
 
+/**
+ * @property insertRows The rows (arrays of values, one per field) of an INSERT query.
+ */
+@property(readonly) NSMutableArray *insertRows;
+
+/**
+ * @property duplicateKeyUpdateFields The fields of an INSERT query to update when a row already exists.
+ */
+@property(readonly) NSMutableArray *duplicateKeyUpdateFields;
+
+/**
+ * @property conflictFields The unique key fields identifying an existing row (PostgreSQL only).
+ */
+@property(readwrite, copy) NSArray *conflictFields;
+
 /**
  * @property identifierQuote The character to use when quoting identifiers.
  */
@@ -130,6 +155,10 @@
 - (NSString *)query;
 - (void)clear;
 
+- (QKQueryTemplate *)compiledTemplate;
+- (NSArray *)templateValues;
+- (NSString *)queryUsingTemplateWithEscaper:(id <QKQueryValueEscaping>)escaper;
+
 - (void)addField:(NSString *)field;
 - (void)addFields:(NSArray *)fields;
 
@@ -145,4 +174,12 @@
 - (void)orderBy:(QKQueryOrderBy *)orderBy;
 - (void)orderByField:(NSString *)field descending:(BOOL)descending;
 
+- (void)addInsertRow:(NSArray *)values;
+- (void)addInsertRows:(NSArray *)rows;
+
+- (void)updateFieldOnDuplicateKey:(NSString *)field;
+- (void)updateFieldsOnDuplicateKey:(NSArray *)fields;
+
+- (NSArray *)insertQueriesWithMaximumLength:(NSUInteger)length escaper:(id <QKQueryValueEscaping>)escaper;
+
 @end
@@ -39,6 +39,9 @@
 
 static NSString *QKNoQueryTypeException = @"QKNoQueryType";
 static NSString *QKNoQueryTableException = @"QKNoQueryTable";
+static NSString *QKNotInsertQueryException = @"QKNotInsertQuery";
+static NSString *QKInsertRowLengthException = @"QKInsertRowLength";
+static NSString *QKNoConflictFieldsException = @"QKNoConflictFields";
 
 @interface QKQuery ()
 
@@ -46,12 +49,22 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 - (void)_configureQuoteIdentifiers;
 
 - (NSString *)_buildQuery;
+- (NSString *)_buildStatementPrefix;
 - (NSString *)_buildFieldList;
 - (NSString *)_buildConstraints;
 - (NSString *)_buildGroupByClause;
 - (NSString *)_buildOrderByClause;
 - (NSString *)_buildUpdateClause;
 - (NSString *)_buildSelectOptions;
+- (NSString *)_buildInsertFieldList;
+- (NSString *)_buildInsertRow:(NSArray *)row escaper:(id <QKQueryValueEscaping>)escaper;
+- (NSString *)_buildDuplicateKeyClause;
+- (NSString *)_literalForValue:(id)value escaper:(id <QKQueryValueEscaping>)escaper;
+- (NSString *)_inlineValue:(id)value;
+
+- (void)_compileTemplate;
+- (NSArray *)_templateArities;
+- (NSUInteger)_placeholderCountForParameter:(QKQueryParameter *)parameter;
 
 - (BOOL)_addString:(NSString *)string toArray:(NSMutableArray *)array;
 
@@ -59,16 +72,10 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 
 @implementation QKQuery
 
-@synthesize database = _database;
-@synthesize table = _table; 
 @synthesize identifierQuote = _identifierQuote;
-@synthesize parameters = _parameters;
-@synthesize queryType = _queryType;
-@synthesize queryDatabase = _queryDatabase;
-@synthesize fields = _fields;
-@synthesize updateParameters = _updateParameters;
-@synthesize useQuotedIdentifiers = _useQuotedIdentifiers;
 @synthesize groupByFields = _groupByFields;
+@synthesize insertRows = _insertRows;
+@synthesize duplicateKeyUpdateFields = _duplicateKeyUpdateFields;
 @synthesize orderByFields = _orderByFields;
 
 #pragma mark -
@@ -126,13 +133,132 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 		
 		_groupByFields = [[NSMutableArray alloc] init];
 		_orderByFields = [[NSMutableArray alloc] init];
+		_insertRows = [[NSMutableArray alloc] init];
+		_duplicateKeyUpdateFields = [[NSMutableArray alloc] init];
+		
+		_conflictFields = nil;
 		
 		_query = [[NSMutableString alloc] init];
+		
+		_template = nil;
+		_templateArities = nil;
+		_templateNeedsCompiling = YES;
 	}
 	
 	return self;
 }
 
+#pragma mark -
+#pragma mark Accessors
+
+// Any change to the structure of the query requires its template to be recompiled, so these are 
+// implemented manually rather than synthesized.
+
+- (NSString *)database
+{
+	return _database;
+}
+
+- (void)setDatabase:(NSString *)database
+{
+	if (_database != database) [_database release], _database = [database retain];
+	
+	_templateNeedsCompiling = YES;
+}
+
+- (NSString *)table
+{
+	return _table;
+}
+
+- (void)setTable:(NSString *)table
+{
+	if (_table != table) [_table release], _table = [table retain];
+	
+	_templateNeedsCompiling = YES;
+}
+
+- (NSMutableArray *)parameters
+{
+	return _parameters;
+}
+
+- (void)setParameters:(NSMutableArray *)parameters
+{
+	if (_parameters != parameters) [_parameters release], _parameters = [parameters retain];
+	
+	_templateNeedsCompiling = YES;
+}
+
+- (NSMutableArray *)fields
+{
+	return _fields;
+}
+
+- (void)setFields:(NSMutableArray *)fields
+{
+	if (_fields != fields) [_fields release], _fields = [fields retain];
+	
+	_templateNeedsCompiling = YES;
+}
+
+- (NSMutableArray *)updateParameters
+{
+	return _updateParameters;
+}
+
+- (void)setUpdateParameters:(NSMutableArray *)updateParameters
+{
+	if (_updateParameters != updateParameters) [_updateParameters release], _updateParameters = [updateParameters retain];
+	
+	_templateNeedsCompiling = YES;
+}
+
+- (QKQueryType)queryType
+{
+	return _queryType;
+}
+
+- (void)setQueryType:(QKQueryType)queryType
+{
+	_queryType = queryType;
+	_templateNeedsCompiling = YES;
+}
+
+- (QKQueryDatabase)queryDatabase
+{
+	return _queryDatabase;
+}
+
+- (void)setQueryDatabase:(QKQueryDatabase)queryDatabase
+{
+	_queryDatabase = queryDatabase;
+	_templateNeedsCompiling = YES;
+}
+
+- (BOOL)useQuotedIdentifiers
+{
+	return _useQuotedIdentifiers;
+}
+
+- (void)setUseQuotedIdentifiers:(BOOL)useQuotedIdentifiers
+{
+	_useQuotedIdentifiers = useQuotedIdentifiers;
+	_templateNeedsCompiling = YES;
+}
+
+- (NSArray *)conflictFields
+{
+	return _conflictFields;
+}
+
+- (void)setConflictFields:(NSArray *)conflictFields
+{
+	if (_conflictFields != conflictFields) [_conflictFields release], _conflictFields = [conflictFields copy];
+	
+	_templateNeedsCompiling = YES;
+}
+
 #pragma mark -
 #pragma mark Public API
 
@@ -162,10 +288,97 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 	[_updateParameters removeAllObjects];
 	[_groupByFields removeAllObjects];
 	[_orderByFields removeAllObjects];
+	[_insertRows removeAllObjects];
+	[_duplicateKeyUpdateFields removeAllObjects];
+	
+	[self setConflictFields:nil];
 	
 	_identifierQuote = EMPTY_STRING;
 	
 	if (_query) [_query release], _query = [[NSMutableString alloc] init];
+	
+	_templateNeedsCompiling = YES;
+}
+
+#pragma mark -
+#pragma mark Templates
+
+/**
+ * Returns the query compiled to a template, with a positional placeholder in place of each value. 
+ * The template is cached and only recompiled when the structure of the query changes, so a query 
+ * whose parameter and update values change between executions can reuse it. Note that changes 
+ * made directly to the arrays returned by -fields, -parameters and -updateParameters aren't 
+ * tracked; use the add methods instead.
+ *
+ * @return The compiled template.
+ */
+- (QKQueryTemplate *)compiledTemplate
+{
+	// The number of placeholders an IN constraint requires depends on its value
+	if (!_templateNeedsCompiling && ![_templateArities isEqualToArray:[self _templateArities]]) {
+		_templateNeedsCompiling = YES;
+	}
+	
+	if (_templateNeedsCompiling || !_template) {
+		[self _compileTemplate];
+	}
+	
+	return _template;
+}
+
+/**
+ * Returns the values to bind to the query's compiled template, in placeholder order. Insert 
+ * and update values come first, followed by constraint values, with the rows of an INSERT and 
+ * the elements of any IN constraint flattened.
+ *
+ * @return The values as an array.
+ */
+- (NSArray *)templateValues
+{
+	NSMutableArray *values = [NSMutableArray array];
+	
+	if (_queryType == QKUpdateQuery) {
+		for (QKQueryUpdateParameter *param in _updateParameters)
+		{
+			[values addObject:[param value]];
+		}
+	}
+	
+	if (_queryType == QKInsertQuery) {
+		for (NSArray *row in _insertRows)
+		{
+			[values addObjectsFromArray:row];
+		}
+	}
+	
+	for (QKQueryParameter *param in _parameters)
+	{
+		NSUInteger count = [self _placeholderCountForParameter:param];
+		
+		if (count == 0) continue;
+		
+		if ([[param value] isKindOfClass:[NSArray class]]) {
+			[values addObjectsFromArray:[param value]];
+		}
+		else {
+			[values addObject:[param value]];
+		}
+	}
+	
+	return values;
+}
+
+/**
+ * Builds the query from its compiled template and current values, for use with connections that 
+ * don't support prepared statements.
+ *
+ * @param escaper The object to use to escape string and data values.
+ *
+ * @return The generated query.
+ */
+- (NSString *)queryUsingTemplateWithEscaper:(id <QKQueryValueEscaping>)escaper
+{
+	return [[self compiledTemplate] queryWithValues:[self templateValues] escaper:escaper];
 }
 
 #pragma mark -
@@ -178,7 +391,7 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
  */
 - (void)addField:(NSString *)field
 {
-	[self _addString:field toArray:_fields];
+	if ([self _addString:field toArray:_fields]) _templateNeedsCompiling = YES;
 }
 
 /**
@@ -206,6 +419,8 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 {
 	if ([parameter field] && ([[parameter field] length] > 0) && ((NSInteger)[parameter operator] > -1) && [parameter value]) {		
 		[_parameters addObject:parameter];
+		
+		_templateNeedsCompiling = YES;
 	} 
 }
 
@@ -232,6 +447,8 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 {
 	if ([parameter field] && ([[parameter field] length] > 0) && [parameter value]) {		
 		[_updateParameters addObject:parameter];
+		
+		_templateNeedsCompiling = YES;
 	}
 }
 
@@ -256,7 +473,7 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
  */
 - (void)groupByField:(NSString *)field
 {
-	[self _addString:field toArray:_groupByFields];
+	if ([self _addString:field toArray:_groupByFields]) _templateNeedsCompiling = YES;
 }
 
 /**
@@ -284,6 +501,8 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 {
 	if ([orderBy orderByField] && [[orderBy orderByField] length] > 0) {
 		[_orderByFields addObject:orderBy];
+		
+		_templateNeedsCompiling = YES;
 	}
 }
 
@@ -298,6 +517,136 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 	[self orderBy:[QKQueryOrderBy orderByField:field descending:descending]];
 }
 
+#pragma mark -
+#pragma mark Insert Rows
+
+/**
+ * Adds a row of values to be inserted by an INSERT query. The row must contain one value per 
+ * field (or, if no fields have been added, as many values as every other row).
+ *
+ * @param values The array of values to insert, using NSNull for NULL.
+ */
+- (void)addInsertRow:(NSArray *)values
+{
+	if (!values || [values count] == 0) return;
+	
+	NSUInteger expected = [_fields count] > 0 ? [_fields count] : [_insertRows count] > 0 ? [[_insertRows objectAtIndex:0] count] : [values count];
+	
+	if ([values count] != expected) {
+		[NSException raise:QKInsertRowLengthException format:@"Attempt to add an insert row with %lu values where %lu are required.", (unsigned long)[values count], (unsigned long)expected];
+	}
+	
+	[_insertRows addObject:values];
+	
+	_templateNeedsCompiling = YES;
+}
+
+/**
+ * Convenience method for adding more than one row.
+ *
+ * @param rows The array (of arrays of values) of rows to add.
+ */
+- (void)addInsertRows:(NSArray *)rows
+{
+	for (NSArray *row in rows)
+	{
+		[self addInsertRow:row];
+	}
+}
+
+/**
+ * Adds the supplied field to those updated with the new row's value when an INSERT query 
+ * encounters an existing row with the same unique key (an upsert). For PostgreSQL the key must 
+ * also be identified using -setConflictFields:.
+ *
+ * @param field The field to update.
+ */
+- (void)updateFieldOnDuplicateKey:(NSString *)field
+{
+	if ([self _addString:field toArray:_duplicateKeyUpdateFields]) _templateNeedsCompiling = YES;
+}
+
+/**
+ * Convenience method for adding more than one field to update on a duplicate key.
+ *
+ * @param fields The array (of strings) of fields to update.
+ */
+- (void)updateFieldsOnDuplicateKey:(NSArray *)fields
+{
+	for (NSString *field in fields)
+	{
+		[self updateFieldOnDuplicateKey:field];
+	}
+}
+
+/**
+ * Builds the multi-row INSERT statements required to insert all of the query's rows, starting 
+ * a new statement whenever adding the next row would take the current one over the supplied 
+ * length. A row that on its own exceeds the length is returned in a statement by itself.
+ *
+ * @param length  The maximum length of each statement in UTF-8 bytes, or 0 for no limit.
+ * @param escaper The object to use to escape string and data values, which is required as the
+ *                statements are intended to be run.
+ *
+ * @return An array of INSERT statements, which is empty if there are no rows.
+ */
+- (NSArray *)insertQueriesWithMaximumLength:(NSUInteger)length escaper:(id <QKQueryValueEscaping>)escaper
+{
+	[self _validateRequiements];
+	
+	if (_queryType != QKInsertQuery) {
+		[NSException raise:QKNotInsertQueryException format:@"Attempt to build insert statements for a query that isn't an INSERT."];
+	}
+	
+	if (!escaper) {
+		[NSException raise:QKTemplateNoEscaperException format:@"Attempt to build insert statements with no escaper."];
+	}
+	
+	if (_useQuotedIdentifiers) {
+		[self _configureQuoteIdentifiers];
+	}
+	
+	NSMutableArray *queries = [NSMutableArray array];
+	
+	if ([_insertRows count] == 0) return queries;
+	
+	NSString *prefix = [NSString stringWithFormat:@"%@%@ VALUES ", [self _buildStatementPrefix], [self _buildInsertFieldList]];
+	NSString *suffix = [self _buildDuplicateKeyClause];
+	
+	NSUInteger fixedLength = [prefix lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + [suffix lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	NSUInteger rowsLength = 0;
+	
+	NSMutableString *rows = [NSMutableString string];
+	
+	for (NSArray *row in _insertRows)
+	{
+		NSString *values = [self _buildInsertRow:row escaper:escaper];
+		NSUInteger valuesLength = [values lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+		
+		if (rowsLength > 0 && length > 0 && (fixedLength + rowsLength + 2 + valuesLength) > length) {
+			[queries addObject:[NSString stringWithFormat:@"%@%@%@", prefix, rows, suffix]];
+			
+			[rows setString:EMPTY_STRING];
+			
+			rowsLength = 0;
+		}
+		
+		if (rowsLength > 0) {
+			[rows appendString:@", "];
+			
+			rowsLength += 2;
+		}
+		
+		[rows appendString:values];
+		
+		rowsLength += valuesLength;
+	}
+	
+	[queries addObject:[NSString stringWithFormat:@"%@%@%@", prefix, rows, suffix]];
+	
+	return queries;
+}
+
 #pragma mark -
 #pragma mark Private API
 
@@ -351,34 +700,13 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 	[self _validateRequiements];
 	
 	BOOL isSelect = _queryType == QKSelectQuery;
-	BOOL isInsert = _queryType == QKInsertQuery;
 	BOOL isUpdate = _queryType == QKUpdateQuery;
-	BOOL isDelete = _queryType == QKDeleteQuery;
 	
 	if (_useQuotedIdentifiers) {
 		[self _configureQuoteIdentifiers];
 	}
 	
-	NSString *fields = [self _buildFieldList];
-	
-	if (isSelect) {
-		[_query appendFormat:@"SELECT %@ FROM ", fields];
-	}
-	else if (isInsert) {
-		[_query appendString:@"INSERT INTO "];
-	}
-	else if (isUpdate) {
-		[_query appendString:@"UPDATE "];
-	}
-	else if (isDelete) {
-		[_query appendString:@"DELETE FROM "];
-	}
-	
-	if (_database && [_database length] > 0) {
-		[_query appendFormat:@"%1$@%2$@%1$@.", _identifierQuote, _database];
-	}
-	
-	[_query appendFormat:@"%1$@%2$@%1$@", _identifierQuote, _table];
+	[_query setString:[self _buildStatementPrefix]];
 	
 	if (isUpdate) {
 		[_query appendFormat:@" %@", [self _buildUpdateClause]];
@@ -392,9 +720,53 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 		[_query appendString:[self _buildSelectOptions]];
 	}
 	
+	if (_queryType == QKInsertQuery && [_insertRows count] > 0) {
+		[_query appendFormat:@"%@ VALUES ", [self _buildInsertFieldList]];
+		
+		for (NSUInteger i = 0; i < [_insertRows count]; i++)
+		{
+			if (i > 0) [_query appendString:@", "];
+			
+			[_query appendString:[self _buildInsertRow:[_insertRows objectAtIndex:i] escaper:nil]];
+		}
+		
+		[_query appendString:[self _buildDuplicateKeyClause]];
+	}
+	
 	return _query;
 }
 
+/**
+ * Builds the start of the query, up to and including the table name.
+ *
+ * @return The statement prefix as SQL.
+ */
+- (NSString *)_buildStatementPrefix
+{
+	NSMutableString *prefix = [NSMutableString string];
+	
+	if (_queryType == QKSelectQuery) {
+		[prefix appendFormat:@"SELECT %@ FROM ", [self _buildFieldList]];
+	}
+	else if (_queryType == QKInsertQuery) {
+		[prefix appendString:@"INSERT INTO "];
+	}
+	else if (_queryType == QKUpdateQuery) {
+		[prefix appendString:@"UPDATE "];
+	}
+	else if (_queryType == QKDeleteQuery) {
+		[prefix appendString:@"DELETE FROM "];
+	}
+	
+	if (_database && [_database length] > 0) {
+		[prefix appendFormat:@"%1$@%2$@%1$@.", _identifierQuote, _database];
+	}
+	
+	[prefix appendFormat:@"%1$@%2$@%1$@", _identifierQuote, _table];
+	
+	return prefix;
+}
+
 /**
  * Builds the string representation of the query's field list.
  *
@@ -548,6 +920,250 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 	return string;
 }
 
+/**
+ * Builds the parenthesised field list of an INSERT query.
+ *
+ * @return The field list as SQL, or an empty string if no fields have been added.
+ */
+- (NSString *)_buildInsertFieldList
+{
+	return [_fields count] > 0 ? [NSString stringWithFormat:@" (%@)", [self _buildFieldList]] : EMPTY_STRING;
+}
+
+/**
+ * Builds the parenthesised list of values for a single row of an INSERT query.
+ *
+ * @param row     The row's values.
+ * @param escaper The object to use to escape string and data values, or nil to inline them unescaped 
+ *                in the same way as parameter values, as when describing the query.
+ *
+ * @return The row as SQL.
+ */
+- (NSString *)_buildInsertRow:(NSArray *)row escaper:(id <QKQueryValueEscaping>)escaper
+{
+	NSMutableString *values = [NSMutableString stringWithString:@"("];
+	
+	for (NSUInteger i = 0; i < [row count]; i++)
+	{
+		if (i > 0) [values appendString:@", "];
+		
+		id value = [row objectAtIndex:i];
+		
+		[values appendString:escaper ? [self _literalForValue:value escaper:escaper] : [self _inlineValue:value]];
+	}
+	
+	[values appendString:@")"];
+	
+	return values;
+}
+
+/**
+ * Builds the clause of an INSERT query that updates existing rows, either MySQL's 
+ * ON DUPLICATE KEY UPDATE or PostgreSQL's ON CONFLICT.
+ *
+ * @return The clause as SQL, or an empty string if there are no fields to update.
+ */
+- (NSString *)_buildDuplicateKeyClause
+{
+	NSMutableString *clause = [NSMutableString string];
+	
+	if ([_duplicateKeyUpdateFields count] == 0) return clause;
+	
+	BOOL isPostgreSQL = _queryDatabase == QKDatabasePostgreSQL;
+	
+	if (isPostgreSQL) {
+		if ([_conflictFields count] == 0) {
+			[NSException raise:QKNoConflictFieldsException format:@"Attempt to build a PostgreSQL upsert with no conflict fields specified."];
+		}
+		
+		[clause appendString:@" ON CONFLICT ("];
+		
+		for (NSUInteger i = 0; i < [_conflictFields count]; i++)
+		{
+			[clause appendFormat:(i > 0) ? @", %1$@%2$@%1$@" : @"%1$@%2$@%1$@", _identifierQuote, [_conflictFields objectAtIndex:i]];
+		}
+		
+		[clause appendString:@") DO UPDATE SET "];
+	}
+	else {
+		[clause appendString:@" ON DUPLICATE KEY UPDATE "];
+	}
+	
+	for (NSString *field in _duplicateKeyUpdateFields)
+	{
+		[clause appendFormat:isPostgreSQL ? @"%1$@%2$@%1$@ = EXCLUDED.%1$@%2$@%1$@, " : @"%1$@%2$@%1$@ = VALUES(%1$@%2$@%1$@), ", _identifierQuote, field];
+	}
+	
+	[clause deleteCharactersInRange:NSMakeRange([clause length] - 2, 2)];
+	
+	return clause;
+}
+
+/**
+ * Returns the SQL literal representation of the supplied value, raising an exception if a value 
+ * which needs escaping is supplied without an escaper.
+ *
+ * @param value   The value.
+ * @param escaper The object to use to escape string and data values.
+ *
+ * @return The literal as a string.
+ */
+- (NSString *)_literalForValue:(id)value escaper:(id <QKQueryValueEscaping>)escaper
+{
+	return [QKQueryTemplate literalForValue:value escaper:escaper];
+}
+
+/**
+ * Returns the supplied value inlined unescaped, in the same way as parameter values are when 
+ * describing the query.
+ *
+ * @param value The value.
+ *
+ * @return The value as a string.
+ */
+- (NSString *)_inlineValue:(id)value
+{
+	if (!value || [value isKindOfClass:[NSNull class]]) return @"NULL";
+	
+	return [NSString stringWithFormat:![value isKindOfClass:[NSNumber class]] ? @"'%@'" : @"%@", [value description]];
+}
+
+/**
+ * Compiles the query to a template, using a placeholder in place of each update and constraint value.
+ */
+- (void)_compileTemplate
+{
+	[self _validateRequiements];
+	
+	if (_useQuotedIdentifiers) {
+		[self _configureQuoteIdentifiers];
+	}
+	
+	NSMutableArray *segments = [NSMutableArray array];
+	NSMutableString *segment = [NSMutableString stringWithString:[self _buildStatementPrefix]];
+	
+	if (_queryType == QKUpdateQuery && [_updateParameters count] > 0) {
+		[segment appendString:@" SET "];
+		
+		for (QKQueryUpdateParameter *param in _updateParameters)
+		{
+			if ([segments count] > 0) [segment appendString:@", "];
+			
+			[segment appendFormat:@"%@ = ", [param quotedField]];
+			
+			[segments addObject:[NSString stringWithString:segment]];
+			[segment setString:EMPTY_STRING];
+		}
+	}
+	
+	if (_queryType == QKInsertQuery && [_insertRows count] > 0) {
+		[segment appendFormat:@"%@ VALUES ", [self _buildInsertFieldList]];
+		
+		for (NSUInteger i = 0; i < [_insertRows count]; i++)
+		{
+			[segment appendString:(i > 0) ? @", (" : @"("];
+			
+			for (NSUInteger j = 0; j < [[_insertRows objectAtIndex:i] count]; j++)
+			{
+				if (j > 0) [segment appendString:@", "];
+				
+				[segments addObject:[NSString stringWithString:segment]];
+				[segment setString:EMPTY_STRING];
+			}
+			
+			[segment appendString:@")"];
+		}
+		
+		[segment appendString:[self _buildDuplicateKeyClause]];
+	}
+	
+	if ([_parameters count] > 0) {
+		[segment appendString:@" WHERE "];
+		
+		BOOL first = YES;
+		
+		for (QKQueryParameter *param in _parameters)
+		{
+			QKQueryOperator operator = [param operator];
+			NSUInteger count = [self _placeholderCountForParameter:param];
+			BOOL isList = operator == QKInOperator || operator == QKNotInOperator;
+			
+			if (!first) [segment appendString:@" AND "];
+			
+			first = NO;
+			
+			[segment appendFormat:@"%@ %@", [param quotedField], [QKQueryUtilities stringRepresentationOfQueryOperator:operator]];
+			[segment appendString:isList ? @" (" : (count > 0) ? @" " : EMPTY_STRING];
+			
+			for (NSUInteger i = 0; i < count; i++)
+			{
+				if (i > 0) [segment appendString:@", "];
+				
+				[segments addObject:[NSString stringWithString:segment]];
+				[segment setString:EMPTY_STRING];
+			}
+			
+			if (isList) [segment appendString:@")"];
+		}
+	}
+	
+	if (_queryType == QKSelectQuery) {
+		[segment appendString:[self _buildSelectOptions]];
+	}
+	
+	[segments addObject:segment];
+	
+	if (_template) [_template release];
+	if (_templateArities) [_templateArities release];
+	
+	_template = [[QKQueryTemplate alloc] initWithSegments:segments database:_queryDatabase];
+	_templateArities = [[self _templateArities] retain];
+	
+	_templateNeedsCompiling = NO;
+}
+
+/**
+ * Returns the number of placeholders each of the query's insert rows and constraints currently requires.
+ *
+ * @return An array of NSNumbers, one per insert row followed by one per constraint.
+ */
+- (NSArray *)_templateArities
+{
+	NSMutableArray *arities = [NSMutableArray arrayWithCapacity:[_parameters count] + [_insertRows count]];
+	
+	for (NSArray *row in _insertRows)
+	{
+		[arities addObject:[NSNumber numberWithUnsignedInteger:[row count]]];
+	}
+	
+	for (QKQueryParameter *param in _parameters)
+	{
+		[arities addObject:[NSNumber numberWithUnsignedInteger:[self _placeholderCountForParameter:param]]];
+	}
+	
+	return arities;
+}
+
+/**
+ * Returns the number of placeholders the supplied constraint requires in the query's template.
+ *
+ * @param parameter The constraint.
+ *
+ * @return The number of placeholders.
+ */
+- (NSUInteger)_placeholderCountForParameter:(QKQueryParameter *)parameter
+{
+	QKQueryOperator operator = [parameter operator];
+	
+	if (operator == QKIsNullOperator || operator == QKIsNotNullOperator) return 0;
+	
+	if ((operator == QKInOperator || operator == QKNotInOperator) && [[parameter value] isKindOfClass:[NSArray class]]) {
+		return [[parameter value] count];
+	}
+	
+	return 1;
+}
+
 /**
  * Adds the supplied string to the supplied array, but only if the length is greater than zero.
  *
@@ -597,6 +1213,11 @@ static NSString *QKNoQueryTableException = @"QKNoQueryTable";
 	if (_updateParameters) [_updateParameters release], _updateParameters = nil;
 	if (_groupByFields) [_groupByFields release], _groupByFields = nil;
 	if (_orderByFields) [_orderByFields release], _orderByFields = nil;
+	if (_insertRows) [_insertRows release], _insertRows = nil;
+	if (_duplicateKeyUpdateFields) [_duplicateKeyUpdateFields release], _duplicateKeyUpdateFields = nil;
+	if (_conflictFields) [_conflictFields release], _conflictFields = nil;
+	if (_template) [_template release], _template = nil;
+	if (_templateArities) [_templateArities release], _templateArities = nil;
 	
 	[super dealloc];
 }
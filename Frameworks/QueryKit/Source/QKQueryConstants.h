@@ -32,3 +32,5 @@
 
 extern NSString *QKMySQLIdentifierQuote;
 extern NSString *QKPostgreSQLIdentifierQuote;
+
+extern NSString *QKTemplateNoEscaperException;
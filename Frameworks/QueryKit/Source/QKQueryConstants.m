@@ -30,3 +30,5 @@
 
 NSString *QKMySQLIdentifierQuote      = @"`";
 NSString *QKPostgreSQLIdentifierQuote = @"\"";
+
+NSString *QKTemplateNoEscaperException = @"QKTemplateNoEscaper";
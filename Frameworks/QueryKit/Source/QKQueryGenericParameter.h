@@ -47,4 +47,6 @@
  */
 @property(readwrite, retain) id value;
 
+- (NSString *)quotedField;
+
 @end
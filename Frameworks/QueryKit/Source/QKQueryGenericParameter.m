@@ -36,6 +36,18 @@
 @synthesize field = _field;
 @synthesize value = _value;
 
+/**
+ * Returns the parameter's field, trimmed and quoted if required.
+ *
+ * @return The field as it should appear in a query.
+ */
+- (NSString *)quotedField
+{
+	NSString *field = [_field stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+	
+	return [NSString stringWithFormat:@"%1$@%2$@%1$@", [self useQuotedIdentifier] ? _identiferQuote : EMPTY_STRING, field];
+}
+
 #pragma mark -
 
 - (void)dealloc
@@ -0,0 +1,85 @@
+//
+//  $Id$
+//
+//  QKQueryTemplate.h
+//  QueryKit
+//
+//  Created by the Sequel Pro team on October 19, 2026
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "QKQueryDatabases.h"
+
+/**
+ * @protocol QKQueryValueEscaping QKQueryTemplate.h
+ *
+ * Implemented by anything capable of escaping values for inclusion in a query as literals. 
+ * SPMySQLConnection already conforms to this informally.
+ */
+@protocol QKQueryValueEscaping
+
+- (NSString *)escapeAndQuoteString:(NSString *)string;
+- (NSString *)escapeAndQuoteData:(NSData *)data;
+
+@end
+
+/**
+ * @class QKQueryTemplate QKQueryTemplate.h
+ *
+ * A compiled query containing positional placeholders in place of values. Templates are immutable 
+ * and can be executed repeatedly with different values, either by passing the SQL and values to a 
+ * prepared statement (PostgresKit) or by splicing escaped literals into it (SPMySQL).
+ */
+@interface QKQueryTemplate : NSObject 
+{
+	NSString *_sql;
+	NSArray *_segments;
+	
+	QKQueryDatabase _queryDatabase;
+}
+
+/**
+ * @property sql The template's SQL, using the placeholder style of the query database.
+ */
+@property(readonly) NSString *sql;
+
+/**
+ * @property segments The template's SQL split at each placeholder.
+ */
+@property(readonly) NSArray *segments;
+
+/**
+ * @property queryDatabase The underlying database system this template was compiled for.
+ */
+@property(readonly) QKQueryDatabase queryDatabase;
+
++ (QKQueryTemplate *)templateWithSegments:(NSArray *)segments database:(QKQueryDatabase)database;
++ (NSString *)literalForValue:(id)value escaper:(id <QKQueryValueEscaping>)escaper;
+
+- (id)initWithSegments:(NSArray *)segments database:(QKQueryDatabase)database;
+
+- (NSUInteger)numberOfPlaceholders;
+
+- (NSString *)queryWithValues:(NSArray *)values escaper:(id <QKQueryValueEscaping>)escaper;
+
+@end
@@ -0,0 +1,168 @@
+//
+//  $Id$
+//
+//  QKQueryTemplate.m
+//  QueryKit
+//
+//  Created by the Sequel Pro team on October 19, 2026
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "QKQueryTemplate.h"
+#import "QKQueryUtilities.h"
+#import "QKQueryConstants.h"
+
+static NSString *QKTemplateValueCountException = @"QKTemplateValueCount";
+
+@implementation QKQueryTemplate
+
+@synthesize sql = _sql;
+@synthesize segments = _segments;
+@synthesize queryDatabase = _queryDatabase;
+
+#pragma mark -
+#pragma mark Initialisation
+
++ (QKQueryTemplate *)templateWithSegments:(NSArray *)segments database:(QKQueryDatabase)database
+{
+	return [[[QKQueryTemplate alloc] initWithSegments:segments database:database] autorelease];
+}
+
+/**
+ * Returns the SQL literal representation of the supplied value. Numbers and nulls are used as is, 
+ * everything else is escaped and quoted using the supplied escaper.
+ *
+ * @param value   The value.
+ * @param escaper The object to use to escape string and data values.
+ *
+ * @return The literal as a string.
+ */
++ (NSString *)literalForValue:(id)value escaper:(id <QKQueryValueEscaping>)escaper
+{
+	if (!value || [value isKindOfClass:[NSNull class]]) return @"NULL";
+	
+	if ([value isKindOfClass:[NSNumber class]]) return [value stringValue];
+	
+	if (!escaper) {
+		[NSException raise:QKTemplateNoEscaperException format:@"Attempt to build a literal for a non-numeric value with no escaper."];
+	}
+	
+	if ([value isKindOfClass:[NSData class]]) return [escaper escapeAndQuoteData:value];
+	
+	return [escaper escapeAndQuoteString:[value description]];
+}
+
+- (id)init
+{
+	return [self initWithSegments:[NSArray arrayWithObject:EMPTY_STRING] database:QKDatabaseUnknown];
+}
+
+/**
+ * Initialises a template from the supplied SQL segments.
+ *
+ * @param segments The SQL, split at each point a placeholder should be inserted.
+ * @param database The database the template is for, which determines the placeholder style.
+ *
+ * @return The initialised template.
+ */
+- (id)initWithSegments:(NSArray *)segments database:(QKQueryDatabase)database
+{
+	if ((self = [super init])) {
+		_segments = [segments copy];
+		_queryDatabase = database;
+		
+		NSMutableString *sql = [NSMutableString string];
+		
+		for (NSUInteger i = 0; i < [_segments count]; i++)
+		{
+			if (i > 0) [sql appendString:[QKQueryUtilities placeholderForDatabase:_queryDatabase index:i]];
+			
+			[sql appendString:[_segments objectAtIndex:i]];
+		}
+		
+		_sql = [sql copy];
+	}
+	
+	return self;
+}
+
+#pragma mark -
+#pragma mark Public API
+
+/**
+ * Returns the number of placeholders in this template.
+ *
+ * @return The number of placeholders.
+ */
+- (NSUInteger)numberOfPlaceholders
+{
+	return [_segments count] - 1;
+}
+
+/**
+ * Builds a query from this template by replacing each placeholder with the escaped literal
+ * representation of the corresponding value. For use with connections that don't support 
+ * prepared statements.
+ *
+ * @param values  The values to use, one per placeholder.
+ * @param escaper The object to use to escape string and data values.
+ *
+ * @return The query.
+ */
+- (NSString *)queryWithValues:(NSArray *)values escaper:(id <QKQueryValueEscaping>)escaper
+{
+	NSUInteger count = [values count];
+	
+	if (count != [self numberOfPlaceholders]) {
+		[NSException raise:QKTemplateValueCountException format:@"Attempt to use a template with %lu placeholders with %lu values.", (unsigned long)[self numberOfPlaceholders], (unsigned long)count];
+	}
+	
+	NSMutableString *query = [NSMutableString stringWithString:[_segments objectAtIndex:0]];
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		[query appendString:[QKQueryTemplate literalForValue:[values objectAtIndex:i] escaper:escaper]];
+		[query appendString:[_segments objectAtIndex:i + 1]];
+	}
+	
+	return query;
+}
+
+#pragma mark -
+
+- (NSString *)description
+{
+	return _sql;
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	if (_sql) [_sql release], _sql = nil;
+	if (_segments) [_segments release], _segments = nil;
+	
+	[super dealloc];
+}
+
+@end
@@ -57,9 +57,7 @@
 {
 	NSMutableString *string = [NSMutableString string]; 
 	
-	NSString *field = [_field stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-	
-	[string appendFormat:@"%1$@%2$@%1$@", [self useQuotedIdentifier] ? _identiferQuote : EMPTY_STRING, field];
+	[string appendString:[self quotedField]];
 	[string appendString:@" = "];
 	[string appendFormat:(![_value isKindOfClass:[NSNumber class]]) ? @"'%@'" : @"%@", [_value description]];
 	
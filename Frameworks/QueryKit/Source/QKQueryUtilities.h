@@ -42,5 +42,6 @@
 
 + (NSString *)identifierQuoteCharacterForDatabase:(QKQueryDatabase)database;
 + (NSString *)stringRepresentationOfQueryOperator:(QKQueryOperator)operator;
++ (NSString *)placeholderForDatabase:(QKQueryDatabase)database index:(NSUInteger)index;
 
 @end
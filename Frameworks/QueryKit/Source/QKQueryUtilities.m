@@ -112,4 +112,17 @@ static NSString *QKUnrecognisedQueryOperatorException = @"QKUnrecognisedQueryOpe
 	return opString;
 }
 
+/**
+ * Returns the positional placeholder to use for a bound value in a query for the supplied database.
+ *
+ * @param database The database to return the placeholder for
+ * @param index    The (one based) position of the value within the query
+ *
+ * @return The placeholder as a string.
+ */
++ (NSString *)placeholderForDatabase:(QKQueryDatabase)database index:(NSUInteger)index
+{
+	return database == QKDatabasePostgreSQL ? [NSString stringWithFormat:@"$%lu", (unsigned long)index] : @"?";
+}
+
 @end
@@ -36,3 +36,4 @@
 #import <QueryKit/QKQueryDatabases.h>
 #import <QueryKit/QKQueryParameter.h>
 #import <QueryKit/QKQueryUtilities.h>
+#import <QueryKit/QKQueryTemplate.h>
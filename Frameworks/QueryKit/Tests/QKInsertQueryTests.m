@@ -0,0 +1,175 @@
+//
+//  $Id$
+//
+//  QKInsertQueryTests.m
+//  QueryKit
+//
+//  Created by the Sequel Pro team on October 19, 2026
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+#import "QKInsertQueryTests.h"
+#import "QKTestConstants.h"
+
+@implementation QKInsertQueryTests
+
+#pragma mark -
+#pragma mark Initialisation
+
++ (id)defaultTestSuite
+{
+    SenTestSuite *testSuite = [[SenTestSuite alloc] initWithName:NSStringFromClass(self)];
+	
+	[self addTestForDatabase:QKDatabaseUnknown withIdentifierQuote:EMPTY_STRING toTestSuite:testSuite];
+	[self addTestForDatabase:QKDatabaseMySQL withIdentifierQuote:QKMySQLIdentifierQuote toTestSuite:testSuite];
+	[self addTestForDatabase:QKDatabasePostgreSQL withIdentifierQuote:QKPostgreSQLIdentifierQuote toTestSuite:testSuite];
+	
+    return [testSuite autorelease];
+}
+
++ (void)addTestForDatabase:(QKQueryDatabase)database withIdentifierQuote:(NSString *)quote toTestSuite:(SenTestSuite *)testSuite
+{		
+    for (NSInvocation *invocation in [self testInvocations]) 
+	{
+		SenTestCase *test = [[NSClassFromString(@"QKInsertQueryTests") alloc] initWithInvocation:invocation database:database identifierQuote:quote];
+		
+		[testSuite addTest:test];
+		
+        [test release];
+    }
+}
+
+#pragma mark -
+#pragma mark Setup
+
+- (void)setUp
+{
+	QKQuery *query = [QKQuery queryTable:QKTestTableName];
+	
+	[query setQueryType:QKInsertQuery];
+	[query setQueryDatabase:[self database]];
+	[query setUseQuotedIdentifiers:[self identifierQuote] && [[self identifierQuote] length] > 0];
+	
+	[query addField:QKTestFieldOne];
+	[query addField:QKTestFieldTwo];
+	
+	[query addInsertRow:[NSArray arrayWithObjects:QKTestUpdateValueOne, [NSNumber numberWithUnsignedInteger:QKTestParameterOne], nil]];
+	[query addInsertRow:[NSArray arrayWithObjects:QKTestUpdateValueTwo, [NSNull null], nil]];
+	
+	[self setQuery:query];
+}
+
+#pragma mark -
+#pragma mark Value escaping
+
+- (NSString *)escapeAndQuoteString:(NSString *)string
+{
+	return [NSString stringWithFormat:@"'%@'", [string stringByReplacingOccurrencesOfString:@"'" withString:@"''"]];
+}
+
+- (NSString *)escapeAndQuoteData:(NSData *)data
+{
+	return @"X''";
+}
+
+#pragma mark -
+#pragma mark Tests
+
+- (void)testInsertQueryTypeIsCorrect
+{
+	STAssertTrue([[[self query] query] hasPrefix:@"INSERT INTO"], nil);
+}
+
+- (void)testInsertQueryFieldsAndRowsAreCorrect
+{
+	NSString *query = [NSString stringWithFormat:@"INSERT INTO %1$@%2$@%1$@ (%1$@%3$@%1$@, %1$@%4$@%1$@) VALUES ('%5$@', %6$@), ('%7$@', NULL)", 
+					   [self identifierQuote], QKTestTableName, QKTestFieldOne, QKTestFieldTwo, QKTestUpdateValueOne, [NSNumber numberWithUnsignedInteger:QKTestParameterOne], QKTestUpdateValueTwo];
+	
+	STAssertEqualObjects([[self query] query], query, nil);
+}
+
+- (void)testInsertQueryDuplicateKeyClauseIsCorrect
+{
+	NSString *clause = nil;
+	
+	[[self query] updateFieldOnDuplicateKey:QKTestFieldTwo];
+	
+	if ([self database] == QKDatabasePostgreSQL) {
+		[[self query] setConflictFields:[NSArray arrayWithObject:QKTestFieldOne]];
+		
+		clause = [NSString stringWithFormat:@" ON CONFLICT (%1$@%2$@%1$@) DO UPDATE SET %1$@%3$@%1$@ = EXCLUDED.%1$@%3$@%1$@", [self identifierQuote], QKTestFieldOne, QKTestFieldTwo];
+	}
+	else {
+		clause = [NSString stringWithFormat:@" ON DUPLICATE KEY UPDATE %1$@%2$@%1$@ = VALUES(%1$@%2$@%1$@)", [self identifierQuote], QKTestFieldTwo];
+	}
+	
+	STAssertTrue([[[self query] query] hasSuffix:clause], nil);
+}
+
+- (void)testInsertQueryWithMismatchedRowLengthThrows
+{
+	STAssertThrows([[self query] addInsertRow:[NSArray arrayWithObject:QKTestUpdateValueOne]], nil);
+}
+
+- (void)testInsertQueriesWithoutLimitMatchesQuery
+{
+	NSArray *queries = [[self query] insertQueriesWithMaximumLength:0 escaper:self];
+	
+	STAssertEquals([queries count], (NSUInteger)1, nil);
+	STAssertEqualObjects([queries objectAtIndex:0], [[self query] query], nil);
+}
+
+- (void)testInsertQueriesAreSplitAtMaximumLength
+{
+	NSUInteger length = [[[self query] query] lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	
+	NSArray *queries = [[self query] insertQueriesWithMaximumLength:(length - 1) escaper:self];
+	
+	STAssertEquals([queries count], (NSUInteger)2, nil);
+	
+	for (NSString *query in queries)
+	{
+		STAssertTrue([query hasPrefix:@"INSERT INTO"], nil);
+		STAssertTrue([query lengthOfBytesUsingEncoding:NSUTF8StringEncoding] < length, nil);
+	}
+}
+
+- (void)testInsertQueriesReturnOversizedRowsAlone
+{
+	NSArray *queries = [[self query] insertQueriesWithMaximumLength:1 escaper:self];
+	
+	STAssertEquals([queries count], [[[self query] insertRows] count], nil);
+}
+
+- (void)testInsertQueriesWithoutEscaperThrows
+{
+	STAssertThrows([[self query] insertQueriesWithMaximumLength:0 escaper:nil], nil);
+}
+
+- (void)testInsertQueryTemplateUsesPlaceholders
+{
+	STAssertEquals([[[self query] compiledTemplate] numberOfPlaceholders], (NSUInteger)4, nil);
+	STAssertEquals([[[self query] templateValues] count], (NSUInteger)4, nil);
+	STAssertEqualObjects([[self query] queryUsingTemplateWithEscaper:self], [[self query] query], nil);
+}
+
+@end
@@ -0,0 +1,163 @@
+//
+//  $Id$
+//
+//  QKQueryTemplateTests.m
+//  QueryKit
+//
+//  Created by the Sequel Pro team on October 19, 2026
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+#import "QKQueryTemplateTests.h"
+#import "QKTestConstants.h"
+
+@implementation QKQueryTemplateTests
+
+#pragma mark -
+#pragma mark Initialisation
+
++ (id)defaultTestSuite
+{
+    SenTestSuite *testSuite = [[SenTestSuite alloc] initWithName:NSStringFromClass(self)];
+	
+	[self addTestForDatabase:QKDatabaseUnknown withIdentifierQuote:EMPTY_STRING toTestSuite:testSuite];
+	[self addTestForDatabase:QKDatabaseMySQL withIdentifierQuote:QKMySQLIdentifierQuote toTestSuite:testSuite];
+	[self addTestForDatabase:QKDatabasePostgreSQL withIdentifierQuote:QKPostgreSQLIdentifierQuote toTestSuite:testSuite];
+	
+    return [testSuite autorelease];
+}
+
++ (void)addTestForDatabase:(QKQueryDatabase)database withIdentifierQuote:(NSString *)quote toTestSuite:(SenTestSuite *)testSuite
+{		
+    for (NSInvocation *invocation in [self testInvocations]) 
+	{
+		SenTestCase *test = [[NSClassFromString(@"QKQueryTemplateTests") alloc] initWithInvocation:invocation database:database identifierQuote:quote];
+		
+		[testSuite addTest:test];
+		
+        [test release];
+    }
+}
+
+#pragma mark -
+#pragma mark Setup
+
+- (void)setUp
+{
+	QKQuery *query = [QKQuery queryTable:QKTestTableName];
+	
+	[query setQueryType:QKUpdateQuery];
+	[query setQueryDatabase:[self database]];
+	[query setUseQuotedIdentifiers:[self identifierQuote] && [[self identifierQuote] length] > 0];
+	
+	[query addFieldToUpdate:QKTestFieldOne toValue:QKTestUpdateValueOne];
+	[query addFieldToUpdate:QKTestFieldTwo toValue:QKTestUpdateValueTwo];
+	
+	[query addParameter:QKTestFieldOne operator:QKEqualityOperator value:[NSNumber numberWithUnsignedInteger:QKTestParameterOne]];
+	
+	[self setQuery:query];
+}
+
+#pragma mark -
+#pragma mark Value escaping
+
+- (NSString *)escapeAndQuoteString:(NSString *)string
+{
+	return [NSString stringWithFormat:@"'%@'", [string stringByReplacingOccurrencesOfString:@"'" withString:@"''"]];
+}
+
+- (NSString *)escapeAndQuoteData:(NSData *)data
+{
+	return @"X''";
+}
+
+#pragma mark -
+#pragma mark Tests
+
+- (void)testTemplateUsesPlaceholders
+{
+	NSString *query = [NSString stringWithFormat:@"UPDATE %1$@%2$@%1$@ SET %1$@%3$@%1$@ = %5$@, %1$@%4$@%1$@ = %6$@ WHERE %1$@%3$@%1$@ = %7$@", 
+					   [self identifierQuote], QKTestTableName, QKTestFieldOne, QKTestFieldTwo, 
+					   [QKQueryUtilities placeholderForDatabase:[self database] index:1],
+					   [QKQueryUtilities placeholderForDatabase:[self database] index:2],
+					   [QKQueryUtilities placeholderForDatabase:[self database] index:3]];
+	
+	STAssertEqualObjects([[[self query] compiledTemplate] sql], query, nil);
+}
+
+- (void)testTemplateValuesAreInPlaceholderOrder
+{
+	NSArray *values = [NSArray arrayWithObjects:QKTestUpdateValueOne, QKTestUpdateValueTwo, [NSNumber numberWithUnsignedInteger:QKTestParameterOne], nil];
+	
+	STAssertEqualObjects([[self query] templateValues], values, nil);
+}
+
+- (void)testTemplateIsReusedWhenOnlyValuesChange
+{
+	QKQueryTemplate *template = [[self query] compiledTemplate];
+	
+	[[[[self query] parameters] objectAtIndex:0] setValue:[NSNumber numberWithUnsignedInteger:QKTestParameterOne + 1]];
+	
+	STAssertTrue([[self query] compiledTemplate] == template, nil);
+	STAssertEqualObjects([[[self query] templateValues] lastObject], [NSNumber numberWithUnsignedInteger:QKTestParameterOne + 1], nil);
+}
+
+- (void)testTemplateIsRecompiledWhenStructureChanges
+{
+	QKQueryTemplate *template = [[self query] compiledTemplate];
+	
+	[[self query] addParameter:QKTestFieldTwo operator:QKIsNullOperator value:[NSNull null]];
+	
+	STAssertTrue([[self query] compiledTemplate] != template, nil);
+	STAssertTrue([[[[self query] compiledTemplate] sql] hasSuffix:@"IS NULL"], nil);
+	STAssertEquals([[[self query] compiledTemplate] numberOfPlaceholders], (NSUInteger)3, nil);
+}
+
+- (void)testTemplateExpandsInConstraintValues
+{
+	NSArray *values = [NSArray arrayWithObjects:@"one", @"two", @"three", nil];
+	
+	QKQueryParameter *param = [QKQueryParameter queryParamWithField:QKTestFieldThree operator:QKInOperator value:values];
+	
+	[[self query] addParameter:param];
+	
+	STAssertEquals([[[self query] compiledTemplate] numberOfPlaceholders], (NSUInteger)6, nil);
+	
+	[param setValue:[values subarrayWithRange:NSMakeRange(0, 2)]];
+	
+	STAssertEquals([[[self query] compiledTemplate] numberOfPlaceholders], (NSUInteger)5, nil);
+	STAssertEquals([[[self query] templateValues] count], (NSUInteger)5, nil);
+}
+
+- (void)testQueryUsingTemplateMatchesQuery
+{
+	STAssertEqualObjects([[self query] queryUsingTemplateWithEscaper:self], [[self query] query], nil);
+}
+
+- (void)testQueryUsingTemplateEscapesValues
+{
+	[[self query] addParameter:QKTestFieldTwo operator:QKNotEqualOperator value:@"it's"];
+	
+	STAssertTrue([[[self query] queryUsingTemplateWithEscaper:self] hasSuffix:@"'it''s'"], nil);
+}
+
+@end
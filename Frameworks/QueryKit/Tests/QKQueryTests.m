@@ -80,6 +80,9 @@
 	STAssertTrue([[[self query] updateParameters] count] == 0, @"query update parameters");
 	STAssertTrue([[[self query] groupByFields] count] == 0, @"query group by fields");
 	STAssertTrue([[[self query] orderByFields] count] == 0, @"query order by fields");
+	STAssertTrue([[[self query] insertRows] count] == 0, @"query insert rows");
+	STAssertTrue([[[self query] duplicateKeyUpdateFields] count] == 0, @"query duplicate key update fields");
+	STAssertNil([[self query] conflictFields], @"query conflict fields");
 	
 	STAssertEquals([[self query] queryType], QKUnknownQuery, @"query type");
 	STAssertEquals([[self query] queryDatabase], QKDatabaseUnknown, @"query database");
@@ -86,6 +86,7 @@
 - (void)_flushMultipleResultSets;
 - (void)_updateLastErrorMessage:(NSString *)theErrorMessage;
 - (void)_updateLastErrorID:(NSUInteger)theErrorID;
+- (void)_installLocalInfileHandlerOnConnection:(MYSQL *)theConnection;
 
 @end
 
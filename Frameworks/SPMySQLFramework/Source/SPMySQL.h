@@ -46,6 +46,7 @@
 // MySQL Connection Delegate and Proxy protocols
 #import "SPMySQLConnectionDelegate.h"
 #import "SPMySQLConnectionProxy.h"
+#import "SPMySQLLocalInfileSource.h"
 
 // MySQL Connection class and public categories
 #import "SPMySQLConnection.h"
@@ -63,7 +63,8 @@
 	[copy setRetryQueriesOnConnectionFailure:retryQueriesOnConnectionFailure];
 	[copy setDelegateQueryLogging:delegateQueryLogging];
 
-	// Active connection state details, like selected database and encoding, are *not* copied.
+	// Active connection state details, like selected database and encoding, are *not* copied;
+	// nor is local infile support, which must be requested for each connection used for loads.
 
 	return copy;
 }
@@ -45,6 +45,7 @@
 - (id)streamingQueryString:(NSString *)theQueryString useLowMemoryBlockingStreaming:(BOOL)fullStreaming;
 - (SPMySQLStreamingResultStore *)resultStoreFromQueryString:(NSString *)theQueryString;
 - (id)queryString:(NSString *)theQueryString usingEncoding:(NSStringEncoding)theEncoding withResultType:(SPMySQLResultType)theReturnType;
+- (SPMySQLResult *)queryString:(NSString *)theQueryString withLocalInfileSource:(NSObject <SPMySQLLocalInfileSource> *)theSource;
 
 // Query convenience functions
 - (NSArray *)getAllRowsFromQuery:(NSString *)theQueryString;
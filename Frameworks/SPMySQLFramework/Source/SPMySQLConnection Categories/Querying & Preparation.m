@@ -34,6 +34,14 @@
 #import "SPMySQLConnection.h"
 #import "SPMySQL Private APIs.h"
 
+// The client library's CR_UNKNOWN_ERROR, reported when a local infile source fails
+static const int SPMySQLLocalInfileSourceErrorID = 2000;
+
+static int _localInfileInit(void **handlerState, const char *filename, void *connection);
+static int _localInfileRead(void *handlerState, char *buffer, unsigned int bufferLength);
+static void _localInfileEnd(void *handlerState);
+static int _localInfileError(void *handlerState, char *errorBuffer, unsigned int errorBufferLength);
+
 @implementation SPMySQLConnection (Querying_and_Preparation)
 
 #pragma mark -
@@ -413,6 +421,28 @@
 	return [theResult autorelease];
 }
 
+/**
+ * Run a LOAD DATA LOCAL INFILE query, provided as a string, on the active connection in
+ * the current connection encoding.  The connection must have been connected with
+ * allowsLocalInfile set, or the server or client library will refuse the load.  The server's request for the file is answered with the
+ * data supplied by the source, whatever file name the query names.
+ * As the source cannot be rewound, the query is not retried if the connection is lost
+ * while it runs.
+ */
+- (SPMySQLResult *)queryString:(NSString *)theQueryString withLocalInfileSource:(NSObject <SPMySQLLocalInfileSource> *)theSource
+{
+	BOOL retryQueries = retryQueriesOnConnectionFailure;
+	retryQueriesOnConnectionFailure = NO;
+	localInfileSource = [theSource retain];
+
+	SPMySQLResult *theResult = SPMySQLConnectionQueryString(self, theQueryString, stringEncoding, SPMySQLResultAsResult);
+
+	[localInfileSource release], localInfileSource = nil;
+	retryQueriesOnConnectionFailure = retryQueries;
+
+	return theResult;
+}
+
 #pragma mark -
 #pragma mark Query convenience functions
 
@@ -689,4 +719,75 @@
 	}
 }
 
+/**
+ * Install the framework's local infile handler on a newly made connection, replacing the
+ * client library's default handler which reads whichever file the server names.  The
+ * framework's handler only supplies data from the source registered by
+ * -queryString:withLocalInfileSource:, and refuses the request otherwise - so that a
+ * server cannot request arbitrary local files in response to another query.
+ */
+- (void)_installLocalInfileHandlerOnConnection:(MYSQL *)theConnection
+{
+	mysql_set_local_infile_handler(theConnection, _localInfileInit, _localInfileRead, _localInfileEnd, _localInfileError, self);
+}
+
+#pragma mark -
+#pragma mark Local infile handler callbacks
+
+/**
+ * Called by the client library when the server requests a local file; succeeds only if
+ * a source has been registered for the running query.  The requested file name is ignored.
+ */
+static int _localInfileInit(void **handlerState, const char *filename, void *connection)
+{
+	*handlerState = connection;
+
+	return (((SPMySQLConnection *)connection)->localInfileSource) ? 0 : 1;
+}
+
+/**
+ * Called by the client library to read the next block of file data from the source.
+ */
+static int _localInfileRead(void *handlerState, char *buffer, unsigned int bufferLength)
+{
+	NSObject <SPMySQLLocalInfileSource> *theSource = ((SPMySQLConnection *)handlerState)->localInfileSource;
+	if (!theSource) return -1;
+
+	NSAutoreleasePool *readPool = [[NSAutoreleasePool alloc] init];
+	NSInteger bytesRead = [theSource readLocalInfileBytes:buffer maxLength:bufferLength];
+	[readPool drain];
+
+	return (int)bytesRead;
+}
+
+/**
+ * Called by the client library once the file transfer has finished or failed; the
+ * source remains registered until the query returns, so there is nothing to clean up.
+ */
+static void _localInfileEnd(void *handlerState)
+{
+}
+
+/**
+ * Called by the client library to retrieve the error for a failed file transfer.
+ */
+static int _localInfileError(void *handlerState, char *errorBuffer, unsigned int errorBufferLength)
+{
+	NSObject <SPMySQLLocalInfileSource> *theSource = ((SPMySQLConnection *)handlerState)->localInfileSource;
+	NSString *theErrorMessage = nil;
+
+	if (!theSource) {
+		theErrorMessage = @"LOAD DATA LOCAL INFILE is not permitted for this query.";
+	} else if ([theSource respondsToSelector:@selector(localInfileErrorMessage)]) {
+		theErrorMessage = [theSource localInfileErrorMessage];
+	}
+	if (!theErrorMessage) theErrorMessage = @"The local data for LOAD DATA LOCAL INFILE could not be read.";
+
+	if (errorBufferLength) {
+		strlcpy(errorBuffer, [theErrorMessage UTF8String], errorBufferLength);
+	}
+
+	return SPMySQLLocalInfileSourceErrorID;
+}
+
 @end
@@ -127,6 +127,10 @@
 
 	// Queries
 	BOOL retryQueriesOnConnectionFailure;
+
+	// LOAD DATA LOCAL INFILE support, and the data source for the load query running, if any
+	BOOL allowsLocalInfile;
+	NSObject <SPMySQLLocalInfileSource> *localInfileSource;
 }
 
 #pragma mark -
@@ -150,6 +154,7 @@
 
 @property (readonly) unsigned long mysqlConnectionThreadId;
 @property (readwrite, assign) BOOL retryQueriesOnConnectionFailure;
+@property (readwrite, assign) BOOL allowsLocalInfile;
 
 @property (readwrite, assign) BOOL delegateQueryLogging;
 
@@ -72,6 +72,7 @@ const char *SPMySQLSSLPermissibleCiphers = "DHE-RSA-AES256-SHA:AES256-SHA:DHE-RS
 @synthesize keepAliveInterval;
 @synthesize mysqlConnectionThreadId;
 @synthesize retryQueriesOnConnectionFailure;
+@synthesize allowsLocalInfile;
 @synthesize delegateQueryLogging;
 @synthesize lastQueryWasCancelled;
 
@@ -186,6 +187,11 @@ const char *SPMySQLSSLPermissibleCiphers = "DHE-RSA-AES256-SHA:AES256-SHA:DHE-RS
 		// while running them
 		retryQueriesOnConnectionFailure = YES;
 
+		// Only connections set up for loads allow LOAD DATA LOCAL INFILE, and no local infile
+		// data is supplied until a load query registers a source
+		allowsLocalInfile = NO;
+		localInfileSource = nil;
+
 		// Start the ping keepalive timer
 		keepAliveTimer = [[SPMySQLKeepAliveTimer alloc] initWithInterval:10 target:self selector:@selector(_keepAlive)];
 	}
@@ -515,6 +521,12 @@ const char *SPMySQLSSLPermissibleCiphers = "DHE-RSA-AES256-SHA:AES256-SHA:DHE-RS
 	// Set the connection encoding
 	mysql_options(theConnection, MYSQL_SET_CHARSET_NAME, [encodingName UTF8String]);
 
+	// Allow LOAD DATA LOCAL INFILE only if requested for this connection; the file requests
+	// are answered by the framework's own handler, installed below, which only ever supplies
+	// data from a registered source.
+	unsigned int localInfileEnabled = allowsLocalInfile ? 1 : 0;
+	mysql_options(theConnection, MYSQL_OPT_LOCAL_INFILE, (const void *)&localInfileEnabled);
+
 	// Set up the connection variables in the format MySQL needs, from the class-wide variables
 	const char *theHost = NULL;
 	const char *theUsername = "";
@@ -576,6 +588,9 @@ const char *SPMySQLSSLPermissibleCiphers = "DHE-RSA-AES256-SHA:AES256-SHA:DHE-RS
 	// Ensure automatic reconnection is disabled for older versions
 	theConnection->reconnect = 0;
 
+	// Replace the default local infile handler, which would read any file the server asks for
+	[self _installLocalInfileHandlerOnConnection:theConnection];
+
 	// Successful connection - return the handle
 	return theConnection;
 }
@@ -0,0 +1,61 @@
+//
+//  $Id$
+//
+//  SPMySQLLocalInfileSource.h
+//  SPMySQLFramework
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+/**
+ * A data source supplying the file contents for a LOAD DATA LOCAL INFILE query; see
+ * -[SPMySQLConnection queryString:withLocalInfileSource:].
+ *
+ * The connection never opens files named by the server itself - the server's file
+ * request is only ever answered with the bytes supplied by the source registered
+ * for the query currently running, and refused when no source is registered.
+ * The source methods are called on the thread running the query.
+ */
+@protocol SPMySQLLocalInfileSource <NSObject>
+
+/**
+ * Copy up to maxLength bytes of file data into the supplied buffer, returning the
+ * number of bytes copied; return 0 once all data has been supplied, or -1 to abort
+ * the load with an error.
+ */
+- (NSInteger)readLocalInfileBytes:(char *)buffer maxLength:(NSUInteger)maxLength;
+
+@optional
+
+/**
+ * The error message to report for the load if -readLocalInfileBytes:maxLength:
+ * returned -1.
+ */
+- (NSString *)localInfileErrorMessage;
+
+@end
@@ -64,6 +64,7 @@ typedef char SPMySQLStreamingResultStoreRowData;
 - (id)cellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
 - (id)cellPreviewAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex previewLength:(NSUInteger)previewLength;
 - (BOOL)cellIsNullAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
+- (const char *)rawCellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex length:(NSUInteger *)dataLength;
 
 /* Deleting rows and addition of placeholder rows */
 - (void) addDummyRow;
@@ -108,3 +109,11 @@ static inline id SPMySQLResultStorePreviewAtRowAndColumn(SPMySQLStreamingResultS
 	if (!SPMSRSObjectPreview) SPMSRSObjectPreview = (SPMSRSObjectPreviewMethodPtr)[self methodForSelector:@selector(cellPreviewAtRow:column:previewLength:)];
 	return SPMSRSObjectPreview(self, @selector(cellPreviewAtRow:column:previewLength:), rowIndex, colIndex, previewLength);
 }
+
+static inline const char *SPMySQLResultStoreRawCellData(SPMySQLStreamingResultStore* self, NSUInteger rowIndex, NSUInteger colIndex, NSUInteger *dataLength)
+{
+	typedef const char * (*SPMSRSRawCellFetchMethodPtr)(SPMySQLStreamingResultStore*, SEL, NSUInteger, NSUInteger, NSUInteger *);
+	static SPMSRSRawCellFetchMethodPtr SPMSRSRawCellFetch;
+	if (!SPMSRSRawCellFetch) SPMSRSRawCellFetch = (SPMSRSRawCellFetchMethodPtr)[self methodForSelector:@selector(rawCellDataAtRow:column:length:)];
+	return SPMSRSRawCellFetch(self, @selector(rawCellDataAtRow:column:length:), rowIndex, colIndex, dataLength);
+}
@@ -86,6 +86,66 @@ static inline void SPMySQLStreamingResultStoreFreeRowData(SPMySQLStreamingResult
 	free(aRow);
 }
 
+/**
+ * Locate the data for a cell within a stored row, returning a pointer to the start of the
+ * cell data and setting the supplied length, or returning NULL if the cell is NULL.
+ */
+static inline char *SPMySQLStreamingResultStoreCellDataInRow(SPMySQLStreamingResultStoreRowData *rowData, NSUInteger numberOfFields, NSUInteger columnIndex, unsigned long *dataLength)
+{
+	unsigned long dataStart;
+	size_t sizeOfMetadata;
+
+	// Get the metadata size for this row and adjust the data pointer past the indicator
+	sizeOfMetadata = rowData[0];
+	rowData = rowData + 1;
+
+	static size_t sizeOfNullRecord = sizeof(BOOL);
+
+	// Retrieve the data positions within the stored data.  Manually unroll the logic for
+	// the different data size cases; again, this is messy, but the large memory savings for
+	// small rows make this extra work worth it.
+	if (columnIndex == 0) {
+		dataStart = 0;
+		switch (sizeOfMetadata) {
+			case SPMySQLStoreMetadataAsChar:
+				*dataLength = ((unsigned char *)rowData)[columnIndex];
+				break;
+			case SPMySQLStoreMetadataAsShort:
+				*dataLength = ((unsigned short *)rowData)[columnIndex];
+				break;
+			case SPMySQLStoreMetadataAsLong:
+			default:
+				*dataLength = ((unsigned long *)rowData)[columnIndex];
+				break;
+		}
+	} else {
+		switch (sizeOfMetadata) {
+			case SPMySQLStoreMetadataAsChar:
+				dataStart = ((unsigned char *)rowData)[columnIndex - 1];
+				*dataLength = ((unsigned char *)rowData)[columnIndex] - dataStart;
+				break;
+			case SPMySQLStoreMetadataAsShort:
+				dataStart = ((unsigned short *)rowData)[columnIndex - 1];
+				*dataLength = ((unsigned short *)rowData)[columnIndex] - dataStart;
+				break;
+			case SPMySQLStoreMetadataAsLong:
+			default:
+				dataStart = ((unsigned long *)rowData)[columnIndex - 1];
+				*dataLength = ((unsigned long *)rowData)[columnIndex] - dataStart;
+				break;
+		}
+
+	}
+
+	// If the data length is empty, check whether the cell is null and return null if so
+	if (((BOOL *)(rowData + (sizeOfMetadata * numberOfFields)))[columnIndex]) {
+		return NULL;
+	}
+
+	// Return a reference to the start of the cell data
+	return rowData + ((sizeOfMetadata + sizeOfNullRecord) * numberOfFields) + dataStart;
+}
+
 
 #pragma mark - Setup and teardown
 
@@ -364,59 +424,14 @@ static inline void SPMySQLStreamingResultStoreFreeRowData(SPMySQLStreamingResult
 		return nil;
 	}
 
-	unsigned long dataStart, dataLength;
-	size_t sizeOfMetadata;
-
-	// Get the metadata size for this row and adjust the data pointer past the indicator
-	sizeOfMetadata = rowData[0];
-	rowData = rowData + 1;
+	unsigned long dataLength;
 
-	static size_t sizeOfNullRecord = sizeof(BOOL);
-
-	// Retrieve the data positions within the stored data.  Manually unroll the logic for
-	// the different data size cases; again, this is messy, but the large memory savings for
-	// small rows make this extra work worth it.
-	if (columnIndex == 0) {
-		dataStart = 0;
-		switch (sizeOfMetadata) {
-			case SPMySQLStoreMetadataAsChar:
-				dataLength = ((unsigned char *)rowData)[columnIndex];
-				break;
-			case SPMySQLStoreMetadataAsShort:
-				dataLength = ((unsigned short *)rowData)[columnIndex];
-				break;
-			case SPMySQLStoreMetadataAsLong:
-			default:
-				dataLength = ((unsigned long *)rowData)[columnIndex];
-				break;
-		}
-	} else {
-		switch (sizeOfMetadata) {
-			case SPMySQLStoreMetadataAsChar:
-				dataStart = ((unsigned char *)rowData)[columnIndex - 1];
-				dataLength = ((unsigned char *)rowData)[columnIndex] - dataStart;
-				break;
-			case SPMySQLStoreMetadataAsShort:
-				dataStart = ((unsigned short *)rowData)[columnIndex - 1];
-				dataLength = ((unsigned short *)rowData)[columnIndex] - dataStart;
-				break;
-			case SPMySQLStoreMetadataAsLong:
-			default:
-				dataStart = ((unsigned long *)rowData)[columnIndex - 1];
-				dataLength = ((unsigned long *)rowData)[columnIndex] - dataStart;
-				break;
-		}
-
-	}
-
-	// If the data length is empty, check whether the cell is null and return null if so
-	if (((BOOL *)(rowData + (sizeOfMetadata * numberOfFields)))[columnIndex]) {
+	// Locate the cell data within the row, returning null if the cell is NULL
+	rawCellDataStart = SPMySQLStreamingResultStoreCellDataInRow(rowData, numberOfFields, columnIndex, &dataLength);
+	if (rawCellDataStart == NULL) {
 		return NSNullPointer;
 	}
 
-	// Get a reference to the start of the cell data
-	rawCellDataStart = rowData + ((sizeOfMetadata + sizeOfNullRecord) * numberOfFields) + dataStart;
-
 	// Attempt to convert to the correct native object type, which will result in nil on error/invalidity
 	cellData = SPMySQLResultGetObject(self, rawCellDataStart, dataLength, columnIndex, previewLength);
 
@@ -428,6 +443,34 @@ static inline void SPMySQLStreamingResultStoreFreeRowData(SPMySQLStreamingResult
 	return cellData;
 }
 
+/**
+ * Returns a pointer to the bytes stored for the cell at a specified row and column index, as
+ * received from the server in the connection encoding, setting the supplied length to the
+ * number of bytes.  The bytes are not terminated, and are only valid while the row remains
+ * in the store.  Returns NULL for NULL cells and dummy rows.
+ */
+- (const char *)rawCellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex length:(NSUInteger *)dataLength
+{
+	// Throw an exception if the row or column index is out of bounds
+	if (rowIndex >= numberOfRows || columnIndex >= numberOfFields) {
+		[NSException raise:NSRangeException format:@"Requested storage index (row %llu, col %llu) beyond bounds (%llu, %llu)", (unsigned long long)rowIndex, (unsigned long long)columnIndex, (unsigned long long)numberOfRows, (unsigned long long)numberOfFields];
+	}
+
+	SPMySQLStreamingResultStoreRowData *rowData = dataStorage[rowIndex];
+	unsigned long cellLength;
+	char *cellData;
+
+	// A null pointer for the row indicates a dummy entry
+	if (rowData == NULL) {
+		return NULL;
+	}
+
+	cellData = SPMySQLStreamingResultStoreCellDataInRow(rowData, numberOfFields, columnIndex, &cellLength);
+	if (dataLength) *dataLength = (NSUInteger)cellLength;
+
+	return cellData;
+}
+
 /**
  * Returns whether the data at a specified row and column index is NULL.
  */
@@ -33,34 +33,49 @@
 /**
  * This class provides a string class intended for CSV parsing.  Unlike SPSQLParser, this
  * does not extend NSMutableString and instead provides only a subset of similar methods.
- * Internally, an approach similar to NSScanner is used to support multi-character strings.
  * The methods are designed with the intention that as a string is parsed the parsed content
  * is removed.  This also allows parsing to occur in "streaming" mode, with parseable content
  * being pulled off the start of the string as additional content is appended onto the end of
  * the string, eg from a file.
  *
+ * Internally the CSV is held and scanned as bytes in the data encoding (UTF-8 by default);
+ * terminators, quotes and escapes are located using memchr(), and each cell is only converted
+ * to a string once, after its extent and any escapes have been resolved.  Raw file data in an
+ * ASCII-compatible encoding can be appended directly using appendData: after setting the
+ * data encoding, avoiding the need to convert the file contents to strings before parsing;
+ * appended strings are converted to the data encoding.
+ *
  * Supports:
  *  - Control of field terminator, line terminator, string enclosures and escape characters.
  *  - Multi-character field terminator, line terminator, string enclosures, and escape strings.
- *  - Stream-based processing (recommended that strings split by \n or \r are used when streaming
- *    to minimise multibyte issues)
+ *  - Stream-based processing, including data split at arbitrary byte positions
  *  - Correct treatment of line terminators within quoted strings and proper escape support
  *    including escape characters matching the quote characters in Excel style
- *
- * The internal usage of string range finding, similar to the NSScanner approach, means this
- * could be significantly sped up for single-character terminators.
  */
 
 #define SPCSVPARSER_TRIM_ENACT_LENGTH 250000
 
+/**
+ * Search state for one of the terminator or quote byte sequences; the position of the last
+ * match found is cached, so that a line end found while looking for the end of the first
+ * field is not searched for again for every subsequent field in the row.
+ */
+typedef struct {
+	NSUInteger foundPosition;
+	NSUInteger searchedToPosition;
+} SPCSVParserSearchState;
+
 @interface SPCSVParser : NSObject
 {
-	NSMutableString *csvString;
+	NSMutableData *csvData;
+	const unsigned char *csvBytes;
+	NSMutableData *cellData;
+	NSStringEncoding dataEncoding;
 
 	NSUInteger trimPosition;
 	NSUInteger parserPosition;
 	NSUInteger totalLengthParsed;
-	NSUInteger csvStringLength;
+	NSUInteger csvDataLength;
 	NSInteger fieldCount;
 
 	NSString *nullReplacementString;
@@ -72,15 +87,32 @@
 	NSString *escapedLineEndString;
 	NSString *escapedFieldQuoteString;
 	NSString *escapedEscapeString;
+
+	NSData *nullReplacementData;
+	NSData *nullMarkerData;
+	NSData *fieldEndData;
+	NSData *lineEndData;
+	NSData *fieldQuoteData;
+	NSData *escapeData;
+	NSData *escapedFieldEndData;
+	NSData *escapedLineEndData;
+	NSData *escapedFieldQuoteData;
+	NSData *escapedEscapeData;
 	NSInteger fieldEndLength;
 	NSInteger lineEndLength;
 	NSInteger fieldQuoteLength;
 	NSInteger escapeLength;
-	NSCharacterSet *skipCharacterSet;
-	NSScanner *csvScanner;
 
+	SPCSVParserSearchState fieldEndSearch;
+	SPCSVParserSearchState lineEndSearch;
+	SPCSVParserSearchState fieldQuoteSearch;
+
+	BOOL skipSpaces;
+	BOOL skipTabs;
 	BOOL escapeStringIsFieldQuoteString;
 	BOOL useStrictEscapeMatching;
+	BOOL dataContainsContent;
+	BOOL dataDecodingFailed;
 }
 
 /* Retrieving data from the CSV string */
@@ -91,12 +123,17 @@
 /* Adding new data to the string */
 - (void) appendString:(NSString *)aString;
 - (void) setString:(NSString *)aString;
+- (void) appendData:(NSData *)someData;
++ (BOOL) canParseDataInEncoding:(NSStringEncoding)anEncoding;
+- (BOOL) setDataEncoding:(NSStringEncoding)anEncoding;
 
 /* Basic information */
 - (NSUInteger) length;
 - (NSString *) string;
 - (NSUInteger) parserPosition;
 - (NSUInteger) totalLengthParsed;
+- (NSStringEncoding) dataEncoding;
+- (BOOL) dataDecodingFailed;
 
 /* Setting the terminator, quote, escape and null character replacement strings */
 - (void) setFieldTerminatorString:(NSString *)theString convertDisplayStrings:(BOOL)convertString;
@@ -109,9 +146,11 @@
 /* Init and internal update methods */
 - (void) _initialiseCSVParserDefaults;
 - (void) _moveParserPastSkippableCharacters;
-- (NSUInteger) _getDistanceToString:(NSString *)theString;
+- (void) _resetSearchStates;
 - (void) _updateState;
 - (NSString *) _convertDisplayString:(NSString *)theString;
+- (NSData *) _dataForString:(NSString *)theString;
+- (void) _updateEncodedStrings;
 - (void) _updateSkipCharacterSet;
 
 /* Initialisation and teardown */
@@ -32,6 +32,23 @@
 
 #import "SPCSVParser.h"
 
+/**
+ * The extent of the cell currently being parsed.  Cells which don't require unescaping
+ * are a single range within the CSV data and are decoded straight from it; other cells are
+ * assembled in the cell buffer.
+ */
+typedef struct {
+	NSUInteger start;
+	NSUInteger length;
+	BOOL buffered;
+} SPCSVParserCell;
+
+static inline NSUInteger _SPCSVParserFindBytes(const unsigned char *bytes, NSUInteger bytesLength, NSUInteger position, const unsigned char *pattern, NSUInteger patternLength);
+static inline NSUInteger _SPCSVParserDistanceToBytes(const unsigned char *bytes, NSUInteger bytesLength, NSUInteger position, const unsigned char *pattern, NSUInteger patternLength, SPCSVParserSearchState *searchState);
+static inline void _SPCSVParserAppendRange(SPCSVParserCell *cell, NSMutableData *buffer, const unsigned char *bytes, NSUInteger start, NSUInteger length);
+static inline void _SPCSVParserAppendBytes(SPCSVParserCell *cell, NSMutableData *buffer, const unsigned char *bytes, const unsigned char *appendBytes, NSUInteger appendLength);
+static void _SPCSVParserReplaceInCell(SPCSVParserCell *cell, NSMutableData *buffer, const unsigned char *bytes, NSData *target, NSData *replacement);
+
 /**
  * Please see the header files for a general description of the purpose of this class.
  */
@@ -53,6 +70,7 @@
 	// Ensure that the full string is being parsed by resetting the parser position
 	parserPosition = trimPosition;
 	totalLengthParsed = 0;
+	[self _resetSearchStates];
 
 	// Loop through the results fetching process
 	while ((csvRowArray = [self getRowAsArrayAndTrimString:NO stringIsComplete:YES]))
@@ -83,223 +101,276 @@
  * mode, and the entire string has not yet been supplied, this should be set to NO; this
  * prevents the final row (possibly without a trailing line terminator) from being returned
  * prematurely.
- * Returns nil if no more rows can be returned.
+ * Returns nil if no more rows can be returned, or if a cell could not be decoded using the
+ * data encoding; in the latter case dataDecodingFailed will return YES.
  */
 - (NSArray *) getRowAsArrayAndTrimString:(BOOL)trimString stringIsComplete:(BOOL)stringComplete
 {
 	NSMutableArray *csvRowArray;
-	NSMutableString *csvCellString = [NSMutableString string];
+	NSString *csvCellString;
+	SPCSVParserCell csvCell;
+	const unsigned char *cellBytes;
+	NSUInteger cellLength;
 	NSUInteger startingParserPosition, nextQuoteDistance, nextFieldEndDistance, nextLineEndDistance;
 	NSInteger skipLength, j;
 	BOOL fieldIsQuoted, isEscaped;
 	BOOL nonStrictEscapeMatchingFallback = NO;
-	BOOL lineEndingEncountered = NO;
+	BOOL lineEndingEncountered;
 
-	if (fieldCount == NSNotFound)
-		csvRowArray = [NSMutableArray array];
-	else
-		csvRowArray = [NSMutableArray arrayWithCapacity:fieldCount];
+	// Cache the terminator bytes for the duration of the row
+	const unsigned char *fieldEndBytes = [fieldEndData bytes];
+	const unsigned char *lineEndBytes = [lineEndData bytes];
+	const unsigned char *fieldQuoteBytes = [fieldQuoteData bytes];
+	const unsigned char *escapeBytes = [escapeData bytes];
 
-	// Store the starting parser position so it can be restored if necessary
-	startingParserPosition = parserPosition;
+	// Loop until a row which isn't empty is found
+	while (1) {
+		lineEndingEncountered = NO;
 
-	// Loop along the CSV string, parsing.
-	while (parserPosition < csvStringLength && !lineEndingEncountered) {
-		[csvCellString setString:@""];
-		fieldIsQuoted = NO;
+		if (fieldCount == NSNotFound)
+			csvRowArray = [NSMutableArray array];
+		else
+			csvRowArray = [NSMutableArray arrayWithCapacity:fieldCount];
 
-		// Skip unescaped, unquoted whitespace where possible
-		[self _moveParserPastSkippableCharacters];
+		// Store the starting parser position so it can be restored if necessary
+		startingParserPosition = parserPosition;
 
-		// Check the start of the string for the quote character, and loop along the string
-		// if so to capture the entire quoted string.
-		if (fieldQuoteLength && parserPosition + fieldQuoteLength <= csvStringLength
-			&& [[csvString substringWithRange:NSMakeRange(parserPosition, fieldQuoteLength)] isEqualToString:fieldQuoteString])
-		{
-			parserPosition += fieldQuoteLength;
-			fieldIsQuoted = YES;
+		// Loop along the CSV data, parsing.
+		while (parserPosition < csvDataLength && !lineEndingEncountered) {
+			fieldIsQuoted = NO;
 
-			while (parserPosition < csvStringLength) {
+			// Skip unescaped, unquoted whitespace where possible
+			[self _moveParserPastSkippableCharacters];
 
-				// Find the next quote string
-				nextQuoteDistance = [self _getDistanceToString:fieldQuoteString];
+			csvCell.start = parserPosition;
+			csvCell.length = 0;
+			csvCell.buffered = NO;
 
-				// Check to see if the quote string encountered was escaped... or an escaper
-				if (escapeLength && nextQuoteDistance != NSNotFound) {
-					j = 1;
-					isEscaped = NO;
-					nonStrictEscapeMatchingFallback = NO;
-					if (!escapeStringIsFieldQuoteString) {
-						while (j * escapeLength <= (NSInteger)nextQuoteDistance
-								&& ([[csvString substringWithRange:NSMakeRange((parserPosition + nextQuoteDistance - (j*escapeLength)), escapeLength)] isEqualToString:escapeString]))
-						{
-							isEscaped = !isEscaped;
-							j++;
-						}
-						skipLength = fieldQuoteLength;
-						if (!useStrictEscapeMatching && !isEscaped) nonStrictEscapeMatchingFallback = YES;
-					}
-					
-					// If the escape string is the field quote string, check for doubled (Excel-style) usage.
-					// Also, if the parser is in loose mode, also support field end strings quoted by using
-					// another field end string, as used by Excel
-					if (escapeStringIsFieldQuoteString || nonStrictEscapeMatchingFallback) {
-						if (parserPosition + nextQuoteDistance + (2 * fieldQuoteLength) <= csvStringLength
-							&& [[csvString substringWithRange:NSMakeRange(parserPosition + nextQuoteDistance + fieldQuoteLength, fieldQuoteLength)] isEqualToString:fieldQuoteString])
-						{
-							isEscaped = YES;
-							skipLength = 2 * fieldQuoteLength;
+			// Check the start of the string for the quote character, and loop along the string
+			// if so to capture the entire quoted string.
+			if (fieldQuoteLength && parserPosition + fieldQuoteLength <= csvDataLength
+				&& !memcmp(csvBytes + parserPosition, fieldQuoteBytes, fieldQuoteLength))
+			{
+				parserPosition += fieldQuoteLength;
+				fieldIsQuoted = YES;
+
+				while (parserPosition < csvDataLength) {
+
+					// Find the next quote string
+					nextQuoteDistance = _SPCSVParserDistanceToBytes(csvBytes, csvDataLength, parserPosition, fieldQuoteBytes, fieldQuoteLength, &fieldQuoteSearch);
+
+					// Check to see if the quote string encountered was escaped... or an escaper
+					if (escapeLength && nextQuoteDistance != NSNotFound) {
+						j = 1;
+						isEscaped = NO;
+						nonStrictEscapeMatchingFallback = NO;
+						if (!escapeStringIsFieldQuoteString) {
+							while (j * escapeLength <= (NSInteger)nextQuoteDistance
+									&& !memcmp(csvBytes + parserPosition + nextQuoteDistance - (j*escapeLength), escapeBytes, escapeLength))
+							{
+								isEscaped = !isEscaped;
+								j++;
+							}
+							skipLength = fieldQuoteLength;
+							if (!useStrictEscapeMatching && !isEscaped) nonStrictEscapeMatchingFallback = YES;
 						}
-					}
 
-					// If it was escaped, keep processing the field.
-					if (isEscaped) {
-						
-						// Append the matched string, together with the field quote character
-						// which has been determined to be within the string - but append the
-						// field end character unescaped to avoid later processing.
+						// If the escape string is the field quote string, check for doubled (Excel-style) usage.
+						// Also, if the parser is in loose mode, also support field end strings quoted by using
+						// another field end string, as used by Excel
 						if (escapeStringIsFieldQuoteString || nonStrictEscapeMatchingFallback) {
-							[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, nextQuoteDistance+fieldQuoteLength)]];
-						} else {
-							[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, nextQuoteDistance - escapeLength)]];
-							[csvCellString appendString:fieldQuoteString];
+							if (parserPosition + nextQuoteDistance + (2 * fieldQuoteLength) <= csvDataLength
+								&& !memcmp(csvBytes + parserPosition + nextQuoteDistance + fieldQuoteLength, fieldQuoteBytes, fieldQuoteLength))
+							{
+								isEscaped = YES;
+								skipLength = 2 * fieldQuoteLength;
+							}
 						}
 
-						// Move the parser location to beyond the field end character[s]
-						parserPosition += nextQuoteDistance + skipLength;
-						continue;
+						// If it was escaped, keep processing the field.
+						if (isEscaped) {
+
+							// Append the matched string, together with the field quote character
+							// which has been determined to be within the string - but append the
+							// field end character unescaped to avoid later processing.
+							if (escapeStringIsFieldQuoteString || nonStrictEscapeMatchingFallback) {
+								_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, nextQuoteDistance + fieldQuoteLength);
+							} else {
+								_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, nextQuoteDistance - escapeLength);
+								_SPCSVParserAppendBytes(&csvCell, cellData, csvBytes, fieldQuoteBytes, fieldQuoteLength);
+							}
+
+							// Move the parser location to beyond the field end character[s]
+							parserPosition += nextQuoteDistance + skipLength;
+							continue;
+						}
 					}
-				}
-				
-				// Add on the scanned string up to the terminating quote character.
-				if (nextQuoteDistance != NSNotFound) {
-					[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, nextQuoteDistance)]];
-					parserPosition += nextQuoteDistance + fieldQuoteLength;
-				} else {
-					[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, csvStringLength - parserPosition)]];
-					parserPosition = csvStringLength;
-				}
 
-				// We should now be at the end of the field - continue on past the quote,
-				// and remove whitespace if possible.
-				if (parserPosition < csvStringLength) {
-					[self _moveParserPastSkippableCharacters];
-				}
+					// Add on the scanned string up to the terminating quote character.
+					if (nextQuoteDistance != NSNotFound) {
+						_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, nextQuoteDistance);
+						parserPosition += nextQuoteDistance + fieldQuoteLength;
+					} else {
+						_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, csvDataLength - parserPosition);
+						parserPosition = csvDataLength;
+					}
 
-				// Break out of the quoted field processing loop.
-				break;
-			}
-		}
+					// We should now be at the end of the field - continue on past the quote,
+					// and remove whitespace if possible.
+					if (parserPosition < csvDataLength) {
+						[self _moveParserPastSkippableCharacters];
+					}
 
-		// With quoted strings processed, now process the field until the next field end
-		// character, or the next line end character, both of which may terminate the current
-		// field.  This also handles unquoted strings/numbers.
-		while (parserPosition < csvStringLength) {
-
-			// Determine whether a line end or a field end occurs first
-			nextFieldEndDistance = [self _getDistanceToString:fieldEndString];
-			nextLineEndDistance = [self _getDistanceToString:lineEndString];
-			if (nextLineEndDistance != NSNotFound
-				&& (nextLineEndDistance < nextFieldEndDistance
-					|| nextFieldEndDistance == NSNotFound))
-			{
-				nextFieldEndDistance = nextLineEndDistance;
-				lineEndingEncountered = YES;
-				skipLength = lineEndLength;
-			} else if (nextFieldEndDistance != NSNotFound) {
-				skipLength = fieldEndLength;
-			} else {
-				[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, csvStringLength - parserPosition)]];
-				parserPosition = csvStringLength;
-				break;
+					// Break out of the quoted field processing loop.
+					break;
+				}
 			}
 
-			// Check to see if the termination character was escaped
-			if (escapeLength) {
-				j = 1;
-				isEscaped = NO;
-				while (j * escapeLength <= (NSInteger)nextFieldEndDistance
-						&& ([[csvString substringWithRange:NSMakeRange((parserPosition + nextFieldEndDistance - (j*escapeLength)), escapeLength)] isEqualToString:escapeString]))
+			// With quoted strings processed, now process the field until the next field end
+			// character, or the next line end character, both of which may terminate the current
+			// field.  This also handles unquoted strings/numbers.
+			while (parserPosition < csvDataLength) {
+
+				// Determine whether a line end or a field end occurs first
+				nextFieldEndDistance = _SPCSVParserDistanceToBytes(csvBytes, csvDataLength, parserPosition, fieldEndBytes, fieldEndLength, &fieldEndSearch);
+				nextLineEndDistance = _SPCSVParserDistanceToBytes(csvBytes, csvDataLength, parserPosition, lineEndBytes, lineEndLength, &lineEndSearch);
+				if (nextLineEndDistance != NSNotFound
+					&& (nextLineEndDistance < nextFieldEndDistance
+						|| nextFieldEndDistance == NSNotFound))
 				{
-					isEscaped = !isEscaped;
-					j++;
+					nextFieldEndDistance = nextLineEndDistance;
+					lineEndingEncountered = YES;
+					skipLength = lineEndLength;
+				} else if (nextFieldEndDistance != NSNotFound) {
+					skipLength = fieldEndLength;
+				} else {
+					_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, csvDataLength - parserPosition);
+					parserPosition = csvDataLength;
+					break;
 				}
 
-				// If it was, continue processing the field
-				if (isEscaped) {
-				
-					// Append the matched string, together with the field/line character
-					// which was encountered - but append the string unescaped to avoid
-					// later processing.
-					[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, nextFieldEndDistance - escapeLength)]];
-					if (lineEndingEncountered) {
-						[csvCellString appendString:lineEndString];
-						lineEndingEncountered = NO;
-					} else {
-						[csvCellString appendString:fieldEndString];
+				// Check to see if the termination character was escaped
+				if (escapeLength) {
+					j = 1;
+					isEscaped = NO;
+					while (j * escapeLength <= (NSInteger)nextFieldEndDistance
+							&& !memcmp(csvBytes + parserPosition + nextFieldEndDistance - (j*escapeLength), escapeBytes, escapeLength))
+					{
+						isEscaped = !isEscaped;
+						j++;
 					}
 
-					// Update the parser location as appropriate
-					parserPosition += nextFieldEndDistance + skipLength;
-					continue;
+					// If it was, continue processing the field
+					if (isEscaped) {
+
+						// Append the matched string, together with the field/line character
+						// which was encountered - but append the string unescaped to avoid
+						// later processing.
+						_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, nextFieldEndDistance - escapeLength);
+						if (lineEndingEncountered) {
+							_SPCSVParserAppendBytes(&csvCell, cellData, csvBytes, lineEndBytes, lineEndLength);
+							lineEndingEncountered = NO;
+						} else {
+							_SPCSVParserAppendBytes(&csvCell, cellData, csvBytes, fieldEndBytes, fieldEndLength);
+						}
+
+						// Update the parser location as appropriate
+						parserPosition += nextFieldEndDistance + skipLength;
+						continue;
+					}
 				}
+
+				// Add on the scanned string up to the terminating character
+				_SPCSVParserAppendRange(&csvCell, cellData, csvBytes, parserPosition, nextFieldEndDistance);
+				parserPosition += nextFieldEndDistance + skipLength;
+
+				break;
 			}
 
-			// Add on the scanned string up to the terminating character
-			[csvCellString appendString:[csvString substringWithRange:NSMakeRange(parserPosition, nextFieldEndDistance)]];
-			parserPosition += nextFieldEndDistance + skipLength;
+			// If the cell ran to the end of the data without a line ending and more data may
+			// follow, the row is incomplete; return nil before decoding, as the cell may end
+			// part-way through a multibyte character.
+			if (parserPosition >= csvDataLength && !lineEndingEncountered && !stringComplete) {
+				parserPosition = startingParserPosition;
+				[self _resetSearchStates];
+				return nil;
+			}
 
-			break;
-		}
+			// We now have the field content.
+			if (csvCell.buffered) {
+				cellBytes = [cellData bytes];
+				cellLength = [cellData length];
+			} else {
+				cellBytes = csvBytes + csvCell.start;
+				cellLength = csvCell.length;
+			}
+
+			// Insert a NSNull object if the cell contains an unescaped null character or
+			// an unquoted string which matches the set null replacement string.
+			if ((cellLength == [nullMarkerData length] && !memcmp(cellBytes, [nullMarkerData bytes], cellLength))
+				|| (!fieldIsQuoted && nullReplacementData && cellLength == [nullReplacementData length] && !memcmp(cellBytes, [nullReplacementData bytes], cellLength)))
+			{
+				[csvRowArray addObject:[NSNull null]];
+				continue;
+			}
 
-		// We now have a field content string.
-		// Insert a NSNull object if the cell contains an unescaped null character or 
-		// an unquoted string which matches the set null replacement string.
-		if ([csvCellString isEqualToString:@"\\N"]
-			|| (!fieldIsQuoted && nullReplacementString && [csvCellString isEqualToString:nullReplacementString]))
-		{
-			[csvRowArray addObject:[NSNull null]];
-		} else {
-				
 			// Clean up escaped characters
 			if (escapeLength) {
 				if (fieldIsQuoted && fieldEndLength)
-					[csvCellString replaceOccurrencesOfString:escapedFieldEndString withString:fieldEndString options:NSLiteralSearch range:NSMakeRange(0, [csvCellString length])];
+					_SPCSVParserReplaceInCell(&csvCell, cellData, csvBytes, escapedFieldEndData, fieldEndData);
 				if (!fieldIsQuoted && fieldQuoteLength)
-					[csvCellString replaceOccurrencesOfString:escapedFieldQuoteString withString:fieldQuoteString options:NSLiteralSearch range:NSMakeRange(0, [csvCellString length])];
+					_SPCSVParserReplaceInCell(&csvCell, cellData, csvBytes, escapedFieldQuoteData, fieldQuoteData);
 				if (fieldIsQuoted && lineEndLength)
-					[csvCellString replaceOccurrencesOfString:escapedLineEndString withString:lineEndString options:NSLiteralSearch range:NSMakeRange(0, [csvCellString length])];
+					_SPCSVParserReplaceInCell(&csvCell, cellData, csvBytes, escapedLineEndData, lineEndData);
 				if (!escapeStringIsFieldQuoteString)
-					[csvCellString replaceOccurrencesOfString:escapedEscapeString withString:escapeString options:NSLiteralSearch range:NSMakeRange(0, [csvCellString length])];
+					_SPCSVParserReplaceInCell(&csvCell, cellData, csvBytes, escapedEscapeData, escapeData);
+				if (csvCell.buffered) {
+					cellBytes = [cellData bytes];
+					cellLength = [cellData length];
+				}
+			}
+
+			// Convert the cell to a string; if the data can't be decoded, restore the parser
+			// position and return nil, so that the caller can report the problem.
+			csvCellString = [[NSString alloc] initWithBytes:cellBytes length:cellLength encoding:dataEncoding];
+			if (!csvCellString) {
+				dataDecodingFailed = YES;
+				parserPosition = startingParserPosition;
+				[self _resetSearchStates];
+				return nil;
 			}
 
 			// Add the field to the row array
-			[csvRowArray addObject:[NSString stringWithString:csvCellString]];
+			[csvRowArray addObject:csvCellString];
+			[csvCellString release];
 		}
-	}
 
-	// If no line ending was encountered, as stringIsComplete is set to NO, return nil
-	// to ensure we don't return a "row" which is incomplete
-	if (!lineEndingEncountered && !stringComplete) {
-		parserPosition = startingParserPosition;
-		return nil;
-	}
+		// If no line ending was encountered, as stringIsComplete is set to NO, return nil
+		// to ensure we don't return a "row" which is incomplete
+		if (!lineEndingEncountered && !stringComplete) {
+			parserPosition = startingParserPosition;
+			[self _resetSearchStates];
+			return nil;
+		}
 
-	// Update the total parsed length (differs from parserPosition following trims)
-	totalLengthParsed += parserPosition - startingParserPosition;
+		// Update the total parsed length (differs from parserPosition following trims)
+		totalLengthParsed += parserPosition - startingParserPosition;
 
-	// Skip empty rows.  Note the NSNull pointer comparison; as [NSNull null] is a singleton this works correctly.
-	if ([csvRowArray count] == 0
-		|| ([csvRowArray count] == 1
-			&& ([csvRowArray objectAtIndex:0] == [NSNull null]
-				|| ![[csvRowArray objectAtIndex:0] length])))
-	{
+		// Skip empty rows.  Note the NSNull pointer comparison; as [NSNull null] is a singleton this works correctly.
+		if ([csvRowArray count] == 0
+			|| ([csvRowArray count] == 1
+				&& ([csvRowArray objectAtIndex:0] == [NSNull null]
+					|| ![[csvRowArray objectAtIndex:0] length])))
+		{
+
+			// If the parser is at the end of the string, return nil
+			if (parserPosition == csvDataLength) return nil;
 
-		// If the parser is at the end of the string, return nil
-		if (parserPosition == csvStringLength) return nil;
+			// Otherwise, retrieve the next row and return that instead
+			continue;
+		}
 
-		// Otherwise, retrieve the next row and return that instead
-		return [self getRowAsArrayAndTrimString:trimString stringIsComplete:stringComplete];
+		break;
 	}
 
 	// Update the string trim state if appropriate, and lazily trigger trims
@@ -326,11 +397,11 @@
 
 /**
  * Append additional data to the CSV string, for example to allow streaming parsing.
+ * The string is converted to the data encoding.
  */
 - (void) appendString:(NSString *)aString
 {
-	[csvString appendString:aString];
-	csvStringLength += [aString length];
+	[self appendData:[aString dataUsingEncoding:dataEncoding allowLossyConversion:YES]];
 }
 
 /**
@@ -339,20 +410,94 @@
 - (void) setString:(NSString *)aString
 {
 	trimPosition = 0;
+	parserPosition = 0;
 	totalLengthParsed = 0;
-	[csvString setString:aString];
-	csvStringLength = [csvString length];
+	dataContainsContent = NO;
+	dataDecodingFailed = NO;
+	[csvData setLength:0];
+	csvBytes = [csvData bytes];
+	csvDataLength = 0;
+	[self _resetSearchStates];
+
+	[self appendString:aString];
+}
+
+/**
+ * Append raw CSV data in the data encoding, for example as read from a file.  Data may be
+ * split at any point, including within multibyte characters; cells are only decoded once
+ * complete.  A UTF-8 byte order mark at the start of the data is skipped.
+ */
+- (void) appendData:(NSData *)someData
+{
+	const unsigned char *appendBytes = [someData bytes];
+	NSUInteger appendLength = [someData length];
+
+	if (!appendLength) return;
+
+	if (!dataContainsContent) {
+		dataContainsContent = YES;
+		if (dataEncoding == NSUTF8StringEncoding && appendLength >= 3
+			&& appendBytes[0] == 0xEF && appendBytes[1] == 0xBB && appendBytes[2] == 0xBF)
+		{
+			appendBytes += 3;
+			appendLength -= 3;
+		}
+	}
+
+	[csvData appendBytes:appendBytes length:appendLength];
+	csvBytes = [csvData bytes];
+	csvDataLength += appendLength;
+}
+
+/**
+ * Returns whether data in the supplied encoding can be parsed directly.  This is the case
+ * for encodings which are supersets of ASCII in which ASCII bytes only ever represent ASCII
+ * characters, so that the terminators can be located without decoding the data; other data
+ * should be decoded and supplied as strings.
+ */
++ (BOOL) canParseDataInEncoding:(NSStringEncoding)anEncoding
+{
+	switch (anEncoding) {
+		case NSUTF8StringEncoding:
+		case NSASCIIStringEncoding:
+		case NSISOLatin1StringEncoding:
+		case NSISOLatin2StringEncoding:
+		case NSWindowsCP1250StringEncoding:
+		case NSWindowsCP1251StringEncoding:
+		case NSWindowsCP1252StringEncoding:
+		case NSWindowsCP1253StringEncoding:
+		case NSWindowsCP1254StringEncoding:
+		case NSMacOSRomanStringEncoding:
+			return YES;
+	}
+
+	return NO;
+}
+
+/**
+ * Set the encoding of the data supplied using appendData:, which defaults to UTF-8.  This
+ * should be set before any data is added.  Returns NO if data in the encoding can't be
+ * parsed directly, leaving the data encoding unchanged.
+ */
+- (BOOL) setDataEncoding:(NSStringEncoding)anEncoding
+{
+	if (![SPCSVParser canParseDataInEncoding:anEncoding]) return NO;
+
+	dataEncoding = anEncoding;
+	[self _updateEncodedStrings];
+
+	return YES;
 }
 
 #pragma mark -
 #pragma mark Basic information
 
 /**
- * Retrieve the string length.
+ * Retrieve the length of the unparsed data, in bytes.
  */
 - (NSUInteger) length
 {
-	return csvStringLength - trimPosition;
+	return csvDataLength - trimPosition;
 }
 
 /**
@@ -360,7 +505,11 @@
  */
 - (NSString *) string
 {
-	return [csvString substringWithRange:NSMakeRange(trimPosition, csvStringLength - trimPosition)];
+	NSString *csvString = [[NSString alloc] initWithBytes:csvBytes + trimPosition length:csvDataLength - trimPosition encoding:dataEncoding];
+
+	if (!csvString) return @"";
+
+	return [csvString autorelease];
 }
 
 /**
@@ -372,14 +521,31 @@
 }
 
 /**
- * Return the total length of CSV parsed so far - differs from the parser position in
- * streaming/trimming situations
+ * Return the total length of CSV parsed so far, in bytes - differs from the parser position
+ * in streaming/trimming situations
  */
 - (NSUInteger) totalLengthParsed
 {
 	return totalLengthParsed;
 }
 
+/**
+ * Return the encoding of the underlying data.
+ */
+- (NSStringEncoding) dataEncoding
+{
+	return dataEncoding;
+}
+
+/**
+ * Returns whether parsing stopped because a cell could not be decoded using the data
+ * encoding.
+ */
+- (BOOL) dataDecodingFailed
+{
+	return dataDecodingFailed;
+}
+
 #pragma mark -
 #pragma mark Setting the terminator, quote, escape and null character replacement strings
 
@@ -396,10 +562,10 @@
 
 	[fieldEndString release];
 	fieldEndString = [[NSString alloc] initWithString:theString];
-	fieldEndLength = [fieldEndString length];
 	[escapedFieldEndString release];
 	escapedFieldEndString = [[NSString alloc] initWithFormat:@"%@%@", escapeString, fieldEndString];
 
+	[self _updateEncodedStrings];
 	[self _updateSkipCharacterSet];
 }
 
@@ -416,10 +582,10 @@
 
 	[lineEndString release];
 	lineEndString = [[NSString alloc] initWithString:theString];
-	lineEndLength = [lineEndString length];
 	[escapedLineEndString release];
 	escapedLineEndString = [[NSString alloc] initWithFormat:@"%@%@", escapeString, lineEndString];
 
+	[self _updateEncodedStrings];
 	[self _updateSkipCharacterSet];
 }
 
@@ -436,11 +602,11 @@
 
 	[fieldQuoteString release];
 	fieldQuoteString = [[NSString alloc] initWithString:theString];
-	fieldQuoteLength = [fieldQuoteString length];
 	[escapedFieldQuoteString release];
 	escapedFieldQuoteString = [[NSString alloc] initWithFormat:@"%@%@", escapeString, fieldQuoteString];
 	escapeStringIsFieldQuoteString = [fieldQuoteString isEqualToString:escapeString];
 
+	[self _updateEncodedStrings];
 	[self _updateSkipCharacterSet];
 }
 
@@ -457,11 +623,11 @@
 
 	[escapeString release];
 	escapeString = [[NSString alloc] initWithString:theString];
-	escapeLength = [escapeString length];
 	[escapedEscapeString release];
 	escapedEscapeString = [[NSString alloc] initWithFormat:@"%@%@", escapeString, escapeString];
 	escapeStringIsFieldQuoteString = [fieldQuoteString isEqualToString:escapeString];
 
+	[self _updateEncodedStrings];
 	[self _updateSkipCharacterSet];
 }
 
@@ -474,6 +640,8 @@
 	if (nullReplacementString) [nullReplacementString release], nullReplacementString = nil;
 
 	if (nullString) nullReplacementString = [[NSString alloc] initWithString:nullString];
+
+	[self _updateEncodedStrings];
 }
 
 /**
@@ -499,7 +667,12 @@
 	fieldCount = NSNotFound;
 	parserPosition = 0;
 	totalLengthParsed = 0;
-	csvStringLength = [csvString length];
+	csvBytes = [csvData bytes];
+	csvDataLength = [csvData length];
+	cellData = [[NSMutableData alloc] init];
+	dataEncoding = NSUTF8StringEncoding;
+	dataContainsContent = NO;
+	dataDecodingFailed = NO;
 
 	// Set up the default field and line separators, together with quote
 	// and escape strings
@@ -513,23 +686,35 @@
 	escapedFieldQuoteString = [[NSString alloc] initWithString:@"\\\""];
 	escapedEscapeString = [[NSString alloc] initWithString:@"\\\\"];
 	useStrictEscapeMatching = NO;
-	fieldEndLength = [fieldEndString length];
-	lineEndLength = [lineEndString length];
-	fieldQuoteLength = [fieldQuoteString length];
-	escapeLength = [escapeString length];
 
 	// Set up the default null replacement character string as nil
 	nullReplacementString = nil;
 
+	// Encode the strings for matching against the data
+	[self _updateEncodedStrings];
+
 	// With the default field and line separators, it's possible to skip
-	// a few characters - reset the character set that can be skipped
-	skipCharacterSet = nil;
+	// a few characters - reset the characters that can be skipped
 	[self _updateSkipCharacterSet];
 }
 
+/**
+ * Forget any cached terminator and quote positions; required whenever the parser position
+ * moves backwards or the data is trimmed.
+ */
+- (void) _resetSearchStates
+{
+	fieldEndSearch.foundPosition = NSNotFound;
+	fieldEndSearch.searchedToPosition = 0;
+	lineEndSearch.foundPosition = NSNotFound;
+	lineEndSearch.searchedToPosition = 0;
+	fieldQuoteSearch.foundPosition = NSNotFound;
+	fieldQuoteSearch.searchedToPosition = 0;
+}
+
 /**
  * Update the string state, enacting trims lazily to trade-off memory usage and the
- * speed hit with constant string updates and NSScanner resets.
+ * speed hit with constant data moves.
  */
 - (void) _updateState
 {
@@ -537,12 +722,14 @@
 	// If the trim position is still before the trim enact point, do nothing.
 	if (trimPosition < SPCSVPARSER_TRIM_ENACT_LENGTH) return;
 
-	// Trim the string
-	[csvString deleteCharactersInRange:NSMakeRange(0, trimPosition)];
+	// Trim the data
+	[csvData replaceBytesInRange:NSMakeRange(0, trimPosition) withBytes:NULL length:0];
+	csvBytes = [csvData bytes];
 
-	// Update the parse position and stored string length
+	// Update the parse position and stored data length
 	parserPosition -= trimPosition;
-	csvStringLength -= trimPosition;
+	csvDataLength -= trimPosition;
+	[self _resetSearchStates];
 
 	// Reset the trim position
 	trimPosition = 0;
@@ -571,39 +758,63 @@
 }
 
 /**
- * Reset the character set that can be skipped when processing the CSV.
- * This is called whenever the delimiters, quotes and escapes are updated.
+ * Returns the supplied string in the data encoding.  A string which can't be represented
+ * in the data encoding is returned as empty data, and so never matches.
  */
-- (void) _updateSkipCharacterSet
+- (NSData *) _dataForString:(NSString *)theString
 {
-	NSMutableString *charactersToSkip;
+	if (!theString) return nil;
 
-	if (skipCharacterSet) [skipCharacterSet release], skipCharacterSet = nil;
+	NSData *encodedString = [theString dataUsingEncoding:dataEncoding allowLossyConversion:NO];
 
-	charactersToSkip = [[NSMutableString alloc] init];
-	if (![fieldEndString isEqualToString:@" "] && ![fieldQuoteString isEqualToString:@" "] && ![escapeString isEqualToString:@" "] && ![lineEndString isEqualToString:@" "])
-		[charactersToSkip appendString:@" "];
-	if (![fieldEndString isEqualToString:@"\t"] && ![fieldQuoteString isEqualToString:@"\t"] && ![escapeString isEqualToString:@"\t"] && ![lineEndString isEqualToString:@"\t"])
-		[charactersToSkip appendString:@"\t"];
+	if (!encodedString) return [NSData data];
 
-	if ([charactersToSkip length])
-		skipCharacterSet = [[NSCharacterSet characterSetWithCharactersInString:charactersToSkip] retain];
-
-	[charactersToSkip release];
+	return encodedString;
 }
 
 /**
- * Get the distance to the next occurence of the specified string, from the current
- * parser location. Returns NSNotFound if the string could not be found before the end
- * of the string.
+ * Update the encoded versions of the terminator, quote, escape and null replacement strings
+ * used to match against the data.  This is called whenever they or the data encoding change.
  */
-- (NSUInteger) _getDistanceToString:(NSString *)theString
+- (void) _updateEncodedStrings
 {
-	NSRange stringRange = [csvString rangeOfString:theString options:NSLiteralSearch range:NSMakeRange(parserPosition, csvStringLength - parserPosition)];
-
-	if (stringRange.location == NSNotFound) return NSNotFound;
+	[nullReplacementData release];
+	nullReplacementData = [[self _dataForString:nullReplacementString] retain];
+	[nullMarkerData release];
+	nullMarkerData = [[self _dataForString:@"\\N"] retain];
+	[fieldEndData release];
+	fieldEndData = [[self _dataForString:fieldEndString] retain];
+	[lineEndData release];
+	lineEndData = [[self _dataForString:lineEndString] retain];
+	[fieldQuoteData release];
+	fieldQuoteData = [[self _dataForString:fieldQuoteString] retain];
+	[escapeData release];
+	escapeData = [[self _dataForString:escapeString] retain];
+	[escapedFieldEndData release];
+	escapedFieldEndData = [[self _dataForString:escapedFieldEndString] retain];
+	[escapedLineEndData release];
+	escapedLineEndData = [[self _dataForString:escapedLineEndString] retain];
+	[escapedFieldQuoteData release];
+	escapedFieldQuoteData = [[self _dataForString:escapedFieldQuoteString] retain];
+	[escapedEscapeData release];
+	escapedEscapeData = [[self _dataForString:escapedEscapeString] retain];
+
+	fieldEndLength = [fieldEndData length];
+	lineEndLength = [lineEndData length];
+	fieldQuoteLength = [fieldQuoteData length];
+	escapeLength = [escapeData length];
+
+	[self _resetSearchStates];
+}
 
-	return stringRange.location - parserPosition;
+/**
+ * Reset the characters that can be skipped when processing the CSV.
+ * This is called whenever the delimiters, quotes and escapes are updated.
+ */
+- (void) _updateSkipCharacterSet
+{
+	skipSpaces = (![fieldEndString isEqualToString:@" "] && ![fieldQuoteString isEqualToString:@" "] && ![escapeString isEqualToString:@" "] && ![lineEndString isEqualToString:@" "]);
+	skipTabs = (![fieldEndString isEqualToString:@"\t"] && ![fieldQuoteString isEqualToString:@"\t"] && ![escapeString isEqualToString:@"\t"] && ![lineEndString isEqualToString:@"\t"]);
 }
 
 /**
@@ -614,14 +825,18 @@
  */ 
 - (void) _moveParserPastSkippableCharacters
 {
-	if (!skipCharacterSet) return;
+	if (!skipSpaces && !skipTabs) return;
 
-	NSInteger i = 0;
-	while (parserPosition + i < csvStringLength) {
-		if (![skipCharacterSet characterIsMember:[csvString characterAtIndex:parserPosition+i]]) break;
-		i++;
+	while (parserPosition < csvDataLength) {
+		if (csvBytes[parserPosition] == ' ') {
+			if (!skipSpaces) break;
+		} else if (csvBytes[parserPosition] == '\t') {
+			if (!skipTabs) break;
+		} else {
+			break;
+		}
+		parserPosition++;
 	}
-	if (i) parserPosition += i;
 }
 
 /**
@@ -631,7 +846,7 @@
 
 - (id) init {
 	if ((self = [super init])) {
-		csvString = [[NSMutableString alloc] init];
+		csvData = [[NSMutableData alloc] init];
 		[self _initialiseCSVParserDefaults];
 	}
 	return self;
@@ -639,20 +854,33 @@
 - (id) initWithString:(NSString *)aString
 {
 	if ((self = [super init])) {
-		csvString = [[NSMutableString alloc] initWithString:aString];
+		csvData = [[NSMutableData alloc] init];
 		[self _initialiseCSVParserDefaults];
+		[self appendString:aString];
 	}
 	return self;
 }
 - (id) initWithContentsOfFile:(NSString *)path encoding:(NSStringEncoding)encoding error:(NSError **)error {
 	if ((self = [super init])) {
-		csvString = [[NSMutableString alloc] initWithContentsOfFile:path encoding:encoding error:error];
+		csvData = [[NSMutableData alloc] init];
 		[self _initialiseCSVParserDefaults];
+
+		// Read the file directly if possible, or otherwise via a string
+		if ([self setDataEncoding:encoding]) {
+			NSData *fileData = [[NSData alloc] initWithContentsOfFile:path options:0 error:error];
+			if (fileData) [self appendData:fileData];
+			[fileData release];
+		} else {
+			NSString *fileString = [[NSString alloc] initWithContentsOfFile:path encoding:encoding error:error];
+			if (fileString) [self appendString:fileString];
+			[fileString release];
+		}
 	}
 	return self;
 }
 - (void) dealloc {
-	[csvString release];
+	[csvData release];
+	[cellData release];
 	[fieldEndString release];
 	[lineEndString release];
 	[fieldQuoteString release];
@@ -662,8 +890,135 @@
 	[escapedFieldQuoteString release];
 	[escapedEscapeString release];
 	if (nullReplacementString) [nullReplacementString release];
-	if (skipCharacterSet) [skipCharacterSet release];
+	if (nullReplacementData) [nullReplacementData release];
+	[nullMarkerData release];
+	[fieldEndData release];
+	[lineEndData release];
+	[fieldQuoteData release];
+	[escapeData release];
+	[escapedFieldEndData release];
+	[escapedLineEndData release];
+	[escapedFieldQuoteData release];
+	[escapedEscapeData release];
 	[super dealloc];
 }
 
 @end
+
+#pragma mark -
+#pragma mark Byte scanning functions
+
+/**
+ * Returns the position of the first occurrence of the pattern at or after the supplied
+ * position, or NSNotFound.  The first byte of the pattern is located using memchr(),
+ * which the system library vectorises, before comparing any remaining bytes.
+ */
+static inline NSUInteger _SPCSVParserFindBytes(const unsigned char *bytes, NSUInteger bytesLength, NSUInteger position, const unsigned char *pattern, NSUInteger patternLength)
+{
+	const unsigned char *match;
+
+	if (!patternLength) return NSNotFound;
+
+	while (position + patternLength <= bytesLength) {
+		match = memchr(bytes + position, pattern[0], bytesLength - patternLength + 1 - position);
+		if (!match) break;
+		position = match - bytes;
+		if (patternLength == 1 || !memcmp(match + 1, pattern + 1, patternLength - 1)) return position;
+		position++;
+	}
+
+	return NSNotFound;
+}
+
+/**
+ * Returns the distance from the supplied position to the next occurrence of the pattern,
+ * or NSNotFound.  The search state records the last match, which is reused while it lies
+ * ahead of the parser, and how far the data is known not to contain a match, so that data
+ * is only scanned once as it is appended.
+ */
+static inline NSUInteger _SPCSVParserDistanceToBytes(const unsigned char *bytes, NSUInteger bytesLength, NSUInteger position, const unsigned char *pattern, NSUInteger patternLength, SPCSVParserSearchState *searchState)
+{
+	NSUInteger matchPosition;
+
+	if (searchState->foundPosition != NSNotFound && searchState->foundPosition >= position) {
+		return searchState->foundPosition - position;
+	}
+
+	matchPosition = _SPCSVParserFindBytes(bytes, bytesLength, MAX(position, searchState->searchedToPosition), pattern, patternLength);
+	searchState->foundPosition = matchPosition;
+
+	if (matchPosition == NSNotFound) {
+		if (bytesLength >= patternLength) searchState->searchedToPosition = MAX(position, bytesLength - patternLength + 1);
+		return NSNotFound;
+	}
+
+	searchState->searchedToPosition = matchPosition;
+	return matchPosition - position;
+}
+
+/**
+ * Append a range of the CSV data to the cell, extending the cell's range where the data is
+ * contiguous and otherwise switching to the cell buffer.
+ */
+static inline void _SPCSVParserAppendRange(SPCSVParserCell *cell, NSMutableData *buffer, const unsigned char *bytes, NSUInteger start, NSUInteger length)
+{
+	if (!cell->buffered) {
+		if (!cell->length) {
+			cell->start = start;
+			cell->length = length;
+			return;
+		}
+		if (cell->start + cell->length == start) {
+			cell->length += length;
+			return;
+		}
+		[buffer setLength:0];
+		[buffer appendBytes:bytes + cell->start length:cell->length];
+		cell->buffered = YES;
+	}
+
+	[buffer appendBytes:bytes + start length:length];
+}
+
+/**
+ * Append bytes from outside the CSV data - an unescaped terminator or quote - to the cell.
+ */
+static inline void _SPCSVParserAppendBytes(SPCSVParserCell *cell, NSMutableData *buffer, const unsigned char *bytes, const unsigned char *appendBytes, NSUInteger appendLength)
+{
+	if (!cell->buffered) {
+		[buffer setLength:0];
+		[buffer appendBytes:bytes + cell->start length:cell->length];
+		cell->buffered = YES;
+	}
+
+	[buffer appendBytes:appendBytes length:appendLength];
+}
+
+/**
+ * Replace all occurrences of the target bytes within the cell, moving the cell into the
+ * cell buffer if any are found.
+ */
+static void _SPCSVParserReplaceInCell(SPCSVParserCell *cell, NSMutableData *buffer, const unsigned char *bytes, NSData *target, NSData *replacement)
+{
+	const unsigned char *cellBytes = cell->buffered ? [buffer bytes] : bytes + cell->start;
+	NSUInteger cellLength = cell->buffered ? [buffer length] : cell->length;
+	const unsigned char *targetBytes = [target bytes];
+	NSUInteger targetLength = [target length];
+	NSUInteger copiedPosition = 0;
+	NSUInteger matchPosition = _SPCSVParserFindBytes(cellBytes, cellLength, 0, targetBytes, targetLength);
+
+	if (matchPosition == NSNotFound) return;
+
+	NSMutableData *replacedCell = [[NSMutableData alloc] initWithCapacity:cellLength];
+	do {
+		[replacedCell appendBytes:cellBytes + copiedPosition length:matchPosition - copiedPosition];
+		[replacedCell appendData:replacement];
+		copiedPosition = matchPosition + targetLength;
+		matchPosition = _SPCSVParserFindBytes(cellBytes, cellLength, copiedPosition, targetBytes, targetLength);
+	} while (matchPosition != NSNotFound);
+	[replacedCell appendBytes:cellBytes + copiedPosition length:cellLength - copiedPosition];
+
+	[buffer setData:replacedCell];
+	[replacedCell release];
+	cell->buffered = YES;
+}
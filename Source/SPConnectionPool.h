@@ -0,0 +1,72 @@
+//
+//  $Id$
+//
+//  SPConnectionPool.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+@class SPDatabaseDocument;
+
+#import <SPMySQL/SPMySQL.h>
+
+/**
+ * A small pool of clones of a document's connection, shared by the helpers which query in
+ * the background - page prefetching, cell fetching, row counting and virtual block loading -
+ * so that they don't each keep a connection open on the server.
+ *
+ * A connection is checked out for each unit of work and checked back in afterwards; when
+ * all the connections are in use, checking out waits for one to be returned.  On checkout
+ * the clone is connected or reconnected as necessary, brought back in line with the encoding
+ * of the parent connection, and switched to the requested database.
+ */
+@interface SPConnectionPool : NSObject <SPMySQLConnectionDelegate>
+{
+	SPDatabaseDocument *delegate;
+	SPMySQLConnection *parentConnection;
+	NSUInteger maximumConnections;
+
+	NSMutableArray *pooledConnections;
+	NSMutableArray *retiredConnections;
+
+	pthread_mutex_t poolLock;
+	pthread_cond_t poolCondition;
+}
+
+// Setup and teardown
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate maximumConnections:(NSUInteger)theMaximumConnections;
+- (void)setConnectionToClone:(SPMySQLConnection *)aConnection;
+- (SPMySQLConnection *)parentConnection;
+- (void)destroy:(NSNotification *)notification;
+
+// Checking connections out and in
+- (SPMySQLConnection *)checkOutConnectionForUser:(id)user database:(NSString *)database;
+- (void)checkInConnection:(SPMySQLConnection *)connection;
+- (void)cancelQueryForUser:(id)user;
+
+@end
@@ -0,0 +1,405 @@
+//
+//  $Id$
+//
+//  SPConnectionPool.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPConnectionPool.h"
+#import "SPDatabaseDocument.h"
+#import "SPConnectionDelegate.h"
+#import "SPMySQLConnectionAdditions.h"
+
+#import <pthread.h>
+
+/**
+ * A connection in the pool, with the database last selected on it and the object it is
+ * checked out to, if any.  The user is a weak reference, only used to find the connection
+ * again to cancel its query.
+ */
+@interface SPPooledConnection : NSObject
+{
+@public
+	SPMySQLConnection *connection;
+	NSString *database;
+	id user;
+}
+
+@end
+
+@interface SPConnectionPool (Private_API)
+
+- (SPPooledConnection *)_pooledConnectionForConnection:(SPMySQLConnection *)connection;
+- (SPPooledConnection *)_pooledConnectionForUser:(id)user;
+- (void)_disconnectPooledConnections:(NSArray *)connections;
+
+@end
+
+#pragma mark -
+
+@implementation SPConnectionPool
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+/**
+ * Prevent SPConnectionPool from being init'd normally.
+ */
+- (id)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"SPConnectionPools should not be init'd directly; use initWithDelegate:maximumConnections: instead."];
+	return nil;
+}
+
+/**
+ * Standard init method, constructing the SPConnectionPool around a delegate which supplies
+ * connection details, and the number of connections which may be open at once.
+ */
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate maximumConnections:(NSUInteger)theMaximumConnections
+{
+	if ((self = [super init])) {
+
+		// Keep a weak reference to the delegate
+		delegate = theDelegate;
+
+		parentConnection = nil;
+		maximumConnections = MAX(theMaximumConnections, 1);
+
+		pooledConnections = [[NSMutableArray alloc] init];
+		retiredConnections = [[NSMutableArray alloc] init];
+
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(destroy:)
+													 name:SPDocumentWillCloseNotification
+												   object:delegate];
+
+		pthread_mutex_init(&poolLock, NULL);
+		pthread_cond_init(&poolCondition, NULL);
+	}
+
+	return self;
+}
+
+/**
+ * Set the connection the pooled connections are cloned from.  Connections cloned from a
+ * previous parent are closed, once returned if they are checked out.
+ */
+- (void)setConnectionToClone:(SPMySQLConnection *)aConnection
+{
+	NSMutableArray *idleConnections = [NSMutableArray array];
+
+	pthread_mutex_lock(&poolLock);
+
+	if (aConnection == parentConnection) {
+		pthread_mutex_unlock(&poolLock);
+		return;
+	}
+
+	if (parentConnection) [parentConnection release];
+	parentConnection = [aConnection retain];
+
+	for (SPPooledConnection *pooledConnection in pooledConnections) {
+		if (pooledConnection->user) {
+			[retiredConnections addObject:pooledConnection];
+		} else {
+			[idleConnections addObject:pooledConnection];
+		}
+	}
+	[pooledConnections removeAllObjects];
+
+	pthread_cond_broadcast(&poolCondition);
+	pthread_mutex_unlock(&poolLock);
+
+	[self _disconnectPooledConnections:idleConnections];
+}
+
+/**
+ * Returns the connection the pooled connections are cloned from.
+ */
+- (SPMySQLConnection *)parentConnection
+{
+	SPMySQLConnection *connection;
+
+	pthread_mutex_lock(&poolLock);
+	connection = [[parentConnection retain] autorelease];
+	pthread_mutex_unlock(&poolLock);
+
+	return connection;
+}
+
+/**
+ * Stop handing out connections, cancel the queries running on any which are checked out,
+ * and close the rest; checked out connections are closed when they are returned.
+ */
+- (void)destroy:(NSNotification *)notification
+{
+	NSMutableArray *idleConnections = [NSMutableArray array];
+
+	pthread_mutex_lock(&poolLock);
+
+	delegate = nil;
+
+	for (SPPooledConnection *pooledConnection in pooledConnections) {
+		if (pooledConnection->user) {
+			[pooledConnection->connection cancelCurrentQuery];
+			[retiredConnections addObject:pooledConnection];
+		} else {
+			[idleConnections addObject:pooledConnection];
+		}
+	}
+	[pooledConnections removeAllObjects];
+
+	pthread_cond_broadcast(&poolCondition);
+	pthread_mutex_unlock(&poolLock);
+
+	[self _disconnectPooledConnections:idleConnections];
+}
+
+#pragma mark -
+#pragma mark Checking connections out and in
+
+/**
+ * Returns a connected clone of the parent connection for the exclusive use of the supplied
+ * object until it is checked back in, using the supplied database if one is given.  Waits
+ * for a connection to be checked in if all are in use.  Returns nil if a connection can't
+ * be made, or the pool has been destroyed.  Should not be called on the main thread.
+ */
+- (SPMySQLConnection *)checkOutConnectionForUser:(id)user database:(NSString *)database
+{
+	SPPooledConnection *pooledConnection = nil;
+	SPMySQLConnection *connection, *theParentConnection;
+	NSString *connectionDatabase;
+	BOOL connectionReady;
+
+	pthread_mutex_lock(&poolLock);
+
+	while (delegate && parentConnection) {
+		for (SPPooledConnection *eachConnection in pooledConnections) {
+			if (!eachConnection->user) {
+				pooledConnection = eachConnection;
+				break;
+			}
+		}
+
+		// Clone another connection if the pool isn't full
+		if (!pooledConnection && [pooledConnections count] < maximumConnections) {
+			pooledConnection = [[[SPPooledConnection alloc] init] autorelease];
+			pooledConnection->connection = [[parentConnection cloneWithDelegate:self] retain];
+			[pooledConnections addObject:pooledConnection];
+		}
+
+		if (pooledConnection) break;
+
+		pthread_cond_wait(&poolCondition, &poolLock);
+	}
+
+	if (!pooledConnection) {
+		pthread_mutex_unlock(&poolLock);
+		return nil;
+	}
+
+	pooledConnection->user = user;
+	connection = [[pooledConnection->connection retain] autorelease];
+	connectionDatabase = [[pooledConnection->database retain] autorelease];
+	theParentConnection = [[parentConnection retain] autorelease];
+
+	pthread_mutex_unlock(&poolLock);
+
+	// The connection is now only used by this caller, so can be set up without the lock held
+	if (![connection isConnected] || ![connection checkConnection]) {
+		connectionDatabase = nil;
+		connectionReady = [connection connectAsCloneOfConnection:theParentConnection];
+	} else {
+		[connection matchEncodingOfConnection:theParentConnection];
+		connectionReady = YES;
+	}
+
+	if (connectionReady && database && ![connectionDatabase isEqualToString:database]) {
+		connectionReady = [connection selectDatabase:database];
+		connectionDatabase = connectionReady ? database : nil;
+	}
+
+	pthread_mutex_lock(&poolLock);
+	if (pooledConnection->database) [pooledConnection->database release];
+	pooledConnection->database = [connectionDatabase copy];
+	pthread_mutex_unlock(&poolLock);
+
+	if (!connectionReady) {
+		[self checkInConnection:connection];
+		return nil;
+	}
+
+	return connection;
+}
+
+/**
+ * Return a connection checked out from the pool, so that it can be used by others.
+ */
+- (void)checkInConnection:(SPMySQLConnection *)connection
+{
+	SPPooledConnection *pooledConnection;
+	BOOL retireConnection = NO;
+
+	if (!connection) return;
+
+	[[connection retain] autorelease];
+
+	pthread_mutex_lock(&poolLock);
+
+	pooledConnection = [[[self _pooledConnectionForConnection:connection] retain] autorelease];
+	if (pooledConnection) {
+		pooledConnection->user = nil;
+		retireConnection = [retiredConnections containsObject:pooledConnection];
+		if (retireConnection) [retiredConnections removeObject:pooledConnection];
+	}
+
+	pthread_cond_broadcast(&poolCondition);
+	pthread_mutex_unlock(&poolLock);
+
+	if (retireConnection) [self _disconnectPooledConnections:[NSArray arrayWithObject:pooledConnection]];
+}
+
+/**
+ * Cancel the query running on the connection checked out to the supplied object, if any.
+ */
+- (void)cancelQueryForUser:(id)user
+{
+	if (!user) return;
+
+	pthread_mutex_lock(&poolLock);
+	SPPooledConnection *pooledConnection = [self _pooledConnectionForUser:user];
+	if (pooledConnection) [pooledConnection->connection cancelCurrentQuery];
+	pthread_mutex_unlock(&poolLock);
+}
+
+#pragma mark -
+#pragma mark SPMySQLConnection delegate methods
+
+/**
+ * Forward keychain password requests to the database object.
+ */
+- (NSString *)keychainPasswordForConnection:(id)connection
+{
+	return [delegate keychainPasswordForConnection:connection];
+}
+
+/**
+ * Log errors the pooled connections would show to the user; their queries run in the
+ * background on the user's behalf, and failures only mean the work is done again in the
+ * foreground, so no alert is shown - which also keeps alerts off background threads.
+ */
+- (void)showErrorWithTitle:(NSString *)title message:(NSString *)message
+{
+	NSLog(@"%@: %@", title, message);
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+
+	[self destroy:nil];
+	[self _disconnectPooledConnections:retiredConnections];
+
+	pthread_mutex_destroy(&poolLock);
+	pthread_cond_destroy(&poolCondition);
+
+	if (parentConnection) [parentConnection release], parentConnection = nil;
+	if (pooledConnections) [pooledConnections release], pooledConnections = nil;
+	if (retiredConnections) [retiredConnections release], retiredConnections = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPConnectionPool (Private_API)
+
+/**
+ * Returns the pool entry for a connection, whether current or retired.  Should be called
+ * with the pool lock held.
+ */
+- (SPPooledConnection *)_pooledConnectionForConnection:(SPMySQLConnection *)connection
+{
+	for (SPPooledConnection *pooledConnection in pooledConnections) {
+		if (pooledConnection->connection == connection) return pooledConnection;
+	}
+	for (SPPooledConnection *pooledConnection in retiredConnections) {
+		if (pooledConnection->connection == connection) return pooledConnection;
+	}
+
+	return nil;
+}
+
+/**
+ * Returns the pool entry for the connection checked out to an object, whether current or
+ * retired.  Should be called with the pool lock held.
+ */
+- (SPPooledConnection *)_pooledConnectionForUser:(id)user
+{
+	for (SPPooledConnection *pooledConnection in pooledConnections) {
+		if (pooledConnection->user == user) return pooledConnection;
+	}
+	for (SPPooledConnection *pooledConnection in retiredConnections) {
+		if (pooledConnection->user == user) return pooledConnection;
+	}
+
+	return nil;
+}
+
+/**
+ * Close the connections of the supplied pool entries, which must no longer be in use.
+ */
+- (void)_disconnectPooledConnections:(NSArray *)connections
+{
+	for (SPPooledConnection *pooledConnection in connections) {
+		[pooledConnection->connection setDelegate:nil];
+		[pooledConnection->connection disconnect];
+	}
+}
+
+@end
+
+#pragma mark -
+
+@implementation SPPooledConnection
+
+- (void)dealloc
+{
+	if (connection) [connection release], connection = nil;
+	if (database) [database release], database = nil;
+
+	[super dealloc];
+}
+
+@end
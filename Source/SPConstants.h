@@ -362,6 +362,7 @@ extern NSString *SPConsoleShowHelps;
 extern NSString *SPEditInSheetEnabled;
 extern NSString *SPTableInformationPanelCollapsed;
 extern NSString *SPTableColumnWidths;
+extern NSString *SPTableColumnAutodetectedWidths;
 extern NSString *SPProcessListTableColumnWidths;
 extern NSString *SPProcessListShowProcessID;
 extern NSString *SPProcessListShowFullProcessList;
@@ -387,6 +388,9 @@ extern NSString *SPCSVImportFieldEscapeCharacter;
 extern NSString *SPCSVImportFirstLineIsHeader;
 extern NSString *SPCSVFieldImportMappingAlignment;
 extern NSString *SPImportClipboardTempFileNamePrefix;
+extern NSString *SPImportSQLReplaysTablesInParallel;
+extern NSString *SPImportUsesBulkLoadMode;
+extern NSString *SPImportBulkLoadBatchesPerTransaction;
 extern NSString *SPSQLExportUseCompression;
 extern NSString *SPNoBOMforSQLdumpFile;
 extern NSString *SPExportLastDirectory;
@@ -411,6 +415,8 @@ extern NSString *SPQueryPrimaryControlRunsAll;
 extern NSString *SPQuickLookTypes;
 extern NSString *SPTableChangedNotification;
 extern NSString *SPTableInfoChangedNotification;
+extern NSString *SPTableRowCountDidFinishNotification;
+extern NSString *SPTableCellFetcherDidFetchNotification;
 extern NSString *SPBlobTextEditorSpellCheckingEnabled;
 extern NSString *SPUniqueSchemaDelimiter;
 extern NSString *SPLastImportIntoNewTableEncoding;
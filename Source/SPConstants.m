@@ -168,6 +168,7 @@ NSString *SPConsoleShowConnections               = @"ConsoleShowConnections";
 NSString *SPEditInSheetEnabled                   = @"EditInSheetEnabled";
 NSString *SPTableInformationPanelCollapsed       = @"TableInformationPanelCollapsed";
 NSString *SPTableColumnWidths                    = @"tableColumnWidths";
+NSString *SPTableColumnAutodetectedWidths        = @"TableColumnAutodetectedWidths";
 NSString *SPProcessListTableColumnWidths         = @"ProcessListTableColumnWidths";
 NSString *SPProcessListShowProcessID             = @"ProcessListShowProcessID";
 NSString *SPProcessListShowFullProcessList       = @"ProcessListShowFullProcessList";
@@ -193,6 +194,9 @@ NSString *SPCSVImportFirstLineIsHeader           = @"CSVImportFirstLineIsHeader"
 NSString *SPCSVImportLineTerminator              = @"CSVImportLineTerminator";
 NSString *SPCSVFieldImportMappingAlignment       = @"CSVFieldImportMappingAlignment";
 NSString *SPImportClipboardTempFileNamePrefix    = @"/tmp/_SP_ClipBoard_Import_File_";
+NSString *SPImportSQLReplaysTablesInParallel     = @"ImportSQLReplaysTablesInParallel";
+NSString *SPImportUsesBulkLoadMode               = @"ImportUsesBulkLoadMode";
+NSString *SPImportBulkLoadBatchesPerTransaction  = @"ImportBulkLoadBatchesPerTransaction";
 NSString *SPSQLExportUseCompression              = @"SQLExportUseCompression";
 NSString *SPNoBOMforSQLdumpFile                  = @"NoBOMforSQLdumpFile";
 NSString *SPExportLastDirectory                  = @"SPExportLastDirectory";
@@ -217,6 +221,8 @@ NSString *SPQueryPrimaryControlRunsAll           = @"QueryPrimaryControlRunsAll"
 NSString *SPQuickLookTypes                       = @"QuickLookTypes";
 NSString *SPTableChangedNotification             = @"SPTableSelectionChanged";
 NSString *SPTableInfoChangedNotification         = @"SPTableInformationChanged";
+NSString *SPTableRowCountDidFinishNotification   = @"SPTableRowCountDidFinish";
+NSString *SPTableCellFetcherDidFetchNotification = @"SPTableCellFetcherDidFetch";
 NSString *SPBlobTextEditorSpellCheckingEnabled   = @"BlobTextEditorSpellCheckingEnabled";
 NSString *SPUniqueSchemaDelimiter                = @"￸"; // U+FFF8
 NSString *SPLastImportIntoNewTableEncoding       = @"LastImportIntoNewTableEncoding";
@@ -75,6 +75,8 @@ extern NSInteger SPEditCopyAsSQL;
 	@abstract   does the work of copying
 	@discussion gets selected (if any) row(s) as a string setting it 
 	   then into th default pasteboard as a string type and tabular text type.
+	   Large selections are formatted in the background as a document task,
+	   using SPTableCopyPipeline, and supplied to the pasteboard on request.
 	@param	  sender who asked for this copy?
 */
 - (void)copy:(id)sender;
@@ -151,13 +153,33 @@ extern NSInteger SPEditCopyAsSQL;
 */
 - (NSDictionary *)autodetectColumnWidths;
 
+/*!
+	@method  autodetectColumnWidthsWithinWidth:
+	@abstract  Autodetect and return column widths based on contents, fitting a width
+	@discussion  As autodetectColumnWidths, but narrowing wide columns to fit within the
+		supplied width, which allows the widths to be detected on a background
+		thread using a width retrieved from availableWidthForColumns on the main thread.
+	@param  The width available to display the columns
+	@result A dictionary - mapped by column identifier - of the column widths to use
+*/
+- (NSDictionary *)autodetectColumnWidthsWithinWidth:(CGFloat)visibleTableWidth;
+
+/*!
+	@method  availableWidthForColumns
+	@abstract  Returns the width available to display the columns without scrolling
+	@discussion  Should be called on the main thread.
+	@result The available width
+*/
+- (CGFloat)availableWidthForColumns;
+
 /*!
 	@method  autodetectWidthForColumnDefinition:maxRows:
 	@abstract  Autodetect and return column width based on contents
 	@discussion  Support autocalculating column width for the represented data.
 		This uses the underlying table storage, and the supplied column definition,
-		iterating through the data and returning a reasonable column width to
-		display that data.
+		measuring the leading rows and a stratified random sample of the rest,
+		and returning a reasonable column width to display that data.  Text
+		widths are summed from glyph advances cached per font where possible.
 		Suitable for calling on background threads, but ensure that the data
 		storage range in use won't be altered while being accessed.
 	@param  A column definition for a represented column; the column to use is derived
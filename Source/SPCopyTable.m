@@ -52,8 +52,11 @@
 #import "SPTablesList.h"
 #import "SPBundleCommandRunner.h"
 #import "SPDatabaseContentViewDelegate.h"
+#import "SPTableCopyPipeline.h"
+#import "SPDatabaseDocument.h"
 
 #import <SPMySQL/SPMySQL.h>
+#import <pthread.h>
 
 NSInteger SPEditMenuCopy            = 2001;
 NSInteger SPEditMenuCopyWithColumns = 2002;
@@ -64,6 +67,98 @@ static const NSInteger kBlobInclude     = 2;
 static const NSInteger kBlobAsFile      = 3;
 static const NSInteger kBlobAsImageFile = 4;
 
+// Selections of at least this many cells are copied in the background
+static const NSUInteger SPCopyTableBackgroundCopyCellCount = 250000;
+
+// Cells which weren't loaded are fetched for this many of the copied rows at a time
+static const NSUInteger SPCopyTableUnloadedFetchRowCount = 1000;
+
+// The first rows are always measured when autodetecting widths, as they are displayed first
+static const NSUInteger SPAutodetectLeadingRows = 20;
+
+// Glyph advances are cached per font in pages of 256 characters
+#define SP_GLYPH_WIDTH_PAGE_SIZE 256
+static const CGFloat SPGlyphWidthMissing = -1;
+
+static NSMutableDictionary *glyphWidthCaches = nil;
+static pthread_mutex_t glyphWidthCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns the advances for a page of characters in a font, filling the page from the font
+ * on first use; characters the font has no glyph for are marked as missing.  Pages are kept
+ * for the lifetime of the application.  Must be called with the cache lock held.
+ */
+static CGFloat *_SPCopyTableGlyphWidthPage(NSMutableData *fontCache, NSFont *font, NSUInteger pageIndex)
+{
+	CGFloat **pages = (CGFloat **)[fontCache mutableBytes];
+
+	if (!pages[pageIndex]) {
+		UniChar characters[SP_GLYPH_WIDTH_PAGE_SIZE];
+		CGGlyph glyphs[SP_GLYPH_WIDTH_PAGE_SIZE];
+		CGSize advances[SP_GLYPH_WIDTH_PAGE_SIZE];
+		CGFloat *page = malloc(SP_GLYPH_WIDTH_PAGE_SIZE * sizeof(CGFloat));
+		NSUInteger i;
+
+		for (i = 0; i < SP_GLYPH_WIDTH_PAGE_SIZE; i++) {
+			characters[i] = (UniChar)(pageIndex * SP_GLYPH_WIDTH_PAGE_SIZE + i);
+		}
+		CTFontGetGlyphsForCharacters((CTFontRef)font, characters, glyphs, SP_GLYPH_WIDTH_PAGE_SIZE);
+		CTFontGetAdvancesForGlyphs((CTFontRef)font, kCTFontDefaultOrientation, glyphs, advances, SP_GLYPH_WIDTH_PAGE_SIZE);
+		for (i = 0; i < SP_GLYPH_WIDTH_PAGE_SIZE; i++) {
+			page[i] = glyphs[i] ? advances[i].width : SPGlyphWidthMissing;
+		}
+
+		pages[pageIndex] = page;
+	}
+
+	return pages[pageIndex];
+}
+
+/**
+ * Returns the width of a line of text as drawn in a font, summing cached glyph advances.
+ * Text containing characters the font can't draw itself, which are drawn using fallback
+ * fonts, is measured in full instead.
+ */
+static CGFloat _SPCopyTableTextWidth(NSString *text, NSFont *font, NSDictionary *textAttributes)
+{
+	UniChar characters[512];
+	NSUInteger i, length = [text length];
+	CGFloat textWidth = 0;
+
+	if (length > 512) return [text sizeWithAttributes:textAttributes].width;
+	[text getCharacters:characters range:NSMakeRange(0, length)];
+
+	NSString *fontKey = [NSString stringWithFormat:@"%@ %f", [font fontName], [font pointSize]];
+
+	pthread_mutex_lock(&glyphWidthCacheLock);
+	if (!glyphWidthCaches) glyphWidthCaches = [[NSMutableDictionary alloc] init];
+	NSMutableData *fontCache = [glyphWidthCaches objectForKey:fontKey];
+	if (!fontCache) {
+		fontCache = [NSMutableData dataWithLength:(65536 / SP_GLYPH_WIDTH_PAGE_SIZE) * sizeof(CGFloat *)];
+		[glyphWidthCaches setObject:fontCache forKey:fontKey];
+	}
+	for (i = 0; i < length; i++) {
+		CGFloat glyphWidth = _SPCopyTableGlyphWidthPage(fontCache, font, characters[i] / SP_GLYPH_WIDTH_PAGE_SIZE)[characters[i] % SP_GLYPH_WIDTH_PAGE_SIZE];
+		if (glyphWidth == SPGlyphWidthMissing) {
+			textWidth = -1;
+			break;
+		}
+		textWidth += glyphWidth;
+	}
+	pthread_mutex_unlock(&glyphWidthCacheLock);
+
+	if (textWidth < 0) return [text sizeWithAttributes:textAttributes].width;
+
+	return textWidth;
+}
+
+@interface SPCopyTable (PrivateAPI)
+
+- (BOOL)_copySelectedRowsInBackgroundAsFormat:(SPTableCopyFormat)copyFormat withHeaders:(BOOL)withHeaders;
+- (id)_unloadedValueForRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex inRows:(NSIndexSet *)rowIndexes fetchedValues:(NSMutableDictionary *)fetchedValues;
+
+@end
+
 @implementation SPCopyTable
 
 /**
@@ -103,6 +198,9 @@ static const NSInteger kBlobAsImageFile = 4;
 #ifndef SP_CODA /* copy table rows */
 	NSString *tmp = nil;
 
+	// Large selections are formatted in the background and offered to the pasteboard lazily
+	if ([self _copySelectedRowsInBackgroundAsFormat:([sender tag] == SPEditCopyAsSQL) ? SPTableCopySQLFormat : SPTableCopyTabFormat withHeaders:([sender tag] == SPEditMenuCopyWithColumns)]) return;
+
 	if ([sender tag] == SPEditCopyAsSQL) {
 		tmp = [self rowsAsSqlInsertsOnlySelectedRows:YES];
 		
@@ -129,6 +227,83 @@ static const NSInteger kBlobAsImageFile = 4;
 #endif
 }
 
+#ifndef SP_CODA /* copy table rows in background */
+/**
+ * Start copying the selected rows in the background if the selection is large, returning
+ * whether the copy was started.  Smaller selections, copies made while the document is
+ * busy, and copies which would need unloaded values fetched are copied directly.
+ * Virtual storage is also copied directly, as most of its rows aren't held locally.
+ */
+- (BOOL)_copySelectedRowsInBackgroundAsFormat:(SPTableCopyFormat)copyFormat withHeaders:(BOOL)withHeaders
+{
+	NSArray *columns = [self tableColumns];
+	NSUInteger c, numColumns = [columns count];
+	id contentDelegate = [self delegate];
+
+	if ([self numberOfSelectedRows] * numColumns < SPCopyTableBackgroundCopyCellCount) return NO;
+	if (![contentDelegate isKindOfClass:[SPTableContent class]] && ![contentDelegate isKindOfClass:[SPCustomQuery class]]) return NO;
+	if (!tableStorage || [tableStorage isVirtual]) return NO;
+
+	if ([contentDelegate isKindOfClass:[SPTableContent class]]
+		&& [prefs boolForKey:SPLoadBlobsAsNeeded]
+		&& [(SPTableContent *)contentDelegate tableContainsBlobOrTextColumns])
+	{
+		return NO;
+	}
+
+	SPDatabaseDocument *document = [(NSObject *)contentDelegate valueForKeyPath:@"tableDocumentInstance"];
+	if (!document || [document isWorking]) return NO;
+
+	NSMutableArray *columnNames = [NSMutableArray arrayWithCapacity:numColumns];
+	NSUInteger *columnMappings = malloc(numColumns * sizeof(NSUInteger));
+	for (c = 0; c < numColumns; c++) {
+		columnMappings[c] = (NSUInteger)[[NSArrayObjectAtIndex(columns, c) identifier] integerValue];
+		[columnNames addObject:[[NSArrayObjectAtIndex(columns, c) headerCell] stringValue]];
+	}
+
+	SPTableCopyPipeline *copyPipeline = [[SPTableCopyPipeline alloc] initWithFormat:copyFormat tableStorage:tableStorage rowIndexes:[self selectedRowIndexes] columnNames:columnNames columnMappings:columnMappings columnDefinitions:columnDefinitions];
+	free(columnMappings);
+
+	[copyPipeline setIncludesHeaders:withHeaders];
+	[copyPipeline setTableName:selectedTable];
+	[copyPipeline setNullString:[prefs objectForKey:SPNullValue]];
+	[copyPipeline setStringEncoding:[mySQLConnection stringEncoding]];
+	[copyPipeline startCopyingForDocument:document];
+	[copyPipeline release];
+
+	return YES;
+}
+#endif
+
+/**
+ * Returns the value of a cell which wasn't loaded with its row, or nil if it can't be
+ * fetched.  The column is fetched by key for a batch of the supplied rows at a time,
+ * starting at the requested row, and the latest batch of each column is kept in the
+ * supplied dictionary for the following rows.
+ */
+- (id)_unloadedValueForRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex inRows:(NSIndexSet *)rowIndexes fetchedValues:(NSMutableDictionary *)fetchedValues
+{
+	if (![[self delegate] isKindOfClass:[SPTableContent class]]) return nil;
+
+	NSNumber *columnNumber = [NSNumber numberWithUnsignedInteger:columnIndex];
+	NSArray *fetchedBatch = [fetchedValues objectForKey:columnNumber];
+
+	if (!fetchedBatch || ![[fetchedBatch objectAtIndex:0] containsIndex:rowIndex]) {
+		NSMutableIndexSet *batchRows = [NSMutableIndexSet indexSet];
+		NSUInteger batchRow = rowIndex;
+
+		while (batchRow != NSNotFound && [batchRows count] < SPCopyTableUnloadedFetchRowCount) {
+			[batchRows addIndex:batchRow];
+			batchRow = [rowIndexes indexGreaterThanIndex:batchRow];
+		}
+
+		fetchedBatch = [NSArray arrayWithObjects:batchRows, [tableInstance valuesForUnloadedColumn:columnIndex inRows:batchRows], nil];
+		[fetchedValues setObject:fetchedBatch forKey:columnNumber];
+	}
+
+	return [[fetchedBatch objectAtIndex:1] objectForKey:[NSNumber numberWithUnsignedInteger:rowIndex]];
+}
+
 #ifdef SP_CODA
 
 - (void)delete:(id)sender
@@ -188,11 +363,18 @@ static const NSInteger kBlobAsImageFile = 4;
 		[fm createDirectoryAtPath:tmpBlobFileDirectory withIntermediateDirectories:YES attributes:nil error:nil];
 	}
 
+	NSMutableDictionary *fetchedValues = [NSMutableDictionary dictionary];
 	while ( rowIndex != NSNotFound )
 	{
 		for ( c = 0; c < numColumns; c++ ) {
 			cellData = SPDataStorageObjectAtRowAndColumn(tableStorage, rowIndex, columnMappings[c]);
 
+			// Cells which weren't loaded with their rows are fetched by key, a batch of rows at a time
+			if ([cellData isSPNotLoaded]) {
+				id fetchedData = [self _unloadedValueForRow:rowIndex column:columnMappings[c] inRows:selectedRows fetchedValues:fetchedValues];
+				if (fetchedData) cellData = fetchedData;
+			}
+
 			// Copy the shown representation of the cell - custom NULL display strings, (not loaded),
 			// definable representation of any blobs or binary texts.
 			if (cellData) {
@@ -327,11 +509,18 @@ static const NSInteger kBlobAsImageFile = 4;
 		[fm createDirectoryAtPath:tmpBlobFileDirectory withIntermediateDirectories:YES attributes:nil error:nil];
 	}
 
+	NSMutableDictionary *fetchedValues = [NSMutableDictionary dictionary];
 	while ( rowIndex != NSNotFound )
 	{
 		for ( c = 0; c < numColumns; c++ ) {
 			cellData = SPDataStorageObjectAtRowAndColumn(tableStorage, rowIndex, columnMappings[c]);
 
+			// Cells which weren't loaded with their rows are fetched by key, a batch of rows at a time
+			if ([cellData isSPNotLoaded]) {
+				id fetchedData = [self _unloadedValueForRow:rowIndex column:columnMappings[c] inRows:selectedRows fetchedValues:fetchedValues];
+				if (fetchedData) cellData = fetchedData;
+			}
+
 			// Copy the shown representation of the cell - custom NULL display strings, (not loaded),
 			// definable representation of any blobs or binary texts.
 			if (cellData) {
@@ -482,6 +671,7 @@ static const NSInteger kBlobAsImageFile = 4;
 	Class spTableContentClass = [SPTableContent class];
 	Class nsDataClass = [NSData class];
 	
+	NSMutableDictionary *fetchedValues = [NSMutableDictionary dictionary];
 	while (rowIndex != NSNotFound)
 	{
 		[value appendString:@"\t("];
@@ -493,7 +683,13 @@ static const NSInteger kBlobAsImageFile = 4;
 		{
 			cellData = SPDataStorageObjectAtRowAndColumn(tableStorage, rowIndex, columnMappings[c]);
 
-			// If the data is not loaded, attempt to fetch the value
+			// Cells which weren't loaded with their rows are fetched by key, a batch of rows at a time
+			if ([cellData isSPNotLoaded]) {
+				id fetchedData = [self _unloadedValueForRow:rowIndex column:columnMappings[c] inRows:selectedRows fetchedValues:fetchedValues];
+				if (fetchedData) cellData = fetchedData;
+			}
+
+			// If the data could not be fetched by key, attempt to fetch the value for the row alone
 			if ([cellData isSPNotLoaded] && [[self delegate] isKindOfClass:spTableContentClass]) {
 
 				// Abort if no table name given, not table content, or if there are no indices on this table
@@ -505,7 +701,6 @@ static const NSInteger kBlobAsImageFile = 4;
 				}
 
 				// Use the argumentForRow to retrieve the missing information
-				// TODO - this could be preloaded for all selected rows rather than cell-by-cell
 				cellData = [mySQLConnection getFirstFieldFromQuery:
 							[NSString stringWithFormat:@"SELECT %@ FROM %@ WHERE %@",
 								[NSArrayObjectAtIndex(tbHeader, columnMappings[c]) backtickQuotedString],
@@ -638,11 +833,18 @@ static const NSInteger kBlobAsImageFile = 4;
 	Class nsDataClass = [NSData class];
 	Class spmysqlGeometryData = [SPMySQLGeometryData class];
 	NSStringEncoding connectionEncoding = [mySQLConnection stringEncoding];
+	NSMutableDictionary *fetchedValues = [NSMutableDictionary dictionary];
 	while ( rowIndex != NSNotFound )
 	{
 		for ( c = 0; c < numColumns; c++ ) {
 			cellData = SPDataStorageObjectAtRowAndColumn(tableStorage, rowIndex, columnMappings[c]);
 
+			// Cells which weren't loaded with their rows are fetched by key, a batch of rows at a time
+			if ([cellData isSPNotLoaded]) {
+				id fetchedData = [self _unloadedValueForRow:rowIndex column:columnMappings[c] inRows:selectedRows fetchedValues:fetchedValues];
+				if (fetchedData) cellData = fetchedData;
+			}
+
 			// Copy the shown representation of the cell - custom NULL display strings, (not loaded),
 			// and the string representation of any blobs or binary texts.
 			if (cellData) {
@@ -717,15 +919,31 @@ static const NSInteger kBlobAsImageFile = 4;
  * Autodetect column widths for a specified font.
  */
 - (NSDictionary *) autodetectColumnWidths
+{
+	return [self autodetectColumnWidthsWithinWidth:[self availableWidthForColumns]];
+}
+
+/**
+ * Returns the width available to display all the columns without scrolling.
+ * Should be called on the main thread.
+ */
+- (CGFloat) availableWidthForColumns
+{
+	NSScrollView *parentScrollView = (NSScrollView*)[[self superview] superview];
+
+	return [parentScrollView bounds].size.width - [NSScroller scrollerWidth] - [columnDefinitions count] * 3.5f;
+}
+
+/**
+ * Autodetect column widths for a specified font, narrowing wide columns to fit within the
+ * supplied width where possible.
+ */
+- (NSDictionary *) autodetectColumnWidthsWithinWidth:(CGFloat)visibleTableWidth
 {
 	NSMutableDictionary *columnWidths = [NSMutableDictionary dictionaryWithCapacity:[columnDefinitions count]];
 	NSUInteger columnWidth;
 	NSUInteger allColumnWidths = 0;
 
-	// Determine the available size
-	NSScrollView *parentScrollView = (NSScrollView*)[[self superview] superview];
- 	CGFloat visibleTableWidth = [parentScrollView bounds].size.width - [NSScroller scrollerWidth] - [columnDefinitions count] * 3.5f;
-
 	for (NSDictionary *columnDefinition in columnDefinitions) {
 		if ([[NSThread currentThread] isCancelled]) return nil;
 
@@ -772,9 +990,8 @@ static const NSInteger kBlobAsImageFile = 4;
 {
 	CGFloat columnBaseWidth;
 	id contentString;
-	NSUInteger cellWidth, maxCellWidth, i;
+	NSUInteger cellWidth, maxCellWidth, i, rowCount, sampleCount;
 	NSRange linebreakRange;
-	double rowStep;
 	unichar breakChar;
 #ifndef SP_CODA /* patch */
 	NSFont *tableFont = [NSUnarchiver unarchiveObjectWithData:[prefs dataForKey:SPGlobalResultTableFont]];
@@ -785,20 +1002,41 @@ static const NSInteger kBlobAsImageFile = 4;
 	NSDictionary *stringAttributes = [NSDictionary dictionaryWithObject:tableFont forKey:NSFontAttributeName];
 	Class spmysqlGeometryData = [SPMySQLGeometryData class];
 
-	// Check the number of rows available to check, sampling every n rows
-	if ([tableStorage count] < rowsToCheck)
-		rowStep = 1;
-	else
-		rowStep = floorf([tableStorage count] / rowsToCheck);
-
-	rowsToCheck = [tableStorage count];
+	BOOL storageIsVirtual = [tableStorage isVirtual];
+
+	// Choose the rows to check.  If there are more rows than are to be checked, the leading
+	// rows are checked, as they are displayed first, and then one row chosen at random from
+	// each of a series of equal strata covering the remaining rows, so that the sample is
+	// spread evenly through the data without following any periodic pattern in it.
+	rowCount = [tableStorage count];
+	sampleCount = MIN(rowCount, rowsToCheck);
+	NSUInteger *sampleRows = malloc((sampleCount ? sampleCount : 1) * sizeof(NSUInteger));
+	if (rowCount <= rowsToCheck) {
+		for (i = 0; i < sampleCount; i++) sampleRows[i] = i;
+	} else {
+		NSUInteger leadingRows = MIN(SPAutodetectLeadingRows, sampleCount / 2);
+		NSUInteger strataCount = sampleCount - leadingRows;
+		double stratumSize = (double)(rowCount - leadingRows) / strataCount;
+		for (i = 0; i < leadingRows; i++) sampleRows[i] = i;
+		for (i = 0; i < strataCount; i++) {
+			NSUInteger stratumStart = leadingRows + (NSUInteger)(i * stratumSize);
+			NSUInteger stratumEnd = leadingRows + (NSUInteger)((i + 1) * stratumSize);
+			if (stratumEnd > rowCount) stratumEnd = rowCount;
+			sampleRows[leadingRows + i] = stratumStart + ((stratumEnd > stratumStart) ? arc4random() % (stratumEnd - stratumStart) : 0);
+		}
+	}
 
 	// Set a default padding for this column
 	columnBaseWidth = 24;
 
-	// Iterate through the data store rows, checking widths
+	// Iterate through the sampled rows, checking widths
 	maxCellWidth = 0;
-	for (i = 0; i < rowsToCheck; i += rowStep) {
+	for (NSUInteger sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++) {
+		i = sampleRows[sampleIndex];
+
+		// Skip rows of virtual storage which haven't been fetched
+		if (storageIsVirtual && ![tableStorage virtualRowIsLoaded:i])
+			continue;
 
 		// Retrieve part of the cell's content to get widths, topping out at a maximum length
 		contentString =	SPDataStoragePreviewAtRowAndColumn(tableStorage, i, columnIndex, 500);
@@ -852,7 +1090,7 @@ static const NSInteger kBlobAsImageFile = 4;
 		}
 
 		// Calculate the width, using it if it's higher than the current stored width
-		cellWidth = [contentString sizeWithAttributes:stringAttributes].width;
+		cellWidth = _SPCopyTableTextWidth(contentString, tableFont, stringAttributes);
 		if (cellWidth > maxCellWidth) maxCellWidth = cellWidth;
 		if (maxCellWidth > SP_MAX_CELL_WIDTH) {
 			maxCellWidth = SP_MAX_CELL_WIDTH;
@@ -860,6 +1098,8 @@ static const NSInteger kBlobAsImageFile = 4;
 		}
 	}
 
+	free(sampleRows);
+
 	// If the column has a foreign key link, expand the width; and also for enums
 	if ([columnDefinition objectForKey:@"foreignkeyreference"]) {
 		maxCellWidth += 18;
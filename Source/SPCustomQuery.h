@@ -177,6 +177,11 @@
 	BOOL isFieldEditable;
 	BOOL textViewWasChanged;
 	NSNumber *sortField;
+	NSMutableArray *additionalSortFields;
+	NSMutableArray *additionalSortDescending;
+	BOOL resultIsServerSorted;
+	BOOL resultIsSortedLocally;
+	NSUInteger columnSizingGeneration;
 
 	NSIndexSet *selectionIndexToRestore;
 	NSRect selectionViewportToRestore;
@@ -51,6 +51,7 @@
 #import "SPQueryDocumentsController.h"
 #import "SPEncodingPopupAccessory.h"
 #import "SPDataStorage.h"
+#import "SPDataStorageSorting.h"
 #import "SPAlertSheets.h"
 #import "SPCopyTable.h"
 #import "SPGeometryDataView.h"
@@ -71,6 +72,10 @@
 
 - (id)_resultDataItemAtRow:(NSInteger)row columnIndex:(NSUInteger)column preserveNULLs:(BOOL)preserveNULLs asPreview:(BOOL)asPreview;
 + (NSString *)linkToHelpTopic:(NSString *)aTopic;
+- (void)_resetSortOrder;
+- (BOOL)_sortResultDataLocally;
+- (void)_autosizeColumnsTask:(NSDictionary *)sizingDetails;
+- (void)_applyAutodetectedColumnWidths:(NSDictionary *)columnWidths generation:(NSNumber *)generation;
 
 @end
 
@@ -141,9 +146,7 @@
 	}
 
 	// Re-init sort order
-	isDesc = NO;
-	sortColumn = nil;
-	if(sortField) [sortField release], sortField = nil;
+	[self _resetSortOrder];
 
 	// Retrieve the custom query string and split it into separate SQL queries
 	queryParser = [[SPSQLParser alloc] initWithString:[textView string]];
@@ -185,9 +188,7 @@
 	if ([tableDocumentInstance isWorking]) return;
 
 	// Re-init sort order
-	isDesc = NO;
-	sortColumn = nil;
-	if(sortField) [sortField release], sortField = nil;
+	[self _resetSortOrder];
 
 	// If the current selection is a single caret position, run the current query.
 	if (selectedRange.length == 0) {
@@ -679,8 +680,11 @@
 				}
 			}
 
-			// Init copyTable with necessary information for copying selected rows as SQL INSERT
+			// Init copyTable with necessary information for copying selected rows as SQL INSERT; the
+			// lock keeps the columns consistent with the rows for any column sizing in progress
+			pthread_mutex_lock(&resultDataLock);
 			[customQueryView setTableInstance:self withTableData:resultData withColumns:cqColumnDefinition withTableName:resultTableName withConnection:mySQLConnection];
+			pthread_mutex_unlock(&resultDataLock);
 
 			[self updateResultStore:resultStore];
 		} else {
@@ -971,6 +975,11 @@
 	}
 	[resultLoadingCondition unlock];
 
+	// If reloading a result which had been sorted in memory, sort the new rows the same way
+	if (reloadingExistingResult && resultIsSortedLocally && ![self _sortResultDataLocally]) {
+		resultIsSortedLocally = NO;
+	}
+
 	// If the final column autoresize wasn't performed, perform it
 	if (queryLoadLastRowCount < 200) [[self onMainThread] autosizeColumns];
 
@@ -1755,14 +1764,51 @@
 }
 
 /**
- * Autosize all columns based on their content.
+ * Autosize all columns based on their content.  The widths are detected on a background
+ * thread, and applied once ready.
  * Should be called on the main thread.
  */
 - (void)autosizeColumns
 {
-	if (isWorking) pthread_mutex_lock(&resultDataLock);
-	NSDictionary *columnWidths = [customQueryView autodetectColumnWidths];
-	if (isWorking) pthread_mutex_unlock(&resultDataLock);
+	// Supersede any detection still running
+	columnSizingGeneration++;
+
+	NSDictionary *sizingDetails = [NSDictionary dictionaryWithObjectsAndKeys:
+		[NSNumber numberWithUnsignedInteger:columnSizingGeneration], @"generation",
+		[NSNumber numberWithDouble:[customQueryView availableWidthForColumns]], @"availableWidth",
+		nil];
+
+	[NSThread detachNewThreadWithName:@"SPCustomQuery column autosizing task" target:self selector:@selector(_autosizeColumnsTask:) object:sizingDetails];
+}
+
+/**
+ * Detect the column widths from the loaded rows, then apply them on the main thread.
+ * Should be called on a background thread.
+ */
+- (void)_autosizeColumnsTask:(NSDictionary *)sizingDetails
+{
+	NSAutoreleasePool *sizingPool = [[NSAutoreleasePool alloc] init];
+
+	pthread_mutex_lock(&resultDataLock);
+	NSDictionary *columnWidths = [customQueryView autodetectColumnWidthsWithinWidth:[[sizingDetails objectForKey:@"availableWidth"] doubleValue]];
+	pthread_mutex_unlock(&resultDataLock);
+
+	if (columnWidths) {
+		[[self onMainThread] _applyAutodetectedColumnWidths:columnWidths generation:[sizingDetails objectForKey:@"generation"]];
+	}
+
+	[sizingPool drain];
+}
+
+/**
+ * Set the widths of the columns, unless the widths are for an earlier request, skipping
+ * columns the user has set widths for.
+ * Should be called on the main thread.
+ */
+- (void)_applyAutodetectedColumnWidths:(NSDictionary *)columnWidths generation:(NSNumber *)generation
+{
+	if ([generation unsignedIntegerValue] != columnSizingGeneration) return;
+
 	[customQueryView setDelegate:nil];
 	for (NSDictionary *columnDefinition in cqColumnDefinition) {
 
@@ -1774,7 +1820,7 @@
 		// Otherwise set the column width
 		NSTableColumn *aTableColumn = [customQueryView tableColumnWithIdentifier:[columnDefinition objectForKey:@"datacolumnindex"]];
 		NSUInteger targetWidth = [[columnWidths objectForKey:[columnDefinition objectForKey:@"datacolumnindex"]] integerValue];
-		[aTableColumn setWidth:targetWidth];
+		if (targetWidth) [aTableColumn setWidth:targetWidth];
 	}
 	
 	[customQueryView setDelegate:self];
@@ -2127,46 +2173,88 @@
 	if (!cqColumnDefinition || ![cqColumnDefinition count]) return;
 
 	NSMutableString *queryString = [NSMutableString stringWithString:lastExecutedQuery];
+	NSNumber *clickedField = [NSNumber numberWithInteger:[[tableColumn identifier] integerValue]];
+	NSUInteger i;
 
-	// Sets column order as tri-state descending, ascending, no sort, descending, ascending etc. order if the same
-	// header is clicked several times
-	if (sortField && [[tableColumn identifier] integerValue] == [sortField integerValue]) {
-		if(isDesc) {
-			[sortField release];
-			sortField = nil;
+	// Shift-clicking a further column while a sort is active adds it as a secondary sort key,
+	// or toggles its direction if it's already part of the sort
+	if (sortField && ![clickedField isEqualToNumber:sortField] && ([[NSApp currentEvent] modifierFlags] & NSShiftKeyMask)) {
+		NSUInteger existingIndex = [additionalSortFields indexOfObject:clickedField];
+		BOOL fieldIsDesc = NO;
+		if (existingIndex == NSNotFound) {
+			[additionalSortFields addObject:clickedField];
+			[additionalSortDescending addObject:[NSNumber numberWithBool:NO]];
 		} else {
+			fieldIsDesc = ![[additionalSortDescending objectAtIndex:existingIndex] boolValue];
+			[additionalSortDescending replaceObjectAtIndex:existingIndex withObject:[NSNumber numberWithBool:fieldIsDesc]];
+		}
+		[[customQueryView onMainThread] setIndicatorImage:[NSImage imageNamed:(fieldIsDesc ? @"NSDescendingSortIndicator" : @"NSAscendingSortIndicator")] inTableColumn:tableColumn];
+	} else {
+
+		// Any plain click discards secondary sort keys
+		for (NSNumber *eachField in additionalSortFields) {
+			[[customQueryView onMainThread] setIndicatorImage:nil inTableColumn:[customQueryView tableColumnWithIdentifier:[eachField stringValue]]];
+		}
+		[additionalSortFields removeAllObjects];
+		[additionalSortDescending removeAllObjects];
+
+		// Sets column order as tri-state descending, ascending, no sort, descending, ascending etc. order if the same
+		// header is clicked several times
+		if (sortField && [[tableColumn identifier] integerValue] == [sortField integerValue]) {
+			if(isDesc) {
+				[sortField release];
+				sortField = nil;
+			} else {
+				if (sortField) [sortField release];
+				sortField = [[NSNumber alloc] initWithInteger:[[tableColumn identifier] integerValue]];
+				isDesc = !isDesc;
+			}
+		} else {
+			isDesc = NO;
+			[[customQueryView onMainThread] setIndicatorImage:nil inTableColumn:[customQueryView tableColumnWithIdentifier:[NSString stringWithFormat:@"%lld", (long long)[sortField integerValue]]]];
 			if (sortField) [sortField release];
 			sortField = [[NSNumber alloc] initWithInteger:[[tableColumn identifier] integerValue]];
-			isDesc = !isDesc;
 		}
-	} else {
-		isDesc = NO;
-		[[customQueryView onMainThread] setIndicatorImage:nil inTableColumn:[customQueryView tableColumnWithIdentifier:[NSString stringWithFormat:@"%lld", (long long)[sortField integerValue]]]];
-		if (sortField) [sortField release];
-		sortField = [[NSNumber alloc] initWithInteger:[[tableColumn identifier] integerValue]];
+
+		if(sortField) {
+			// Set the highlight and indicatorImage
+			[[customQueryView onMainThread] setHighlightedTableColumn:tableColumn];
+			if (isDesc) {
+				[[customQueryView onMainThread] setIndicatorImage:[NSImage imageNamed:@"NSDescendingSortIndicator"] inTableColumn:tableColumn];
+			} else {
+				[[customQueryView onMainThread] setIndicatorImage:[NSImage imageNamed:@"NSAscendingSortIndicator"] inTableColumn:tableColumn];
+			}
+		} else {
+			// If no sort order deselect column header and
+			// remove indicator image
+			[[customQueryView onMainThread] setHighlightedTableColumn:nil];
+			[[customQueryView onMainThread] setIndicatorImage:nil inTableColumn:tableColumn];
+		}
 	}
 
-	if(sortField) {
-		// Set the highlight and indicatorImage
-		[[customQueryView onMainThread] setHighlightedTableColumn:tableColumn];
-		if (isDesc) {
-			[[customQueryView onMainThread] setIndicatorImage:[NSImage imageNamed:@"NSDescendingSortIndicator"] inTableColumn:tableColumn];
+	// If the whole result is already in memory, reorder it locally instead of re-running the query
+	if ([self _sortResultDataLocally]) {
+		if (sortField) {
+			sortColumn = [customQueryView tableColumnWithIdentifier:[sortField stringValue]];
 		} else {
-			[[customQueryView onMainThread] setIndicatorImage:[NSImage imageNamed:@"NSAscendingSortIndicator"] inTableColumn:tableColumn];
+			sortColumn = nil;
 		}
-	} else {
-		// If no sort order deselect column header and
-		// remove indicator image
-		[[customQueryView onMainThread] setHighlightedTableColumn:nil];
-		[[customQueryView onMainThread] setIndicatorImage:nil inTableColumn:tableColumn];
+		[customQueryView deselectAll:self];
+		[customQueryView reloadData];
+		return;
 	}
 
 	// Order by the column position number to avoid ambiguous name errors if any
-	NSString* newOrder;
-	if(sortField)
-		newOrder = [NSString stringWithFormat:@" ORDER BY %ld %@ ", (long)([[tableColumn identifier] integerValue]+1), (isDesc)?@"DESC":@"ASC"];
-	else
-		newOrder = @"";
+	NSMutableString *newOrder = [NSMutableString string];
+	if (sortField) {
+		[newOrder appendFormat:@" ORDER BY %ld %@", (long)([sortField integerValue]+1), (isDesc)?@"DESC":@"ASC"];
+		for (i = 0; i < [additionalSortFields count]; i++) {
+			[newOrder appendFormat:@", %ld %@", (long)([[additionalSortFields objectAtIndex:i] integerValue]+1), ([[additionalSortDescending objectAtIndex:i] boolValue])?@"DESC":@"ASC"];
+		}
+		[newOrder appendString:@" "];
+	}
+	resultIsServerSorted = (sortField != nil);
+	resultIsSortedLocally = NO;
 
 	// Remove any comments
 	[queryString replaceOccurrencesOfRegex:@"--.*?\n" withString:@""];
@@ -2175,7 +2263,6 @@
 
 	// Remove all quoted strings as a temp string to match the correct clauses
 	NSRange matchedRange;
-	NSUInteger i;
 	NSMutableString *tmpString = [NSMutableString stringWithString:queryString];
 	NSMutableString *qq = [NSMutableString string];
 	matchedRange = [tmpString rangeOfRegex:@"\"(?:[^\"\\\\]*+|\\\\.)*\""];
@@ -2236,7 +2323,7 @@
 	[self storeCurrentResultViewForRestoration];
 	queryIsTableSorter = YES;
 	if(sortField)
-		sortColumn = tableColumn;
+		sortColumn = [customQueryView tableColumnWithIdentifier:[sortField stringValue]];
 	else
 		sortColumn = nil;
 	[self performQueries:[NSArray arrayWithObject:queryString] withCallback:@selector(tableSortCallback)];
@@ -2247,8 +2334,7 @@
 	queryIsTableSorter = NO;
 
 	if ([mySQLConnection queryErrored]) {
-		sortColumn = nil;
-		if(sortField) [sortField release], sortField = nil;
+		[self _resetSortOrder];
 		return;
 	}
 
@@ -3708,6 +3794,11 @@
 		lastExecutedQuery = nil;
 		fieldIDQueryString = nil;
 		sortField = nil;
+		additionalSortFields = [[NSMutableArray alloc] init];
+		additionalSortDescending = [[NSMutableArray alloc] init];
+		resultIsServerSorted = NO;
+		resultIsSortedLocally = NO;
+		columnSizingGeneration = 0;
 		isDesc = NO;
 		sortColumn = nil;
 		isFieldEditable = NO;
@@ -4021,6 +4112,58 @@
 	return value;
 }
 
+/**
+ * Discards the current sort column and any secondary sort keys.
+ */
+- (void)_resetSortOrder
+{
+	isDesc = NO;
+	sortColumn = nil;
+	if (sortField) [sortField release], sortField = nil;
+	[additionalSortFields removeAllObjects];
+	[additionalSortDescending removeAllObjects];
+	resultIsServerSorted = NO;
+	resultIsSortedLocally = NO;
+}
+
+/**
+ * Applies the current sort keys to the result in memory, avoiding a re-run of the
+ * query.  This is only possible once the whole result has been downloaded; returns
+ * NO if the result must instead be re-sorted by the server.
+ */
+- (BOOL)_sortResultDataLocally
+{
+	BOOL sorted;
+	NSUInteger i;
+
+	if (![resultData dataDownloaded]) return NO;
+
+	// Removing the sort restores the order the server returned, unless that order
+	// itself came from a sorting query
+	if (!sortField) {
+		if (resultIsServerSorted) return NO;
+		pthread_mutex_lock(&resultDataLock);
+		[resultData clearRowIndexMap];
+		pthread_mutex_unlock(&resultDataLock);
+		resultIsSortedLocally = NO;
+		return YES;
+	}
+
+	NSMutableArray *columns = [NSMutableArray arrayWithObject:sortField];
+	NSMutableArray *descending = [NSMutableArray arrayWithObject:[NSNumber numberWithBool:isDesc]];
+	for (i = 0; i < [additionalSortFields count]; i++) {
+		[columns addObject:[additionalSortFields objectAtIndex:i]];
+		[descending addObject:[additionalSortDescending objectAtIndex:i]];
+	}
+
+	pthread_mutex_lock(&resultDataLock);
+	sorted = [resultData sortRowsByColumns:columns descending:descending columnDefinitions:cqColumnDefinition stringEncoding:[mySQLConnection stringEncoding]];
+	pthread_mutex_unlock(&resultDataLock);
+
+	resultIsSortedLocally = sorted;
+	return sorted;
+}
+
 #pragma mark -
 
 - (void)dealloc
@@ -4045,6 +4188,8 @@
 #endif
 	if (mySQLversion) [mySQLversion release];
 	if (sortField) [sortField release];
+	if (additionalSortFields) [additionalSortFields release];
+	if (additionalSortDescending) [additionalSortDescending release];
 	if (cqColumnDefinition) [cqColumnDefinition release];
 	if (selectionIndexToRestore) [selectionIndexToRestore release];
 	if (currentQueryRanges) [currentQueryRanges release];
@@ -124,6 +124,20 @@ typedef enum {
 	NSMutableArray *nullableNumericFields;
 	NSMutableIndexSet *nullableNumericFieldsMapIndex;
 
+	// LOAD DATA LOCAL INFILE progress
+	NSUInteger csvLoadDataFileLength;
+	unsigned long long csvLoadDataLastProgressBytes;
+
+	// Bulk load mode
+	BOOL csvBulkLoadSessionChanged;
+	BOOL csvBulkLoadUniqueChecksDisabled;
+	BOOL csvBulkLoadKeysDisabled;
+	BOOL csvBulkLoadTransactionOpen;
+	NSUInteger csvBulkLoadBatchesPerTransaction;
+	NSUInteger csvBulkLoadTransactionBatches;
+	NSUInteger csvBulkLoadTransactionsCommitted;
+	NSInteger csvBulkLoadTransactionFirstRow;
+
 	NSSavePanel *currentExportPanel;
 }
 
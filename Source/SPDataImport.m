@@ -42,22 +42,99 @@
 #import "SPGrowlController.h"
 #import "SPSQLParser.h"
 #import "SPCSVParser.h"
+#import "SPSQLStatementSplitter.h"
 #import "SPTableData.h"
 #import "RegexKitLite.h"
 #import "SPAlertSheets.h"
 #import "SPFieldMapperController.h"
 #import "SPFileHandle.h"
+#import "SPLocalInfileFileSource.h"
+#import "SPImportQueryPipeline.h"
+#import "SPSQLDumpReplayer.h"
+#import "SPImportCheckpoint.h"
 #import "SPEncodingPopupAccessory.h"
 #import "SPThreadAdditions.h"
+#import "SPMySQLConnectionAdditions.h"
 
 #import <SPMySQL/SPMySQL.h>
 
 #define SP_FILE_READ_ERROR_STRING NSLocalizedString(@"File read error", @"File read error title (Import Dialog)")
 
+// Server and client error IDs indicating that LOAD DATA LOCAL INFILE is refused
+// (ER_NOT_ALLOWED_COMMAND, CR_LOAD_DATA_LOCAL_INFILE_REJECTED, ER_CLIENT_LOCAL_FILES_DISABLED)
+static const NSUInteger SPLoadDataLocalInfileRefusedErrorIDs[] = { 1148, 2068, 3948 };
+
+// Minimum number of bytes between LOAD DATA LOCAL INFILE progress updates
+static const unsigned long long SPLoadDataProgressUpdateInterval = 256 * 1024;
+
+// Server error ID for a deadlock, after which the server has rolled back the whole transaction
+static const NSUInteger SPImportDeadlockErrorID = 1213;
+
+// CSV INSERT batches are sized from the measured row length and query time, aiming for each
+// statement to stay within a length budget (limited by the maximum query size) and a time budget
+static const NSUInteger SPCSVImportInitialRowsPerQuery = 50;
+static const NSUInteger SPCSVImportMaximumRowsPerQuery = 10000;
+static const NSUInteger SPCSVImportMinimumQueryLength = 64 * 1024;
+static const NSUInteger SPCSVImportMaximumQueryLength = 4 * 1024 * 1024;
+static const double SPCSVImportTargetQueryTime = 0.5;
+
+// Number of connections used to run CSV INSERT batches where row order doesn't matter
+static const NSUInteger SPCSVImportMaximumInserters = 4;
+
+// Number of connections used to replay the tables of SQL dumps concurrently
+static const NSUInteger SPSQLImportMaximumReplayConnections = 4;
+
+// Minimum number of seconds between import checkpoints; tables replayed concurrently have to be
+// waited for before a checkpoint can be taken, so are checkpointed less often
+static const double SPImportCheckpointInterval = 5.0;
+static const double SPSQLImportParallelCheckpointInterval = 30.0;
+
+// Keys for the state saved in import checkpoints
+static NSString *SPImportCheckpointEncodingKey = @"Encoding";
+static NSString *SPImportCheckpointFileOffsetKey = @"FileOffset";
+static NSString *SPImportCheckpointQueryCountKey = @"QueryCount";
+static NSString *SPImportCheckpointDelimiterKey = @"Delimiter";
+static NSString *SPImportCheckpointReplayStateKey = @"ReplayState";
+static NSString *SPImportCheckpointRowCountKey = @"RowCount";
+static NSString *SPImportCheckpointTargetKey = @"Target";
+
+/**
+ * Returns the length of a string once converted to the connection encoding, as sent to the
+ * server; characters which can't be converted are assumed to take the most bytes possible.
+ */
+static inline NSUInteger _SPDataImportQueryByteLength(NSString *aString, NSStringEncoding encoding)
+{
+	NSUInteger byteLength = [aString lengthOfBytesUsingEncoding:encoding];
+
+	if (!byteLength && [aString length]) byteLength = [aString maximumLengthOfBytesUsingEncoding:encoding];
+
+	return byteLength;
+}
+
 @interface SPDataImport ()
 
 - (void)_importBackgroundProcess:(NSString *)filename;
 - (void)_resetFieldMappingGlobals;
+- (void)_reportSQLImportQueryErrors:(NSArray *)queryErrors reportedCount:(NSUInteger *)reportedCount errors:(NSMutableString *)errors ignoreErrors:(BOOL *)ignoreSQLErrors askUser:(BOOL)askUser;
+- (BOOL)_shouldResumeImportAfterProgress:(NSString *)progressDescription;
+- (void)_configureCSVImportParser:(SPCSVParser *)csvParser;
+- (NSString *)_loadDataQueryForCSVFile:(NSString *)filename;
+- (BOOL)_loadDataTreatsCSVRowsLikeInserts;
+- (BOOL)_importCSVFileUsingLoadData:(NSString *)filename encoding:(NSStringEncoding)csvEncoding rowsImported:(NSInteger *)rowsImported errors:(NSMutableString *)errors;
+- (NSUInteger)_csvImportQueryLengthBudget;
+- (NSUInteger)_csvImportRowsPerQueryAfterQueryOfRows:(NSUInteger)queryRowCount averageRowLength:(NSUInteger)averageRowLength queryTime:(double)queryTime rowsPerQuery:(NSUInteger)rowsPerQuery lengthBudget:(NSUInteger)lengthBudget;
+- (SPImportQueryPipeline *)_csvImportInsertPipeline;
+- (NSArray *)_csvImportCheckpointTarget;
+- (NSString *)_csvImportTargetTableEngine;
+- (void)_startCSVImportBulkLoad;
+- (BOOL)_endCSVImportBulkLoadAtRow:(NSInteger)rowsImported committing:(BOOL)commit pipeline:(SPImportQueryPipeline *)pipeline errors:(NSMutableString *)errors;
+- (NSString *)_abandonCSVImportWithPipeline:(SPImportQueryPipeline *)pipeline rowsImported:(NSInteger)rowsImported;
+- (NSString *)_csvImportBulkLoadSessionQuery;
+- (void)_beginCSVImportTransactionAtRow:(NSInteger)rowsImported;
+- (BOOL)_commitCSVImportTransactionIfDueAtRow:(NSInteger)rowsImported errors:(NSMutableString *)errors;
+- (BOOL)_endCSVImportTransactionAtRow:(NSInteger)rowsImported committing:(BOOL)commit errors:(NSMutableString *)errors;
+- (BOOL)_csvImportTransactionWasRolledBackBeforeRow:(NSInteger)lastRow errors:(NSMutableString *)errors;
+- (NSString *)_csvImportRateStringForRowsImported:(NSInteger)rowsImported sinceTime:(double)startTime rowsPerQuery:(NSUInteger)rowsPerQuery;
 
 @end
 
@@ -91,6 +168,16 @@
 		importIntoNewTable = NO;
 		insertRemainingRowsAfterUpdate = NO;
 		numberOfImportDataColumns = 0;
+		csvLoadDataFileLength = 0;
+		csvLoadDataLastProgressBytes = 0;
+		csvBulkLoadSessionChanged = NO;
+		csvBulkLoadUniqueChecksDisabled = NO;
+		csvBulkLoadKeysDisabled = NO;
+		csvBulkLoadTransactionOpen = NO;
+		csvBulkLoadBatchesPerTransaction = 0;
+		csvBulkLoadTransactionBatches = 0;
+		csvBulkLoadTransactionsCommitted = 0;
+		csvBulkLoadTransactionFirstRow = 0;
 		selectedTableTarget = nil;
 		targetTableDetails = nil;
 		
@@ -347,12 +434,16 @@
 /**
  * Streaming data processing method to import a supplied SQL file.
  *
- * The file is read in chunk by chunk; each chunk is then checked
- * for line endings, which are used to split the data into parts
- * which can be parsed to NSStrings in the appropriate encoding.
+ * The file is read in chunk by chunk, and the chunks are fed to a
+ * statement splitter, which splits the data into statements ready
+ * to be executed.  Files in encodings which the splitter can't read
+ * directly are first split at line endings into parts which can be
+ * parsed to NSStrings in the appropriate encoding.
  *
- * The NSStrings are then fed to a SQL parser, which splits them
- * into statements ready to be executed.
+ * The statements are replayed by a SPSQLDumpReplayer, which runs
+ * them in file order or - for dumps which disable foreign key
+ * checks - runs the sections for different tables concurrently on
+ * several connections.
  */
 - (void)importSQLFile:(NSString *)filename
 {
@@ -362,18 +453,26 @@
 	const unsigned char *sqlDataBufferBytes;
 	NSData *fileChunk;
 	NSString *sqlString;
-	SPSQLParser *sqlParser;
+	SPSQLStatementSplitter *sqlSplitter;
+	SPSQLDumpReplayer *sqlReplayer;
+	SPImportCheckpoint *importCheckpoint;
+	NSDictionary *checkpointState = nil;
+	NSDictionary *replayState;
 	NSString *query;
 	NSMutableString *errors = [NSMutableString string];
 	NSInteger fileChunkMaxLength = 1024 * 1024;
-	NSUInteger fileTotalLength = 0;
-	NSUInteger fileProcessedLength = 0;
+	unsigned long long fileTotalLength = 0;
+	unsigned long long fileProcessedLength = 0;
+	unsigned long long resumeFileOffset = 0;
+	unsigned long long resumeSkipLength = 0;
 	NSInteger queriesPerformed = 0;
+	NSUInteger queryErrorsReported = 0;
 	NSInteger dataBufferLength = 0;
 	NSInteger dataBufferPosition = 0;
 	NSInteger dataBufferLastQueryEndPosition = 0;
 	BOOL fileIsCompressed;
 	BOOL allDataRead = NO;
+	BOOL sqlSplitterReadsData;
 	BOOL ignoreSQLErrors = ([importSQLErrorHandlingPopup selectedTag] == SPSQLImportIgnoreErrors);
 	NSStringEncoding sqlEncoding = NSUTF8StringEncoding;
 	NSString *connectionEncodingToRestore = nil;
@@ -396,19 +495,22 @@
 	fileIsCompressed = [sqlFileHandle isCompressed];
 
 	// Grab the file length
-	fileTotalLength = (NSUInteger)[[[[NSFileManager defaultManager] attributesOfItemAtPath:filename error:NULL] objectForKey:NSFileSize] longLongValue];
+	fileTotalLength = (unsigned long long)[[[[NSFileManager defaultManager] attributesOfItemAtPath:filename error:NULL] objectForKey:NSFileSize] longLongValue];
 	if (!fileTotalLength) fileTotalLength = 1;
 
 	// If importing a bzipped file, use indeterminate progress bars as no progress is available
 	BOOL useIndeterminate = NO;
 	if ([sqlFileHandle compressionFormat] == SPBzip2Compression) useIndeterminate = YES;
 
+	// Checkpoints are recorded alongside the file, to allow an interrupted import to be resumed
+	importCheckpoint = [[[SPImportCheckpoint alloc] initWithImportFile:filename format:@"SQL"] autorelease];
+
 	// Reset progress interface
 	[errorsView setString:@""];
 	[[singleProgressTitle onMainThread] setStringValue:NSLocalizedString(@"Importing SQL", @"text showing that the application is importing SQL")];
 	[[singleProgressText onMainThread] setStringValue:NSLocalizedString(@"Reading...", @"text showing that app is reading dump")];
 	[[singleProgressBar onMainThread] setIndeterminate:useIndeterminate];
-	[[singleProgressBar onMainThread] setMaxValue:fileTotalLength];
+	[[singleProgressBar onMainThread] setMaxValue:(double)fileTotalLength];
 	[[singleProgressBar onMainThread] setUsesThreadedAnimation:YES];
 	[[singleProgressBar onMainThread] startAnimation:self];
 
@@ -432,16 +534,45 @@
 		sqlEncoding = [importEncodingPopup selectedTag];
 	}
 
-	// Read in the file in a loop
-	sqlParser = [[SPSQLParser alloc] init];
-	[sqlParser setDelimiterSupport:YES];
+	// Read in the file in a loop.  If the file's encoding allows it, supply the file data to
+	// the statement splitter directly; otherwise the data is decoded into strings for the
+	// splitter, split at line endings.
+	sqlSplitter = [[SPSQLStatementSplitter alloc] init];
+	[sqlSplitter setDelimiterSupport:YES];
+	sqlSplitterReadsData = [sqlSplitter setDataEncoding:sqlEncoding];
 	sqlDataBuffer = [[NSMutableData alloc] init];
+
+	// Statements are replayed in file order, or with tables replayed concurrently where the dump allows it
+	sqlReplayer = [[SPSQLDumpReplayer alloc] initWithConnection:mySQLConnection delegate:tableDocumentInstance queryEncoding:sqlEncoding];
+	[sqlReplayer setReplaysTablesInParallel:[prefs boolForKey:SPImportSQLReplaysTablesInParallel] workerCount:SPSQLImportMaximumReplayConnections];
+	if (connectionEncodingToRestore) {
+		[sqlReplayer addSessionQuery:[NSString stringWithFormat:@"SET NAMES '%@'", [SPMySQLConnection mySQLCharsetForStringEncoding:sqlEncoding]]];
+	}
+
+	// Checkpoints record file offsets, so are only used when the splitter reads the file data
+	// directly.  If an earlier import of the file was interrupted, offer to resume it from the
+	// last checkpoint: the file is read up to the checkpoint offset without being split, and
+	// the splitter and replay state restored.
+	if (!sqlSplitterReadsData) importCheckpoint = nil;
+	checkpointState = [importCheckpoint savedState];
+	if (checkpointState && [[checkpointState objectForKey:SPImportCheckpointEncodingKey] unsignedIntegerValue] == sqlEncoding
+		&& [self _shouldResumeImportAfterProgress:[NSString stringWithFormat:NSLocalizedString(@"query %ld (%@ of the file)", @"description of SQL import progress when offering to resume an interrupted import"),
+			(long)[[checkpointState objectForKey:SPImportCheckpointQueryCountKey] integerValue], [NSString stringForByteSize:[[checkpointState objectForKey:SPImportCheckpointFileOffsetKey] longLongValue]]]])
+	{
+		resumeFileOffset = [[checkpointState objectForKey:SPImportCheckpointFileOffsetKey] unsignedLongLongValue];
+		resumeSkipLength = resumeFileOffset;
+		queriesPerformed = [[checkpointState objectForKey:SPImportCheckpointQueryCountKey] integerValue];
+		[sqlSplitter setDelimiter:[checkpointState objectForKey:SPImportCheckpointDelimiterKey]];
+		[sqlReplayer restoreCheckpointState:[checkpointState objectForKey:SPImportCheckpointReplayStateKey]];
+		[[singleProgressText onMainThread] setStringValue:NSLocalizedString(@"Skipping to checkpoint...", @"text showing that the app is reading through a file to resume an interrupted import")];
+	}
+
 	importPool = [[NSAutoreleasePool alloc] init];
 	while (1) {
 		if (progressCancelled) break;
 
 		@try {
-			fileChunk = [sqlFileHandle readDataOfLength:fileChunkMaxLength];
+			fileChunk = [sqlFileHandle readDataOfLength:(resumeSkipLength ? (NSUInteger)MIN(resumeSkipLength, (unsigned long long)fileChunkMaxLength) : fileChunkMaxLength)];
 		}
 
 		// Report file read errors, and bail
@@ -454,7 +585,9 @@
 							  NSLocalizedString(@"OK", @"OK button"),
 							  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
 							  [NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file.\n\nOnly %ld queries were executed.\n\n(%@)", @"SQL read error, including detail from system"), (long)queriesPerformed, [exception reason]]);
-			[sqlParser release];
+			[sqlReplayer cancel];
+			[sqlReplayer release];
+			[sqlSplitter release];
 			[sqlDataBuffer release];
 			[importPool drain];
 			[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
@@ -463,74 +596,89 @@
 			return;
 		}
 
+		// When resuming, discard the data before the checkpoint
+		if (resumeSkipLength && [fileChunk length]) {
+			resumeSkipLength -= [fileChunk length];
+			[importPool drain];
+			importPool = [[NSAutoreleasePool alloc] init];
+			continue;
+		}
+
 		// If no data returned, end of file - set a marker to ensure full processing
 		if (!fileChunk || ![fileChunk length]) {
 			allDataRead = YES;
 
-		// Otherwise add the data to the read/parse buffer
+		// Otherwise add the data to the splitter if it reads the data directly, or to the read/parse buffer
+		} else if (sqlSplitterReadsData) {
+			[sqlSplitter appendData:fileChunk];
 		} else {
 			[sqlDataBuffer appendData:fileChunk];
 		}
 
-		// Step through the data buffer, identifying line endings to parse the data with
-		sqlDataBufferBytes = [sqlDataBuffer bytes];
-		dataBufferLength = [sqlDataBuffer length];
-		for ( ; dataBufferPosition < dataBufferLength || allDataRead; dataBufferPosition++) {
-			if (sqlDataBufferBytes[dataBufferPosition] == 0x0A || sqlDataBufferBytes[dataBufferPosition] == 0x0D || allDataRead) {
-
-				// Keep reading through any other line endings
-				while (dataBufferPosition + 1 < dataBufferLength
-						&& (sqlDataBufferBytes[dataBufferPosition+1] == 0x0A
-							|| sqlDataBufferBytes[dataBufferPosition+1] == 0x0D))
-				{
-					dataBufferPosition++;
-				}
+		if (!sqlSplitterReadsData) {
+
+			// Step through the data buffer, identifying line endings to parse the data with
+			sqlDataBufferBytes = [sqlDataBuffer bytes];
+			dataBufferLength = [sqlDataBuffer length];
+			for ( ; dataBufferPosition < dataBufferLength || allDataRead; dataBufferPosition++) {
+				if (sqlDataBufferBytes[dataBufferPosition] == 0x0A || sqlDataBufferBytes[dataBufferPosition] == 0x0D || allDataRead) {
 
-				// Try to generate a NSString with the resulting data
-				sqlString = [[NSString alloc] initWithData:[sqlDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferPosition - dataBufferLastQueryEndPosition)]
-												  encoding:sqlEncoding];
-				if (!sqlString) {
-					if (connectionEncodingToRestore) {
-						[mySQLConnection queryString:[NSString stringWithFormat:@"SET NAMES '%@'", connectionEncodingToRestore]];
+					// Keep reading through any other line endings
+					while (dataBufferPosition + 1 < dataBufferLength
+							&& (sqlDataBufferBytes[dataBufferPosition+1] == 0x0A
+								|| sqlDataBufferBytes[dataBufferPosition+1] == 0x0D))
+					{
+						dataBufferPosition++;
 					}
-					[self closeAndStopProgressSheet];
-					NSString *displayEncoding;
-					if (![importEncodingPopup indexOfSelectedItem]) {
-						displayEncoding = [NSString stringWithFormat:@"%@ - %@", [importEncodingPopup titleOfSelectedItem], [NSString localizedNameOfStringEncoding:sqlEncoding]];
-					} else {
-						displayEncoding = [NSString localizedNameOfStringEncoding:sqlEncoding];
+
+					// Try to generate a NSString with the resulting data
+					sqlString = [[NSString alloc] initWithData:[sqlDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferPosition - dataBufferLastQueryEndPosition)]
+													  encoding:sqlEncoding];
+					if (!sqlString) {
+						if (connectionEncodingToRestore) {
+							[mySQLConnection queryString:[NSString stringWithFormat:@"SET NAMES '%@'", connectionEncodingToRestore]];
+						}
+						[self closeAndStopProgressSheet];
+						NSString *displayEncoding;
+						if (![importEncodingPopup indexOfSelectedItem]) {
+							displayEncoding = [NSString stringWithFormat:@"%@ - %@", [importEncodingPopup titleOfSelectedItem], [NSString localizedNameOfStringEncoding:sqlEncoding]];
+						} else {
+							displayEncoding = [NSString localizedNameOfStringEncoding:sqlEncoding];
+						}
+						SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
+										  NSLocalizedString(@"OK", @"OK button"),
+										  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
+										  [NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file, as it could not be read in the encoding you selected (%@).\n\nOnly %ld queries were executed.", @"SQL encoding read error"), displayEncoding, (long)queriesPerformed]);
+						[sqlReplayer cancel];
+						[sqlReplayer release];
+						[sqlSplitter release];
+						[sqlDataBuffer release];
+						[importPool drain];
+						[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
+						if([filename hasPrefix:SPImportClipboardTempFileNamePrefix])
+							[[NSFileManager defaultManager] removeItemAtPath:filename error:nil];
+						return;
 					}
-					SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
-									  NSLocalizedString(@"OK", @"OK button"),
-									  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
-									  [NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file, as it could not be read in the encoding you selected (%@).\n\nOnly %ld queries were executed.", @"SQL encoding read error"), displayEncoding, (long)queriesPerformed]);
-					[sqlParser release];
-					[sqlDataBuffer release];
-					[importPool drain];
-					[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
-					if([filename hasPrefix:SPImportClipboardTempFileNamePrefix])
-						[[NSFileManager defaultManager] removeItemAtPath:filename error:nil];
-					return;
-				}
 
-				// Add the NSString segment to the SQL parser and release it
-				[sqlParser appendString:sqlString];
-				[sqlString release];
+					// Add the NSString segment to the statement splitter and release it
+					[sqlSplitter appendString:sqlString];
+					[sqlString release];
 
-				if (allDataRead) break;
+					if (allDataRead) break;
 
-				// Increment the query end position marker
-				dataBufferLastQueryEndPosition = dataBufferPosition;
+					// Increment the query end position marker
+					dataBufferLastQueryEndPosition = dataBufferPosition;
+				}
 			}
-		}
 
-		// Trim the data buffer if part of it was used
-		if (dataBufferLastQueryEndPosition) {
-			[sqlDataBuffer setData:[sqlDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferLength - dataBufferLastQueryEndPosition)]];
-			dataBufferPosition -= dataBufferLastQueryEndPosition;
-			dataBufferLastQueryEndPosition = 0;
+			// Trim the data buffer if part of it was used
+			if (dataBufferLastQueryEndPosition) {
+				[sqlDataBuffer setData:[sqlDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferLength - dataBufferLastQueryEndPosition)]];
+				dataBufferPosition -= dataBufferLastQueryEndPosition;
+				dataBufferLastQueryEndPosition = 0;
+			}
 		}
-		
+
 		// Before entering the following loop, check that we actually have a connection.
 		// If not, check the connection if appropriate and then clean up and exit if appropriate.
 		if (![mySQLConnection isConnected] && ([mySQLConnection userTriggeredDisconnect] || ![mySQLConnection checkConnection])) {
@@ -539,19 +687,21 @@
 			[self closeAndStopProgressSheet];
 			[errors appendString:NSLocalizedString(@"The connection to the server was lost during the import.  The import is only partially complete.", @"Connection lost during import error message")];
 			[self showErrorSheetWithMessage:errors];
-			[sqlParser release];
+			[sqlReplayer cancel];
+			[sqlReplayer release];
+			[sqlSplitter release];
 			[sqlDataBuffer release];
 			[importPool drain];
 			return;
 		}
 
 		// Extract and process any complete SQL queries that can be found in the strings parsed so far
-		while ((query = [sqlParser trimAndReturnStringToCharacter:';' trimmingInclusively:YES returningInclusively:NO])) {
+		while ((query = [sqlSplitter nextStatementWithDataComplete:allDataRead])) {
 			if (progressCancelled) break;
-			fileProcessedLength += [query lengthOfBytesUsingEncoding:sqlEncoding] + 1;
+			fileProcessedLength = resumeFileOffset + [sqlSplitter totalLengthParsed];
 
 			// Ensure whitespace is removed from both ends, and normalise if necessary.
-			if ([sqlParser containsCarriageReturns]) {
+			if ([sqlSplitter containsCarriageReturns]) {
 				query = [SPSQLParser normaliseQueryForExecution:query];
 			} else {
 				query = [query stringByTrimmingCharactersInSet:whitespaceAndNewlineCharset];
@@ -560,62 +710,70 @@
 			// Skip blank or whitespace-only queries to avoid errors
 			if (![query length]) continue;
 			
-			// Run the query
-			[mySQLConnection queryString:query usingEncoding:sqlEncoding withResultType:SPMySQLResultAsResult];
-
-			// Check for any errors
-			if ([mySQLConnection queryErrored] && ![[mySQLConnection lastErrorMessage] isEqualToString:@"Query was empty"]) {
-				[errors appendFormat:NSLocalizedString(@"[ERROR in query %ld] %@\n", @"error text when multiple custom query failed"), (long)(queriesPerformed+1), [mySQLConnection lastErrorMessage]];
-
-				// If not set to ignore errors, ask what to do.  Use NSAlert rather than
-				// SPBeginWaitingAlertSheet as there is already a modal sheet in progress.
-				if (!ignoreSQLErrors) {
-					NSInteger sqlImportErrorSheetReturnCode;
-
-					NSAlert *sqlErrorAlert = [NSAlert
-							alertWithMessageText:NSLocalizedString(@"An error occurred while importing SQL", @"sql import error message")
-								   defaultButton:NSLocalizedString(@"Continue", @"continue button")
-								 alternateButton:NSLocalizedString(@"Ignore All Errors", @"ignore errors button")
-									 otherButton:NSLocalizedString(@"Stop", @"stop button")
-					   informativeTextWithFormat:NSLocalizedString(@"[ERROR in query %ld] %@\n", @"error text when multiple custom query failed"), (long)(queriesPerformed+1), [mySQLConnection lastErrorMessage]
-					];
-					[sqlErrorAlert setAlertStyle:NSWarningAlertStyle];
-					sqlImportErrorSheetReturnCode = [sqlErrorAlert runModal];
-
-					switch (sqlImportErrorSheetReturnCode) {
-					
-						// On "continue", no additional action is required
-						case NSAlertDefaultReturn:
-							break;
-						
-						// Ignore all future errors if asked to
-						case NSAlertAlternateReturn:
-							ignoreSQLErrors = YES;
-							break;
-
-						// Otherwise, stop
-						default:
-							[errors appendString:NSLocalizedString(@"Import cancelled!\n", @"import cancelled message")];
-							progressCancelled = YES;
-					}
-				}
+			// Replay the query, and report any errors from it or from earlier queries still running;
+			// if a replay connection was lost, stop the import
+			if (![sqlReplayer addStatement:query queryNumber:(NSUInteger)(queriesPerformed+1)]) {
+				progressCancelled = YES;
+				break;
 			}
+			[self _reportSQLImportQueryErrors:[sqlReplayer queryErrors] reportedCount:&queryErrorsReported errors:errors ignoreErrors:&ignoreSQLErrors askUser:YES];
 
 			// Increment the processed queries count
 			queriesPerformed++;
 
+			// Record a checkpoint once due, after the queries so far have run; tables replayed
+			// concurrently are checkpointed less often, as they must be waited for
+			if ([importCheckpoint isDueAfterInterval:([sqlReplayer isReplayingTablesInParallel] ? SPSQLImportParallelCheckpointInterval : SPImportCheckpointInterval)]
+				&& (replayState = [sqlReplayer checkpointState]))
+			{
+				[importCheckpoint saveState:[NSDictionary dictionaryWithObjectsAndKeys:
+					[NSNumber numberWithUnsignedInteger:sqlEncoding], SPImportCheckpointEncodingKey,
+					[NSNumber numberWithUnsignedLongLong:fileProcessedLength], SPImportCheckpointFileOffsetKey,
+					[NSNumber numberWithInteger:queriesPerformed], SPImportCheckpointQueryCountKey,
+					[sqlSplitter delimiter], SPImportCheckpointDelimiterKey,
+					replayState, SPImportCheckpointReplayStateKey,
+					nil]];
+			}
+
 			// Update the progress bar
 			if (fileIsCompressed) {
 				[singleProgressBar setDoubleValue:[sqlFileHandle realDataReadLength]];
 				[singleProgressText setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Imported %@ of SQL", @"SQL import progress text where total size is unknown"),
-					[NSString stringForByteSize:fileProcessedLength]]];			
+					[NSString stringForByteSize:(long long)fileProcessedLength]]];			
 			} else {
-				[singleProgressBar setDoubleValue:fileProcessedLength];
+				[singleProgressBar setDoubleValue:(double)fileProcessedLength];
 				[singleProgressText setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Imported %@ of %@", @"SQL import progress text"),
-					[NSString stringForByteSize:fileProcessedLength], [NSString stringForByteSize:fileTotalLength]]];
+					[NSString stringForByteSize:(long long)fileProcessedLength], [NSString stringForByteSize:(long long)fileTotalLength]]];
 			}
 		}
 		
+		// If the splitter reads the data directly, it reports statements which can't be decoded
+		if ([sqlSplitter dataDecodingFailed]) {
+			if (connectionEncodingToRestore) {
+				[mySQLConnection queryString:[NSString stringWithFormat:@"SET NAMES '%@'", connectionEncodingToRestore]];
+			}
+			[self closeAndStopProgressSheet];
+			NSString *displayEncoding;
+			if (![importEncodingPopup indexOfSelectedItem]) {
+				displayEncoding = [NSString stringWithFormat:@"%@ - %@", [importEncodingPopup titleOfSelectedItem], [NSString localizedNameOfStringEncoding:sqlEncoding]];
+			} else {
+				displayEncoding = [NSString localizedNameOfStringEncoding:sqlEncoding];
+			}
+			SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
+							  NSLocalizedString(@"OK", @"OK button"),
+							  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
+							  [NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file, as it could not be read in the encoding you selected (%@).\n\nOnly %ld queries were executed.", @"SQL encoding read error"), displayEncoding, (long)queriesPerformed]);
+			[sqlReplayer cancel];
+			[sqlReplayer release];
+			[sqlSplitter release];
+			[sqlDataBuffer release];
+			[importPool drain];
+			[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
+			if([filename hasPrefix:SPImportClipboardTempFileNamePrefix])
+				[[NSFileManager defaultManager] removeItemAtPath:filename error:nil];
+			return;
+		}
+
 		// If all the data has been read, break out of the processing loop
 		if (allDataRead) break;
 
@@ -624,27 +782,30 @@
 		importPool = [[NSAutoreleasePool alloc] init];
 	}
 
-	// If any text remains in the SQL parser, it's an unterminated query - execute it.
-	query = [sqlParser stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-	if ([query length] && !progressCancelled) {
-
-		// Run the query
-		[mySQLConnection queryString:query usingEncoding:sqlEncoding withResultType:SPMySQLResultAsResult];
-
-		// Check for any errors
-		if ([mySQLConnection queryErrored] && ![[mySQLConnection lastErrorMessage] isEqualToString:@"Query was empty"]) {
-			[errors appendFormat:NSLocalizedString(@"[ERROR in query %ld] %@\n", @"error text when multiple custom query failed"), (long)(queriesPerformed+1), [mySQLConnection lastErrorMessage]];
-		}
+	// Finish any tables still being replayed and the statements held back until they were
+	// loaded, or discard them if the import was stopped, and report any remaining errors
+	if (progressCancelled) {
+		[sqlReplayer cancel];
+	} else {
+		[[singleProgressText onMainThread] setStringValue:NSLocalizedString(@"Finishing...", @"text showing that the SQL import is waiting for the last queries to finish")];
+		[sqlReplayer finish];
+	}
+	[self _reportSQLImportQueryErrors:[sqlReplayer queryErrors] reportedCount:&queryErrorsReported errors:errors ignoreErrors:&ignoreSQLErrors askUser:NO];
+	if ([sqlReplayer errorMessage]) {
+		[errors appendFormat:NSLocalizedString(@"[ERROR] %@\n", @"error text when importing a csv file gave an error not attributable to a row"), [sqlReplayer errorMessage]];
+	}
 
-		// Increment the processed queries count
-		queriesPerformed++;
+	// Once the whole file has been replayed, the checkpoint is no longer needed
+	if (!progressCancelled && ![sqlReplayer errorMessage]) {
+		[importCheckpoint remove];
 	}
 
 	// Clean up
 	if (connectionEncodingToRestore) {
 		[mySQLConnection queryString:[NSString stringWithFormat:@"SET NAMES '%@'", connectionEncodingToRestore]];
 	}
-	[sqlParser release];
+	[sqlReplayer release];
+	[sqlSplitter release];
 	[sqlDataBuffer release];
 	[importPool drain];
 	[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
@@ -693,6 +854,13 @@
  * mapping sheet is displayed to allow columns to be mapped to
  * fields in a table; the queries are then constructed for each of
  * the rows, and the rest of the file is processed.
+ *
+ * If the mapping chosen is a straight mapping of file columns to
+ * table columns, the parsed rows of the whole file are instead
+ * streamed to the server using LOAD DATA LOCAL INFILE where the
+ * server permits it.
+ * Otherwise INSERT batches are run by a pipeline of inserter
+ * connections while the file continues to be read and parsed.
  */
 - (void)importCSVFile:(NSString *)filename
 {
@@ -703,6 +871,8 @@
 	NSData *fileChunk;
 	NSString *csvString;
 	SPCSVParser *csvParser;
+	SPImportCheckpoint *importCheckpoint;
+	NSDictionary *checkpointState;
 	NSMutableString *query;
 	NSMutableString *errors = [NSMutableString string];
 	NSMutableString *insertBaseString = [NSMutableString string];
@@ -711,8 +881,14 @@
 	NSMutableArray *parsePositions = [[NSMutableArray alloc] init];
 	NSArray *csvRowArray;
 	NSInteger fileChunkMaxLength = 256 * 1024;
-	NSUInteger csvRowsPerQuery = 50;
+	NSUInteger csvRowsPerQuery = SPCSVImportInitialRowsPerQuery;
 	NSUInteger csvRowsThisQuery;
+	NSUInteger csvRowsToSkip = 0;
+	NSUInteger csvQueryLengthBudget = SPCSVImportMinimumQueryLength;
+	NSUInteger csvQueryBaseLength, csvQueryLength, csvRowLength;
+	NSStringEncoding csvQueryEncoding = NSUTF8StringEncoding;
+	double csvQueryStartTime, csvQueryTime;
+	double csvImportStartTime = 0;
 	NSUInteger fileTotalLength = 0;
 	BOOL fileIsCompressed;
 	NSInteger rowsImported = 0;
@@ -722,6 +898,11 @@
 	NSUInteger i;
 	BOOL allDataRead = NO;
 	BOOL insertBaseStringHasEntries;
+	BOOL importMethodChosen = NO;
+	BOOL importedUsingLoadData = NO;
+	BOOL csvParserReadsData;
+	BOOL bulkLoadTransactionFailed = NO;
+	SPImportQueryPipeline *insertPipeline = nil;
 	
 	NSStringEncoding csvEncoding = [mySQLConnection stringEncoding];
 
@@ -784,6 +965,20 @@
 		csvEncoding = [importEncodingPopup selectedTag];
 	}
 
+	// Checkpoints are recorded alongside the file, to allow an interrupted import to be resumed.
+	// If an earlier import of the file was interrupted, offer to resume it; the rows imported
+	// before the checkpoint are parsed again but skipped, once the field mapping is known.
+	importCheckpoint = [[[SPImportCheckpoint alloc] initWithImportFile:filename format:@"CSV"] autorelease];
+	checkpointState = [importCheckpoint savedState];
+	if (checkpointState && [[checkpointState objectForKey:SPImportCheckpointEncodingKey] unsignedIntegerValue] == csvEncoding
+		&& [self _shouldResumeImportAfterProgress:[NSString stringWithFormat:NSLocalizedString(@"row %ld", @"description of CSV import progress when offering to resume an interrupted import"), (long)[[checkpointState objectForKey:SPImportCheckpointRowCountKey] integerValue]]])
+	{
+		csvRowsToSkip = [[checkpointState objectForKey:SPImportCheckpointRowCountKey] unsignedIntegerValue];
+		[[singleProgressText onMainThread] setStringValue:NSLocalizedString(@"Skipping to checkpoint...", @"text showing that the app is reading through a file to resume an interrupted import")];
+	} else {
+		checkpointState = nil;
+	}
+
 	// Read in the file in a loop.  The loop actually needs to perform three tasks: read in
 	// CSV data and parse them into row arrays; present the field mapping interface once it
 	// has some data to show within the interface; and use the field mapping data to construct
@@ -799,21 +994,16 @@
 	[prefs setBool:[importFieldNamesSwitch state] forKey:SPCSVImportFirstLineIsHeader];
 
 	// Take CSV import setting from accessory view
-	[csvParser setFieldTerminatorString:[importFieldsTerminatedField stringValue] convertDisplayStrings:YES];
-	[csvParser setLineTerminatorString:[importLinesTerminatedField stringValue] convertDisplayStrings:YES];
-	[csvParser setFieldQuoteString:[importFieldsEnclosedField stringValue] convertDisplayStrings:YES];
-	if ([[importFieldsEscapedField stringValue] isEqualToString:@"\\ or \""]) {
-		[csvParser setEscapeString:@"\\" convertDisplayStrings:NO];
-	} else {
-		[csvParser setEscapeString:[importFieldsEscapedField stringValue] convertDisplayStrings:YES];
-		[csvParser setEscapeStringsAreMatchedStrictly:YES];
-	}
-	[csvParser setNullReplacementString:[prefs objectForKey:SPNullValue]];
+	[self _configureCSVImportParser:csvParser];
+
+	// If the file's encoding allows it, supply the file data to the parser directly; otherwise
+	// the data is decoded into strings for the parser, split at line endings.
+	csvParserReadsData = [csvParser setDataEncoding:csvEncoding];
 
 	csvDataBuffer = [[NSMutableData alloc] init];
 	importPool = [[NSAutoreleasePool alloc] init];
 	while (1) {
-		if (progressCancelled) break;
+		if (progressCancelled || [insertPipeline hasFailed] || bulkLoadTransactionFailed) break;
 
 		@try {
 			fileChunk = [csvFileHandle readDataOfLength:fileChunkMaxLength];
@@ -821,15 +1011,17 @@
 
 		// Report file read errors, and bail
 		@catch (NSException *exception) {
+			NSString *bulkLoadReport = [self _abandonCSVImportWithPipeline:insertPipeline rowsImported:rowsImported];
 			[self closeAndStopProgressSheet];
 			SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
 							  NSLocalizedString(@"OK", @"OK button"),
 							  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
-							  [NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file.\n\nOnly %ld rows were imported.\n\n(%@)", @"CSV read error, including detail string from system"), (long)rowsImported, [exception reason]]);
+							  [[NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file.\n\nOnly %ld rows were imported.\n\n(%@)", @"CSV read error, including detail string from system"), (long)rowsImported, [exception reason]] stringByAppendingString:bulkLoadReport]);
 			[csvParser release];
 			[csvDataBuffer release];
 			[parsedRows release];
 			[parsePositions release];
+			[insertPipeline release];
 			[self _resetFieldMappingGlobals];
 			[importPool drain];
 			[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
@@ -842,67 +1034,74 @@
 		if (!fileChunk || ![fileChunk length]) {
 			allDataRead = YES;
 
-		// Otherwise add the data to the read/parse buffer
+		// Otherwise add the data to the parser if it reads the data directly, or to the read/parse buffer
+		} else if (csvParserReadsData) {
+			[csvParser appendData:fileChunk];
 		} else {
 			[csvDataBuffer appendData:fileChunk];
 		}
 
-		// Step through the data buffer, identifying line endings to parse the data with
-		csvDataBufferBytes = [csvDataBuffer bytes];
-		dataBufferLength = [csvDataBuffer length];
-		for ( ; dataBufferPosition < dataBufferLength || allDataRead; dataBufferPosition++) {
-			if (csvDataBufferBytes[dataBufferPosition] == 0x0A || csvDataBufferBytes[dataBufferPosition] == 0x0D || allDataRead) {
-
-				// Keep reading through any other line endings
-				while (dataBufferPosition + 1 < dataBufferLength
-						&& (csvDataBufferBytes[dataBufferPosition+1] == 0x0A
-							|| csvDataBufferBytes[dataBufferPosition+1] == 0x0D))
-				{
-					dataBufferPosition++;
-				}
+		if (!csvParserReadsData) {
 
-				// Try to generate a NSString with the resulting data
-				csvString = [[NSString alloc] initWithData:[csvDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferPosition - dataBufferLastQueryEndPosition)] encoding:csvEncoding];
-				if (!csvString) {
-					[self closeAndStopProgressSheet];
-					NSString *displayEncoding;
-					if (![importEncodingPopup indexOfSelectedItem]) {
-						displayEncoding = [NSString stringWithFormat:@"%@ - %@", [importEncodingPopup titleOfSelectedItem], [NSString localizedNameOfStringEncoding:csvEncoding]];
-					} else {
-						displayEncoding = [NSString localizedNameOfStringEncoding:csvEncoding];
+			// Step through the data buffer, identifying line endings to parse the data with
+			csvDataBufferBytes = [csvDataBuffer bytes];
+			dataBufferLength = [csvDataBuffer length];
+			for ( ; dataBufferPosition < dataBufferLength || allDataRead; dataBufferPosition++) {
+				if (csvDataBufferBytes[dataBufferPosition] == 0x0A || csvDataBufferBytes[dataBufferPosition] == 0x0D || allDataRead) {
+
+					// Keep reading through any other line endings
+					while (dataBufferPosition + 1 < dataBufferLength
+							&& (csvDataBufferBytes[dataBufferPosition+1] == 0x0A
+								|| csvDataBufferBytes[dataBufferPosition+1] == 0x0D))
+					{
+						dataBufferPosition++;
 					}
-					SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
-									  NSLocalizedString(@"OK", @"OK button"),
-									  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
-									  [NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file, as it could not be read using the encoding you selected (%@).\n\nOnly %ld rows were imported.", @"CSV encoding read error"), displayEncoding, (long)rowsImported]);
-					[csvParser release];
-					[csvDataBuffer release];
-					[parsedRows release];
-					[parsePositions release];
-					[self _resetFieldMappingGlobals];
-					[importPool drain];
-					[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
-					if([filename hasPrefix:SPImportClipboardTempFileNamePrefix])
-						[[NSFileManager defaultManager] removeItemAtPath:filename error:nil];
-					return;
-				}
 
-				// Add the NSString segment to the CSV parser and release it
-				[csvParser appendString:csvString];
-				[csvString release];
+					// Try to generate a NSString with the resulting data
+					csvString = [[NSString alloc] initWithData:[csvDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferPosition - dataBufferLastQueryEndPosition)] encoding:csvEncoding];
+					if (!csvString) {
+						NSString *bulkLoadReport = [self _abandonCSVImportWithPipeline:insertPipeline rowsImported:rowsImported];
+						[self closeAndStopProgressSheet];
+						NSString *displayEncoding;
+						if (![importEncodingPopup indexOfSelectedItem]) {
+							displayEncoding = [NSString stringWithFormat:@"%@ - %@", [importEncodingPopup titleOfSelectedItem], [NSString localizedNameOfStringEncoding:csvEncoding]];
+						} else {
+							displayEncoding = [NSString localizedNameOfStringEncoding:csvEncoding];
+						}
+						SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
+										  NSLocalizedString(@"OK", @"OK button"),
+										  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
+										  [[NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file, as it could not be read using the encoding you selected (%@).\n\nOnly %ld rows were imported.", @"CSV encoding read error"), displayEncoding, (long)rowsImported] stringByAppendingString:bulkLoadReport]);
+						[csvParser release];
+						[csvDataBuffer release];
+						[parsedRows release];
+						[parsePositions release];
+						[insertPipeline release];
+						[self _resetFieldMappingGlobals];
+						[importPool drain];
+						[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
+						if([filename hasPrefix:SPImportClipboardTempFileNamePrefix])
+							[[NSFileManager defaultManager] removeItemAtPath:filename error:nil];
+						return;
+					}
 
-				if (allDataRead) break;
+					// Add the NSString segment to the CSV parser and release it
+					[csvParser appendString:csvString];
+					[csvString release];
 
-				// Increment the buffer end position marker
-				dataBufferLastQueryEndPosition = dataBufferPosition;
+					if (allDataRead) break;
+
+					// Increment the buffer end position marker
+					dataBufferLastQueryEndPosition = dataBufferPosition;
+				}
 			}
-		}
 
-		// Trim the data buffer if part of it was used
-		if (dataBufferLastQueryEndPosition) {
-			[csvDataBuffer setData:[csvDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferLength - dataBufferLastQueryEndPosition)]];
-			dataBufferPosition -= dataBufferLastQueryEndPosition;
-			dataBufferLastQueryEndPosition = 0;
+			// Trim the data buffer if part of it was used
+			if (dataBufferLastQueryEndPosition) {
+				[csvDataBuffer setData:[csvDataBuffer subdataWithRange:NSMakeRange(dataBufferLastQueryEndPosition, dataBufferLength - dataBufferLastQueryEndPosition)]];
+				dataBufferPosition -= dataBufferLastQueryEndPosition;
+				dataBufferLastQueryEndPosition = 0;
+			}
 		}
 
 		// Extract and process any full CSV rows found so far.  Also trigger processing if all
@@ -926,6 +1125,8 @@
 					[csvDataBuffer release];
 					[parsedRows release];
 					[parsePositions release];
+					[self _abandonCSVImportWithPipeline:insertPipeline rowsImported:rowsImported];
+					[insertPipeline release];
 					[self _resetFieldMappingGlobals];
 					[importPool drain];
 					[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
@@ -986,17 +1187,43 @@
 					[parsedRows removeObjectAtIndex:0];
 					[parsePositions removeObjectAtIndex:0];
 				}
+
+				// Size INSERT statements, and the file reads feeding them, from the maximum query size
+				csvQueryLengthBudget = [self _csvImportQueryLengthBudget];
+				csvQueryEncoding = [mySQLConnection stringEncoding];
+				fileChunkMaxLength = MAX(fileChunkMaxLength, (NSInteger)csvQueryLengthBudget);
+				csvImportStartTime = [NSDate monotonicTimeInterval];
+
+				// Only resume an import into the same table and columns as the interrupted import
+				if (checkpointState && ![[checkpointState objectForKey:SPImportCheckpointTargetKey] isEqual:[self _csvImportCheckpointTarget]]) {
+					[errors appendString:NSLocalizedString(@"The import could not be resumed, as the target table or field mapping differ from those of the interrupted import.\n", @"error text when an interrupted CSV import is resumed with a different table or mapping")];
+					progressCancelled = YES;
+					break;
+				}
 			}
 			if (!fieldMappingArray) continue;
+
+			// When resuming, skip the rows imported before the checkpoint
+			if (csvRowsToSkip) {
+				csvRowsThisQuery = MIN(csvRowsToSkip, [parsedRows count]);
+				[parsedRows removeObjectsInRange:NSMakeRange(0, csvRowsThisQuery)];
+				[parsePositions removeObjectsInRange:NSMakeRange(0, csvRowsThisQuery)];
+				csvRowsToSkip -= csvRowsThisQuery;
+				rowsImported += csvRowsThisQuery;
+				if (csvRowsToSkip || ![parsedRows count]) continue;
+			}
 			
 			// Before entering the following loop, check that we actually have a connection.
 			// If not, check the connection if appropriate and then clean up and exit if appropriate.
 			if (![mySQLConnection isConnected] && ([mySQLConnection userTriggeredDisconnect] || ![mySQLConnection checkConnection])) {
+				NSString *bulkLoadReport = [self _abandonCSVImportWithPipeline:insertPipeline rowsImported:rowsImported];
 				[self closeAndStopProgressSheet];
+				if ([bulkLoadReport length]) [self showErrorSheetWithMessage:[bulkLoadReport substringFromIndex:2]];
 				[csvParser release];
 				[csvDataBuffer release];
 				[parsedRows release];
 				[parsePositions release];
+				[insertPipeline release];
 				[self _resetFieldMappingGlobals];
 				[importPool drain];
 				[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
@@ -1005,6 +1232,23 @@
 				return;
 			}
 
+			// With a straight column mapping, stream the parsed rows of the whole file to the server
+			// using LOAD DATA LOCAL INFILE rather than INSERTs; if that isn't possible, or when resuming,
+			// continue below, running INSERT batches on a pipeline of inserter connections where possible.
+			// If bulk load mode is enabled, the session and table are prepared for it first.
+			if (!importMethodChosen) {
+				importMethodChosen = YES;
+				[self _startCSVImportBulkLoad];
+				if (!checkpointState && [self _importCSVFileUsingLoadData:filename encoding:csvEncoding rowsImported:&rowsImported errors:errors]) {
+					importedUsingLoadData = YES;
+					break;
+				}
+				if (!importMethodIsUpdate) {
+					insertPipeline = [[self _csvImportInsertPipeline] retain];
+					[insertPipeline setCompletedRowNumber:rowsImported];
+				}
+			}
+
 			// If we have more than the csvRowsPerQuery amount, or if we're at the end of the
 			// available data, construct and run a query.
 			while ([parsedRows count] >= csvRowsPerQuery
@@ -1012,21 +1256,81 @@
 			{
 				if (progressCancelled) break;
 				csvRowsThisQuery = 0;
+
+				// Hand INSERT batches to the pipeline to run, while parsing continues
+				if (insertPipeline) {
+					NSMutableArray *valueStrings = [NSMutableArray arrayWithCapacity:MIN(csvRowsPerQuery, [parsedRows count])];
+					csvQueryLength = 0;
+					csvQueryBaseLength = _SPDataImportQueryByteLength(insertBaseString, csvQueryEncoding) + _SPDataImportQueryByteLength(csvImportTailString, csvQueryEncoding) + 1;
+					for (i = 0; i < csvRowsPerQuery && i < [parsedRows count]; i++) {
+						NSString *valueString = [self mappedValueStringForRowArray:[parsedRows objectAtIndex:i]];
+						csvRowLength = _SPDataImportQueryByteLength(valueString, csvQueryEncoding) + 2;
+
+						// Stop before a row which would take the batch over the budget
+						if (csvRowsThisQuery && csvQueryBaseLength + csvQueryLength + csvRowLength > csvQueryLengthBudget) break;
+						[valueStrings addObject:valueString];
+						csvQueryLength += csvRowLength;
+						csvRowsThisQuery++;
+					}
+					if (![insertPipeline addRowValues:valueStrings toQuery:insertBaseString tail:csvImportTailString firstRowNumber:rowsImported + 1 inLane:SPImportQueryPipelineAnyLane]) break;
+
+					// Size the next batch from the rows built here and the inserters' query times
+					csvRowsPerQuery = [self _csvImportRowsPerQueryAfterQueryOfRows:[insertPipeline lastQueryRowCount] averageRowLength:csvQueryLength / csvRowsThisQuery queryTime:[insertPipeline lastQueryTime] rowsPerQuery:csvRowsPerQuery lengthBudget:csvQueryLengthBudget];
+
+					rowsImported += csvRowsThisQuery;
+					NSString *rateString = [self _csvImportRateStringForRowsImported:(NSInteger)[insertPipeline rowsProcessed] sinceTime:csvImportStartTime rowsPerQuery:csvRowsThisQuery];
+					if (fileIsCompressed) {
+						[[singleProgressBar onMainThread] setDoubleValue:[csvFileHandle realDataReadLength]];
+						[[singleProgressText onMainThread] setStringValue:[NSString stringWithFormat:@"%@ %@", [NSString stringWithFormat:NSLocalizedString(@"Imported %@ of CSV data", @"CSV import progress text where total size is unknown"),
+							[NSString stringForByteSize:[[parsePositions objectAtIndex:csvRowsThisQuery-1] longValue]]], rateString]];
+					} else {
+						[[singleProgressBar onMainThread] setDoubleValue:[[parsePositions objectAtIndex:csvRowsThisQuery-1] doubleValue]];
+						[[singleProgressText onMainThread] setStringValue:[NSString stringWithFormat:@"%@ %@", [NSString stringWithFormat:NSLocalizedString(@"Imported %@ of %@", @"SQL import progress text"),
+							[NSString stringForByteSize:[[parsePositions objectAtIndex:csvRowsThisQuery-1] longValue]], [NSString stringForByteSize:fileTotalLength]], rateString]];
+					}
+
+					[parsedRows removeObjectsInRange:NSMakeRange(0, csvRowsThisQuery)];
+					[parsePositions removeObjectsInRange:NSMakeRange(0, csvRowsThisQuery)];
+					continue;
+				}
+
+				[self _beginCSVImportTransactionAtRow:rowsImported];
+
 				if(!importMethodIsUpdate) {
 					query = [[NSMutableString alloc] initWithString:insertBaseString];
+					csvQueryLength = 0;
+					csvQueryBaseLength = _SPDataImportQueryByteLength(query, csvQueryEncoding) + _SPDataImportQueryByteLength(csvImportTailString, csvQueryEncoding) + 1;
 					for (i = 0; i < csvRowsPerQuery && i < [parsedRows count]; i++) {
+						NSString *valueString = [[self mappedValueStringForRowArray:[parsedRows objectAtIndex:i]] description];
+						csvRowLength = _SPDataImportQueryByteLength(valueString, csvQueryEncoding) + 2;
+
+						// Stop before a row which would take the query over the budget
+						if (csvRowsThisQuery && csvQueryBaseLength + csvQueryLength + csvRowLength > csvQueryLengthBudget) break;
 						if (i > 0) [query appendString:@",\n"];
-						[query appendString:[[self mappedValueStringForRowArray:[parsedRows objectAtIndex:i]] description]];
+						[query appendString:valueString];
+						csvQueryLength += csvRowLength;
 						csvRowsThisQuery++;
-						if ([query length] > 250000) break;
 					}
 
 					// Perform the query
+					csvQueryStartTime = [NSDate monotonicTimeInterval];
 					if(csvImportMethodHasTail)
 						[mySQLConnection queryString:[NSString stringWithFormat:@"%@ %@", query, csvImportTailString]];
 					else
 						[mySQLConnection queryString:query];
+					csvQueryTime = [NSDate monotonicTimeInterval] - csvQueryStartTime;
+
+					// Size the next batch from this batch's row length and query time
+					if (![mySQLConnection queryErrored] && csvRowsThisQuery) {
+						csvRowsPerQuery = [self _csvImportRowsPerQueryAfterQueryOfRows:csvRowsThisQuery averageRowLength:csvQueryLength / csvRowsThisQuery queryTime:csvQueryTime rowsPerQuery:csvRowsPerQuery lengthBudget:csvQueryLengthBudget];
+					}
 					[query release];
+
+					// A deadlock rolls back the whole transaction, losing its earlier batches as well
+					if ([mySQLConnection queryErrored] && [self _csvImportTransactionWasRolledBackBeforeRow:rowsImported + csvRowsThisQuery errors:errors]) {
+						bulkLoadTransactionFailed = YES;
+						break;
+					}
 				} else {
 					if(insertRemainingRowsAfterUpdate) {
 						[insertRemainingBaseString setString:@"INSERT INTO "];
@@ -1054,6 +1358,11 @@
 							[mySQLConnection queryString:query];
 						[query release];
 
+						if ([mySQLConnection queryErrored] && [self _csvImportTransactionWasRolledBackBeforeRow:rowsImported + 1 errors:errors]) {
+							bulkLoadTransactionFailed = YES;
+							break;
+						}
+
 						if ([mySQLConnection queryErrored]) {
 							[tableDocumentInstance showConsole:nil];
 							[errors appendFormat:
@@ -1091,6 +1400,7 @@
 								[NSString stringForByteSize:[[parsePositions objectAtIndex:i] longValue]], [NSString stringForByteSize:fileTotalLength]]];
 						}
 					}
+					if (bulkLoadTransactionFailed) break;
 				}
 
 				// If an error occurred, run the queries individually to get exact line errors
@@ -1126,32 +1436,97 @@
 					}
 				} else {
 					rowsImported += csvRowsThisQuery;
+					NSString *rateString = [self _csvImportRateStringForRowsImported:rowsImported sinceTime:csvImportStartTime rowsPerQuery:csvRowsThisQuery];
 					if (fileIsCompressed) {
 						[singleProgressBar setDoubleValue:[csvFileHandle realDataReadLength]];
-						[singleProgressText setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Imported %@ of CSV data", @"CSV import progress text where total size is unknown"),
-						[NSString stringForByteSize:[[parsePositions objectAtIndex:csvRowsThisQuery-1] longValue]]]];			
+						[singleProgressText setStringValue:[NSString stringWithFormat:@"%@ %@", [NSString stringWithFormat:NSLocalizedString(@"Imported %@ of CSV data", @"CSV import progress text where total size is unknown"),
+						[NSString stringForByteSize:[[parsePositions objectAtIndex:csvRowsThisQuery-1] longValue]]], rateString]];
 					} else {
 						[singleProgressBar setDoubleValue:[[parsePositions objectAtIndex:csvRowsThisQuery-1] doubleValue]];
-						[singleProgressText setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Imported %@ of %@", @"SQL import progress text"),
-							[NSString stringForByteSize:[[parsePositions objectAtIndex:csvRowsThisQuery-1] longValue]], [NSString stringForByteSize:fileTotalLength]]];
+						[singleProgressText setStringValue:[NSString stringWithFormat:@"%@ %@", [NSString stringWithFormat:NSLocalizedString(@"Imported %@ of %@", @"SQL import progress text"),
+							[NSString stringForByteSize:[[parsePositions objectAtIndex:csvRowsThisQuery-1] longValue]], [NSString stringForByteSize:fileTotalLength]], rateString]];
 					}
 				}
 
+				// Commit the bulk load transaction once it holds enough batches
+				if (![self _commitCSVImportTransactionIfDueAtRow:rowsImported errors:errors]) {
+					bulkLoadTransactionFailed = YES;
+					break;
+				}
+
 				// Update the arrays
 				[parsedRows removeObjectsInRange:NSMakeRange(0, csvRowsThisQuery)];
 				[parsePositions removeObjectsInRange:NSMakeRange(0, csvRowsThisQuery)];
 			}
+
+			// Record a checkpoint once due, of the rows the server has completed and committed
+			if (!progressCancelled && !bulkLoadTransactionFailed && [importCheckpoint isDueAfterInterval:SPImportCheckpointInterval]) {
+				[importCheckpoint saveState:[NSDictionary dictionaryWithObjectsAndKeys:
+					[NSNumber numberWithUnsignedInteger:csvEncoding], SPImportCheckpointEncodingKey,
+					[NSNumber numberWithInteger:(insertPipeline ? (NSInteger)[insertPipeline completedRowNumber] : (csvBulkLoadTransactionOpen ? csvBulkLoadTransactionFirstRow : rowsImported))], SPImportCheckpointRowCountKey,
+					[self _csvImportCheckpointTarget], SPImportCheckpointTargetKey,
+					nil]];
+			}
 		}
-		
-		// If all the data has been read, break out of the processing loop
-		if (allDataRead) break;
+
+		// If the parser reads the data directly, it reports cells which can't be decoded
+		if ([csvParser dataDecodingFailed]) {
+			NSString *bulkLoadReport = [self _abandonCSVImportWithPipeline:insertPipeline rowsImported:rowsImported];
+			[self closeAndStopProgressSheet];
+			NSString *displayEncoding;
+			if (![importEncodingPopup indexOfSelectedItem]) {
+				displayEncoding = [NSString stringWithFormat:@"%@ - %@", [importEncodingPopup titleOfSelectedItem], [NSString localizedNameOfStringEncoding:csvEncoding]];
+			} else {
+				displayEncoding = [NSString localizedNameOfStringEncoding:csvEncoding];
+			}
+			SPBeginAlertSheet(SP_FILE_READ_ERROR_STRING,
+							  NSLocalizedString(@"OK", @"OK button"),
+							  nil, nil, [tableDocumentInstance parentWindow], self, nil, nil,
+							  [[NSString stringWithFormat:NSLocalizedString(@"An error occurred when reading the file, as it could not be read using the encoding you selected (%@).\n\nOnly %ld rows were imported.", @"CSV encoding read error"), displayEncoding, (long)rowsImported] stringByAppendingString:bulkLoadReport]);
+			[csvParser release];
+			[csvDataBuffer release];
+			[parsedRows release];
+			[parsePositions release];
+			[insertPipeline release];
+			[self _resetFieldMappingGlobals];
+			[importPool drain];
+			[tableDocumentInstance setQueryMode:SPInterfaceQueryMode];
+			if([filename hasPrefix:SPImportClipboardTempFileNamePrefix])
+				[[NSFileManager defaultManager] removeItemAtPath:filename error:nil];
+			return;
+		}
+
+		// If all the data has been read or loaded, break out of the processing loop
+		if (allDataRead || importedUsingLoadData) break;
 
 		// Reset the autorelease pool
 		[importPool drain];
 		importPool = [[NSAutoreleasePool alloc] init];
 	}
 
+	// Wait for the pipeline to run the remaining batches, collecting any errors
+	if (insertPipeline) {
+		if (progressCancelled) [insertPipeline cancel];
+		[insertPipeline waitUntilFinished];
+		[errors appendString:[insertPipeline rowErrorReport]];
+		if ([insertPipeline hasFailed]) {
+			[errors appendFormat:NSLocalizedString(@"[ERROR] %@\n", @"error text when importing a csv file gave an error not attributable to a row"), [insertPipeline errorMessage]];
+		}
+		if ([errors length]) [tableDocumentInstance showConsole:nil];
+	}
+
+	// End any bulk load, committing its last transaction unless the import was cancelled or failed
+	if (![self _endCSVImportBulkLoadAtRow:rowsImported committing:(!progressCancelled && !bulkLoadTransactionFailed && ![insertPipeline hasFailed]) pipeline:insertPipeline errors:errors]) {
+		bulkLoadTransactionFailed = YES;
+	}
+
+	// Once the whole file has been imported, the checkpoint is no longer needed
+	if (!progressCancelled && (allDataRead || importedUsingLoadData) && ![insertPipeline hasFailed] && !bulkLoadTransactionFailed) {
+		[importCheckpoint remove];
+	}
+
 	// Clean up
+	[insertPipeline release];
 	[csvParser release];
 	[csvDataBuffer release];
 	[parsedRows release];
@@ -1724,6 +2099,634 @@
 	if (fieldMapperOperator) [fieldMapperOperator release], fieldMapperOperator = nil;
 }
 
+/**
+ * Append any SQL import query errors which haven't yet been reported to the error log.
+ * If asked and not set to ignore errors, ask what to do about each error, stopping the
+ * import if the user chooses to.
+ */
+- (void)_reportSQLImportQueryErrors:(NSArray *)queryErrors reportedCount:(NSUInteger *)reportedCount errors:(NSMutableString *)errors ignoreErrors:(BOOL *)ignoreSQLErrors askUser:(BOOL)askUser
+{
+	for ( ; *reportedCount < [queryErrors count]; (*reportedCount)++) {
+		NSDictionary *queryError = [queryErrors objectAtIndex:*reportedCount];
+		long queryNumber = (long)[[queryError objectForKey:@"query"] unsignedIntegerValue];
+		NSString *errorMessage = [queryError objectForKey:@"message"];
+
+		[errors appendFormat:NSLocalizedString(@"[ERROR in query %ld] %@\n", @"error text when multiple custom query failed"), queryNumber, errorMessage];
+
+		if (!askUser || *ignoreSQLErrors || progressCancelled) continue;
+
+		// Use NSAlert rather than SPBeginWaitingAlertSheet as there is already a modal sheet in progress.
+		NSAlert *sqlErrorAlert = [NSAlert
+				alertWithMessageText:NSLocalizedString(@"An error occurred while importing SQL", @"sql import error message")
+					   defaultButton:NSLocalizedString(@"Continue", @"continue button")
+					 alternateButton:NSLocalizedString(@"Ignore All Errors", @"ignore errors button")
+						 otherButton:NSLocalizedString(@"Stop", @"stop button")
+		   informativeTextWithFormat:NSLocalizedString(@"[ERROR in query %ld] %@\n", @"error text when multiple custom query failed"), queryNumber, errorMessage
+		];
+		[sqlErrorAlert setAlertStyle:NSWarningAlertStyle];
+
+		switch ([sqlErrorAlert runModal]) {
+
+			// On "continue", no additional action is required
+			case NSAlertDefaultReturn:
+				break;
+
+			// Ignore all future errors if asked to
+			case NSAlertAlternateReturn:
+				*ignoreSQLErrors = YES;
+				break;
+
+			// Otherwise, stop
+			default:
+				[errors appendString:NSLocalizedString(@"Import cancelled!\n", @"import cancelled message")];
+				progressCancelled = YES;
+		}
+	}
+}
+
+/**
+ * Ask whether to resume an interrupted import of the file from its last checkpoint, described
+ * by the supplied progress description, or to start the import over.
+ */
+- (BOOL)_shouldResumeImportAfterProgress:(NSString *)progressDescription
+{
+
+	// Use NSAlert rather than SPBeginWaitingAlertSheet as there is already a modal sheet in progress.
+	NSAlert *resumeAlert = [NSAlert
+			alertWithMessageText:NSLocalizedString(@"Resume the interrupted import?", @"title of alert offering to resume an interrupted import")
+				   defaultButton:NSLocalizedString(@"Resume", @"resume button")
+				 alternateButton:NSLocalizedString(@"Start Over", @"start over button")
+					 otherButton:nil
+	   informativeTextWithFormat:NSLocalizedString(@"An earlier import of this file was interrupted after %@. The import can be resumed from that point, or started over from the beginning of the file.", @"informative text of alert offering to resume an interrupted import"), progressDescription
+	];
+	[resumeAlert setAlertStyle:NSInformationalAlertStyle];
+
+	return ([resumeAlert runModal] == NSAlertDefaultReturn);
+}
+
+/**
+ * Set up a CSV parser with the terminator, quote, escape and null settings chosen for the
+ * import, so that every parser reading the file reads the same rows from it.
+ */
+- (void)_configureCSVImportParser:(SPCSVParser *)csvParser
+{
+	[csvParser setFieldTerminatorString:[importFieldsTerminatedField stringValue] convertDisplayStrings:YES];
+	[csvParser setLineTerminatorString:[importLinesTerminatedField stringValue] convertDisplayStrings:YES];
+	[csvParser setFieldQuoteString:[importFieldsEnclosedField stringValue] convertDisplayStrings:YES];
+	if ([[importFieldsEscapedField stringValue] isEqualToString:@"\\ or \""]) {
+		[csvParser setEscapeString:@"\\" convertDisplayStrings:NO];
+	} else {
+		[csvParser setEscapeString:[importFieldsEscapedField stringValue] convertDisplayStrings:YES];
+		[csvParser setEscapeStringsAreMatchedStrictly:YES];
+	}
+	[csvParser setNullReplacementString:[prefs objectForKey:SPNullValue]];
+}
+
+/**
+ * Build a LOAD DATA LOCAL INFILE query performing the CSV import set up by the field mapper,
+ * reading the rows supplied by an SPLocalInfileFileSource.  Returns nil if the import can't
+ * be expressed as a LOAD DATA query: the mapping must be a straight INSERT or REPLACE of file
+ * columns into table columns, without global values, UPDATE or ON DUPLICATE KEY UPDATE
+ * semantics, or geometry or bit columns needing conversion.
+ */
+- (NSString *)_loadDataQueryForCSVFile:(NSString *)filename
+{
+	NSUInteger i;
+
+	if (importMethodIsUpdate || fieldMappingArrayHasGlobalVariables || csvImportMethodHasTail) return nil;
+	if (!numberOfImportDataColumns) return nil;
+
+	// Check the mapped columns don't need conversion, and map to file columns
+	for (i = 0; i < [fieldMappingArray count]; i++) {
+		if ([NSArrayObjectAtIndex(fieldMapperOperator, i) integerValue] != 0) continue;
+		NSString *fieldName = NSArrayObjectAtIndex(fieldMappingTableColumnNames, i);
+		if ([geometryFields containsObject:fieldName] || [bitFields containsObject:fieldName]) return nil;
+		if ([NSArrayObjectAtIndex(fieldMappingArray, i) integerValue] >= numberOfImportDataColumns) return nil;
+	}
+
+	// The source supplies UTF-8; servers from 5.5.3 accept the full range as utf8mb4
+	NSString *charset = @"utf8";
+	if ([mySQLConnection serverVersionIsGreaterThanOrEqualTo:5 minorVersion:5 releaseVersion:3]) {
+		charset = @"utf8mb4";
+	}
+
+	NSMutableString *loadQuery = [NSMutableString stringWithString:@"LOAD DATA "];
+	if ([csvImportHeaderString rangeOfString:@"LOW_PRIORITY "].location != NSNotFound) {
+		[loadQuery appendString:@"LOW_PRIORITY "];
+	}
+	[loadQuery appendFormat:@"LOCAL INFILE %@ ", [mySQLConnection escapeAndQuoteString:[filename lastPathComponent]]];
+	if ([csvImportHeaderString hasPrefix:@"REPLACE"]) {
+		[loadQuery appendString:@"REPLACE "];
+	} else if ([csvImportHeaderString rangeOfString:@"IGNORE "].location != NSNotFound) {
+		[loadQuery appendString:@"IGNORE "];
+	}
+	[loadQuery appendFormat:@"INTO TABLE %@ CHARACTER SET %@ %@", [selectedTableTarget backtickQuotedString], charset, [SPLocalInfileFileSource loadDataFormatClause]];
+
+	// Read every file column into a user variable, then assign the mapped table columns
+	[loadQuery appendString:@" ("];
+	for (i = 0; i < (NSUInteger)numberOfImportDataColumns; i++) {
+		if (i) [loadQuery appendString:@","];
+		[loadQuery appendFormat:@"@c%lu", (unsigned long)i];
+	}
+	[loadQuery appendString:@")"];
+
+	// NULL cells arrive as \N, as the parser found them; as for INSERTs, empty strings
+	// for nullable numeric columns are also inserted as NULL
+	BOOL setClauseHasEntries = NO;
+	for (i = 0; i < [fieldMappingArray count]; i++) {
+		if ([NSArrayObjectAtIndex(fieldMapperOperator, i) integerValue] != 0) continue;
+
+		NSString *valueExpression = [NSString stringWithFormat:@"@c%ld", (long)[NSArrayObjectAtIndex(fieldMappingArray, i) integerValue]];
+		if ([nullableNumericFields containsObject:NSArrayObjectAtIndex(fieldMappingTableColumnNames, i)]) {
+			valueExpression = [NSString stringWithFormat:@"NULLIF(%@, '')", valueExpression];
+		}
+
+		[loadQuery appendString:(setClauseHasEntries) ? @", " : @" SET "];
+		[loadQuery appendFormat:@"%@ = %@", [NSArrayObjectAtIndex(fieldMappingTableColumnNames, i) backtickQuotedString], valueExpression];
+		setClauseHasEntries = YES;
+	}
+	if (!setClauseHasEntries) return nil;
+
+	return loadQuery;
+}
+
+/**
+ * Returns whether a LOAD DATA import would treat the rows of the CSV file as the equivalent
+ * INSERTs would.  A LOCAL load turns duplicate key and data conversion errors into warnings,
+ * skipping or adjusting rows which INSERTs would reject with errors.  That matches an IGNORE
+ * or REPLACE import; otherwise the load is only used when the target table has no unique
+ * keys to duplicate and strict mode is off, so that INSERTs would also only warn.
+ */
+- (BOOL)_loadDataTreatsCSVRowsLikeInserts
+{
+	if ([csvImportHeaderString hasPrefix:@"REPLACE"] || [csvImportHeaderString rangeOfString:@"IGNORE "].location != NSNotFound) return YES;
+
+	id sqlMode = [mySQLConnection getFirstFieldFromQuery:@"SELECT @@SESSION.sql_mode"];
+	if ([mySQLConnection queryErrored] || ![sqlMode isKindOfClass:[NSString class]]) return NO;
+	if ([sqlMode rangeOfString:@"STRICT_"].location != NSNotFound) return NO;
+
+	SPMySQLResult *indexResult = [mySQLConnection queryString:[NSString stringWithFormat:@"SHOW INDEX FROM %@", [selectedTableTarget backtickQuotedString]]];
+	if ([mySQLConnection queryErrored]) return NO;
+	[indexResult setReturnDataAsStrings:YES];
+	[indexResult setDefaultRowReturnType:SPMySQLResultRowAsDictionary];
+	for (NSDictionary *eachIndex in indexResult) {
+		if ([[eachIndex objectForKey:@"Non_unique"] isEqualToString:@"0"]) return NO;
+	}
+
+	return YES;
+}
+
+/**
+ * Import a CSV file with LOAD DATA LOCAL INFILE, if the import set up by the field mapper
+ * can be expressed as a LOAD DATA query which treats its rows as INSERTs would, and the
+ * server permits local loads.  The file is read afresh and parsed with the import's
+ * settings, and the parsed rows streamed to the server, so that the rows imported are
+ * exactly those an INSERT import would insert.
+ * The load runs on a connection of its own, the only one allowed to make local loads.
+ * Returns NO if the file wasn't loaded, and the import should proceed by parsing the file;
+ * returns YES once the load has been run, adding any errors or warnings to the supplied string.
+ */
+- (BOOL)_importCSVFileUsingLoadData:(NSString *)filename encoding:(NSStringEncoding)csvEncoding rowsImported:(NSInteger *)rowsImported errors:(NSMutableString *)errors
+{
+	NSUInteger i;
+
+	NSString *loadQuery = [self _loadDataQueryForCSVFile:filename];
+	if (!loadQuery || ![self _loadDataTreatsCSVRowsLikeInserts]) return NO;
+
+	// The source parses the file data directly, which requires an ASCII-compatible encoding
+	if (![SPCSVParser canParseDataInEncoding:csvEncoding]) return NO;
+
+	// Check whether the server allows local loads
+	if (![[mySQLConnection getFirstFieldFromQuery:@"SELECT @@local_infile"] boolValue] || [mySQLConnection queryErrored]) return NO;
+
+	// Connect a load connection, matching the import connection, with local loads allowed
+	SPMySQLConnection *loadConnection = [[mySQLConnection cloneWithDelegate:tableDocumentInstance] retain];
+	[loadConnection setAllowsLocalInfile:YES];
+	if (![loadConnection connectAsCloneOfConnection:mySQLConnection] || ([tableDocumentInstance database] && ![loadConnection selectDatabase:[tableDocumentInstance database]])) {
+		[loadConnection disconnect];
+		[loadConnection release];
+		return NO;
+	}
+	NSString *sessionVariablesQuery = [mySQLConnection sessionVariablesMatchingQuery];
+	if (sessionVariablesQuery) [loadConnection queryString:sessionVariablesQuery];
+	if (csvBulkLoadSessionChanged) [loadConnection queryString:[self _csvImportBulkLoadSessionQuery]];
+
+	SPFileHandle *loadFileHandle = [SPFileHandle fileHandleForReadingAtPath:filename];
+	SPCSVParser *loadParser = [[SPCSVParser alloc] init];
+	[self _configureCSVImportParser:loadParser];
+	if (!loadFileHandle || ![loadParser setDataEncoding:csvEncoding]) {
+		[loadParser release];
+		[loadConnection disconnect];
+		[loadConnection release];
+		return NO;
+	}
+
+	SPLocalInfileFileSource *loadSource = [[SPLocalInfileFileSource alloc] initWithFileHandle:loadFileHandle parser:loadParser columnCount:(NSUInteger)numberOfImportDataColumns];
+	[loadSource setSkipsFirstRow:([importFieldNamesSwitch state] == NSOnState)];
+	[loadSource setDelegate:self];
+	[loadParser release];
+
+	csvLoadDataFileLength = (NSUInteger)[[[[NSFileManager defaultManager] attributesOfItemAtPath:filename error:NULL] objectForKey:NSFileSize] longLongValue];
+	if (!csvLoadDataFileLength) csvLoadDataFileLength = 1;
+	csvLoadDataLastProgressBytes = 0;
+
+	[loadConnection queryString:loadQuery withLocalInfileSource:loadSource];
+
+	// If the server refused the load before any data was sent, fall back to parsing the file
+	if ([loadConnection queryErrored] && ![loadSource bytesSupplied]) {
+		NSUInteger errorID = [loadConnection lastErrorID];
+		for (i = 0; i < sizeof(SPLoadDataLocalInfileRefusedErrorIDs) / sizeof(SPLoadDataLocalInfileRefusedErrorIDs[0]); i++) {
+			if (errorID == SPLoadDataLocalInfileRefusedErrorIDs[i]) {
+				[loadSource release];
+				[loadConnection disconnect];
+				[loadConnection release];
+				return NO;
+			}
+		}
+	}
+
+	if ([loadConnection queryErrored]) {
+		if (![loadSource wasCancelled]) {
+			[tableDocumentInstance showConsole:nil];
+			[errors appendFormat:NSLocalizedString(@"[ERROR] %@\n", @"error text when importing a csv file gave an error not attributable to a row"), [loadConnection lastErrorMessage]];
+		}
+	} else {
+		*rowsImported = (NSInteger)[loadConnection rowsAffectedByLastQuery];
+
+		// Rows which couldn't be loaded or converted are reported as warnings.  The server only
+		// keeps the first max_error_count of them, so the total is reported alongside the list.
+		unsigned long long warningCount = (unsigned long long)[[loadConnection getFirstFieldFromQuery:@"SELECT @@warning_count"] longLongValue];
+		unsigned long long warningsListed = 0;
+		if (warningCount) {
+			SPMySQLResult *warningsResult = [loadConnection queryString:@"SHOW WARNINGS"];
+			[warningsResult setReturnDataAsStrings:YES];
+			[warningsResult setDefaultRowReturnType:SPMySQLResultRowAsDictionary];
+			for (NSDictionary *eachWarning in warningsResult) {
+				[errors appendFormat:NSLocalizedString(@"[%@] %@\n", @"warning text when a LOAD DATA import of a csv file gave warnings; level and message"), [eachWarning objectForKey:@"Level"], [eachWarning objectForKey:@"Message"]];
+				warningsListed++;
+			}
+		}
+		if (warningCount > warningsListed) {
+			[errors appendFormat:NSLocalizedString(@"[WARNING] The import gave %llu warnings; only the first %llu are listed.\n", @"text when a LOAD DATA import of a csv file gave more warnings than could be listed; total and listed counts"), warningCount, warningsListed];
+		}
+	}
+
+	[loadSource release];
+	[loadConnection disconnect];
+	[loadConnection release];
+
+	return YES;
+}
+
+/**
+ * Returns the length in bytes to aim for when building each CSV INSERT statement: three
+ * quarters of the connection's maximum query size, up to a sensible maximum.
+ * Statements are measured in the connection encoding, so are sent without the connection
+ * having to raise the maximum query size.
+ */
+- (NSUInteger)_csvImportQueryLengthBudget
+{
+	NSUInteger queryLengthBudget = [mySQLConnection maxQuerySize] / 4 * 3;
+
+	return MIN(queryLengthBudget, SPCSVImportMaximumQueryLength);
+}
+
+/**
+ * Returns the number of rows to put in the next CSV INSERT batch, given the last batch: enough
+ * to fill the query length budget at the average row length seen, and the time budget at the
+ * rate seen, growing by at most double each time.
+ */
+- (NSUInteger)_csvImportRowsPerQueryAfterQueryOfRows:(NSUInteger)queryRowCount averageRowLength:(NSUInteger)averageRowLength queryTime:(double)queryTime rowsPerQuery:(NSUInteger)rowsPerQuery lengthBudget:(NSUInteger)lengthBudget
+{
+	NSUInteger nextRowsPerQuery = lengthBudget / MAX(1, averageRowLength);
+
+	if (queryRowCount && queryTime > 0.001) {
+		nextRowsPerQuery = MIN(nextRowsPerQuery, (NSUInteger)(queryRowCount * SPCSVImportTargetQueryTime / queryTime));
+	}
+	nextRowsPerQuery = MIN(nextRowsPerQuery, rowsPerQuery * 2);
+
+	return MAX(1, MIN(nextRowsPerQuery, SPCSVImportMaximumRowsPerQuery));
+}
+
+/**
+ * Set up a pipeline of inserter connections to run the CSV import's INSERT batches.  Batches
+ * run in parallel on several connections only for plain INSERTs into a table without an
+ * unmapped auto-increment column, where the order rows are inserted in doesn't matter;
+ * REPLACE, INSERT IGNORE and ON DUPLICATE KEY UPDATE batches run in file order on a single
+ * inserter.  Returns nil if the inserter connections can't be made.
+ */
+- (SPImportQueryPipeline *)_csvImportInsertPipeline
+{
+	NSUInteger i, inserterCount = SPCSVImportMaximumInserters;
+
+	if (![csvImportHeaderString hasPrefix:@"INSERT"] || [csvImportHeaderString rangeOfString:@"IGNORE "].location != NSNotFound || csvImportMethodHasTail) {
+		inserterCount = 1;
+	}
+	for (NSDictionary *column in [targetTableDetails objectForKey:@"columns"]) {
+		if (![[column objectForKey:@"autoincrement"] integerValue]) continue;
+		for (i = 0; i < [fieldMappingArray count]; i++) {
+			if ([NSArrayObjectAtIndex(fieldMapperOperator, i) integerValue] == 0
+				&& [NSArrayObjectAtIndex(fieldMappingTableColumnNames, i) isEqualToString:[column objectForKey:@"name"]]) break;
+		}
+		if (i == [fieldMappingArray count]) inserterCount = 1;
+	}
+
+	SPImportQueryPipeline *pipeline = [[SPImportQueryPipeline alloc] initWithConnection:mySQLConnection delegate:tableDocumentInstance workerCount:inserterCount];
+
+	// Match the session variables of the import connection, such as the SQL mode and time
+	// zone, and any bulk load settings on the inserters
+	NSMutableArray *sessionQueries = [NSMutableArray array];
+	NSString *sessionVariablesQuery = [mySQLConnection sessionVariablesMatchingQuery];
+	if (sessionVariablesQuery) [sessionQueries addObject:sessionVariablesQuery];
+	if (csvBulkLoadSessionChanged) [sessionQueries addObject:[self _csvImportBulkLoadSessionQuery]];
+	[pipeline setSessionQueries:sessionQueries];
+	[pipeline setBatchesPerTransaction:csvBulkLoadBatchesPerTransaction];
+
+	if (![pipeline startInDatabase:[tableDocumentInstance database]]) {
+		[pipeline release];
+		return nil;
+	}
+
+	return [pipeline autorelease];
+}
+
+/**
+ * Returns the target table, field mapping and file settings of the CSV import set up by the
+ * field mapper, saved with checkpoints so that an import is only resumed into the same columns.
+ */
+- (NSArray *)_csvImportCheckpointTarget
+{
+	return [NSArray arrayWithObjects:
+		selectedTableTarget,
+		[NSNumber numberWithBool:importMethodIsUpdate],
+		csvImportHeaderString,
+		(csvImportTailString ? csvImportTailString : @""),
+		fieldMappingArray,
+		fieldMappingTableColumnNames,
+		fieldMapperOperator,
+		(fieldMappingArrayHasGlobalVariables ? fieldMappingGlobalValueArray : [NSArray array]),
+		[prefs objectForKey:SPCSVImportFieldTerminator],
+		[prefs objectForKey:SPCSVImportLineTerminator],
+		[prefs objectForKey:SPCSVImportFieldEnclosedBy],
+		[prefs objectForKey:SPCSVImportFieldEscapeCharacter],
+		[NSNumber numberWithBool:[prefs boolForKey:SPCSVImportFirstLineIsHeader]],
+		nil];
+}
+
+/**
+ * Returns the storage engine of the CSV import's target table, or nil if it can't be found.
+ */
+- (NSString *)_csvImportTargetTableEngine
+{
+	NSMutableString *escapedTableName = [NSMutableString stringWithString:[selectedTableTarget tickQuotedString]];
+	[escapedTableName replaceOccurrencesOfString:@"\\" withString:@"\\\\\\\\" options:0 range:NSMakeRange(0, [escapedTableName length])];
+
+	SPMySQLResult *statusResult = [mySQLConnection queryString:[NSString stringWithFormat:@"SHOW TABLE STATUS LIKE %@", escapedTableName]];
+	if ([mySQLConnection queryErrored]) return nil;
+	[statusResult setReturnDataAsStrings:YES];
+	[statusResult setDefaultRowReturnType:SPMySQLResultRowAsDictionary];
+
+	// Underscores in the name may match other tables, so find the target; MySQL < 4.1 reports "Type"
+	for (NSDictionary *tableStatus in statusResult) {
+		if (![[tableStatus objectForKey:@"Name"] isEqualToString:selectedTableTarget]) continue;
+		return [tableStatus objectForKey:([tableStatus objectForKey:@"Engine"] ? @"Engine" : @"Type")];
+	}
+
+	return nil;
+}
+
+/**
+ * If bulk load mode is enabled, prepare the import connection and target table for a bulk
+ * load: foreign key checks are turned off for the session, as are unique checks for plain
+ * INSERT imports - REPLACE, INSERT IGNORE, ON DUPLICATE KEY UPDATE and UPDATE imports rely
+ * on the unique indexes to find the rows they replace or skip - the keys of MyISAM
+ * tables are disabled so that their indexes are rebuilt once at the end, and INSERT batches
+ * into InnoDB tables are grouped into transactions of the preferred number of batches.
+ */
+- (void)_startCSVImportBulkLoad
+{
+	csvBulkLoadSessionChanged = NO;
+	csvBulkLoadUniqueChecksDisabled = NO;
+	csvBulkLoadKeysDisabled = NO;
+	csvBulkLoadTransactionOpen = NO;
+	csvBulkLoadBatchesPerTransaction = 0;
+	csvBulkLoadTransactionBatches = 0;
+	csvBulkLoadTransactionsCommitted = 0;
+
+	if (![prefs boolForKey:SPImportUsesBulkLoadMode]) return;
+
+	csvBulkLoadUniqueChecksDisabled = (!importMethodIsUpdate
+		&& [csvImportHeaderString hasPrefix:@"INSERT"]
+		&& [csvImportHeaderString rangeOfString:@"IGNORE "].location == NSNotFound
+		&& !csvImportMethodHasTail);
+
+	[mySQLConnection queryString:[NSString stringWithFormat:@"SET @SP_OLD_UNIQUE_CHECKS=@@UNIQUE_CHECKS, @SP_OLD_FOREIGN_KEY_CHECKS=@@FOREIGN_KEY_CHECKS, %@", [[self _csvImportBulkLoadSessionQuery] substringFromIndex:4]]];
+	csvBulkLoadSessionChanged = ![mySQLConnection queryErrored];
+
+	NSString *tableEngine = [self _csvImportTargetTableEngine];
+	if ([tableEngine isEqualToString:@"MyISAM"]) {
+		[mySQLConnection queryString:[NSString stringWithFormat:@"ALTER TABLE %@ DISABLE KEYS", [selectedTableTarget backtickQuotedString]]];
+		csvBulkLoadKeysDisabled = ![mySQLConnection queryErrored];
+	}
+	else if ([tableEngine isEqualToString:@"InnoDB"]) {
+		NSInteger batchesPerTransaction = [prefs integerForKey:SPImportBulkLoadBatchesPerTransaction];
+		csvBulkLoadBatchesPerTransaction = (batchesPerTransaction > 0) ? (NSUInteger)batchesPerTransaction : 1;
+	}
+}
+
+/**
+ * Undo the bulk load preparation once the CSV import has run: any transaction still open on
+ * the import connection is committed, or rolled back if the import was cancelled or failed,
+ * keys are enabled again, rebuilding the indexes, and the session's checks are restored.
+ * Rows lost to rolled back transactions, on the import connection or the supplied pipeline,
+ * are reported in the errors.  Returns NO if the last transaction couldn't be committed.
+ */
+- (BOOL)_endCSVImportBulkLoadAtRow:(NSInteger)rowsImported committing:(BOOL)commit pipeline:(SPImportQueryPipeline *)pipeline errors:(NSMutableString *)errors
+{
+	BOOL transactionCommitted = [self _endCSVImportTransactionAtRow:rowsImported committing:commit errors:errors];
+
+	if ([pipeline rowsRolledBack]) {
+		[errors appendFormat:NSLocalizedString(@"[ERROR] The bulk load transactions open when the import stopped were rolled back, so %@ rows were not imported. %@ transactions of up to %@ queries were committed before then.\n", @"error text when CSV import transactions in bulk load mode were rolled back; rows rolled back, transactions committed and queries per transaction"),
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedLongLong:[pipeline rowsRolledBack]] numberStyle:NSNumberFormatterDecimalStyle],
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedLongLong:[pipeline transactionsCommitted]] numberStyle:NSNumberFormatterDecimalStyle],
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:[pipeline batchesPerTransaction]] numberStyle:NSNumberFormatterDecimalStyle]];
+	}
+
+	if (csvBulkLoadKeysDisabled) {
+		[[singleProgressText onMainThread] setStringValue:NSLocalizedString(@"Rebuilding indexes...", @"text showing that the app is re-enabling the keys of a table after a bulk load")];
+		[mySQLConnection queryString:[NSString stringWithFormat:@"ALTER TABLE %@ ENABLE KEYS", [selectedTableTarget backtickQuotedString]]];
+		if ([mySQLConnection queryErrored]) {
+			[errors appendFormat:NSLocalizedString(@"[ERROR] The keys of %@ could not be enabled again after the bulk load: %@\n", @"error text when re-enabling table keys after a CSV bulk load failed; table name and detail from MySQL"), selectedTableTarget, [mySQLConnection lastErrorMessage]];
+		}
+		csvBulkLoadKeysDisabled = NO;
+	}
+
+	if (csvBulkLoadSessionChanged) {
+		[mySQLConnection queryString:@"SET UNIQUE_CHECKS=@SP_OLD_UNIQUE_CHECKS, FOREIGN_KEY_CHECKS=@SP_OLD_FOREIGN_KEY_CHECKS"];
+		csvBulkLoadSessionChanged = NO;
+	}
+
+	csvBulkLoadBatchesPerTransaction = 0;
+
+	return transactionCommitted;
+}
+
+/**
+ * Stop a CSV import which is bailing out early: the pipeline's inserters are cancelled and
+ * waited for, so that their open transactions have been rolled back before the bulk load
+ * is ended and the session restored.  Returns any rows lost to those rollbacks as a report
+ * to append to the error shown, prefixed by a blank line, or an empty string.
+ */
+- (NSString *)_abandonCSVImportWithPipeline:(SPImportQueryPipeline *)pipeline rowsImported:(NSInteger)rowsImported
+{
+	NSMutableString *report = [NSMutableString string];
+
+	if (pipeline) {
+		[pipeline cancel];
+		[pipeline waitUntilFinished];
+	}
+	[self _endCSVImportBulkLoadAtRow:rowsImported committing:NO pipeline:pipeline errors:report];
+
+	if (![report length]) return @"";
+
+	return [@"\n\n" stringByAppendingString:report];
+}
+
+/**
+ * The session settings used for a bulk load, to be run on any other connection importing
+ * rows alongside the import connection.
+ */
+- (NSString *)_csvImportBulkLoadSessionQuery
+{
+	if (csvBulkLoadUniqueChecksDisabled) return @"SET UNIQUE_CHECKS=0, FOREIGN_KEY_CHECKS=0";
+
+	return @"SET FOREIGN_KEY_CHECKS=0";
+}
+
+/**
+ * Open a transaction on the import connection for the next CSV batch run there, if bulk
+ * loading into a transactional table and no transaction is open.  If the transaction can't
+ * be started, batches continue to be committed as they run.
+ */
+- (void)_beginCSVImportTransactionAtRow:(NSInteger)rowsImported
+{
+	if (!csvBulkLoadBatchesPerTransaction || csvBulkLoadTransactionOpen) return;
+
+	[mySQLConnection queryString:@"START TRANSACTION"];
+	if ([mySQLConnection queryErrored]) return;
+
+	csvBulkLoadTransactionOpen = YES;
+	csvBulkLoadTransactionBatches = 0;
+	csvBulkLoadTransactionFirstRow = rowsImported;
+}
+
+/**
+ * Count a batch as run in the open transaction on the import connection, committing the
+ * transaction once it holds the preferred number of batches.  Returns NO if the commit failed.
+ */
+- (BOOL)_commitCSVImportTransactionIfDueAtRow:(NSInteger)rowsImported errors:(NSMutableString *)errors
+{
+	if (!csvBulkLoadTransactionOpen) return YES;
+	if (++csvBulkLoadTransactionBatches < csvBulkLoadBatchesPerTransaction) return YES;
+
+	return [self _endCSVImportTransactionAtRow:rowsImported committing:YES errors:errors];
+}
+
+/**
+ * Commit or roll back the open transaction on the import connection, if any.  If the
+ * transaction is rolled back or can't be committed, the rows run in it are reported in the
+ * errors.  Returns NO if the transaction couldn't be committed.
+ */
+- (BOOL)_endCSVImportTransactionAtRow:(NSInteger)rowsImported committing:(BOOL)commit errors:(NSMutableString *)errors
+{
+	if (!csvBulkLoadTransactionOpen) return YES;
+	csvBulkLoadTransactionOpen = NO;
+
+	[mySQLConnection queryString:(commit ? @"COMMIT" : @"ROLLBACK")];
+	if (commit && ![mySQLConnection queryErrored]) {
+		csvBulkLoadTransactionsCommitted++;
+		return YES;
+	}
+
+	if (commit) {
+		[errors appendFormat:NSLocalizedString(@"[ERROR] The transaction could not be committed: %@\n", @"error text when committing a transaction of CSV import batches failed, with detail from MySQL"), [mySQLConnection lastErrorMessage]];
+	}
+	if (rowsImported > csvBulkLoadTransactionFirstRow) {
+		[errors appendFormat:NSLocalizedString(@"[ERROR] The bulk load transaction was rolled back, so rows %ld to %ld were not imported. %@ transactions of up to %@ queries were committed before then.\n", @"error text when a CSV import transaction in bulk load mode was rolled back; first and last rows lost, transactions committed and queries per transaction"),
+			(long)(csvBulkLoadTransactionFirstRow + 1), (long)rowsImported,
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:csvBulkLoadTransactionsCommitted] numberStyle:NSNumberFormatterDecimalStyle],
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:csvBulkLoadBatchesPerTransaction] numberStyle:NSNumberFormatterDecimalStyle]];
+	}
+
+	return !commit;
+}
+
+/**
+ * Returns whether the last query on the import connection failed with a deadlock within an
+ * open bulk load transaction.  The server then rolls back the whole transaction, so the
+ * error and the rows lost, up to the supplied row, are reported.
+ */
+- (BOOL)_csvImportTransactionWasRolledBackBeforeRow:(NSInteger)lastRow errors:(NSMutableString *)errors
+{
+	if (!csvBulkLoadTransactionOpen || [mySQLConnection lastErrorID] != SPImportDeadlockErrorID) return NO;
+
+	[tableDocumentInstance showConsole:nil];
+	[errors appendFormat:NSLocalizedString(@"[ERROR] %@\n", @"error text when importing a csv file gave an error not attributable to a row"), [mySQLConnection lastErrorMessage]];
+
+	// The transaction is already rolled back; report the rows lost without ending it again
+	csvBulkLoadTransactionOpen = NO;
+	[errors appendFormat:NSLocalizedString(@"[ERROR] The bulk load transaction was rolled back, so rows %ld to %ld were not imported. %@ transactions of up to %@ queries were committed before then.\n", @"error text when a CSV import transaction in bulk load mode was rolled back; first and last rows lost, transactions committed and queries per transaction"),
+		(long)(csvBulkLoadTransactionFirstRow + 1), (long)lastRow,
+		[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:csvBulkLoadTransactionsCommitted] numberStyle:NSNumberFormatterDecimalStyle],
+		[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:csvBulkLoadBatchesPerTransaction] numberStyle:NSNumberFormatterDecimalStyle]];
+
+	return YES;
+}
+
+/**
+ * Returns a description of the CSV import rate and the size of the last INSERT batch, for
+ * display in the progress sheet.
+ */
+- (NSString *)_csvImportRateStringForRowsImported:(NSInteger)rowsImported sinceTime:(double)startTime rowsPerQuery:(NSUInteger)rowsPerQuery
+{
+	double elapsedTime = [NSDate monotonicTimeInterval] - startTime;
+	double rowsPerSecond = (elapsedTime > 0) ? rowsImported / elapsedTime : 0;
+
+	if (csvBulkLoadBatchesPerTransaction) {
+		return [NSString stringWithFormat:NSLocalizedString(@"(%@ rows/s, %@ rows per query, committing every %@ queries)", @"CSV import progress rate text in bulk load mode; rows imported per second, rows in the last INSERT statement and queries per transaction"),
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithDouble:floor(rowsPerSecond)] numberStyle:NSNumberFormatterDecimalStyle],
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:rowsPerQuery] numberStyle:NSNumberFormatterDecimalStyle],
+			[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:csvBulkLoadBatchesPerTransaction] numberStyle:NSNumberFormatterDecimalStyle]];
+	}
+
+	return [NSString stringWithFormat:NSLocalizedString(@"(%@ rows/s, %@ rows per query)", @"CSV import progress rate text; rows imported per second and rows in the last INSERT statement"),
+		[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithDouble:floor(rowsPerSecond)] numberStyle:NSNumberFormatterDecimalStyle],
+		[NSNumberFormatter localizedStringFromNumber:[NSNumber numberWithUnsignedInteger:rowsPerQuery] numberStyle:NSNumberFormatterDecimalStyle]];
+}
+
+/**
+ * Update the progress interface while a CSV file is streamed to the server by LOAD DATA LOCAL
+ * INFILE; called on the import thread from within the query.  Returns NO to cancel the load.
+ */
+- (BOOL)localInfileFileSource:(SPLocalInfileFileSource *)source shouldContinueAfterParsingBytes:(unsigned long long)totalBytes
+{
+	if (progressCancelled) return NO;
+	if (totalBytes - csvLoadDataLastProgressBytes < SPLoadDataProgressUpdateInterval) return YES;
+	csvLoadDataLastProgressBytes = totalBytes;
+
+	SPFileHandle *loadFileHandle = [source fileHandle];
+	[[singleProgressBar onMainThread] setDoubleValue:[loadFileHandle realDataReadLength]];
+	if ([loadFileHandle isCompressed]) {
+		[[singleProgressText onMainThread] setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Imported %@ of CSV data", @"CSV import progress text where total size is unknown"),
+			[NSString stringForByteSize:(long long)totalBytes]]];
+	} else {
+		[[singleProgressText onMainThread] setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Imported %@ of %@", @"SQL import progress text"),
+			[NSString stringForByteSize:(long long)totalBytes], [NSString stringForByteSize:csvLoadDataFileLength]]];
+	}
+
+	return YES;
+}
+
 #pragma mark -
 
 - (void)dealloc
@@ -31,28 +31,80 @@
 //  More info at <http://code.google.com/p/sequel-pro/>
 
 #import <SPMySQL/SPMySQLStreamingResultStoreDelegate.h>
+#import <pthread.h>
 
 @class SPMySQLStreamingResultStore;
+@class SPDataStorage;
+
+/**
+ * Implemented by the owner of a virtual data storage to fetch blocks of rows as they
+ * are required.  Requests may be made on any thread, and should be serviced in the
+ * background, supplying the block's rows using -setResultStore:forVirtualBlock:.
+ */
+@protocol SPDataStorageVirtualLoader <NSObject>
+
+- (void)dataStorage:(SPDataStorage *)dataStorage needsVirtualBlock:(NSUInteger)blockIndex rowRange:(NSRange)rowRange;
+
+@end
 
 /**
  * This class wraps a SPMySQLStreamingResultStore, providing an editable
  * data store; on a fresh load all data will be proxied from the underlying
- * result store, but if cells or rows are edited, mutable rows are stored
- * directly.
+ * result store.  Edited cells are held in a sparse overlay on top of the
+ * result store, keeping only values which differ from the original, while
+ * rows added to the storage are stored directly as mutable rows.
+ *
+ * A row index map may be set to present the rows in a different order, or only a subset of
+ * them, without changing the underlying storage; all row indexes supplied to and returned
+ * by the storage then refer to positions in the map.
+ *
+ * Alternatively the storage can be virtual, representing a known number of rows of which
+ * only the blocks recently displayed are held; missing blocks are requested from a loader
+ * as their rows are accessed, and the next block in the direction of travel is prefetched.
  */
 
 @interface SPDataStorage : NSObject <SPMySQLStreamingResultStoreDelegate>
 {
 	SPMySQLStreamingResultStore *dataStorage;
 	NSPointerArray *editedRows;
+	NSPointerArray *editedCells;
 	BOOL *unloadedColumns;
 
 	NSUInteger numberOfColumns;
+
+	NSUInteger *rowIndexMap;
+	NSUInteger rowIndexMapCount;
+	NSUInteger rowIndexMapCapacity;
+
+	BOOL isVirtual;
+	NSUInteger virtualRowCount;
+	NSUInteger virtualBlockSize;
+	NSUInteger virtualBlockCacheLimit;
+	NSUInteger lastAccessedVirtualBlock;
+	NSMutableDictionary *virtualBlocks;
+	NSMutableArray *virtualBlockUsage;
+	NSMutableIndexSet *virtualBlocksRequested;
+	NSMutableDictionary *virtualEditedRows;
+	NSMutableDictionary *virtualEditedCells;
+	id <SPDataStorageVirtualLoader> virtualLoader;
+	pthread_mutex_t virtualBlockLock;
 }
 
 /* Setting result store */
 - (void) setDataStorage:(SPMySQLStreamingResultStore *) newDataStorage updatingExisting:(BOOL)updateExistingStore;
 
+/* Virtual storage */
+- (void) setVirtualRowCount:(NSUInteger)rowCount columnCount:(NSUInteger)columnCount blockSize:(NSUInteger)blockSize loader:(id <SPDataStorageVirtualLoader>)loader;
+- (void) setVirtualRowCount:(NSUInteger)rowCount;
+- (void) setResultStore:(SPMySQLStreamingResultStore *)resultStore forVirtualBlock:(NSUInteger)blockIndex;
+- (BOOL) isVirtual;
+- (BOOL) virtualRowIsLoaded:(NSUInteger)rowIndex;
+
+/* Row index map */
+- (void) setRowIndexMap:(const NSUInteger *)newRowIndexMap count:(NSUInteger)newCount;
+- (void) clearRowIndexMap;
+- (BOOL) hasRowIndexMap;
+
 /* Retrieving rows and cells */
 - (NSMutableArray *) rowContentsAtIndex:(NSUInteger)anIndex;
 - (id) cellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
@@ -81,6 +133,20 @@
 
 @end
 
+#pragma mark -
+#pragma mark Edited cell overlay
+
+/**
+ * Returns the edited value of a cell from the overlay of edits for its row, or nil if the
+ * cell hasn't been edited.  Edits are keyed by column index plus one, so that no key is
+ * NULL.
+ */
+static inline id SPDataStorageEditedCellValue(CFDictionaryRef rowEdits, NSUInteger columnIndex)
+{
+	if (!rowEdits) return nil;
+	return (id)CFDictionaryGetValue(rowEdits, (const void *)(columnIndex + 1));
+}
+
 #pragma mark -
 #pragma mark Cached method calls to remove obj-c messaging overhead in tight loops
 
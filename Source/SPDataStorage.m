@@ -37,6 +37,11 @@
 @interface SPDataStorage (Private_API)
 
 - (void) _checkNewRow:(NSMutableArray *)aRow;
+- (void) _clearVirtualStorage;
+- (SPMySQLStreamingResultStore *) _resultStoreForVirtualRow:(NSUInteger)rowIndex rowInBlock:(NSUInteger *)blockRowIndex;
+- (id) _virtualEditedValueAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
+- (id) _originalValueAtUnderlyingRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
+- (void) _setEditedValue:(id)anObject atUnderlyingRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
 
 @end
 
@@ -50,6 +55,40 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 	return SPDSGetEditedRow(rowStore, @selector(pointerAtIndex:), rowIndex);
 }
 
+static inline CFMutableDictionaryRef SPDataStorageGetEditedCells(NSPointerArray* cellStore, NSUInteger rowIndex)
+{
+	typedef CFMutableDictionaryRef (*SPDSGetEditedCellsMethodPtr)(NSPointerArray*, SEL, NSUInteger);
+	static SPDSGetEditedCellsMethodPtr SPDSGetEditedCells;
+	if (!SPDSGetEditedCells) SPDSGetEditedCells = (SPDSGetEditedCellsMethodPtr)[cellStore methodForSelector:@selector(pointerAtIndex:)];
+	return SPDSGetEditedCells(cellStore, @selector(pointerAtIndex:), rowIndex);
+}
+
+static void SPDataStorageApplyEditedCell(const void *key, const void *value, void *row)
+{
+	CFArraySetValueAtIndex((CFMutableArrayRef)row, (CFIndex)key - 1, value);
+}
+
+/**
+ * Apply a row's overlay of edited cells to a copy of its row.
+ */
+static inline void SPDataStorageApplyEditedCells(NSMutableArray *row, CFDictionaryRef rowEdits)
+{
+	if (rowEdits) CFDictionaryApplyFunction(rowEdits, SPDataStorageApplyEditedCell, row);
+}
+
+/**
+ * Translate a row index into an index in the underlying storage, using the row index map
+ * if one is set.
+ */
+static inline NSUInteger SPDataStorageUnderlyingRowIndex(NSUInteger *rowIndexMap, NSUInteger rowIndexMapCount, NSUInteger rowIndex)
+{
+	if (!rowIndexMap) return rowIndex;
+	if (rowIndex >= rowIndexMapCount) {
+		[NSException raise:NSRangeException format:@"Requested storage index (%llu) beyond bounds (%llu)", (unsigned long long)rowIndex, (unsigned long long)rowIndexMapCount];
+	}
+	return rowIndexMap[rowIndex];
+}
+
 #pragma mark - Setting result store
 
 /**
@@ -59,7 +98,10 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 - (void) setDataStorage:(SPMySQLStreamingResultStore *)newDataStorage updatingExisting:(BOOL)updateExistingStore
 {
 	NSUInteger i;
+	[self _clearVirtualStorage];
+	[self clearRowIndexMap];
 	[editedRows release], editedRows = nil;
+	[editedCells release], editedCells = nil;
 	if (unloadedColumns) free(unloadedColumns), unloadedColumns = NULL;
 
 	if (dataStorage) {
@@ -77,6 +119,7 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 
 	numberOfColumns = [dataStorage numberOfFields];
 	editedRows = [NSPointerArray new];
+	editedCells = [NSPointerArray new];
 	if ([dataStorage dataDownloaded]) {
 		[self resultStoreDidFinishLoadingData:dataStorage];
 	}
@@ -88,6 +131,145 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 }
 
 
+#pragma mark - Row index map
+
+/**
+ * Present the rows in the order listed by the supplied map of indexes into the underlying
+ * storage, which may also omit rows.  The map is copied.  Maps can't be used with virtual
+ * storage.
+ */
+- (void) setRowIndexMap:(const NSUInteger *)newRowIndexMap count:(NSUInteger)newCount
+{
+	if (isVirtual) {
+		[NSException raise:NSInternalInconsistencyException format:@"Row index maps can't be used with virtual storage"];
+	}
+
+	if (newCount > rowIndexMapCapacity || !rowIndexMap) {
+		if (rowIndexMap) free(rowIndexMap);
+		rowIndexMapCapacity = newCount ? newCount : 1;
+		rowIndexMap = malloc(rowIndexMapCapacity * sizeof(NSUInteger));
+	}
+	memcpy(rowIndexMap, newRowIndexMap, newCount * sizeof(NSUInteger));
+	rowIndexMapCount = newCount;
+}
+
+/**
+ * Remove any row index map, presenting all the rows in their underlying order.
+ */
+- (void) clearRowIndexMap
+{
+	if (rowIndexMap) free(rowIndexMap), rowIndexMap = NULL;
+	rowIndexMapCount = 0;
+	rowIndexMapCapacity = 0;
+}
+
+/**
+ * Returns whether a row index map is set.
+ */
+- (BOOL) hasRowIndexMap
+{
+	return (rowIndexMap != NULL);
+}
+
+#pragma mark - Virtual storage
+
+/**
+ * Switch the storage to virtual mode, representing the supplied number of rows without
+ * holding them.  Rows are divided into blocks of the supplied size, each of which is
+ * requested from the loader when one of its rows is first accessed; only the most recently
+ * used blocks are kept.  This will clear any existing data, edited rows and unloaded
+ * column tracking.
+ */
+- (void) setVirtualRowCount:(NSUInteger)rowCount columnCount:(NSUInteger)columnCount blockSize:(NSUInteger)blockSize loader:(id <SPDataStorageVirtualLoader>)loader
+{
+	NSUInteger i;
+	[self setDataStorage:nil updatingExisting:NO];
+
+	pthread_mutex_lock(&virtualBlockLock);
+	isVirtual = YES;
+	virtualRowCount = rowCount;
+	virtualBlockSize = blockSize ? blockSize : 1;
+	lastAccessedVirtualBlock = 0;
+	virtualLoader = loader;
+	virtualBlocks = [[NSMutableDictionary alloc] init];
+	virtualBlockUsage = [[NSMutableArray alloc] init];
+	virtualBlocksRequested = [[NSMutableIndexSet alloc] init];
+	virtualEditedRows = [[NSMutableDictionary alloc] init];
+	virtualEditedCells = [[NSMutableDictionary alloc] init];
+	pthread_mutex_unlock(&virtualBlockLock);
+
+	numberOfColumns = columnCount;
+	if (unloadedColumns) free(unloadedColumns);
+	unloadedColumns = malloc(numberOfColumns * sizeof(BOOL));
+	for (i = 0; i < numberOfColumns; i++) {
+		unloadedColumns[i] = NO;
+	}
+}
+
+/**
+ * Update the number of rows represented by a virtual storage, for example once the loader
+ * has established that an estimated row count was inaccurate.
+ */
+- (void) setVirtualRowCount:(NSUInteger)rowCount
+{
+	if (!isVirtual) return;
+
+	pthread_mutex_lock(&virtualBlockLock);
+	virtualRowCount = rowCount;
+	pthread_mutex_unlock(&virtualBlockLock);
+}
+
+/**
+ * Supply the rows of a virtual block, in the form of a fully downloaded result store.
+ * Supplying nil, for example after an error, allows the block to be requested again.
+ * If this takes the number of blocks held over the cache limit, the least recently used
+ * blocks are discarded.
+ */
+- (void) setResultStore:(SPMySQLStreamingResultStore *)resultStore forVirtualBlock:(NSUInteger)blockIndex
+{
+	if (!isVirtual) return;
+
+	NSNumber *blockKey = [NSNumber numberWithUnsignedInteger:blockIndex];
+
+	pthread_mutex_lock(&virtualBlockLock);
+	[virtualBlocksRequested removeIndex:blockIndex];
+	if (resultStore) {
+		[virtualBlocks setObject:resultStore forKey:blockKey];
+		[virtualBlockUsage removeObject:blockKey];
+		[virtualBlockUsage addObject:blockKey];
+
+		while ([virtualBlockUsage count] > virtualBlockCacheLimit) {
+			[virtualBlocks removeObjectForKey:[virtualBlockUsage objectAtIndex:0]];
+			[virtualBlockUsage removeObjectAtIndex:0];
+		}
+	}
+	pthread_mutex_unlock(&virtualBlockLock);
+}
+
+/**
+ * Returns whether the storage is virtual.
+ */
+- (BOOL) isVirtual
+{
+	return isVirtual;
+}
+
+/**
+ * Returns whether the data for a row is currently available; this is always true for
+ * storage which isn't virtual, and for edited rows.
+ */
+- (BOOL) virtualRowIsLoaded:(NSUInteger)rowIndex
+{
+	if (!isVirtual) return YES;
+
+	BOOL rowIsLoaded;
+	pthread_mutex_lock(&virtualBlockLock);
+	rowIsLoaded = [virtualEditedRows objectForKey:[NSNumber numberWithUnsignedInteger:rowIndex]] || [virtualBlocks objectForKey:[NSNumber numberWithUnsignedInteger:(rowIndex / virtualBlockSize)]];
+	pthread_mutex_unlock(&virtualBlockLock);
+
+	return rowIsLoaded;
+}
+
 #pragma mark -
 #pragma mark Retrieving rows and cells
 
@@ -96,6 +278,40 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (NSMutableArray *) rowContentsAtIndex:(NSUInteger)anIndex
 {
+	NSUInteger i;
+
+	// For virtual storage, return any edited row or the row from its block if loaded
+	if (isVirtual) {
+		NSNumber *rowKey = [NSNumber numberWithUnsignedInteger:anIndex];
+		NSMutableArray *virtualRow;
+
+		pthread_mutex_lock(&virtualBlockLock);
+		virtualRow = [[[virtualEditedRows objectForKey:rowKey] retain] autorelease];
+		pthread_mutex_unlock(&virtualBlockLock);
+		if (virtualRow) return virtualRow;
+
+		NSUInteger blockRowIndex;
+		SPMySQLStreamingResultStore *blockStore = [self _resultStoreForVirtualRow:anIndex rowInBlock:&blockRowIndex];
+		if (blockStore) {
+			virtualRow = SPMySQLResultStoreGetRow(blockStore, blockRowIndex);
+		} else {
+			virtualRow = [NSMutableArray arrayWithCapacity:numberOfColumns];
+			for (i = 0; i < numberOfColumns; i++) {
+				[virtualRow addObject:[SPNotLoaded notLoaded]];
+			}
+		}
+		for (i = 0; i < numberOfColumns; i++) {
+			if (unloadedColumns[i]) {
+				CFArraySetValueAtIndex((CFMutableArrayRef)virtualRow, i, [SPNotLoaded notLoaded]);
+			}
+		}
+		pthread_mutex_lock(&virtualBlockLock);
+		SPDataStorageApplyEditedCells(virtualRow, (CFDictionaryRef)[virtualEditedCells objectForKey:rowKey]);
+		pthread_mutex_unlock(&virtualBlockLock);
+		return virtualRow;
+	}
+
+	anIndex = SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, anIndex);
 
 	// If an edited row exists for the supplied index, return it
 	NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, anIndex);
@@ -107,12 +323,15 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 	NSMutableArray *dataArray = SPMySQLResultStoreGetRow(dataStorage, anIndex);
 
 	// Modify unloaded cells as appropriate
-	for (NSUInteger i = 0; i < numberOfColumns; i++) {
+	for (i = 0; i < numberOfColumns; i++) {
 		if (unloadedColumns[i]) {
 			CFArraySetValueAtIndex((CFMutableArrayRef)dataArray, i, [SPNotLoaded notLoaded]);
 		}
 	}
 
+	// Apply any edited cells
+	SPDataStorageApplyEditedCells(dataArray, SPDataStorageGetEditedCells(editedCells, anIndex));
+
 	return dataArray;
 }
 
@@ -121,11 +340,27 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (id) cellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
 {
+	rowIndex = SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, rowIndex);
 
-	// If an edited row exists at the supplied index, return it
-	NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
-	if (editedRow != NULL) {
-		return CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex);
+	// For virtual storage, return any edited value, which is read under the block lock
+	if (isVirtual) {
+		id editedValue = [self _virtualEditedValueAtRow:rowIndex column:columnIndex];
+		if (editedValue) {
+			return editedValue;
+		}
+	} else {
+
+		// If an edited row exists at the supplied index, return it
+		NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
+		if (editedRow != NULL) {
+			return CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex);
+		}
+
+		// If the cell has been edited, return the edited value
+		id editedValue = SPDataStorageEditedCellValue(SPDataStorageGetEditedCells(editedCells, rowIndex), columnIndex);
+		if (editedValue) {
+			return editedValue;
+		}
 	}
 
 	// Throw an exception if the column index is out of bounds
@@ -138,6 +373,14 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 		return [SPNotLoaded notLoaded];
 	}
 
+	// For virtual storage, return the content from the row's block, if loaded
+	if (isVirtual) {
+		NSUInteger blockRowIndex;
+		SPMySQLStreamingResultStore *blockStore = [self _resultStoreForVirtualRow:rowIndex rowInBlock:&blockRowIndex];
+		if (!blockStore) return [SPNotLoaded notLoaded];
+		return SPMySQLResultStoreObjectAtRowAndColumn(blockStore, blockRowIndex, columnIndex);
+	}
+
 	// Return the content
 	return SPMySQLResultStoreObjectAtRowAndColumn(dataStorage, rowIndex, columnIndex);
 }
@@ -148,11 +391,17 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (id) cellPreviewAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex previewLength:(NSUInteger)previewLength
 {
+	rowIndex = SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, rowIndex);
 
 	// If an edited row exists at the supplied index, return it
-	NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
-	if (editedRow != NULL) {
-		id anObject = CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex);
+	id anObject;
+	if (isVirtual) {
+		anObject = [self _virtualEditedValueAtRow:rowIndex column:columnIndex];
+	} else {
+		NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
+		anObject = (editedRow != NULL) ? CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex) : SPDataStorageEditedCellValue(SPDataStorageGetEditedCells(editedCells, rowIndex), columnIndex);
+	}
+	if (anObject) {
 		if ([anObject isKindOfClass:[NSString class]] && [(NSString *)anObject length] > 150) {
 			return ([NSString stringWithFormat:@"%@...", [anObject substringToIndex:147]]);
 		}
@@ -169,6 +418,14 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 		return [SPNotLoaded notLoaded];
 	}
 
+	// For virtual storage, return the content from the row's block, if loaded
+	if (isVirtual) {
+		NSUInteger blockRowIndex;
+		SPMySQLStreamingResultStore *blockStore = [self _resultStoreForVirtualRow:rowIndex rowInBlock:&blockRowIndex];
+		if (!blockStore) return [SPNotLoaded notLoaded];
+		return SPMySQLResultStorePreviewAtRowAndColumn(blockStore, blockRowIndex, columnIndex, previewLength);
+	}
+
 	// Return the content
 	return SPMySQLResultStorePreviewAtRowAndColumn(dataStorage, rowIndex, columnIndex, previewLength);
 }
@@ -178,10 +435,21 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (BOOL) cellIsNullOrUnloadedAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
 {
-	// If an edited row exists at the supplied index, check it for a NULL.
-	NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
-	if (editedRow != NULL) {
-		return [(id)CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex) isNSNull];
+	rowIndex = SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, rowIndex);
+
+	// If an edited row or cell exists at the supplied index, check it for a NULL.
+	id editedValue;
+	if (isVirtual) {
+		editedValue = [self _virtualEditedValueAtRow:rowIndex column:columnIndex];
+	} else {
+		NSMutableArray *editedRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
+		if (editedRow != NULL) {
+			return [(id)CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex) isNSNull];
+		}
+		editedValue = SPDataStorageEditedCellValue(SPDataStorageGetEditedCells(editedCells, rowIndex), columnIndex);
+	}
+	if (editedValue) {
+		return [editedValue isNSNull];
 	}
 
 	// Throw an exception if the column index is out of bounds
@@ -193,6 +461,12 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 		return YES;
 	}
 
+	if (isVirtual) {
+		NSUInteger blockRowIndex;
+		SPMySQLStreamingResultStore *blockStore = [self _resultStoreForVirtualRow:rowIndex rowInBlock:&blockRowIndex];
+		return !blockStore || [blockStore cellIsNullAtRow:blockRowIndex column:columnIndex];
+	}
+
 	return [dataStorage cellIsNullAtRow:rowIndex column:columnIndex];
 }
 
@@ -208,13 +482,14 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 {
 
 	// If the start index is out of bounds, return 0 to indicate end of results
-	if (state->state >= SPMySQLResultStoreGetRowCount(dataStorage)) return 0;
+	if (state->state >= [self count]) return 0;
 
 	// If an edited row exists for the supplied index, use that; otherwise use the underlying
 	// storage row
-	NSMutableArray *targetRow = SPDataStorageGetEditedRow(editedRows, state->state);
+	NSUInteger rowIndex = isVirtual ? state->state : SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, state->state);
+	NSMutableArray *targetRow = isVirtual ? [self rowContentsAtIndex:rowIndex] : SPDataStorageGetEditedRow(editedRows, rowIndex);
 	if (targetRow == NULL) {
-		targetRow = SPMySQLResultStoreGetRow(dataStorage, state->state);
+		targetRow = SPMySQLResultStoreGetRow(dataStorage, rowIndex);
 
 		// Modify unloaded cells as appropriate
 		for (NSUInteger i = 0; i < numberOfColumns; i++) {
@@ -222,6 +497,9 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 				CFArraySetValueAtIndex((CFMutableArrayRef)targetRow, i, [SPNotLoaded notLoaded]);
 			}
 		}
+
+		// Apply any edited cells
+		SPDataStorageApplyEditedCells(targetRow, SPDataStorageGetEditedCells(editedCells, rowIndex));
 	}
 
 	// Add the item to the buffer and return the appropriate state
@@ -248,11 +526,30 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 	// Verify the row is of the correct length
 	[self _checkNewRow:aRow];
 
+	// For virtual storage, store the row as an edited row beyond the existing rows
+	if (isVirtual) {
+		pthread_mutex_lock(&virtualBlockLock);
+		[virtualEditedRows setObject:aRow forKey:[NSNumber numberWithUnsignedInteger:virtualRowCount]];
+		virtualRowCount++;
+		pthread_mutex_unlock(&virtualBlockLock);
+		return;
+	}
+
 	// Add the new row to the editable store
 	[editedRows addPointer:aRow];
+	[editedCells addPointer:NULL];
 
 	// Update the underlying store as well to keep counts correct
 	[dataStorage addDummyRow];
+
+	// Show the new row at the end of any row index map
+	if (rowIndexMap) {
+		if (rowIndexMapCount == rowIndexMapCapacity) {
+			rowIndexMapCapacity *= 2;
+			rowIndexMap = realloc(rowIndexMap, rowIndexMapCapacity * sizeof(NSUInteger));
+		}
+		rowIndexMap[rowIndexMapCount++] = (NSUInteger)SPMySQLResultStoreGetRowCount(dataStorage) - 1;
+	}
 }
 
 /**
@@ -262,7 +559,7 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (void) insertRowContents:(NSMutableArray *)aRow atIndex:(NSUInteger)anIndex
 {
-	unsigned long long numberOfRows = SPMySQLResultStoreGetRowCount(dataStorage);
+	unsigned long long numberOfRows = [self count];
 
 	// Verify the row is of the correct length
 	[self _checkNewRow:aRow];
@@ -277,8 +574,24 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 		return [self addRowWithContents:aRow];
 	}
 
+	// Rows in virtual storage are identified by position, so can't be renumbered
+	if (isVirtual) {
+		[NSException raise:NSInternalInconsistencyException format:@"Rows can only be added to the end of virtual storage"];
+	}
+
+	// If a row index map is set, add the row to the end of the underlying storage and
+	// move its entry in the map into position
+	if (rowIndexMap) {
+		[self addRowWithContents:aRow];
+		NSUInteger underlyingIndex = rowIndexMap[rowIndexMapCount - 1];
+		memmove(rowIndexMap + anIndex + 1, rowIndexMap + anIndex, (rowIndexMapCount - 1 - anIndex) * sizeof(NSUInteger));
+		rowIndexMap[anIndex] = underlyingIndex;
+		return;
+	}
+
 	// Add the new row to the editable store
 	[editedRows insertPointer:aRow atIndex:anIndex];
+	[editedCells insertPointer:NULL atIndex:anIndex];
 
 	// Update the underlying store to keep counts and indices correct
 	[dataStorage insertDummyRowAtIndex:anIndex];
@@ -289,8 +602,36 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (void) replaceRowAtIndex:(NSUInteger)anIndex withRowContents:(NSMutableArray *)aRow
 {
+	NSUInteger i;
+
 	[self _checkNewRow:aRow];
-	[editedRows replacePointerAtIndex:anIndex withPointer:aRow];
+
+	// Rows which were added to the storage are replaced directly
+	if (isVirtual) {
+		NSNumber *rowKey = [NSNumber numberWithUnsignedInteger:anIndex];
+		BOOL rowWasAdded;
+		pthread_mutex_lock(&virtualBlockLock);
+		rowWasAdded = !![virtualEditedRows objectForKey:rowKey];
+		if (rowWasAdded) {
+			[virtualEditedRows setObject:aRow forKey:rowKey];
+		} else {
+			[virtualEditedCells removeObjectForKey:rowKey];
+		}
+		pthread_mutex_unlock(&virtualBlockLock);
+		if (rowWasAdded) return;
+	} else {
+		anIndex = SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, anIndex);
+		if (SPDataStorageGetEditedRow(editedRows, anIndex)) {
+			[editedRows replacePointerAtIndex:anIndex withPointer:aRow];
+			return;
+		}
+		[editedCells replacePointerAtIndex:anIndex withPointer:NULL];
+	}
+
+	// Otherwise only cells which differ from the original row are kept
+	for (i = 0; i < numberOfColumns; i++) {
+		[self _setEditedValue:[aRow objectAtIndex:i] atUnderlyingRow:anIndex column:i];
+	}
 }
 
 /**
@@ -299,15 +640,30 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 - (void) replaceObjectInRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex withObject:(id)anObject
 {
 
-	// Make sure that the row in question is editable
-	NSMutableArray *editableRow = SPDataStorageGetEditedRow(editedRows, rowIndex);
-	if (editableRow == NULL) {
-		editableRow = [self rowContentsAtIndex:rowIndex];
-		[editedRows replacePointerAtIndex:rowIndex withPointer:editableRow];
+	NSUInteger underlyingIndex = isVirtual ? rowIndex : SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, rowIndex);
+	NSMutableArray *editableRow;
+
+	// Rows which were added to the storage are modified directly
+	if (isVirtual) {
+		pthread_mutex_lock(&virtualBlockLock);
+		editableRow = [virtualEditedRows objectForKey:[NSNumber numberWithUnsignedInteger:rowIndex]];
+		if (editableRow) [editableRow replaceObjectAtIndex:columnIndex withObject:anObject];
+		pthread_mutex_unlock(&virtualBlockLock);
+		if (editableRow) return;
+	} else {
+		editableRow = SPDataStorageGetEditedRow(editedRows, underlyingIndex);
+		if (editableRow != NULL) {
+			[editableRow replaceObjectAtIndex:columnIndex withObject:anObject];
+			return;
+		}
+	}
+
+	if (columnIndex >= numberOfColumns) {
+		[NSException raise:NSRangeException format:@"Requested storage column (col %llu) beyond bounds (%llu)", (unsigned long long)columnIndex, (unsigned long long)numberOfColumns];
 	}
 
-	// Modify the cell
-	[editableRow replaceObjectAtIndex:columnIndex withObject:anObject];
+	// Otherwise record the cell in the row's edits
+	[self _setEditedValue:anObject atUnderlyingRow:underlyingIndex column:columnIndex];
 }
 
 /**
@@ -316,13 +672,38 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 - (void) removeRowAtIndex:(NSUInteger)anIndex
 {
 
+	// Rows in virtual storage are identified by position, so only the last added row can be removed
+	if (isVirtual) {
+		pthread_mutex_lock(&virtualBlockLock);
+		if (anIndex + 1 != virtualRowCount || ![virtualEditedRows objectForKey:[NSNumber numberWithUnsignedInteger:anIndex]]) {
+			pthread_mutex_unlock(&virtualBlockLock);
+			[NSException raise:NSInternalInconsistencyException format:@"Only rows added to the end of virtual storage can be removed"];
+		}
+		[virtualEditedRows removeObjectForKey:[NSNumber numberWithUnsignedInteger:anIndex]];
+		virtualRowCount--;
+		pthread_mutex_unlock(&virtualBlockLock);
+		return;
+	}
+
+	// Remove the row's entry from any row index map, renumbering the entries beyond it
+	if (rowIndexMap) {
+		NSUInteger i, underlyingIndex = SPDataStorageUnderlyingRowIndex(rowIndexMap, rowIndexMapCount, anIndex);
+		memmove(rowIndexMap + anIndex, rowIndexMap + anIndex + 1, (rowIndexMapCount - anIndex - 1) * sizeof(NSUInteger));
+		rowIndexMapCount--;
+		for (i = 0; i < rowIndexMapCount; i++) {
+			if (rowIndexMap[i] > underlyingIndex) rowIndexMap[i]--;
+		}
+		anIndex = underlyingIndex;
+	}
+
 	// Throw an exception if the index is out of bounds
 	if (anIndex >= SPMySQLResultStoreGetRowCount(dataStorage)) {
 		[NSException raise:NSRangeException format:@"Requested storage index (%llu) beyond bounds (%llu)", (unsigned long long)anIndex, SPMySQLResultStoreGetRowCount(dataStorage)];
 	}
 
-	// Remove the row from the edited list and underlying storage
+	// Remove the row from the edited lists and underlying storage
 	[editedRows removePointerAtIndex:anIndex];
+	[editedCells removePointerAtIndex:anIndex];
 	[dataStorage removeRowAtIndex:anIndex];
 }
 
@@ -332,16 +713,32 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (void) removeRowsInRange:(NSRange)rangeToRemove
 {
+	if (isVirtual) {
+		[NSException raise:NSInternalInconsistencyException format:@"Rows can't be removed from virtual storage"];
+	}
+
+	// Mapped rows may not be contiguous in the underlying storage, so remove them individually
+	if (rowIndexMap) {
+		if (rangeToRemove.location + rangeToRemove.length > rowIndexMapCount) {
+			[NSException raise:NSRangeException format:@"Requested storage index (%llu) beyond bounds (%llu)", (unsigned long long)(rangeToRemove.location + rangeToRemove.length), (unsigned long long)rowIndexMapCount];
+		}
+		NSUInteger i = rangeToRemove.location + rangeToRemove.length;
+		while (i-- > rangeToRemove.location) {
+			[self removeRowAtIndex:i];
+		}
+		return;
+	}
 
 	// Throw an exception if the range is out of bounds
 	if (rangeToRemove.location + rangeToRemove.length > SPMySQLResultStoreGetRowCount(dataStorage)) {
 		[NSException raise:NSRangeException format:@"Requested storage index (%llu) beyond bounds (%llu)", (unsigned long long)(rangeToRemove.location + rangeToRemove.length), SPMySQLResultStoreGetRowCount(dataStorage)];
 	}
 
-	// Remove the rows from the edited list and underlying storage
+	// Remove the rows from the edited lists and underlying storage
 	NSUInteger i = rangeToRemove.location + rangeToRemove.length;
 	while (--i >= rangeToRemove.location) {
 		[editedRows removePointerAtIndex:i];
+		[editedCells removePointerAtIndex:i];
 	}
 	[dataStorage removeRowsInRange:rangeToRemove];
 }
@@ -351,7 +748,20 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (void) removeAllRows
 {
+	if (isVirtual) {
+		pthread_mutex_lock(&virtualBlockLock);
+		virtualRowCount = 0;
+		[virtualEditedRows removeAllObjects];
+		[virtualEditedCells removeAllObjects];
+		[virtualBlocks removeAllObjects];
+		[virtualBlockUsage removeAllObjects];
+		[virtualBlocksRequested removeAllIndexes];
+		pthread_mutex_unlock(&virtualBlockLock);
+		return;
+	}
+	[self clearRowIndexMap];
 	[editedRows setCount:0];
+	[editedCells setCount:0];
 	[dataStorage removeAllRows];
 }
 
@@ -376,6 +786,8 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (NSUInteger) count
 {
+	if (isVirtual) return virtualRowCount;
+	if (rowIndexMap) return rowIndexMapCount;
 	return (NSUInteger)[dataStorage numberOfRows];
 }
 
@@ -392,7 +804,7 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
  */
 - (BOOL) dataDownloaded
 {
-	return !dataStorage || [dataStorage dataDownloaded];
+	return isVirtual || !dataStorage || [dataStorage dataDownloaded];
 }
 
 #pragma mark - Delegate callback methods
@@ -403,6 +815,7 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 - (void)resultStoreDidFinishLoadingData:(SPMySQLStreamingResultStore *)resultStore
 {
 	[editedRows setCount:(NSUInteger)[resultStore numberOfRows]];
+	[editedCells setCount:(NSUInteger)[resultStore numberOfRows]];
 }
 
 /**
@@ -414,17 +827,39 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 	if ((self = [super init])) {
 		dataStorage = nil;
 		editedRows = nil;
+		editedCells = nil;
 		unloadedColumns = NULL;
 
 		numberOfColumns = 0;
+
+		rowIndexMap = NULL;
+		rowIndexMapCount = 0;
+		rowIndexMapCapacity = 0;
+
+		isVirtual = NO;
+		virtualRowCount = 0;
+		virtualBlockSize = 0;
+		virtualBlockCacheLimit = 32;
+		lastAccessedVirtualBlock = 0;
+		virtualBlocks = nil;
+		virtualBlockUsage = nil;
+		virtualBlocksRequested = nil;
+		virtualEditedRows = nil;
+		virtualEditedCells = nil;
+		virtualLoader = nil;
+		pthread_mutex_init(&virtualBlockLock, NULL);
 	}
 	return self;
 }
 
 - (void) dealloc {
+	[self _clearVirtualStorage];
+	pthread_mutex_destroy(&virtualBlockLock);
 	[dataStorage release], dataStorage = nil;
 	[editedRows release], editedRows = nil;
+	[editedCells release], editedCells = nil;
 	if (unloadedColumns) free(unloadedColumns), unloadedColumns = NULL;
+	if (rowIndexMap) free(rowIndexMap), rowIndexMap = NULL;
 
 	[super dealloc];
 }
@@ -440,5 +875,175 @@ static inline NSMutableArray* SPDataStorageGetEditedRow(NSPointerArray* rowStore
 	}
 }
 
+/**
+ * Leave virtual mode, discarding all held blocks and edited rows.
+ */
+- (void) _clearVirtualStorage
+{
+	if (!isVirtual) return;
+
+	pthread_mutex_lock(&virtualBlockLock);
+	isVirtual = NO;
+	virtualRowCount = 0;
+	virtualLoader = nil;
+	[virtualBlocks release], virtualBlocks = nil;
+	[virtualBlockUsage release], virtualBlockUsage = nil;
+	[virtualBlocksRequested release], virtualBlocksRequested = nil;
+	[virtualEditedRows release], virtualEditedRows = nil;
+	[virtualEditedCells release], virtualEditedCells = nil;
+	pthread_mutex_unlock(&virtualBlockLock);
+}
+
+/**
+ * Returns the result store holding the block containing the supplied virtual row, and
+ * the index of the row within it, marking the block as recently used.  If the block isn't
+ * loaded it is requested from the loader and nil is returned.  When moving to a different
+ * block, the following block in the same direction is also requested so that scrolling
+ * doesn't stall at block boundaries.
+ */
+- (SPMySQLStreamingResultStore *) _resultStoreForVirtualRow:(NSUInteger)rowIndex rowInBlock:(NSUInteger *)blockRowIndex
+{
+	NSUInteger blockIndex = rowIndex / virtualBlockSize;
+	NSUInteger lastBlockIndex;
+	NSUInteger blockToRequest = NSNotFound, blockToPrefetch = NSNotFound;
+	NSNumber *blockKey = [NSNumber numberWithUnsignedInteger:blockIndex];
+	SPMySQLStreamingResultStore *blockStore;
+
+	*blockRowIndex = rowIndex % virtualBlockSize;
+
+	pthread_mutex_lock(&virtualBlockLock);
+
+	// Retain the store so that it survives being discarded by another thread while in use
+	blockStore = [[[virtualBlocks objectForKey:blockKey] retain] autorelease];
+
+	if (!blockStore) {
+		if (![virtualBlocksRequested containsIndex:blockIndex]) {
+			[virtualBlocksRequested addIndex:blockIndex];
+			blockToRequest = blockIndex;
+		}
+	} else if (blockIndex != lastAccessedVirtualBlock) {
+		[virtualBlockUsage removeObject:blockKey];
+		[virtualBlockUsage addObject:blockKey];
+	}
+
+	// The final block may hold fewer rows than the block size
+	if (blockStore && *blockRowIndex >= (NSUInteger)[blockStore numberOfRows]) blockStore = nil;
+
+	if (blockIndex != lastAccessedVirtualBlock) {
+		lastBlockIndex = virtualRowCount ? (virtualRowCount - 1) / virtualBlockSize : 0;
+		if (blockIndex > lastAccessedVirtualBlock && blockIndex < lastBlockIndex) blockToPrefetch = blockIndex + 1;
+		else if (blockIndex < lastAccessedVirtualBlock && blockIndex > 0) blockToPrefetch = blockIndex - 1;
+
+		if (blockToPrefetch != NSNotFound) {
+			if ([virtualBlocks objectForKey:[NSNumber numberWithUnsignedInteger:blockToPrefetch]] || [virtualBlocksRequested containsIndex:blockToPrefetch]) {
+				blockToPrefetch = NSNotFound;
+			} else {
+				[virtualBlocksRequested addIndex:blockToPrefetch];
+			}
+		}
+		lastAccessedVirtualBlock = blockIndex;
+	}
+
+	pthread_mutex_unlock(&virtualBlockLock);
+
+	// Request blocks outside the lock, as the loader may supply them synchronously.  The
+	// block being looked at is requested last, so that it is the most recent request.
+	if (blockToPrefetch != NSNotFound) {
+		[virtualLoader dataStorage:self needsVirtualBlock:blockToPrefetch rowRange:NSMakeRange(blockToPrefetch * virtualBlockSize, virtualBlockSize)];
+	}
+	if (blockToRequest != NSNotFound) {
+		[virtualLoader dataStorage:self needsVirtualBlock:blockToRequest rowRange:NSMakeRange(blockToRequest * virtualBlockSize, virtualBlockSize)];
+	}
+
+	return blockStore;
+}
+
+/**
+ * Returns any edited value for a cell in virtual storage, from an added row or from the
+ * row's edited cells, or nil if the cell hasn't been edited.  The edits are read under the
+ * block lock and the value retained, so it survives being replaced by another thread.
+ */
+- (id) _virtualEditedValueAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
+{
+	NSNumber *rowKey = [NSNumber numberWithUnsignedInteger:rowIndex];
+	id editedValue;
+
+	pthread_mutex_lock(&virtualBlockLock);
+	NSMutableArray *editedRow = [virtualEditedRows objectForKey:rowKey];
+	if (editedRow) {
+		editedValue = (id)CFArrayGetValueAtIndex((CFArrayRef)editedRow, columnIndex);
+	} else {
+		editedValue = SPDataStorageEditedCellValue((CFDictionaryRef)[virtualEditedCells objectForKey:rowKey], columnIndex);
+	}
+	[[editedValue retain] autorelease];
+	pthread_mutex_unlock(&virtualBlockLock);
+
+	return editedValue;
+}
+
+/**
+ * Returns the value of a cell as held in the result store, before any edits; for virtual
+ * storage, nil is returned if the row's block isn't loaded.
+ */
+- (id) _originalValueAtUnderlyingRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
+{
+	if (unloadedColumns[columnIndex]) return [SPNotLoaded notLoaded];
+
+	if (isVirtual) {
+		NSUInteger blockRowIndex;
+		SPMySQLStreamingResultStore *blockStore = [self _resultStoreForVirtualRow:rowIndex rowInBlock:&blockRowIndex];
+		return blockStore ? SPMySQLResultStoreObjectAtRowAndColumn(blockStore, blockRowIndex, columnIndex) : nil;
+	}
+
+	return SPMySQLResultStoreObjectAtRowAndColumn(dataStorage, rowIndex, columnIndex);
+}
+
+/**
+ * Record the edited value of a cell in its row's overlay of edits, creating the overlay
+ * as required.  A value matching the original is removed from the overlay instead, and
+ * the overlay is discarded once it holds no edits, so that rows edited back to their
+ * original values are once again read straight from the result store.  For virtual
+ * storage the overlays are changed with the virtual block lock held, as rows may be read
+ * on other threads.
+ */
+- (void) _setEditedValue:(id)anObject atUnderlyingRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
+{
+	NSNumber *rowKey = isVirtual ? [NSNumber numberWithUnsignedInteger:rowIndex] : nil;
+	const void *cellKey = (const void *)(columnIndex + 1);
+
+	// Look up the original value first, as this may lock and request the row's block
+	BOOL valueIsOriginal = [anObject isEqual:[self _originalValueAtUnderlyingRow:rowIndex column:columnIndex]];
+
+	if (isVirtual) pthread_mutex_lock(&virtualBlockLock);
+
+	CFMutableDictionaryRef rowEdits = isVirtual ? (CFMutableDictionaryRef)[virtualEditedCells objectForKey:rowKey] : SPDataStorageGetEditedCells(editedCells, rowIndex);
+
+	if (valueIsOriginal) {
+		if (rowEdits) {
+			CFDictionaryRemoveValue(rowEdits, cellKey);
+			if (!CFDictionaryGetCount(rowEdits)) {
+				if (isVirtual) {
+					[virtualEditedCells removeObjectForKey:rowKey];
+				} else {
+					[editedCells replacePointerAtIndex:rowIndex withPointer:NULL];
+				}
+			}
+		}
+	} else {
+		if (!rowEdits) {
+			rowEdits = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+			if (isVirtual) {
+				[virtualEditedCells setObject:(id)rowEdits forKey:rowKey];
+			} else {
+				[editedCells replacePointerAtIndex:rowIndex withPointer:rowEdits];
+			}
+			CFRelease(rowEdits);
+		}
+
+		CFDictionarySetValue(rowEdits, cellKey, anObject);
+	}
+
+	if (isVirtual) pthread_mutex_unlock(&virtualBlockLock);
+}
 
 @end
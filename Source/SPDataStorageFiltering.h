@@ -0,0 +1,91 @@
+//
+//  $Id$
+//
+//  SPDataStorageFiltering.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+#import "SPDataStorage.h"
+
+typedef enum {
+	SPDataStorageFilterEquals = 0,
+	SPDataStorageFilterNotEquals,
+	SPDataStorageFilterGreaterThan,
+	SPDataStorageFilterLessThan,
+	SPDataStorageFilterGreaterThanOrEqual,
+	SPDataStorageFilterLessThanOrEqual,
+	SPDataStorageFilterBetween,
+	SPDataStorageFilterIn,
+	SPDataStorageFilterLike,
+	SPDataStorageFilterNotLike,
+	SPDataStorageFilterRegexp,
+	SPDataStorageFilterNotRegexp,
+	SPDataStorageFilterIsNull,
+	SPDataStorageFilterIsNotNull
+} SPDataStorageFilterOperator;
+
+/**
+ * A single content filter condition on one column, created from the clause of a content
+ * filter and the arguments entered for it.  Only clauses made up of a plain comparison,
+ * BETWEEN, IN, LIKE, REGEXP or NULL test can be evaluated locally; anything else has to
+ * be run by the server.
+ */
+@interface SPDataStorageFilter : NSObject
+{
+	SPDataStorageFilterOperator filterOperator;
+	NSUInteger columnIndex;
+	NSArray *arguments;
+	BOOL caseSensitive;
+}
+
++ (SPDataStorageFilter *)filterWithClause:(NSString *)clause columnIndex:(NSUInteger)column arguments:(NSArray *)filterArguments caseSensitive:(BOOL)isCaseSensitive;
+
+- (id)initWithOperator:(SPDataStorageFilterOperator)anOperator columnIndex:(NSUInteger)column arguments:(NSArray *)filterArguments caseSensitive:(BOOL)isCaseSensitive;
+
+- (SPDataStorageFilterOperator)filterOperator;
+- (NSUInteger)columnIndex;
+- (NSArray *)arguments;
+- (BOOL)isCaseSensitive;
+
+- (BOOL)narrowsFilter:(SPDataStorageFilter *)otherFilter;
+- (BOOL)matchesValue:(id)value columnDefinition:(NSDictionary *)columnDefinition stringEncoding:(NSStringEncoding)stringEncoding;
+
+@end
+
+/**
+ * Filters the rows held in a data storage instance in memory, without querying the server
+ * again.  Cells are matched directly against the bytes received from the server, and the
+ * rows which match are set as the storage's row index map, keeping their current order; a
+ * filter which narrows the previous one therefore only needs to look at the rows which
+ * are already shown.
+ */
+@interface SPDataStorage (SPDataStorageFiltering)
+
+- (BOOL) restrictRowsToMatchesOfFilter:(SPDataStorageFilter *)filter columnDefinitions:(NSArray *)columnDefinitions stringEncoding:(NSStringEncoding)stringEncoding;
+
+@end
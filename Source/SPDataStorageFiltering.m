@@ -0,0 +1,931 @@
+//
+//  $Id$
+//
+//  SPDataStorageFiltering.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+#import "SPDataStorageFiltering.h"
+#import "SPObjectAdditions.h"
+#import "RegexKitLite.h"
+#import <SPMySQL/SPMySQLStreamingResultStore.h>
+
+#import <regex.h>
+#ifdef __SSE2__
+#import <emmintrin.h>
+#endif
+
+// Text matched without regard to case is also compared without regard to accents, as
+// MySQL's default collations do
+#define SPDataStorageFilterFoldingOptions (kCFCompareCaseInsensitive | kCFCompareDiacriticInsensitive | kCFCompareWidthInsensitive)
+
+typedef enum {
+	SPDataStorageFilterValueString,
+	SPDataStorageFilterValueBinary,
+	SPDataStorageFilterValueSigned,
+	SPDataStorageFilterValueUnsigned,
+	SPDataStorageFilterValueDouble,
+	SPDataStorageFilterValueDate
+} SPDataStorageFilterValueType;
+
+typedef struct {
+	long long signedValue;
+	unsigned long long unsignedValue;
+	double doubleValue;
+} SPDataStorageFilterNumber;
+
+typedef struct {
+	SPDataStorageFilterOperator filterOperator;
+	SPDataStorageFilterValueType valueType;
+	BOOL foldsCase;
+	BOOL comparesAsDouble;
+	BOOL patternIsUTF8;
+	BOOL patternIsSubstring;
+	CFStringEncoding cfStringEncoding;
+
+	NSUInteger argumentCount;
+	const char **argumentBytes;
+	NSUInteger *argumentLengths;
+	SPDataStorageFilterNumber *argumentNumbers;
+
+	regex_t regex;
+	BOOL hasRegex;
+
+	char *scratch;
+	NSUInteger scratchSize;
+} SPDataStorageFilterMatcher;
+
+static BOOL _SPDataStorageFilterMatchesCell(SPDataStorageFilterMatcher *matcher, const char *bytes, NSUInteger length);
+static const char *_SPDataStorageFilterBytesForObject(id value, NSStringEncoding stringEncoding, NSUInteger *length);
+static BOOL _SPDataStorageFilterSetUpMatcher(SPDataStorageFilterMatcher *matcher, SPDataStorageFilter *filter, NSDictionary *columnDefinition, NSStringEncoding stringEncoding, NSMutableArray *argumentData);
+static void _SPDataStorageFilterTearDownMatcher(SPDataStorageFilterMatcher *matcher);
+
+#pragma mark - Filter arguments
+
+/**
+ * Remove the escapes the server would interpret from an argument: \n, \r and \t become the
+ * characters they represent and any other backslash is literal.  In LIKE patterns \% and
+ * \_ remain escaped wildcards, and literal backslashes are escaped for the pattern matcher.
+ */
+static NSString *_SPDataStorageFilterUnescapedArgument(NSString *argument, BOOL forLikePattern)
+{
+	NSUInteger i, length = [argument length];
+	NSMutableString *unescaped = [NSMutableString stringWithCapacity:length];
+
+	for (i = 0; i < length; i++) {
+		unichar character = [argument characterAtIndex:i];
+
+		if (character == '\\') {
+			unichar next = (i + 1 < length) ? [argument characterAtIndex:i + 1] : 0;
+
+			if (next == 'n' || next == 'r' || next == 't') {
+				[unescaped appendString:(next == 'n') ? @"\n" : (next == 'r') ? @"\r" : @"\t"];
+				i++;
+				continue;
+			}
+			if (forLikePattern) {
+				if (next == '%' || next == '_') {
+					[unescaped appendFormat:@"\\%C", next];
+					i++;
+				} else {
+					[unescaped appendString:@"\\\\"];
+				}
+				continue;
+			}
+		}
+
+		[unescaped appendFormat:@"%C", character];
+	}
+
+	return unescaped;
+}
+
+/**
+ * Split the argument of an IN clause into its values.  Quoted values are returned as
+ * strings and unquoted values as numbers; returns nil if the list contains anything else,
+ * such as column names or expressions, which has to be evaluated by the server.
+ */
+static NSArray *_SPDataStorageFilterValuesInList(NSString *list)
+{
+	NSMutableArray *values = [NSMutableArray array];
+	NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+	NSUInteger i = 0, length = [list length];
+
+	while (i < length) {
+		while (i < length && [whitespace characterIsMember:[list characterAtIndex:i]]) i++;
+		if (i == length) return nil;
+
+		unichar quote = [list characterAtIndex:i];
+
+		// Quoted strings, which may contain escaped or doubled quotes
+		if (quote == '\'' || quote == '"') {
+			NSMutableString *value = [NSMutableString string];
+			BOOL closed = NO;
+
+			for (i++; i < length; i++) {
+				unichar character = [list characterAtIndex:i];
+				if (character == '\\' && i + 1 < length) {
+					unichar next = [list characterAtIndex:++i];
+					[value appendFormat:@"%C", (unichar)((next == 'n') ? '\n' : (next == 'r') ? '\r' : (next == 't') ? '\t' : next)];
+				} else if (character == quote) {
+					if (i + 1 < length && [list characterAtIndex:i + 1] == quote) {
+						[value appendFormat:@"%C", quote];
+						i++;
+					} else {
+						closed = YES;
+						i++;
+						break;
+					}
+				} else {
+					[value appendFormat:@"%C", character];
+				}
+			}
+			if (!closed) return nil;
+			[values addObject:value];
+
+		// Unquoted values must be numbers
+		} else {
+			NSUInteger valueStart = i;
+			while (i < length && [list characterAtIndex:i] != ',') i++;
+			NSString *value = [[list substringWithRange:NSMakeRange(valueStart, i - valueStart)] stringByTrimmingCharactersInSet:whitespace];
+			if (![value isMatchedByRegex:@"^[+-]?(\\d+\\.?\\d*|\\.\\d+)([eE][+-]?\\d+)?$"]) return nil;
+			[values addObject:[NSDecimalNumber decimalNumberWithString:value locale:[NSDictionary dictionaryWithObject:@"." forKey:NSLocaleDecimalSeparator]]];
+		}
+
+		while (i < length && [whitespace characterIsMember:[list characterAtIndex:i]]) i++;
+		if (i < length) {
+			if ([list characterAtIndex:i] != ',') return nil;
+			i++;
+			if (i == length) return nil;
+		}
+	}
+
+	return [values count] ? values : nil;
+}
+
+@implementation SPDataStorageFilter
+
+/**
+ * Returns a filter for the supplied content filter clause, as found in the content filter
+ * definitions, with its ${} placeholders taking the arguments in order.  Returns nil if
+ * the clause can't be evaluated locally.
+ */
++ (SPDataStorageFilter *)filterWithClause:(NSString *)clause columnIndex:(NSUInteger)column arguments:(NSArray *)filterArguments caseSensitive:(BOOL)isCaseSensitive
+{
+	NSMutableString *normalisedClause = [NSMutableString stringWithString:clause];
+	SPDataStorageFilterOperator filterOperator;
+	NSArray *values = nil;
+	NSArray *captures;
+
+	// Case sensitivity is supplied separately, and the column is implied
+	[normalisedClause replaceOccurrencesOfRegex:@"(?<!\\\\)\\$BINARY\\s*" withString:@""];
+	[normalisedClause flushCachedRegexData];
+	[normalisedClause replaceOccurrencesOfRegex:@"\\s+" withString:@" "];
+	[normalisedClause flushCachedRegexData];
+	NSString *trimmedClause = [normalisedClause stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+
+	// Comparisons against a single quoted argument
+	if ([(captures = [trimmedClause captureComponentsMatchedByRegex:@"^(=|!=|<>|>=|<=|>|<) ?(['\"])\\$\\{\\}\\2$"]) count]) {
+		if ([filterArguments count] != 1) return nil;
+		NSString *comparison = [captures objectAtIndex:1];
+		if ([comparison isEqualToString:@"="]) filterOperator = SPDataStorageFilterEquals;
+		else if ([comparison isEqualToString:@">"]) filterOperator = SPDataStorageFilterGreaterThan;
+		else if ([comparison isEqualToString:@"<"]) filterOperator = SPDataStorageFilterLessThan;
+		else if ([comparison isEqualToString:@">="]) filterOperator = SPDataStorageFilterGreaterThanOrEqual;
+		else if ([comparison isEqualToString:@"<="]) filterOperator = SPDataStorageFilterLessThanOrEqual;
+		else filterOperator = SPDataStorageFilterNotEquals;
+		values = [NSArray arrayWithObject:_SPDataStorageFilterUnescapedArgument([filterArguments objectAtIndex:0], NO)];
+	}
+
+	// Ranges between two quoted arguments
+	else if ([trimmedClause isMatchedByRegex:@"(?i)^BETWEEN (['\"])\\$\\{\\}\\1 AND (['\"])\\$\\{\\}\\2$"]) {
+		if ([filterArguments count] != 2) return nil;
+		filterOperator = SPDataStorageFilterBetween;
+		values = [NSArray arrayWithObjects:_SPDataStorageFilterUnescapedArgument([filterArguments objectAtIndex:0], NO), _SPDataStorageFilterUnescapedArgument([filterArguments objectAtIndex:1], NO), nil];
+	}
+
+	// Lists of values
+	else if ([trimmedClause isMatchedByRegex:@"(?i)^IN ?\\( ?\\$\\{\\} ?\\)$"]) {
+		if ([filterArguments count] != 1) return nil;
+		filterOperator = SPDataStorageFilterIn;
+		values = _SPDataStorageFilterValuesInList([filterArguments objectAtIndex:0]);
+		if (!values) return nil;
+	}
+
+	// LIKE patterns, which may have fixed text - usually wildcards - around the argument
+	else if ([(captures = [trimmedClause captureComponentsMatchedByRegex:@"(?i)^(NOT )?LIKE (['\"])([^'\"$\\\\]*)\\$\\{\\}([^'\"$\\\\]*)\\2$"]) count]) {
+		if ([filterArguments count] != 1) return nil;
+		filterOperator = [[captures objectAtIndex:1] length] ? SPDataStorageFilterNotLike : SPDataStorageFilterLike;
+		values = [NSArray arrayWithObject:[NSString stringWithFormat:@"%@%@%@", [captures objectAtIndex:3], _SPDataStorageFilterUnescapedArgument([filterArguments objectAtIndex:0], YES), [captures objectAtIndex:4]]];
+	}
+	else if ([(captures = [trimmedClause captureComponentsMatchedByRegex:@"(?i)^(NOT )?LIKE (['\"])([^'\"$\\\\]*)\\2$"]) count]) {
+		filterOperator = [[captures objectAtIndex:1] length] ? SPDataStorageFilterNotLike : SPDataStorageFilterLike;
+		values = [NSArray arrayWithObject:[captures objectAtIndex:3]];
+	}
+
+	// Regular expressions
+	else if ([(captures = [trimmedClause captureComponentsMatchedByRegex:@"(?i)^(NOT )?REGEXP (['\"])\\$\\{\\}\\2$"]) count]) {
+		if ([filterArguments count] != 1) return nil;
+		filterOperator = [[captures objectAtIndex:1] length] ? SPDataStorageFilterNotRegexp : SPDataStorageFilterRegexp;
+		values = [NSArray arrayWithObject:_SPDataStorageFilterUnescapedArgument([filterArguments objectAtIndex:0], NO)];
+	}
+
+	// NULL tests
+	else if ([(captures = [trimmedClause captureComponentsMatchedByRegex:@"(?i)^IS (NOT )?NULL$"]) count]) {
+		filterOperator = [[captures objectAtIndex:1] length] ? SPDataStorageFilterIsNotNull : SPDataStorageFilterIsNull;
+		values = [NSArray array];
+	}
+
+	else {
+		return nil;
+	}
+
+	return [[[SPDataStorageFilter alloc] initWithOperator:filterOperator columnIndex:column arguments:values caseSensitive:isCaseSensitive] autorelease];
+}
+
+/**
+ * Initialise a filter directly; LIKE patterns and REGEXP expressions are supplied as they
+ * would be seen by the server once the SQL string has been parsed.
+ */
+- (id)initWithOperator:(SPDataStorageFilterOperator)anOperator columnIndex:(NSUInteger)column arguments:(NSArray *)filterArguments caseSensitive:(BOOL)isCaseSensitive
+{
+	if ((self = [super init])) {
+		filterOperator = anOperator;
+		columnIndex = column;
+		arguments = [filterArguments copy];
+		caseSensitive = isCaseSensitive;
+	}
+
+	return self;
+}
+
+- (SPDataStorageFilterOperator)filterOperator
+{
+	return filterOperator;
+}
+
+- (NSUInteger)columnIndex
+{
+	return columnIndex;
+}
+
+- (NSArray *)arguments
+{
+	return arguments;
+}
+
+- (BOOL)isCaseSensitive
+{
+	return caseSensitive;
+}
+
+/**
+ * Returns whether every row matching this filter must also match the supplied filter,
+ * allowing the rows it matched to be filtered further instead of starting again.  This
+ * covers the same filter, and LIKE patterns extended by typing further text into them.
+ */
+- (BOOL)narrowsFilter:(SPDataStorageFilter *)otherFilter
+{
+	if (!otherFilter || columnIndex != [otherFilter columnIndex] || caseSensitive != [otherFilter isCaseSensitive] || filterOperator != [otherFilter filterOperator]) return NO;
+
+	if ([arguments isEqualToArray:[otherFilter arguments]]) return YES;
+
+	if (filterOperator != SPDataStorageFilterLike) return NO;
+
+	NSString *pattern = [arguments objectAtIndex:0];
+	NSString *otherPattern = [[otherFilter arguments] objectAtIndex:0];
+
+	// Escapes make it harder to tell where literal text ends, so leave those to a full pass
+	if ([pattern rangeOfString:@"\\"].location != NSNotFound || [otherPattern rangeOfString:@"\\"].location != NSNotFound) return NO;
+
+	// Text added before a trailing wildcard, or after a leading one
+	if ([otherPattern hasSuffix:@"%"] && [pattern hasPrefix:[otherPattern stringByMatching:@"^(.*?)%*$" capture:1L]]) return YES;
+	if ([otherPattern hasPrefix:@"%"] && [pattern hasSuffix:[otherPattern stringByMatching:@"^%*(.*)$" capture:1L]]) return YES;
+
+	// Text added within a pattern that is wildcarded at both ends
+	if ([pattern length] > 1 && [otherPattern length] > 1 && [pattern hasPrefix:@"%"] && [pattern hasSuffix:@"%"] && [otherPattern hasPrefix:@"%"] && [otherPattern hasSuffix:@"%"]) {
+		NSString *otherText = [otherPattern stringByMatching:@"^%*(.*?)%*$" capture:1L];
+		if (![otherText length] || [pattern rangeOfString:otherText options:NSLiteralSearch].location != NSNotFound) return YES;
+	}
+
+	return NO;
+}
+
+/**
+ * Returns whether a single value - data as received from the server, a string, or NSNull for
+ * NULL - matches the filter, as a cell in a column with the supplied definition would.
+ * Returns NO if the filter can't be evaluated locally for the column.
+ */
+- (BOOL)matchesValue:(id)value columnDefinition:(NSDictionary *)columnDefinition stringEncoding:(NSStringEncoding)stringEncoding
+{
+	SPDataStorageFilterMatcher matcher;
+	NSMutableArray *argumentData = [[NSMutableArray alloc] init];
+	NSUInteger length = 0;
+	const char *bytes;
+	BOOL matches = NO;
+
+	memset(&matcher, 0, sizeof(SPDataStorageFilterMatcher));
+
+	if (_SPDataStorageFilterSetUpMatcher(&matcher, self, columnDefinition, stringEncoding, argumentData)) {
+		bytes = _SPDataStorageFilterBytesForObject(value, stringEncoding, &length);
+		matches = _SPDataStorageFilterMatchesCell(&matcher, bytes, length);
+	}
+
+	_SPDataStorageFilterTearDownMatcher(&matcher);
+	[argumentData release];
+
+	return matches;
+}
+
+- (void)dealloc
+{
+	if (arguments) [arguments release], arguments = nil;
+
+	[super dealloc];
+}
+
+@end
+
+@implementation SPDataStorage (SPDataStorageFiltering)
+
+#pragma mark - Byte matching
+
+static inline unsigned char _SPDataStorageFilterLowercase(unsigned char character)
+{
+	return (character >= 'A' && character <= 'Z') ? (unsigned char)(character + ('a' - 'A')) : character;
+}
+
+static inline BOOL _SPDataStorageFilterBytesAreASCII(const char *bytes, NSUInteger length)
+{
+	NSUInteger i = 0;
+
+#ifdef __SSE2__
+	for (; i + 16 <= length; i += 16) {
+		if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(bytes + i)))) return NO;
+	}
+#endif
+	for (; i < length; i++) {
+		if ((unsigned char)bytes[i] & 0x80) return NO;
+	}
+
+	return YES;
+}
+
+static inline BOOL _SPDataStorageFilterBytesEqual(const char *text, const char *needle, NSUInteger length, BOOL lowercaseText)
+{
+	NSUInteger i;
+
+	if (!lowercaseText) return !memcmp(text, needle, length);
+
+	for (i = 0; i < length; i++) {
+		if (_SPDataStorageFilterLowercase((unsigned char)text[i]) != (unsigned char)needle[i]) return NO;
+	}
+
+	return YES;
+}
+
+/**
+ * Returns whether the needle occurs in the haystack, optionally lowercasing ASCII in the
+ * haystack to match a lowercased needle.  Sixteen candidate positions are checked at a
+ * time by comparing the first and last bytes of the needle against the haystack, only
+ * comparing the whole needle where both match.
+ */
+static BOOL _SPDataStorageFilterContainsBytes(const char *haystack, NSUInteger haystackLength, const char *needle, NSUInteger needleLength, BOOL lowercaseHaystack)
+{
+	NSUInteger i = 0, lastPosition;
+	unsigned char first, last, firstFold, lastFold;
+
+	if (!needleLength) return YES;
+	if (needleLength > haystackLength) return NO;
+
+	lastPosition = haystackLength - needleLength;
+	first = (unsigned char)needle[0];
+	last = (unsigned char)needle[needleLength - 1];
+
+	// Setting the 0x20 bit lowercases ASCII letters, so is applied to the haystack where the
+	// needle has a letter; anything else this maps onto a match is rejected by the full comparison
+	firstFold = (lowercaseHaystack && first >= 'a' && first <= 'z') ? 0x20 : 0;
+	lastFold = (lowercaseHaystack && last >= 'a' && last <= 'z') ? 0x20 : 0;
+
+#ifdef __SSE2__
+	__m128i firstNeedle = _mm_set1_epi8((char)first);
+	__m128i lastNeedle = _mm_set1_epi8((char)last);
+	__m128i firstFoldMask = _mm_set1_epi8((char)firstFold);
+	__m128i lastFoldMask = _mm_set1_epi8((char)lastFold);
+
+	for (; i + 16 <= lastPosition + 1; i += 16) {
+		__m128i firstBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(haystack + i)), firstFoldMask);
+		__m128i lastBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(haystack + i + needleLength - 1)), lastFoldMask);
+		unsigned int candidates = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, firstNeedle), _mm_cmpeq_epi8(lastBlock, lastNeedle)));
+
+		while (candidates) {
+			if (_SPDataStorageFilterBytesEqual(haystack + i + __builtin_ctz(candidates), needle, needleLength, lowercaseHaystack)) return YES;
+			candidates &= candidates - 1;
+		}
+	}
+#endif
+
+	for (; i <= lastPosition; i++) {
+		if (((unsigned char)haystack[i] | firstFold) != first) continue;
+		if (_SPDataStorageFilterBytesEqual(haystack + i, needle, needleLength, lowercaseHaystack)) return YES;
+	}
+
+	return NO;
+}
+
+static inline NSUInteger _SPDataStorageFilterCharacterLength(const char *bytes, NSUInteger length, BOOL isUTF8)
+{
+	NSUInteger characterLength = 1;
+
+	if (isUTF8 && ((unsigned char)bytes[0] & 0xC0) == 0xC0) {
+		while (characterLength < length && ((unsigned char)bytes[characterLength] & 0xC0) == 0x80) characterLength++;
+	}
+
+	return characterLength;
+}
+
+/**
+ * Match text against a LIKE pattern, where % matches any run of characters, _ matches a
+ * single character and a backslash escapes the following character.  On a mismatch the
+ * most recent % is extended by one character and matching resumes after it.
+ */
+static BOOL _SPDataStorageFilterMatchesLikePattern(const char *text, NSUInteger textLength, const char *pattern, NSUInteger patternLength, BOOL lowercaseText, BOOL isUTF8)
+{
+	NSUInteger t = 0, p = 0;
+	NSUInteger wildcardPattern = NSNotFound, wildcardText = 0;
+
+	while (t < textLength) {
+		if (p < patternLength) {
+			unsigned char expected = (unsigned char)pattern[p];
+			NSUInteger patternStep = 1;
+
+			if (expected == '%') {
+				wildcardPattern = ++p;
+				wildcardText = t;
+				continue;
+			}
+			if (expected == '_') {
+				t += _SPDataStorageFilterCharacterLength(text + t, textLength - t, isUTF8);
+				p++;
+				continue;
+			}
+			if (expected == '\\' && p + 1 < patternLength) {
+				expected = (unsigned char)pattern[p + 1];
+				patternStep = 2;
+			}
+			if ((lowercaseText ? _SPDataStorageFilterLowercase((unsigned char)text[t]) : (unsigned char)text[t]) == expected) {
+				t++;
+				p += patternStep;
+				continue;
+			}
+		}
+
+		if (wildcardPattern == NSNotFound) return NO;
+
+		wildcardText += _SPDataStorageFilterCharacterLength(text + wildcardText, textLength - wildcardText, isUTF8);
+		t = wildcardText;
+		p = wildcardPattern;
+	}
+
+	while (p < patternLength && pattern[p] == '%') p++;
+
+	return (p == patternLength);
+}
+
+#pragma mark - Cell values
+
+/**
+ * Fold a string for matching without regard to case or accents.
+ */
+static void _SPDataStorageFilterFoldString(CFMutableStringRef string)
+{
+	CFStringFold(string, SPDataStorageFilterFoldingOptions, NULL);
+	CFStringLowercase(string, NULL);
+}
+
+/**
+ * Returns the bytes a cell should be matched using.  Where text is matched without regard to
+ * case, ASCII text is lowercased as it is compared, but any other text is first folded into
+ * the matcher's scratch buffer as UTF-8, as the arguments were.
+ */
+static const char *_SPDataStorageFilterMatchableBytes(SPDataStorageFilterMatcher *matcher, const char *bytes, NSUInteger length, NSUInteger *matchableLength)
+{
+	*matchableLength = length;
+
+	if (!matcher->foldsCase || _SPDataStorageFilterBytesAreASCII(bytes, length)) return bytes;
+
+	CFStringRef cellString = CFStringCreateWithBytes(kCFAllocatorDefault, (const UInt8 *)bytes, (CFIndex)length, matcher->cfStringEncoding, false);
+	if (!cellString) return bytes;
+
+	CFMutableStringRef foldedString = CFStringCreateMutableCopy(kCFAllocatorDefault, 0, cellString);
+	_SPDataStorageFilterFoldString(foldedString);
+
+	CFIndex foldedLength = CFStringGetLength(foldedString);
+	NSUInteger maximumSize = (NSUInteger)CFStringGetMaximumSizeForEncoding(foldedLength, kCFStringEncodingUTF8);
+	if (maximumSize > matcher->scratchSize) {
+		matcher->scratchSize = maximumSize;
+		matcher->scratch = realloc(matcher->scratch, matcher->scratchSize);
+	}
+
+	CFIndex usedLength = 0;
+	CFStringGetBytes(foldedString, CFRangeMake(0, foldedLength), kCFStringEncodingUTF8, 0, false, (UInt8 *)matcher->scratch, (CFIndex)matcher->scratchSize, &usedLength);
+	*matchableLength = (NSUInteger)usedLength;
+
+	CFRelease(foldedString);
+	CFRelease(cellString);
+
+	return matcher->scratch;
+}
+
+/**
+ * Parse a number from its text form, as each of the types it may be compared as.
+ */
+static SPDataStorageFilterNumber _SPDataStorageFilterParseNumber(const char *bytes, NSUInteger length)
+{
+	SPDataStorageFilterNumber number;
+	char buffer[128];
+
+	if (length >= sizeof(buffer)) length = sizeof(buffer) - 1;
+	memcpy(buffer, bytes, length);
+	buffer[length] = '\0';
+
+	number.signedValue = strtoll(buffer, NULL, 10);
+	number.unsignedValue = strtoull(buffer, NULL, 10);
+	number.doubleValue = strtod(buffer, NULL);
+
+	return number;
+}
+
+/**
+ * Compare a cell against one of the filter arguments, as the column's value type requires.
+ */
+static int _SPDataStorageFilterCompareCell(SPDataStorageFilterMatcher *matcher, const char *bytes, NSUInteger length, NSUInteger argumentIndex)
+{
+	SPDataStorageFilterNumber *argumentNumber = &matcher->argumentNumbers[argumentIndex];
+	SPDataStorageFilterNumber cellNumber;
+	const char *argumentBytes = matcher->argumentBytes[argumentIndex];
+	NSUInteger argumentLength = matcher->argumentLengths[argumentIndex];
+	NSUInteger i, commonLength;
+	int result;
+
+	switch (matcher->valueType) {
+		case SPDataStorageFilterValueSigned:
+		case SPDataStorageFilterValueUnsigned:
+		case SPDataStorageFilterValueDouble:
+			cellNumber = _SPDataStorageFilterParseNumber(bytes, length);
+			if (matcher->comparesAsDouble || matcher->valueType == SPDataStorageFilterValueDouble) {
+				return (cellNumber.doubleValue > argumentNumber->doubleValue) - (cellNumber.doubleValue < argumentNumber->doubleValue);
+			}
+			if (matcher->valueType == SPDataStorageFilterValueUnsigned) {
+				return (cellNumber.unsignedValue > argumentNumber->unsignedValue) - (cellNumber.unsignedValue < argumentNumber->unsignedValue);
+			}
+			return (cellNumber.signedValue > argumentNumber->signedValue) - (cellNumber.signedValue < argumentNumber->signedValue);
+
+		// Text comparisons ignore trailing spaces, as MySQL's do; the arguments were trimmed
+		// when the matcher was set up
+		case SPDataStorageFilterValueString:
+			bytes = _SPDataStorageFilterMatchableBytes(matcher, bytes, length, &length);
+			while (length && bytes[length - 1] == ' ') length--;
+			commonLength = MIN(length, argumentLength);
+			for (i = 0; i < commonLength; i++) {
+				unsigned char cellCharacter = matcher->foldsCase ? _SPDataStorageFilterLowercase((unsigned char)bytes[i]) : (unsigned char)bytes[i];
+				if (cellCharacter != (unsigned char)argumentBytes[i]) return (cellCharacter > (unsigned char)argumentBytes[i]) ? 1 : -1;
+			}
+			return (length > argumentLength) - (length < argumentLength);
+
+		// Dates are received in a format which sorts as text
+		case SPDataStorageFilterValueDate:
+		case SPDataStorageFilterValueBinary:
+			result = memcmp(bytes, argumentBytes, MIN(length, argumentLength));
+			if (result) return (result > 0) ? 1 : -1;
+			return (length > argumentLength) - (length < argumentLength);
+	}
+
+	return 0;
+}
+
+/**
+ * Returns whether a cell, or NULL, matches the filter.  As in SQL, NULL only ever matches a
+ * test for NULL.
+ */
+static BOOL _SPDataStorageFilterMatchesCell(SPDataStorageFilterMatcher *matcher, const char *bytes, NSUInteger length)
+{
+	NSUInteger i, matchableLength;
+	const char *matchableBytes;
+	BOOL matches = NO;
+
+	if (!bytes) return (matcher->filterOperator == SPDataStorageFilterIsNull);
+
+	switch (matcher->filterOperator) {
+		case SPDataStorageFilterIsNull:
+			return NO;
+		case SPDataStorageFilterIsNotNull:
+			return YES;
+
+		case SPDataStorageFilterEquals:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) == 0;
+		case SPDataStorageFilterNotEquals:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) != 0;
+		case SPDataStorageFilterGreaterThan:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) > 0;
+		case SPDataStorageFilterLessThan:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) < 0;
+		case SPDataStorageFilterGreaterThanOrEqual:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) >= 0;
+		case SPDataStorageFilterLessThanOrEqual:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) <= 0;
+		case SPDataStorageFilterBetween:
+			return _SPDataStorageFilterCompareCell(matcher, bytes, length, 0) >= 0 && _SPDataStorageFilterCompareCell(matcher, bytes, length, 1) <= 0;
+		case SPDataStorageFilterIn:
+			for (i = 0; i < matcher->argumentCount; i++) {
+				if (_SPDataStorageFilterCompareCell(matcher, bytes, length, i) == 0) return YES;
+			}
+			return NO;
+
+		case SPDataStorageFilterLike:
+		case SPDataStorageFilterNotLike:
+			matchableBytes = _SPDataStorageFilterMatchableBytes(matcher, bytes, length, &matchableLength);
+			if (matcher->patternIsSubstring) {
+				matches = _SPDataStorageFilterContainsBytes(matchableBytes, matchableLength, matcher->argumentBytes[0], matcher->argumentLengths[0], matcher->foldsCase);
+			} else {
+				matches = _SPDataStorageFilterMatchesLikePattern(matchableBytes, matchableLength, matcher->argumentBytes[0], matcher->argumentLengths[0], matcher->foldsCase, matcher->patternIsUTF8);
+			}
+			return (matcher->filterOperator == SPDataStorageFilterLike) ? matches : !matches;
+
+		// The regular expression library requires terminated strings
+		case SPDataStorageFilterRegexp:
+		case SPDataStorageFilterNotRegexp:
+			if (length + 1 > matcher->scratchSize) {
+				matcher->scratchSize = length + 1;
+				matcher->scratch = realloc(matcher->scratch, matcher->scratchSize);
+			}
+			memcpy(matcher->scratch, bytes, length);
+			matcher->scratch[length] = '\0';
+			matches = (regexec(&matcher->regex, matcher->scratch, 0, NULL, 0) == 0);
+			return (matcher->filterOperator == SPDataStorageFilterRegexp) ? matches : !matches;
+	}
+
+	return NO;
+}
+
+/**
+ * Returns the bytes for a cell in an edited row, or NULL for NULL.
+ */
+static const char *_SPDataStorageFilterBytesForObject(id value, NSStringEncoding stringEncoding, NSUInteger *length)
+{
+	if ([value isNSNull] || [value isSPNotLoaded]) return NULL;
+
+	if (![value isKindOfClass:[NSData class]]) {
+		value = [[value description] dataUsingEncoding:stringEncoding allowLossyConversion:YES];
+	}
+
+	*length = [(NSData *)value length];
+
+	return [(NSData *)value length] ? [(NSData *)value bytes] : "";
+}
+
+#pragma mark - Matcher setup
+
+/**
+ * Convert a text argument into the form cells will be matched against.
+ */
+static NSData *_SPDataStorageFilterArgumentData(SPDataStorageFilterMatcher *matcher, NSString *argument, NSStringEncoding stringEncoding)
+{
+	if (matcher->foldsCase) {
+		NSMutableString *foldedArgument = [NSMutableString stringWithString:argument];
+		_SPDataStorageFilterFoldString((CFMutableStringRef)foldedArgument);
+		return [foldedArgument dataUsingEncoding:NSUTF8StringEncoding];
+	}
+
+	return [argument dataUsingEncoding:stringEncoding];
+}
+
+/**
+ * Set up a matcher for a filter on a column with the supplied definition, returning NO if
+ * the filter can't be evaluated locally for that column.  Converted arguments are added to
+ * the supplied array, which must be kept until matching is complete.
+ */
+static BOOL _SPDataStorageFilterSetUpMatcher(SPDataStorageFilterMatcher *matcher, SPDataStorageFilter *filter, NSDictionary *columnDefinition, NSStringEncoding stringEncoding, NSMutableArray *argumentData)
+{
+	NSString *typeGrouping = [columnDefinition objectForKey:@"typegrouping"];
+	NSString *collation = [columnDefinition objectForKey:@"charset_collation"];
+	NSString *type = [[columnDefinition objectForKey:@"type"] uppercaseString];
+	NSArray *arguments = [filter arguments];
+	NSUInteger i;
+	BOOL ignoresCase;
+
+	matcher->filterOperator = [filter filterOperator];
+	matcher->cfStringEncoding = CFStringConvertNSStringEncodingToEncoding(stringEncoding);
+	matcher->argumentCount = [arguments count];
+	matcher->argumentBytes = calloc(matcher->argumentCount + 1, sizeof(const char *));
+	matcher->argumentLengths = calloc(matcher->argumentCount + 1, sizeof(NSUInteger));
+	matcher->argumentNumbers = calloc(matcher->argumentCount + 1, sizeof(SPDataStorageFilterNumber));
+
+	// NULL tests apply to any column
+	if (matcher->filterOperator == SPDataStorageFilterIsNull || matcher->filterOperator == SPDataStorageFilterIsNotNull) return YES;
+
+	if ([typeGrouping isEqualToString:@"integer"]) {
+		matcher->valueType = [[columnDefinition objectForKey:@"UNSIGNED_FLAG"] boolValue] ? SPDataStorageFilterValueUnsigned : SPDataStorageFilterValueSigned;
+	} else if ([typeGrouping isEqualToString:@"float"]) {
+		matcher->valueType = SPDataStorageFilterValueDouble;
+	} else if ([typeGrouping isEqualToString:@"date"]) {
+		matcher->valueType = SPDataStorageFilterValueDate;
+	} else if ([typeGrouping isEqualToString:@"string"] || [typeGrouping isEqualToString:@"textdata"] || [typeGrouping isEqualToString:@"enum"]) {
+		matcher->valueType = ([collation hasSuffix:@"_bin"] || [[columnDefinition objectForKey:@"BINARY_FLAG"] boolValue]) ? SPDataStorageFilterValueBinary : SPDataStorageFilterValueString;
+	} else if ([typeGrouping isEqualToString:@"binary"] || [typeGrouping isEqualToString:@"blobdata"]) {
+		matcher->valueType = SPDataStorageFilterValueBinary;
+
+	// Bit fields and geometry are received in binary forms the filters aren't written against
+	} else {
+		return NO;
+	}
+
+	ignoresCase = (![filter isCaseSensitive] && ![collation hasSuffix:@"_cs"] && matcher->valueType != SPDataStorageFilterValueBinary);
+	matcher->foldsCase = (ignoresCase && matcher->valueType == SPDataStorageFilterValueString);
+	matcher->patternIsUTF8 = (matcher->foldsCase || stringEncoding == NSUTF8StringEncoding);
+
+	switch (matcher->filterOperator) {
+
+		// LIKE patterns wildcarded at both ends around plain text are a substring search
+		case SPDataStorageFilterLike:
+		case SPDataStorageFilterNotLike:
+		{
+			NSString *pattern = [arguments objectAtIndex:0];
+			if ([pattern length] >= 2 && [pattern hasPrefix:@"%"] && [pattern hasSuffix:@"%"] && ![[pattern substringWithRange:NSMakeRange(1, [pattern length] - 2)] isMatchedByRegex:@"[%_\\\\]"]) {
+				matcher->patternIsSubstring = YES;
+				pattern = [pattern substringWithRange:NSMakeRange(1, [pattern length] - 2)];
+			}
+			NSData *patternData = _SPDataStorageFilterArgumentData(matcher, pattern, stringEncoding);
+			if (!patternData) return NO;
+			[argumentData addObject:patternData];
+			break;
+		}
+
+		case SPDataStorageFilterRegexp:
+		case SPDataStorageFilterNotRegexp:
+		{
+			NSData *expressionData = [[arguments objectAtIndex:0] dataUsingEncoding:stringEncoding];
+			if (!expressionData) return NO;
+			NSMutableData *terminatedExpression = [NSMutableData dataWithData:expressionData];
+			[terminatedExpression appendBytes:"" length:1];
+			if (regcomp(&matcher->regex, [terminatedExpression bytes], REG_EXTENDED | REG_NOSUB | (ignoresCase ? REG_ICASE : 0))) return NO;
+			matcher->hasRegex = YES;
+			break;
+		}
+
+		// Comparisons, ranges and lists compare against each argument as the column type requires
+		default:
+			for (i = 0; i < [arguments count]; i++) {
+				id argument = [arguments objectAtIndex:i];
+				NSString *argumentString = [argument isKindOfClass:[NSNumber class]] ? [argument stringValue] : argument;
+				NSData *data = nil;
+
+				switch (matcher->valueType) {
+					case SPDataStorageFilterValueSigned:
+					case SPDataStorageFilterValueUnsigned:
+					case SPDataStorageFilterValueDouble:
+						if (![argumentString isMatchedByRegex:@"^\\s*[+-]?(\\d+\\.?\\d*|\\.\\d+)([eE][+-]?\\d+)?\\s*$"]) return NO;
+						matcher->argumentNumbers[i] = _SPDataStorageFilterParseNumber([argumentString UTF8String], strlen([argumentString UTF8String]));
+
+						// Integer columns compared against fractions, or unsigned columns against negative
+						// numbers, compare as floating point
+						if (![argumentString isMatchedByRegex:@"^\\s*[+-]?\\d{1,18}\\s*$"] || (matcher->valueType == SPDataStorageFilterValueUnsigned && matcher->argumentNumbers[i].doubleValue < 0)) {
+							matcher->comparesAsDouble = YES;
+						}
+						data = [NSData data];
+						break;
+
+					// Numbers in lists compare numerically, and dates have to be complete for the column type
+					// to compare as text
+					case SPDataStorageFilterValueDate:
+						if ([argument isKindOfClass:[NSNumber class]]) return NO;
+						if ([type isEqualToString:@"DATE"]) {
+							if (![argumentString isMatchedByRegex:@"^\\d{4}-\\d{2}-\\d{2}$"]) return NO;
+						} else if ([type isEqualToString:@"DATETIME"] || [type isEqualToString:@"TIMESTAMP"]) {
+							if (![argumentString isMatchedByRegex:@"^\\d{4}-\\d{2}-\\d{2}( \\d{2}:\\d{2}:\\d{2})?$"]) return NO;
+							if ([argumentString length] == 10) argumentString = [argumentString stringByAppendingString:@" 00:00:00"];
+						} else if ([type isEqualToString:@"YEAR"]) {
+							if (![argumentString isMatchedByRegex:@"^\\d{4}$"]) return NO;
+						} else {
+							return NO;
+						}
+						data = [argumentString dataUsingEncoding:NSASCIIStringEncoding];
+						break;
+
+					case SPDataStorageFilterValueString:
+						if ([argument isKindOfClass:[NSNumber class]]) return NO;
+						data = _SPDataStorageFilterArgumentData(matcher, [argumentString stringByReplacingOccurrencesOfRegex:@" +$" withString:@""], stringEncoding);
+						break;
+
+					case SPDataStorageFilterValueBinary:
+						if ([argument isKindOfClass:[NSNumber class]]) return NO;
+						data = [argumentString dataUsingEncoding:stringEncoding];
+						break;
+				}
+
+				if (!data) return NO;
+				[argumentData addObject:data];
+			}
+			break;
+	}
+
+	for (i = 0; i < [argumentData count]; i++) {
+		matcher->argumentBytes[i] = [[argumentData objectAtIndex:i] bytes];
+		matcher->argumentLengths[i] = [(NSData *)[argumentData objectAtIndex:i] length];
+	}
+
+	return YES;
+}
+
+static void _SPDataStorageFilterTearDownMatcher(SPDataStorageFilterMatcher *matcher)
+{
+	if (matcher->hasRegex) regfree(&matcher->regex);
+	if (matcher->argumentBytes) free(matcher->argumentBytes);
+	if (matcher->argumentLengths) free(matcher->argumentLengths);
+	if (matcher->argumentNumbers) free(matcher->argumentNumbers);
+	if (matcher->scratch) free(matcher->scratch);
+}
+
+#pragma mark - Filtering
+
+/**
+ * Restrict the rows shown to those currently shown which match the supplied filter, keeping
+ * their order.  The column definitions, as returned by the connection for the result, are
+ * used to decide how cells are compared.  Returns NO, leaving the rows unchanged, if the
+ * filter can't be applied locally - if the storage is virtual or still loading, the column
+ * wasn't loaded, or the filter isn't supported for the column's type.
+ */
+- (BOOL) restrictRowsToMatchesOfFilter:(SPDataStorageFilter *)filter columnDefinitions:(NSArray *)columnDefinitions stringEncoding:(NSStringEncoding)stringEncoding
+{
+	NSUInteger column = [filter columnIndex];
+	NSUInteger row, rowCount, matchCount = 0, length = 0;
+	SPDataStorageFilterMatcher matcher;
+	NSMutableArray *argumentData;
+	const char *bytes;
+
+	if (isVirtual || !dataStorage || ![dataStorage dataDownloaded]) return NO;
+	if (column >= numberOfColumns || column >= [columnDefinitions count] || unloadedColumns[column]) return NO;
+
+	memset(&matcher, 0, sizeof(SPDataStorageFilterMatcher));
+	argumentData = [[NSMutableArray alloc] init];
+
+	if (!_SPDataStorageFilterSetUpMatcher(&matcher, filter, [columnDefinitions objectAtIndex:column], stringEncoding, argumentData)) {
+		_SPDataStorageFilterTearDownMatcher(&matcher);
+		[argumentData release];
+		return NO;
+	}
+
+	rowCount = [self count];
+	NSUInteger *matchingRows = malloc((rowCount ? rowCount : 1) * sizeof(NSUInteger));
+
+	for (row = 0; row < rowCount; row++) {
+		NSUInteger underlyingRow = rowIndexMap ? rowIndexMap[row] : row;
+		NSMutableArray *editedRow = [editedRows pointerAtIndex:underlyingRow];
+		id editedValue = editedRow ? [editedRow objectAtIndex:column] : SPDataStorageEditedCellValue([editedCells pointerAtIndex:underlyingRow], column);
+
+		if (editedValue) {
+			bytes = _SPDataStorageFilterBytesForObject(editedValue, stringEncoding, &length);
+		} else {
+			bytes = SPMySQLResultStoreRawCellData(dataStorage, underlyingRow, column, &length);
+		}
+
+		if (_SPDataStorageFilterMatchesCell(&matcher, bytes, length)) {
+			matchingRows[matchCount++] = underlyingRow;
+		}
+	}
+
+	[self setRowIndexMap:matchingRows count:matchCount];
+
+	free(matchingRows);
+	_SPDataStorageFilterTearDownMatcher(&matcher);
+	[argumentData release];
+
+	return YES;
+}
+
+@end
@@ -0,0 +1,47 @@
+//
+//  $Id$
+//
+//  SPDataStorageSorting.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+#import "SPTableContent.h"
+
+#import "SPDataStorage.h"
+
+/**
+ * Sorts the rows held in a data storage instance in memory, without querying the server
+ * again.  Typed sort keys are built for each sort column - numeric, collation-aware string
+ * or binary - and a permutation of the rows is sorted across all available cores, before
+ * being set as the storage's row index map.
+ */
+@interface SPDataStorage (SPDataStorageSorting)
+
+- (BOOL) sortRowsByColumns:(NSArray *)columnIndexes descending:(NSArray *)descendingFlags columnDefinitions:(NSArray *)columnDefinitions stringEncoding:(NSStringEncoding)stringEncoding;
+
+@end
@@ -0,0 +1,702 @@
+//
+//  $Id$
+//
+//  SPDataStorageSorting.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+#import "SPTableContent.h"
+
+#import "SPDataStorageSorting.h"
+#import "SPObjectAdditions.h"
+#import <SPMySQL/SPMySQLStreamingResultStore.h>
+
+#import <pthread.h>
+
+// The sort is only split across threads when each thread will have at least this many rows
+#define SPDataStorageSortMinimumRowsPerThread 16384
+
+// Runs shorter than this are sorted by insertion before merging
+#define SPDataStorageSortInsertionRunLength 16
+
+typedef enum {
+	SPDataStorageSortKeySigned,
+	SPDataStorageSortKeyTime,
+	SPDataStorageSortKeyUnsigned,
+	SPDataStorageSortKeyBit,
+	SPDataStorageSortKeyDouble,
+	SPDataStorageSortKeyString,
+	SPDataStorageSortKeyBinary
+} SPDataStorageSortKeyType;
+
+typedef union {
+	long long signedValue;
+	unsigned long long unsignedValue;
+	double doubleValue;
+} SPDataStorageSortKeyValue;
+
+typedef struct {
+	SPDataStorageSortKeyType type;
+	BOOL descending;
+	NSUInteger columnIndex;
+	CFStringCompareFlags compareFlags;
+	SPDataStorageSortKeyValue *values;
+	BOOL *nulls;
+
+	// String and binary values are held until they have been converted to ranks
+	CFStringRef *strings;
+	const char **bytes;
+	NSUInteger *lengths;
+	BOOL *ownsBytes;
+} SPDataStorageSortKey;
+
+typedef struct {
+	SPDataStorageSortKey *keys;
+	NSUInteger keyCount;
+	SPMySQLStreamingResultStore *resultStore;
+	NSPointerArray *editedRows;
+	NSPointerArray *editedCells;
+	NSStringEncoding stringEncoding;
+	CFStringEncoding cfStringEncoding;
+} SPDataStorageSortContext;
+
+typedef int (*SPDataStorageSortCompareFunction)(NSUInteger firstIndex, NSUInteger secondIndex, void *context);
+typedef void (*SPDataStorageSortTask)(NSUInteger start, NSUInteger end, void *context);
+
+typedef struct {
+	SPDataStorageSortTask task;
+	void *context;
+	NSUInteger start;
+	NSUInteger end;
+} SPDataStorageSortTaskRange;
+
+typedef struct {
+	NSUInteger *source;
+	NSUInteger *destination;
+	NSUInteger *chunkBounds;
+	NSUInteger chunkCount;
+	NSUInteger runWidth;
+	SPDataStorageSortCompareFunction compare;
+	void *compareContext;
+} SPDataStorageMergeSortContext;
+
+@implementation SPDataStorage (SPDataStorageSorting)
+
+#pragma mark - Threading
+
+static void *_SPDataStorageRunSortTaskRange(void *taskRange)
+{
+	NSAutoreleasePool *taskPool = [[NSAutoreleasePool alloc] init];
+	SPDataStorageSortTaskRange *range = (SPDataStorageSortTaskRange *)taskRange;
+
+	range->task(range->start, range->end, range->context);
+
+	[taskPool drain];
+
+	return NULL;
+}
+
+/**
+ * Returns the number of threads to split work on the supplied number of rows across.
+ */
+static NSUInteger _SPDataStorageSortThreadCount(NSUInteger rowCount)
+{
+	NSUInteger threadCount = [[NSProcessInfo processInfo] activeProcessorCount];
+	NSUInteger usefulThreadCount = rowCount / SPDataStorageSortMinimumRowsPerThread;
+
+	if (usefulThreadCount < threadCount) threadCount = usefulThreadCount;
+	if (threadCount < 1) threadCount = 1;
+
+	return threadCount;
+}
+
+/**
+ * Splits the supplied number of items into contiguous ranges, running the task over each
+ * range on its own thread and waiting for all to complete.  The first range is run on the
+ * calling thread.
+ */
+static void _SPDataStorageRunSortTaskInParallel(NSUInteger itemCount, NSUInteger threadCount, SPDataStorageSortTask task, void *context)
+{
+	NSUInteger i;
+
+	if (threadCount > itemCount) threadCount = itemCount;
+	if (threadCount < 2) {
+		task(0, itemCount, context);
+		return;
+	}
+
+	SPDataStorageSortTaskRange *ranges = malloc(threadCount * sizeof(SPDataStorageSortTaskRange));
+	pthread_t *threads = malloc(threadCount * sizeof(pthread_t));
+
+	for (i = 0; i < threadCount; i++) {
+		ranges[i].task = task;
+		ranges[i].context = context;
+		ranges[i].start = itemCount * i / threadCount;
+		ranges[i].end = itemCount * (i + 1) / threadCount;
+	}
+
+	for (i = 1; i < threadCount; i++) {
+		pthread_create(&threads[i], NULL, _SPDataStorageRunSortTaskRange, &ranges[i]);
+	}
+
+	_SPDataStorageRunSortTaskRange(&ranges[0]);
+
+	for (i = 1; i < threadCount; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	free(threads);
+	free(ranges);
+}
+
+#pragma mark - Parallel merge sort
+
+/**
+ * Merge two adjacent sorted runs from the source into the same positions in the destination,
+ * taking from the first run when items compare equal so that the sort is stable.
+ */
+static inline void _SPDataStorageMergeRuns(NSUInteger *source, NSUInteger *destination, NSUInteger start, NSUInteger middle, NSUInteger end, SPDataStorageSortCompareFunction compare, void *context)
+{
+	NSUInteger i = start, j = middle, k = start;
+
+	while (i < middle && j < end) {
+		if (compare(source[j], source[i], context) < 0) {
+			destination[k++] = source[j++];
+		} else {
+			destination[k++] = source[i++];
+		}
+	}
+	while (i < middle) destination[k++] = source[i++];
+	while (j < end) destination[k++] = source[j++];
+}
+
+/**
+ * Stable bottom-up merge sort of a range of items, using a scratch buffer of the same size.
+ */
+static void _SPDataStorageMergeSortRange(NSUInteger *items, NSUInteger *scratch, NSUInteger count, SPDataStorageSortCompareFunction compare, void *context)
+{
+	NSUInteger i, j, width, start, item;
+	NSUInteger *source = items, *destination = scratch, *swap;
+
+	// Sort short runs by insertion
+	for (start = 0; start < count; start += SPDataStorageSortInsertionRunLength) {
+		NSUInteger end = MIN(start + SPDataStorageSortInsertionRunLength, count);
+		for (i = start + 1; i < end; i++) {
+			item = items[i];
+			for (j = i; j > start && compare(items[j - 1], item, context) > 0; j--) {
+				items[j] = items[j - 1];
+			}
+			items[j] = item;
+		}
+	}
+
+	// Merge the runs, alternating between the buffers
+	for (width = SPDataStorageSortInsertionRunLength; width < count; width *= 2) {
+		for (start = 0; start < count; start += width * 2) {
+			_SPDataStorageMergeRuns(source, destination, start, MIN(start + width, count), MIN(start + width * 2, count), compare, context);
+		}
+		swap = source, source = destination, destination = swap;
+	}
+
+	if (source != items) memcpy(items, source, count * sizeof(NSUInteger));
+}
+
+static void _SPDataStorageSortChunks(NSUInteger start, NSUInteger end, void *context)
+{
+	SPDataStorageMergeSortContext *mergeContext = (SPDataStorageMergeSortContext *)context;
+
+	for (NSUInteger chunk = start; chunk < end; chunk++) {
+		NSUInteger chunkStart = mergeContext->chunkBounds[chunk];
+		_SPDataStorageMergeSortRange(mergeContext->source + chunkStart, mergeContext->destination + chunkStart, mergeContext->chunkBounds[chunk + 1] - chunkStart, mergeContext->compare, mergeContext->compareContext);
+	}
+}
+
+static void _SPDataStorageMergeChunkPairs(NSUInteger start, NSUInteger end, void *context)
+{
+	SPDataStorageMergeSortContext *mergeContext = (SPDataStorageMergeSortContext *)context;
+	NSUInteger width = mergeContext->runWidth;
+
+	for (NSUInteger pair = start; pair < end; pair++) {
+		NSUInteger firstChunk = pair * width * 2;
+		_SPDataStorageMergeRuns(mergeContext->source, mergeContext->destination,
+			mergeContext->chunkBounds[firstChunk],
+			mergeContext->chunkBounds[MIN(firstChunk + width, mergeContext->chunkCount)],
+			mergeContext->chunkBounds[MIN(firstChunk + width * 2, mergeContext->chunkCount)],
+			mergeContext->compare, mergeContext->compareContext);
+	}
+}
+
+/**
+ * Stable sort of a list of indexes using the supplied comparison function.  The list is split
+ * into a chunk per thread, each sorted on its own thread, and the sorted chunks are then merged
+ * in pairs, with the pairs in each pass also merged in parallel.
+ */
+static void _SPDataStorageParallelSort(NSUInteger *indexes, NSUInteger count, NSUInteger threadCount, SPDataStorageSortCompareFunction compare, void *context)
+{
+	NSUInteger i, *swap;
+	SPDataStorageMergeSortContext mergeContext;
+
+	if (count < 2) return;
+	if (threadCount < 1) threadCount = 1;
+
+	mergeContext.source = indexes;
+	mergeContext.destination = malloc(count * sizeof(NSUInteger));
+	mergeContext.chunkCount = threadCount;
+	mergeContext.chunkBounds = malloc((threadCount + 1) * sizeof(NSUInteger));
+	mergeContext.compare = compare;
+	mergeContext.compareContext = context;
+	for (i = 0; i <= threadCount; i++) {
+		mergeContext.chunkBounds[i] = count * i / threadCount;
+	}
+
+	_SPDataStorageRunSortTaskInParallel(threadCount, threadCount, _SPDataStorageSortChunks, &mergeContext);
+
+	for (mergeContext.runWidth = 1; mergeContext.runWidth < threadCount; mergeContext.runWidth *= 2) {
+		NSUInteger pairCount = (threadCount + mergeContext.runWidth * 2 - 1) / (mergeContext.runWidth * 2);
+		_SPDataStorageRunSortTaskInParallel(pairCount, pairCount, _SPDataStorageMergeChunkPairs, &mergeContext);
+		swap = mergeContext.source, mergeContext.source = mergeContext.destination, mergeContext.destination = swap;
+	}
+
+	if (mergeContext.source != indexes) {
+		memcpy(indexes, mergeContext.source, count * sizeof(NSUInteger));
+		mergeContext.destination = mergeContext.source;
+	}
+
+	free(mergeContext.destination);
+	free(mergeContext.chunkBounds);
+}
+
+#pragma mark - Comparison
+
+static int _SPDataStorageCompareRows(NSUInteger firstRow, NSUInteger secondRow, void *context)
+{
+	SPDataStorageSortContext *sortContext = (SPDataStorageSortContext *)context;
+	int result;
+
+	for (NSUInteger i = 0; i < sortContext->keyCount; i++) {
+		SPDataStorageSortKey *key = &sortContext->keys[i];
+
+		// NULLs sort before all other values, as on the server
+		if (key->nulls[firstRow] || key->nulls[secondRow]) {
+			result = (int)key->nulls[secondRow] - (int)key->nulls[firstRow];
+		} else {
+			switch (key->type) {
+				case SPDataStorageSortKeySigned:
+				case SPDataStorageSortKeyTime:
+					result = (key->values[firstRow].signedValue > key->values[secondRow].signedValue) - (key->values[firstRow].signedValue < key->values[secondRow].signedValue);
+					break;
+				case SPDataStorageSortKeyDouble:
+					result = (key->values[firstRow].doubleValue > key->values[secondRow].doubleValue) - (key->values[firstRow].doubleValue < key->values[secondRow].doubleValue);
+					break;
+
+				// Unsigned and bit values, and the ranks of string and binary values
+				default:
+					result = (key->values[firstRow].unsignedValue > key->values[secondRow].unsignedValue) - (key->values[firstRow].unsignedValue < key->values[secondRow].unsignedValue);
+					break;
+			}
+		}
+
+		if (result) return key->descending ? -result : result;
+	}
+
+	return 0;
+}
+
+static int _SPDataStorageCompareStrings(NSUInteger firstRow, NSUInteger secondRow, void *context)
+{
+	SPDataStorageSortKey *key = (SPDataStorageSortKey *)context;
+
+	return (int)CFStringCompare(key->strings[firstRow], key->strings[secondRow], key->compareFlags);
+}
+
+static int _SPDataStorageCompareBytes(NSUInteger firstRow, NSUInteger secondRow, void *context)
+{
+	SPDataStorageSortKey *key = (SPDataStorageSortKey *)context;
+	NSUInteger firstLength = key->lengths[firstRow], secondLength = key->lengths[secondRow];
+	int result = memcmp(key->bytes[firstRow], key->bytes[secondRow], MIN(firstLength, secondLength));
+
+	if (result) return result;
+	return (firstLength > secondLength) - (firstLength < secondLength);
+}
+
+#pragma mark - Sort key construction
+
+static long long _SPDataStorageParseSigned(const char *bytes, NSUInteger length)
+{
+	NSUInteger i = 0;
+	BOOL negative = NO;
+	unsigned long long value = 0;
+
+	if (length && (bytes[0] == '-' || bytes[0] == '+')) {
+		negative = (bytes[0] == '-');
+		i++;
+	}
+	for (; i < length && bytes[i] >= '0' && bytes[i] <= '9'; i++) {
+		value = value * 10 + (unsigned long long)(bytes[i] - '0');
+	}
+
+	return negative ? -(long long)value : (long long)value;
+}
+
+/**
+ * Parse a TIME value, in the [-]H:MM:SS[.ffffff] form the server returns, into a signed
+ * number of microseconds, so that negative times and times of 100 hours or more sort as
+ * durations rather than as text.
+ */
+static long long _SPDataStorageParseTime(const char *bytes, NSUInteger length)
+{
+	NSUInteger i = 0, component = 0, fractionDigits = 0;
+	BOOL negative = NO;
+	long long components[3] = { 0, 0, 0 };
+	long long microseconds = 0;
+
+	if (length && bytes[0] == '-') {
+		negative = YES;
+		i++;
+	}
+	for (; i < length; i++) {
+		if (bytes[i] >= '0' && bytes[i] <= '9') {
+			components[component] = components[component] * 10 + (bytes[i] - '0');
+		} else if (bytes[i] == ':' && component < 2) {
+			component++;
+		} else {
+			break;
+		}
+	}
+	if (i < length && bytes[i] == '.') {
+		for (i++; i < length && fractionDigits < 6 && bytes[i] >= '0' && bytes[i] <= '9'; i++, fractionDigits++) {
+			microseconds = microseconds * 10 + (bytes[i] - '0');
+		}
+		for (; fractionDigits < 6; fractionDigits++) microseconds *= 10;
+	}
+
+	microseconds += ((components[0] * 60 + components[1]) * 60 + components[2]) * 1000000;
+
+	return negative ? -microseconds : microseconds;
+}
+
+static unsigned long long _SPDataStorageParseUnsigned(const char *bytes, NSUInteger length)
+{
+	unsigned long long value = 0;
+
+	for (NSUInteger i = 0; i < length && bytes[i] >= '0' && bytes[i] <= '9'; i++) {
+		value = value * 10 + (unsigned long long)(bytes[i] - '0');
+	}
+
+	return value;
+}
+
+static double _SPDataStorageParseDouble(const char *bytes, NSUInteger length)
+{
+	char buffer[128];
+
+	if (length >= sizeof(buffer)) length = sizeof(buffer) - 1;
+	memcpy(buffer, bytes, length);
+	buffer[length] = '\0';
+
+	return strtod(buffer, NULL);
+}
+
+/**
+ * Set the sort key for a row from the bytes received from the server; bit fields are received
+ * as big-endian binary data, and all other numeric types as text.
+ */
+static void _SPDataStorageSetKeyFromBytes(SPDataStorageSortKey *key, NSUInteger row, const char *bytes, NSUInteger length, SPDataStorageSortContext *sortContext)
+{
+	NSUInteger i;
+
+	if (!bytes) {
+		key->nulls[row] = YES;
+		return;
+	}
+
+	switch (key->type) {
+		case SPDataStorageSortKeySigned:
+			key->values[row].signedValue = _SPDataStorageParseSigned(bytes, length);
+			break;
+		case SPDataStorageSortKeyTime:
+			key->values[row].signedValue = _SPDataStorageParseTime(bytes, length);
+			break;
+		case SPDataStorageSortKeyUnsigned:
+			key->values[row].unsignedValue = _SPDataStorageParseUnsigned(bytes, length);
+			break;
+		case SPDataStorageSortKeyBit:
+			key->values[row].unsignedValue = 0;
+			for (i = 0; i < length; i++) {
+				key->values[row].unsignedValue = (key->values[row].unsignedValue << 8) | (unsigned char)bytes[i];
+			}
+			break;
+		case SPDataStorageSortKeyDouble:
+			key->values[row].doubleValue = _SPDataStorageParseDouble(bytes, length);
+			break;
+		case SPDataStorageSortKeyString:
+			key->strings[row] = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, (const UInt8 *)bytes, length, sortContext->cfStringEncoding, false, kCFAllocatorNull);
+			if (!key->strings[row]) key->nulls[row] = YES;
+			break;
+		case SPDataStorageSortKeyBinary:
+			key->bytes[row] = bytes;
+			key->lengths[row] = length;
+			break;
+	}
+}
+
+/**
+ * Set the sort key for a row from a cell in an edited row.
+ */
+static void _SPDataStorageSetKeyFromObject(SPDataStorageSortKey *key, NSUInteger row, id value, SPDataStorageSortContext *sortContext)
+{
+	if ([value isNSNull] || [value isSPNotLoaded]) {
+		key->nulls[row] = YES;
+		return;
+	}
+
+	if (key->type == SPDataStorageSortKeyString) {
+		if ([value isKindOfClass:[NSData class]]) {
+			key->strings[row] = (CFStringRef)[[NSString alloc] initWithData:value encoding:sortContext->stringEncoding];
+		} else {
+			key->strings[row] = (CFStringRef)[[value description] copy];
+		}
+		if (!key->strings[row]) key->nulls[row] = YES;
+		return;
+	}
+
+	if (key->type == SPDataStorageSortKeyBinary) {
+		if ([value isKindOfClass:[NSData class]]) {
+			key->bytes[row] = [(NSData *)value bytes];
+			key->lengths[row] = [(NSData *)value length];
+		} else {
+			NSData *valueData = [[value description] dataUsingEncoding:sortContext->stringEncoding allowLossyConversion:YES];
+			char *valueBytes = malloc([valueData length] ? [valueData length] : 1);
+			memcpy(valueBytes, [valueData bytes], [valueData length]);
+			key->bytes[row] = valueBytes;
+			key->lengths[row] = [valueData length];
+			key->ownsBytes[row] = YES;
+		}
+		return;
+	}
+
+	if (key->type == SPDataStorageSortKeyBit && ![value isKindOfClass:[NSData class]]) {
+		key->values[row].unsignedValue = strtoull([[value description] UTF8String], NULL, 2);
+		return;
+	}
+
+	if ([value isKindOfClass:[NSData class]]) {
+		_SPDataStorageSetKeyFromBytes(key, row, [(NSData *)value bytes], [(NSData *)value length], sortContext);
+	} else {
+		const char *valueString = [[value description] UTF8String];
+		_SPDataStorageSetKeyFromBytes(key, row, valueString, strlen(valueString), sortContext);
+	}
+}
+
+/**
+ * Build the sort keys for a range of rows.  Unedited cells are read directly from the bytes
+ * in the result store, avoiding the creation of an object per cell.
+ */
+static void _SPDataStorageBuildSortKeys(NSUInteger start, NSUInteger end, void *context)
+{
+	SPDataStorageSortContext *sortContext = (SPDataStorageSortContext *)context;
+	NSUInteger i, length;
+
+	for (NSUInteger row = start; row < end; row++) {
+		NSMutableArray *editedRow = [sortContext->editedRows pointerAtIndex:row];
+		CFDictionaryRef rowEdits = editedRow ? NULL : [sortContext->editedCells pointerAtIndex:row];
+		id editedValue;
+
+		for (i = 0; i < sortContext->keyCount; i++) {
+			SPDataStorageSortKey *key = &sortContext->keys[i];
+
+			if (editedRow) {
+				_SPDataStorageSetKeyFromObject(key, row, [editedRow objectAtIndex:key->columnIndex], sortContext);
+			} else if ((editedValue = SPDataStorageEditedCellValue(rowEdits, key->columnIndex))) {
+				_SPDataStorageSetKeyFromObject(key, row, editedValue, sortContext);
+			} else {
+				const char *bytes = SPMySQLResultStoreRawCellData(sortContext->resultStore, row, key->columnIndex, &length);
+				_SPDataStorageSetKeyFromBytes(key, row, bytes, length, sortContext);
+			}
+		}
+	}
+}
+
+/**
+ * Replace the string or binary values of a key with their ranks amongst each other, so that
+ * the main sort only compares integers.  Equal values share a rank.
+ */
+static void _SPDataStorageRankKeyValues(SPDataStorageSortKey *key, NSUInteger rowCount, NSUInteger threadCount)
+{
+	NSUInteger i, rankedCount = 0;
+	unsigned long long rank = 0;
+	SPDataStorageSortCompareFunction compare = (key->type == SPDataStorageSortKeyString) ? _SPDataStorageCompareStrings : _SPDataStorageCompareBytes;
+	NSUInteger *rankedRows = malloc((rowCount ? rowCount : 1) * sizeof(NSUInteger));
+
+	for (i = 0; i < rowCount; i++) {
+		if (!key->nulls[i]) rankedRows[rankedCount++] = i;
+	}
+
+	_SPDataStorageParallelSort(rankedRows, rankedCount, threadCount, compare, key);
+
+	for (i = 0; i < rankedCount; i++) {
+		if (i && compare(rankedRows[i - 1], rankedRows[i], key)) rank++;
+		key->values[rankedRows[i]].unsignedValue = rank;
+	}
+
+	free(rankedRows);
+}
+
+/**
+ * Determine the type of sort key to use for a column from its definition.
+ */
+static void _SPDataStorageConfigureSortKey(SPDataStorageSortKey *key, NSDictionary *columnDefinition)
+{
+	NSString *typeGrouping = [columnDefinition objectForKey:@"typegrouping"];
+	NSString *collation = [columnDefinition objectForKey:@"charset_collation"];
+
+	key->compareFlags = 0;
+
+	if ([typeGrouping isEqualToString:@"integer"]) {
+		key->type = [[columnDefinition objectForKey:@"UNSIGNED_FLAG"] boolValue] ? SPDataStorageSortKeyUnsigned : SPDataStorageSortKeySigned;
+	} else if ([typeGrouping isEqualToString:@"bit"]) {
+		key->type = SPDataStorageSortKeyBit;
+	} else if ([typeGrouping isEqualToString:@"float"]) {
+		key->type = SPDataStorageSortKeyDouble;
+	} else if ([[columnDefinition objectForKey:@"type"] isEqualToString:@"TIME"]) {
+		key->type = SPDataStorageSortKeyTime;
+
+	// Text follows its collation; binary collations compare bytes, others compare characters,
+	// ignoring case unless the collation is case sensitive
+	} else if ([typeGrouping isEqualToString:@"string"] || [typeGrouping isEqualToString:@"textdata"]) {
+		if ([collation hasSuffix:@"_bin"] || [[columnDefinition objectForKey:@"BINARY_FLAG"] boolValue]) {
+			key->type = SPDataStorageSortKeyBinary;
+		} else {
+			key->type = SPDataStorageSortKeyString;
+			key->compareFlags = kCFCompareNonliteral;
+			if (![collation hasSuffix:@"_cs"]) key->compareFlags |= kCFCompareCaseInsensitive;
+		}
+
+	// Binary data, geometry and other dates, which are received in a sortable text format
+	} else {
+		key->type = SPDataStorageSortKeyBinary;
+	}
+}
+
+#pragma mark - Sorting
+
+/**
+ * Sort the rows by the supplied columns, in order of precedence, each ascending or descending
+ * as set by the matching entry in the supplied array of NSNumber booleans; rows which compare
+ * equal keep their current underlying order.  The column definitions, as returned by the
+ * result store, determine how each column's values are compared.
+ * Returns NO without sorting if the rows can't be sorted locally, for example if the data
+ * hasn't finished downloading, is virtual, or a sort column isn't loaded.  ENUM and SET
+ * columns are also left to the server, which sorts them by member index rather than by
+ * value; the members aren't part of the column definitions.
+ */
+- (BOOL) sortRowsByColumns:(NSArray *)columnIndexes descending:(NSArray *)descendingFlags columnDefinitions:(NSArray *)columnDefinitions stringEncoding:(NSStringEncoding)stringEncoding
+{
+	NSUInteger i, row;
+
+	if (isVirtual || !dataStorage || ![dataStorage dataDownloaded] || ![columnIndexes count]) return NO;
+	if ([descendingFlags count] != [columnIndexes count]) return NO;
+
+	for (NSNumber *columnIndex in columnIndexes) {
+		NSUInteger column = [columnIndex unsignedIntegerValue];
+		if (column >= numberOfColumns || column >= [columnDefinitions count] || unloadedColumns[column]) return NO;
+		if ([[[columnDefinitions objectAtIndex:column] objectForKey:@"typegrouping"] isEqualToString:@"enum"]) return NO;
+	}
+
+	NSUInteger rowCount = (NSUInteger)[dataStorage numberOfRows];
+	NSUInteger threadCount = _SPDataStorageSortThreadCount(rowCount);
+	SPDataStorageSortContext sortContext;
+
+	sortContext.keyCount = [columnIndexes count];
+	sortContext.keys = calloc(sortContext.keyCount, sizeof(SPDataStorageSortKey));
+	sortContext.resultStore = dataStorage;
+	sortContext.editedRows = editedRows;
+	sortContext.editedCells = editedCells;
+	sortContext.stringEncoding = stringEncoding;
+	sortContext.cfStringEncoding = CFStringConvertNSStringEncodingToEncoding(stringEncoding);
+
+	for (i = 0; i < sortContext.keyCount; i++) {
+		SPDataStorageSortKey *key = &sortContext.keys[i];
+
+		key->columnIndex = [[columnIndexes objectAtIndex:i] unsignedIntegerValue];
+		key->descending = [[descendingFlags objectAtIndex:i] boolValue];
+		_SPDataStorageConfigureSortKey(key, [columnDefinitions objectAtIndex:key->columnIndex]);
+
+		key->values = calloc(rowCount ? rowCount : 1, sizeof(SPDataStorageSortKeyValue));
+		key->nulls = calloc(rowCount ? rowCount : 1, sizeof(BOOL));
+		if (key->type == SPDataStorageSortKeyString) {
+			key->strings = calloc(rowCount ? rowCount : 1, sizeof(CFStringRef));
+		} else if (key->type == SPDataStorageSortKeyBinary) {
+			key->bytes = calloc(rowCount ? rowCount : 1, sizeof(const char *));
+			key->lengths = calloc(rowCount ? rowCount : 1, sizeof(NSUInteger));
+			key->ownsBytes = calloc(rowCount ? rowCount : 1, sizeof(BOOL));
+		}
+	}
+
+	// Build the keys for all rows across the available cores
+	_SPDataStorageRunSortTaskInParallel(rowCount, threadCount, _SPDataStorageBuildSortKeys, &sortContext);
+
+	// Convert string and binary values to ranks, and release them
+	for (i = 0; i < sortContext.keyCount; i++) {
+		SPDataStorageSortKey *key = &sortContext.keys[i];
+
+		if (key->type != SPDataStorageSortKeyString && key->type != SPDataStorageSortKeyBinary) continue;
+
+		_SPDataStorageRankKeyValues(key, rowCount, threadCount);
+
+		for (row = 0; row < rowCount; row++) {
+			if (key->strings && key->strings[row]) CFRelease(key->strings[row]);
+			if (key->ownsBytes && key->ownsBytes[row]) free((void *)key->bytes[row]);
+		}
+		if (key->strings) free(key->strings), key->strings = NULL;
+		if (key->bytes) free(key->bytes), key->bytes = NULL;
+		if (key->lengths) free(key->lengths), key->lengths = NULL;
+		if (key->ownsBytes) free(key->ownsBytes), key->ownsBytes = NULL;
+	}
+
+	// Sort a permutation of the rows by the keys, and display the rows in that order
+	NSUInteger *rowOrder = malloc((rowCount ? rowCount : 1) * sizeof(NSUInteger));
+	for (row = 0; row < rowCount; row++) {
+		rowOrder[row] = row;
+	}
+
+	_SPDataStorageParallelSort(rowOrder, rowCount, threadCount, _SPDataStorageCompareRows, &sortContext);
+
+	[self setRowIndexMap:rowOrder count:rowCount];
+
+	free(rowOrder);
+	for (i = 0; i < sortContext.keyCount; i++) {
+		free(sortContext.keys[i].values);
+		free(sortContext.keys[i].nulls);
+	}
+	free(sortContext.keys);
+
+	return YES;
+}
+
+@end
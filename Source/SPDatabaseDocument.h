@@ -55,6 +55,7 @@
 @class SPServerSupport;
 @class SPCustomQuery;
 @class SPDatabaseStructure;
+@class SPConnectionPool;
 @class SPMySQLConnection;
 @class SPCharsetCollationHelper;
 
@@ -282,6 +283,7 @@
 	BOOL windowTitleStatusViewIsVisible;
 #endif
 	SPDatabaseStructure *databaseStructureRetrieval;
+	SPConnectionPool *connectionPool;
 }
 
 #ifdef SP_CODA /* ivars */
@@ -319,6 +321,7 @@
 #endif
 @property (readonly) SPServerSupport *serverSupport;
 @property (readonly) SPDatabaseStructure *databaseStructureRetrieval;
+@property (readonly) SPConnectionPool *connectionPool;
 
 #ifndef SP_CODA /* method decls */
 - (BOOL)isUntitled;
@@ -111,6 +111,7 @@ enum {
 #endif
 
 #import "SPCharsetCollationHelper.h"
+#import "SPConnectionPool.h"
 
 #import <SPMySQL/SPMySQL.h>
 
@@ -121,6 +122,9 @@ static NSString *SPCreateSyntx = @"SPCreateSyntax";
 static NSString *SPRenameDatabaseAction = @"SPRenameDatabase";
 static NSString *SPAlterDatabaseAction = @"SPAlterDatabase";
 
+// The number of connections the table content helpers share for their background queries
+static const NSUInteger SPBackgroundConnectionPoolSize = 2;
+
 @interface SPDatabaseDocument ()
 - (void)_addDatabase;
 - (void)_alterDatabase;
@@ -147,6 +151,7 @@ static NSString *SPAlterDatabaseAction = @"SPAlterDatabase";
 @synthesize isProcessing;
 @synthesize serverSupport;
 @synthesize databaseStructureRetrieval;
+@synthesize connectionPool;
 #ifndef SP_CODA /* ivars */
 @synthesize processID;
 #endif
@@ -260,6 +265,7 @@ static NSString *SPAlterDatabaseAction = @"SPAlterDatabase";
 #endif
 
 		databaseStructureRetrieval = [[SPDatabaseStructure alloc] initWithDelegate:self];
+		connectionPool = [[SPConnectionPool alloc] initWithDelegate:self maximumConnections:SPBackgroundConnectionPoolSize];
 	}
 	
 	return self;
@@ -480,6 +486,9 @@ static NSString *SPAlterDatabaseAction = @"SPAlterDatabase";
 	// Set the connection on the database structure builder
 	[databaseStructureRetrieval setConnectionToClone:mySQLConnection];
 
+	// Set the connection the background helpers' pooled connections are cloned from
+	[connectionPool setConnectionToClone:mySQLConnection];
+
 	[databaseDataInstance setConnection:mySQLConnection];
 	
 	// Pass the support class to the data instance
@@ -6264,6 +6273,7 @@ static NSString *SPAlterDatabaseAction = @"SPAlterDatabase";
 	[[NSNotificationCenter defaultCenter] postNotificationName:SPDocumentWillCloseNotification object:self];
 	
 	[databaseStructureRetrieval release];
+	[connectionPool release];
 	
 	[allDatabases release];
 	[allSystemDatabases release];
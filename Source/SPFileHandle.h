@@ -30,6 +30,8 @@
 //
 //  More info at <http://code.google.com/p/sequel-pro/>
 
+@class SPFileHandleMapping, SPFileHandleReadAhead, SPParallelDecompressor;
+
 /**
  * @class SPFileHandle SPFileHandle.h
  *
@@ -38,6 +40,14 @@
  * Provides a class which aims to duplicate some of the most-used functionality
  * of NSFileHandle, while also transparently supporting gzip and bzip2 compressed content
  * on reading; gzip and bzip2 compression is also supported on writing.
+ *
+ * On reading, uncompressed files are memory-mapped where possible, with reads copied out
+ * of the mapping and the kernel asked to read in the data following each read while it is
+ * processed; if the file is truncated or appended to while being read, the rest is read
+ * from the file instead.  Compressed files are decompressed ahead of
+ * reads on a background thread, into a small pool of reused buffers; where a compressed
+ * file divides into independent chunks, as bzip2 files and multi-member gzip files do, the
+ * chunks are instead decompressed on several threads and returned in order.
  */
 @interface SPFileHandle : NSObject 
 {
@@ -51,6 +61,11 @@
 	pthread_mutex_t bufferLock;
 	NSThread *processingThread;
 
+	SPFileHandleMapping *fileMapping;
+	NSUInteger mappedReadPosition;
+	SPFileHandleReadAhead *readAhead;
+	SPParallelDecompressor *parallelDecompressor;
+
 	int fileMode;
 	BOOL dataWritten;
 	BOOL allDataWritten;
@@ -77,10 +92,10 @@
 #pragma mark Data reading
 
 // Reads data up to a specified number of bytes from the file
-- (NSMutableData *)readDataOfLength:(NSUInteger)length;
+- (NSData *)readDataOfLength:(NSUInteger)length;
 
 // Returns the data to the end of the file
-- (NSMutableData *)readDataToEndOfFile;
+- (NSData *)readDataToEndOfFile;
 
 // Returns the on-disk (raw) length of data read so far - can be used in progress bars
 - (NSUInteger)realDataReadLength;
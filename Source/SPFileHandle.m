@@ -34,13 +34,294 @@
 #import "zlib.1.2.4.h"
 #import "bzlib.h"
 #import "pthread.h"
+#import "SPThreadAdditions.h"
+#import "SPParallelDecompressor.h"
+
+#import <sys/mman.h>
+#import <sys/stat.h>
 
 // Define the maximum size of the background write buffer before the writing thread
 // waits until some has been written out.  This can affect speed and memory usage.
 #define SPFH_MAX_WRITE_BUFFER_SIZE 1048576
 
+// Define the size and number of the buffers compressed files are decompressed into ahead
+// of reads; once all are filled, the decompressing thread waits for one to be read.
+#define SPFH_READ_AHEAD_BUFFER_SIZE 1048576
+#define SPFH_READ_AHEAD_BUFFER_COUNT 4
+
+// Define the length of mapped file data copied out at a time, between checks that the file
+// hasn't been truncated or appended to.
+#define SPFH_MAPPED_READ_CHUNK_SIZE 1048576
+
+/**
+ * A read-only memory mapping of a file, unmapped once released by the file handle and any
+ * decompressor reading it.  A descriptor for the file is kept so that the file can be checked
+ * for changes: reading pages of the mapping beyond the end of a truncated file raises SIGBUS.
+ */
+@interface SPFileHandleMapping : NSObject
+{
+@public
+	const unsigned char *mappedBytes;
+	NSUInteger mappedLength;
+	int fileDescriptor;
+}
+
+- (BOOL)fileIsUnchanged;
+
+@end
+
+@implementation SPFileHandleMapping
+
+/**
+ * Returns whether the mapped file still has the length it had when mapped, so has been
+ * neither truncated nor appended to.
+ */
+- (BOOL)fileIsUnchanged
+{
+	struct stat fileStatus;
+
+	return (!fstat(fileDescriptor, &fileStatus) && (unsigned long long)fileStatus.st_size == (unsigned long long)mappedLength);
+}
+
+- (void)dealloc
+{
+	munmap((void *)mappedBytes, mappedLength);
+	close(fileDescriptor);
+
+	[super dealloc];
+}
+
+@end
+
+/**
+ * Decompresses a gzip or bzip2 file on a background thread, ahead of the data being read,
+ * into a ring of reused buffers.  The thread is started by the first read, and must be
+ * stopped before the file is closed.
+ */
+@interface SPFileHandleReadAhead : NSObject
+{
+	void *compressedFile;
+	SPFileCompressionFormat compressionFormat;
+
+	unsigned char *buffers[SPFH_READ_AHEAD_BUFFER_COUNT];
+	NSUInteger bufferLengths[SPFH_READ_AHEAD_BUFFER_COUNT];
+	NSUInteger bufferRawOffsets[SPFH_READ_AHEAD_BUFFER_COUNT];
+	NSUInteger filledBufferCount;
+	NSUInteger fillIndex;
+	NSUInteger readIndex;
+	NSUInteger readPosition;
+	NSUInteger rawDataReadLength;
+
+	pthread_mutex_t readAheadLock;
+	pthread_cond_t readAheadCondition;
+	BOOL threadStarted;
+	BOOL threadRunning;
+	BOOL stopRequested;
+	BOOL endOfData;
+	NSString *errorMessage;
+}
+
+- (id)initWithFile:(void *)theFile compressionFormat:(SPFileCompressionFormat)theCompressionFormat;
+- (NSUInteger)readBytes:(void *)destination length:(NSUInteger)length;
+- (NSUInteger)rawDataReadLength;
+- (void)stop;
+
+@end
+
+@implementation SPFileHandleReadAhead
+
+- (id)initWithFile:(void *)theFile compressionFormat:(SPFileCompressionFormat)theCompressionFormat
+{
+	if ((self = [super init])) {
+		NSUInteger i;
+
+		compressedFile = theFile;
+		compressionFormat = theCompressionFormat;
+
+		for (i = 0; i < SPFH_READ_AHEAD_BUFFER_COUNT; i++) {
+			buffers[i] = malloc(SPFH_READ_AHEAD_BUFFER_SIZE);
+			bufferLengths[i] = 0;
+			bufferRawOffsets[i] = 0;
+		}
+		filledBufferCount = 0;
+		fillIndex = 0;
+		readIndex = 0;
+		readPosition = 0;
+		rawDataReadLength = 0;
+
+		pthread_mutex_init(&readAheadLock, NULL);
+		pthread_cond_init(&readAheadCondition, NULL);
+		threadStarted = NO;
+		threadRunning = NO;
+		stopRequested = NO;
+		endOfData = NO;
+		errorMessage = nil;
+	}
+
+	return self;
+}
+
+/**
+ * Copy up to the supplied number of decompressed bytes into the destination, waiting for
+ * them to be decompressed if necessary, and return the number of bytes copied; fewer are
+ * only returned at the end of the data.  Raises an exception if the data couldn't be
+ * decompressed.
+ */
+- (NSUInteger)readBytes:(void *)destination length:(NSUInteger)length
+{
+	NSUInteger bytesCopied = 0;
+	NSUInteger copyLength;
+	NSString *readErrorMessage = nil;
+
+	pthread_mutex_lock(&readAheadLock);
+
+	if (!threadStarted) {
+		threadStarted = YES;
+		threadRunning = YES;
+		[NSThread detachNewThreadWithName:@"SPFileHandle read-ahead thread" target:self selector:@selector(_decompressAhead) object:nil];
+	}
+
+	while (bytesCopied < length) {
+		while (!filledBufferCount && !endOfData && !stopRequested) {
+			pthread_cond_wait(&readAheadCondition, &readAheadLock);
+		}
+		if (!filledBufferCount) break;
+
+		// Filled buffers aren't touched by the decompressing thread, so can be copied from unlocked
+		copyLength = MIN(length - bytesCopied, bufferLengths[readIndex] - readPosition);
+		pthread_mutex_unlock(&readAheadLock);
+		memcpy((unsigned char *)destination + bytesCopied, buffers[readIndex] + readPosition, copyLength);
+		pthread_mutex_lock(&readAheadLock);
+
+		bytesCopied += copyLength;
+		readPosition += copyLength;
+
+		// Once a buffer has been read, hand it back to be refilled
+		if (readPosition == bufferLengths[readIndex]) {
+			rawDataReadLength = bufferRawOffsets[readIndex];
+			readPosition = 0;
+			readIndex = (readIndex + 1) % SPFH_READ_AHEAD_BUFFER_COUNT;
+			filledBufferCount--;
+			pthread_cond_broadcast(&readAheadCondition);
+		}
+	}
+
+	if (!bytesCopied && errorMessage) readErrorMessage = [[errorMessage copy] autorelease];
+
+	pthread_mutex_unlock(&readAheadLock);
+
+	if (readErrorMessage) {
+		[NSException raise:NSGenericException format:@"%@", readErrorMessage];
+	}
+
+	return bytesCopied;
+}
+
+/**
+ * Returns the length of compressed data decompressed into the buffers read so far.
+ */
+- (NSUInteger)rawDataReadLength
+{
+	pthread_mutex_lock(&readAheadLock);
+	NSUInteger theRawDataReadLength = rawDataReadLength;
+	pthread_mutex_unlock(&readAheadLock);
+
+	return theRawDataReadLength;
+}
+
+/**
+ * Stop decompressing, waiting for the thread to finish with the file.
+ */
+- (void)stop
+{
+	pthread_mutex_lock(&readAheadLock);
+	stopRequested = YES;
+	pthread_cond_broadcast(&readAheadCondition);
+	while (threadRunning) {
+		pthread_cond_wait(&readAheadCondition, &readAheadLock);
+	}
+	pthread_mutex_unlock(&readAheadLock);
+}
+
+/**
+ * Decompress the file into empty buffers until the end of the data is reached or stopped.
+ * Should always be executed on a background thread.
+ */
+- (void)_decompressAhead
+{
+	NSAutoreleasePool *readAheadPool = [[NSAutoreleasePool alloc] init];
+	long dataLength = 0;
+	NSUInteger rawOffset = 0;
+	NSUInteger bufferIndex;
+	const char *zlibErrorString;
+	int bzip2ErrorNumber;
+
+	pthread_mutex_lock(&readAheadLock);
+	while (1) {
+		while (!stopRequested && filledBufferCount == SPFH_READ_AHEAD_BUFFER_COUNT) {
+			pthread_cond_wait(&readAheadCondition, &readAheadLock);
+		}
+		if (stopRequested) break;
+		bufferIndex = fillIndex;
+		pthread_mutex_unlock(&readAheadLock);
+
+		if (compressionFormat == SPGzipCompression) {
+			dataLength = gzread(compressedFile, buffers[bufferIndex], SPFH_READ_AHEAD_BUFFER_SIZE);
+			rawOffset = (NSUInteger)gzoffset(compressedFile);
+		}
+		else if (compressionFormat == SPBzip2Compression) {
+			dataLength = BZ2_bzread(compressedFile, buffers[bufferIndex], SPFH_READ_AHEAD_BUFFER_SIZE);
+		}
+
+		pthread_mutex_lock(&readAheadLock);
+
+		// Record any decompression error, to be raised by the read which reaches it
+		if (dataLength < 0) {
+			if (compressionFormat == SPGzipCompression) {
+				zlibErrorString = gzerror(compressedFile, NULL);
+				errorMessage = [[NSString alloc] initWithFormat:NSLocalizedString(@"The gzip data could not be decompressed: %s", @"gzip decompression error message"), zlibErrorString];
+			} else {
+				errorMessage = [[NSString alloc] initWithFormat:NSLocalizedString(@"The bzip2 data could not be decompressed: %s", @"bzip2 decompression error message"), BZ2_bzerror(compressedFile, &bzip2ErrorNumber)];
+			}
+		}
+		if (dataLength <= 0) {
+			endOfData = YES;
+			pthread_cond_broadcast(&readAheadCondition);
+			break;
+		}
+
+		bufferLengths[bufferIndex] = (NSUInteger)dataLength;
+		bufferRawOffsets[bufferIndex] = rawOffset;
+		fillIndex = (bufferIndex + 1) % SPFH_READ_AHEAD_BUFFER_COUNT;
+		filledBufferCount++;
+		pthread_cond_broadcast(&readAheadCondition);
+	}
+	threadRunning = NO;
+	pthread_cond_broadcast(&readAheadCondition);
+	pthread_mutex_unlock(&readAheadLock);
+
+	[readAheadPool drain];
+}
+
+- (void)dealloc
+{
+	NSUInteger i;
+
+	for (i = 0; i < SPFH_READ_AHEAD_BUFFER_COUNT; i++) free(buffers[i]);
+	if (errorMessage) [errorMessage release], errorMessage = nil;
+
+	pthread_mutex_destroy(&readAheadLock);
+	pthread_cond_destroy(&readAheadCondition);
+
+	[super dealloc];
+}
+
+@end
+
 @interface SPFileHandle ()
 
+- (void)_mapFile:(FILE *)theFile;
+- (NSUInteger)_readDecompressedBytes:(void *)destination length:(NSUInteger)length;
 - (void)_writeBufferToData;
 
 @end
@@ -84,6 +365,11 @@
 		bufferDataLength = 0;
 		bufferPosition = 0;
 		endOfFile = NO;
+
+		fileMapping = nil;
+		mappedReadPosition = 0;
+		readAhead = nil;
+		parallelDecompressor = nil;
 		
 		useCompression = NO;
 		compressionFormat = SPNoCompression;
@@ -133,10 +419,24 @@
 					gzclose(gzfile);
 				}
 				
+				// Decompress the file on several threads if it can be mapped and divides into chunks,
+				// otherwise decompress it serially ahead of reads.  The mapping is kept to check
+				// that the file hasn't changed while it is being decompressed.
+				[self _mapFile:theFile];
+				if (fileMapping) {
+					parallelDecompressor = [[SPParallelDecompressor alloc] initWithBytes:fileMapping->mappedBytes length:fileMapping->mappedLength owner:fileMapping compressionFormat:compressionFormat workerCount:[SPParallelDecompressor defaultWorkerCount]];
+					if (!parallelDecompressor) [fileMapping release], fileMapping = nil;
+				}
+				if (!parallelDecompressor) {
+					readAhead = [[SPFileHandleReadAhead alloc] initWithFile:wrappedFile compressionFormat:compressionFormat];
+				}
+
 				fclose(theFile);
 			}
 			else {
 				gzclose(gzfile);
+
+				[self _mapFile:wrappedFile];
 			}
 			
 			processingThread = nil;
@@ -201,23 +501,76 @@
 
 /**
  * Reads data up to a specified number of uncompressed bytes from the file.
+ * Memory-mapped files are copied out of the mapping a chunk at a time, checking before
+ * each chunk that the file hasn't changed; if it has been truncated or appended to, the
+ * rest of the file is read from the FILE instead.
  */
-- (NSMutableData *)readDataOfLength:(NSUInteger)length
+- (NSData *)readDataOfLength:(NSUInteger)length
 {	
 	long dataLength = 0;
-	void *data = malloc(length);
-			
-	if (useCompression) {
-		if (compressionFormat == SPGzipCompression) {
-			dataLength = gzread(wrappedFile, data, (unsigned)length);
+	NSUInteger chunkLength, chunkDataLength;
+
+	if (fileMapping && !useCompression) {
+		NSMutableData *data = [NSMutableData data];
+
+		while ((NSUInteger)dataLength < length) {
+			if (![fileMapping fileIsUnchanged]) {
+				fseeko(wrappedFile, (off_t)mappedReadPosition, SEEK_SET);
+				[fileMapping release], fileMapping = nil;
+				break;
+			}
+			if (mappedReadPosition == fileMapping->mappedLength) break;
+
+			chunkLength = MIN(length - dataLength, MIN((NSUInteger)SPFH_MAPPED_READ_CHUNK_SIZE, fileMapping->mappedLength - mappedReadPosition));
+			[data appendBytes:fileMapping->mappedBytes + mappedReadPosition length:chunkLength];
+			dataLength += chunkLength;
+			mappedReadPosition += chunkLength;
 		}
-		else if (compressionFormat == SPBzip2Compression) {
-			dataLength = BZ2_bzread(wrappedFile, data, (int)length);
-		}		
+
+		if (fileMapping) {
+
+			// Ask for a similar length of the following data to be read in while this is processed
+			if (dataLength && mappedReadPosition < fileMapping->mappedLength) {
+				NSUInteger pageSize = (NSUInteger)getpagesize();
+				NSUInteger adviseStart = mappedReadPosition - (mappedReadPosition % pageSize);
+				madvise((void *)(fileMapping->mappedBytes + adviseStart), MIN((NSUInteger)dataLength, fileMapping->mappedLength - adviseStart), MADV_WILLNEED);
+			}
+
+			return data;
+		}
+
+		// The mapping has been dropped, so read the remainder of the requested data from the FILE
+		while ((NSUInteger)dataLength < length) {
+			chunkLength = MIN(length - dataLength, (NSUInteger)SPFH_MAPPED_READ_CHUNK_SIZE);
+			[data setLength:dataLength + chunkLength];
+			chunkDataLength = fread((unsigned char *)[data mutableBytes] + dataLength, 1, chunkLength, wrappedFile);
+			dataLength += chunkDataLength;
+			if (chunkDataLength < chunkLength) break;
+		}
+		[data setLength:dataLength];
+
+		return data;
 	}
-	else {
-		dataLength = fread(data, 1, length, wrappedFile);
+
+	// Copy decompressed data out of the decompression buffers, a buffer's length at a time
+	if (readAhead || parallelDecompressor) {
+		NSMutableData *data = [NSMutableData data];
+
+		while ((NSUInteger)dataLength < length) {
+			chunkLength = MIN(length - dataLength, SPFH_READ_AHEAD_BUFFER_SIZE);
+			[data setLength:dataLength + chunkLength];
+			chunkDataLength = [self _readDecompressedBytes:(unsigned char *)[data mutableBytes] + dataLength length:chunkLength];
+			dataLength += chunkDataLength;
+			if (chunkDataLength < chunkLength) break;
+		}
+		[data setLength:dataLength];
+
+		return data;
 	}
+
+	void *data = malloc(length);
+
+	dataLength = fread(data, 1, length, wrappedFile);
 		
 	return [NSMutableData dataWithBytesNoCopy:data length:dataLength freeWhenDone:YES];
 }
@@ -225,7 +578,7 @@
 /**
  * Returns all the data to the end of the file.
  */
-- (NSMutableData *)readDataToEndOfFile
+- (NSData *)readDataToEndOfFile
 {
 	return [self readDataOfLength:NSUIntegerMax];
 }
@@ -239,8 +592,10 @@
 {
 	if ((fileMode == O_WRONLY) || (compressionFormat == SPBzip2Compression)) return 0;
 	
+	if (fileMapping && !useCompression) return mappedReadPosition;
+
 	if (useCompression && (compressionFormat == SPGzipCompression)) {
-		return gzoffset(wrappedFile);
+		return parallelDecompressor ? [parallelDecompressor rawDataReadLength] : [readAhead rawDataReadLength];
 	}
 	else {
 		return ftell(wrappedFile);
@@ -345,6 +700,10 @@
 {
 	if (!fileIsClosed) {
 		[self synchronizeFile];
+
+		// Wait for any decompression ahead of reads to stop before closing the file
+		if (readAhead) [readAhead stop];
+		if (parallelDecompressor) [parallelDecompressor stop];
 		
 		if (useCompression) {
 			if (compressionFormat == SPGzipCompression) {
@@ -388,6 +747,78 @@
 	return compressionFormat;
 }
 
+/**
+ * Copy up to the supplied number of decompressed bytes into the destination, returning the
+ * number copied.  If the parallel decompressor fails, because the file couldn't be divided
+ * into chunks after all, or the file has been truncated or appended to since it was mapped,
+ * the file is decompressed serially from the start instead, skipping the data already
+ * returned.
+ */
+- (NSUInteger)_readDecompressedBytes:(void *)destination length:(NSUInteger)length
+{
+	NSUInteger bytesRead = 0, skipLength;
+	unsigned long long decompressedLengthToSkip;
+	void *skipBuffer;
+
+	if (parallelDecompressor) {
+		if ([fileMapping fileIsUnchanged]) {
+			bytesRead = [parallelDecompressor readBytes:destination length:length];
+			if (bytesRead == length || ![parallelDecompressor hasFailed]) return bytesRead;
+		}
+
+		decompressedLengthToSkip = [parallelDecompressor decompressedLengthRead];
+		[parallelDecompressor stop];
+		[parallelDecompressor release], parallelDecompressor = nil;
+		[fileMapping release], fileMapping = nil;
+
+		readAhead = [[SPFileHandleReadAhead alloc] initWithFile:wrappedFile compressionFormat:compressionFormat];
+		skipBuffer = malloc(SPFH_READ_AHEAD_BUFFER_SIZE);
+		while (decompressedLengthToSkip) {
+			skipLength = (NSUInteger)MIN(decompressedLengthToSkip, (unsigned long long)SPFH_READ_AHEAD_BUFFER_SIZE);
+			if ([readAhead readBytes:skipBuffer length:skipLength] < skipLength) break;
+			decompressedLengthToSkip -= skipLength;
+		}
+		free(skipBuffer);
+	}
+
+	return bytesRead + [readAhead readBytes:(unsigned char *)destination + bytesRead length:length - bytesRead];
+}
+
+/**
+ * Map a file being read into memory.  Uncompressed files are copied out of the mapping;
+ * compressed files are mapped to be divided into chunks for parallel decompression.  If the
+ * file can't be mapped, for example if it isn't a regular file or is too large for the
+ * address space, it is read using the FILE instead.
+ */
+- (void)_mapFile:(FILE *)theFile
+{
+	struct stat fileStatus;
+	void *mappedBytes;
+	int fileDescriptor;
+
+	if (fstat(fileno(theFile), &fileStatus) || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size <= 0) return;
+	if ((unsigned long long)fileStatus.st_size > (unsigned long long)(size_t)-1) return;
+
+	mappedBytes = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileno(theFile), 0);
+	if (mappedBytes == MAP_FAILED) return;
+
+	// Keep a descriptor for the file, which may be closed while mapped, to check it for changes
+	fileDescriptor = dup(fileno(theFile));
+	if (fileDescriptor == -1) {
+		munmap(mappedBytes, (size_t)fileStatus.st_size);
+		return;
+	}
+
+	// Files are read from start to end, so pages can be read ahead and discarded once read
+	madvise(mappedBytes, (size_t)fileStatus.st_size, MADV_SEQUENTIAL);
+
+	fileMapping = [[SPFileHandleMapping alloc] init];
+	fileMapping->mappedBytes = mappedBytes;
+	fileMapping->mappedLength = (NSUInteger)fileStatus.st_size;
+	fileMapping->fileDescriptor = fileDescriptor;
+	mappedReadPosition = 0;
+}
+
 /**
  * A method to be called on a background thread, allowing write data to build
  * up in a buffer and write to disk in chunks as the buffer fills.  This allows
@@ -470,6 +901,9 @@
 	[self closeFile];
 	
 	if (processingThread) [processingThread release];
+	if (readAhead) [readAhead release], readAhead = nil;
+	if (parallelDecompressor) [parallelDecompressor release], parallelDecompressor = nil;
+	if (fileMapping) [fileMapping release], fileMapping = nil;
 	
 	free(wrappedFilePath);
 	[buffer release];
@@ -0,0 +1,143 @@
+//
+//  $Id$
+//
+//  SPImportCheckpoint.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPImportCheckpoint.h"
+
+// Extension added to the name of the imported file to name the checkpoint file
+static NSString *SPImportCheckpointFileExtension = @"spcheckpoint";
+
+// Keys for the checkpoint file contents
+static NSString *SPImportCheckpointFormatKey = @"Format";
+static NSString *SPImportCheckpointFileSizeKey = @"FileSize";
+static NSString *SPImportCheckpointFileModificationTimeKey = @"FileModificationTime";
+static NSString *SPImportCheckpointStateKey = @"State";
+
+@implementation SPImportCheckpoint
+
+/**
+ * Initialise a checkpoint for an import of the supplied file in the supplied format, such
+ * as "SQL" or "CSV".  Returns nil for files which can't be resumed, such as the temporary
+ * files used for clipboard imports.
+ */
+- (id)initWithImportFile:(NSString *)path format:(NSString *)format
+{
+	NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL];
+
+	if ([path hasPrefix:SPImportClipboardTempFileNamePrefix] || ![fileAttributes objectForKey:NSFileSize] || ![fileAttributes objectForKey:NSFileModificationDate]) {
+		[self release];
+		return nil;
+	}
+
+	if ((self = [super init])) {
+		importFormat = [format copy];
+		checkpointPath = [[path stringByAppendingPathExtension:SPImportCheckpointFileExtension] retain];
+
+		// The file is identified by its size and modification time, to whole seconds as stored in property lists
+		fileSize = [[fileAttributes objectForKey:NSFileSize] retain];
+		fileModificationTime = [[NSNumber alloc] initWithLongLong:(long long)[[fileAttributes objectForKey:NSFileModificationDate] timeIntervalSince1970]];
+
+		lastSaveTime = [NSDate monotonicTimeInterval];
+		saveFailed = NO;
+	}
+
+	return self;
+}
+
+/**
+ * Returns the state saved by the last checkpoint of an import of the file, or nil if there
+ * is none, or if it was saved for another format or before the file was changed.
+ */
+- (NSDictionary *)savedState
+{
+	NSDictionary *checkpoint = [NSDictionary dictionaryWithContentsOfFile:checkpointPath];
+
+	if (![[checkpoint objectForKey:SPImportCheckpointFormatKey] isEqualToString:importFormat]
+		|| ![[checkpoint objectForKey:SPImportCheckpointFileSizeKey] isEqualToNumber:fileSize]
+		|| ![[checkpoint objectForKey:SPImportCheckpointFileModificationTimeKey] isEqualToNumber:fileModificationTime])
+	{
+		return nil;
+	}
+
+	return [checkpoint objectForKey:SPImportCheckpointStateKey];
+}
+
+/**
+ * Returns whether the supplied interval has passed since the last checkpoint was saved, or
+ * since the import started.  Always returns NO once a checkpoint couldn't be saved.
+ */
+- (BOOL)isDueAfterInterval:(double)interval
+{
+	return (!saveFailed && [NSDate monotonicTimeInterval] - lastSaveTime >= interval);
+}
+
+/**
+ * Save a checkpoint with the supplied state, which must consist of property list objects.
+ * If the checkpoint file can't be written, for example beside a file on a read-only volume,
+ * no further checkpoints are attempted.
+ */
+- (void)saveState:(NSDictionary *)state
+{
+	NSDictionary *checkpoint = [NSDictionary dictionaryWithObjectsAndKeys:
+		importFormat, SPImportCheckpointFormatKey,
+		fileSize, SPImportCheckpointFileSizeKey,
+		fileModificationTime, SPImportCheckpointFileModificationTimeKey,
+		state, SPImportCheckpointStateKey,
+		nil];
+
+	if (![checkpoint writeToFile:checkpointPath atomically:YES]) saveFailed = YES;
+
+	lastSaveTime = [NSDate monotonicTimeInterval];
+}
+
+/**
+ * Remove the checkpoint file, once the import has completed.
+ */
+- (void)remove
+{
+	[[NSFileManager defaultManager] removeItemAtPath:checkpointPath error:NULL];
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[importFormat release];
+	[checkpointPath release];
+	[fileSize release];
+	[fileModificationTime release];
+
+	[super dealloc];
+}
+
+@end
@@ -0,0 +1,141 @@
+//
+//  $Id$
+//
+//  SPImportQueryPipeline.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import <SPMySQL/SPMySQL.h>
+
+// Lane to use for queries which may run on any inserter, in any order
+#define SPImportQueryPipelineAnyLane NSNotFound
+
+/**
+ * @class SPImportQueryPipeline SPImportQueryPipeline.h
+ *
+ * Runs import queries on a set of inserter connections cloned from a parent connection,
+ * so that an import can keep reading and parsing its file while earlier statements run.
+ *
+ * Queries are added to lanes; each lane maps to one inserter, whose queries run in the
+ * order they were added, so lanes give ordering where an import needs it - for example
+ * per table or per transaction.  Queries in SPImportQueryPipelineAnyLane go to the least
+ * busy inserter.  Each inserter's queue is bounded, so adding a query blocks while the
+ * inserter has a full queue, keeping the reader no more than a few statements ahead.
+ *
+ * Multi-row INSERTs may be added as row values, which are joined into a single statement
+ * by the inserter; if that statement fails for anything other than a connection error,
+ * the rows are inserted individually to report the errors for each row.  Any other error
+ * fails the pipeline: queued queries are discarded and further queries are refused, unless
+ * the pipeline is set to record query errors, in which case only connection errors fail it.
+ *
+ * Session queries, such as SET statements from the header of a dump file, can be supplied
+ * to be run on each inserter after it connects.  A queued length budget allows the queues
+ * to grow beyond their usual bound while the total length of queued queries is within it,
+ * so that a reader can get ahead of an inserter busy with a long run of queries.
+ *
+ * For bulk loads, each inserter can group its queries into transactions of a set number of
+ * queries.  Rows then only count as completed once their transaction is committed; if the
+ * pipeline fails or is cancelled, each inserter's open transaction is rolled back and its
+ * rows counted as rolled back.  A deadlock, which rolls back the whole transaction, fails
+ * the pipeline rather than being retried row by row.
+ */
+@interface SPImportQueryPipeline : NSObject <SPMySQLConnectionDelegate>
+{
+	id delegate;
+	SPMySQLConnection *parentConnection;
+	NSString *database;
+
+	NSUInteger workerCount;
+	NSMutableArray *workerConnections;
+	NSMutableArray *workerQueues;
+	NSUInteger *workerActiveJobs;
+	NSUInteger workersRunning;
+	BOOL pipelineFinishing;
+	BOOL pipelineCancelled;
+
+	NSString *errorMessage;
+	NSUInteger errorID;
+	NSMutableArray *rowErrors;
+	NSMutableArray *queryErrors;
+	NSArray *sessionQueries;
+	NSStringEncoding queryEncoding;
+	BOOL recordsQueryErrors;
+	NSUInteger maximumQueuedLength;
+	NSUInteger batchesPerTransaction;
+	NSUInteger *workerTransactionJobs;
+	NSMutableArray *workerUncommittedJobs;
+	unsigned long long transactionsCommitted;
+	unsigned long long rowsRolledBack;
+	NSUInteger queuedLength;
+	unsigned long long queriesRun;
+	unsigned long long rowsProcessed;
+	NSUInteger completedRowNumber;
+	NSMutableDictionary *completedRowBatches;
+	double lastQueryTime;
+	NSUInteger lastQueryRowCount;
+
+	pthread_mutex_t pipelineLock;
+	pthread_cond_t pipelineCondition;
+}
+
+// Setup and teardown
+- (id)initWithConnection:(SPMySQLConnection *)aConnection delegate:(id)theDelegate workerCount:(NSUInteger)theWorkerCount;
+- (void)setSessionQueries:(NSArray *)theQueries;
+- (void)setQueryEncoding:(NSStringEncoding)theEncoding;
+- (void)setRecordsQueryErrors:(BOOL)recordErrors;
+- (void)setMaximumQueuedLength:(NSUInteger)theLength;
+- (void)setBatchesPerTransaction:(NSUInteger)theBatchCount;
+- (BOOL)startInDatabase:(NSString *)theDatabase;
+- (void)waitUntilIdle;
+- (void)waitUntilFinished;
+- (void)cancel;
+
+// Adding queries
+- (BOOL)addQuery:(NSString *)query inLane:(NSUInteger)lane;
+- (BOOL)addQuery:(NSString *)query queryNumber:(NSUInteger)queryNumber inLane:(NSUInteger)lane;
+- (BOOL)addRowValues:(NSArray *)valueStrings toQuery:(NSString *)baseQuery tail:(NSString *)tail firstRowNumber:(NSUInteger)firstRowNumber inLane:(NSUInteger)lane;
+
+// State
+- (NSUInteger)workerCount;
+- (BOOL)hasFailed;
+- (NSString *)errorMessage;
+- (NSUInteger)errorID;
+- (NSString *)rowErrorReport;
+- (NSArray *)queryErrors;
+- (unsigned long long)rowsProcessed;
+- (void)setCompletedRowNumber:(NSUInteger)rowNumber;
+- (NSUInteger)completedRowNumber;
+- (double)lastQueryTime;
+- (NSUInteger)lastQueryRowCount;
+- (NSUInteger)batchesPerTransaction;
+- (unsigned long long)transactionsCommitted;
+- (unsigned long long)rowsRolledBack;
+
+@end
@@ -0,0 +1,852 @@
+//
+//  $Id$
+//
+//  SPImportQueryPipeline.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPImportQueryPipeline.h"
+#import "SPThreadAdditions.h"
+#import "SPMySQLConnectionAdditions.h"
+
+#import <pthread.h>
+
+// Number of queries each inserter may have waiting before adding more queries blocks
+static const NSUInteger SPImportQueryPipelineQueueLength = 4;
+
+// Server error ID for a deadlock, after which the server has rolled back the whole transaction
+static const NSUInteger SPImportQueryPipelineDeadlockErrorID = 1213;
+
+/**
+ * A query waiting to be run by an inserter: either a complete query, or row values to be
+ * joined into a multi-row INSERT.
+ */
+@interface SPImportQueryPipelineJob : NSObject
+{
+@public
+	NSString *query;
+	NSArray *valueStrings;
+	NSString *tail;
+	NSUInteger firstRowNumber;
+	NSUInteger queryNumber;
+}
+@end
+
+@implementation SPImportQueryPipelineJob
+
+- (void)dealloc
+{
+	[query release];
+	[valueStrings release];
+	[tail release];
+
+	[super dealloc];
+}
+
+@end
+
+@interface SPImportQueryPipeline (Private_API)
+
+- (BOOL)_addJob:(SPImportQueryPipelineJob *)job inLane:(NSUInteger)lane;
+- (void)_runWorker:(NSNumber *)workerIndex;
+- (BOOL)_runJob:(SPImportQueryPipelineJob *)job onConnection:(SPMySQLConnection *)connection;
+- (BOOL)_isFailingErrorOnConnection:(SPMySQLConnection *)connection;
+- (BOOL)_endTransactionOnWorker:(NSUInteger)workerIndex committing:(BOOL)commit;
+- (void)_recordCompletedRowsOfJob:(SPImportQueryPipelineJob *)job;
+- (void)_failWithErrorMessage:(NSString *)message errorID:(NSUInteger)theErrorID;
+
+@end
+
+@implementation SPImportQueryPipeline
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+/**
+ * Initialise the pipeline to run queries on the supplied number of inserter connections,
+ * cloned from the supplied connection; the delegate supplies connection details.
+ */
+- (id)initWithConnection:(SPMySQLConnection *)aConnection delegate:(id)theDelegate workerCount:(NSUInteger)theWorkerCount
+{
+	if ((self = [super init])) {
+		delegate = theDelegate;
+		parentConnection = [aConnection retain];
+		database = nil;
+
+		workerCount = MAX(1, theWorkerCount);
+		workerConnections = [[NSMutableArray alloc] initWithCapacity:workerCount];
+		workerQueues = [[NSMutableArray alloc] initWithCapacity:workerCount];
+		workerActiveJobs = calloc(workerCount, sizeof(NSUInteger));
+		workersRunning = 0;
+		pipelineFinishing = NO;
+		pipelineCancelled = NO;
+
+		errorMessage = nil;
+		errorID = 0;
+		rowErrors = [[NSMutableArray alloc] init];
+		queryErrors = [[NSMutableArray alloc] init];
+		sessionQueries = nil;
+		queryEncoding = [aConnection stringEncoding];
+		recordsQueryErrors = NO;
+		maximumQueuedLength = 0;
+		batchesPerTransaction = 0;
+		workerTransactionJobs = calloc(workerCount, sizeof(NSUInteger));
+		workerUncommittedJobs = [[NSMutableArray alloc] initWithCapacity:workerCount];
+		transactionsCommitted = 0;
+		rowsRolledBack = 0;
+		queuedLength = 0;
+		queriesRun = 0;
+		rowsProcessed = 0;
+		completedRowNumber = 0;
+		completedRowBatches = [[NSMutableDictionary alloc] init];
+		lastQueryTime = 0;
+		lastQueryRowCount = 0;
+
+		pthread_mutex_init(&pipelineLock, NULL);
+		pthread_cond_init(&pipelineCondition, NULL);
+	}
+
+	return self;
+}
+
+/**
+ * Set queries to be run on each inserter after it connects, for example to match session
+ * variables set on the parent connection.  Errors in these queries are ignored, as they
+ * will also have been reported when run on the parent connection.  Must be set before the
+ * pipeline is started.
+ */
+- (void)setSessionQueries:(NSArray *)theQueries
+{
+	if (sessionQueries) [sessionQueries release], sessionQueries = nil;
+	sessionQueries = [theQueries copy];
+}
+
+/**
+ * Set the encoding used to send queries to the server; defaults to the string encoding of
+ * the parent connection.  Must be set before the pipeline is started.
+ */
+- (void)setQueryEncoding:(NSStringEncoding)theEncoding
+{
+	queryEncoding = theEncoding;
+}
+
+/**
+ * Set whether errors in plain queries are recorded, along with their query numbers, rather
+ * than failing the pipeline.  Connection errors always fail the pipeline.  Must be set
+ * before the pipeline is started.
+ */
+- (void)setRecordsQueryErrors:(BOOL)recordErrors
+{
+	recordsQueryErrors = recordErrors;
+}
+
+/**
+ * Set a total length of queued queries, in characters, within which inserter queues may
+ * grow beyond their usual bound; 0, the default, keeps queues to the usual bound.  Must be
+ * set before the pipeline is started.
+ */
+- (void)setMaximumQueuedLength:(NSUInteger)theLength
+{
+	maximumQueuedLength = theLength;
+}
+
+/**
+ * Set the number of queries each inserter runs in a transaction before committing it; 0,
+ * the default, runs each query in its own implicit transaction.  Must be set before the
+ * pipeline is started.
+ */
+- (void)setBatchesPerTransaction:(NSUInteger)theBatchCount
+{
+	batchesPerTransaction = theBatchCount;
+}
+
+/**
+ * Connect the inserter connections, using the supplied database, and start the inserters.
+ * Returns NO if the connections couldn't be made, for example if the server has no
+ * connections to spare, in which case the pipeline can't be used.
+ */
+- (BOOL)startInDatabase:(NSString *)theDatabase
+{
+	NSUInteger i;
+
+	if (![parentConnection isConnected]) return NO;
+
+	database = [theDatabase copy];
+
+	for (i = 0; i < workerCount; i++) {
+		SPMySQLConnection *workerConnection = [parentConnection cloneWithDelegate:self];
+
+		if (![workerConnection connectAsCloneOfConnection:parentConnection]) break;
+
+		if (database && ![workerConnection selectDatabase:database]) {
+			[workerConnection disconnect];
+			break;
+		}
+
+		for (NSString *sessionQuery in sessionQueries) {
+			[workerConnection queryString:sessionQuery usingEncoding:queryEncoding withResultType:SPMySQLResultAsResult];
+		}
+
+		[workerConnections addObject:workerConnection];
+		[workerQueues addObject:[NSMutableArray array]];
+		[workerUncommittedJobs addObject:[NSMutableArray array]];
+	}
+
+	// Give up if no inserters could connect; otherwise use those which did
+	if (![workerConnections count]) return NO;
+	workerCount = [workerConnections count];
+
+	pthread_mutex_lock(&pipelineLock);
+	workersRunning = workerCount;
+	pthread_mutex_unlock(&pipelineLock);
+
+	for (i = 0; i < workerCount; i++) {
+		[NSThread detachNewThreadWithName:@"SPImportQueryPipeline inserter task" target:self selector:@selector(_runWorker:) object:[NSNumber numberWithUnsignedInteger:i]];
+	}
+
+	return YES;
+}
+
+/**
+ * Wait for all queued queries to be run, leaving the inserters running to accept more.
+ * Any open transactions are left open.
+ */
+- (void)waitUntilIdle
+{
+	NSUInteger i;
+
+	pthread_mutex_lock(&pipelineLock);
+	while (workersRunning && !pipelineCancelled) {
+		for (i = 0; i < workerCount; i++) {
+			if ([[workerQueues objectAtIndex:i] count] || workerActiveJobs[i]) break;
+		}
+		if (i == workerCount) break;
+		pthread_cond_wait(&pipelineCondition, &pipelineLock);
+	}
+	pthread_mutex_unlock(&pipelineLock);
+}
+
+/**
+ * Wait for all queued queries to be run and any open transactions to be committed, then
+ * disconnect the inserter connections.
+ */
+- (void)waitUntilFinished
+{
+	pthread_mutex_lock(&pipelineLock);
+	pipelineFinishing = YES;
+	pthread_cond_broadcast(&pipelineCondition);
+	while (workersRunning) {
+		pthread_cond_wait(&pipelineCondition, &pipelineLock);
+	}
+	pthread_mutex_unlock(&pipelineLock);
+
+	for (SPMySQLConnection *workerConnection in workerConnections) {
+		[workerConnection disconnect];
+	}
+}
+
+/**
+ * Discard any queued queries and refuse further queries; queries already running are
+ * allowed to finish, and any open transactions are then rolled back.
+ */
+- (void)cancel
+{
+	pthread_mutex_lock(&pipelineLock);
+	pipelineCancelled = YES;
+	for (NSMutableArray *workerQueue in workerQueues) {
+		[workerQueue removeAllObjects];
+	}
+	queuedLength = 0;
+	pthread_cond_broadcast(&pipelineCondition);
+	pthread_mutex_unlock(&pipelineLock);
+}
+
+#pragma mark -
+#pragma mark Adding queries
+
+/**
+ * Add a query to run in the supplied lane, blocking while the lane's inserter has a full
+ * queue.  Returns NO if the pipeline has failed or been cancelled.
+ */
+- (BOOL)addQuery:(NSString *)query inLane:(NSUInteger)lane
+{
+	SPImportQueryPipelineJob *job = [[SPImportQueryPipelineJob alloc] init];
+	job->query = [query copy];
+
+	BOOL jobAdded = [self _addJob:job inLane:lane];
+	[job release];
+
+	return jobAdded;
+}
+
+/**
+ * Add a query to run in the supplied lane, as above, with the query number to report any
+ * error against if the pipeline records query errors.
+ */
+- (BOOL)addQuery:(NSString *)query queryNumber:(NSUInteger)queryNumber inLane:(NSUInteger)lane
+{
+	SPImportQueryPipelineJob *job = [[SPImportQueryPipelineJob alloc] init];
+	job->query = [query copy];
+	job->queryNumber = queryNumber;
+
+	BOOL jobAdded = [self _addJob:job inLane:lane];
+	[job release];
+
+	return jobAdded;
+}
+
+/**
+ * Add a multi-row INSERT to run in the supplied lane, as an INSERT query up to the VALUES
+ * keyword, the row value strings, and any tail such as an ON DUPLICATE KEY UPDATE clause.
+ * The row number of the first row is used when reporting errors for individual rows.
+ * Blocks while the lane's inserter has a full queue; returns NO if the pipeline has failed
+ * or been cancelled.
+ */
+- (BOOL)addRowValues:(NSArray *)valueStrings toQuery:(NSString *)baseQuery tail:(NSString *)tail firstRowNumber:(NSUInteger)firstRowNumber inLane:(NSUInteger)lane
+{
+	SPImportQueryPipelineJob *job = [[SPImportQueryPipelineJob alloc] init];
+	job->query = [baseQuery copy];
+	job->valueStrings = [valueStrings copy];
+	job->tail = [tail length] ? [tail copy] : nil;
+	job->firstRowNumber = firstRowNumber;
+
+	BOOL jobAdded = [self _addJob:job inLane:lane];
+	[job release];
+
+	return jobAdded;
+}
+
+#pragma mark -
+#pragma mark State
+
+/**
+ * Returns the number of inserters running queries.
+ */
+- (NSUInteger)workerCount
+{
+	return workerCount;
+}
+
+/**
+ * Returns whether a query failed, stopping the pipeline.
+ */
+- (BOOL)hasFailed
+{
+	pthread_mutex_lock(&pipelineLock);
+	BOOL hasFailed = (errorMessage != nil);
+	pthread_mutex_unlock(&pipelineLock);
+
+	return hasFailed;
+}
+
+/**
+ * Returns the error which stopped the pipeline, if any.
+ */
+- (NSString *)errorMessage
+{
+	pthread_mutex_lock(&pipelineLock);
+	NSString *theErrorMessage = [[errorMessage retain] autorelease];
+	pthread_mutex_unlock(&pipelineLock);
+
+	return theErrorMessage;
+}
+
+/**
+ * Returns the MySQL error ID of the error which stopped the pipeline, or 0.
+ */
+- (NSUInteger)errorID
+{
+	return errorID;
+}
+
+/**
+ * Returns the errors for individual rows which couldn't be inserted, in row order, one
+ * per line.
+ */
+- (NSString *)rowErrorReport
+{
+	NSMutableString *report = [NSMutableString string];
+
+	pthread_mutex_lock(&pipelineLock);
+	NSArray *sortedRowErrors = [rowErrors sortedArrayUsingDescriptors:[NSArray arrayWithObject:[[[NSSortDescriptor alloc] initWithKey:@"row" ascending:YES] autorelease]]];
+	pthread_mutex_unlock(&pipelineLock);
+
+	for (NSDictionary *rowError in sortedRowErrors) {
+		[report appendFormat:NSLocalizedString(@"[ERROR in row %ld] %@\n", @"error text when reading of csv file gave errors"),
+			(long)[[rowError objectForKey:@"row"] unsignedIntegerValue], [rowError objectForKey:@"message"]];
+	}
+
+	return report;
+}
+
+/**
+ * Returns the errors recorded for plain queries, in the order they occurred, as
+ * dictionaries of the query number and the error message.  Only used if the pipeline
+ * records query errors.
+ */
+- (NSArray *)queryErrors
+{
+	pthread_mutex_lock(&pipelineLock);
+	NSArray *theQueryErrors = [NSArray arrayWithArray:queryErrors];
+	pthread_mutex_unlock(&pipelineLock);
+
+	return theQueryErrors;
+}
+
+/**
+ * Returns the number of rows added as row values which have been processed, whether or
+ * not they could be inserted.
+ */
+- (unsigned long long)rowsProcessed
+{
+	return rowsProcessed;
+}
+
+/**
+ * Set the number of the last row known to be processed before any rows are added, for
+ * example when resuming an import; defaults to 0.
+ */
+- (void)setCompletedRowNumber:(NSUInteger)rowNumber
+{
+	pthread_mutex_lock(&pipelineLock);
+	completedRowNumber = rowNumber;
+	pthread_mutex_unlock(&pipelineLock);
+}
+
+/**
+ * Returns the number of the last row for which it and all earlier rows added as row values
+ * have been processed.  As inserters complete batches out of order, this may trail the rows
+ * processed; it is always the last row of a batch.  When running queries in transactions,
+ * a batch is only completed once its transaction has been committed.
+ */
+- (NSUInteger)completedRowNumber
+{
+	pthread_mutex_lock(&pipelineLock);
+	NSUInteger theCompletedRowNumber = completedRowNumber;
+	pthread_mutex_unlock(&pipelineLock);
+
+	return theCompletedRowNumber;
+}
+
+/**
+ * Returns the time taken by the most recently completed query.
+ */
+- (double)lastQueryTime
+{
+	return lastQueryTime;
+}
+
+/**
+ * Returns the number of rows in the most recently completed query, or 0 if it was not
+ * added as row values.
+ */
+- (NSUInteger)lastQueryRowCount
+{
+	return lastQueryRowCount;
+}
+
+/**
+ * Returns the number of queries each inserter runs per transaction, or 0 if queries aren't
+ * grouped into transactions.
+ */
+- (NSUInteger)batchesPerTransaction
+{
+	return batchesPerTransaction;
+}
+
+/**
+ * Returns the number of transactions committed across all inserters.
+ */
+- (unsigned long long)transactionsCommitted
+{
+	return transactionsCommitted;
+}
+
+/**
+ * Returns the number of rows added as row values whose transactions were rolled back,
+ * either explicitly when the pipeline failed or was cancelled, or by the server after a
+ * deadlock or lost connection.
+ */
+- (unsigned long long)rowsRolledBack
+{
+	return rowsRolledBack;
+}
+
+#pragma mark -
+#pragma mark SPMySQLConnection delegate methods
+
+/**
+ * Forward keychain password requests to the database object.
+ */
+- (NSString *)keychainPasswordForConnection:(id)connection
+{
+	return [delegate keychainPasswordForConnection:connection];
+}
+
+/**
+ * Forward errors the inserter connections would show to the user to the delegate on the
+ * main thread, so that no alert is run from an inserter thread.
+ */
+- (void)showErrorWithTitle:(NSString *)title message:(NSString *)message
+{
+	if ([delegate respondsToSelector:@selector(showErrorWithTitle:message:)]) {
+		[[delegate onMainThread] showErrorWithTitle:title message:message];
+	} else {
+		NSLog(@"%@: %@", title, message);
+	}
+}
+
+/**
+ * Decide how an inserter whose connection was lost should proceed; the connection asks on
+ * the main thread.  A reconnected inserter would lose its session variables and any open
+ * transaction, silently writing later rows differently or dropping earlier ones, so the
+ * inserter is always disconnected, failing the pipeline with an error the import reports.
+ * The document's connection isn't affected.
+ */
+- (SPMySQLConnectionLostDecision)connectionLost:(id)connection
+{
+	BOOL pipelineActive;
+
+	pthread_mutex_lock(&pipelineLock);
+	pipelineActive = !pipelineCancelled;
+	pthread_mutex_unlock(&pipelineLock);
+
+	if (pipelineActive) {
+		[self _failWithErrorMessage:NSLocalizedString(@"The connection to the server used to import rows was lost.", @"error when an import inserter connection was lost") errorID:0];
+	}
+
+	return SPMySQLConnectionLostDisconnect;
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	pthread_mutex_destroy(&pipelineLock);
+	pthread_cond_destroy(&pipelineCondition);
+
+	for (SPMySQLConnection *workerConnection in workerConnections) {
+		[workerConnection setDelegate:nil];
+		[workerConnection disconnect];
+	}
+	[workerConnections release];
+	[workerQueues release];
+	free(workerActiveJobs);
+	free(workerTransactionJobs);
+	[workerUncommittedJobs release];
+	[rowErrors release];
+	[queryErrors release];
+	[completedRowBatches release];
+	if (sessionQueries) [sessionQueries release], sessionQueries = nil;
+	if (errorMessage) [errorMessage release], errorMessage = nil;
+	if (database) [database release], database = nil;
+	[parentConnection release];
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPImportQueryPipeline (Private_API)
+
+/**
+ * Queue a job for the inserter serving the supplied lane, or the least busy inserter,
+ * waiting for space in its queue or within the queued length budget.  Returns NO if the
+ * pipeline has failed or been cancelled.
+ */
+- (BOOL)_addJob:(SPImportQueryPipelineJob *)job inLane:(NSUInteger)lane
+{
+	NSUInteger i, workerIndex;
+	NSUInteger jobLength = [job->query length];
+
+	pthread_mutex_lock(&pipelineLock);
+	while (1) {
+		if (pipelineCancelled || !workersRunning) {
+			pthread_mutex_unlock(&pipelineLock);
+			return NO;
+		}
+
+		if (lane == SPImportQueryPipelineAnyLane) {
+			workerIndex = 0;
+			for (i = 1; i < workerCount; i++) {
+				if ([[workerQueues objectAtIndex:i] count] + workerActiveJobs[i] < [[workerQueues objectAtIndex:workerIndex] count] + workerActiveJobs[workerIndex]) {
+					workerIndex = i;
+				}
+			}
+		} else {
+			workerIndex = lane % workerCount;
+		}
+
+		if ([[workerQueues objectAtIndex:workerIndex] count] < SPImportQueryPipelineQueueLength) break;
+		if (maximumQueuedLength && queuedLength + jobLength <= maximumQueuedLength) break;
+
+		pthread_cond_wait(&pipelineCondition, &pipelineLock);
+	}
+
+	[[workerQueues objectAtIndex:workerIndex] addObject:job];
+	queuedLength += jobLength;
+	pthread_cond_broadcast(&pipelineCondition);
+	pthread_mutex_unlock(&pipelineLock);
+
+	return YES;
+}
+
+/**
+ * Run the queries queued for one inserter, in order, until the pipeline is finished,
+ * failed or cancelled.  Should always be executed on a background thread.
+ */
+- (void)_runWorker:(NSNumber *)workerIndexNumber
+{
+	NSAutoreleasePool *workerPool = [[NSAutoreleasePool alloc] init];
+	NSUInteger workerIndex = [workerIndexNumber unsignedIntegerValue];
+	SPMySQLConnection *workerConnection = [workerConnections objectAtIndex:workerIndex];
+	NSMutableArray *workerQueue = [workerQueues objectAtIndex:workerIndex];
+
+	pthread_mutex_lock(&pipelineLock);
+	while (1) {
+		while (!pipelineCancelled && !pipelineFinishing && ![workerQueue count]) {
+			pthread_cond_wait(&pipelineCondition, &pipelineLock);
+		}
+		if (pipelineCancelled || ![workerQueue count]) break;
+
+		SPImportQueryPipelineJob *job = [[workerQueue objectAtIndex:0] retain];
+		[workerQueue removeObjectAtIndex:0];
+		queuedLength -= MIN(queuedLength, [job->query length]);
+		workerActiveJobs[workerIndex]++;
+		pthread_cond_broadcast(&pipelineCondition);
+		pthread_mutex_unlock(&pipelineLock);
+
+		NSAutoreleasePool *jobPool = [[NSAutoreleasePool alloc] init];
+		BOOL jobSucceeded = YES;
+
+		// Open a transaction for the job if running queries in transactions
+		if (batchesPerTransaction && !workerTransactionJobs[workerIndex]) {
+			[workerConnection queryString:@"START TRANSACTION"];
+			if ([workerConnection queryErrored]) {
+				[self _failWithErrorMessage:[workerConnection lastErrorMessage] errorID:[workerConnection lastErrorID]];
+				jobSucceeded = NO;
+			}
+		}
+
+		double queryStartTime = [NSDate monotonicTimeInterval];
+		if (jobSucceeded) jobSucceeded = [self _runJob:job onConnection:workerConnection];
+		double queryTime = [NSDate monotonicTimeInterval] - queryStartTime;
+
+		// Rows run in a transaction are only completed once it is committed
+		BOOL jobCompleted = jobSucceeded;
+		if (batchesPerTransaction) {
+			jobCompleted = NO;
+			if (job->valueStrings) [[workerUncommittedJobs objectAtIndex:workerIndex] addObject:job];
+			workerTransactionJobs[workerIndex]++;
+			if (jobSucceeded && workerTransactionJobs[workerIndex] >= batchesPerTransaction) {
+				[self _endTransactionOnWorker:workerIndex committing:YES];
+			}
+		}
+		[jobPool drain];
+
+		pthread_mutex_lock(&pipelineLock);
+		workerActiveJobs[workerIndex]--;
+		queriesRun++;
+		if (jobSucceeded) {
+			rowsProcessed += [job->valueStrings count];
+			lastQueryTime = queryTime;
+			lastQueryRowCount = [job->valueStrings count];
+			if (jobCompleted) [self _recordCompletedRowsOfJob:job];
+		}
+		[job release];
+		pthread_cond_broadcast(&pipelineCondition);
+	}
+
+	// Commit any open transaction once all queries have run, or roll it back if cancelled
+	if (workerTransactionJobs[workerIndex]) {
+		BOOL commitTransaction = !pipelineCancelled;
+		workerActiveJobs[workerIndex]++;
+		pthread_mutex_unlock(&pipelineLock);
+		[self _endTransactionOnWorker:workerIndex committing:commitTransaction];
+		pthread_mutex_lock(&pipelineLock);
+		workerActiveJobs[workerIndex]--;
+	}
+	workersRunning--;
+	pthread_cond_broadcast(&pipelineCondition);
+	pthread_mutex_unlock(&pipelineLock);
+
+	[workerPool drain];
+}
+
+/**
+ * Run a job on an inserter connection.  If a multi-row INSERT fails for a reason other than
+ * a lost connection, its rows are inserted individually and the row errors recorded; errors
+ * in plain queries are recorded if the pipeline records query errors, and any other error
+ * fails the pipeline.  Returns NO if the pipeline was failed.
+ */
+- (BOOL)_runJob:(SPImportQueryPipelineJob *)job onConnection:(SPMySQLConnection *)connection
+{
+	NSUInteger i;
+
+	if (!job->valueStrings) {
+		[connection queryString:job->query usingEncoding:queryEncoding withResultType:SPMySQLResultAsResult];
+		if ([connection queryErrored]) {
+			if (!recordsQueryErrors || [self _isFailingErrorOnConnection:connection]) {
+				[self _failWithErrorMessage:[connection lastErrorMessage] errorID:[connection lastErrorID]];
+				return NO;
+			}
+			if (![[connection lastErrorMessage] isEqualToString:@"Query was empty"]) {
+				pthread_mutex_lock(&pipelineLock);
+				[queryErrors addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+					[NSNumber numberWithUnsignedInteger:job->queryNumber], @"query",
+					[connection lastErrorMessage], @"message",
+					nil]];
+				pthread_mutex_unlock(&pipelineLock);
+			}
+		}
+		return YES;
+	}
+
+	NSMutableString *query = [NSMutableString stringWithString:job->query];
+	[query appendString:[job->valueStrings componentsJoinedByString:@",\n"]];
+	if (job->tail) [query appendFormat:@" %@", job->tail];
+	[connection queryString:query usingEncoding:queryEncoding withResultType:SPMySQLResultAsResult];
+
+	if (![connection queryErrored]) return YES;
+
+	if ([self _isFailingErrorOnConnection:connection]) {
+		[self _failWithErrorMessage:[connection lastErrorMessage] errorID:[connection lastErrorID]];
+		return NO;
+	}
+
+	// Insert the rows individually to find the rows in error
+	for (i = 0; i < [job->valueStrings count]; i++) {
+		if (pipelineCancelled) return NO;
+
+		[query setString:job->query];
+		[query appendString:[job->valueStrings objectAtIndex:i]];
+		if (job->tail) [query appendFormat:@" %@", job->tail];
+		[connection queryString:query usingEncoding:queryEncoding withResultType:SPMySQLResultAsResult];
+
+		if ([connection queryErrored]) {
+			if ([self _isFailingErrorOnConnection:connection]) {
+				[self _failWithErrorMessage:[connection lastErrorMessage] errorID:[connection lastErrorID]];
+				return NO;
+			}
+
+			pthread_mutex_lock(&pipelineLock);
+			[rowErrors addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+				[NSNumber numberWithUnsignedInteger:job->firstRowNumber + i], @"row",
+				[connection lastErrorMessage], @"message",
+				nil]];
+			pthread_mutex_unlock(&pipelineLock);
+		}
+	}
+
+	return YES;
+}
+
+/**
+ * Returns whether the last error on an inserter connection should fail the pipeline rather
+ * than be recorded against a row or query: a lost connection, or a deadlock while running
+ * queries in transactions, after which the server has rolled back the whole transaction.
+ */
+- (BOOL)_isFailingErrorOnConnection:(SPMySQLConnection *)connection
+{
+	if ([SPMySQLConnection isErrorIDConnectionError:[connection lastErrorID]] || ![connection isConnected]) return YES;
+
+	return (batchesPerTransaction && [connection lastErrorID] == SPImportQueryPipelineDeadlockErrorID);
+}
+
+/**
+ * Commit or roll back an inserter's open transaction.  Committed rows are recorded as
+ * completed; if the transaction is rolled back, or the commit fails, its rows are counted
+ * as rolled back, and a failed commit fails the pipeline.  Returns whether the transaction
+ * was committed.
+ */
+- (BOOL)_endTransactionOnWorker:(NSUInteger)workerIndex committing:(BOOL)commit
+{
+	SPMySQLConnection *workerConnection = [workerConnections objectAtIndex:workerIndex];
+	NSMutableArray *uncommittedJobs = [workerUncommittedJobs objectAtIndex:workerIndex];
+	unsigned long long uncommittedRowCount = 0;
+
+	[workerConnection queryString:(commit ? @"COMMIT" : @"ROLLBACK")];
+	BOOL committed = (commit && ![workerConnection queryErrored]);
+
+	if (commit && !committed) {
+		[self _failWithErrorMessage:[NSString stringWithFormat:NSLocalizedString(@"The transaction could not be committed: %@", @"error when committing a transaction of CSV import batches failed, with detail from MySQL"), [workerConnection lastErrorMessage]] errorID:[workerConnection lastErrorID]];
+	}
+
+	pthread_mutex_lock(&pipelineLock);
+	for (SPImportQueryPipelineJob *uncommittedJob in uncommittedJobs) {
+		if (committed) [self _recordCompletedRowsOfJob:uncommittedJob];
+		else uncommittedRowCount += [uncommittedJob->valueStrings count];
+	}
+	if (committed) transactionsCommitted++;
+	rowsRolledBack += uncommittedRowCount;
+	pthread_cond_broadcast(&pipelineCondition);
+	pthread_mutex_unlock(&pipelineLock);
+
+	[uncommittedJobs removeAllObjects];
+	workerTransactionJobs[workerIndex] = 0;
+
+	return committed;
+}
+
+/**
+ * Advance the completed row number over a job's batch of rows and any later batches already
+ * completed.  Must be called with the pipeline lock held.
+ */
+- (void)_recordCompletedRowsOfJob:(SPImportQueryPipelineJob *)job
+{
+	NSNumber *batchRowCount;
+
+	if (!job->valueStrings) return;
+
+	[completedRowBatches setObject:[NSNumber numberWithUnsignedInteger:[job->valueStrings count]] forKey:[NSNumber numberWithUnsignedInteger:job->firstRowNumber]];
+	while ((batchRowCount = [completedRowBatches objectForKey:[NSNumber numberWithUnsignedInteger:completedRowNumber + 1]])) {
+		[completedRowBatches removeObjectForKey:[NSNumber numberWithUnsignedInteger:completedRowNumber + 1]];
+		completedRowNumber += [batchRowCount unsignedIntegerValue];
+	}
+}
+
+/**
+ * Record the first error to stop the pipeline, and cancel all queued queries.
+ */
+- (void)_failWithErrorMessage:(NSString *)message errorID:(NSUInteger)theErrorID
+{
+	pthread_mutex_lock(&pipelineLock);
+	if (!errorMessage) {
+		errorMessage = [(message ? message : @"") copy];
+		errorID = theErrorID;
+	}
+	pthread_mutex_unlock(&pipelineLock);
+
+	[self cancel];
+}
+
+@end
@@ -0,0 +1,92 @@
+//
+//  $Id$
+//
+//  SPLocalInfileFileSource.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import <SPMySQL/SPMySQL.h>
+
+@class SPFileHandle, SPCSVParser;
+
+/**
+ * @class SPLocalInfileFileSource SPLocalInfileFileSource.h
+ *
+ * Supplies the rows of a CSV file, decompressed if necessary, to a LOAD DATA LOCAL INFILE
+ * query run with -[SPMySQLConnection queryString:withLocalInfileSource:].
+ *
+ * The file is not passed to the server as-is: the server's CSV reading differs from
+ * SPCSVParser's in its whitespace, empty line, escape sequence and NULL handling, so the
+ * same file could otherwise import differently depending on the import path taken.  Instead
+ * the file is read with the supplied parser, and each parsed row is written out again in a
+ * fixed, unambiguous format - UTF-8, tab separated, with backslash escapes and \N for NULL -
+ * which the load query must describe using +loadDataFormatClause and a UTF-8 character set.
+ *
+ * The delegate is informed of progress from within the query, on the thread running
+ * it, and may cancel the load by returning NO.
+ */
+@interface SPLocalInfileFileSource : NSObject <SPMySQLLocalInfileSource>
+{
+	SPFileHandle *fileHandle;
+	SPCSVParser *csvParser;
+	NSUInteger columnCount;
+	BOOL skipsFirstRow;
+	BOOL firstRowSkipped;
+	BOOL fileReadCompletely;
+	BOOL rowsExhausted;
+	NSMutableData *pendingData;
+	NSUInteger pendingDataPosition;
+	unsigned long long bytesSupplied;
+	unsigned long long rowsSupplied;
+	BOOL sourceCancelled;
+	NSString *errorMessage;
+
+	id delegate;
+}
+
+@property (readwrite, assign) id delegate;
+@property (readwrite, assign) BOOL skipsFirstRow;
+
++ (NSString *)loadDataFormatClause;
+
+- (id)initWithFileHandle:(SPFileHandle *)aFileHandle parser:(SPCSVParser *)aParser columnCount:(NSUInteger)theColumnCount;
+
+- (SPFileHandle *)fileHandle;
+- (unsigned long long)bytesSupplied;
+- (unsigned long long)rowsSupplied;
+- (BOOL)wasCancelled;
+
+@end
+
+@interface NSObject (SPLocalInfileFileSourceDelegate)
+
+- (BOOL)localInfileFileSource:(SPLocalInfileFileSource *)source shouldContinueAfterParsingBytes:(unsigned long long)totalBytes;
+
+@end
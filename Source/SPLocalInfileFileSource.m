@@ -0,0 +1,288 @@
+//
+//  $Id$
+//
+//  SPLocalInfileFileSource.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPLocalInfileFileSource.h"
+#import "SPFileHandle.h"
+#import "SPCSVParser.h"
+
+// Size of the blocks read from the file handle, and the length of re-written rows built up
+// before supplying them; the client library requests data in smaller blocks, which are
+// served from the pending rows.
+static const NSUInteger SPLocalInfileFileSourceChunkLength = 256 * 1024;
+
+static void _SPLocalInfileAppendCell(NSMutableData *rowData, id cell);
+
+@interface SPLocalInfileFileSource (Private_API)
+
+- (BOOL)_fillPendingData;
+
+@end
+
+@implementation SPLocalInfileFileSource
+
+@synthesize delegate;
+@synthesize skipsFirstRow;
+
+/**
+ * Returns the FIELDS and LINES clauses describing the rows supplied by the source.
+ */
++ (NSString *)loadDataFormatClause
+{
+	return @"FIELDS TERMINATED BY '\\t' ENCLOSED BY '' ESCAPED BY '\\\\' LINES TERMINATED BY '\\n' STARTING BY ''";
+}
+
+/**
+ * Initialise the source to supply the rows of the CSV data read from the supplied file
+ * handle, from its current read position, using the supplied parser, which must already be
+ * set up with the import's terminator, quote, escape, null and encoding settings.  Only the
+ * first column count cells of each row are supplied.
+ */
+- (id)initWithFileHandle:(SPFileHandle *)aFileHandle parser:(SPCSVParser *)aParser columnCount:(NSUInteger)theColumnCount
+{
+	if ((self = [super init])) {
+		fileHandle = [aFileHandle retain];
+		csvParser = [aParser retain];
+		columnCount = theColumnCount;
+		skipsFirstRow = NO;
+		firstRowSkipped = NO;
+		fileReadCompletely = NO;
+		rowsExhausted = NO;
+		pendingData = [[NSMutableData alloc] initWithCapacity:SPLocalInfileFileSourceChunkLength + 4096];
+		pendingDataPosition = 0;
+		bytesSupplied = 0;
+		rowsSupplied = 0;
+		sourceCancelled = NO;
+		errorMessage = nil;
+		delegate = nil;
+	}
+
+	return self;
+}
+
+#pragma mark -
+#pragma mark SPMySQLLocalInfileSource protocol
+
+/**
+ * Copy the next block of re-written rows into the client library's buffer, parsing more
+ * of the file as required.
+ */
+- (NSInteger)readLocalInfileBytes:(char *)buffer maxLength:(NSUInteger)maxLength
+{
+	if (sourceCancelled || errorMessage) return -1;
+
+	if (pendingDataPosition >= [pendingData length]) {
+		if (![self _fillPendingData]) return -1;
+
+		// No more rows - end of file
+		if (![pendingData length]) return 0;
+
+		if (delegate && ![delegate localInfileFileSource:self shouldContinueAfterParsingBytes:[csvParser totalLengthParsed]]) {
+			sourceCancelled = YES;
+			return -1;
+		}
+	}
+
+	NSUInteger copyLength = MIN(maxLength, [pendingData length] - pendingDataPosition);
+	memcpy(buffer, (const char *)[pendingData bytes] + pendingDataPosition, copyLength);
+	pendingDataPosition += copyLength;
+	bytesSupplied += copyLength;
+
+	return (NSInteger)copyLength;
+}
+
+/**
+ * Returns the error to report for a failed load.
+ */
+- (NSString *)localInfileErrorMessage
+{
+	if (sourceCancelled) return NSLocalizedString(@"Query cancelled.", @"Query cancelled error");
+
+	return errorMessage;
+}
+
+#pragma mark -
+#pragma mark Source state
+
+/**
+ * Returns the file handle the data is being read from.
+ */
+- (SPFileHandle *)fileHandle
+{
+	return fileHandle;
+}
+
+/**
+ * Returns the number of bytes of re-written rows supplied to the server so far.
+ */
+- (unsigned long long)bytesSupplied
+{
+	return bytesSupplied;
+}
+
+/**
+ * Returns the number of rows supplied to the server so far.
+ */
+- (unsigned long long)rowsSupplied
+{
+	return rowsSupplied;
+}
+
+/**
+ * Returns whether the delegate cancelled the load.
+ */
+- (BOOL)wasCancelled
+{
+	return sourceCancelled;
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[fileHandle release];
+	[csvParser release];
+	[pendingData release];
+	if (errorMessage) [errorMessage release], errorMessage = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPLocalInfileFileSource (Private_API)
+
+/**
+ * Replace the pending data with the next rows parsed from the file, re-written in the
+ * format described by +loadDataFormatClause, reading more of the file as required.  Leaves
+ * the pending data empty once all rows have been supplied.  Returns NO if the file couldn't
+ * be read or decoded, recording the error.
+ */
+- (BOOL)_fillPendingData
+{
+	NSArray *csvRowArray;
+	NSUInteger i, cellCount;
+
+	[pendingData setLength:0];
+	pendingDataPosition = 0;
+
+	while (!rowsExhausted && [pendingData length] < SPLocalInfileFileSourceChunkLength) {
+		NSAutoreleasePool *rowPool = [[NSAutoreleasePool alloc] init];
+		csvRowArray = [csvParser getRowAsArrayAndTrimString:YES stringIsComplete:fileReadCompletely];
+
+		if (!csvRowArray) {
+			[rowPool drain];
+
+			if ([csvParser dataDecodingFailed]) {
+				errorMessage = [NSLocalizedString(@"The file could not be read using the selected encoding.", @"error when a CSV file supplied to LOAD DATA LOCAL INFILE can't be decoded") retain];
+				return NO;
+			}
+
+			// With all the data parsed, there are no more rows
+			if (fileReadCompletely) {
+				rowsExhausted = YES;
+				break;
+			}
+
+			// Otherwise read more of the file for the parser
+			NSData *fileChunk = nil;
+			@try {
+				fileChunk = [fileHandle readDataOfLength:SPLocalInfileFileSourceChunkLength];
+			}
+			@catch (NSException *exception) {
+				errorMessage = [[exception reason] copy];
+				return NO;
+			}
+			if ([fileChunk length]) [csvParser appendData:fileChunk];
+			else fileReadCompletely = YES;
+			continue;
+		}
+
+		// The header row is read by the parser as any other row, after skipped empty lines
+		if (skipsFirstRow && !firstRowSkipped) {
+			firstRowSkipped = YES;
+			[rowPool drain];
+			continue;
+		}
+
+		cellCount = MIN([csvRowArray count], columnCount);
+		for (i = 0; i < cellCount; i++) {
+			if (i) [pendingData appendBytes:"\t" length:1];
+			_SPLocalInfileAppendCell(pendingData, [csvRowArray objectAtIndex:i]);
+		}
+		[pendingData appendBytes:"\n" length:1];
+		rowsSupplied++;
+
+		[rowPool drain];
+	}
+
+	return YES;
+}
+
+@end
+
+/**
+ * Append a parsed cell to the row data as UTF-8, escaping the characters which have a
+ * meaning in the load format; NULL cells are written as \N.
+ */
+static void _SPLocalInfileAppendCell(NSMutableData *rowData, id cell)
+{
+	if (cell == [NSNull null]) {
+		[rowData appendBytes:"\\N" length:2];
+		return;
+	}
+
+	NSData *cellData = [[cell description] dataUsingEncoding:NSUTF8StringEncoding];
+	const char *cellBytes = [cellData bytes];
+	NSUInteger cellLength = [cellData length];
+	NSUInteger i, runStart = 0;
+	const char *escapedBytes;
+
+	for (i = 0; i < cellLength; i++) {
+		switch (cellBytes[i]) {
+			case '\\': escapedBytes = "\\\\"; break;
+			case '\t': escapedBytes = "\\t"; break;
+			case '\n': escapedBytes = "\\n"; break;
+			case '\r': escapedBytes = "\\r"; break;
+			case '\0': escapedBytes = "\\0"; break;
+			default: continue;
+		}
+		if (i > runStart) [rowData appendBytes:cellBytes + runStart length:i - runStart];
+		[rowData appendBytes:escapedBytes length:2];
+		runStart = i + 1;
+	}
+	if (cellLength > runStart) [rowData appendBytes:cellBytes + runStart length:cellLength - runStart];
+}
@@ -0,0 +1,128 @@
+//
+//  $Id$
+//
+//  SPMySQLConnectionAdditions.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPMySQLConnectionAdditions.h"
+
+// Session variables which affect how rows are written, and so are matched on clones which write
+static NSString *SPMySQLConnectionMatchedSessionVariables[] = { @"sql_mode", @"time_zone", @"FOREIGN_KEY_CHECKS", @"UNIQUE_CHECKS", @"auto_increment_increment", @"auto_increment_offset" };
+static const NSUInteger SPMySQLConnectionMatchedSessionVariableCount = 6;
+
+@implementation SPMySQLConnection (SPMySQLConnectionAdditions)
+
+/**
+ * Returns an unconnected, autoreleased copy of the connection using the supplied delegate.
+ * Queries on the copy aren't logged to the delegate, as clones run background work the
+ * user didn't ask for directly.
+ */
+- (SPMySQLConnection *)cloneWithDelegate:(id)aDelegate
+{
+	SPMySQLConnection *clone = [[self copy] autorelease];
+
+	[clone setDelegate:aDelegate];
+	[clone setDelegateQueryLogging:NO];
+
+	return clone;
+}
+
+/**
+ * Connect a clone of the supplied connection, matching the parent's local port - in case a
+ * proxy has changed it since the clone was made - and its encoding, so that queries are
+ * sent and results read identically on both.  Returns NO if the parent isn't connected or
+ * the connection fails.  The clone's database isn't selected.
+ */
+- (BOOL)connectAsCloneOfConnection:(SPMySQLConnection *)parentConnection
+{
+	if (!parentConnection || ![parentConnection isConnected]) return NO;
+
+	[self setPort:[parentConnection port]];
+
+	if (![self connect]) return NO;
+
+	[self matchEncodingOfConnection:parentConnection];
+
+	return YES;
+}
+
+/**
+ * Set the encoding and latin1 transport of a connected clone to those of the supplied
+ * connection; the parent's encoding may be changed at any time, so this is also used to
+ * bring clones which are kept connected back in line.  Nothing is sent if they match.
+ */
+- (void)matchEncodingOfConnection:(SPMySQLConnection *)parentConnection
+{
+	NSString *parentEncoding = [parentConnection encoding];
+
+	if (parentEncoding && ![[self encoding] isEqualToString:parentEncoding]) [self setEncoding:parentEncoding];
+	[self setEncodingUsesLatin1Transport:[parentConnection encodingUsesLatin1Transport]];
+}
+
+/**
+ * Returns a SET query giving another connection the current values of this connection's
+ * session variables which affect how rows are written - the SQL mode, time zone, key checks
+ * and auto increment settings - so that clones writing rows behave as this connection
+ * would.  Returns nil if the values can't be read, for example on servers too old to
+ * support them.
+ */
+- (NSString *)sessionVariablesMatchingQuery
+{
+	NSMutableArray *selectParts = [NSMutableArray arrayWithCapacity:SPMySQLConnectionMatchedSessionVariableCount];
+	NSMutableArray *setParts = [NSMutableArray arrayWithCapacity:SPMySQLConnectionMatchedSessionVariableCount];
+	NSUInteger i;
+
+	for (i = 0; i < SPMySQLConnectionMatchedSessionVariableCount; i++) {
+		[selectParts addObject:[NSString stringWithFormat:@"@@SESSION.%@", SPMySQLConnectionMatchedSessionVariables[i]]];
+	}
+
+	SPMySQLResult *variablesResult = [self queryString:[NSString stringWithFormat:@"SELECT %@", [selectParts componentsJoinedByString:@", "]]];
+	if ([self queryErrored]) return nil;
+
+	[variablesResult setReturnDataAsStrings:YES];
+	NSArray *values = [variablesResult getRowAsArray];
+	if ([values count] != SPMySQLConnectionMatchedSessionVariableCount) return nil;
+
+	for (i = 0; i < SPMySQLConnectionMatchedSessionVariableCount; i++) {
+		id value = [values objectAtIndex:i];
+		if ([value isNSNull]) continue;
+
+		// Numeric variables must be set unquoted, as the server rejects strings for them
+		if (![value length] || [value rangeOfCharacterFromSet:[[NSCharacterSet decimalDigitCharacterSet] invertedSet]].location != NSNotFound) {
+			value = [self escapeAndQuoteString:value];
+		}
+		[setParts addObject:[NSString stringWithFormat:@"%@ = %@", SPMySQLConnectionMatchedSessionVariables[i], value]];
+	}
+	if (![setParts count]) return nil;
+
+	return [NSString stringWithFormat:@"SET SESSION %@", [setParts componentsJoinedByString:@", "]];
+}
+
+@end
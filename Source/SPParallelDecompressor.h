@@ -0,0 +1,100 @@
+//
+//  $Id$
+//
+//  SPParallelDecompressor.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import <pthread.h>
+
+/**
+ * @class SPParallelDecompressor SPParallelDecompressor.h
+ *
+ * Decompresses gzip or bzip2 data held in memory, such as a mapped file, on several threads,
+ * returning the decompressed data in order.
+ *
+ * bzip2 data is split into blocks at the bit patterns marking the start of each block and
+ * the end of each stream; each block is decoded on its own as a single-block stream.  gzip
+ * data can only be split where a new member starts, so only multi-member files, such as
+ * those written by bgzip or by concatenating gzip files, are decompressed in parallel; each
+ * member is decoded from its header; a gzip chunk which decompresses to more than a fixed
+ * length, such as one holding a large member, fails rather than being held whole in memory,
+ * so that each waiting chunk stays bounded.  As the patterns can also occur within compressed
+ * data, chunks are decoded speculatively and only used if they start where the previous
+ * chunk was found to end.
+ *
+ * If data which could be decoded in order can't be decoded in chunks, the decompressor
+ * fails without raising an exception, having returned only correctly decoded data; the
+ * remainder can then be read by decompressing the data serially.
+ */
+@interface SPParallelDecompressor : NSObject
+{
+	const unsigned char *compressedBytes;
+	NSUInteger compressedLength;
+	id compressedBytesOwner;
+	SPFileCompressionFormat compressionFormat;
+
+	unsigned long long *candidateOffsets;
+	BOOL *candidateIsBlock;
+	NSUInteger candidateCount;
+	NSUInteger candidateCapacity;
+	NSUInteger scanPosition;
+	unsigned long long scanWindow;
+	NSUInteger chunkedCandidateCount;
+	BOOL scanning;
+	BOOL scanFinished;
+
+	NSMutableArray *chunks;
+	NSUInteger maximumChunkCount;
+	NSUInteger expectedChunkStart;
+	NSUInteger chunkReadPosition;
+	NSUInteger rawDataReadLength;
+	unsigned long long decompressedLengthRead;
+
+	pthread_mutex_t decompressorLock;
+	pthread_cond_t decompressorCondition;
+	NSUInteger workerCount;
+	NSUInteger workersRunning;
+	BOOL workersStarted;
+	BOOL stopRequested;
+	BOOL endOfData;
+	BOOL decompressorFailed;
+}
+
++ (NSUInteger)defaultWorkerCount;
+
+- (id)initWithBytes:(const unsigned char *)theBytes length:(NSUInteger)theLength owner:(id)theOwner compressionFormat:(SPFileCompressionFormat)theCompressionFormat workerCount:(NSUInteger)theWorkerCount;
+
+- (NSUInteger)readBytes:(void *)destination length:(NSUInteger)length;
+- (BOOL)hasFailed;
+- (unsigned long long)decompressedLengthRead;
+- (NSUInteger)rawDataReadLength;
+- (void)stop;
+
+@end
@@ -0,0 +1,756 @@
+//
+//  $Id$
+//
+//  SPParallelDecompressor.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPParallelDecompressor.h"
+#import "SPThreadAdditions.h"
+#import "zlib.1.2.4.h"
+#import "bzlib.h"
+
+// Length of compressed data scanned for chunk boundaries at a time
+static const NSUInteger SPParallelDecompressorScanLength = 4 * 1024 * 1024;
+
+// Compressed length of consecutive gzip members decoded as one chunk
+static const NSUInteger SPParallelDecompressorGzipChunkLength = 1024 * 1024;
+
+// Number of following boundaries a bzip2 block is extended over if the boundary ending it
+// turns out to be a false match within the block
+static const NSUInteger SPParallelDecompressorMaximumBlockMerges = 4;
+
+// Length by which decompressed output buffers are grown
+static const NSUInteger SPParallelDecompressorOutputIncrement = 1024 * 1024;
+
+// Decompressed length at which a gzip chunk is abandoned, so that a large member - which
+// can't be split - is left to the serial decompressor rather than inflated whole in memory
+static const NSUInteger SPParallelDecompressorMaximumGzipChunkOutputLength = 32 * 1024 * 1024;
+
+// bzip2 block and end of stream markers, which aren't byte aligned
+#define SPBzip2BlockMagic 0x314159265359ULL
+#define SPBzip2EndOfStreamMagic 0x177245385090ULL
+#define SPBzip2MagicMask 0xFFFFFFFFFFFFULL
+
+// Nominal end of a bzip2 chunk whose end hasn't been found
+#define SPParallelDecompressorUnknownEnd ULLONG_MAX
+
+/**
+ * A run of compressed data decoded by one worker: one or more gzip members, or one bzip2
+ * block.  Offsets are in bytes for gzip and in bits for bzip2, so are held as 64-bit values
+ * which can address every bit of the data on 32-bit builds.
+ */
+@interface SPParallelDecompressorChunk : NSObject
+{
+@public
+	NSUInteger startCandidate;
+	NSUInteger endCandidate;
+	unsigned long long start;
+	unsigned long long nominalEnd;
+	unsigned long long end;
+	NSMutableData *output;
+	BOOL claimed;
+	BOOL decoded;
+	BOOL failed;
+	BOOL accepted;
+	BOOL reachedEndOfData;
+}
+@end
+
+@implementation SPParallelDecompressorChunk
+
+- (void)dealloc
+{
+	[output release];
+
+	[super dealloc];
+}
+
+@end
+
+static BOOL _SPIsPlausibleGzipHeader(const unsigned char *header, NSUInteger availableLength);
+static NSUInteger _SPScanForChunkBoundaries(const unsigned char *bytes, NSUInteger length, SPFileCompressionFormat format, NSUInteger *position, unsigned long long *window, unsigned long long **offsets, BOOL **isBlock);
+static NSMutableData *_SPInflateGzipMembers(const unsigned char *bytes, NSUInteger length, NSUInteger start, NSUInteger nominalEnd, NSUInteger *end, BOOL *reachedEndOfData);
+static NSMutableData *_SPDecompressBzip2Block(const unsigned char *bytes, NSUInteger length, unsigned long long startBit, unsigned long long endBit);
+
+@interface SPParallelDecompressor (Private_API)
+
+- (void)_appendCandidates:(unsigned long long *)offsets isBlock:(BOOL *)isBlock count:(NSUInteger)count;
+- (void)_createChunks;
+- (void)_runWorker;
+- (BOOL)_acceptChunk:(SPParallelDecompressorChunk *)chunk;
+
+@end
+
+@implementation SPParallelDecompressor
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+/**
+ * Returns the number of threads to decompress on, or 1 if there is no benefit.
+ */
++ (NSUInteger)defaultWorkerCount
+{
+	return MAX(1, MIN(8, [[NSProcessInfo processInfo] activeProcessorCount]));
+}
+
+/**
+ * Initialise a decompressor for the supplied gzip or bzip2 data, retaining the owner of the
+ * bytes for as long as they are used.  Returns nil if the data can't usefully be decompressed
+ * in parallel: if fewer than two workers are requested, or if the start of the data doesn't
+ * contain several chunks, as for ordinary single-member gzip files.
+ */
+- (id)initWithBytes:(const unsigned char *)theBytes length:(NSUInteger)theLength owner:(id)theOwner compressionFormat:(SPFileCompressionFormat)theCompressionFormat workerCount:(NSUInteger)theWorkerCount
+{
+	unsigned long long *offsets = NULL;
+	BOOL *isBlock = NULL;
+	NSUInteger count, i, blockCount = 0;
+
+	if ((self = [super init])) {
+		compressedBytes = theBytes;
+		compressedLength = theLength;
+		compressedBytesOwner = [theOwner retain];
+		compressionFormat = theCompressionFormat;
+
+		candidateOffsets = NULL;
+		candidateIsBlock = NULL;
+		candidateCount = 0;
+		candidateCapacity = 0;
+		scanPosition = 0;
+		scanWindow = 0;
+		chunkedCandidateCount = 0;
+		scanning = NO;
+		scanFinished = NO;
+
+		workerCount = theWorkerCount;
+		chunks = [[NSMutableArray alloc] init];
+		maximumChunkCount = workerCount * 2;
+		expectedChunkStart = 0;
+		chunkReadPosition = 0;
+		rawDataReadLength = 0;
+		decompressedLengthRead = 0;
+
+		pthread_mutex_init(&decompressorLock, NULL);
+		pthread_cond_init(&decompressorCondition, NULL);
+		workersRunning = 0;
+		workersStarted = NO;
+		stopRequested = NO;
+		endOfData = NO;
+		decompressorFailed = NO;
+
+		if (workerCount < 2 || (compressionFormat != SPGzipCompression && compressionFormat != SPBzip2Compression)) {
+			[self release];
+			return nil;
+		}
+
+		// Scan the start of the data, to check that it splits into chunks
+		count = _SPScanForChunkBoundaries(compressedBytes, compressedLength, compressionFormat, &scanPosition, &scanWindow, &offsets, &isBlock);
+		[self _appendCandidates:offsets isBlock:isBlock count:count];
+		free(offsets);
+		free(isBlock);
+		for (i = 0; i < candidateCount; i++) {
+			if (candidateIsBlock[i]) blockCount++;
+		}
+		if (blockCount < 2 || (compressionFormat == SPGzipCompression && candidateOffsets[0] != 0)) {
+			[self release];
+			return nil;
+		}
+	}
+
+	return self;
+}
+
+/**
+ * Stop decompressing, waiting for the workers to finish with the data.
+ */
+- (void)stop
+{
+	pthread_mutex_lock(&decompressorLock);
+	stopRequested = YES;
+	pthread_cond_broadcast(&decompressorCondition);
+	while (workersRunning) {
+		pthread_cond_wait(&decompressorCondition, &decompressorLock);
+	}
+	pthread_mutex_unlock(&decompressorLock);
+}
+
+- (void)dealloc
+{
+	[chunks release];
+	[compressedBytesOwner release];
+	if (candidateOffsets) free(candidateOffsets);
+	if (candidateIsBlock) free(candidateIsBlock);
+
+	pthread_mutex_destroy(&decompressorLock);
+	pthread_cond_destroy(&decompressorCondition);
+
+	[super dealloc];
+}
+
+#pragma mark -
+#pragma mark Reading
+
+/**
+ * Copy up to the supplied number of decompressed bytes into the destination, waiting for
+ * them to be decompressed if necessary, and return the number of bytes copied.  Fewer bytes
+ * are only returned at the end of the data, or if the decompressor has failed.
+ */
+- (NSUInteger)readBytes:(void *)destination length:(NSUInteger)length
+{
+	NSUInteger bytesCopied = 0;
+	NSUInteger copyLength, i;
+	SPParallelDecompressorChunk *chunk;
+
+	pthread_mutex_lock(&decompressorLock);
+
+	if (!workersStarted) {
+		workersStarted = YES;
+		workersRunning = workerCount;
+		for (i = 0; i < workerCount; i++) {
+			[NSThread detachNewThreadWithName:@"SPParallelDecompressor worker" target:self selector:@selector(_runWorker) object:nil];
+		}
+	}
+
+	while (bytesCopied < length && !decompressorFailed && !endOfData && !stopRequested) {
+		chunk = [chunks count] ? [chunks objectAtIndex:0] : nil;
+
+		// Once all chunks have been read, the end of the data has been reached
+		if (!chunk && scanFinished && !scanning && chunkedCandidateCount == candidateCount) {
+			endOfData = YES;
+			break;
+		}
+		if (!chunk || !chunk->decoded) {
+			pthread_cond_wait(&decompressorCondition, &decompressorLock);
+			continue;
+		}
+
+		// Check the chunk continues from the end of the last chunk before using it, skipping
+		// chunks started at false boundaries
+		if (!chunk->accepted) {
+			if ((compressionFormat == SPGzipCompression && chunk->start < expectedChunkStart)
+				|| (compressionFormat == SPBzip2Compression && chunk->startCandidate < expectedChunkStart))
+			{
+				[chunks removeObjectAtIndex:0];
+				pthread_cond_broadcast(&decompressorCondition);
+				continue;
+			}
+			if (![self _acceptChunk:chunk]) {
+				decompressorFailed = YES;
+				break;
+			}
+		}
+
+		// Decoded chunks aren't touched by the workers, so can be copied from unlocked
+		copyLength = MIN(length - bytesCopied, [chunk->output length] - chunkReadPosition);
+		pthread_mutex_unlock(&decompressorLock);
+		memcpy((unsigned char *)destination + bytesCopied, (const unsigned char *)[chunk->output bytes] + chunkReadPosition, copyLength);
+		pthread_mutex_lock(&decompressorLock);
+
+		bytesCopied += copyLength;
+		chunkReadPosition += copyLength;
+
+		// Once a chunk has been read, free its place for another to be decoded
+		if (chunkReadPosition == [chunk->output length]) {
+			rawDataReadLength = (NSUInteger)((compressionFormat == SPGzipCompression) ? chunk->end : (chunk->end + 7) / 8);
+			if (chunk->reachedEndOfData) endOfData = YES;
+			chunkReadPosition = 0;
+			[chunks removeObjectAtIndex:0];
+			pthread_cond_broadcast(&decompressorCondition);
+		}
+	}
+
+	decompressedLengthRead += bytesCopied;
+
+	pthread_mutex_unlock(&decompressorLock);
+
+	return bytesCopied;
+}
+
+/**
+ * Returns whether the data couldn't be decompressed in chunks, in which case no more data
+ * will be returned and the remainder should be decompressed serially.
+ */
+- (BOOL)hasFailed
+{
+	pthread_mutex_lock(&decompressorLock);
+	BOOL hasFailed = decompressorFailed;
+	pthread_mutex_unlock(&decompressorLock);
+
+	return hasFailed;
+}
+
+/**
+ * Returns the length of decompressed data returned so far.
+ */
+- (unsigned long long)decompressedLengthRead
+{
+	pthread_mutex_lock(&decompressorLock);
+	unsigned long long theDecompressedLengthRead = decompressedLengthRead;
+	pthread_mutex_unlock(&decompressorLock);
+
+	return theDecompressedLengthRead;
+}
+
+/**
+ * Returns the length of compressed data decompressed into the chunks read so far.
+ */
+- (NSUInteger)rawDataReadLength
+{
+	pthread_mutex_lock(&decompressorLock);
+	NSUInteger theRawDataReadLength = rawDataReadLength;
+	pthread_mutex_unlock(&decompressorLock);
+
+	return theRawDataReadLength;
+}
+
+@end
+
+@implementation SPParallelDecompressor (Private_API)
+
+/**
+ * Add chunk boundary candidates found by a scan to the list of candidates.  Must be called
+ * with the lock held, other than during initialisation.
+ */
+- (void)_appendCandidates:(unsigned long long *)offsets isBlock:(BOOL *)isBlock count:(NSUInteger)count
+{
+	if (candidateCount + count > candidateCapacity) {
+		candidateCapacity = MAX(candidateCapacity * 2, candidateCount + count + 64);
+		candidateOffsets = realloc(candidateOffsets, candidateCapacity * sizeof(unsigned long long));
+		candidateIsBlock = realloc(candidateIsBlock, candidateCapacity * sizeof(BOOL));
+	}
+	if (count) {
+		memcpy(candidateOffsets + candidateCount, offsets, count * sizeof(unsigned long long));
+		memcpy(candidateIsBlock + candidateCount, isBlock, count * sizeof(BOOL));
+		candidateCount += count;
+	}
+	if (scanPosition >= compressedLength) scanFinished = YES;
+}
+
+/**
+ * Create chunks to decode from the candidates found so far, up to the maximum number of chunks
+ * waiting to be read.  gzip chunks group members up to a compressed length; bzip2 chunks run
+ * from a block to the next boundary.  Must be called with the lock held.
+ */
+- (void)_createChunks
+{
+	SPParallelDecompressorChunk *chunk;
+	NSUInteger endCandidate;
+
+	while ([chunks count] < maximumChunkCount && chunkedCandidateCount < candidateCount) {
+		if (!candidateIsBlock[chunkedCandidateCount]) {
+			chunkedCandidateCount++;
+			continue;
+		}
+
+		if (compressionFormat == SPGzipCompression) {
+			for (endCandidate = chunkedCandidateCount + 1; endCandidate < candidateCount; endCandidate++) {
+				if (candidateOffsets[endCandidate] >= candidateOffsets[chunkedCandidateCount] + SPParallelDecompressorGzipChunkLength) break;
+			}
+		} else {
+			endCandidate = chunkedCandidateCount + 1;
+		}
+
+		// Wait for the scan to find the end of the chunk, unless it has reached the end of the data
+		if (endCandidate >= candidateCount && !scanFinished) break;
+
+		chunk = [[SPParallelDecompressorChunk alloc] init];
+		chunk->startCandidate = chunkedCandidateCount;
+		chunk->endCandidate = endCandidate;
+		chunk->start = candidateOffsets[chunkedCandidateCount];
+		if (endCandidate < candidateCount) {
+			chunk->nominalEnd = candidateOffsets[endCandidate];
+		} else {
+			chunk->nominalEnd = (compressionFormat == SPGzipCompression) ? compressedLength : SPParallelDecompressorUnknownEnd;
+		}
+		[chunks addObject:chunk];
+		[chunk release];
+
+		chunkedCandidateCount = (compressionFormat == SPGzipCompression) ? endCandidate : chunkedCandidateCount + 1;
+	}
+}
+
+/**
+ * Decode chunks until all have been decoded or the decompressor is stopped, scanning for
+ * further chunk boundaries when no chunks are waiting.  Should always be executed on a
+ * background thread.
+ */
+- (void)_runWorker
+{
+	NSAutoreleasePool *workerPool = [[NSAutoreleasePool alloc] init];
+	SPParallelDecompressorChunk *chunk;
+	unsigned long long *offsets;
+	BOOL *isBlock;
+	NSUInteger count, i, gzipEnd;
+
+	pthread_mutex_lock(&decompressorLock);
+	while (!stopRequested) {
+		[self _createChunks];
+
+		chunk = nil;
+		for (i = 0; i < [chunks count]; i++) {
+			if (!((SPParallelDecompressorChunk *)[chunks objectAtIndex:i])->claimed) {
+				chunk = [chunks objectAtIndex:i];
+				break;
+			}
+		}
+
+		// Decode the first waiting chunk
+		if (chunk) {
+			chunk->claimed = YES;
+			[chunk retain];
+			pthread_mutex_unlock(&decompressorLock);
+
+			NSAutoreleasePool *chunkPool = [[NSAutoreleasePool alloc] init];
+			if (compressionFormat == SPGzipCompression) {
+				chunk->output = [_SPInflateGzipMembers(compressedBytes, compressedLength, (NSUInteger)chunk->start, (NSUInteger)chunk->nominalEnd, &gzipEnd, &(chunk->reachedEndOfData)) retain];
+				chunk->end = gzipEnd;
+			} else {
+				chunk->end = chunk->nominalEnd;
+				if (chunk->nominalEnd != SPParallelDecompressorUnknownEnd) {
+					chunk->output = [_SPDecompressBzip2Block(compressedBytes, compressedLength, chunk->start, chunk->nominalEnd) retain];
+				}
+			}
+			[chunkPool drain];
+
+			pthread_mutex_lock(&decompressorLock);
+			chunk->failed = !chunk->output;
+			chunk->decoded = YES;
+			[chunk release];
+			pthread_cond_broadcast(&decompressorCondition);
+			continue;
+		}
+
+		// If there is room for more chunks, scan for their boundaries
+		if (!scanFinished && !scanning && [chunks count] < maximumChunkCount) {
+			scanning = YES;
+			pthread_mutex_unlock(&decompressorLock);
+			offsets = NULL;
+			isBlock = NULL;
+			count = _SPScanForChunkBoundaries(compressedBytes, compressedLength, compressionFormat, &scanPosition, &scanWindow, &offsets, &isBlock);
+			pthread_mutex_lock(&decompressorLock);
+			[self _appendCandidates:offsets isBlock:isBlock count:count];
+			free(offsets);
+			free(isBlock);
+			scanning = NO;
+			pthread_cond_broadcast(&decompressorCondition);
+			continue;
+		}
+
+		// Once the whole of the data has been divided into chunks, there's nothing left to do
+		if (scanFinished && !scanning && chunkedCandidateCount == candidateCount) break;
+
+		pthread_cond_wait(&decompressorCondition, &decompressorLock);
+	}
+	workersRunning--;
+	pthread_cond_broadcast(&decompressorCondition);
+	pthread_mutex_unlock(&decompressorLock);
+
+	[workerPool drain];
+}
+
+/**
+ * Check that a decoded chunk at the expected position can be used, and note where the next
+ * chunk should start.  A gzip chunk must start exactly where the last ended; a bzip2 block
+ * which couldn't be decoded is retried over the following boundaries, in case a boundary
+ * was found within it.  Returns NO if the chunk can't be used.  Must be called with the
+ * lock held, which may be released while retrying.
+ */
+- (BOOL)_acceptChunk:(SPParallelDecompressorChunk *)chunk
+{
+	NSUInteger merges, endCandidate;
+	unsigned long long endBit;
+	NSMutableData *mergedOutput;
+
+	if (compressionFormat == SPGzipCompression) {
+		if (chunk->start != expectedChunkStart || chunk->failed) return NO;
+		chunk->accepted = YES;
+		expectedChunkStart = (NSUInteger)chunk->end;
+		return YES;
+	}
+
+	for (merges = 1; chunk->failed && merges <= SPParallelDecompressorMaximumBlockMerges; merges++) {
+		endCandidate = chunk->startCandidate + 1 + merges;
+		if (endCandidate >= candidateCount) break;
+		endBit = candidateOffsets[endCandidate];
+
+		pthread_mutex_unlock(&decompressorLock);
+		mergedOutput = [_SPDecompressBzip2Block(compressedBytes, compressedLength, chunk->start, endBit) retain];
+		pthread_mutex_lock(&decompressorLock);
+
+		if (mergedOutput) {
+			chunk->output = mergedOutput;
+			chunk->endCandidate = endCandidate;
+			chunk->end = endBit;
+			chunk->failed = NO;
+		}
+	}
+	if (chunk->failed) return NO;
+
+	chunk->accepted = YES;
+	expectedChunkStart = chunk->endCandidate;
+	return YES;
+}
+
+@end
+
+#pragma mark -
+#pragma mark Decoding functions
+
+/**
+ * Returns whether the supplied bytes look like the start of a gzip member, with the deflate
+ * method, no reserved flags, and common extra flag and operating system values.
+ */
+static BOOL _SPIsPlausibleGzipHeader(const unsigned char *header, NSUInteger availableLength)
+{
+	if (availableLength < 20) return NO;
+
+	return (header[0] == 0x1f && header[1] == 0x8b && header[2] == 0x08 && !(header[3] & 0xE0)
+			&& (header[8] == 0 || header[8] == 2 || header[8] == 4)
+			&& (header[9] <= 13 || header[9] == 255));
+}
+
+/**
+ * Scan the next window of compressed data for possible chunk boundaries, advancing the scan
+ * position, and return the number found; the offsets, and whether each starts a chunk rather
+ * than only ending one, are returned in arrays which the caller must free.  gzip boundaries
+ * are byte offsets of member headers; bzip2 boundaries are bit offsets of block and end of
+ * stream markers, found using a window of the last 64 bits read.
+ */
+static NSUInteger _SPScanForChunkBoundaries(const unsigned char *bytes, NSUInteger length, SPFileCompressionFormat format, NSUInteger *position, unsigned long long *window, unsigned long long **offsets, BOOL **isBlock)
+{
+	NSUInteger windowEnd = MIN(length, *position + SPParallelDecompressorScanLength);
+	NSUInteger count = 0, capacity = 64;
+	NSUInteger i, shift;
+	unsigned long long bits = *window, pattern, bitOffset;
+	const unsigned char *match;
+
+	*offsets = malloc(capacity * sizeof(unsigned long long));
+	*isBlock = malloc(capacity * sizeof(BOOL));
+
+	if (format == SPGzipCompression) {
+		i = *position;
+		while (i < windowEnd && (match = memchr(bytes + i, 0x1f, windowEnd - i))) {
+			i = match - bytes;
+			if (_SPIsPlausibleGzipHeader(match, length - i)) {
+				if (count == capacity) {
+					capacity *= 2;
+					*offsets = realloc(*offsets, capacity * sizeof(unsigned long long));
+					*isBlock = realloc(*isBlock, capacity * sizeof(BOOL));
+				}
+				(*offsets)[count] = i;
+				(*isBlock)[count] = YES;
+				count++;
+			}
+			i++;
+		}
+	} else {
+		for (i = *position; i < windowEnd; i++) {
+			bits = (bits << 8) | bytes[i];
+			if (i < 6) continue;
+
+			// Check for a marker ending at each bit of this byte, earliest first
+			for (shift = 8; shift-- > 0; ) {
+				pattern = (bits >> shift) & SPBzip2MagicMask;
+				if (pattern != SPBzip2BlockMagic && pattern != SPBzip2EndOfStreamMagic) continue;
+				bitOffset = ((unsigned long long)i + 1) * 8 - shift - 48;
+				if (count == capacity) {
+					capacity *= 2;
+					*offsets = realloc(*offsets, capacity * sizeof(unsigned long long));
+					*isBlock = realloc(*isBlock, capacity * sizeof(BOOL));
+				}
+				(*offsets)[count] = bitOffset;
+				(*isBlock)[count] = (pattern == SPBzip2BlockMagic);
+				count++;
+			}
+		}
+		*window = bits;
+	}
+
+	*position = windowEnd;
+
+	return count;
+}
+
+/**
+ * Decode consecutive gzip members from the supplied start offset until reaching or passing
+ * the nominal end, returning the decompressed data and the offset after the last member, or
+ * nil if the data couldn't be decoded or decompresses to more than the chunk output limit.
+ * If the data following a member isn't another member, it is treated as the end of the
+ * data, as by gzread().
+ */
+static NSMutableData *_SPInflateGzipMembers(const unsigned char *bytes, NSUInteger length, NSUInteger start, NSUInteger nominalEnd, NSUInteger *end, BOOL *reachedEndOfData)
+{
+	NSMutableData *output = [NSMutableData dataWithLength:SPParallelDecompressorOutputIncrement];
+	NSUInteger outputLength = 0, position;
+	uInt availableOutput;
+	z_stream stream;
+	int result;
+
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit2(&stream, 15 + 16) != Z_OK) return nil;
+	stream.next_in = (Bytef *)(bytes + start);
+	stream.avail_in = 0;
+
+	while (1) {
+
+		// Supply the data in lengths zlib can address, and grow the output as required
+		if (!stream.avail_in) {
+			position = (NSUInteger)(stream.next_in - bytes);
+			if (position >= length) break;
+			stream.avail_in = (uInt)MIN(length - position, (NSUInteger)UINT_MAX);
+		}
+		if (outputLength == [output length]) {
+			if (outputLength >= SPParallelDecompressorMaximumGzipChunkOutputLength) break;
+			[output setLength:outputLength + SPParallelDecompressorOutputIncrement];
+		}
+		availableOutput = (uInt)MIN([output length] - outputLength, (NSUInteger)UINT_MAX);
+		stream.next_out = (Bytef *)[output mutableBytes] + outputLength;
+		stream.avail_out = availableOutput;
+
+		result = inflate(&stream, Z_NO_FLUSH);
+		outputLength += availableOutput - stream.avail_out;
+
+		if (result == Z_STREAM_END) {
+			position = (NSUInteger)(stream.next_in - bytes);
+
+			// Continue with a following member within the chunk
+			if (position < nominalEnd && _SPIsPlausibleGzipHeader(bytes + position, length - position)) {
+				inflateReset(&stream);
+				continue;
+			}
+
+			*end = position;
+			*reachedEndOfData = (position >= length || !_SPIsPlausibleGzipHeader(bytes + position, length - position));
+			inflateEnd(&stream);
+			[output setLength:outputLength];
+			return output;
+		}
+		if (result != Z_OK && result != Z_BUF_ERROR) break;
+	}
+
+	// The data was invalid, ended within a member, or was too large to hold
+	inflateEnd(&stream);
+	return nil;
+}
+
+/**
+ * Read up to 64 bits, most significant first, from the supplied bit offset.
+ */
+static unsigned long long _SPReadBits(const unsigned char *bytes, unsigned long long bitOffset, NSUInteger bitCount)
+{
+	unsigned long long value = 0;
+	NSUInteger i;
+
+	for (i = 0; i < bitCount; i++, bitOffset++) {
+		value = (value << 1) | ((bytes[(NSUInteger)(bitOffset >> 3)] >> (7 - (bitOffset & 7))) & 1);
+	}
+
+	return value;
+}
+
+/**
+ * Write up to 64 bits, most significant first, at the supplied bit offset of a zeroed buffer.
+ */
+static void _SPWriteBits(unsigned char *bytes, NSUInteger *bitOffset, unsigned long long value, NSUInteger bitCount)
+{
+	while (bitCount--) {
+		if ((value >> bitCount) & 1) bytes[*bitOffset >> 3] |= (unsigned char)(0x80 >> (*bitOffset & 7));
+		(*bitOffset)++;
+	}
+}
+
+/**
+ * Decode the bzip2 block between the supplied bit offsets, starting at its block marker, by
+ * wrapping it in a single-block stream: a stream header, the block, and an end of stream
+ * marker with a stream CRC equal to the block's CRC.  Returns the decompressed data, or nil
+ * if the block couldn't be decoded or failed its CRC check.
+ */
+static NSMutableData *_SPDecompressBzip2Block(const unsigned char *bytes, NSUInteger length, unsigned long long startBit, unsigned long long endBit)
+{
+	NSMutableData *output;
+	unsigned long long bitLength;
+	NSUInteger streamLength, bitOffset, byteOffset, shift, i;
+	NSUInteger outputLength = 0;
+	unsigned int availableOutput;
+	unsigned char *streamBytes;
+	bz_stream stream;
+	int result;
+
+	if (endBit <= startBit + 80 || endBit > (unsigned long long)length * 8) return nil;
+
+	bitLength = endBit - startBit;
+	streamLength = 4 + (NSUInteger)(bitLength / 8) + 12;
+	streamBytes = calloc(streamLength, 1);
+	memcpy(streamBytes, "BZh9", 4);
+
+	// Copy the whole bytes of the block shifted into alignment, then the remaining bits
+	byteOffset = (NSUInteger)(startBit >> 3);
+	shift = (NSUInteger)(startBit & 7);
+	for (i = 0; i < bitLength / 8; i++) {
+		streamBytes[4 + i] = shift ? (unsigned char)((bytes[byteOffset + i] << shift) | (bytes[byteOffset + i + 1] >> (8 - shift))) : bytes[byteOffset + i];
+	}
+	bitOffset = 32 + (NSUInteger)(bitLength / 8) * 8;
+	_SPWriteBits(streamBytes, &bitOffset, _SPReadBits(bytes, startBit + (bitLength / 8) * 8, (NSUInteger)(bitLength % 8)), (NSUInteger)(bitLength % 8));
+	_SPWriteBits(streamBytes, &bitOffset, SPBzip2EndOfStreamMagic, 48);
+	_SPWriteBits(streamBytes, &bitOffset, _SPReadBits(bytes, startBit + 48, 32), 32);
+
+	memset(&stream, 0, sizeof(stream));
+	if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) {
+		free(streamBytes);
+		return nil;
+	}
+	stream.next_in = (char *)streamBytes;
+	stream.avail_in = (unsigned int)((bitOffset + 7) / 8);
+
+	output = [NSMutableData dataWithLength:SPParallelDecompressorOutputIncrement];
+	while (1) {
+		if (outputLength == [output length]) [output setLength:outputLength + SPParallelDecompressorOutputIncrement];
+		availableOutput = (unsigned int)MIN([output length] - outputLength, (NSUInteger)UINT_MAX);
+		stream.next_out = (char *)[output mutableBytes] + outputLength;
+		stream.avail_out = availableOutput;
+
+		result = BZ2_bzDecompress(&stream);
+		outputLength += availableOutput - stream.avail_out;
+
+		if (result == BZ_STREAM_END) break;
+
+		// Errors, and running out of input before the end of the stream, mean the block is invalid
+		if (result != BZ_OK || (!stream.avail_in && stream.avail_out)) {
+			output = nil;
+			break;
+		}
+	}
+
+	BZ2_bzDecompressEnd(&stream);
+	free(streamBytes);
+	[output setLength:outputLength];
+
+	return output;
+}
@@ -0,0 +1,127 @@
+//
+//  $Id$
+//
+//  SPSQLDumpReplayer.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+@class SPMySQLConnection, SPImportQueryPipeline;
+
+// Statement types, as classified from the leading keywords of each statement
+typedef enum {
+	SPSQLDumpEmptyStatement = 0,
+	SPSQLDumpSessionStatement = 1,
+	SPSQLDumpTransactionStartStatement = 2,
+	SPSQLDumpTableStatement = 3,
+	SPSQLDumpCurrentTableStatement = 4,
+	SPSQLDumpDeferredStatement = 5,
+	SPSQLDumpBarrierStatement = 6
+} SPSQLDumpStatementType;
+
+/**
+ * @class SPSQLDumpReplayer SPSQLDumpReplayer.h
+ *
+ * Replays the statements of a SQL dump file, as split from the file, in file order on
+ * a connection - or, where the dump allows it, runs the statements for different tables
+ * concurrently on a pipeline of cloned connections.
+ *
+ * Each statement is classified from its leading keywords.  Statements for a single table
+ * (DROP TABLE, CREATE TABLE, INSERT, REPLACE, LOCK TABLES, ALTER TABLE, TRUNCATE) are
+ * assigned to a lane per table, so each table's section of the dump runs in order on one
+ * connection while other tables' sections run on others.  Views, routines, triggers and
+ * events are held back to be run in a final serial phase once the tables are loaded.  Any
+ * statement which can't be assigned - such as USE or CREATE DATABASE - is a barrier: the
+ * tables queued so far are finished, and the statement is run on the connection.
+ *
+ * SET statements are always run on the connection, so that its session ends up as it would
+ * after a serial replay; those before the first table statement are also run on each of
+ * the pipeline's connections as they connect.  Later SET statements are additionally sent
+ * with the statement they belong to: SET statements which restore a user variable go with
+ * the preceding statement, and others with the following statement.
+ *
+ * Tables are only replayed concurrently once the dump has disabled FOREIGN_KEY_CHECKS, as
+ * dumps written by mysqldump and Sequel Pro do, and has not changed autocommit in its
+ * session header; otherwise all statements are run in file order on the connection.
+ *
+ * The replay state can be captured between statements, once the statements queued so far
+ * have run, and restored to continue an interrupted replay part way through a file.
+ */
+@interface SPSQLDumpReplayer : NSObject
+{
+	id delegate;
+	SPMySQLConnection *connection;
+	NSStringEncoding queryEncoding;
+
+	BOOL replaysTablesInParallel;
+	NSUInteger workerCount;
+	SPImportQueryPipeline *pipeline;
+	BOOL pipelineUnavailable;
+	NSUInteger pipelineErrorsCollected;
+
+	NSMutableArray *sessionQueries;
+	NSMutableArray *pendingSessionStatements;
+	NSMutableArray *deferredStatements;
+	NSMutableDictionary *tableLanes;
+	NSUInteger nextLane;
+	NSUInteger currentTableLane;
+	NSUInteger lastDestination;
+
+	BOOL foreignKeyChecksDisabled;
+	BOOL sessionChangesAutocommit;
+	BOOL transactionOpen;
+	BOOL replayCancelled;
+
+	NSMutableArray *queryErrors;
+	NSString *errorMessage;
+}
+
+// Setup
+- (id)initWithConnection:(SPMySQLConnection *)aConnection delegate:(id)theDelegate queryEncoding:(NSStringEncoding)theEncoding;
+- (void)setReplaysTablesInParallel:(BOOL)replayInParallel workerCount:(NSUInteger)theWorkerCount;
+- (void)addSessionQuery:(NSString *)query;
+
+// Statement classification
++ (SPSQLDumpStatementType)typeOfStatement:(NSString *)statement tableName:(NSString **)tableName;
+
+// Replaying statements
+- (BOOL)addStatement:(NSString *)statement queryNumber:(NSUInteger)queryNumber;
+- (void)finish;
+- (void)cancel;
+
+// Checkpoints
+- (NSDictionary *)checkpointState;
+- (void)restoreCheckpointState:(NSDictionary *)state;
+
+// State
+- (BOOL)isReplayingTablesInParallel;
+- (NSArray *)queryErrors;
+- (NSString *)errorMessage;
+
+@end
@@ -0,0 +1,812 @@
+//
+//  $Id$
+//
+//  SPSQLDumpReplayer.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPSQLDumpReplayer.h"
+#import "SPImportQueryPipeline.h"
+#import "SPMySQLConnectionAdditions.h"
+#import "RegexKitLite.h"
+
+// Statement destinations other than pipeline lanes
+#define SPSQLDumpConnectionDestination NSNotFound
+#define SPSQLDumpDeferredDestination (NSNotFound - 1)
+
+// Number of characters at the start of each statement examined to classify it
+#define SPSQLDumpClassifiedLength 2048
+
+// Length of queued statements within which the file reader may get ahead of busy tables
+static const NSUInteger SPSQLDumpMaximumQueuedLength = 32 * 1024 * 1024;
+
+// Keys for the replay state captured for checkpoints
+static NSString *SPSQLDumpCheckpointDatabaseKey = @"Database";
+static NSString *SPSQLDumpCheckpointSessionQueriesKey = @"SessionQueries";
+static NSString *SPSQLDumpCheckpointPendingStatementsKey = @"PendingStatements";
+static NSString *SPSQLDumpCheckpointDeferredStatementsKey = @"DeferredStatements";
+static NSString *SPSQLDumpCheckpointForeignKeyChecksDisabledKey = @"ForeignKeyChecksDisabled";
+static NSString *SPSQLDumpCheckpointSessionChangesAutocommitKey = @"SessionChangesAutocommit";
+
+#define SPSQLDumpIsWhitespace(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r' || (c) == '\v' || (c) == '\f')
+#define SPSQLDumpIsWordCharacter(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || ((c) >= '0' && (c) <= '9') || (c) == '_')
+#define SPSQLDumpIsIdentifierCharacter(c) (SPSQLDumpIsWordCharacter(c) || (c) == '$' || (c) > 0x7F)
+
+/**
+ * The start of a statement being classified, and the position reached.
+ */
+typedef struct {
+	unichar *characters;
+	NSUInteger length;
+	NSUInteger position;
+} SPSQLDumpScanner;
+
+static NSSet *SPSQLDumpInsertModifiers = nil;
+static NSSet *SPSQLDumpTableModifiers = nil;
+static NSSet *SPSQLDumpExistenceWords = nil;
+static NSSet *SPSQLDumpTableCopyWords = nil;
+static NSSet *SPSQLDumpValuesWords = nil;
+static NSSet *SPSQLDumpTableWords = nil;
+static NSSet *SPSQLDumpDeferredObjectWords = nil;
+
+static SPSQLDumpStatementType _SPSQLDumpStatementType(NSString *statement, NSString **tableName);
+
+@interface SPSQLDumpReplayer (Private_API)
+
+- (NSString *)_currentDatabase;
+- (BOOL)_startPipeline;
+- (void)_finishPipeline;
+- (void)_collectPipelineErrors;
+- (BOOL)_sendStatement:(NSString *)statement queryNumber:(NSUInteger)queryNumber toDestination:(NSUInteger)destination;
+- (void)_runStatement:(NSString *)statement queryNumber:(NSUInteger)queryNumber recordingErrors:(BOOL)recordErrors;
+- (void)_updateSessionStateForStatement:(NSString *)statement;
+
+@end
+
+@implementation SPSQLDumpReplayer
+
++ (void)initialize
+{
+	if (self != [SPSQLDumpReplayer class]) return;
+
+	SPSQLDumpInsertModifiers = [[NSSet alloc] initWithObjects:@"LOW_PRIORITY", @"DELAYED", @"HIGH_PRIORITY", @"IGNORE", @"INTO", nil];
+	SPSQLDumpTableModifiers = [[NSSet alloc] initWithObjects:@"TEMPORARY", @"IGNORE", @"ONLINE", @"OFFLINE", nil];
+	SPSQLDumpExistenceWords = [[NSSet alloc] initWithObjects:@"IF", @"NOT", @"EXISTS", nil];
+	SPSQLDumpTableCopyWords = [[NSSet alloc] initWithObjects:@"LIKE", @"AS", @"SELECT", nil];
+	SPSQLDumpValuesWords = [[NSSet alloc] initWithObjects:@"VALUES", @"VALUE", @"SET", nil];
+	SPSQLDumpTableWords = [[NSSet alloc] initWithObjects:@"TABLE", @"TABLES", nil];
+	SPSQLDumpDeferredObjectWords = [[NSSet alloc] initWithObjects:@"VIEW", @"PROCEDURE", @"FUNCTION", @"TRIGGER", @"EVENT", @"ALGORITHM", @"DEFINER", @"SQL", @"OR", @"AGGREGATE", nil];
+}
+
+#pragma mark -
+#pragma mark Setup
+
+/**
+ * Initialise the replayer to run statements on the supplied connection, sending them in
+ * the supplied encoding; the delegate supplies connection details for pipeline connections.
+ */
+- (id)initWithConnection:(SPMySQLConnection *)aConnection delegate:(id)theDelegate queryEncoding:(NSStringEncoding)theEncoding
+{
+	if ((self = [super init])) {
+		delegate = theDelegate;
+		connection = [aConnection retain];
+		queryEncoding = theEncoding;
+
+		replaysTablesInParallel = NO;
+		workerCount = 1;
+		pipeline = nil;
+		pipelineUnavailable = NO;
+		pipelineErrorsCollected = 0;
+
+		sessionQueries = [[NSMutableArray alloc] init];
+		pendingSessionStatements = [[NSMutableArray alloc] init];
+		deferredStatements = [[NSMutableArray alloc] init];
+		tableLanes = [[NSMutableDictionary alloc] init];
+		nextLane = 0;
+		currentTableLane = 0;
+		lastDestination = SPSQLDumpConnectionDestination;
+
+		foreignKeyChecksDisabled = NO;
+		sessionChangesAutocommit = NO;
+		transactionOpen = NO;
+		replayCancelled = NO;
+
+		queryErrors = [[NSMutableArray alloc] init];
+		errorMessage = nil;
+	}
+
+	return self;
+}
+
+/**
+ * Set whether tables may be replayed concurrently, and on how many connections.
+ */
+- (void)setReplaysTablesInParallel:(BOOL)replayInParallel workerCount:(NSUInteger)theWorkerCount
+{
+	replaysTablesInParallel = replayInParallel;
+	workerCount = MAX(1, theWorkerCount);
+}
+
+/**
+ * Add a query which has already been run on the connection to the queries run on each
+ * pipeline connection as it connects - for example a SET NAMES query selecting the
+ * encoding of the file.
+ */
+- (void)addSessionQuery:(NSString *)query
+{
+	[sessionQueries addObject:query];
+}
+
+#pragma mark -
+#pragma mark Replaying statements
+
+/**
+ * Replay a statement, numbered for error reports.  Statements for tables may only be
+ * queued when this returns, and statements may be held back until the replay is finished.
+ * Returns NO if the replay failed, for example if a pipeline connection was lost, or was
+ * cancelled.
+ */
+- (BOOL)addStatement:(NSString *)statement queryNumber:(NSUInteger)queryNumber
+{
+	NSString *tableName = nil;
+	NSNumber *lane;
+
+	[self _collectPipelineErrors];
+	if (replayCancelled || errorMessage) return NO;
+
+	switch (_SPSQLDumpStatementType(statement, &tableName)) {
+
+		// Statements containing only comments have nothing to run
+		case SPSQLDumpEmptyStatement:
+			return YES;
+
+		// SET statements are run on the connection; while tables are being replayed, they
+		// are also sent with the statement they belong to
+		case SPSQLDumpSessionStatement:
+			[self _runStatement:statement queryNumber:queryNumber recordingErrors:!pipeline];
+			[self _updateSessionStateForStatement:statement];
+			[sessionQueries addObject:statement];
+			if (!pipeline) return YES;
+			if ([statement isMatchedByRegex:@"=\\s*@[^@]"]) {
+				if (lastDestination == SPSQLDumpConnectionDestination) return YES;
+				return [self _sendStatement:statement queryNumber:queryNumber toDestination:lastDestination];
+			}
+			[pendingSessionStatements addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+				statement, @"statement",
+				[NSNumber numberWithUnsignedInteger:queryNumber], @"query",
+				[NSNumber numberWithBool:YES], @"runOnConnection",
+				nil]];
+			return YES;
+
+		// Transactions are started with the statement which follows
+		case SPSQLDumpTransactionStartStatement:
+			transactionOpen = YES;
+			if (!pipeline) break;
+			[pendingSessionStatements addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+				statement, @"statement",
+				[NSNumber numberWithUnsignedInteger:queryNumber], @"query",
+				nil]];
+			return YES;
+
+		// Statements for a single table are sent to that table's lane
+		case SPSQLDumpTableStatement:
+			if (!pipeline && ![self _startPipeline]) break;
+			lane = [tableLanes objectForKey:tableName];
+			if (!lane) {
+				lane = [NSNumber numberWithUnsignedInteger:nextLane++];
+				[tableLanes setObject:lane forKey:tableName];
+			}
+			currentTableLane = [lane unsignedIntegerValue];
+			return [self _sendStatement:statement queryNumber:queryNumber toDestination:currentTableLane];
+
+		// UNLOCK TABLES and COMMIT end the section of the most recent table
+		case SPSQLDumpCurrentTableStatement:
+			if ([statement isMatchedByRegex:@"(?i)\\bCOMMIT\\b"]) transactionOpen = NO;
+			if (!pipeline) break;
+			return [self _sendStatement:statement queryNumber:queryNumber toDestination:currentTableLane];
+
+		// Views, routines, triggers and events are run once the tables are loaded
+		case SPSQLDumpDeferredStatement:
+			if (!pipeline) break;
+			return [self _sendStatement:statement queryNumber:queryNumber toDestination:SPSQLDumpDeferredDestination];
+
+		// Anything else waits for the tables queued so far
+		case SPSQLDumpBarrierStatement:
+			[self _finishPipeline];
+			if (errorMessage) return NO;
+			break;
+	}
+
+	[self _runStatement:statement queryNumber:queryNumber recordingErrors:YES];
+	lastDestination = SPSQLDumpConnectionDestination;
+
+	return YES;
+}
+
+/**
+ * Wait for the tables being replayed to be finished, then run any held back statements.
+ */
+- (void)finish
+{
+	[self _finishPipeline];
+}
+
+/**
+ * Stop the replay, discarding queued and held back statements; statements already running
+ * are allowed to finish.
+ */
+- (void)cancel
+{
+	replayCancelled = YES;
+	[pipeline cancel];
+	[self _finishPipeline];
+}
+
+#pragma mark -
+#pragma mark Statement classification
+
+/**
+ * Classify a statement by its leading keywords, as when it is added for replay.  For
+ * statements which only affect a single table, the table's name is returned by reference,
+ * unquoted and in lower case, so that all statements for a table share the same name.
+ */
++ (SPSQLDumpStatementType)typeOfStatement:(NSString *)statement tableName:(NSString **)tableName
+{
+	return _SPSQLDumpStatementType(statement, tableName);
+}
+
+#pragma mark -
+#pragma mark Checkpoints
+
+/**
+ * Wait for the statements queued so far to run, and return the state needed to continue the
+ * replay from the next statement: the current database, the session statements run so far,
+ * and any statements held back or pending.  Returns nil if the replay can't be continued from
+ * this point, as a transaction is open or the replay has failed.
+ */
+- (NSDictionary *)checkpointState
+{
+	if (transactionOpen || replayCancelled || errorMessage) return nil;
+
+	if (pipeline) {
+		[pipeline waitUntilIdle];
+		[self _collectPipelineErrors];
+		if (errorMessage) return nil;
+	}
+
+	NSMutableDictionary *state = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+		[NSArray arrayWithArray:sessionQueries], SPSQLDumpCheckpointSessionQueriesKey,
+		[NSArray arrayWithArray:pendingSessionStatements], SPSQLDumpCheckpointPendingStatementsKey,
+		[NSArray arrayWithArray:deferredStatements], SPSQLDumpCheckpointDeferredStatementsKey,
+		[NSNumber numberWithBool:foreignKeyChecksDisabled], SPSQLDumpCheckpointForeignKeyChecksDisabledKey,
+		[NSNumber numberWithBool:sessionChangesAutocommit], SPSQLDumpCheckpointSessionChangesAutocommitKey,
+		nil];
+
+	NSString *database = [self _currentDatabase];
+	if (database) [state setObject:database forKey:SPSQLDumpCheckpointDatabaseKey];
+
+	return state;
+}
+
+/**
+ * Restore replay state captured by checkpointState before any statements are added,
+ * selecting the database and re-running the session statements on the connection.
+ */
+- (void)restoreCheckpointState:(NSDictionary *)state
+{
+	NSString *database = [state objectForKey:SPSQLDumpCheckpointDatabaseKey];
+	if (database) [connection selectDatabase:database];
+
+	for (NSString *sessionQuery in [state objectForKey:SPSQLDumpCheckpointSessionQueriesKey]) {
+		[self _runStatement:sessionQuery queryNumber:0 recordingErrors:NO];
+		[sessionQueries addObject:sessionQuery];
+	}
+
+	[pendingSessionStatements setArray:[state objectForKey:SPSQLDumpCheckpointPendingStatementsKey]];
+	[deferredStatements setArray:[state objectForKey:SPSQLDumpCheckpointDeferredStatementsKey]];
+	foreignKeyChecksDisabled = [[state objectForKey:SPSQLDumpCheckpointForeignKeyChecksDisabledKey] boolValue];
+	sessionChangesAutocommit = [[state objectForKey:SPSQLDumpCheckpointSessionChangesAutocommitKey] boolValue];
+}
+
+#pragma mark -
+#pragma mark State
+
+/**
+ * Returns whether tables are currently being replayed concurrently.
+ */
+- (BOOL)isReplayingTablesInParallel
+{
+	return (pipeline != nil);
+}
+
+/**
+ * Returns the errors for statements which failed, in the order they were reported, as
+ * dictionaries of the query number and the error message.
+ */
+- (NSArray *)queryErrors
+{
+	[self _collectPipelineErrors];
+
+	return queryErrors;
+}
+
+/**
+ * Returns the error which stopped the replay, if any.
+ */
+- (NSString *)errorMessage
+{
+	return errorMessage;
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	if (pipeline) {
+		[pipeline cancel];
+		[pipeline waitUntilFinished];
+		[pipeline release], pipeline = nil;
+	}
+	[sessionQueries release];
+	[pendingSessionStatements release];
+	[deferredStatements release];
+	[tableLanes release];
+	[queryErrors release];
+	if (errorMessage) [errorMessage release], errorMessage = nil;
+	[connection release];
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPSQLDumpReplayer (Private_API)
+
+/**
+ * Returns the connection's current database, asking the server as USE statements in the
+ * dump may have changed it, or nil if none is selected.
+ */
+- (NSString *)_currentDatabase
+{
+	NSString *database = nil;
+
+	SPMySQLResult *databaseResult = [connection queryString:@"SELECT DATABASE()"];
+	[databaseResult setDefaultRowReturnType:SPMySQLResultRowAsArray];
+	if ([connection queryErrored]) return nil;
+	for (NSArray *eachRow in databaseResult) {
+		database = NSArrayObjectAtIndex(eachRow, 0);
+	}
+	if ([database isNSNull]) return nil;
+
+	return database;
+}
+
+/**
+ * Start a pipeline to replay tables on, in the connection's current database, if the dump
+ * allows tables to be replayed concurrently.  Returns NO if tables should be replayed on
+ * the connection instead.
+ */
+- (BOOL)_startPipeline
+{
+	if (!replaysTablesInParallel || pipelineUnavailable || !foreignKeyChecksDisabled || sessionChangesAutocommit) return NO;
+
+	NSString *database = [self _currentDatabase];
+
+	pipeline = [[SPImportQueryPipeline alloc] initWithConnection:connection delegate:delegate workerCount:workerCount];
+
+	// Match the connection's session variables on the inserters, such as any SQL mode set
+	// before the import, and then replay the dump's own session statements over them
+	NSMutableArray *pipelineSessionQueries = [NSMutableArray arrayWithCapacity:[sessionQueries count] + 1];
+	NSString *sessionVariablesQuery = [connection sessionVariablesMatchingQuery];
+	if (sessionVariablesQuery) [pipelineSessionQueries addObject:sessionVariablesQuery];
+	[pipelineSessionQueries addObjectsFromArray:sessionQueries];
+	[pipeline setSessionQueries:pipelineSessionQueries];
+	[pipeline setQueryEncoding:queryEncoding];
+	[pipeline setRecordsQueryErrors:YES];
+	[pipeline setMaximumQueuedLength:SPSQLDumpMaximumQueuedLength];
+
+	// If the pipeline connections can't be made, replay everything on the connection
+	if (![pipeline startInDatabase:database]) {
+		[pipeline release], pipeline = nil;
+		pipelineUnavailable = YES;
+		return NO;
+	}
+
+	pipelineErrorsCollected = 0;
+	[tableLanes removeAllObjects];
+	nextLane = 0;
+
+	return YES;
+}
+
+/**
+ * Wait for the pipeline to run all queued statements, then run the held back statements
+ * on the connection, followed by any pending statements which haven't yet been run there.
+ */
+- (void)_finishPipeline
+{
+	if (!pipeline) return;
+
+	[pipeline waitUntilFinished];
+	[self _collectPipelineErrors];
+	[pipeline release], pipeline = nil;
+
+	if (!replayCancelled && !errorMessage) {
+		for (NSDictionary *deferredStatement in deferredStatements) {
+			[self _runStatement:[deferredStatement objectForKey:@"statement"] queryNumber:[[deferredStatement objectForKey:@"query"] unsignedIntegerValue] recordingErrors:YES];
+		}
+		for (NSDictionary *pendingStatement in pendingSessionStatements) {
+			if ([[pendingStatement objectForKey:@"runOnConnection"] boolValue]) continue;
+			[self _runStatement:[pendingStatement objectForKey:@"statement"] queryNumber:[[pendingStatement objectForKey:@"query"] unsignedIntegerValue] recordingErrors:YES];
+		}
+	}
+	[deferredStatements removeAllObjects];
+	[pendingSessionStatements removeAllObjects];
+	lastDestination = SPSQLDumpConnectionDestination;
+}
+
+/**
+ * Move any query errors reported by the pipeline since the last collection into the
+ * replay's errors, and record the error if the pipeline has failed.
+ */
+- (void)_collectPipelineErrors
+{
+	if (!pipeline) return;
+
+	NSArray *pipelineErrors = [pipeline queryErrors];
+	for ( ; pipelineErrorsCollected < [pipelineErrors count]; pipelineErrorsCollected++) {
+		[queryErrors addObject:[pipelineErrors objectAtIndex:pipelineErrorsCollected]];
+	}
+
+	if (!errorMessage && [pipeline hasFailed]) {
+		errorMessage = [[pipeline errorMessage] copy];
+	}
+}
+
+/**
+ * Send a statement, preceded by any pending session statements, to a pipeline lane or the
+ * held back statements.  Returns NO if the pipeline refused it.
+ */
+- (BOOL)_sendStatement:(NSString *)statement queryNumber:(NSUInteger)queryNumber toDestination:(NSUInteger)destination
+{
+	NSMutableArray *statements = [NSMutableArray arrayWithArray:pendingSessionStatements];
+	[pendingSessionStatements removeAllObjects];
+	[statements addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+		statement, @"statement",
+		[NSNumber numberWithUnsignedInteger:queryNumber], @"query",
+		nil]];
+
+	lastDestination = destination;
+
+	if (destination == SPSQLDumpDeferredDestination) {
+		[deferredStatements addObjectsFromArray:statements];
+		return YES;
+	}
+
+	for (NSDictionary *eachStatement in statements) {
+		if (![pipeline addQuery:[eachStatement objectForKey:@"statement"] queryNumber:[[eachStatement objectForKey:@"query"] unsignedIntegerValue] inLane:destination]) {
+			[self _collectPipelineErrors];
+			return NO;
+		}
+	}
+
+	return YES;
+}
+
+/**
+ * Run a statement on the connection, recording any error against the query number.
+ */
+- (void)_runStatement:(NSString *)statement queryNumber:(NSUInteger)queryNumber recordingErrors:(BOOL)recordErrors
+{
+	[connection queryString:statement usingEncoding:queryEncoding withResultType:SPMySQLResultAsResult];
+
+	if (recordErrors && [connection queryErrored] && ![[connection lastErrorMessage] isEqualToString:@"Query was empty"]) {
+		[queryErrors addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+			[NSNumber numberWithUnsignedInteger:queryNumber], @"query",
+			[connection lastErrorMessage], @"message",
+			nil]];
+	}
+}
+
+/**
+ * Track the session settings which determine whether tables may be replayed concurrently.
+ */
+- (void)_updateSessionStateForStatement:(NSString *)statement
+{
+	if ([statement isMatchedByRegex:@"(?i)(?<![@\\w])FOREIGN_KEY_CHECKS\\s*=\\s*(0|OFF)\\b"]) {
+		foreignKeyChecksDisabled = YES;
+	} else if ([statement isMatchedByRegex:@"(?i)(?<![@\\w])FOREIGN_KEY_CHECKS\\s*="]) {
+		foreignKeyChecksDisabled = NO;
+	}
+
+	if (!pipeline && [statement isMatchedByRegex:@"(?i)(?<![@\\w])AUTOCOMMIT\\s*="]) {
+		sessionChangesAutocommit = YES;
+	}
+
+	// Statements after autocommit is disabled run in a transaction until the next commit
+	if ([statement isMatchedByRegex:@"(?i)(?<![@\\w])AUTOCOMMIT\\s*=\\s*(0|OFF)\\b"]) {
+		transactionOpen = YES;
+	}
+}
+
+@end
+
+#pragma mark -
+#pragma mark Statement classification
+
+/**
+ * Move the scanner past whitespace and comments.  The contents of MySQL version-specific
+ * comments such as "⁄*!40000 ALTER TABLE ... *⁄" are run by the server, so only their
+ * markers are skipped.
+ */
+static void _SPSQLDumpSkipIgnorable(SPSQLDumpScanner *scanner)
+{
+	unichar *c = scanner->characters;
+	NSUInteger length = scanner->length;
+	NSUInteger i = scanner->position;
+
+	while (i < length) {
+		if (SPSQLDumpIsWhitespace(c[i])) {
+			i++;
+		} else if (c[i] == '#' || (c[i] == '-' && i + 1 < length && c[i + 1] == '-' && (i + 2 == length || SPSQLDumpIsWhitespace(c[i + 2])))) {
+			while (i < length && c[i] != '\n' && c[i] != '\r') i++;
+		} else if (c[i] == '/' && i + 1 < length && c[i + 1] == '*') {
+			if (i + 2 < length && c[i + 2] == '!') {
+				for (i += 3; i < length && c[i] >= '0' && c[i] <= '9'; i++);
+			} else {
+				for (i += 2; i + 1 < length && !(c[i] == '*' && c[i + 1] == '/'); i++);
+				i += 2;
+			}
+		} else if (c[i] == '*' && i + 1 < length && c[i + 1] == '/') {
+			i += 2;
+		} else {
+			break;
+		}
+	}
+
+	scanner->position = MIN(i, length);
+}
+
+/**
+ * Returns the next keyword, in upper case, or nil if the next token isn't a word.
+ */
+static NSString *_SPSQLDumpNextWord(SPSQLDumpScanner *scanner)
+{
+	_SPSQLDumpSkipIgnorable(scanner);
+
+	NSUInteger start = scanner->position;
+	while (scanner->position < scanner->length && SPSQLDumpIsWordCharacter(scanner->characters[scanner->position])) {
+		scanner->position++;
+	}
+	if (scanner->position == start) return nil;
+
+	return [[NSString stringWithCharacters:scanner->characters + start length:scanner->position - start] uppercaseString];
+}
+
+/**
+ * Move the scanner past any of the supplied keywords, stopping before any other token.
+ */
+static void _SPSQLDumpSkipWords(SPSQLDumpScanner *scanner, NSSet *words)
+{
+	while (1) {
+		NSUInteger wordStart = scanner->position;
+		NSString *word = _SPSQLDumpNextWord(scanner);
+		if (!word || ![words containsObject:word]) {
+			scanner->position = wordStart;
+			return;
+		}
+	}
+}
+
+/**
+ * Returns whether the next keyword is one of the supplied keywords, moving the scanner
+ * past it if so.
+ */
+static BOOL _SPSQLDumpNextWordIsIn(SPSQLDumpScanner *scanner, NSSet *words)
+{
+	NSUInteger wordStart = scanner->position;
+	NSString *word = _SPSQLDumpNextWord(scanner);
+
+	if (word && [words containsObject:word]) return YES;
+
+	scanner->position = wordStart;
+	return NO;
+}
+
+/**
+ * Returns the next character other than whitespace and comments, or 0 at the end.
+ */
+static unichar _SPSQLDumpNextCharacter(SPSQLDumpScanner *scanner)
+{
+	_SPSQLDumpSkipIgnorable(scanner);
+
+	return (scanner->position < scanner->length) ? scanner->characters[scanner->position] : 0;
+}
+
+/**
+ * Returns the next table name, unquoted and in lower case so that names for a table match
+ * however they were quoted; qualified names keep the database name.  Returns nil if the
+ * next token isn't an identifier.
+ */
+static NSString *_SPSQLDumpNextIdentifier(SPSQLDumpScanner *scanner)
+{
+	NSMutableString *identifier = [NSMutableString string];
+	unichar *c = scanner->characters;
+	NSUInteger start;
+
+	_SPSQLDumpSkipIgnorable(scanner);
+
+	while (scanner->position < scanner->length) {
+		if (c[scanner->position] == '`' || c[scanner->position] == '"') {
+			unichar quote = c[scanner->position];
+			start = ++scanner->position;
+			while (1) {
+				if (scanner->position >= scanner->length) return nil;
+				if (c[scanner->position] == quote) {
+					if (scanner->position + 1 >= scanner->length || c[scanner->position + 1] != quote) break;
+
+					// Doubled quotes within the name stand for one quote
+					[identifier appendString:[NSString stringWithCharacters:c + start length:scanner->position + 1 - start]];
+					scanner->position += 2;
+					start = scanner->position;
+					continue;
+				}
+				scanner->position++;
+			}
+			[identifier appendString:[NSString stringWithCharacters:c + start length:scanner->position - start]];
+			scanner->position++;
+		} else {
+			start = scanner->position;
+			while (scanner->position < scanner->length && SPSQLDumpIsIdentifierCharacter(c[scanner->position])) {
+				scanner->position++;
+			}
+			if (scanner->position == start) return nil;
+			[identifier appendString:[NSString stringWithCharacters:c + start length:scanner->position - start]];
+		}
+
+		if (scanner->position >= scanner->length || c[scanner->position] != '.') break;
+		[identifier appendString:@"."];
+		scanner->position++;
+	}
+
+	return [identifier length] ? [identifier lowercaseString] : nil;
+}
+
+/**
+ * Returns whether the rest of an INSERT or REPLACE after the table name supplies values,
+ * rather than selecting them from other tables.
+ */
+static BOOL _SPSQLDumpInsertSuppliesValues(SPSQLDumpScanner *scanner)
+{
+	// Skip any column list, which may only contain names
+	if (_SPSQLDumpNextCharacter(scanner) == '(') {
+		unichar quote = 0;
+		for (scanner->position++; scanner->position < scanner->length; scanner->position++) {
+			unichar c = scanner->characters[scanner->position];
+			if (quote) {
+				if (c == quote) quote = 0;
+			} else if (c == '`' || c == '"') {
+				quote = c;
+			} else if (c == ')') {
+				break;
+			}
+		}
+		if (scanner->position++ >= scanner->length) return NO;
+	}
+
+	return _SPSQLDumpNextWordIsIn(scanner, SPSQLDumpValuesWords);
+}
+
+/**
+ * Classify a statement by its leading keywords, returning the name of the table for
+ * statements which only affect a single table.
+ */
+static SPSQLDumpStatementType _SPSQLDumpStatementType(NSString *statement, NSString **tableName)
+{
+	unichar characters[SPSQLDumpClassifiedLength];
+	NSUInteger statementLength = [statement length];
+	SPSQLDumpScanner scanner;
+	NSString *word;
+
+	scanner.characters = characters;
+	scanner.length = MIN(statementLength, SPSQLDumpClassifiedLength);
+	scanner.position = 0;
+	[statement getCharacters:characters range:NSMakeRange(0, scanner.length)];
+
+	*tableName = nil;
+	word = _SPSQLDumpNextWord(&scanner);
+	if (!word) {
+		if (scanner.position == statementLength) return SPSQLDumpEmptyStatement;
+		return SPSQLDumpBarrierStatement;
+	}
+
+	if ([word isEqualToString:@"SET"]) return SPSQLDumpSessionStatement;
+	if ([word isEqualToString:@"BEGIN"]) return SPSQLDumpTransactionStartStatement;
+	if ([word isEqualToString:@"START"]) {
+		if ([_SPSQLDumpNextWord(&scanner) isEqualToString:@"TRANSACTION"]) return SPSQLDumpTransactionStartStatement;
+		return SPSQLDumpBarrierStatement;
+	}
+	if ([word isEqualToString:@"UNLOCK"] || [word isEqualToString:@"COMMIT"]) return SPSQLDumpCurrentTableStatement;
+
+	if ([word isEqualToString:@"INSERT"] || [word isEqualToString:@"REPLACE"]) {
+		_SPSQLDumpSkipWords(&scanner, SPSQLDumpInsertModifiers);
+		*tableName = _SPSQLDumpNextIdentifier(&scanner);
+		if (!*tableName || !_SPSQLDumpInsertSuppliesValues(&scanner)) return SPSQLDumpBarrierStatement;
+		return SPSQLDumpTableStatement;
+	}
+
+	if ([word isEqualToString:@"DROP"] || [word isEqualToString:@"CREATE"] || [word isEqualToString:@"ALTER"]) {
+		BOOL isCreate = [word isEqualToString:@"CREATE"];
+		BOOL isDrop = [word isEqualToString:@"DROP"];
+
+		// Views are dropped in the lane for their name, as dumps may create a placeholder table
+		// of the same name before the view itself is created
+		_SPSQLDumpSkipWords(&scanner, SPSQLDumpTableModifiers);
+		word = _SPSQLDumpNextWord(&scanner);
+		if ([word isEqualToString:@"TABLE"] || (isDrop && [word isEqualToString:@"VIEW"])) {
+			_SPSQLDumpSkipWords(&scanner, SPSQLDumpExistenceWords);
+			*tableName = _SPSQLDumpNextIdentifier(&scanner);
+			if (!*tableName) return SPSQLDumpBarrierStatement;
+
+			// Statements affecting several tables, or copying another table, wait for the tables before them
+			if (isDrop && _SPSQLDumpNextCharacter(&scanner) == ',') return SPSQLDumpBarrierStatement;
+			if (isCreate && _SPSQLDumpNextWordIsIn(&scanner, SPSQLDumpTableCopyWords)) return SPSQLDumpBarrierStatement;
+
+			return SPSQLDumpTableStatement;
+		}
+		if (word && [SPSQLDumpDeferredObjectWords containsObject:word]) return SPSQLDumpDeferredStatement;
+
+		return SPSQLDumpBarrierStatement;
+	}
+
+	if ([word isEqualToString:@"TRUNCATE"]) {
+		_SPSQLDumpNextWordIsIn(&scanner, SPSQLDumpTableWords);
+		*tableName = _SPSQLDumpNextIdentifier(&scanner);
+		return *tableName ? SPSQLDumpTableStatement : SPSQLDumpBarrierStatement;
+	}
+
+	if ([word isEqualToString:@"LOCK"]) {
+		if (!_SPSQLDumpNextWordIsIn(&scanner, SPSQLDumpTableWords)) return SPSQLDumpBarrierStatement;
+		*tableName = _SPSQLDumpNextIdentifier(&scanner);
+		if (!*tableName || statementLength > SPSQLDumpClassifiedLength) return SPSQLDumpBarrierStatement;
+
+		// Locks on several tables wait for the tables before them
+		for ( ; scanner.position < scanner.length; scanner.position++) {
+			if (characters[scanner.position] == ',') return SPSQLDumpBarrierStatement;
+		}
+
+		return SPSQLDumpTableStatement;
+	}
+
+	return SPSQLDumpBarrierStatement;
+}
@@ -0,0 +1,87 @@
+//
+//  $Id$
+//
+//  SPSQLStatementSplitter.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+/**
+ * Splits a stream of SQL, such as a mysqldump file, into individual statements.  Unlike
+ * SPSQLParser, the data is held and scanned as bytes in the data encoding; the scan state
+ * is kept between calls, so data appended in chunks is only scanned once, and consumed
+ * statements are discarded lazily rather than trimmed from the front of a string for
+ * each statement.
+ *
+ * Statements are split at semicolons, or at the delimiter set by a DELIMITER command,
+ * ignoring those in quoted strings and comments.  Comments, including MySQL-version specific
+ * comments such as "⁄*!40101 SET NAMES utf8 *⁄", are left in the statements; DELIMITER
+ * commands are consumed.
+ */
+@interface SPSQLStatementSplitter : NSObject
+{
+	NSMutableData *sqlData;
+	const unsigned char *sqlBytes;
+	NSUInteger sqlDataLength;
+	NSStringEncoding dataEncoding;
+
+	NSUInteger statementStartPosition;
+	NSUInteger scanPosition;
+	NSUInteger quotedStringStartPosition;
+	NSUInteger scanState;
+	unsigned char quoteCharacter;
+	unsigned char significantBytes[256];
+	unsigned long long discardedLength;
+
+	unsigned char *delimiter;
+	NSUInteger delimiterLength;
+
+	BOOL supportDelimiters;
+	BOOL containsCRs;
+	BOOL dataContainsContent;
+	BOOL dataDecodingFailed;
+}
+
+/* Adding data */
+- (void)appendData:(NSData *)someData;
+- (void)appendString:(NSString *)aString;
++ (BOOL)canSplitDataInEncoding:(NSStringEncoding)anEncoding;
+- (BOOL)setDataEncoding:(NSStringEncoding)anEncoding;
+- (void)setDelimiterSupport:(BOOL)shouldSupportDelimiters;
+- (NSString *)delimiter;
+- (void)setDelimiter:(NSString *)aDelimiter;
+
+/* Retrieving statements */
+- (NSString *)nextStatementWithDataComplete:(BOOL)dataComplete;
+
+/* Basic information */
+- (unsigned long long)totalLengthParsed;
+- (BOOL)containsCarriageReturns;
+- (BOOL)dataDecodingFailed;
+
+@end
@@ -0,0 +1,562 @@
+//
+//  $Id$
+//
+//  SPSQLStatementSplitter.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPSQLStatementSplitter.h"
+
+// Scan states, kept between calls so that appended data continues the scan
+typedef enum {
+	SPSQLSplitterScanningStatement = 0,
+	SPSQLSplitterScanningQuotedString = 1,
+	SPSQLSplitterScanningLineComment = 2,
+	SPSQLSplitterScanningBlockComment = 3
+} SPSQLSplitterScanState;
+
+#define SPSQLSplitterIsWhitespace(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r' || (c) == '\v' || (c) == '\f')
+
+@interface SPSQLStatementSplitter (PrivateAPI)
+
+- (void)_updateSignificantBytes;
+- (NSUInteger)_endOfDelimiterCommandAtPosition:(NSUInteger)position dataComplete:(BOOL)dataComplete delimiterRange:(NSRange *)delimiterRange needsMoreData:(BOOL *)needsMoreData;
+
+@end
+
+@implementation SPSQLStatementSplitter
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+- (id)init
+{
+	if ((self = [super init])) {
+		sqlData = [[NSMutableData alloc] init];
+		sqlBytes = [sqlData bytes];
+		sqlDataLength = 0;
+		dataEncoding = NSUTF8StringEncoding;
+
+		statementStartPosition = 0;
+		scanPosition = 0;
+		quotedStringStartPosition = 0;
+		scanState = SPSQLSplitterScanningStatement;
+		discardedLength = 0;
+
+		delimiter = NULL;
+		delimiterLength = 0;
+
+		supportDelimiters = NO;
+		containsCRs = NO;
+		dataContainsContent = NO;
+		dataDecodingFailed = NO;
+
+		[self _updateSignificantBytes];
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	[sqlData release];
+	if (delimiter) free(delimiter);
+
+	[super dealloc];
+}
+
+#pragma mark -
+#pragma mark Adding data
+
+/**
+ * Append raw SQL data in the data encoding, for example as read from a file.  Data may be
+ * split at any point; statements are only decoded once complete.  A UTF-8 byte order mark
+ * at the start of the data is skipped.
+ */
+- (void)appendData:(NSData *)someData
+{
+	const unsigned char *appendBytes = [someData bytes];
+	NSUInteger appendLength = [someData length];
+
+	if (!appendLength) return;
+
+	if (!dataContainsContent) {
+		dataContainsContent = YES;
+		if (dataEncoding == NSUTF8StringEncoding && appendLength >= 3
+			&& appendBytes[0] == 0xEF && appendBytes[1] == 0xBB && appendBytes[2] == 0xBF)
+		{
+			appendBytes += 3;
+			appendLength -= 3;
+
+			// Count the byte order mark as consumed, so lengths parsed match file offsets
+			discardedLength += 3;
+		}
+	}
+
+	// Discard consumed statements once they make up at least half of the data; only the
+	// unfinished statement is moved, so each byte is only moved a bounded number of times.
+	if (statementStartPosition && statementStartPosition >= sqlDataLength - statementStartPosition) {
+		[sqlData replaceBytesInRange:NSMakeRange(0, statementStartPosition) withBytes:NULL length:0];
+		discardedLength += statementStartPosition;
+		sqlDataLength -= statementStartPosition;
+		scanPosition -= statementStartPosition;
+		if (quotedStringStartPosition >= statementStartPosition) quotedStringStartPosition -= statementStartPosition;
+		statementStartPosition = 0;
+	}
+
+	[sqlData appendBytes:appendBytes length:appendLength];
+	sqlBytes = [sqlData bytes];
+	sqlDataLength += appendLength;
+}
+
+/**
+ * Append SQL supplied as a string, which is converted to the data encoding.
+ */
+- (void)appendString:(NSString *)aString
+{
+	[self appendData:[aString dataUsingEncoding:dataEncoding allowLossyConversion:YES]];
+}
+
+/**
+ * Returns whether data in the supplied encoding can be split directly.  This is the case
+ * for encodings which are supersets of ASCII in which ASCII bytes only ever represent ASCII
+ * characters, so quotes, backslashes and delimiters can't occur within other characters;
+ * other data should be decoded and supplied as strings.
+ */
++ (BOOL)canSplitDataInEncoding:(NSStringEncoding)anEncoding
+{
+	switch (anEncoding) {
+		case NSUTF8StringEncoding:
+		case NSASCIIStringEncoding:
+		case NSISOLatin1StringEncoding:
+		case NSISOLatin2StringEncoding:
+		case NSWindowsCP1250StringEncoding:
+		case NSWindowsCP1251StringEncoding:
+		case NSWindowsCP1252StringEncoding:
+		case NSWindowsCP1253StringEncoding:
+		case NSWindowsCP1254StringEncoding:
+		case NSMacOSRomanStringEncoding:
+			return YES;
+	}
+
+	return NO;
+}
+
+/**
+ * Set the encoding of the data supplied using appendData:, which defaults to UTF-8.  This
+ * should be set before any data is added.  Returns NO if data in the encoding can't be
+ * split directly, leaving the data encoding unchanged.
+ */
+- (BOOL)setDataEncoding:(NSStringEncoding)anEncoding
+{
+	if (![SPSQLStatementSplitter canSplitDataInEncoding:anEncoding]) return NO;
+
+	dataEncoding = anEncoding;
+
+	return YES;
+}
+
+/**
+ * Set whether DELIMITER commands are recognised, as used in dumps containing routines
+ * and triggers.  Off by default.
+ */
+- (void)setDelimiterSupport:(BOOL)shouldSupportDelimiters
+{
+	supportDelimiters = shouldSupportDelimiters;
+
+	[self _updateSignificantBytes];
+}
+
+/**
+ * Returns the current statement delimiter, as set by the last DELIMITER command.
+ */
+- (NSString *)delimiter
+{
+	if (!delimiter) return @";";
+
+	return [[[NSString alloc] initWithBytes:delimiter length:delimiterLength encoding:dataEncoding] autorelease];
+}
+
+/**
+ * Set the statement delimiter, as if set by a DELIMITER command - for example when
+ * continuing to split a file part way through.
+ */
+- (void)setDelimiter:(NSString *)aDelimiter
+{
+	NSData *delimiterData = [aDelimiter dataUsingEncoding:dataEncoding];
+
+	if (delimiter) free(delimiter), delimiter = NULL;
+	delimiterLength = 0;
+	if ([delimiterData length] && ![aDelimiter isEqualToString:@";"]) {
+		delimiterLength = [delimiterData length];
+		delimiter = malloc(delimiterLength);
+		memcpy(delimiter, [delimiterData bytes], delimiterLength);
+	}
+
+	[self _updateSignificantBytes];
+}
+
+#pragma mark -
+#pragma mark Retrieving statements
+
+/**
+ * Returns the next complete statement, without its delimiter, or nil if no complete statement
+ * is available yet.  If dataComplete is set to indicate that no more data will be appended,
+ * any remaining unterminated statement is also returned.
+ * Returns nil if a statement could not be decoded using the data encoding; in that case
+ * dataDecodingFailed will return YES.
+ */
+- (NSString *)nextStatementWithDataComplete:(BOOL)dataComplete
+{
+	NSUInteger position, statementEndPosition = NSNotFound, nextStatementPosition = 0;
+	NSUInteger commandEndPosition, i;
+	NSRange delimiterRange;
+	NSString *statement;
+	const unsigned char *match;
+	unsigned char currentByte;
+	BOOL needsMoreData = NO;
+	BOOL isEscaped;
+
+	while (statementEndPosition == NSNotFound && !needsMoreData && scanPosition < sqlDataLength) {
+		switch (scanState) {
+
+			// Walk along the statement, stopping at the delimiter or at the start of strings,
+			// comments and DELIMITER commands
+			case SPSQLSplitterScanningStatement:
+				for (position = scanPosition; position < sqlDataLength; position++) {
+					currentByte = sqlBytes[position];
+
+					// Skip whitespace at the start of statements
+					if (position == statementStartPosition && SPSQLSplitterIsWhitespace(currentByte)) {
+						if (currentByte == '\r') containsCRs = YES;
+						statementStartPosition++;
+						continue;
+					}
+
+					if (!significantBytes[currentByte]) continue;
+
+					// Check for the end of the statement
+					if (delimiter) {
+						if (currentByte == delimiter[0]) {
+							if (position + delimiterLength > sqlDataLength) {
+								if (!dataComplete) {
+									needsMoreData = YES;
+									break;
+								}
+							} else if (!memcmp(sqlBytes + position, delimiter, delimiterLength)) {
+								statementEndPosition = position;
+								nextStatementPosition = position + delimiterLength;
+								break;
+							}
+						}
+					} else if (currentByte == ';') {
+						statementEndPosition = position;
+						nextStatementPosition = position + 1;
+						break;
+					}
+
+					switch (currentByte) {
+
+						// Quoted strings
+						case '\'':
+						case '"':
+						case '`':
+							scanState = SPSQLSplitterScanningQuotedString;
+							quoteCharacter = currentByte;
+							quotedStringStartPosition = position + 1;
+							break;
+
+						// Comments starting "--" followed by whitespace
+						case '-':
+							if (position + 2 >= sqlDataLength) {
+								if (!dataComplete) needsMoreData = YES;
+								break;
+							}
+							if (sqlBytes[position + 1] == '-' && SPSQLSplitterIsWhitespace(sqlBytes[position + 2])) {
+								scanState = SPSQLSplitterScanningLineComment;
+								position += 1;
+							}
+							break;
+
+						// Comments starting "#"
+						case '#':
+							scanState = SPSQLSplitterScanningLineComment;
+							break;
+
+						// Comments starting "/*", including MySQL-version specific comments
+						case '/':
+							if (position + 1 >= sqlDataLength) {
+								if (!dataComplete) needsMoreData = YES;
+								break;
+							}
+							if (sqlBytes[position + 1] == '*') {
+								scanState = SPSQLSplitterScanningBlockComment;
+								position += 1;
+							}
+							break;
+
+						// Capture whether carriage returns are encountered
+						case '\r':
+							containsCRs = YES;
+							break;
+
+						// DELIMITER commands, which must start a word
+						case 'd':
+						case 'D':
+							if (!supportDelimiters) break;
+							if (position != statementStartPosition && !SPSQLSplitterIsWhitespace(sqlBytes[position - 1])) break;
+							commandEndPosition = [self _endOfDelimiterCommandAtPosition:position dataComplete:dataComplete delimiterRange:&delimiterRange needsMoreData:&needsMoreData];
+							if (commandEndPosition == NSNotFound) break;
+
+							// Return any statement text before the command first
+							if (position != statementStartPosition) {
+								statementEndPosition = position;
+								nextStatementPosition = position;
+								break;
+							}
+
+							// Update the delimiter, dropping back to semicolons if a semicolon was set
+							if (delimiter) free(delimiter), delimiter = NULL;
+							delimiterLength = 0;
+							if (delimiterRange.length != 1 || sqlBytes[delimiterRange.location] != ';') {
+								delimiterLength = delimiterRange.length;
+								delimiter = malloc(delimiterLength);
+								memcpy(delimiter, sqlBytes + delimiterRange.location, delimiterLength);
+							}
+							[self _updateSignificantBytes];
+
+							// Consume the command
+							statementStartPosition = commandEndPosition;
+							position = commandEndPosition - 1;
+							break;
+					}
+
+					if (needsMoreData || statementEndPosition != NSNotFound || scanState != SPSQLSplitterScanningStatement) break;
+				}
+
+				// Record how far the statement was scanned; the scan resumes at the current
+				// byte if more data is needed, or after the byte which changed the state
+				if (needsMoreData || statementEndPosition != NSNotFound) scanPosition = position;
+				else if (scanState != SPSQLSplitterScanningStatement) scanPosition = position + 1;
+				else scanPosition = sqlDataLength;
+				break;
+
+			// Look for the end of the quoted string, taking into account backslash escapes
+			// and doubled quotes
+			case SPSQLSplitterScanningQuotedString:
+				match = memchr(sqlBytes + scanPosition, quoteCharacter, sqlDataLength - scanPosition);
+				if (!match) {
+					scanPosition = sqlDataLength;
+					break;
+				}
+				position = match - sqlBytes;
+
+				// Quotes preceded by an odd number of backslashes are escaped, except in backtick-quoted strings
+				if (quoteCharacter != '`') {
+					isEscaped = NO;
+					for (i = position; i > quotedStringStartPosition && sqlBytes[i - 1] == '\\'; i--) isEscaped = !isEscaped;
+					if (isEscaped) {
+						scanPosition = position + 1;
+						break;
+					}
+				}
+
+				// Doubled quotes are also escaped
+				if (position + 1 >= sqlDataLength && !dataComplete) {
+					scanPosition = position;
+					needsMoreData = YES;
+					break;
+				}
+				if (position + 1 < sqlDataLength && sqlBytes[position + 1] == quoteCharacter) {
+					scanPosition = position + 2;
+					break;
+				}
+
+				scanState = SPSQLSplitterScanningStatement;
+				scanPosition = position + 1;
+				break;
+
+			// Line comments run until the next line ending, which is then processed normally
+			case SPSQLSplitterScanningLineComment:
+				for (position = scanPosition; position < sqlDataLength; position++) {
+					if (sqlBytes[position] == '\n' || sqlBytes[position] == '\r') {
+						scanState = SPSQLSplitterScanningStatement;
+						break;
+					}
+				}
+				scanPosition = position;
+				break;
+
+			// Block comments run until the first "*/"
+			case SPSQLSplitterScanningBlockComment:
+				match = memchr(sqlBytes + scanPosition, '*', sqlDataLength - scanPosition);
+				if (!match) {
+					scanPosition = sqlDataLength;
+					break;
+				}
+				position = match - sqlBytes;
+				if (position + 1 >= sqlDataLength) {
+					if (dataComplete) {
+						scanPosition = sqlDataLength;
+					} else {
+						scanPosition = position;
+						needsMoreData = YES;
+					}
+					break;
+				}
+				if (sqlBytes[position + 1] == '/') {
+					scanState = SPSQLSplitterScanningStatement;
+					scanPosition = position + 2;
+				} else {
+					scanPosition = position + 1;
+				}
+				break;
+		}
+	}
+
+	// If no statement end was found, return any remaining text once all data has been supplied
+	if (statementEndPosition == NSNotFound) {
+		if (!dataComplete || needsMoreData || statementStartPosition >= sqlDataLength) return nil;
+		statementEndPosition = sqlDataLength;
+		nextStatementPosition = sqlDataLength;
+	}
+
+	// Decode the statement straight from the data
+	statement = [[NSString alloc] initWithBytes:sqlBytes + statementStartPosition length:statementEndPosition - statementStartPosition encoding:dataEncoding];
+	if (!statement) {
+		dataDecodingFailed = YES;
+		return nil;
+	}
+
+	statementStartPosition = nextStatementPosition;
+	scanPosition = nextStatementPosition;
+	scanState = SPSQLSplitterScanningStatement;
+
+	return [statement autorelease];
+}
+
+#pragma mark -
+#pragma mark Basic information
+
+/**
+ * Return the total length of data consumed by the statements returned so far, in bytes.
+ * Counted as a 64-bit value, as dumps may exceed 4GB on 32-bit builds.
+ */
+- (unsigned long long)totalLengthParsed
+{
+	return discardedLength + statementStartPosition;
+}
+
+/**
+ * Return whether any carriage returns have been encountered outside quoted strings; may be
+ * used to determine whether statements need to be normalised.
+ */
+- (BOOL)containsCarriageReturns
+{
+	return containsCRs;
+}
+
+/**
+ * Returns whether splitting stopped because a statement could not be decoded using the
+ * data encoding.
+ */
+- (BOOL)dataDecodingFailed
+{
+	return dataDecodingFailed;
+}
+
+@end
+
+#pragma mark -
+
+@implementation SPSQLStatementSplitter (PrivateAPI)
+
+/**
+ * Update the lookup table of bytes which need to be examined while scanning statements.
+ */
+- (void)_updateSignificantBytes
+{
+	memset(significantBytes, 0, sizeof(significantBytes));
+
+	significantBytes[';'] = 1;
+	significantBytes['\''] = 1;
+	significantBytes['"'] = 1;
+	significantBytes['`'] = 1;
+	significantBytes['-'] = 1;
+	significantBytes['#'] = 1;
+	significantBytes['/'] = 1;
+	significantBytes['\r'] = 1;
+	if (supportDelimiters) {
+		significantBytes['d'] = 1;
+		significantBytes['D'] = 1;
+	}
+	if (delimiter) significantBytes[delimiter[0]] = 1;
+}
+
+/**
+ * Check for a "DELIMITER x" command at the supplied position.  Returns the position after
+ * the command, setting the range of the new delimiter, or NSNotFound if there is no command
+ * at the position.  If more data is required to tell, needsMoreData is set.
+ */
+- (NSUInteger)_endOfDelimiterCommandAtPosition:(NSUInteger)position dataComplete:(BOOL)dataComplete delimiterRange:(NSRange *)delimiterRange needsMoreData:(BOOL *)needsMoreData
+{
+	static const char *command = "delimiter";
+	NSUInteger i, delimiterStart;
+
+	// Match the command name, case insensitively, followed by spaces or tabs
+	for (i = 0; i < 9; i++) {
+		if (position + i >= sqlDataLength) {
+			if (!dataComplete) *needsMoreData = YES;
+			return NSNotFound;
+		}
+		if ((sqlBytes[position + i] | 0x20) != command[i]) return NSNotFound;
+	}
+	position += 9;
+	if (position >= sqlDataLength) {
+		if (!dataComplete) *needsMoreData = YES;
+		return NSNotFound;
+	}
+	if (sqlBytes[position] != ' ' && sqlBytes[position] != '\t') return NSNotFound;
+	while (position < sqlDataLength && (sqlBytes[position] == ' ' || sqlBytes[position] == '\t')) position++;
+
+	// The delimiter runs until the next whitespace or the end of the data
+	delimiterStart = position;
+	while (position < sqlDataLength && !SPSQLSplitterIsWhitespace(sqlBytes[position])) position++;
+	if (position == sqlDataLength && !dataComplete) {
+		*needsMoreData = YES;
+		return NSNotFound;
+	}
+	if (position == delimiterStart) return NSNotFound;
+
+	*delimiterRange = NSMakeRange(delimiterStart, position - delimiterStart);
+
+	return position;
+}
+
+@end
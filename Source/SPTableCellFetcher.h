@@ -0,0 +1,88 @@
+//
+//  $Id$
+//
+//  SPTableCellFetcher.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+@class SPDatabaseDocument;
+@class SPConnectionPool;
+
+#import <SPMySQL/SPMySQL.h>
+
+/**
+ * Fetches the values of table cells which weren't loaded with their rows - typically blob
+ * and text columns when these are loaded as needed - identifying the rows by their primary
+ * key.  Cells are fetched in batches, using one query per column for many rows, and kept
+ * in a cache limited by the approximate size of the values, discarding the least recently
+ * used first.
+ *
+ * Cells can either be queued for fetching in the background on a pooled connection, with
+ * a SPTableCellFetcherDidFetchNotification posted on the main thread as each batch is
+ * cached, or fetched immediately on a supplied connection.
+ */
+@interface SPTableCellFetcher : NSObject
+{
+	SPDatabaseDocument *delegate;
+	SPConnectionPool *connectionPool;
+
+	NSString *table;
+	NSString *database;
+	NSArray *keyColumns;
+
+	NSMutableDictionary *cachedCells;
+	NSUInteger cachedCellsSize;
+	NSUInteger cacheUseCounter;
+
+	NSMutableArray *queuedCells;
+	NSMutableSet *pendingCellKeys;
+	NSUInteger fetchGeneration;
+	BOOL fetcherRunning;
+
+	pthread_mutex_t fetchLock;
+}
+
+// Setup and teardown
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate;
+- (void)setConnectionPool:(SPConnectionPool *)aConnectionPool;
+- (void)destroy:(NSNotification *)notification;
+
+// Table details
+- (void)setTable:(NSString *)theTable inDatabase:(NSString *)theDatabase keyColumns:(NSArray *)theKeyColumns;
+- (BOOL)canFetchCells;
+- (NSString *)rowKeyForKeyValues:(NSArray *)keyValues;
+
+// Fetching
+- (id)cachedValueForColumn:(NSString *)column rowKey:(NSString *)rowKey;
+- (void)fetchValuesForColumn:(NSString *)column rowKeys:(NSArray *)rowKeys;
+- (NSDictionary *)valuesForColumn:(NSString *)column rowKeys:(NSArray *)rowKeys usingConnection:(SPMySQLConnection *)connection;
+- (void)invalidate;
+
+@end
@@ -0,0 +1,603 @@
+//
+//  $Id$
+//
+//  SPTableCellFetcher.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPTableCellFetcher.h"
+#import "SPDatabaseDocument.h"
+#import "SPConnectionPool.h"
+#import "SPThreadAdditions.h"
+#import "SPNotLoaded.h"
+
+#import <pthread.h>
+
+// The approximate size, in bytes, of the cached cell values; once exceeded, the least
+// recently used values are discarded until three quarters of this remains
+static const NSUInteger SPTableCellFetchCacheSizeLimit = 32 * 1024 * 1024;
+
+// The maximum number of rows whose cells are fetched by one query
+static const NSUInteger SPTableCellFetchBatchSize = 500;
+
+// The delay, in microseconds, before background fetching starts, allowing cells requested
+// together - such as all those drawn in one pass - to be fetched together
+static const useconds_t SPTableCellFetchCoalesceDelay = 20000;
+
+/**
+ * A cached cell value, with its approximate size and when it was last used.
+ */
+@interface SPTableFetchedCell : NSObject
+{
+@public
+	id value;
+	NSUInteger size;
+	NSUInteger lastUse;
+}
+
+- (NSComparisonResult)compareLastUse:(SPTableFetchedCell *)otherCell;
+
+@end
+
+@interface SPTableCellFetcher (Private_API)
+
+- (NSString *)_cellKeyForColumn:(NSString *)column rowKey:(NSString *)rowKey;
+- (NSString *)_rowKeyForKeyValues:(NSArray *)keyValues usingConnection:(SPMySQLConnection *)connection;
+- (NSString *)_queryForColumn:(NSString *)column rowKeys:(NSArray *)rowKeys table:(NSString *)theTable database:(NSString *)theDatabase keyColumns:(NSArray *)theKeyColumns;
+- (NSDictionary *)_valuesFromResult:(SPMySQLResult *)result keyColumnCount:(NSUInteger)keyColumnCount usingConnection:(SPMySQLConnection *)connection;
+- (void)_cacheValue:(id)value forCellKey:(NSString *)cellKey;
+- (void)_fetchCellsTask;
+
+@end
+
+#pragma mark -
+
+@implementation SPTableCellFetcher
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+/**
+ * Prevent SPTableCellFetcher from being init'd normally.
+ */
+- (id)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"SPTableCellFetchers should not be init'd directly; use initWithDelegate: instead."];
+	return nil;
+}
+
+/**
+ * Standard init method, constructing the SPTableCellFetcher around a delegate which
+ * supplies connection details.
+ */
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate
+{
+	if ((self = [super init])) {
+
+		// Keep a weak reference to the delegate
+		delegate = theDelegate;
+
+		connectionPool = nil;
+
+		table = nil;
+		database = nil;
+		keyColumns = nil;
+
+		cachedCells = [[NSMutableDictionary alloc] init];
+		cachedCellsSize = 0;
+		cacheUseCounter = 0;
+
+		queuedCells = [[NSMutableArray alloc] init];
+		pendingCellKeys = [[NSMutableSet alloc] init];
+		fetchGeneration = 0;
+		fetcherRunning = NO;
+
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(destroy:)
+													 name:SPDocumentWillCloseNotification
+												   object:delegate];
+
+		pthread_mutex_init(&fetchLock, NULL);
+	}
+
+	return self;
+}
+
+/**
+ * Set the pool cells are fetched on a connection from; the pool's parent connection is
+ * used to build row keys.
+ */
+- (void)setConnectionPool:(SPConnectionPool *)aConnectionPool
+{
+	pthread_mutex_lock(&fetchLock);
+	if (connectionPool) [connectionPool release];
+	connectionPool = [aConnectionPool retain];
+	pthread_mutex_unlock(&fetchLock);
+}
+
+/**
+ * Discard all cached cells, cancel any fetch in progress, and stop using the delegate.
+ */
+- (void)destroy:(NSNotification *)notification
+{
+	[self invalidate];
+
+	pthread_mutex_lock(&fetchLock);
+	delegate = nil;
+	pthread_mutex_unlock(&fetchLock);
+}
+
+#pragma mark -
+#pragma mark Table details
+
+/**
+ * Set the table whose cells are fetched, and the primary key columns identifying its rows.
+ * Cells can't be fetched if no key columns are supplied.  Changing the table discards all
+ * cached cells.
+ */
+- (void)setTable:(NSString *)theTable inDatabase:(NSString *)theDatabase keyColumns:(NSArray *)theKeyColumns
+{
+	if (![theKeyColumns count]) theKeyColumns = nil;
+
+	pthread_mutex_lock(&fetchLock);
+
+	if ((table == theTable || [table isEqualToString:theTable])
+		&& (database == theDatabase || [database isEqualToString:theDatabase])
+		&& (keyColumns == theKeyColumns || [keyColumns isEqualToArray:theKeyColumns]))
+	{
+		pthread_mutex_unlock(&fetchLock);
+		return;
+	}
+
+	if (table) [table release];
+	table = [theTable copy];
+	if (database) [database release];
+	database = [theDatabase copy];
+	if (keyColumns) [keyColumns release];
+	keyColumns = [theKeyColumns copy];
+
+	pthread_mutex_unlock(&fetchLock);
+
+	[self invalidate];
+}
+
+/**
+ * Returns whether the rows of the current table can be identified to fetch their cells.
+ */
+- (BOOL)canFetchCells
+{
+	BOOL canFetch;
+
+	pthread_mutex_lock(&fetchLock);
+	canFetch = (table && database && keyColumns && [connectionPool parentConnection]);
+	pthread_mutex_unlock(&fetchLock);
+
+	return canFetch;
+}
+
+/**
+ * Returns the key identifying a row by the values of its primary key columns, in order, or
+ * nil if any of the values can't be used to identify the row.
+ */
+- (NSString *)rowKeyForKeyValues:(NSArray *)keyValues
+{
+	SPMySQLConnection *connection;
+
+	pthread_mutex_lock(&fetchLock);
+	if ([keyValues count] != [keyColumns count]) {
+		pthread_mutex_unlock(&fetchLock);
+		return nil;
+	}
+	connection = [connectionPool parentConnection];
+	pthread_mutex_unlock(&fetchLock);
+
+	return [self _rowKeyForKeyValues:keyValues usingConnection:connection];
+}
+
+#pragma mark -
+#pragma mark Fetching
+
+/**
+ * Returns the cached value of a cell, or nil if it hasn't been fetched.  Cells which were
+ * fetched but whose rows no longer exist are returned as SPNotLoaded.
+ */
+- (id)cachedValueForColumn:(NSString *)column rowKey:(NSString *)rowKey
+{
+	id value = nil;
+
+	if (!column || !rowKey) return nil;
+
+	NSString *cellKey = [self _cellKeyForColumn:column rowKey:rowKey];
+
+	pthread_mutex_lock(&fetchLock);
+	SPTableFetchedCell *cachedCell = [cachedCells objectForKey:cellKey];
+	if (cachedCell) {
+		cachedCell->lastUse = ++cacheUseCounter;
+		value = [[cachedCell->value retain] autorelease];
+	}
+	pthread_mutex_unlock(&fetchLock);
+
+	return value;
+}
+
+/**
+ * Queue the cells of a column in the supplied rows to be fetched in the background.  Cells
+ * which are already cached or queued aren't queued again.
+ */
+- (void)fetchValuesForColumn:(NSString *)column rowKeys:(NSArray *)rowKeys
+{
+	BOOL startFetcher;
+
+	if (!column || ![rowKeys count]) return;
+
+	pthread_mutex_lock(&fetchLock);
+
+	if (!keyColumns || !delegate) {
+		pthread_mutex_unlock(&fetchLock);
+		return;
+	}
+
+	for (NSString *rowKey in rowKeys) {
+		NSString *cellKey = [self _cellKeyForColumn:column rowKey:rowKey];
+
+		if ([pendingCellKeys containsObject:cellKey] || [cachedCells objectForKey:cellKey]) continue;
+
+		[pendingCellKeys addObject:cellKey];
+		[queuedCells addObject:[NSArray arrayWithObjects:column, rowKey, cellKey, nil]];
+	}
+
+	startFetcher = ([queuedCells count] && !fetcherRunning);
+	if (startFetcher) fetcherRunning = YES;
+
+	pthread_mutex_unlock(&fetchLock);
+
+	if (startFetcher) {
+		[NSThread detachNewThreadWithName:@"SPTableCellFetcher cell fetch task" target:self selector:@selector(_fetchCellsTask) object:nil];
+	}
+}
+
+/**
+ * Fetch the cells of a column in the supplied rows immediately on the supplied connection,
+ * returning a dictionary of the values keyed by row key.  Cached values are used where
+ * available, and fetched values are cached.  Rows which couldn't be fetched are missing
+ * from the dictionary.
+ */
+- (NSDictionary *)valuesForColumn:(NSString *)column rowKeys:(NSArray *)rowKeys usingConnection:(SPMySQLConnection *)connection
+{
+	NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:[rowKeys count]];
+	NSMutableArray *uncachedRowKeys = [NSMutableArray array];
+	NSString *theTable, *theDatabase;
+	NSArray *theKeyColumns;
+	NSUInteger generation, i;
+
+	if (!column || ![rowKeys count] || !connection) return values;
+
+	pthread_mutex_lock(&fetchLock);
+	for (NSString *rowKey in rowKeys) {
+		SPTableFetchedCell *cachedCell = [cachedCells objectForKey:[self _cellKeyForColumn:column rowKey:rowKey]];
+		if (cachedCell && ![cachedCell->value isSPNotLoaded]) {
+			cachedCell->lastUse = ++cacheUseCounter;
+			[values setObject:cachedCell->value forKey:rowKey];
+		} else {
+			[uncachedRowKeys addObject:rowKey];
+		}
+	}
+	theTable = [[table retain] autorelease];
+	theDatabase = [[database retain] autorelease];
+	theKeyColumns = [[keyColumns retain] autorelease];
+	generation = fetchGeneration;
+	pthread_mutex_unlock(&fetchLock);
+
+	if (!theTable || !theDatabase || !theKeyColumns) return values;
+
+	// Fetch the remaining cells in batches
+	for (i = 0; i < [uncachedRowKeys count]; i += SPTableCellFetchBatchSize) {
+		NSAutoreleasePool *batchPool = [[NSAutoreleasePool alloc] init];
+		NSArray *batchRowKeys = [uncachedRowKeys subarrayWithRange:NSMakeRange(i, MIN(SPTableCellFetchBatchSize, [uncachedRowKeys count] - i))];
+
+		SPMySQLResult *result = [connection queryString:[self _queryForColumn:column rowKeys:batchRowKeys table:theTable database:theDatabase keyColumns:theKeyColumns]];
+		if ([connection queryErrored]) {
+			[batchPool drain];
+			break;
+		}
+
+		NSDictionary *batchValues = [self _valuesFromResult:result keyColumnCount:[theKeyColumns count] usingConnection:connection];
+		[values addEntriesFromDictionary:batchValues];
+
+		pthread_mutex_lock(&fetchLock);
+		if (generation == fetchGeneration) {
+			for (NSString *rowKey in batchValues) {
+				[self _cacheValue:[batchValues objectForKey:rowKey] forCellKey:[self _cellKeyForColumn:column rowKey:rowKey]];
+			}
+		}
+		pthread_mutex_unlock(&fetchLock);
+
+		[batchPool drain];
+	}
+
+	return values;
+}
+
+/**
+ * Discard all cached and queued cells and cancel any fetch in progress, for use when the
+ * cells may no longer match the table, such as after edits.
+ */
+- (void)invalidate
+{
+	pthread_mutex_lock(&fetchLock);
+	fetchGeneration++;
+	[cachedCells removeAllObjects];
+	cachedCellsSize = 0;
+	[queuedCells removeAllObjects];
+	[pendingCellKeys removeAllObjects];
+	if (fetcherRunning) [connectionPool cancelQueryForUser:self];
+	pthread_mutex_unlock(&fetchLock);
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+
+	[self destroy:nil];
+
+	pthread_mutex_destroy(&fetchLock);
+
+	if (connectionPool) [connectionPool release], connectionPool = nil;
+	if (table) [table release], table = nil;
+	if (database) [database release], database = nil;
+	if (keyColumns) [keyColumns release], keyColumns = nil;
+	if (cachedCells) [cachedCells release], cachedCells = nil;
+	if (queuedCells) [queuedCells release], queuedCells = nil;
+	if (pendingCellKeys) [pendingCellKeys release], pendingCellKeys = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPTableCellFetcher (Private_API)
+
+/**
+ * Returns the key identifying a cell in the cache.
+ */
+- (NSString *)_cellKeyForColumn:(NSString *)column rowKey:(NSString *)rowKey
+{
+	return [NSString stringWithFormat:@"%@ %@", [column backtickQuotedString], rowKey];
+}
+
+/**
+ * Returns the key identifying a row - its key values as a quoted SQL value, or a row
+ * constructor for multiple key columns, so that keys can be used directly in queries.
+ * The same connection encoding must be used for all row keys of a table.
+ */
+- (NSString *)_rowKeyForKeyValues:(NSArray *)keyValues usingConnection:(SPMySQLConnection *)connection
+{
+	NSMutableArray *quotedValues = [NSMutableArray arrayWithCapacity:[keyValues count]];
+
+	if (!connection || ![keyValues count]) return nil;
+
+	for (id keyValue in keyValues) {
+		if ([keyValue isNSNull] || [keyValue isSPNotLoaded] || [keyValue isKindOfClass:[SPMySQLGeometryData class]]) return nil;
+
+		if ([keyValue isKindOfClass:[NSData class]]) {
+			[quotedValues addObject:[connection escapeAndQuoteData:keyValue]];
+		} else {
+			[quotedValues addObject:[connection escapeAndQuoteString:[keyValue description]]];
+		}
+	}
+
+	if ([quotedValues count] == 1) return [quotedValues objectAtIndex:0];
+
+	return [NSString stringWithFormat:@"(%@)", [quotedValues componentsJoinedByString:@", "]];
+}
+
+/**
+ * Returns the query fetching the key values and the cell values of a column in the
+ * supplied rows.
+ */
+- (NSString *)_queryForColumn:(NSString *)column rowKeys:(NSArray *)rowKeys table:(NSString *)theTable database:(NSString *)theDatabase keyColumns:(NSArray *)theKeyColumns
+{
+	NSString *keyExpression = [theKeyColumns componentsJoinedAndBacktickQuoted];
+	if ([theKeyColumns count] > 1) keyExpression = [NSString stringWithFormat:@"(%@)", keyExpression];
+
+	return [NSString stringWithFormat:@"SELECT %@, %@ FROM %@.%@ WHERE %@ IN (%@)",
+		[theKeyColumns componentsJoinedAndBacktickQuoted],
+		[column backtickQuotedString],
+		[theDatabase backtickQuotedString],
+		[theTable backtickQuotedString],
+		keyExpression,
+		[rowKeys componentsJoinedByString:@", "]];
+}
+
+/**
+ * Returns the cell values in a result from a fetch query, keyed by row key.
+ */
+- (NSDictionary *)_valuesFromResult:(SPMySQLResult *)result keyColumnCount:(NSUInteger)keyColumnCount usingConnection:(SPMySQLConnection *)connection
+{
+	NSMutableDictionary *values = [NSMutableDictionary dictionary];
+	NSArray *row;
+
+	while ((row = [result getRowAsArray])) {
+		if ([row count] != keyColumnCount + 1) continue;
+
+		NSString *rowKey = [self _rowKeyForKeyValues:[row subarrayWithRange:NSMakeRange(0, keyColumnCount)] usingConnection:connection];
+		if (rowKey) [values setObject:[row objectAtIndex:keyColumnCount] forKey:rowKey];
+	}
+
+	return values;
+}
+
+/**
+ * Cache a cell value, discarding the least recently used cells if the cache has grown too
+ * large.  Should be called with the fetch lock held.
+ */
+- (void)_cacheValue:(id)value forCellKey:(NSString *)cellKey
+{
+	SPTableFetchedCell *cachedCell = [cachedCells objectForKey:cellKey];
+	if (cachedCell) cachedCellsSize -= cachedCell->size;
+
+	cachedCell = [[SPTableFetchedCell alloc] init];
+	cachedCell->value = [value retain];
+	cachedCell->lastUse = ++cacheUseCounter;
+	cachedCell->size = [cellKey length] * sizeof(unichar);
+	if ([value isKindOfClass:[NSData class]]) {
+		cachedCell->size += [(NSData *)value length];
+	} else if ([value isKindOfClass:[NSString class]]) {
+		cachedCell->size += [(NSString *)value length] * sizeof(unichar);
+	} else if ([value isKindOfClass:[SPMySQLGeometryData class]]) {
+		cachedCell->size += [[(SPMySQLGeometryData *)value data] length];
+	}
+	[cachedCells setObject:cachedCell forKey:cellKey];
+	cachedCellsSize += cachedCell->size;
+	[cachedCell release];
+
+	if (cachedCellsSize <= SPTableCellFetchCacheSizeLimit) return;
+
+	// Discard the least recently used cells until a quarter of the cache is free
+	for (NSString *eachKey in [cachedCells keysSortedByValueUsingSelector:@selector(compareLastUse:)]) {
+		if (cachedCellsSize <= SPTableCellFetchCacheSizeLimit / 4 * 3) break;
+		cachedCellsSize -= ((SPTableFetchedCell *)[cachedCells objectForKey:eachKey])->size;
+		[cachedCells removeObjectForKey:eachKey];
+	}
+}
+
+/**
+ * Fetch queued cells in batches of the same column until the queue is empty, caching the
+ * values unless the cache was invalidated while they were fetched, and posting a
+ * SPTableCellFetcherDidFetchNotification for each batch cached.
+ * Should always be executed on a background thread.
+ */
+- (void)_fetchCellsTask
+{
+	NSAutoreleasePool *fetchPool = [[NSAutoreleasePool alloc] init];
+
+	usleep(SPTableCellFetchCoalesceDelay);
+
+	while (1) {
+		NSAutoreleasePool *batchPool = [[NSAutoreleasePool alloc] init];
+		NSMutableArray *batchCells = [NSMutableArray array];
+		NSMutableArray *batchRowKeys = [NSMutableArray array];
+		NSMutableIndexSet *batchIndexes = [NSMutableIndexSet indexSet];
+		NSDictionary *batchValues = nil;
+		SPMySQLConnection *fetchConnection;
+		SPConnectionPool *pool;
+		NSString *column, *theTable, *theDatabase;
+		NSArray *theKeyColumns;
+		NSUInteger generation, i;
+		BOOL cached = NO;
+
+		pthread_mutex_lock(&fetchLock);
+		if (![queuedCells count] || !delegate || !keyColumns) {
+			fetcherRunning = NO;
+			pthread_mutex_unlock(&fetchLock);
+			[batchPool drain];
+			break;
+		}
+
+		// Take the queued cells of the first queued column, in order, up to the batch size
+		column = [[[[queuedCells objectAtIndex:0] objectAtIndex:0] retain] autorelease];
+		for (i = 0; i < [queuedCells count] && [batchCells count] < SPTableCellFetchBatchSize; i++) {
+			NSArray *queuedCell = [queuedCells objectAtIndex:i];
+			if (![[queuedCell objectAtIndex:0] isEqualToString:column]) continue;
+			[batchCells addObject:queuedCell];
+			[batchRowKeys addObject:[queuedCell objectAtIndex:1]];
+			[batchIndexes addIndex:i];
+		}
+		[queuedCells removeObjectsAtIndexes:batchIndexes];
+		theTable = [[table retain] autorelease];
+		theDatabase = [[database retain] autorelease];
+		theKeyColumns = [[keyColumns retain] autorelease];
+		generation = fetchGeneration;
+		pool = [[connectionPool retain] autorelease];
+		pthread_mutex_unlock(&fetchLock);
+
+		fetchConnection = [pool checkOutConnectionForUser:self database:nil];
+		if (fetchConnection) {
+			SPMySQLResult *result = [fetchConnection queryString:[self _queryForColumn:column rowKeys:batchRowKeys table:theTable database:theDatabase keyColumns:theKeyColumns]];
+			if (![fetchConnection queryErrored] && ![fetchConnection lastQueryWasCancelled]) {
+				batchValues = [self _valuesFromResult:result keyColumnCount:[theKeyColumns count] usingConnection:fetchConnection];
+			}
+			[pool checkInConnection:fetchConnection];
+		}
+
+		pthread_mutex_lock(&fetchLock);
+		if (generation == fetchGeneration) {
+			for (NSArray *batchCell in batchCells) {
+				[pendingCellKeys removeObject:[batchCell objectAtIndex:2]];
+
+				// Rows missing from the result are cached as not loaded, so that they aren't requested again
+				if (batchValues) {
+					id value = [batchValues objectForKey:[batchCell objectAtIndex:1]];
+					[self _cacheValue:(value ? value : [SPNotLoaded notLoaded]) forCellKey:[batchCell objectAtIndex:2]];
+					cached = YES;
+				}
+			}
+		}
+		pthread_mutex_unlock(&fetchLock);
+
+		if (cached) {
+			[[NSNotificationCenter defaultCenter] postNotificationOnMainThread:[NSNotification notificationWithName:SPTableCellFetcherDidFetchNotification object:self]];
+		}
+
+		[batchPool drain];
+	}
+
+	[fetchPool drain];
+}
+
+@end
+
+#pragma mark -
+
+@implementation SPTableFetchedCell
+
+/**
+ * Orders cells from least to most recently used.
+ */
+- (NSComparisonResult)compareLastUse:(SPTableFetchedCell *)otherCell
+{
+	if (lastUse < otherCell->lastUse) return NSOrderedAscending;
+	if (lastUse > otherCell->lastUse) return NSOrderedDescending;
+	return NSOrderedSame;
+}
+
+- (void)dealloc
+{
+	if (value) [value release], value = nil;
+
+	[super dealloc];
+}
+
+@end
@@ -47,12 +47,18 @@
 @class SPTableStructure;
 @class SPTableList;
 @class SPContentFilterManager;
+@class SPDataStorageFilter;
+@class SPTablePagePrefetcher;
+@class SPTableCellFetcher;
+@class SPTableResultCache;
 #ifndef SP_CODA
 @class SPSplitView;
 #endif
 
 #import "SPDatabaseContentViewDelegate.h"
 
+#import <SPMySQL/SPMySQL.h>
+
 @interface SPTableContent : NSObject <NSTableViewDelegate, NSTableViewDataSource, NSComboBoxDataSource, NSComboBoxDelegate>
 {	
 	IBOutlet SPDatabaseDocument *tableDocumentInstance;
@@ -133,12 +139,37 @@
 	BOOL isFiltered, isLimited, isInterruptedLoad, maxNumRowsIsEstimate;
 	NSUserDefaults *prefs;
 	NSInteger currentlyEditingRow, maxNumRows;
+	NSString *filteredRowCountClause;
 
 	NSMutableDictionary *contentFilters;
 	NSMutableDictionary *numberOfDefaultFilters;
 	NSUInteger lastSelectedContentFilterIndex;
 	SPContentFilterManager *contentFilterManager;
 	NSUInteger contentPage;
+	SPDataStorageFilter *localFilter;
+	NSMutableDictionary *keysetPageBoundaries;
+	NSString *keysetQueryBase;
+	SPTablePagePrefetcher *pagePrefetcher;
+	SPTableCellFetcher *cellFetcher;
+	SPTableResultCache *resultCache;
+	BOOL tableValuesStoreIsCached;
+
+	pthread_mutex_t virtualBlockQueueLock;
+	pthread_cond_t virtualBlockDownloadCondition;
+	NSMutableIndexSet *virtualBlockQueue;
+	NSMutableIndexSet *virtualBlocksWithBoundaries;
+	NSMutableDictionary *virtualBlockBoundaries;
+	NSString *virtualQueryBase;
+	NSString *virtualQueryOrderBy;
+	NSArray *virtualKeyColumns;
+	NSString *virtualDatabase;
+	NSUInteger virtualLoadGeneration;
+	NSUInteger virtualMostRecentBlock;
+	BOOL virtualLoaderRunning;
+	BOOL virtualColumnsNeedSizing;
+
+	NSUInteger columnSizingGeneration;
+	BOOL columnWidthsRestored;
 
 #ifndef SP_CODA
 	NSMutableDictionary *filterTableData;
@@ -252,6 +283,7 @@
 // Data accessors
 - (NSArray *)currentResult;
 - (NSArray *)currentDataResultWithNULLs:(BOOL)includeNULLs hideBLOBs:(BOOL)hide;
+- (NSDictionary *)valuesForUnloadedColumn:(NSUInteger)columnIndex inRows:(NSIndexSet *)rowIndexes;
 
 // Task interaction
 - (void)startDocumentTaskForTab:(NSNotification *)aNotification;
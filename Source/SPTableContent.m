@@ -41,6 +41,7 @@
 #import "SPCopyTable.h"
 #import "SPDataCellFormatter.h"
 #import "SPTableData.h"
+#import "SPServerSupport.h"
 #import "SPQueryController.h"
 #import "SPQueryDocumentsController.h"
 #import "SPTextAndLinkCell.h"
@@ -53,6 +54,13 @@
 #import "RegexKitLite.h"
 #import "SPContentFilterManager.h"
 #import "SPDataStorage.h"
+#import "SPDataStorageSorting.h"
+#import "SPDataStorageFiltering.h"
+#import "SPTableRowCounter.h"
+#import "SPTablePagePrefetcher.h"
+#import "SPTableCellFetcher.h"
+#import "SPConnectionPool.h"
+#import "SPTableResultCache.h"
 #import "SPAlertSheets.h"
 #import "SPHistoryController.h"
 #import "SPGeometryDataView.h"
@@ -72,16 +80,53 @@
 static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOperator";
 #endif
 
+// Unlimited tables estimated to hold at least this many rows only fetch the rows displayed
+static const NSUInteger SPTableContentVirtualLoadingThreshold = 100000;
+static const NSUInteger SPTableContentVirtualBlockSize = 500;
+
+// Detected column widths are saved for this many of the most recently shown tables per database
+static const NSUInteger SPTableContentSavedColumnWidthsLimit = 100;
+
 @interface SPTableContent (SPTableContentDataSource_Private_API)
 
 - (id)_contentValueForTableColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex asPreview:(BOOL)asPreview;
+- (NSString *)_rowKeyForLazyFetchAtRow:(NSUInteger)rowIndex;
 
 @end
 
-@interface SPTableContent ()
+@interface SPTableContent () <SPDataStorageVirtualLoader, SPMySQLStreamingResultStoreDelegate>
 
 - (BOOL)cancelRowEditing;
 
+- (NSArray *)_keysetColumnIndexes;
+- (NSString *)_keysetOrderByClauseForColumns:(NSArray *)columnIndexes;
+- (NSString *)_keysetConditionForColumns:(NSArray *)columnIndexes afterValues:(NSArray *)keyValues;
+- (void)_storeKeysetBoundaryForPage:(NSUInteger)page columns:(NSArray *)columnIndexes;
+- (NSString *)_queryForPage:(NSUInteger)page selectClause:(NSString *)selectClause filter:(NSString *)filterString orderBy:(NSString *)orderByString keyColumns:(NSArray *)keyColumns;
+- (void)_prefetchPagesAdjacentToPage:(NSUInteger)page selectClause:(NSString *)selectClause filter:(NSString *)filterString orderBy:(NSString *)orderByString keyColumns:(NSArray *)keyColumns;
+
+- (SPDataStorageFilter *)_localFilterForCurrentSettings;
+- (BOOL)_filterTableValuesLocally;
+- (BOOL)_restoreLocalRowOrder;
+
+- (void)_rowCountDidFinish:(NSNotification *)notification;
+
+- (NSArray *)_cellFetcherKeyColumns;
+- (NSString *)_resultCacheProbeIsSettled:(BOOL *)isSettled;
+- (void)_cellFetcherDidFetch:(NSNotification *)notification;
+
+- (void)_autosizeColumnsTask:(NSDictionary *)sizingDetails;
+- (void)_applyAutodetectedColumnWidths:(NSDictionary *)columnWidths generation:(NSNumber *)generation;
+#ifndef SP_CODA
+- (NSDictionary *)_savedAutodetectedColumnWidths;
+- (void)_saveAutodetectedColumnWidths:(NSDictionary *)columnWidths;
+#endif
+
+- (void)_loadVirtualTableValuesWithQuery:(NSString *)queryBase orderBy:(NSString *)orderBy keyColumns:(NSArray *)keyColumns;
+- (NSString *)_queryForVirtualBlock:(NSUInteger)blockIndex;
+- (void)_loadVirtualBlocksTask;
+- (void)_installVirtualBlock:(NSArray *)blockDetails;
+
 @end
 
 @implementation SPTableContent
@@ -147,6 +192,30 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 
 		currentlyEditingRow = -1;
 		contentPage = 1;
+		keysetPageBoundaries = [[NSMutableDictionary alloc] init];
+		keysetQueryBase = nil;
+		pagePrefetcher = nil;
+		cellFetcher = nil;
+		resultCache = [[SPTableResultCache alloc] init];
+		tableValuesStoreIsCached = NO;
+		filteredRowCountClause = nil;
+
+		pthread_mutex_init(&virtualBlockQueueLock, NULL);
+		pthread_cond_init(&virtualBlockDownloadCondition, NULL);
+		virtualBlockQueue = [[NSMutableIndexSet alloc] init];
+		virtualBlocksWithBoundaries = [[NSMutableIndexSet alloc] init];
+		virtualBlockBoundaries = [[NSMutableDictionary alloc] init];
+		virtualQueryBase = nil;
+		virtualQueryOrderBy = nil;
+		virtualKeyColumns = nil;
+		virtualDatabase = nil;
+		virtualLoadGeneration = 0;
+		virtualMostRecentBlock = 0;
+		virtualLoaderRunning = NO;
+		virtualColumnsNeedSizing = NO;
+
+		columnSizingGeneration = 0;
+		columnWidthsRestored = NO;
 
 		sortColumnToRestore = nil;
 		sortColumnToRestoreIsAsc = YES;
@@ -272,6 +341,12 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 											 selector:@selector(endDocumentTaskForTab:)
 												 name:SPDocumentTaskEndNotification
 											   object:tableDocumentInstance];
+
+	// Add an observer for background row counts
+	[[NSNotificationCenter defaultCenter] addObserver:self
+											 selector:@selector(_rowCountDidFinish:)
+												 name:SPTableRowCountDidFinishNotification
+											   object:nil];
 }
 
 #pragma mark -
@@ -316,8 +391,11 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 									nil];
 	[self performSelectorOnMainThread:@selector(setTableDetails:) withObject:tableDetails waitUntilDone:YES];
 
-	// Init copyTable with necessary information for copying selected rows as SQL INSERT
+	// Init copyTable with necessary information for copying selected rows as SQL INSERT; the
+	// lock keeps the columns consistent with the rows for any column sizing in progress
+	pthread_mutex_lock(&tableValuesLock);
 	[tableContentView setTableInstance:self withTableData:tableValues withColumns:dataColumns withTableName:selectedTable withConnection:mySQLConnection];
+	pthread_mutex_unlock(&tableValuesLock);
 
 	// Trigger a data refresh
 	[self loadTableValues];
@@ -408,6 +486,16 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		contentPage = 1;
 		[paginationPageField setStringValue:@"1"];
 
+		// Page boundaries from any previous table no longer apply
+		[keysetPageBoundaries removeAllObjects];
+		if (keysetQueryBase) [keysetQueryBase release], keysetQueryBase = nil;
+
+		// Discard any virtual blocks still being fetched for the previous table
+		pthread_mutex_lock(&virtualBlockQueueLock);
+		virtualLoadGeneration++;
+		[virtualBlockQueue removeAllIndexes];
+		pthread_mutex_unlock(&virtualBlockQueueLock);
+
 		// Clear the selection
 		[tableContentView deselectAll:self];
 
@@ -415,9 +503,12 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		[tableContentView scrollRowToVisible:0];
 		[tableContentView scrollColumnToVisible:0];
 
-		// Set the maximum table rows to an estimated count pre-load
+		// Set the maximum table rows to an estimated count pre-load, and stop counting
+		// the rows of any previous table
 		maxNumRows = [[tableDataInstance statusValueForKey:@"Rows"] integerValue];
 		maxNumRowsIsEstimate = YES;
+		[[tableDataInstance rowCounter] cancelCount];
+		[pagePrefetcher invalidate];
 	}
 
 	// If no table has been supplied, reset the view to a blank table and disabled elements.
@@ -434,6 +525,7 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		[tableContentView reloadData];
 		isFiltered = NO;
 		isLimited = NO;
+		if (localFilter) [localFilter release], localFilter = nil;
 #ifndef SP_CODA
 		[countText setStringValue:@""];
 #endif
@@ -771,9 +863,20 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	NSMutableString *queryString;
 	NSString *queryStringBeforeLimit = nil;
 	NSString *filterString;
-	SPMySQLStreamingResultStore *resultStore;
+	NSString *orderByString = nil;
+	NSString *selectClause = nil;
+	NSArray *keysetColumns = nil;
+	NSUInteger whereClauseStart;
+	BOOL loadVirtually = NO;
+	SPMySQLStreamingResultStore *resultStore = nil;
+	NSString *resultCacheProbe = nil;
+	BOOL resultCacheProbeIsSettled = NO;
+	BOOL resultStoreWasCached = NO;
 	NSInteger rowsToLoad = [[tableDataInstance statusValueForKey:@"Rows"] integerValue];
 
+	// Allow any saved column widths to be restored for this load
+	columnWidthsRestored = NO;
+
 #ifndef SP_CODA
 	[countText setStringValue:NSLocalizedString(@"Loading table data...", @"Loading table data string")];
 #endif
@@ -789,8 +892,11 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 			@"", 
 			[self fieldListForQuery], [selectedTable backtickQuotedString]];
 
-	// Add a filter string if appropriate
+	// Add a filter string if appropriate; any filter applied to the previously loaded rows
+	// is replaced by the server's
 	filterString = [self tableFilterString];
+	whereClauseStart = [queryString length];
+	if (localFilter) [localFilter release], localFilter = nil;
 
 	if (filterString) {
 		[queryString appendFormat:@" WHERE %@", filterString];
@@ -799,33 +905,73 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		isFiltered = NO;
 	}
 
-	// Add sorting details if appropriate
-	if (sortCol) {
-		[queryString appendFormat:@" ORDER BY %@", [[[dataColumns objectAtIndex:[sortCol integerValue]] objectForKey:@"name"] backtickQuotedString]];
-		if (isDesc) [queryString appendString:@" DESC"];
+	// Keep the filter for counting the matching rows; DISTINCT rows can't be counted by it alone
+	if (filteredRowCountClause) [filteredRowCountClause release], filteredRowCountClause = nil;
+#ifndef SP_CODA
+	if (filterString && !(activeFilter == 1 && filterTableDistinct)) filteredRowCountClause = [[NSString alloc] initWithString:filterString];
+#else
+	if (filterString) filteredRowCountClause = [[NSString alloc] initWithString:filterString];
+#endif
+
+	// Add sorting details if appropriate.  When paging through a table with a usable key, always
+	// order by that key so that pages can be located by seeking past the last key of an earlier page.
+	if ([prefs boolForKey:SPLimitResults]) {
+		keysetColumns = [self _keysetColumnIndexes];
+		if (keysetColumns) orderByString = [self _keysetOrderByClauseForColumns:keysetColumns];
+	}
+	if (!orderByString && sortCol) {
+		orderByString = [NSString stringWithFormat:@" ORDER BY %@%@", [[[dataColumns objectAtIndex:[sortCol integerValue]] objectForKey:@"name"] backtickQuotedString], isDesc ? @" DESC" : @""];
+	}
+
+	// Large unfiltered tables which aren't being paged are loaded virtually, only fetching blocks
+	// of rows as they are displayed; this also requires a key to locate the blocks by.
+	if (![prefs boolForKey:SPLimitResults] && !filterString && maxNumRows >= (NSInteger)SPTableContentVirtualLoadingThreshold) {
+		keysetColumns = [self _keysetColumnIndexes];
+		if (keysetColumns) {
+			loadVirtually = YES;
+			queryStringBeforeLimit = [NSString stringWithString:queryString];
+			orderByString = [self _keysetOrderByClauseForColumns:keysetColumns];
+		}
 	}
 
 	// Check to see if a limit needs to be applied
 	if ([prefs boolForKey:SPLimitResults]) 
 	{
+		NSInteger pageSize = [prefs integerForKey:SPLimitResultsValue];
+
 		// Ensure the page supplied is within the appropriate limits
 		if (contentPage <= 0)
 			contentPage = 1;
-		else if (contentPage > 1 && (NSInteger)(contentPage - 1) * [prefs integerForKey:SPLimitResultsValue] >= maxNumRows)
+		else if (contentPage > 1 && (NSInteger)(contentPage - 1) * pageSize >= maxNumRows)
 			contentPage = ceilf((CGFloat)maxNumRows / [prefs floatForKey:SPLimitResultsValue]);
 
 		// If the result set is from a late page, take a copy of the string to allow resetting limit
 		// if no results are found
 		if (contentPage > 1) {
-			queryStringBeforeLimit = [NSString stringWithString:queryString];
+			queryStringBeforeLimit = orderByString ? [queryString stringByAppendingString:orderByString] : [NSString stringWithString:queryString];
+		}
+
+		if (keysetColumns) {
+			NSString *queryBase = orderByString ? [queryString stringByAppendingString:orderByString] : queryString;
+
+			// Boundaries recorded for a different filter or sort order can't be used
+			if (!keysetQueryBase || ![keysetQueryBase isEqualToString:queryBase]) {
+				[keysetPageBoundaries removeAllObjects];
+				if (keysetQueryBase) [keysetQueryBase release];
+				keysetQueryBase = [queryBase copy];
+			}
 		}
 
-		// Append the limit settings
-		[queryString appendFormat:@" LIMIT %ld,%ld", (long)((contentPage-1)*[prefs integerForKey:SPLimitResultsValue]), (long)[prefs integerForKey:SPLimitResultsValue]];
+		// Build the query for the page, with the limit settings
+		selectClause = [queryString substringToIndex:whereClauseStart];
+		[queryString setString:[self _queryForPage:contentPage selectClause:selectClause filter:filterString orderBy:orderByString keyColumns:keysetColumns]];
 
 		// Update the approximate count of the rows to load
-		rowsToLoad = rowsToLoad - (contentPage-1)*[prefs integerForKey:SPLimitResultsValue];
-		if (rowsToLoad > [prefs integerForKey:SPLimitResultsValue]) rowsToLoad = [prefs integerForKey:SPLimitResultsValue];
+		rowsToLoad = rowsToLoad - (contentPage-1)*pageSize;
+		if (rowsToLoad > pageSize) rowsToLoad = pageSize;
+	}
+	else if (orderByString) {
+		[queryString appendString:orderByString];
 	}
 
 	// If within a task, allow this query to be cancelled
@@ -834,7 +980,24 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	// Perform and process the query
 	[tableContentView performSelectorOnMainThread:@selector(noteNumberOfRowsChanged) withObject:nil waitUntilDone:YES];
 	[self setUsedQuery:queryString];
-	resultStore = [[mySQLConnection resultStoreFromQueryString:queryString] retain];
+	if (loadVirtually) {
+		resultStore = nil;
+		[self _loadVirtualTableValuesWithQuery:queryStringBeforeLimit orderBy:orderByString keyColumns:keysetColumns];
+		queryStringBeforeLimit = nil;
+	} else {
+
+		// Use the page if it has been prefetched, or is being prefetched
+		if (selectClause) resultStore = [[pagePrefetcher prefetchedResultStoreForQuery:queryString inDatabase:[tableDocumentInstance database]] retain];
+
+		// Otherwise reuse the last result of the same query if the table is unchanged since
+		if (!resultStore) {
+			resultCacheProbe = [self _resultCacheProbeIsSettled:&resultCacheProbeIsSettled];
+			resultStore = [[resultCache resultStoreForQuery:queryString table:selectedTable inDatabase:[tableDocumentInstance database] validationProbe:resultCacheProbe] retain];
+			resultStoreWasCached = !!resultStore;
+		}
+
+		if (!resultStore) resultStore = [[mySQLConnection resultStoreFromQueryString:queryString] retain];
+	}
 
 	// Ensure the number of columns are unchanged; if the column count has changed, abort the load
 	// and queue a full table reload.
@@ -849,6 +1012,13 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	// Process the result into the data store
 	if (!fullTableReloadRequired && resultStore) {
 		[self updateResultStore:resultStore approximateRowCount:rowsToLoad];
+
+		// Keep complete results to show again while the table is unchanged
+		if (!resultStoreWasCached && resultCacheProbeIsSettled && ![mySQLConnection lastQueryWasCancelled] && ![mySQLConnection queryErrored]) {
+			[resultCache cacheResultStore:resultStore forQuery:queryString table:selectedTable inDatabase:[tableDocumentInstance database] validationProbe:resultCacheProbe];
+			resultStoreWasCached = YES;
+		}
+		tableValuesStoreIsCached = resultStoreWasCached;
 	}
 	if (resultStore) [resultStore release];
 
@@ -865,11 +1035,21 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		}
 	}
 
-	if ([mySQLConnection lastQueryWasCancelled] || [mySQLConnection queryErrored])
+	if (!loadVirtually && ([mySQLConnection lastQueryWasCancelled] || [mySQLConnection queryErrored]))
 		isInterruptedLoad = YES;
 	else
 		isInterruptedLoad = NO;
 
+	// Remember the key of the last row of a full page so the next page can be sought directly
+	if (keysetColumns && !fullTableReloadRequired && !isInterruptedLoad && (NSInteger)tableRowsCount == [prefs integerForKey:SPLimitResultsValue]) {
+		[self _storeKeysetBoundaryForPage:contentPage columns:keysetColumns];
+	}
+
+	// Fetch the neighbouring pages in the background, so that paging to them is immediate
+	if (selectClause && !fullTableReloadRequired && !isInterruptedLoad) {
+		[self _prefetchPagesAdjacentToPage:contentPage selectClause:selectClause filter:filterString orderBy:orderByString keyColumns:keysetColumns];
+	}
+
 	// End cancellation ability
 	[tableDocumentInstance disableTaskCancellation];
 
@@ -880,7 +1060,8 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		NSMutableIndexSet *selectionSet = [NSMutableIndexSet indexSet];
 
 		// Currently two types of stored selection are supported: primary keys and direct index sets.
-		if ([[selectionToRestore objectForKey:@"type"] isEqualToString:SPSelectionDetailTypePrimaryKeyed]) {
+		// Virtually loaded rows can't be searched for keys without fetching the entire table.
+		if ([[selectionToRestore objectForKey:@"type"] isEqualToString:SPSelectionDetailTypePrimaryKeyed] && ![tableValues isVirtual]) {
 
 			// Check whether the keys are still present and get their positions
 			BOOL columnsFound = YES;
@@ -948,6 +1129,15 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	// Update the rows count as necessary
 	[self updateNumberOfRows];
 
+	// If an accurate count is now known for a virtually loaded table, use it
+	if (loadVirtually && !maxNumRowsIsEstimate && maxNumRows != (NSInteger)tableRowsCount) {
+		pthread_mutex_lock(&tableValuesLock);
+		[tableValues setVirtualRowCount:maxNumRows];
+		tableRowsCount = [tableValues count];
+		pthread_mutex_unlock(&tableValuesLock);
+		[[tableContentView onMainThread] noteNumberOfRowsChanged];
+	}
+
 	// Set the filter text
 	[self updateCountText];
 
@@ -1000,14 +1190,19 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	NSUInteger dataColumnsCount = [dataColumns count];
 	tableLoadTargetRowCount = targetRowCount;
 
-	// Update the data storage, updating the current store if appropriate
+	// Prefetched pages and cached results are already downloaded
+	BOOL resultStoreIsDownloaded = [theResultStore dataDownloaded];
+
+	// Update the data storage, updating the current store if appropriate; cached stores
+	// mustn't have their data taken over, as they may be shown again
 	pthread_mutex_lock(&tableValuesLock);
 	tableRowsCount = 0;
-	[tableValues setDataStorage:theResultStore updatingExisting:!![tableValues count]];
+	[tableValues setDataStorage:theResultStore updatingExisting:(!resultStoreIsDownloaded && !tableValuesStoreIsCached && [tableValues count])];
+	tableValuesStoreIsCached = NO;
 	pthread_mutex_unlock(&tableValuesLock);
 
 	// Start the data downloading
-	[theResultStore startDownload];
+	if (!resultStoreIsDownloaded) [theResultStore startDownload];
 
 #ifndef SP_CODA
 	NSProgressIndicator *dataLoadingIndicator = [tableDocumentInstance valueForKey:@"queryProgressBar"];
@@ -1023,6 +1218,9 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 				[tableValues setColumnAsUnloaded:i];
 			}
 		}
+
+		// Unloaded cells are fetched by primary key as they are shown
+		[cellFetcher setTable:selectedTable inDatabase:[tableDocumentInstance database] keyColumns:[self _cellFetcherKeyColumns]];
 	}
 #endif
 
@@ -1309,7 +1507,10 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	// If both a filter and limit is active, display full string
 	} else {
 		NSUInteger limitStart = (contentPage-1)*[prefs integerForKey:SPLimitResultsValue] + 1;
-		[countString appendFormat:NSLocalizedString(@"Rows %@ - %@ from filtered matches", @"text showing how many rows are in the limited filter match"), [numberFormatter stringFromNumber:[NSNumber numberWithUnsignedInteger:limitStart]], [numberFormatter stringFromNumber:[NSNumber numberWithUnsignedInteger:(limitStart+tableRowsCount-1)]]];
+		if (filteredRowCountClause)
+			[countString appendFormat:NSLocalizedString(@"Rows %@ - %@ of %@%@ filtered matches", @"text showing how many rows are in the limited filter match, out of a count of all matches"), [numberFormatter stringFromNumber:[NSNumber numberWithUnsignedInteger:limitStart]], [numberFormatter stringFromNumber:[NSNumber numberWithUnsignedInteger:(limitStart+tableRowsCount-1)]], maxNumRowsIsEstimate?@"~":@"", maxRowsString];
+		else
+			[countString appendFormat:NSLocalizedString(@"Rows %@ - %@ from filtered matches", @"text showing how many rows are in the limited filter match"), [numberFormatter stringFromNumber:[NSNumber numberWithUnsignedInteger:limitStart]], [numberFormatter stringFromNumber:[NSNumber numberWithUnsignedInteger:(limitStart+tableRowsCount-1)]]];
 	}
 
 	// If rows are selected, append selection count
@@ -1451,6 +1652,10 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	// Clear the table data column cache and status (including counts)
 	[tableDataInstance resetColumnData];
 	[tableDataInstance resetStatusData];
+	[[tableDataInstance rowCounter] invalidateCountsForTable:selectedTable inDatabase:[tableDocumentInstance database]];
+	[pagePrefetcher invalidate];
+	[cellFetcher invalidate];
+	[resultCache invalidateTable:selectedTable inDatabase:[tableDocumentInstance database]];
 
 	// Load the table's data
 	[self loadTable:[tablesListInstance tableName]];
@@ -1514,6 +1719,10 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		[sender becomeFirstResponder];
 	}
 
+	// Where the whole table is already loaded, filter the rows in memory rather than scanning
+	// the table again
+	if (!senderIsPaginationButton && [self _filterTableValuesLocally]) return;
+
 #ifndef SP_CODA
 	[self setPaginationViewVisibility:FALSE];
 #endif
@@ -1539,6 +1748,9 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		taskString = [NSString stringWithFormat:NSLocalizedString(@"Loading page %lu...", @"Loading table page task string"), (unsigned long)contentPage];
 	}
 
+	// Pages prefetched for the previous filter settings are no longer needed
+	if (!senderIsPaginationButton) [pagePrefetcher invalidate];
+
 	[tableDocumentInstance startTaskWithDescription:taskString];
 
 	if ([NSThread isMainThread]) {
@@ -1685,6 +1897,23 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		[[tableContentView onMainThread] setIndicatorImage:nil inTableColumn:tableColumn];
 	}
 	
+	// When the whole table is already held, sort the rows in memory rather than querying again
+	if (sortCol && !isLimited && (!isFiltered || localFilter) && !isInterruptedLoad && cqColumnDefinition && ![tableValues isVirtual]) {
+		BOOL sortedInMemory;
+
+		pthread_mutex_lock(&tableValuesLock);
+		sortedInMemory = [self _restoreLocalRowOrder];
+		pthread_mutex_unlock(&tableValuesLock);
+
+		if (sortedInMemory) {
+			[[tableContentView onMainThread] selectRowIndexes:[NSIndexSet indexSet] byExtendingSelection:NO];
+			[[tableContentView onMainThread] reloadData];
+			[tableDocumentInstance endTask];
+			[sortPool drain];
+			return;
+		}
+	}
+
 	// Update data using the new sort order
 	previousTableRowsCount = tableRowsCount;
 	[self setSelectionToRestore:[self selectionDetailsAllowingIndexSelection:NO]];
@@ -1772,6 +2001,177 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 #endif
 }
 
+/**
+ * Returns the indexes of the data columns that can be used to page through the table by seeking
+ * to a key rather than by offset, or nil if there are none.  The columns are the sort column, if
+ * any, followed by the primary key columns.  All must be present in the loaded data with their
+ * exact values, and the sort column must not allow NULLs.  ENUM and SET columns are excluded
+ * as they sort by member index but compare against a string value as strings.
+ */
+- (NSArray *)_keysetColumnIndexes
+{
+	NSArray *primaryKeyColumnNames = [tableDataInstance primaryKeyColumnNames];
+	if (![primaryKeyColumnNames count]) return nil;
+
+	NSMutableArray *columnIndexes = [NSMutableArray arrayWithCapacity:[primaryKeyColumnNames count] + 1];
+	NSArray *unusableTypeGroupings = [NSArray arrayWithObjects:@"float", @"bit", @"enum", @"geometry", @"blobdata", @"textdata", nil];
+
+	if (sortCol) {
+		NSDictionary *sortColumn = [dataColumns objectAtIndex:[sortCol integerValue]];
+
+		if ([[sortColumn objectForKey:@"null"] boolValue] && ![primaryKeyColumnNames containsObject:[sortColumn objectForKey:@"name"]]) return nil;
+
+		[columnIndexes addObject:sortCol];
+	}
+
+	for (NSString *primaryKeyColumnName in primaryKeyColumnNames) {
+		NSUInteger columnIndex = NSNotFound;
+
+		for (NSUInteger i = 0; i < [dataColumns count]; i++) {
+			if ([[[dataColumns objectAtIndex:i] objectForKey:@"name"] isEqualToString:primaryKeyColumnName]) {
+				columnIndex = i;
+				break;
+			}
+		}
+
+		if (columnIndex == NSNotFound) return nil;
+		if (sortCol && (NSInteger)columnIndex == [sortCol integerValue]) continue;
+
+		[columnIndexes addObject:[NSNumber numberWithUnsignedInteger:columnIndex]];
+	}
+
+	for (NSNumber *columnIndex in columnIndexes) {
+		if ([unusableTypeGroupings containsObject:[[dataColumns objectAtIndex:[columnIndex unsignedIntegerValue]] objectForKey:@"typegrouping"]]) return nil;
+	}
+
+	return columnIndexes;
+}
+
+/**
+ * Returns the ORDER BY clause for paging by the supplied key columns, all ordered in the
+ * direction of the current sort.
+ */
+- (NSString *)_keysetOrderByClauseForColumns:(NSArray *)columnIndexes
+{
+	NSMutableArray *orderByFields = [NSMutableArray arrayWithCapacity:[columnIndexes count]];
+
+	for (NSNumber *columnIndex in columnIndexes) {
+		[orderByFields addObject:[NSString stringWithFormat:@"%@%@", [[[dataColumns objectAtIndex:[columnIndex unsignedIntegerValue]] objectForKey:@"name"] backtickQuotedString], isDesc ? @" DESC" : @""]];
+	}
+
+	return [NSString stringWithFormat:@" ORDER BY %@", [orderByFields componentsJoinedByString:@", "]];
+}
+
+/**
+ * Returns a WHERE condition matching the rows which follow the supplied key values in the
+ * current sort order, or nil if the values can't be used.
+ * The row comparison is expanded to (a > x OR (a = x AND b > y)) as older MySQL versions don't
+ * use indexes for row constructor comparisons.
+ */
+- (NSString *)_keysetConditionForColumns:(NSArray *)columnIndexes afterValues:(NSArray *)keyValues
+{
+	if ([keyValues count] != [columnIndexes count]) return nil;
+
+	NSString *comparison = isDesc ? @"<" : @">";
+	NSMutableString *condition = [NSMutableString string];
+	NSUInteger openParentheses = 0;
+
+	for (NSUInteger i = 0; i < [columnIndexes count]; i++) {
+		NSString *fieldName = [[[dataColumns objectAtIndex:[[columnIndexes objectAtIndex:i] unsignedIntegerValue]] objectForKey:@"name"] backtickQuotedString];
+		id keyValue = [keyValues objectAtIndex:i];
+		NSString *escapedValue;
+
+		if ([keyValue isNSNull]) return nil;
+		else if ([keyValue isKindOfClass:[NSData class]]) escapedValue = [mySQLConnection escapeAndQuoteData:keyValue];
+		else escapedValue = [mySQLConnection escapeAndQuoteString:[keyValue description]];
+
+		if (i == [columnIndexes count] - 1) {
+			[condition appendFormat:@"%@ %@ %@", fieldName, comparison, escapedValue];
+		} else {
+			[condition appendFormat:@"(%@ %@ %@ OR (%@ = %@ AND ", fieldName, comparison, escapedValue, fieldName, escapedValue];
+			openParentheses += 2;
+		}
+	}
+
+	while (openParentheses--) [condition appendString:@")"];
+
+	return condition;
+}
+
+/**
+ * Records the key values of the last loaded row as the boundary of the supplied page.
+ */
+- (void)_storeKeysetBoundaryForPage:(NSUInteger)page columns:(NSArray *)columnIndexes
+{
+	if (!tableRowsCount) return;
+
+	NSMutableArray *keyValues = [NSMutableArray arrayWithCapacity:[columnIndexes count]];
+
+	pthread_mutex_lock(&tableValuesLock);
+	for (NSNumber *columnIndex in columnIndexes) {
+		id keyValue = SPDataStorageObjectAtRowAndColumn(tableValues, tableRowsCount - 1, [columnIndex unsignedIntegerValue]);
+		[keyValues addObject:keyValue ? keyValue : [NSNull null]];
+	}
+	pthread_mutex_unlock(&tableValuesLock);
+
+	[keysetPageBoundaries setObject:keyValues forKey:[NSNumber numberWithUnsignedInteger:page]];
+}
+
+/**
+ * Returns the query for a page of the table, from the SELECT ... FROM clause, any filter and
+ * ORDER BY clause, and the key columns if the table is paged by key.  Seeks past the last key
+ * of the closest earlier page whose boundary is known, only skipping any pages in between by
+ * offset.
+ */
+- (NSString *)_queryForPage:(NSUInteger)page selectClause:(NSString *)selectClause filter:(NSString *)filterString orderBy:(NSString *)orderByString keyColumns:(NSArray *)keyColumns
+{
+	NSInteger pageSize = [prefs integerForKey:SPLimitResultsValue];
+	NSInteger limitOffset = (page - 1) * pageSize;
+	NSMutableString *pageQuery = [NSMutableString stringWithString:selectClause];
+	NSString *seekCondition = nil;
+
+	if (keyColumns) {
+		for (NSUInteger boundaryPage = page - 1; boundaryPage > 0; boundaryPage--) {
+			NSArray *boundary = [keysetPageBoundaries objectForKey:[NSNumber numberWithUnsignedInteger:boundaryPage]];
+			if (!boundary) continue;
+
+			seekCondition = [self _keysetConditionForColumns:keyColumns afterValues:boundary];
+			if (seekCondition) limitOffset = (page - 1 - boundaryPage) * pageSize;
+			break;
+		}
+	}
+
+	if (filterString && seekCondition) {
+		[pageQuery appendFormat:@" WHERE (%@) AND %@", filterString, seekCondition];
+	} else if (filterString || seekCondition) {
+		[pageQuery appendFormat:@" WHERE %@", filterString ? filterString : seekCondition];
+	}
+
+	if (orderByString) [pageQuery appendString:orderByString];
+
+	[pageQuery appendFormat:@" LIMIT %ld,%ld", (long)limitOffset, (long)pageSize];
+
+	return pageQuery;
+}
+
+/**
+ * Queue the next page, if the current page is full, and the previous page to be fetched in
+ * the background on the page prefetcher's connection.
+ */
+- (void)_prefetchPagesAdjacentToPage:(NSUInteger)page selectClause:(NSString *)selectClause filter:(NSString *)filterString orderBy:(NSString *)orderByString keyColumns:(NSArray *)keyColumns
+{
+	NSMutableArray *pageQueries = [NSMutableArray arrayWithCapacity:2];
+
+	if ((NSInteger)tableRowsCount == [prefs integerForKey:SPLimitResultsValue]) {
+		[pageQueries addObject:[self _queryForPage:page + 1 selectClause:selectClause filter:filterString orderBy:orderByString keyColumns:keyColumns]];
+	}
+	if (page > 1) {
+		[pageQueries addObject:[self _queryForPage:page - 1 selectClause:selectClause filter:filterString orderBy:orderByString keyColumns:keyColumns]];
+	}
+
+	[pagePrefetcher prefetchQueries:pageQueries inDatabase:[tableDocumentInstance database]];
+}
+
 /**
  * Update the state of the pagination buttons and text.
  * This function is not thread-safe and should be called on the main thread.
@@ -1813,6 +2213,368 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 #endif
 }
 
+#pragma mark -
+#pragma mark Local filtering
+
+/**
+ * Returns a filter which can be evaluated over the loaded rows for the current settings of
+ * the content filter bar, or nil if the filter has to be run by the server.
+ */
+- (SPDataStorageFilter *)_localFilterForCurrentSettings
+{
+	NSArray *filters = [contentFilters objectForKey:compareType];
+	NSInteger filterIndex = [[compareField selectedItem] tag];
+	NSArray *arguments;
+
+	if (!filters || filterIndex < 0 || filterIndex >= (NSInteger)[filters count]) return nil;
+
+	NSDictionary *filter = [filters objectAtIndex:filterIndex];
+	NSString *clause = [filter objectForKey:@"Clause"];
+	if (![clause length] || [filter objectForKey:@"SuppressLeadingFieldPlaceholder"]) return nil;
+
+	NSUInteger columnIndex = [[dataColumns valueForKey:@"name"] indexOfObject:[fieldField titleOfSelectedItem]];
+	if (columnIndex == NSNotFound) return nil;
+
+	NSUInteger numberOfArguments = [[filter objectForKey:@"NumberOfArguments"] integerValue];
+	if (numberOfArguments == 2) {
+		arguments = [NSArray arrayWithObjects:[firstBetweenField stringValue], [secondBetweenField stringValue], nil];
+	} else if (numberOfArguments == 1) {
+		arguments = [NSArray arrayWithObject:[argumentField stringValue]];
+	} else {
+		arguments = [NSArray array];
+	}
+
+	// As for the server's filter, holding a modifier key makes a $BINARY clause case sensitive
+	BOOL caseSensitive = ([clause isMatchedByRegex:@"(?<!\\\\)\\$BINARY "] && ([[NSApp currentEvent] modifierFlags] & (NSShiftKeyMask|NSControlKeyMask|NSAlternateKeyMask|NSCommandKeyMask)));
+
+	return [SPDataStorageFilter filterWithClause:clause columnIndex:columnIndex arguments:arguments caseSensitive:caseSensitive];
+}
+
+/**
+ * Apply the current content filter to the loaded rows, where they make up the whole table,
+ * rather than querying the server.  A filter narrowing the one already applied - such as
+ * further text typed into a "contains" search - only looks at the rows currently shown.
+ * Returns NO if the table has to be filtered by the server instead.
+ */
+- (BOOL)_filterTableValuesLocally
+{
+	SPDataStorageFilter *filter = nil;
+	BOOL filtered;
+
+#ifndef SP_CODA
+	if (activeFilter != 0) return NO;
+#endif
+
+	// The loaded rows must be the whole table, either unfiltered or filtered locally
+	if (isLimited || isInterruptedLoad || (isFiltered && !localFilter) || !cqColumnDefinition || [tableValues isVirtual] || ![tableValues dataDownloaded]) return NO;
+
+	// Without a filter, show all the rows again; if none were hidden, reload as before
+	if ([self tableFilterString]) {
+		filter = [self _localFilterForCurrentSettings];
+		if (!filter) return NO;
+	} else if (!localFilter) {
+		return NO;
+	}
+
+	pthread_mutex_lock(&tableValuesLock);
+	if (filter && [filter narrowsFilter:localFilter]) {
+		filtered = [tableValues restrictRowsToMatchesOfFilter:filter columnDefinitions:cqColumnDefinition stringEncoding:[mySQLConnection stringEncoding]];
+	} else {
+		if (localFilter) [localFilter release], localFilter = nil;
+		filtered = [self _restoreLocalRowOrder];
+		if (filtered && filter) {
+			filtered = [tableValues restrictRowsToMatchesOfFilter:filter columnDefinitions:cqColumnDefinition stringEncoding:[mySQLConnection stringEncoding]];
+		}
+	}
+	pthread_mutex_unlock(&tableValuesLock);
+
+	// If the rows couldn't be filtered, the server's filtered result replaces them
+	if (!filtered) return NO;
+
+	if (localFilter) [localFilter release];
+	localFilter = [filter retain];
+	isFiltered = (filter != nil);
+	tableRowsCount = [tableValues count];
+
+#ifndef SP_CODA
+	[spHistoryControllerInstance updateHistoryEntries];
+#endif
+
+	[tableContentView deselectAll:self];
+	[tableContentView reloadData];
+	[tableContentView scrollPoint:NSMakePoint(0.0f, 0.0f)];
+	[self updateCountText];
+
+	return YES;
+}
+
+/**
+ * Show all the loaded rows in the current sort order, then reapply any local filter.  The
+ * table values lock must be held.  Returns NO if either step can't be performed in memory.
+ */
+- (BOOL)_restoreLocalRowOrder
+{
+	[tableValues clearRowIndexMap];
+
+	if (sortCol && ![tableValues sortRowsByColumns:[NSArray arrayWithObject:sortCol] descending:[NSArray arrayWithObject:[NSNumber numberWithBool:isDesc]] columnDefinitions:cqColumnDefinition stringEncoding:[mySQLConnection stringEncoding]]) {
+		return NO;
+	}
+
+	if (localFilter) {
+		return [tableValues restrictRowsToMatchesOfFilter:localFilter columnDefinitions:cqColumnDefinition stringEncoding:[mySQLConnection stringEncoding]];
+	}
+
+	return YES;
+}
+
+#pragma mark -
+#pragma mark Virtual loading
+
+/**
+ * Sets up the table values store to represent the whole table without loading it, so that
+ * blocks of rows are only fetched as they are displayed.  Blocks are located by the supplied
+ * key columns, which the supplied ORDER BY clause must sort by.
+ */
+- (void)_loadVirtualTableValuesWithQuery:(NSString *)queryBase orderBy:(NSString *)orderBy keyColumns:(NSArray *)keyColumns
+{
+	NSUInteger i;
+
+	// Discard any blocks queued or boundaries found for a previous load
+	pthread_mutex_lock(&virtualBlockQueueLock);
+	virtualLoadGeneration++;
+	[virtualBlockQueue removeAllIndexes];
+	[virtualBlockBoundaries removeAllObjects];
+	[virtualBlocksWithBoundaries removeAllIndexes];
+	if (virtualQueryBase) [virtualQueryBase release];
+	virtualQueryBase = [queryBase copy];
+	if (virtualQueryOrderBy) [virtualQueryOrderBy release];
+	virtualQueryOrderBy = [orderBy copy];
+	if (virtualKeyColumns) [virtualKeyColumns release];
+	virtualKeyColumns = [keyColumns retain];
+	if (virtualDatabase) [virtualDatabase release];
+	virtualDatabase = [[tableDocumentInstance database] copy];
+	virtualMostRecentBlock = 0;
+	pthread_mutex_unlock(&virtualBlockQueueLock);
+
+	// Size the store by the estimated row count; this is corrected once the end is fetched
+	pthread_mutex_lock(&tableValuesLock);
+	[tableValues setVirtualRowCount:maxNumRows columnCount:[dataColumns count] blockSize:SPTableContentVirtualBlockSize loader:self];
+#ifndef SP_CODA
+	if ([prefs boolForKey:SPLoadBlobsAsNeeded]) {
+		for (i = 0; i < [dataColumns count]; i++) {
+			if ([tableDataInstance columnIsBlobOrText:[NSArrayObjectAtIndex(dataColumns, i) objectForKey:@"name"]]) {
+				[tableValues setColumnAsUnloaded:i];
+			}
+		}
+
+		[cellFetcher setTable:selectedTable inDatabase:[tableDocumentInstance database] keyColumns:[self _cellFetcherKeyColumns]];
+	}
+#endif
+	tableRowsCount = [tableValues count];
+	pthread_mutex_unlock(&tableValuesLock);
+
+	virtualColumnsNeedSizing = YES;
+
+	[[tableContentView onMainThread] noteNumberOfRowsChanged];
+}
+
+/**
+ * Returns the query to fetch the supplied block of a virtually loaded table.  Where the last
+ * key of an earlier block is known, the query seeks past it and only skips any blocks in between
+ * by offset.  Should be called with the virtual block queue lock held.
+ */
+- (NSString *)_queryForVirtualBlock:(NSUInteger)blockIndex
+{
+	NSMutableString *blockQuery = [NSMutableString stringWithString:virtualQueryBase];
+	NSUInteger blockOffset = blockIndex * SPTableContentVirtualBlockSize;
+	NSUInteger boundaryBlock = [virtualBlocksWithBoundaries indexLessThanIndex:blockIndex];
+
+	if (boundaryBlock != NSNotFound) {
+		NSString *seekCondition = [self _keysetConditionForColumns:virtualKeyColumns afterValues:[virtualBlockBoundaries objectForKey:[NSNumber numberWithUnsignedInteger:boundaryBlock]]];
+		if (seekCondition) {
+			[blockQuery appendFormat:@" WHERE %@", seekCondition];
+			blockOffset = (blockIndex - boundaryBlock - 1) * SPTableContentVirtualBlockSize;
+		}
+	}
+
+	[blockQuery appendString:virtualQueryOrderBy];
+	[blockQuery appendFormat:@" LIMIT %lu,%lu", (unsigned long)blockOffset, (unsigned long)SPTableContentVirtualBlockSize];
+
+	return blockQuery;
+}
+
+/**
+ * SPDataStorageVirtualLoader delegate method; queues the block for loading, starting the
+ * background loader if it isn't already running.
+ */
+- (void)dataStorage:(SPDataStorage *)dataStorage needsVirtualBlock:(NSUInteger)blockIndex rowRange:(NSRange)rowRange
+{
+	BOOL startLoader;
+
+	pthread_mutex_lock(&virtualBlockQueueLock);
+	[virtualBlockQueue addIndex:blockIndex];
+	virtualMostRecentBlock = blockIndex;
+	startLoader = !virtualLoaderRunning;
+	virtualLoaderRunning = YES;
+	pthread_mutex_unlock(&virtualBlockQueueLock);
+
+	if (startLoader) {
+		[NSThread detachNewThreadWithName:@"SPTableContent virtual block load task" target:self selector:@selector(_loadVirtualBlocksTask) object:nil];
+	}
+}
+
+/**
+ * Fetches queued blocks of a virtually loaded table until the queue is empty, passing each
+ * to the main thread to install.  Blocks are fetched on a pooled connection, so that the
+ * main connection stays free while scrolling.  The block most recently requested is
+ * always fetched first, as the earlier requests may already have been scrolled past.
+ */
+- (void)_loadVirtualBlocksTask
+{
+	NSAutoreleasePool *loadPool = [[NSAutoreleasePool alloc] init];
+
+	while (1) {
+		NSAutoreleasePool *blockPool = [[NSAutoreleasePool alloc] init];
+		NSUInteger blockIndex, generation, i;
+		NSArray *keyColumns;
+		NSString *blockQuery, *database;
+		SPMySQLConnection *blockConnection;
+		SPMySQLStreamingResultStore *blockStore = nil;
+
+		pthread_mutex_lock(&virtualBlockQueueLock);
+		if (![virtualBlockQueue count]) {
+			virtualLoaderRunning = NO;
+			pthread_mutex_unlock(&virtualBlockQueueLock);
+			[blockPool drain];
+			break;
+		}
+		blockIndex = [virtualBlockQueue containsIndex:virtualMostRecentBlock] ? virtualMostRecentBlock : [virtualBlockQueue lastIndex];
+		[virtualBlockQueue removeIndex:blockIndex];
+		generation = virtualLoadGeneration;
+		keyColumns = [[virtualKeyColumns retain] autorelease];
+		database = [[virtualDatabase retain] autorelease];
+		blockQuery = [self _queryForVirtualBlock:blockIndex];
+		pthread_mutex_unlock(&virtualBlockQueueLock);
+
+		blockConnection = [[tableDocumentInstance connectionPool] checkOutConnectionForUser:self database:database];
+		if (blockConnection) {
+			blockStore = [blockConnection resultStoreFromQueryString:blockQuery];
+			if (blockStore) {
+				[blockStore setDelegate:self];
+				[blockStore startDownload];
+
+				// Sleep until the store reports that its download has finished
+				pthread_mutex_lock(&virtualBlockQueueLock);
+				while (![blockStore dataDownloaded]) pthread_cond_wait(&virtualBlockDownloadCondition, &virtualBlockQueueLock);
+				pthread_mutex_unlock(&virtualBlockQueueLock);
+				[blockStore setDelegate:nil];
+			}
+			if ([blockConnection queryErrored] || [blockConnection lastQueryWasCancelled]) blockStore = nil;
+			[[tableDocumentInstance connectionPool] checkInConnection:blockConnection];
+		}
+		if (blockStore) {
+			// Remember the key of the last row of a full block so following blocks can be sought
+			if ([blockStore numberOfRows] == SPTableContentVirtualBlockSize) {
+				NSMutableArray *keyValues = [NSMutableArray arrayWithCapacity:[keyColumns count]];
+				for (i = 0; i < [keyColumns count]; i++) {
+					id keyValue = SPMySQLResultStoreObjectAtRowAndColumn(blockStore, SPTableContentVirtualBlockSize - 1, [[keyColumns objectAtIndex:i] unsignedIntegerValue]);
+					[keyValues addObject:keyValue ? keyValue : [NSNull null]];
+				}
+
+				pthread_mutex_lock(&virtualBlockQueueLock);
+				if (generation == virtualLoadGeneration) {
+					[virtualBlockBoundaries setObject:keyValues forKey:[NSNumber numberWithUnsignedInteger:blockIndex]];
+					[virtualBlocksWithBoundaries addIndex:blockIndex];
+				}
+				pthread_mutex_unlock(&virtualBlockQueueLock);
+			}
+		}
+
+		[self performSelectorOnMainThread:@selector(_installVirtualBlock:) withObject:[NSArray arrayWithObjects:[NSNumber numberWithUnsignedInteger:blockIndex], [NSNumber numberWithUnsignedInteger:generation], blockStore ? (id)blockStore : (id)[NSNull null], nil] waitUntilDone:NO];
+
+		[blockPool drain];
+	}
+
+	[loadPool drain];
+}
+
+/**
+ * Called on the download thread when a virtual block's result store has
+ * finished loading; wakes the loader thread waiting on that store.
+ */
+- (void)resultStoreDidFinishLoadingData:(SPMySQLStreamingResultStore *)resultStore
+{
+	pthread_mutex_lock(&virtualBlockQueueLock);
+	pthread_cond_broadcast(&virtualBlockDownloadCondition);
+	pthread_mutex_unlock(&virtualBlockQueueLock);
+}
+
+/**
+ * Installs a fetched block into the virtually loaded table values store, correcting the
+ * estimated row count if the block shows where the table ends.  Blocks fetched for a
+ * previous load are discarded.  Should be called on the main thread.
+ */
+- (void)_installVirtualBlock:(NSArray *)blockDetails
+{
+	NSUInteger blockIndex = [[blockDetails objectAtIndex:0] unsignedIntegerValue];
+	id blockStore = [blockDetails objectAtIndex:2];
+	BOOL blockIsCurrent;
+
+	pthread_mutex_lock(&virtualBlockQueueLock);
+	blockIsCurrent = ([[blockDetails objectAtIndex:1] unsignedIntegerValue] == virtualLoadGeneration);
+	pthread_mutex_unlock(&virtualBlockQueueLock);
+
+	if (!blockIsCurrent || ![tableValues isVirtual]) return;
+
+	// Clear the request for a failed block, so that it is fetched again when next displayed
+	if ([blockStore isNSNull]) {
+		[tableValues setResultStore:nil forVirtualBlock:blockIndex];
+		return;
+	}
+
+	NSUInteger blockRowCount = (NSUInteger)[blockStore numberOfRows];
+	NSUInteger blockStart = blockIndex * SPTableContentVirtualBlockSize;
+	NSUInteger correctedRowCount = tableRowsCount;
+
+	[tableValues setResultStore:blockStore forVirtualBlock:blockIndex];
+
+	// A short block marks the end of the table, while a full final block means the estimate
+	// was too low.  Leave the count alone while a new row is being edited at the end.
+	if (!isEditingNewRow) {
+		if (blockRowCount < SPTableContentVirtualBlockSize && (blockRowCount || !blockIndex)) {
+			correctedRowCount = blockStart + blockRowCount;
+			maxNumRowsIsEstimate = NO;
+		} else if (!blockRowCount) {
+			correctedRowCount = MIN(correctedRowCount, blockStart);
+		} else if (blockStart + blockRowCount >= tableRowsCount) {
+			correctedRowCount = blockStart + blockRowCount + SPTableContentVirtualBlockSize;
+		}
+
+		if (correctedRowCount != tableRowsCount) {
+			pthread_mutex_lock(&tableValuesLock);
+			[tableValues setVirtualRowCount:correctedRowCount];
+			tableRowsCount = [tableValues count];
+			pthread_mutex_unlock(&tableValuesLock);
+			maxNumRows = tableRowsCount;
+			[tableDataInstance setStatusValue:[NSString stringWithFormat:@"%ld", (long)maxNumRows] forKey:@"Rows"];
+			[tableDataInstance setStatusValue:maxNumRowsIsEstimate?@"n":@"y" forKey:@"RowsCountAccurate"];
+			[tableContentView noteNumberOfRowsChanged];
+			[self updateCountText];
+		}
+	}
+
+	// Cache the column definitions for editing views from the first block fetched
+	if (!cqColumnDefinition) cqColumnDefinition = [[blockStore fieldDefinitions] retain];
+
+	// Size the columns to the first rows once they're available
+	if (virtualColumnsNeedSizing && !blockIndex) {
+		virtualColumnsNeedSizing = NO;
+		[self autosizeColumns];
+	}
+
+	[tableContentView setNeedsDisplay:YES];
+}
+
 #pragma mark -
 #pragma mark Edit methods
 
@@ -2005,13 +2767,15 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		}
 	}
 
-	// Insert the copied row
-	[tableValues insertRowContents:tempRow atIndex:[tableContentView selectedRow] + 1];
+	// Insert the copied row; virtually loaded tables can only have rows added at the end
+	NSUInteger duplicateRowIndex = [tableValues isVirtual] ? tableRowsCount : (NSUInteger)[tableContentView selectedRow] + 1;
+	[tableValues insertRowContents:tempRow atIndex:duplicateRowIndex];
 	tableRowsCount++;
 
 	// Select row and go in edit mode
 	[tableContentView reloadData];
-	[tableContentView selectRowIndexes:[NSIndexSet indexSetWithIndex:[tableContentView selectedRow] + 1] byExtendingSelection:NO];
+	[tableContentView selectRowIndexes:[NSIndexSet indexSetWithIndex:duplicateRowIndex] byExtendingSelection:NO];
+	[tableContentView scrollRowToVisible:duplicateRowIndex];
 	
 	isEditingRow = YES;
 	isEditingNewRow = YES;
@@ -2118,6 +2882,10 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 			if (isEditingRow) [self cancelRowEditing];
 
 			[mySQLConnection queryString:[NSString stringWithFormat:@"DELETE FROM %@", [selectedTable backtickQuotedString]]];
+			[[tableDataInstance rowCounter] invalidateCountsForTable:selectedTable inDatabase:[tableDocumentInstance database]];
+			[pagePrefetcher invalidate];
+			[cellFetcher invalidate];
+			[resultCache invalidateTable:selectedTable inDatabase:[tableDocumentInstance database]];
 			if ( ![mySQLConnection queryErrored] ) {
 				maxNumRows = 0;
 				tableRowsCount = 0;
@@ -2174,6 +2942,12 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 			NSInteger affectedRows = 0;
 			errors = 0;
 
+			// Any row counts or prefetched pages, cells and results for the table will no longer apply
+			[[tableDataInstance rowCounter] invalidateCountsForTable:selectedTable inDatabase:[tableDocumentInstance database]];
+			[pagePrefetcher invalidate];
+			[cellFetcher invalidate];
+			[resultCache invalidateTable:selectedTable inDatabase:[tableDocumentInstance database]];
+
 			// Disable updating of the Console Log window for large number of queries
 			// to speed the deletion
 			consoleUpdateStatus = [[SPQueryController sharedQueryController] allowConsoleUpdate];
@@ -2363,8 +3137,8 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 						   afterDelay:0.3];
 			}
 
-			// Refresh table content
-			if (errors || reloadAfterRemovingRow) {
+			// Refresh table content; rows can't be removed from virtually loaded tables in place
+			if (errors || reloadAfterRemovingRow || [tableValues isVirtual]) {
 				previousTableRowsCount = tableRowsCount;
 				[self loadTableValues];
 			} 
@@ -2530,6 +3304,33 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	return currentResult;
 }
 
+/**
+ * Fetches the values of a data column which wasn't loaded with the table rows, for the
+ * supplied rows, identifying the rows by primary key.  Returns a dictionary of the values
+ * keyed by row index, from which rows that couldn't be fetched are missing.
+ */
+- (NSDictionary *)valuesForUnloadedColumn:(NSUInteger)columnIndex inRows:(NSIndexSet *)rowIndexes
+{
+	NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:[rowIndexes count]];
+	NSMutableDictionary *rowIndexesByKey = [NSMutableDictionary dictionaryWithCapacity:[rowIndexes count]];
+
+	if (![cellFetcher canFetchCells] || columnIndex >= [dataColumns count]) return values;
+
+	NSUInteger rowIndex = [rowIndexes firstIndex];
+	while (rowIndex != NSNotFound) {
+		NSString *rowKey = [self _rowKeyForLazyFetchAtRow:rowIndex];
+		if (rowKey) [rowIndexesByKey setObject:[NSNumber numberWithUnsignedInteger:rowIndex] forKey:rowKey];
+		rowIndex = [rowIndexes indexGreaterThanIndex:rowIndex];
+	}
+
+	NSDictionary *fetchedValues = [cellFetcher valuesForColumn:[NSArrayObjectAtIndex(dataColumns, columnIndex) objectForKey:@"name"] rowKeys:[rowIndexesByKey allKeys] usingConnection:mySQLConnection];
+	for (NSString *rowKey in fetchedValues) {
+		[values setObject:[fetchedValues objectForKey:rowKey] forKey:[rowIndexesByKey objectForKey:rowKey]];
+	}
+
+	return values;
+}
+
 #pragma mark -
 
 /**
@@ -2539,6 +3340,20 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 {
 	mySQLConnection = theConnection;
 
+	// Pages are prefetched on a connection from the document's pool
+	if (!pagePrefetcher) pagePrefetcher = [[SPTablePagePrefetcher alloc] initWithDelegate:tableDocumentInstance];
+	[pagePrefetcher setConnectionPool:[tableDocumentInstance connectionPool]];
+
+	// Unloaded cells are also fetched on a pooled connection, redrawing the table as they arrive
+	if (!cellFetcher) {
+		cellFetcher = [[SPTableCellFetcher alloc] initWithDelegate:tableDocumentInstance];
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(_cellFetcherDidFetch:)
+													 name:SPTableCellFetcherDidFetchNotification
+												   object:cellFetcher];
+	}
+	[cellFetcher setConnectionPool:[tableDocumentInstance connectionPool]];
+
 	[tableContentView setVerticalMotionCanBeginDrag:NO];
 }
 
@@ -2954,6 +3769,12 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	} else if ( ![mySQLConnection queryErrored] ) {
 		isEditingRow = NO;
 
+		// Any row counts for the table, including filtered counts, and prefetched pages, cells and results may no longer apply
+		[[tableDataInstance rowCounter] invalidateCountsForTable:selectedTable inDatabase:[tableDocumentInstance database]];
+		[pagePrefetcher invalidate];
+		[cellFetcher invalidate];
+		[resultCache invalidateTable:selectedTable inDatabase:[tableDocumentInstance database]];
+
 		// New row created successfully
 		if ( isEditingNewRow ) {
 #ifndef SP_CODA
@@ -3542,6 +4363,11 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 
 	}
 
+	// Any prefetched pages, cells or results may include the old value
+	[pagePrefetcher invalidate];
+	[cellFetcher invalidate];
+	[resultCache invalidateTable:selectedTable inDatabase:[tableDocumentInstance database]];
+
 	// Reload table after each editing due to complex declarations
 	if (isFirstChangeInView) {
 
@@ -4012,44 +4838,80 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 /**
  * Updates the number of rows in the selected table.
  * Attempts to use the fullResult count if available, also updating the
- * table data store; otherwise, uses the table data store if accurate or
- * falls back to a fetch if necessary and set in preferences.
+ * table data store; otherwise, uses the table data store if accurate, or
+ * its estimate while an accurate count is fetched in the background if set
+ * in preferences.
  * The prefs option "fetch accurate row counts" is used as a last resort as
  * it can be very slow on large InnoDB tables which require a full table scan.
+ * When a page of filtered rows is shown, the count is of the rows matching
+ * the filter instead, estimated from the query plan until counted.
  */
 - (void)updateNumberOfRows
 {
 	BOOL checkStatusCount = NO;
+	SPTableRowCounter *rowCounter = [tableDataInstance rowCounter];
+	NSString *database = [tableDocumentInstance database];
 
-	// For unfiltered and non-limited tables, use the result count - and update the status count
-	if (!isLimited && !isFiltered && !isInterruptedLoad) {
+	// For unfiltered and non-limited tables, use the result count - and update the status count.
+	// Virtually loaded tables only hold an estimated count until the end has been fetched.
+	if (!isLimited && !isFiltered && !isInterruptedLoad && ![tableValues isVirtual]) {
 		maxNumRows = tableRowsCount;
 		maxNumRowsIsEstimate = NO;
 		[tableDataInstance setStatusValue:[NSString stringWithFormat:@"%ld", (long)maxNumRows] forKey:@"Rows"];
 		[tableDataInstance setStatusValue:@"y" forKey:@"RowsCountAccurate"];
+		[rowCounter setRowCount:maxNumRows forTable:selectedTable inDatabase:database whereClause:nil tableStatus:[tableDataInstance statusValues]];
 #ifndef SP_CODA
 		[[tableInfoInstance onMainThread] tableChanged:nil];
 		[[[tableDocumentInstance valueForKey:@"extendedTableInfoInstance"] onMainThread] loadTable:selectedTable];
 #endif
 
+	// For a page of filtered rows, count the rows matching the filter so that pagination
+	// covers only those rows
+	} else if (isFiltered && isLimited && !isInterruptedLoad && filteredRowCountClause) {
+		NSInteger pageSize = [prefs integerForKey:SPLimitResultsValue];
+		NSInteger foundMaxRows = ((contentPage - 1) * pageSize) + tableRowsCount;
+		NSInteger cachedRowCount;
+
+		// A short page is the last page, so the count is known
+		if ((NSInteger)tableRowsCount < pageSize) {
+			maxNumRows = foundMaxRows;
+			maxNumRowsIsEstimate = NO;
+			[rowCounter setRowCount:maxNumRows forTable:selectedTable inDatabase:database whereClause:filteredRowCountClause tableStatus:[tableDataInstance statusValues]];
+
+		} else if ([rowCounter getCachedRowCount:&cachedRowCount forTable:selectedTable inDatabase:database whereClause:filteredRowCountClause tableStatus:[tableDataInstance statusValues]]) {
+			maxNumRows = cachedRowCount;
+			maxNumRowsIsEstimate = NO;
+
+		// Otherwise use the estimate from the query plan, kept above the rows already seen,
+		// and count the matching rows in the background
+		} else {
+			maxNumRows = [rowCounter estimatedRowCountForTable:selectedTable inDatabase:database whereClause:filteredRowCountClause usingConnection:mySQLConnection];
+			if (maxNumRows <= foundMaxRows) maxNumRows = foundMaxRows + 1;
+			maxNumRowsIsEstimate = YES;
+			if ([tablesListInstance tableType] == SPTableTypeTable && [tableDataInstance shouldFetchAccurateRowCount]) {
+				[rowCounter countRowsInTable:selectedTable inDatabase:database whereClause:filteredRowCountClause tableStatus:[tableDataInstance statusValues]];
+			}
+		}
+
 	} else {
 
 		// Trigger an update via the SPTableData instance if preferences require it, and if
-		// the state is not already accurate
+		// the state is not already accurate; the update runs in the background, and the
+		// estimate is used until it completes
 		[tableDataInstance updateAccurateNumberOfRowsForCurrentTableForcingUpdate:NO];
 
-		// If the state is now accurate, use it
+		// If the state is accurate, use it
 		if ([[tableDataInstance statusValueForKey:@"RowsCountAccurate"] boolValue]) {
-		maxNumRows = [[tableDataInstance statusValueForKey:@"Rows"] integerValue];
-		maxNumRowsIsEstimate = NO;
-		checkStatusCount = YES;
+			maxNumRows = [[tableDataInstance statusValueForKey:@"Rows"] integerValue];
+			maxNumRowsIsEstimate = NO;
+			checkStatusCount = YES;
 
 		// Otherwise, use the estimate count
-	} else {
-		maxNumRows = [[tableDataInstance statusValueForKey:@"Rows"] integerValue];
-		maxNumRowsIsEstimate = YES;
-		checkStatusCount = YES;
-	}
+		} else {
+			maxNumRows = [[tableDataInstance statusValueForKey:@"Rows"] integerValue];
+			maxNumRowsIsEstimate = YES;
+			checkStatusCount = YES;
+		}
 	}
 
 	// Check whether the estimated count requires updating, ie if the retrieved count exceeds it
@@ -4084,14 +4946,166 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 }
 
 /**
- * Autosize all columns based on their content.
+ * Update the row count and dependent interface once a background count for the selected
+ * table completes, either of all its rows or of the rows matching the current filter.
+ */
+- (void)_rowCountDidFinish:(NSNotification *)notification
+{
+	NSDictionary *countInfo = [notification userInfo];
+	NSString *whereClause = [countInfo objectForKey:@"whereClause"];
+	NSInteger rowCount = [[countInfo objectForKey:@"rowCount"] integerValue];
+
+	if ([notification object] != [tableDataInstance rowCounter] || !selectedTable) return;
+	if (![[countInfo objectForKey:@"table"] isEqualToString:selectedTable]) return;
+	if (![[countInfo objectForKey:@"database"] isEqualToString:[tableDocumentInstance database]]) return;
+
+	// Wait for any load of the table to finish, which may already have picked up the count
+	if ([tableDocumentInstance isWorking]) {
+		[self performSelector:@selector(_rowCountDidFinish:) withObject:notification afterDelay:0.5];
+		return;
+	}
+	if (isInterruptedLoad) return;
+
+	// Filtered counts only apply to a page of the same filtered rows; counts of the whole
+	// table apply when that is what the count text and pagination show
+	BOOL countsFilteredPage = (isFiltered && isLimited && filteredRowCountClause);
+	if (whereClause) {
+		if (!countsFilteredPage || ![whereClause isEqualToString:filteredRowCountClause]) return;
+	} else {
+		if (countsFilteredPage || (!isFiltered && !isLimited && ![tableValues isVirtual])) return;
+	}
+
+	maxNumRows = rowCount;
+	maxNumRowsIsEstimate = NO;
+
+	// Virtually loaded tables can now be sized exactly
+	if ([tableValues isVirtual] && !whereClause && !isEditingNewRow && maxNumRows != (NSInteger)tableRowsCount) {
+		pthread_mutex_lock(&tableValuesLock);
+		[tableValues setVirtualRowCount:maxNumRows];
+		tableRowsCount = [tableValues count];
+		pthread_mutex_unlock(&tableValuesLock);
+		[tableContentView noteNumberOfRowsChanged];
+	}
+
+	[self updateCountText];
+	[self updatePaginationState];
+}
+
+/**
+ * Returns the primary key columns used to fetch the unloaded cells of the selected table,
+ * or nil if it has no primary key or its key values can't be quoted back to match rows.
+ */
+- (NSArray *)_cellFetcherKeyColumns
+{
+	NSArray *keyColumnNames = [tableDataInstance primaryKeyColumnNames];
+
+	for (NSString *keyColumnName in keyColumnNames) {
+		NSDictionary *keyColumn = [tableDataInstance columnWithName:keyColumnName];
+
+		if (!keyColumn || [tableDataInstance columnIsBlobOrText:keyColumnName]) return nil;
+		if ([[keyColumn objectForKey:@"type"] isEqualToString:@"BIT"] || [[keyColumn objectForKey:@"typegrouping"] isEqualToString:@"geometry"]) return nil;
+	}
+
+	return keyColumnNames;
+}
+
+/**
+ * Redraw the table content once unloaded cells have been fetched in the background, so
+ * that they are shown.
+ */
+- (void)_cellFetcherDidFetch:(NSNotification *)notification
+{
+	[tableContentView setNeedsDisplay:YES];
+}
+
+/**
+ * Returns a description of the state of the selected table - its creation and last update
+ * times - for validating cached results, or nil if the server can't supply one.  isSettled
+ * is set to whether the table was last updated long enough ago for a result loaded now to
+ * be cached against the description; updates within the same second can't be told apart.
+ */
+- (NSString *)_resultCacheProbeIsSettled:(BOOL *)isSettled
+{
+	*isSettled = NO;
+
+	if (!selectedTable || ![tableDocumentInstance database]) return nil;
+	if ([tablesListInstance tableType] != SPTableTypeTable || ![[tableDocumentInstance serverSupport] supportsInformationSchema]) return nil;
+
+	SPMySQLResult *probeResult = [mySQLConnection queryString:[NSString stringWithFormat:@"SELECT CREATE_TIME, UPDATE_TIME, UPDATE_TIME < NOW() - INTERVAL 1 SECOND FROM `information_schema`.`TABLES` WHERE TABLE_SCHEMA = %@ AND TABLE_NAME = %@",
+		[mySQLConnection escapeAndQuoteString:[tableDocumentInstance database]],
+		[mySQLConnection escapeAndQuoteString:selectedTable]]];
+	if ([mySQLConnection queryErrored]) return nil;
+
+	[probeResult setReturnDataAsStrings:YES];
+	NSArray *probeRow = [probeResult getRowAsArray];
+
+	// Engines which don't track update times can't be validated
+	if ([probeRow count] != 3 || [[probeRow objectAtIndex:0] isNSNull] || [[probeRow objectAtIndex:1] isNSNull]) return nil;
+
+	*isSettled = [[probeRow objectAtIndex:2] isEqualToString:@"1"];
+
+	return [NSString stringWithFormat:@"%@ %@", [probeRow objectAtIndex:0], [probeRow objectAtIndex:1]];
+}
+
+/**
+ * Autosize all columns based on their content.  Widths detected when the table was last
+ * shown are reused if they cover all its columns; otherwise the widths are detected from
+ * the content on a background thread, and applied once ready.
  * Should be called on the main thread.
  */
 - (void)autosizeColumns
 {
-	if (isWorking) pthread_mutex_lock(&tableValuesLock);
-	NSDictionary *columnWidths = [tableContentView autodetectColumnWidths];
-	if (isWorking) pthread_mutex_unlock(&tableValuesLock);
+	// Restored widths are kept for the rest of the load
+	if (columnWidthsRestored) return;
+
+	// Supersede any detection still running
+	columnSizingGeneration++;
+
+#ifndef SP_CODA
+	NSDictionary *savedWidths = [self _savedAutodetectedColumnWidths];
+	if (savedWidths) {
+		columnWidthsRestored = YES;
+		[self _applyAutodetectedColumnWidths:savedWidths generation:[NSNumber numberWithUnsignedInteger:columnSizingGeneration]];
+		return;
+	}
+#endif
+
+	NSDictionary *sizingDetails = [NSDictionary dictionaryWithObjectsAndKeys:
+		[NSNumber numberWithUnsignedInteger:columnSizingGeneration], @"generation",
+		[NSNumber numberWithDouble:[tableContentView availableWidthForColumns]], @"availableWidth",
+		nil];
+
+	[NSThread detachNewThreadWithName:@"SPTableContent column autosizing task" target:self selector:@selector(_autosizeColumnsTask:) object:sizingDetails];
+}
+
+/**
+ * Detect the column widths from the loaded rows, then apply them on the main thread.
+ * Should be called on a background thread.
+ */
+- (void)_autosizeColumnsTask:(NSDictionary *)sizingDetails
+{
+	NSAutoreleasePool *sizingPool = [[NSAutoreleasePool alloc] init];
+
+	pthread_mutex_lock(&tableValuesLock);
+	NSDictionary *columnWidths = [tableContentView autodetectColumnWidthsWithinWidth:[[sizingDetails objectForKey:@"availableWidth"] doubleValue]];
+	pthread_mutex_unlock(&tableValuesLock);
+
+	if (columnWidths) {
+		[[self onMainThread] _applyAutodetectedColumnWidths:columnWidths generation:[sizingDetails objectForKey:@"generation"]];
+	}
+
+	[sizingPool drain];
+}
+
+/**
+ * Set the widths of the columns, unless the widths are for an earlier request, skipping
+ * columns the user has set widths for.  Detected widths are saved for the table.
+ * Should be called on the main thread.
+ */
+- (void)_applyAutodetectedColumnWidths:(NSDictionary *)columnWidths generation:(NSNumber *)generation
+{
+	if ([generation unsignedIntegerValue] != columnSizingGeneration) return;
+
 	[tableContentView setDelegate:nil];
 	for (NSDictionary *columnDefinition in dataColumns) {
 
@@ -4103,11 +5117,74 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 		// Otherwise set the column width
 		NSTableColumn *aTableColumn = [tableContentView tableColumnWithIdentifier:[columnDefinition objectForKey:@"datacolumnindex"]];
 		NSInteger targetWidth = [[columnWidths objectForKey:[columnDefinition objectForKey:@"datacolumnindex"]] integerValue];
-		[aTableColumn setWidth:targetWidth];
+		if (targetWidth) [aTableColumn setWidth:targetWidth];
 	}
 	[tableContentView setDelegate:self];
+
+#ifndef SP_CODA
+	if (!columnWidthsRestored) [self _saveAutodetectedColumnWidths:columnWidths];
+#endif
 }
 
+#ifndef SP_CODA
+/**
+ * Returns the widths detected for the columns of the selected table when it was last shown,
+ * mapped by column identifier, or nil if there are none for any of its columns.
+ */
+- (NSDictionary *)_savedAutodetectedColumnWidths
+{
+	NSDictionary *tableWidths = [[[[prefs objectForKey:SPTableColumnAutodetectedWidths] objectForKey:[NSString stringWithFormat:@"%@@%@", [tableDocumentInstance database], [tableDocumentInstance host]]] objectForKey:selectedTable] objectForKey:@"widths"];
+	if (!tableWidths || ![dataColumns count]) return nil;
+
+	NSMutableDictionary *columnWidths = [NSMutableDictionary dictionaryWithCapacity:[dataColumns count]];
+	for (NSDictionary *columnDefinition in dataColumns) {
+		NSNumber *columnWidth = [tableWidths objectForKey:[columnDefinition objectForKey:@"name"]];
+		if (!columnWidth) return nil;
+		[columnWidths setObject:columnWidth forKey:[columnDefinition objectForKey:@"datacolumnindex"]];
+	}
+
+	return columnWidths;
+}
+
+/**
+ * Save the detected column widths for the selected table, so that they can be reused when
+ * it is next shown.  Only the most recently sized tables for each database are kept.
+ */
+- (void)_saveAutodetectedColumnWidths:(NSDictionary *)columnWidths
+{
+	if (!selectedTable) return;
+
+	NSString *databaseKey = [NSString stringWithFormat:@"%@@%@", [tableDocumentInstance database], [tableDocumentInstance host]];
+	NSMutableDictionary *savedWidths = [NSMutableDictionary dictionaryWithDictionary:[prefs objectForKey:SPTableColumnAutodetectedWidths]];
+	NSMutableDictionary *databaseWidths = [NSMutableDictionary dictionaryWithDictionary:[savedWidths objectForKey:databaseKey]];
+	NSMutableDictionary *tableWidths = [NSMutableDictionary dictionaryWithCapacity:[dataColumns count]];
+
+	for (NSDictionary *columnDefinition in dataColumns) {
+		NSNumber *columnWidth = [NSNumber numberWithInteger:[[columnWidths objectForKey:[columnDefinition objectForKey:@"datacolumnindex"]] integerValue]];
+		[tableWidths setObject:columnWidth forKey:[columnDefinition objectForKey:@"name"]];
+	}
+
+	[databaseWidths setObject:[NSDictionary dictionaryWithObjectsAndKeys:tableWidths, @"widths", [NSDate date], @"saved", nil] forKey:selectedTable];
+
+	// Discard the widths of the least recently sized tables
+	while ([databaseWidths count] > SPTableContentSavedColumnWidthsLimit) {
+		NSString *oldestTable = nil;
+		NSDate *oldestDate = nil;
+		for (NSString *eachTable in databaseWidths) {
+			NSDate *savedDate = [[databaseWidths objectForKey:eachTable] objectForKey:@"saved"];
+			if (!oldestDate || [savedDate compare:oldestDate] == NSOrderedAscending) {
+				oldestTable = eachTable;
+				oldestDate = savedDate;
+			}
+		}
+		[databaseWidths removeObjectForKey:oldestTable];
+	}
+
+	[savedWidths setObject:databaseWidths forKey:databaseKey];
+	[prefs setObject:savedWidths forKey:SPTableColumnAutodetectedWidths];
+}
+#endif
+
 #pragma mark -
 #pragma mark Task interaction
 
@@ -4260,6 +5337,22 @@ static NSString *SPTableFilterSetDefaultOperator = @"SPTableFilterSetDefaultOper
 	if (filterTableDefaultOperator) [filterTableDefaultOperator release];
 #endif
 	if (selectedTable) [selectedTable release];
+	[keysetPageBoundaries release];
+	if (keysetQueryBase) [keysetQueryBase release];
+	if (pagePrefetcher) [pagePrefetcher release];
+	if (cellFetcher) [cellFetcher release];
+	[resultCache release];
+	if (localFilter) [localFilter release];
+	if (filteredRowCountClause) [filteredRowCountClause release];
+	[virtualBlockQueue release];
+	[virtualBlocksWithBoundaries release];
+	[virtualBlockBoundaries release];
+	if (virtualQueryBase) [virtualQueryBase release];
+	if (virtualQueryOrderBy) [virtualQueryOrderBy release];
+	if (virtualKeyColumns) [virtualKeyColumns release];
+	if (virtualDatabase) [virtualDatabase release];
+	pthread_cond_destroy(&virtualBlockDownloadCondition);
+	pthread_mutex_destroy(&virtualBlockQueueLock);
 	if (contentFilters) [contentFilters release];
 	if (numberOfDefaultFilters) [numberOfDefaultFilters release];
 	if (keys) [keys release];
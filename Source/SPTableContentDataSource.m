@@ -35,6 +35,8 @@
 #import "SPDataStorage.h"
 #import "SPCopyTable.h"
 #import "SPTablesList.h"
+#import "SPTableData.h"
+#import "SPTableCellFetcher.h"
 
 #import <pthread.h>
 #import <SPMySQL/SPMySQL.h>
@@ -42,6 +44,8 @@
 @interface SPTableContent (SPTableContentDataSource_Private_API)
 
 - (id)_contentValueForTableColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex asPreview:(BOOL)asPreview;
+- (id)_lazilyFetchedValueForTableColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+- (NSString *)_rowKeyForLazyFetchAtRow:(NSUInteger)rowIndex;
 
 @end
 
@@ -111,6 +115,13 @@
 					value = [self _contentValueForTableColumn:columnIndex row:rowIndex asPreview:YES];
 				}
 			}
+
+			// Cells which weren't loaded with their rows are fetched by key in the background,
+			// and shown once fetched
+			if ([value isSPNotLoaded] && !isWorking && [tableValues virtualRowIsLoaded:rowIndex]) {
+				id fetchedValue = [self _lazilyFetchedValueForTableColumn:columnIndex row:rowIndex];
+				if (fetchedValue) value = fetchedValue;
+			}
 			
 			if ([value isKindOfClass:[SPMySQLGeometryData class]])
 				return [value wktString];
@@ -125,6 +136,10 @@
 				return [value stringRepresentationUsingEncoding:[mySQLConnection stringEncoding]];
 			}
 			
+			// Rows of virtually loaded tables may not have been fetched yet
+			if ([value isSPNotLoaded] && ![tableValues virtualRowIsLoaded:rowIndex])
+				return @"...";
+
 			if ([value isSPNotLoaded])
 				return NSLocalizedString(@"(not loaded)", @"value shown for hidden blob and text fields");
 			
@@ -206,4 +221,59 @@
 	return SPDataStorageObjectAtRowAndColumn(tableValues, rowIndex, columnIndex);
 }
 
+/**
+ * Returns a preview of the value of a cell which wasn't loaded with its row, if it has been
+ * fetched by primary key, or nil.  Cells not yet fetched are queued to be fetched in the
+ * background.
+ */
+- (id)_lazilyFetchedValueForTableColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex
+{
+	if (columnIndex >= [dataColumns count] || ![cellFetcher canFetchCells]) return nil;
+
+	NSString *rowKey = [self _rowKeyForLazyFetchAtRow:rowIndex];
+	if (!rowKey) return nil;
+
+	NSString *columnName = [NSArrayObjectAtIndex(dataColumns, columnIndex) objectForKey:@"name"];
+	id value = [cellFetcher cachedValueForColumn:columnName rowKey:rowKey];
+
+	if (!value) {
+		[cellFetcher fetchValuesForColumn:columnName rowKeys:[NSArray arrayWithObject:rowKey]];
+		return nil;
+	}
+
+	// Shorten long values as previews of loaded cells are
+	if ([value isKindOfClass:[NSString class]] && [(NSString *)value length] > 150) {
+		return [NSString stringWithFormat:@"%@...", [value substringToIndex:147]];
+	}
+	if ([value isKindOfClass:[NSData class]] && [(NSData *)value length] > 150) {
+		return [value subdataWithRange:NSMakeRange(0, 150)];
+	}
+
+	return value;
+}
+
+/**
+ * Returns the key identifying a row to the cell fetcher, built from its primary key values,
+ * or nil if the row can't be identified.
+ */
+- (NSString *)_rowKeyForLazyFetchAtRow:(NSUInteger)rowIndex
+{
+	NSArray *keyColumnNames = [tableDataInstance primaryKeyColumnNames];
+	NSMutableArray *keyValues = [NSMutableArray arrayWithCapacity:[keyColumnNames count]];
+
+	if (!keyColumnNames || rowIndex >= tableRowsCount) return nil;
+
+	for (NSString *keyColumnName in keyColumnNames) {
+		NSDictionary *keyColumn = [tableDataInstance columnWithName:keyColumnName];
+		if (!keyColumn) return nil;
+
+		id keyValue = SPDataStorageObjectAtRowAndColumn(tableValues, rowIndex, [[keyColumn objectForKey:@"datacolumnindex"] integerValue]);
+		if (!keyValue) return nil;
+
+		[keyValues addObject:keyValue];
+	}
+
+	return [cellFetcher rowKeyForKeyValues:keyValues];
+}
+
 @end
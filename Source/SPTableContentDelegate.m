@@ -46,6 +46,7 @@
 #import "SPCopyTable.h"
 #import "SPAlertSheets.h"
 #import "SPTableData.h"
+#import "SPTableCellFetcher.h"
 #import "SPFieldEditorController.h"
 #import "SPThreadAdditions.h"
 #import "SPTextAndLinkCell.h"
@@ -56,6 +57,7 @@
 @interface SPTableContent (SPDeclaredAPI)
 
 - (BOOL)cancelRowEditing;
+- (NSString *)_rowKeyForLazyFetchAtRow:(NSUInteger)rowIndex;
 
 @end
 
@@ -244,6 +246,14 @@
 			if ([wherePart length] == 0) return NO;
 			
 			// If the selected cell hasn't been loaded, load it.
+			if ([[tableValues cellDataAtRow:rowIndex column:[[tableColumn identifier] integerValue]] isSPNotLoaded]) {
+
+				// Use the value if it has already been fetched to show it
+				id fetchedValue = [cellFetcher cachedValueForColumn:[[tableColumn headerCell] stringValue] rowKey:[self _rowKeyForLazyFetchAtRow:rowIndex]];
+				if (fetchedValue && ![fetchedValue isSPNotLoaded]) {
+					[tableValues replaceObjectInRow:rowIndex column:[[tableColumn identifier] integerValue] withObject:fetchedValue];
+				}
+			}
 			if ([[tableValues cellDataAtRow:rowIndex column:[[tableColumn identifier] integerValue]] isSPNotLoaded]) {
 				
 				// Only get the data for the selected column, not all of them
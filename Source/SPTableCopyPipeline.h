@@ -0,0 +1,101 @@
+//
+//  $Id$
+//
+//  SPTableCopyPipeline.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+@class SPDataStorage;
+@class SPDatabaseDocument;
+
+typedef enum {
+	SPTableCopyTabFormat = 0,
+	SPTableCopySQLFormat = 1
+} SPTableCopyFormat;
+
+/**
+ * Copies large selections of rows to the general pasteboard without blocking the interface.
+ * Rows are formatted in chunks on worker threads straight into UTF-8 bytes, and the chunks
+ * are appended in order to a single buffer as they complete; only a few chunks are held
+ * ahead of the buffer at a time.  Progress is shown using the document's task display,
+ * which also allows the copy to be cancelled.
+ *
+ * Once complete the pasteboard types are declared with the pipeline as their owner, and
+ * the data is only written to the pasteboard when it is first requested.  The pipeline
+ * keeps itself alive until another owner takes over the pasteboard.
+ *
+ * The storage must not be modified while the copy runs; the document's task state
+ * prevents editing and reloads.
+ */
+@interface SPTableCopyPipeline : NSObject
+{
+	SPDataStorage *tableStorage;
+	SPDatabaseDocument *tableDocument;
+	SPTableCopyFormat format;
+
+	NSUInteger *rowIndexes;
+	NSUInteger rowCount;
+	NSUInteger *columnMappings;
+	NSUInteger *columnTypes;
+	NSUInteger columnCount;
+	NSArray *columnNames;
+
+	BOOL includesHeaders;
+	NSString *tableName;
+	NSData *insertPrefixData;
+	NSData *nullStringData;
+	NSData *notLoadedData;
+	NSStringEncoding stringEncoding;
+
+	NSMutableData **chunks;
+	NSUInteger chunkCount;
+	NSUInteger nextChunk;
+	NSUInteger appendedChunkCount;
+	NSUInteger chunkWindow;
+	pthread_mutex_t chunkLock;
+	pthread_cond_t chunkCondition;
+	BOOL cancelled;
+
+	NSMutableData *copiedData;
+	NSArray *pasteboardTypes;
+}
+
+- (id)initWithFormat:(SPTableCopyFormat)copyFormat tableStorage:(SPDataStorage *)storage rowIndexes:(NSIndexSet *)selectedRows columnNames:(NSArray *)names columnMappings:(NSUInteger *)mappings columnDefinitions:(NSArray *)columnDefinitions;
+
+// Options
+- (void)setIncludesHeaders:(BOOL)withHeaders;
+- (void)setTableName:(NSString *)name;
+- (void)setNullString:(NSString *)nullString;
+- (void)setStringEncoding:(NSStringEncoding)encoding;
+
+// Copying
+- (void)startCopyingForDocument:(SPDatabaseDocument *)document;
+- (void)cancelCopy;
+
+@end
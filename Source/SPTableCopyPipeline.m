@@ -0,0 +1,580 @@
+//
+//  $Id$
+//
+//  SPTableCopyPipeline.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPTableCopyPipeline.h"
+#import "SPDataStorage.h"
+#import "SPDatabaseDocument.h"
+#import "SPNotLoaded.h"
+#import "SPThreadAdditions.h"
+
+#import <SPMySQL/SPMySQL.h>
+#import <pthread.h>
+
+// Rows are formatted in chunks of this many rows
+static const NSUInteger SPTableCopyChunkRowCount = 2000;
+
+// Each worker thread may run this many chunks ahead of the last chunk appended
+static const NSUInteger SPTableCopyChunksAheadPerThread = 4;
+
+// A new INSERT statement is started once a statement exceeds this length
+static const NSUInteger SPTableCopyMaxInsertLength = 250000;
+
+typedef enum {
+	SPTableCopyEscapeNone,
+	SPTableCopyEscapeTabular,
+	SPTableCopyEscapeSQL
+} SPTableCopyEscaping;
+
+typedef enum {
+	SPTableCopyNumericColumn = 0,
+	SPTableCopyStringColumn = 1,
+	SPTableCopyBlobColumn = 2,
+	SPTableCopyGeometryColumn = 3
+} SPTableCopyColumnType;
+
+static const UInt8 SPTableCopyHexDigits[] = "0123456789ABCDEF";
+
+@interface SPTableCopyPipeline (PrivateAPI)
+
+- (void)_formatRows;
+- (void)_formatChunks;
+- (NSMutableData *)_formatChunk:(NSUInteger)chunkIndex;
+- (void)_copyDidFinish;
+
+@end
+
+#pragma mark -
+
+/**
+ * Append bytes to the data, escaping them as required.  Tabular text has line breaks and tabs
+ * replaced with visible symbols; SQL strings are escaped as by mysql_real_escape_string.  As
+ * the bytes are UTF-8, none of the escaped characters can occur within a multibyte sequence.
+ */
+static void _SPTableCopyAppendBytes(NSMutableData *data, const UInt8 *bytes, NSUInteger length, SPTableCopyEscaping escaping)
+{
+	NSUInteger i, runStart = 0;
+	const char *replacement;
+
+	if (escaping == SPTableCopyEscapeNone) {
+		[data appendBytes:bytes length:length];
+		return;
+	}
+
+	for (i = 0; i < length; i++) {
+		replacement = NULL;
+
+		if (escaping == SPTableCopyEscapeTabular) {
+			if (bytes[i] == '\n') replacement = "\xE2\x86\xB5";
+			else if (bytes[i] == '\t') replacement = "\xE2\x87\xA5";
+		}
+		else {
+			switch (bytes[i]) {
+				case '\0': replacement = "\\0"; break;
+				case '\n': replacement = "\\n"; break;
+				case '\r': replacement = "\\r"; break;
+				case '\\': replacement = "\\\\"; break;
+				case '\'': replacement = "\\'"; break;
+				case '"': replacement = "\\\""; break;
+				case '\032': replacement = "\\Z"; break;
+			}
+		}
+
+		if (replacement) {
+			if (i > runStart) [data appendBytes:bytes + runStart length:i - runStart];
+			[data appendBytes:replacement length:strlen(replacement)];
+			runStart = i + 1;
+		}
+	}
+
+	if (length > runStart) [data appendBytes:bytes + runStart length:length - runStart];
+}
+
+/**
+ * Append a string to the data as UTF-8, escaping it as required.
+ */
+static void _SPTableCopyAppendString(NSMutableData *data, NSString *string, SPTableCopyEscaping escaping)
+{
+	UInt8 buffer[4096];
+	CFIndex length = CFStringGetLength((CFStringRef)string);
+	CFIndex maxByteLength = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8);
+	CFIndex byteLength = 0;
+	UInt8 *bytes = (maxByteLength <= (CFIndex)sizeof(buffer)) ? buffer : malloc(maxByteLength);
+	CFStringGetBytes((CFStringRef)string, CFRangeMake(0, length), kCFStringEncodingUTF8, '?', false, bytes, maxByteLength, &byteLength);
+	_SPTableCopyAppendBytes(data, bytes, byteLength, escaping);
+	if (bytes != buffer) free(bytes);
+}
+
+/**
+ * Append binary data to the data as a quoted SQL hex literal.
+ */
+static void _SPTableCopyAppendHexData(NSMutableData *data, NSData *value)
+{
+	NSUInteger i, length = [value length];
+	NSUInteger offset = [data length];
+	const UInt8 *bytes = [value bytes];
+
+	[data increaseLengthBy:(length * 2) + 3];
+	UInt8 *output = (UInt8 *)[data mutableBytes] + offset;
+
+	*output++ = 'X';
+	*output++ = '\'';
+	for (i = 0; i < length; i++) {
+		*output++ = SPTableCopyHexDigits[bytes[i] >> 4];
+		*output++ = SPTableCopyHexDigits[bytes[i] & 0x0F];
+	}
+	*output = '\'';
+}
+
+static inline void _SPTableCopyAppendCString(NSMutableData *data, const char *cString)
+{
+	[data appendBytes:cString length:strlen(cString)];
+}
+
+static void *_SPTableCopyRunWorker(void *pipeline)
+{
+	NSAutoreleasePool *workerPool = [[NSAutoreleasePool alloc] init];
+
+	[(SPTableCopyPipeline *)pipeline _formatChunks];
+
+	[workerPool drain];
+
+	return NULL;
+}
+
+@implementation SPTableCopyPipeline
+
+/**
+ * Set up a copy of the specified rows and columns of the storage.  Column names are used for
+ * the header row and for INSERT statements; the column mappings give the storage column for
+ * each, and the column definitions are used to quote SQL values by type.
+ */
+- (id)initWithFormat:(SPTableCopyFormat)copyFormat tableStorage:(SPDataStorage *)storage rowIndexes:(NSIndexSet *)selectedRows columnNames:(NSArray *)names columnMappings:(NSUInteger *)mappings columnDefinitions:(NSArray *)columnDefinitions
+{
+	if ((self = [super init])) {
+		NSUInteger c;
+
+		format = copyFormat;
+		tableStorage = [storage retain];
+		columnNames = [names retain];
+		columnCount = [columnNames count];
+		includesHeaders = NO;
+		tableName = nil;
+		nullStringData = nil;
+		notLoadedData = nil;
+		insertPrefixData = nil;
+		stringEncoding = NSUTF8StringEncoding;
+		copiedData = nil;
+		pasteboardTypes = nil;
+		tableDocument = nil;
+		cancelled = NO;
+
+		// Take a copy of the row indexes, so the selection can change during the copy
+		rowCount = [selectedRows count];
+		rowIndexes = malloc(MAX(rowCount, 1) * sizeof(NSUInteger));
+		[selectedRows getIndexes:rowIndexes maxCount:rowCount inIndexRange:NULL];
+
+		columnMappings = malloc(MAX(columnCount, 1) * sizeof(NSUInteger));
+		columnTypes = malloc(MAX(columnCount, 1) * sizeof(NSUInteger));
+		for (c = 0; c < columnCount; c++) {
+			columnMappings[c] = mappings[c];
+
+			NSString *t = (columnDefinitions) ? [NSArrayObjectAtIndex(columnDefinitions, columnMappings[c]) objectForKey:@"typegrouping"] : nil;
+
+			if ([t isEqualToString:@"bit"] || [t isEqualToString:@"integer"] || [t isEqualToString:@"float"])
+				columnTypes[c] = SPTableCopyNumericColumn;
+			else if ([t isEqualToString:@"blobdata"] || [t isEqualToString:@"textdata"])
+				columnTypes[c] = SPTableCopyBlobColumn;
+			else if ([t isEqualToString:@"geometry"])
+				columnTypes[c] = SPTableCopyGeometryColumn;
+			else
+				columnTypes[c] = SPTableCopyStringColumn;
+		}
+
+		chunkCount = (rowCount + SPTableCopyChunkRowCount - 1) / SPTableCopyChunkRowCount;
+		chunks = calloc(MAX(chunkCount, 1), sizeof(NSMutableData *));
+		nextChunk = 0;
+		appendedChunkCount = 0;
+		chunkWindow = 1;
+
+		pthread_mutex_init(&chunkLock, NULL);
+		pthread_cond_init(&chunkCondition, NULL);
+	}
+
+	return self;
+}
+
+#pragma mark -
+#pragma mark Options
+
+/**
+ * Set whether tab-separated copies start with a row of column names.
+ */
+- (void)setIncludesHeaders:(BOOL)withHeaders
+{
+	includesHeaders = withHeaders;
+}
+
+/**
+ * Set the table name used in INSERT statements; <table> is used if none is set.
+ */
+- (void)setTableName:(NSString *)name
+{
+	if (tableName) [tableName release], tableName = nil;
+	tableName = [name copy];
+}
+
+/**
+ * Set the string shown for NULL values in tab-separated copies.
+ */
+- (void)setNullString:(NSString *)nullString
+{
+	if (nullStringData) [nullStringData release], nullStringData = nil;
+	nullStringData = [[nullString dataUsingEncoding:NSUTF8StringEncoding] retain];
+}
+
+/**
+ * Set the encoding used to read binary data as text in tab-separated copies.
+ */
+- (void)setStringEncoding:(NSStringEncoding)encoding
+{
+	stringEncoding = encoding;
+}
+
+#pragma mark -
+#pragma mark Copying
+
+/**
+ * Start formatting the rows in the background, as a task of the supplied document.
+ */
+- (void)startCopyingForDocument:(SPDatabaseDocument *)document
+{
+	tableDocument = document;
+	copiedData = [[NSMutableData alloc] init];
+
+	notLoadedData = [[NSLocalizedString(@"(not loaded)", @"value shown for hidden blob and text fields") dataUsingEncoding:NSUTF8StringEncoding] retain];
+
+	if (format == SPTableCopySQLFormat) {
+		NSMutableData *prefix = [NSMutableData data];
+		_SPTableCopyAppendString(prefix, [NSString stringWithFormat:@"INSERT INTO %@ (%@)\nVALUES\n",
+			[(tableName == nil) ? @"<table>" : tableName backtickQuotedString], [columnNames componentsJoinedAndBacktickQuoted]], SPTableCopyEscapeNone);
+		insertPrefixData = [prefix retain];
+	}
+	else if (includesHeaders) {
+		_SPTableCopyAppendString(copiedData, [columnNames componentsJoinedByString:@"\t"], SPTableCopyEscapeNone);
+		if (rowCount) _SPTableCopyAppendCString(copiedData, "\n");
+	}
+
+	[tableDocument startTaskWithDescription:NSLocalizedString(@"Copying rows...", @"copying rows task description")];
+	[tableDocument enableTaskCancellationWithTitle:NSLocalizedString(@"Cancel", @"cancel button") callbackObject:self callbackFunction:@selector(cancelCopy)];
+	[tableDocument setTaskPercentage:0];
+
+	[NSThread detachNewThreadWithName:@"SPTableCopyPipeline row formatter" target:self selector:@selector(_formatRows) object:nil];
+}
+
+/**
+ * Stop the copy; called via the document's task cancellation button.  Chunks being formatted
+ * are abandoned, and the pasteboard is left unchanged.
+ */
+- (void)cancelCopy
+{
+	[tableDocument setTaskDescription:NSLocalizedString(@"Cancelling...", @"cancelling task status message")];
+
+	pthread_mutex_lock(&chunkLock);
+	cancelled = YES;
+	pthread_cond_broadcast(&chunkCondition);
+	pthread_mutex_unlock(&chunkLock);
+}
+
+#pragma mark -
+#pragma mark Pasteboard ownership
+
+/**
+ * Supply the copied data the first time it's requested from the pasteboard.  The data is
+ * UTF-8, as required for both the plain and tabular text types.
+ */
+- (void)pasteboard:(NSPasteboard *)sender provideDataForType:(NSString *)type
+{
+	if (copiedData) [sender setData:copiedData forType:type];
+}
+
+/**
+ * Release the copy once something else has been placed on the pasteboard.
+ */
+- (void)pasteboardChangedOwner:(NSPasteboard *)sender
+{
+	[self autorelease];
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	NSUInteger i;
+
+	for (i = 0; i < chunkCount; i++) {
+		if (chunks[i]) [chunks[i] release];
+	}
+	free(chunks);
+	if (rowIndexes) free(rowIndexes);
+	if (columnMappings) free(columnMappings);
+	if (columnTypes) free(columnTypes);
+
+	if (tableStorage) [tableStorage release], tableStorage = nil;
+	if (columnNames) [columnNames release], columnNames = nil;
+	if (tableName) [tableName release], tableName = nil;
+	if (insertPrefixData) [insertPrefixData release], insertPrefixData = nil;
+	if (nullStringData) [nullStringData release], nullStringData = nil;
+	if (notLoadedData) [notLoadedData release], notLoadedData = nil;
+	if (copiedData) [copiedData release], copiedData = nil;
+	if (pasteboardTypes) [pasteboardTypes release], pasteboardTypes = nil;
+
+	pthread_mutex_destroy(&chunkLock);
+	pthread_cond_destroy(&chunkCondition);
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+
+@implementation SPTableCopyPipeline (PrivateAPI)
+
+/**
+ * Run the worker threads, appending the chunks they produce to the copied data in order as
+ * they complete.  Each chunk is released as soon as it has been appended.
+ */
+- (void)_formatRows
+{
+	NSAutoreleasePool *formatPool = [[NSAutoreleasePool alloc] init];
+	NSUInteger i, threadCount = [[NSProcessInfo processInfo] activeProcessorCount];
+	NSMutableData *chunk;
+
+	if (threadCount > chunkCount) threadCount = chunkCount;
+	if (threadCount < 1) threadCount = 1;
+	chunkWindow = threadCount * SPTableCopyChunksAheadPerThread;
+
+	pthread_t *threads = malloc(threadCount * sizeof(pthread_t));
+	for (i = 0; i < threadCount; i++) {
+		pthread_create(&threads[i], NULL, _SPTableCopyRunWorker, self);
+	}
+
+	pthread_mutex_lock(&chunkLock);
+	while (appendedChunkCount < chunkCount && !cancelled) {
+		chunk = chunks[appendedChunkCount];
+		if (!chunk) {
+			pthread_cond_wait(&chunkCondition, &chunkLock);
+			continue;
+		}
+
+		chunks[appendedChunkCount] = nil;
+		appendedChunkCount++;
+		pthread_cond_broadcast(&chunkCondition);
+		pthread_mutex_unlock(&chunkLock);
+
+		[copiedData appendData:chunk];
+		[chunk release];
+		[tableDocument setTaskPercentage:(appendedChunkCount * 100.0f / chunkCount)];
+
+		pthread_mutex_lock(&chunkLock);
+	}
+	pthread_mutex_unlock(&chunkLock);
+
+	for (i = 0; i < threadCount; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+
+	[[self onMainThread] _copyDidFinish];
+
+	[formatPool drain];
+}
+
+/**
+ * Worker thread loop, formatting the next unclaimed chunk until all are claimed.  Workers
+ * wait rather than running too far ahead of the appended chunks, limiting the memory held.
+ */
+- (void)_formatChunks
+{
+	NSUInteger chunkIndex;
+	NSMutableData *chunk;
+
+	pthread_mutex_lock(&chunkLock);
+	while (!cancelled && nextChunk < chunkCount) {
+		if (nextChunk >= appendedChunkCount + chunkWindow) {
+			pthread_cond_wait(&chunkCondition, &chunkLock);
+			continue;
+		}
+
+		chunkIndex = nextChunk++;
+		pthread_mutex_unlock(&chunkLock);
+
+		NSAutoreleasePool *chunkPool = [[NSAutoreleasePool alloc] init];
+		chunk = [self _formatChunk:chunkIndex];
+		[chunkPool drain];
+
+		pthread_mutex_lock(&chunkLock);
+		chunks[chunkIndex] = chunk;
+		pthread_cond_broadcast(&chunkCondition);
+	}
+	pthread_mutex_unlock(&chunkLock);
+}
+
+/**
+ * Format a chunk of rows, returning a retained data object.  Tab-separated rows are separated
+ * by line breaks; SQL chunks each start a new INSERT statement, and start another whenever
+ * the current statement grows too long.
+ */
+- (NSMutableData *)_formatChunk:(NSUInteger)chunkIndex
+{
+	NSUInteger firstRow = chunkIndex * SPTableCopyChunkRowCount;
+	NSUInteger endRow = MIN(firstRow + SPTableCopyChunkRowCount, rowCount);
+	NSUInteger i, c, statementStart = 0;
+	NSMutableData *chunk = [[NSMutableData alloc] initWithCapacity:(endRow - firstRow) * columnCount * 16];
+	Class nsDataClass = [NSData class];
+	Class spmysqlGeometryData = [SPMySQLGeometryData class];
+	id cellData;
+
+	for (i = firstRow; i < endRow; i++) {
+		if (cancelled) break;
+
+		// Start the row, and a new statement if appropriate
+		if (format == SPTableCopySQLFormat) {
+			if (i == firstRow) {
+				if (i) _SPTableCopyAppendCString(chunk, "\n");
+				[chunk appendData:insertPrefixData];
+				statementStart = [chunk length];
+			}
+			else if ([chunk length] - statementStart > SPTableCopyMaxInsertLength) {
+				_SPTableCopyAppendCString(chunk, ");\n\n");
+				[chunk appendData:insertPrefixData];
+				statementStart = [chunk length];
+			}
+			else {
+				_SPTableCopyAppendCString(chunk, "),\n");
+			}
+			_SPTableCopyAppendCString(chunk, "\t(");
+		}
+		else if (i) {
+			_SPTableCopyAppendCString(chunk, "\n");
+		}
+
+		for (c = 0; c < columnCount; c++) {
+			if (c) _SPTableCopyAppendCString(chunk, (format == SPTableCopySQLFormat) ? ", " : "\t");
+
+			cellData = SPDataStorageObjectAtRowAndColumn(tableStorage, rowIndexes[i], columnMappings[c]);
+
+			// SQL values are quoted by column type
+			if (format == SPTableCopySQLFormat) {
+				if (!cellData || [cellData isNSNull]) {
+					_SPTableCopyAppendCString(chunk, "NULL");
+				}
+				else if (columnTypes[c] == SPTableCopyNumericColumn) {
+					_SPTableCopyAppendString(chunk, [cellData description], SPTableCopyEscapeNone);
+				}
+				else if (columnTypes[c] == SPTableCopyGeometryColumn && [cellData isKindOfClass:spmysqlGeometryData]) {
+					_SPTableCopyAppendHexData(chunk, [cellData data]);
+				}
+				else if ([cellData isKindOfClass:nsDataClass]) {
+					_SPTableCopyAppendHexData(chunk, cellData);
+				}
+				else {
+					_SPTableCopyAppendCString(chunk, "'");
+					_SPTableCopyAppendString(chunk, [cellData description], SPTableCopyEscapeSQL);
+					_SPTableCopyAppendCString(chunk, "'");
+				}
+				continue;
+			}
+
+			// Tab-separated values copy the shown representation of the cell - custom NULL display
+			// strings, (not loaded), and binary data read as text.
+			if (!cellData) continue;
+			if ([cellData isNSNull]) {
+				if (nullStringData) [chunk appendData:nullStringData];
+			}
+			else if ([cellData isSPNotLoaded]) {
+				[chunk appendData:notLoadedData];
+			}
+			else if ([cellData isKindOfClass:nsDataClass]) {
+				NSString *displayString = [[NSString alloc] initWithData:cellData encoding:stringEncoding];
+				if (!displayString) displayString = [[NSString alloc] initWithData:cellData encoding:NSASCIIStringEncoding];
+				if (displayString) {
+					_SPTableCopyAppendString(chunk, displayString, SPTableCopyEscapeNone);
+					[displayString release];
+				}
+			}
+			else if ([cellData isKindOfClass:spmysqlGeometryData]) {
+				_SPTableCopyAppendString(chunk, [cellData wktString], SPTableCopyEscapeNone);
+			}
+			else {
+				_SPTableCopyAppendString(chunk, [cellData description], SPTableCopyEscapeTabular);
+			}
+		}
+	}
+
+	// Close the chunk's last statement
+	if (format == SPTableCopySQLFormat && endRow > firstRow) {
+		_SPTableCopyAppendCString(chunk, ");\n");
+	}
+
+	return chunk;
+}
+
+/**
+ * Once formatting completes, end the task and, unless cancelled, declare the pasteboard
+ * types.  The pipeline stays alive as the pasteboard owner until replaced.
+ */
+- (void)_copyDidFinish
+{
+	[tableDocument endTask];
+
+	// The rows and storage are no longer needed
+	free(rowIndexes), rowIndexes = NULL;
+	if (tableStorage) [tableStorage release], tableStorage = nil;
+
+	if (cancelled) {
+		if (copiedData) [copiedData release], copiedData = nil;
+		return;
+	}
+
+	if (format == SPTableCopySQLFormat) {
+		pasteboardTypes = [[NSArray alloc] initWithObjects:NSPasteboardTypeString, nil];
+	} else {
+		pasteboardTypes = [[NSArray alloc] initWithObjects:NSPasteboardTypeTabularText, NSPasteboardTypeString, nil];
+	}
+
+	[[NSPasteboard generalPasteboard] declareTypes:pasteboardTypes owner:self];
+	[self retain];
+}
+
+@end
@@ -33,6 +33,7 @@
 @class SPDatabaseDocument;
 @class SPTablesList;
 @class SPMySQLConnection;
+@class SPTableRowCounter;
 
 @interface SPTableData : NSObject 
 {
@@ -50,6 +51,7 @@
 	NSString *tableCreateSyntax;
 	
 	SPMySQLConnection *mySQLConnection;
+	SPTableRowCounter *rowCounter;
 
 	pthread_mutex_t dataProcessingLock;
 
@@ -59,6 +61,7 @@
 @property (readonly, assign) BOOL tableHasAutoIncrementField;
 
 - (void) setConnection:(SPMySQLConnection *)theConnection;
+- (SPTableRowCounter *) rowCounter;
 - (NSString *) tableEncoding;
 - (NSString *) tableCreateSyntax;
 - (NSArray *) columns;
@@ -82,6 +85,7 @@
 - (BOOL) updateStatusInformationForCurrentTable;
 - (BOOL) updateTriggersForCurrentTable;
 - (BOOL) updateAccurateNumberOfRowsForCurrentTableForcingUpdate:(BOOL)alwaysUpdate;
+- (BOOL) shouldFetchAccurateRowCount;
 - (NSDictionary *) parseFieldDefinitionStringParts:(NSArray *)definitionParts;
 - (NSArray *) primaryKeyColumnNames;
 
@@ -37,6 +37,8 @@
 #import "SPAlertSheets.h"
 #import "RegexKitLite.h"
 #import "SPServerSupport.h"
+#import "SPTableRowCounter.h"
+#import "SPConnectionPool.h"
 
 #import <pthread.h>
 #import <SPMySQL/SPMySQL.h>
@@ -44,6 +46,7 @@
 @interface SPTableData (PrivateAPI)
 
 - (void)_loopWhileWorking;
+- (void)_rowCountDidFinish:(NSNotification *)notification;
 
 @end
 
@@ -64,6 +67,7 @@
 		tableEncoding = nil;
 		tableCreateSyntax = nil;
 		mySQLConnection = nil;
+		rowCounter = nil;
 		tableHasAutoIncrementField = NO;
 
 		pthread_mutex_init(&dataProcessingLock, NULL);
@@ -82,6 +86,21 @@
 {
 	mySQLConnection = theConnection;
 	[mySQLConnection retain];
+
+	// Set up the row counter, which counts rows in the background on a pooled connection
+	if (!rowCounter) {
+		rowCounter = [[SPTableRowCounter alloc] initWithDelegate:tableDocumentInstance];
+		[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_rowCountDidFinish:) name:SPTableRowCountDidFinishNotification object:rowCounter];
+	}
+	[rowCounter setConnectionPool:[tableDocumentInstance connectionPool]];
+}
+
+/**
+ * Returns the row counter used to estimate and count rows for the document's tables.
+ */
+- (SPTableRowCounter *) rowCounter
+{
+	return rowCounter;
 }
 
 /**
@@ -1032,6 +1051,13 @@
 			[status setObject:@"y" forKey:@"RowsCountAccurate"];
 		} else {
 			[status setObject:@"n" forKey:@"RowsCountAccurate"];
+
+			// Use any exact count made since the table last changed
+			NSInteger cachedRowCount;
+			if ([rowCounter getCachedRowCount:&cachedRowCount forTable:[tableListInstance tableName] inDatabase:[tableDocumentInstance database] whereClause:nil tableStatus:status]) {
+				[status setObject:[NSString stringWithFormat:@"%ld", (long)cachedRowCount] forKey:@"Rows"];
+				[status setObject:@"y" forKey:@"RowsCountAccurate"];
+			}
 		}
 
 		// [status objectForKey:@"Rows"] is NULL then try to get the number of rows via SELECT COUNT(1) FROM `foo`
@@ -1110,8 +1136,9 @@
  * Retrieve the number of rows in the current table if necessary; if a value has already been
  * set for the current table/view, no update will occur.  However, if the row count value
  * is an estimate but the preferences are set to retrieve accurate row counts, this will
- * run a COUNT query to retrieve an accurate value.
- * Returns YES if the update was successful or not needed, or NO if the update failed
+ * start a COUNT query in the background to retrieve an accurate value; the estimate is kept
+ * until the count completes, and SPTableInfoChangedNotification is posted once it has.
+ * Returns YES if the update was started or not needed, or NO if the update failed
  */
 - (BOOL) updateAccurateNumberOfRowsForCurrentTableForcingUpdate:(BOOL)alwaysUpdate
 {
@@ -1134,32 +1161,36 @@
 			return YES;
 		}
 
-		SPRowCountQueryUsageLevels rowCountLevel = SPRowCountFetchAlways;
-		NSInteger rowCountCheapBoundary = 5242880;
-#ifndef SP_CODA
-		rowCountLevel = (SPRowCountQueryUsageLevels)[[[NSUserDefaults standardUserDefaults] objectForKey:SPTableRowCountQueryLevel] integerValue];
-		rowCountCheapBoundary = [[[NSUserDefaults standardUserDefaults] objectForKey:SPTableRowCountCheapSizeBoundary] integerValue];
-#endif
-
-		if (rowCountLevel == SPRowCountFetchNever
-			|| (rowCountLevel == SPRowCountFetchIfCheap && [[self statusValueForKey:@"Data_length"] integerValue] >= rowCountCheapBoundary))
-		{
+		if (![self shouldFetchAccurateRowCount]) {
 			return YES;
 		}
 	}
 
-	// Fetch the number of rows
-	SPMySQLResult *rowResult = [mySQLConnection queryString:[NSString stringWithFormat:@"SELECT COUNT(1) FROM %@", [[tableListInstance tableName] backtickQuotedString]]];
-	if ([mySQLConnection queryErrored]) {
-		return NO;
-	}
+	// Count the rows in the background, without tying up the connection
+	if (!rowCounter) return NO;
+	[rowCounter countRowsInTable:[tableListInstance tableName] inDatabase:[tableDocumentInstance database] whereClause:nil tableStatus:status];
 
-	// Store the number of rows
-	[status setObject:[[rowResult getRowAsArray] objectAtIndex:0] forKey:@"Rows"];
-	[status setObject:@"y" forKey:@"RowsCountAccurate"];
+	return YES;
+}
 
-	// Trigger an update to the table info pane and view
-	[[NSNotificationCenter defaultCenter] postNotificationOnMainThreadWithName:SPTableInfoChangedNotification object:tableDocumentInstance];
+/**
+ * Returns whether the preferences allow an exact row count to be run for the current
+ * table; counts on large tables can take a long time on engines without a stored count.
+ */
+- (BOOL) shouldFetchAccurateRowCount
+{
+	SPRowCountQueryUsageLevels rowCountLevel = SPRowCountFetchAlways;
+	NSInteger rowCountCheapBoundary = 5242880;
+#ifndef SP_CODA
+	rowCountLevel = (SPRowCountQueryUsageLevels)[[[NSUserDefaults standardUserDefaults] objectForKey:SPTableRowCountQueryLevel] integerValue];
+	rowCountCheapBoundary = [[[NSUserDefaults standardUserDefaults] objectForKey:SPTableRowCountCheapSizeBoundary] integerValue];
+#endif
+
+	if (rowCountLevel == SPRowCountFetchNever
+		|| (rowCountLevel == SPRowCountFetchIfCheap && [[self statusValueForKey:@"Data_length"] integerValue] >= rowCountCheapBoundary))
+	{
+		return NO;
+	}
 
 	return YES;
 }
@@ -1410,6 +1441,11 @@
 	if (tableEncoding) [tableEncoding release];
 	if (tableCreateSyntax) [tableCreateSyntax release];
 	if (mySQLConnection) [mySQLConnection release];
+	if (rowCounter) {
+		[[NSNotificationCenter defaultCenter] removeObserver:self];
+		[rowCounter destroy:nil];
+		[rowCounter release];
+	}
 
 	pthread_mutex_destroy(&dataProcessingLock);
 
@@ -1425,6 +1461,24 @@
 	pthread_mutex_unlock(&dataProcessingLock);
 }
 
+/**
+ * Store an exact count of the rows in the current table once a background count
+ * completes, and trigger an update to the table info pane and view.
+ */
+- (void)_rowCountDidFinish:(NSNotification *)notification
+{
+	NSDictionary *countInfo = [notification userInfo];
+
+	if ([countInfo objectForKey:@"whereClause"]) return;
+	if (![[countInfo objectForKey:@"table"] isEqualToString:[tableListInstance tableName]]) return;
+	if (![[countInfo objectForKey:@"database"] isEqualToString:[tableDocumentInstance database]]) return;
+
+	[status setObject:[[countInfo objectForKey:@"rowCount"] stringValue] forKey:@"Rows"];
+	[status setObject:@"y" forKey:@"RowsCountAccurate"];
+
+	[[NSNotificationCenter defaultCenter] postNotificationName:SPTableInfoChangedNotification object:tableDocumentInstance];
+}
+
 #ifdef SP_CODA /* glue */
 
 - (void)setTableDocumentInstance:(SPDatabaseDocument *)doc
@@ -0,0 +1,76 @@
+//
+//  $Id$
+//
+//  SPTablePagePrefetcher.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+@class SPDatabaseDocument;
+@class SPConnectionPool;
+
+#import <SPMySQL/SPMySQL.h>
+
+/**
+ * Fetches pages of table content in the background, so that paging through a table can
+ * show the next or previous page without waiting for the server.  Pages are run as their
+ * full queries on a connection from the document's pool, one at a time in the order requested, and kept
+ * in a small cache keyed by database and query until used, replaced, too old, or
+ * invalidated.
+ *
+ * Requesting a page which is still being prefetched waits for that prefetch to finish
+ * rather than running the query again.
+ */
+@interface SPTablePagePrefetcher : NSObject <SPMySQLStreamingResultStoreDelegate>
+{
+	SPDatabaseDocument *delegate;
+	SPConnectionPool *connectionPool;
+
+	NSMutableArray *queuedPageKeys;
+	NSMutableDictionary *queuedPages;
+	NSString *activePageKey;
+	NSMutableDictionary *prefetchedPages;
+	NSMutableArray *prefetchedPageKeys;
+	NSUInteger prefetchGeneration;
+	BOOL prefetcherRunning;
+
+	pthread_mutex_t prefetchLock;
+	pthread_cond_t prefetchCondition;
+}
+
+// Setup and teardown
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate;
+- (void)setConnectionPool:(SPConnectionPool *)aConnectionPool;
+- (void)destroy:(NSNotification *)notification;
+
+// Prefetching
+- (void)prefetchQueries:(NSArray *)queries inDatabase:(NSString *)database;
+- (SPMySQLStreamingResultStore *)prefetchedResultStoreForQuery:(NSString *)query inDatabase:(NSString *)database;
+- (void)invalidate;
+
+@end
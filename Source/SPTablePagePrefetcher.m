@@ -0,0 +1,337 @@
+//
+//  $Id$
+//
+//  SPTablePagePrefetcher.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPTablePagePrefetcher.h"
+#import "SPDatabaseDocument.h"
+#import "SPConnectionPool.h"
+#import "SPThreadAdditions.h"
+
+#import <pthread.h>
+
+// The number of prefetched pages kept; the oldest are discarded first
+static const NSUInteger SPTablePagePrefetchCacheLimit = 4;
+
+// Prefetched pages older than this, in seconds, are discarded rather than shown
+static const NSTimeInterval SPTablePagePrefetchMaximumAge = 60;
+
+@interface SPTablePagePrefetcher (Private_API)
+
+- (NSString *)_keyForQuery:(NSString *)query inDatabase:(NSString *)database;
+- (void)_prefetchPagesTask;
+
+@end
+
+#pragma mark -
+
+@implementation SPTablePagePrefetcher
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+/**
+ * Prevent SPTablePagePrefetcher from being init'd normally.
+ */
+- (id)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"SPTablePagePrefetchers should not be init'd directly; use initWithDelegate: instead."];
+	return nil;
+}
+
+/**
+ * Standard init method, constructing the SPTablePagePrefetcher around a delegate which
+ * supplies connection details.
+ */
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate
+{
+	if ((self = [super init])) {
+
+		// Keep a weak reference to the delegate
+		delegate = theDelegate;
+
+		connectionPool = nil;
+
+		queuedPageKeys = [[NSMutableArray alloc] init];
+		queuedPages = [[NSMutableDictionary alloc] init];
+		activePageKey = nil;
+		prefetchedPages = [[NSMutableDictionary alloc] init];
+		prefetchedPageKeys = [[NSMutableArray alloc] init];
+		prefetchGeneration = 0;
+		prefetcherRunning = NO;
+
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(destroy:)
+													 name:SPDocumentWillCloseNotification
+												   object:delegate];
+
+		pthread_mutex_init(&prefetchLock, NULL);
+		pthread_cond_init(&prefetchCondition, NULL);
+	}
+
+	return self;
+}
+
+/**
+ * Set the pool pages are prefetched on a connection from.
+ */
+- (void)setConnectionPool:(SPConnectionPool *)aConnectionPool
+{
+	pthread_mutex_lock(&prefetchLock);
+	if (connectionPool) [connectionPool release];
+	connectionPool = [aConnectionPool retain];
+	pthread_mutex_unlock(&prefetchLock);
+}
+
+/**
+ * Discard all prefetched pages, cancel any prefetch in progress, and stop using the delegate.
+ */
+- (void)destroy:(NSNotification *)notification
+{
+	[self invalidate];
+
+	pthread_mutex_lock(&prefetchLock);
+	delegate = nil;
+	pthread_mutex_unlock(&prefetchLock);
+}
+
+#pragma mark -
+#pragma mark Prefetching
+
+/**
+ * Queue the supplied page queries to be prefetched in order, replacing any queued
+ * previously.  Pages already prefetched or being prefetched aren't queued again.
+ */
+- (void)prefetchQueries:(NSArray *)queries inDatabase:(NSString *)database
+{
+	BOOL startPrefetcher;
+
+	if (!database || ![queries count]) return;
+
+	pthread_mutex_lock(&prefetchLock);
+
+	[queuedPageKeys removeAllObjects];
+	[queuedPages removeAllObjects];
+
+	for (NSString *query in queries) {
+		NSString *pageKey = [self _keyForQuery:query inDatabase:database];
+
+		if ([pageKey isEqualToString:activePageKey] || [prefetchedPages objectForKey:pageKey]) continue;
+
+		[queuedPageKeys addObject:pageKey];
+		[queuedPages setObject:[NSArray arrayWithObjects:query, database, nil] forKey:pageKey];
+	}
+
+	startPrefetcher = ([queuedPageKeys count] && !prefetcherRunning && delegate);
+	if (startPrefetcher) prefetcherRunning = YES;
+
+	pthread_mutex_unlock(&prefetchLock);
+
+	if (startPrefetcher) {
+		[NSThread detachNewThreadWithName:@"SPTablePagePrefetcher page prefetch task" target:self selector:@selector(_prefetchPagesTask) object:nil];
+	}
+}
+
+/**
+ * Returns a fully downloaded result store for the supplied query if the page has been
+ * prefetched, removing it from the cache, or nil.  If the page is being prefetched the
+ * prefetch is waited for.  Should not be called on the main thread.
+ */
+- (SPMySQLStreamingResultStore *)prefetchedResultStoreForQuery:(NSString *)query inDatabase:(NSString *)database
+{
+	SPMySQLStreamingResultStore *resultStore = nil;
+
+	if (!query || !database) return nil;
+
+	NSString *pageKey = [self _keyForQuery:query inDatabase:database];
+
+	pthread_mutex_lock(&prefetchLock);
+
+	// The page is no longer needed from the queue
+	[queuedPageKeys removeObject:pageKey];
+	[queuedPages removeObjectForKey:pageKey];
+
+	while ([activePageKey isEqualToString:pageKey]) {
+		pthread_cond_wait(&prefetchCondition, &prefetchLock);
+	}
+
+	NSArray *prefetchedPage = [prefetchedPages objectForKey:pageKey];
+	if (prefetchedPage) {
+		if (-[[prefetchedPage objectAtIndex:1] timeIntervalSinceNow] < SPTablePagePrefetchMaximumAge) {
+			resultStore = [[[prefetchedPage objectAtIndex:0] retain] autorelease];
+		}
+		[prefetchedPages removeObjectForKey:pageKey];
+		[prefetchedPageKeys removeObject:pageKey];
+	}
+
+	pthread_mutex_unlock(&prefetchLock);
+
+	return resultStore;
+}
+
+/**
+ * Discard all prefetched and queued pages and cancel any prefetch in progress, for use
+ * when the pages may no longer match the table, such as after edits.
+ */
+- (void)invalidate
+{
+	pthread_mutex_lock(&prefetchLock);
+	prefetchGeneration++;
+	[queuedPageKeys removeAllObjects];
+	[queuedPages removeAllObjects];
+	[prefetchedPages removeAllObjects];
+	[prefetchedPageKeys removeAllObjects];
+	if (activePageKey) [connectionPool cancelQueryForUser:self];
+	pthread_mutex_unlock(&prefetchLock);
+}
+
+#pragma mark -
+#pragma mark Result store delegate
+
+/**
+ * Called on the download thread when a prefetched page's result store has
+ * finished loading; wakes the prefetch thread waiting on that store.
+ */
+- (void)resultStoreDidFinishLoadingData:(SPMySQLStreamingResultStore *)resultStore
+{
+	pthread_mutex_lock(&prefetchLock);
+	pthread_cond_broadcast(&prefetchCondition);
+	pthread_mutex_unlock(&prefetchLock);
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+
+	[self destroy:nil];
+
+	pthread_mutex_destroy(&prefetchLock);
+	pthread_cond_destroy(&prefetchCondition);
+
+	if (connectionPool) [connectionPool release], connectionPool = nil;
+	if (queuedPageKeys) [queuedPageKeys release], queuedPageKeys = nil;
+	if (queuedPages) [queuedPages release], queuedPages = nil;
+	if (prefetchedPages) [prefetchedPages release], prefetchedPages = nil;
+	if (prefetchedPageKeys) [prefetchedPageKeys release], prefetchedPageKeys = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPTablePagePrefetcher (Private_API)
+
+/**
+ * Returns the key identifying a page query in a database.
+ */
+- (NSString *)_keyForQuery:(NSString *)query inDatabase:(NSString *)database
+{
+	return [NSString stringWithFormat:@"%@ %@", [database backtickQuotedString], query];
+}
+
+/**
+ * Prefetch queued pages one at a time until the queue is empty, caching each fully
+ * downloaded result unless the cache was invalidated while it was fetched.
+ * Should always be executed on a background thread.
+ */
+- (void)_prefetchPagesTask
+{
+	NSAutoreleasePool *prefetchPool = [[NSAutoreleasePool alloc] init];
+
+	while (1) {
+		NSAutoreleasePool *pagePool = [[NSAutoreleasePool alloc] init];
+		SPMySQLStreamingResultStore *resultStore = nil;
+		SPMySQLConnection *prefetchConnection;
+		SPConnectionPool *pool;
+		NSString *pageKey, *query, *database;
+		NSArray *queuedPage;
+		NSUInteger generation;
+
+		pthread_mutex_lock(&prefetchLock);
+		if (![queuedPageKeys count] || !delegate) {
+			prefetcherRunning = NO;
+			pthread_mutex_unlock(&prefetchLock);
+			[pagePool drain];
+			break;
+		}
+		pageKey = [[[queuedPageKeys objectAtIndex:0] retain] autorelease];
+		queuedPage = [[[queuedPages objectForKey:pageKey] retain] autorelease];
+		query = [queuedPage objectAtIndex:0];
+		database = [queuedPage objectAtIndex:1];
+		[queuedPageKeys removeObjectAtIndex:0];
+		[queuedPages removeObjectForKey:pageKey];
+		activePageKey = [pageKey retain];
+		generation = prefetchGeneration;
+		pool = [[connectionPool retain] autorelease];
+		pthread_mutex_unlock(&prefetchLock);
+
+		prefetchConnection = [pool checkOutConnectionForUser:self database:database];
+		if (prefetchConnection) {
+			resultStore = [prefetchConnection resultStoreFromQueryString:query];
+			if (resultStore) {
+				[resultStore setDelegate:self];
+				[resultStore startDownload];
+
+				// Sleep until the store reports that its download has finished
+				pthread_mutex_lock(&prefetchLock);
+				while (![resultStore dataDownloaded]) pthread_cond_wait(&prefetchCondition, &prefetchLock);
+				pthread_mutex_unlock(&prefetchLock);
+				[resultStore setDelegate:nil];
+			}
+			if ([prefetchConnection queryErrored] || [prefetchConnection lastQueryWasCancelled]) resultStore = nil;
+			[pool checkInConnection:prefetchConnection];
+		}
+
+		pthread_mutex_lock(&prefetchLock);
+		if (resultStore && generation == prefetchGeneration) {
+			[prefetchedPages setObject:[NSArray arrayWithObjects:resultStore, [NSDate date], nil] forKey:pageKey];
+			[prefetchedPageKeys addObject:pageKey];
+			while ([prefetchedPageKeys count] > SPTablePagePrefetchCacheLimit) {
+				[prefetchedPages removeObjectForKey:[prefetchedPageKeys objectAtIndex:0]];
+				[prefetchedPageKeys removeObjectAtIndex:0];
+			}
+		}
+		[activePageKey release], activePageKey = nil;
+		pthread_cond_broadcast(&prefetchCondition);
+		pthread_mutex_unlock(&prefetchLock);
+
+		[pagePool drain];
+	}
+
+	[prefetchPool drain];
+}
+
+@end
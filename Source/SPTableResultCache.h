@@ -0,0 +1,65 @@
+//
+//  $Id$
+//
+//  SPTableResultCache.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import <SPMySQL/SPMySQL.h>
+
+/**
+ * Keeps the fully downloaded results of recent table content queries, so that returning to
+ * a table - by switching back to it, or through the navigation history - can show the same
+ * rows again without rerunning the query.  Results are keyed by database, table and query,
+ * which covers the filter, sort order and page, and each is stored with a validation probe
+ * describing the table's state when it was loaded; a result is only returned for a matching
+ * probe.
+ *
+ * The cache is bounded both by the number of results and by their total number of cells,
+ * discarding the least recently used results first.
+ */
+@interface SPTableResultCache : NSObject
+{
+	NSMutableDictionary *cachedResults;
+	NSMutableArray *cachedResultKeys;
+	NSUInteger cachedCellCount;
+
+	pthread_mutex_t cacheLock;
+}
+
+// Cached results
+- (SPMySQLStreamingResultStore *)resultStoreForQuery:(NSString *)query table:(NSString *)table inDatabase:(NSString *)database validationProbe:(NSString *)probe;
+- (void)cacheResultStore:(SPMySQLStreamingResultStore *)resultStore forQuery:(NSString *)query table:(NSString *)table inDatabase:(NSString *)database validationProbe:(NSString *)probe;
+
+// Invalidation
+- (void)invalidateTable:(NSString *)table inDatabase:(NSString *)database;
+- (void)invalidate;
+
+@end
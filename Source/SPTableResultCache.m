@@ -0,0 +1,211 @@
+//
+//  $Id$
+//
+//  SPTableResultCache.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPTableResultCache.h"
+
+#import <pthread.h>
+
+// The number of results kept
+static const NSUInteger SPTableResultCacheEntryLimit = 8;
+
+// The total number of cells in the results kept; larger results aren't cached at all
+static const NSUInteger SPTableResultCacheCellLimit = 4000000;
+
+@interface SPTableResultCache (Private_API)
+
+- (NSString *)_keyPrefixForTable:(NSString *)table inDatabase:(NSString *)database;
+- (void)_removeResultForKey:(NSString *)resultKey;
+
+@end
+
+#pragma mark -
+
+@implementation SPTableResultCache
+
+#pragma mark -
+#pragma mark Setup
+
+- (id)init
+{
+	if ((self = [super init])) {
+		cachedResults = [[NSMutableDictionary alloc] init];
+		cachedResultKeys = [[NSMutableArray alloc] init];
+		cachedCellCount = 0;
+
+		pthread_mutex_init(&cacheLock, NULL);
+	}
+
+	return self;
+}
+
+#pragma mark -
+#pragma mark Cached results
+
+/**
+ * Returns the cached result of a query on a table, if there is one and it was stored with
+ * the supplied validation probe, or nil.  A result stored with a different probe is out of
+ * date and is discarded.
+ */
+- (SPMySQLStreamingResultStore *)resultStoreForQuery:(NSString *)query table:(NSString *)table inDatabase:(NSString *)database validationProbe:(NSString *)probe
+{
+	SPMySQLStreamingResultStore *resultStore = nil;
+
+	if (!query || !table || !database || !probe) return nil;
+
+	NSString *resultKey = [[self _keyPrefixForTable:table inDatabase:database] stringByAppendingString:query];
+
+	pthread_mutex_lock(&cacheLock);
+
+	NSArray *cachedResult = [cachedResults objectForKey:resultKey];
+	if (cachedResult) {
+		if ([[cachedResult objectAtIndex:1] isEqualToString:probe]) {
+			resultStore = [[[cachedResult objectAtIndex:0] retain] autorelease];
+
+			// Mark the result as the most recently used
+			[cachedResultKeys removeObject:resultKey];
+			[cachedResultKeys addObject:resultKey];
+		} else {
+			[self _removeResultForKey:resultKey];
+		}
+	}
+
+	pthread_mutex_unlock(&cacheLock);
+
+	return resultStore;
+}
+
+/**
+ * Store the fully downloaded result of a query on a table, with a probe describing the
+ * state of the table when the query was run, replacing any earlier result of the query.
+ */
+- (void)cacheResultStore:(SPMySQLStreamingResultStore *)resultStore forQuery:(NSString *)query table:(NSString *)table inDatabase:(NSString *)database validationProbe:(NSString *)probe
+{
+	if (!resultStore || ![resultStore dataDownloaded] || !query || !table || !database || !probe) return;
+
+	NSUInteger cellCount = (NSUInteger)[resultStore numberOfRows] * [resultStore numberOfFields];
+	if (cellCount > SPTableResultCacheCellLimit) return;
+
+	NSString *resultKey = [[self _keyPrefixForTable:table inDatabase:database] stringByAppendingString:query];
+
+	pthread_mutex_lock(&cacheLock);
+
+	[self _removeResultForKey:resultKey];
+
+	[cachedResults setObject:[NSArray arrayWithObjects:resultStore, probe, [NSNumber numberWithUnsignedInteger:cellCount], nil] forKey:resultKey];
+	[cachedResultKeys addObject:resultKey];
+	cachedCellCount += cellCount;
+
+	// Discard the least recently used results until within the limits
+	while ([cachedResultKeys count] > SPTableResultCacheEntryLimit || cachedCellCount > SPTableResultCacheCellLimit) {
+		[self _removeResultForKey:[cachedResultKeys objectAtIndex:0]];
+	}
+
+	pthread_mutex_unlock(&cacheLock);
+}
+
+#pragma mark -
+#pragma mark Invalidation
+
+/**
+ * Discard all cached results of queries on a table, for use after it has been changed.
+ */
+- (void)invalidateTable:(NSString *)table inDatabase:(NSString *)database
+{
+	if (!table || !database) return;
+
+	NSString *keyPrefix = [self _keyPrefixForTable:table inDatabase:database];
+
+	pthread_mutex_lock(&cacheLock);
+	for (NSString *resultKey in [NSArray arrayWithArray:cachedResultKeys]) {
+		if ([resultKey hasPrefix:keyPrefix]) [self _removeResultForKey:resultKey];
+	}
+	pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * Discard all cached results.
+ */
+- (void)invalidate
+{
+	pthread_mutex_lock(&cacheLock);
+	[cachedResults removeAllObjects];
+	[cachedResultKeys removeAllObjects];
+	cachedCellCount = 0;
+	pthread_mutex_unlock(&cacheLock);
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	pthread_mutex_destroy(&cacheLock);
+
+	if (cachedResults) [cachedResults release], cachedResults = nil;
+	if (cachedResultKeys) [cachedResultKeys release], cachedResultKeys = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPTableResultCache (Private_API)
+
+/**
+ * Returns the start of the keys of all results for a table.
+ */
+- (NSString *)_keyPrefixForTable:(NSString *)table inDatabase:(NSString *)database
+{
+	return [NSString stringWithFormat:@"%@.%@ ", [database backtickQuotedString], [table backtickQuotedString]];
+}
+
+/**
+ * Remove a cached result, if present.  Should be called with the cache lock held.
+ */
+- (void)_removeResultForKey:(NSString *)resultKey
+{
+	NSArray *cachedResult = [cachedResults objectForKey:resultKey];
+	if (!cachedResult) return;
+
+	// The key may be owned by the key list alone
+	[[resultKey retain] autorelease];
+
+	cachedCellCount -= [[cachedResult objectAtIndex:2] unsignedIntegerValue];
+	[cachedResultKeys removeObject:resultKey];
+	[cachedResults removeObjectForKey:resultKey];
+}
+
+@end
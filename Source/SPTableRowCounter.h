@@ -0,0 +1,79 @@
+//
+//  $Id$
+//
+//  SPTableRowCounter.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+@class SPDatabaseDocument;
+@class SPConnectionPool;
+
+#import <SPMySQL/SPMySQL.h>
+
+/**
+ * Counts the rows in tables, and the rows matching filters on them, without blocking the
+ * document's connection.  Estimates are available immediately, from the table status or
+ * the query plan, while exact counts are run in the background on a pooled connection;
+ * a new count request cancels any count still running.  Exact counts are cached until the
+ * table appears to have changed.
+ *
+ * When an exact count completes, a SPTableRowCountDidFinishNotification is posted on the
+ * main thread, with the table, database, where clause (if any) and row count in its
+ * userInfo dictionary.
+ */
+@interface SPTableRowCounter : NSObject
+{
+	SPDatabaseDocument *delegate;
+	SPConnectionPool *connectionPool;
+
+	NSMutableDictionary *cachedCounts;
+	NSUInteger countGeneration;
+
+	pthread_mutex_t countLock;
+	pthread_mutex_t countTaskLock;
+}
+
+// Setup and teardown
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate;
+- (void)setConnectionPool:(SPConnectionPool *)aConnectionPool;
+- (void)destroy:(NSNotification *)notification;
+
+// Estimates
+- (NSInteger)estimatedRowCountForTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause usingConnection:(SPMySQLConnection *)connection;
+
+// Cached counts
+- (BOOL)getCachedRowCount:(NSInteger *)rowCount forTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause tableStatus:(NSDictionary *)tableStatus;
+- (void)setRowCount:(NSInteger)rowCount forTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause tableStatus:(NSDictionary *)tableStatus;
+- (void)invalidateCountsForTable:(NSString *)table inDatabase:(NSString *)database;
+
+// Exact counts
+- (void)countRowsInTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause tableStatus:(NSDictionary *)tableStatus;
+- (void)cancelCount;
+
+@end
@@ -0,0 +1,350 @@
+//
+//  $Id$
+//
+//  SPTableRowCounter.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPTableRowCounter.h"
+#import "SPDatabaseDocument.h"
+#import "SPConnectionPool.h"
+#import "SPThreadAdditions.h"
+
+#import <pthread.h>
+
+@interface SPTableRowCounter (Private_API)
+
+- (NSString *)_keyForTable:(NSString *)table inDatabase:(NSString *)database;
+- (NSString *)_validityTokenForTableStatus:(NSDictionary *)tableStatus;
+- (void)_setRowCount:(NSInteger)rowCount forTableKey:(NSString *)tableKey whereClause:(NSString *)whereClause validityToken:(NSString *)validityToken;
+- (void)_countRowsWithDetails:(NSDictionary *)countDetails;
+
+@end
+
+#pragma mark -
+
+@implementation SPTableRowCounter
+
+#pragma mark -
+#pragma mark Setup and teardown
+
+/**
+ * Prevent SPTableRowCounter from being init'd normally.
+ */
+- (id)init
+{
+	[NSException raise:NSInternalInconsistencyException format:@"SPTableRowCounters should not be init'd directly; use initWithDelegate: instead."];
+	return nil;
+}
+
+/**
+ * Standard init method, constructing the SPTableRowCounter around a delegate which
+ * supplies connection details.
+ */
+- (id)initWithDelegate:(SPDatabaseDocument *)theDelegate
+{
+	if ((self = [super init])) {
+
+		// Keep a weak reference to the delegate
+		delegate = theDelegate;
+
+		connectionPool = nil;
+
+		cachedCounts = [[NSMutableDictionary alloc] init];
+		countGeneration = 0;
+
+		[[NSNotificationCenter defaultCenter] addObserver:self
+												 selector:@selector(destroy:)
+													 name:SPDocumentWillCloseNotification
+												   object:delegate];
+
+		pthread_mutex_init(&countLock, NULL);
+		pthread_mutex_init(&countTaskLock, NULL);
+	}
+
+	return self;
+}
+
+/**
+ * Set the pool exact counts are run on a connection from.
+ */
+- (void)setConnectionPool:(SPConnectionPool *)aConnectionPool
+{
+	pthread_mutex_lock(&countLock);
+	if (connectionPool) [connectionPool release];
+	connectionPool = [aConnectionPool retain];
+	pthread_mutex_unlock(&countLock);
+}
+
+/**
+ * Cancel any count in progress and stop using the delegate.
+ */
+- (void)destroy:(NSNotification *)notification
+{
+	[self cancelCount];
+
+	pthread_mutex_lock(&countLock);
+	delegate = nil;
+	pthread_mutex_unlock(&countLock);
+}
+
+#pragma mark -
+#pragma mark Estimates
+
+/**
+ * Returns an estimate of the number of rows matching a where clause, as reported by the
+ * query plan for the table, or -1 if no estimate is available.  The EXPLAIN is run on the
+ * supplied connection, as it is cheap and the result is required immediately.
+ */
+- (NSInteger)estimatedRowCountForTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause usingConnection:(SPMySQLConnection *)connection
+{
+	NSMutableString *queryString = [NSMutableString stringWithFormat:@"EXPLAIN SELECT * FROM %@", [self _keyForTable:table inDatabase:database]];
+	if (whereClause) [queryString appendFormat:@" WHERE %@", whereClause];
+
+	SPMySQLResult *planResult = [connection queryString:queryString];
+	if ([connection queryErrored]) return -1;
+
+	[planResult setReturnDataAsStrings:YES];
+	id estimatedRows = [[planResult getRowAsDictionary] objectForKey:@"rows"];
+	if (!estimatedRows || [estimatedRows isNSNull]) return -1;
+
+	return [estimatedRows integerValue];
+}
+
+#pragma mark -
+#pragma mark Cached counts
+
+/**
+ * Retrieve an exact count previously made for a table and where clause, provided the
+ * table status doesn't suggest that the table has changed since.  Returns NO if no
+ * usable count is cached.
+ */
+- (BOOL)getCachedRowCount:(NSInteger *)rowCount forTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause tableStatus:(NSDictionary *)tableStatus
+{
+	BOOL countFound = NO;
+
+	if (!table || !database) return NO;
+
+	pthread_mutex_lock(&countLock);
+	NSArray *cachedCount = [[cachedCounts objectForKey:[self _keyForTable:table inDatabase:database]] objectForKey:whereClause ? whereClause : @""];
+	if (cachedCount && [[cachedCount objectAtIndex:1] isEqualToString:[self _validityTokenForTableStatus:tableStatus]]) {
+		*rowCount = [[cachedCount objectAtIndex:0] integerValue];
+		countFound = YES;
+	}
+	pthread_mutex_unlock(&countLock);
+
+	return countFound;
+}
+
+/**
+ * Cache an exact count established elsewhere, for example by loading all the rows of a
+ * table, so that it doesn't need to be counted again.
+ */
+- (void)setRowCount:(NSInteger)rowCount forTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause tableStatus:(NSDictionary *)tableStatus
+{
+	if (!table || !database) return;
+
+	[self _setRowCount:rowCount forTableKey:[self _keyForTable:table inDatabase:database] whereClause:whereClause validityToken:[self _validityTokenForTableStatus:tableStatus]];
+}
+
+/**
+ * Discard all the cached counts for a table, for use after its rows have been modified.
+ */
+- (void)invalidateCountsForTable:(NSString *)table inDatabase:(NSString *)database
+{
+	if (!table || !database) return;
+
+	pthread_mutex_lock(&countLock);
+	[cachedCounts removeObjectForKey:[self _keyForTable:table inDatabase:database]];
+	pthread_mutex_unlock(&countLock);
+}
+
+#pragma mark -
+#pragma mark Exact counts
+
+/**
+ * Start an exact count of the rows in a table, optionally restricted by a where clause,
+ * in a background thread.  Any count still running is cancelled first.
+ */
+- (void)countRowsInTable:(NSString *)table inDatabase:(NSString *)database whereClause:(NSString *)whereClause tableStatus:(NSDictionary *)tableStatus
+{
+	if (!table || !database) return;
+
+	[self cancelCount];
+
+	pthread_mutex_lock(&countLock);
+	NSMutableDictionary *countDetails = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+		table, @"table",
+		database, @"database",
+		[self _validityTokenForTableStatus:tableStatus], @"validityToken",
+		[NSNumber numberWithUnsignedInteger:countGeneration], @"generation",
+		nil];
+	if (whereClause) [countDetails setObject:whereClause forKey:@"whereClause"];
+	pthread_mutex_unlock(&countLock);
+
+	[NSThread detachNewThreadWithName:[NSString stringWithFormat:@"SPTableRowCounter count of %@", table]
+							   target:self
+							 selector:@selector(_countRowsWithDetails:)
+							   object:countDetails];
+}
+
+/**
+ * Cancel any count in progress; the results of cancelled counts are discarded.
+ */
+- (void)cancelCount
+{
+	pthread_mutex_lock(&countLock);
+	countGeneration++;
+
+	// If a count is running, cancel its query
+	[connectionPool cancelQueryForUser:self];
+	pthread_mutex_unlock(&countLock);
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+
+	[self destroy:nil];
+
+	pthread_mutex_destroy(&countLock);
+	pthread_mutex_destroy(&countTaskLock);
+
+	if (connectionPool) [connectionPool release], connectionPool = nil;
+	if (cachedCounts) [cachedCounts release], cachedCounts = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark -
+#pragma mark Private API
+
+@implementation SPTableRowCounter (Private_API)
+
+/**
+ * Returns the fully qualified, quoted name of a table, used both in queries and as the key
+ * for its cached counts.
+ */
+- (NSString *)_keyForTable:(NSString *)table inDatabase:(NSString *)database
+{
+	return [NSString stringWithFormat:@"%@.%@", [database backtickQuotedString], [table backtickQuotedString]];
+}
+
+/**
+ * Returns a string which changes when the table status suggests the table has been
+ * modified; the row count estimate is left out as it varies between calls for InnoDB.
+ */
+- (NSString *)_validityTokenForTableStatus:(NSDictionary *)tableStatus
+{
+	return [NSString stringWithFormat:@"%@/%@", [tableStatus objectForKey:@"Update_time"], [tableStatus objectForKey:@"Data_length"]];
+}
+
+/**
+ * Store an exact count in the cache, along with the table status it was made against.
+ */
+- (void)_setRowCount:(NSInteger)rowCount forTableKey:(NSString *)tableKey whereClause:(NSString *)whereClause validityToken:(NSString *)validityToken
+{
+	NSArray *cachedCount = [NSArray arrayWithObjects:[NSNumber numberWithInteger:rowCount], validityToken, nil];
+
+	pthread_mutex_lock(&countLock);
+	NSMutableDictionary *tableCounts = [cachedCounts objectForKey:tableKey];
+	if (!tableCounts) {
+		tableCounts = [NSMutableDictionary dictionary];
+		[cachedCounts setObject:tableCounts forKey:tableKey];
+	}
+	[tableCounts setObject:cachedCount forKey:whereClause ? whereClause : @""];
+	pthread_mutex_unlock(&countLock);
+}
+
+/**
+ * Run an exact count on a pooled connection, one count at a time, caching the result
+ * and notifying observers unless the count was cancelled.
+ * Should always be executed on a background thread.
+ */
+- (void)_countRowsWithDetails:(NSDictionary *)countDetails
+{
+	NSAutoreleasePool *countPool = [[NSAutoreleasePool alloc] init];
+	NSUInteger generation = [[countDetails objectForKey:@"generation"] unsignedIntegerValue];
+	NSString *table = [countDetails objectForKey:@"table"];
+	NSString *database = [countDetails objectForKey:@"database"];
+	NSString *whereClause = [countDetails objectForKey:@"whereClause"];
+	NSInteger rowCount = -1;
+	SPMySQLConnection *countConnection = nil;
+	SPConnectionPool *pool;
+	BOOL countIsCurrent;
+
+	// Wait for any cancelled count to finish with its connection
+	pthread_mutex_lock(&countTaskLock);
+
+	// Skip the count if it has been superseded while waiting
+	pthread_mutex_lock(&countLock);
+	countIsCurrent = (generation == countGeneration);
+	pool = [[connectionPool retain] autorelease];
+	pthread_mutex_unlock(&countLock);
+
+	if (countIsCurrent) countConnection = [pool checkOutConnectionForUser:self database:nil];
+	if (countConnection) {
+		NSMutableString *queryString = [NSMutableString stringWithFormat:@"SELECT COUNT(1) FROM %@", [self _keyForTable:table inDatabase:database]];
+		if (whereClause) [queryString appendFormat:@" WHERE %@", whereClause];
+
+		SPMySQLResult *countResult = [countConnection queryString:queryString];
+		if (![countConnection queryErrored] && ![countConnection lastQueryWasCancelled]) {
+			[countResult setReturnDataAsStrings:YES];
+			rowCount = [[[countResult getRowAsArray] objectAtIndex:0] integerValue];
+		}
+		[pool checkInConnection:countConnection];
+	}
+
+	pthread_mutex_unlock(&countTaskLock);
+
+	pthread_mutex_lock(&countLock);
+	countIsCurrent = (generation == countGeneration && delegate);
+	pthread_mutex_unlock(&countLock);
+
+	if (rowCount >= 0 && countIsCurrent) {
+		[self _setRowCount:rowCount forTableKey:[self _keyForTable:table inDatabase:database] whereClause:whereClause validityToken:[countDetails objectForKey:@"validityToken"]];
+
+		NSMutableDictionary *countInfo = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+			table, @"table",
+			database, @"database",
+			[NSNumber numberWithInteger:rowCount], @"rowCount",
+			nil];
+		if (whereClause) [countInfo setObject:whereClause forKey:@"whereClause"];
+
+		[[NSNotificationCenter defaultCenter] postNotificationOnMainThread:[NSNotification notificationWithName:SPTableRowCountDidFinishNotification object:self userInfo:countInfo]];
+	}
+
+	[countPool drain];
+}
+
+@end
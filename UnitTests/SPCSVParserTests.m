@@ -0,0 +1,211 @@
+//
+//  $Id$
+//
+//  SPCSVParserTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPCSVParserTests.h"
+#import "SPCSVParser.h"
+
+@implementation SPCSVParserTests
+
+/**
+ * Quoted fields test case.
+ */
+- (void)testQuotedFields
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] initWithString:@"a,\"b,c\",\"d\ne\"\n1,2,3\n"];
+	NSArray *expectedArray = [NSArray arrayWithObjects:
+		[NSArray arrayWithObjects:@"a", @"b,c", @"d\ne", nil],
+		[NSArray arrayWithObjects:@"1", @"2", @"3", nil],
+		nil];
+	NSArray *resultArray = [parser array];
+
+	STAssertEqualObjects(resultArray, expectedArray, @"The parsed rows should look like: %@, but actually look like: %@", expectedArray, resultArray);
+
+	[parser release];
+}
+
+/**
+ * Escaped quotes, terminators and escapes test case.
+ */
+- (void)testEscapes
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] initWithString:@"\"say \\\"hi\\\"\",a\\,b,c\\\\\n"];
+	NSArray *expectedRow = [NSArray arrayWithObjects:@"say \"hi\"", @"a,b", @"c\\", nil];
+	NSArray *resultRow = [parser getRowAsArray];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+
+	[parser release];
+}
+
+/**
+ * Doubled quotes test case, both with the quote as the escape string and with the loose
+ * escape matching fallback.
+ */
+- (void)testDoubledQuotes
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] initWithString:@"\"say \"\"hi\"\"\",x\n"];
+	[parser setEscapeString:@"\"" convertDisplayStrings:NO];
+
+	NSArray *expectedRow = [NSArray arrayWithObjects:@"say \"hi\"", @"x", nil];
+	NSArray *resultRow = [parser getRowAsArray];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+
+	[parser release];
+
+	parser = [[SPCSVParser alloc] initWithString:@"\"it\"\"s\",y\n"];
+
+	expectedRow = [NSArray arrayWithObjects:@"it\"s", @"y", nil];
+	resultRow = [parser getRowAsArray];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+
+	[parser release];
+}
+
+/**
+ * Null replacement test case.
+ */
+- (void)testNullReplacement
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] initWithString:@"NULL,\"NULL\",\\N,x\n"];
+	[parser setNullReplacementString:@"NULL"];
+
+	NSArray *expectedRow = [NSArray arrayWithObjects:[NSNull null], @"NULL", [NSNull null], @"x", nil];
+	NSArray *resultRow = [parser getRowAsArray];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"Only unquoted null strings should be replaced; the row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+
+	[parser release];
+}
+
+/**
+ * Empty rows test case.
+ */
+- (void)testEmptyRowsAreSkipped
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] initWithString:@"a,b\n\n  \nc,d\n\n"];
+	NSArray *expectedArray = [NSArray arrayWithObjects:
+		[NSArray arrayWithObjects:@"a", @"b", nil],
+		[NSArray arrayWithObjects:@"c", @"d", nil],
+		nil];
+	NSArray *resultArray = [parser array];
+
+	STAssertEqualObjects(resultArray, expectedArray, @"The parsed rows should look like: %@, but actually look like: %@", expectedArray, resultArray);
+
+	[parser release];
+}
+
+/**
+ * Whitespace trimming test case.
+ */
+- (void)testWhitespaceTrimming
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] initWithString:@"  a,\tb,  \" c \"  ,d\n"];
+	NSArray *expectedRow = [NSArray arrayWithObjects:@"a", @"b", @" c ", @"d", nil];
+	NSArray *resultRow = [parser getRowAsArray];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"Unquoted whitespace should be skipped; the row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+
+	[parser release];
+}
+
+/**
+ * Appended chunks test case.
+ */
+- (void)testAppendedChunks
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] init];
+	NSArray *expectedRow, *resultRow;
+
+	[parser appendString:@"a,\"b\n"];
+
+	STAssertNil([parser getRowAsArrayAndTrimString:YES stringIsComplete:NO], @"An incomplete row should not be returned");
+
+	[parser appendString:@"c\",d\n1,"];
+
+	expectedRow = [NSArray arrayWithObjects:@"a", @"b\nc", @"d", nil];
+	resultRow = [parser getRowAsArrayAndTrimString:YES stringIsComplete:NO];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+	STAssertNil([parser getRowAsArrayAndTrimString:YES stringIsComplete:NO], @"An incomplete row should not be returned");
+
+	[parser appendString:@"2,3"];
+
+	STAssertNil([parser getRowAsArrayAndTrimString:YES stringIsComplete:NO], @"A row without a line ending should not be returned until the string is complete");
+
+	expectedRow = [NSArray arrayWithObjects:@"1", @"2", @"3", nil];
+	resultRow = [parser getRowAsArrayAndTrimString:YES stringIsComplete:YES];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+	STAssertNil([parser getRowAsArrayAndTrimString:YES stringIsComplete:YES], @"No further rows should be returned");
+
+	[parser release];
+}
+
+/**
+ * Multibyte characters split across appended chunks test case.
+ */
+- (void)testMultibyteCharacterSplitAcrossChunks
+{
+	SPCSVParser *parser = [[SPCSVParser alloc] init];
+	NSArray *expectedRow, *resultRow;
+
+	STAssertTrue([parser setDataEncoding:NSUTF8StringEncoding], @"UTF-8 data should be parsed directly");
+
+	[parser appendData:[NSData dataWithBytes:"caf\xc3" length:4]];
+
+	STAssertNil([parser getRowAsArrayAndTrimString:YES stringIsComplete:NO], @"An incomplete row should not be returned");
+	STAssertFalse([parser dataDecodingFailed], @"A character split across chunks should not be decoded until complete");
+
+	[parser appendData:[NSData dataWithBytes:"\xa9,x\n\"\xe2\x82" length:7]];
+
+	expectedRow = [NSArray arrayWithObjects:[NSString stringWithUTF8String:"caf\xc3\xa9"], @"x", nil];
+	resultRow = [parser getRowAsArrayAndTrimString:YES stringIsComplete:NO];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+	STAssertNil([parser getRowAsArrayAndTrimString:YES stringIsComplete:NO], @"An incomplete row should not be returned");
+	STAssertFalse([parser dataDecodingFailed], @"A character split across chunks should not be decoded until complete");
+
+	[parser appendData:[NSData dataWithBytes:"\xac\",y\n" length:5]];
+
+	expectedRow = [NSArray arrayWithObjects:[NSString stringWithUTF8String:"\xe2\x82\xac"], @"y", nil];
+	resultRow = [parser getRowAsArrayAndTrimString:YES stringIsComplete:YES];
+
+	STAssertEqualObjects(resultRow, expectedRow, @"The parsed row should look like: %@, but actually looks like: %@", expectedRow, resultRow);
+	STAssertFalse([parser dataDecodingFailed], @"The data should have been decoded successfully");
+
+	[parser release];
+}
+
+@end
@@ -0,0 +1,155 @@
+//
+//  $Id$
+//
+//  SPDataStorageFilteringTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPDataStorageFilteringTests.h"
+#import "SPDataStorageFiltering.h"
+
+/**
+ * Returns the definition of a text column with the supplied collation.
+ */
+static NSDictionary *_SPStringColumnDefinition(NSString *collation)
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:@"string", @"typegrouping", @"VARCHAR", @"type", collation, @"charset_collation", nil];
+}
+
+/**
+ * Returns a LIKE filter on the first column for the supplied pattern.
+ */
+static SPDataStorageFilter *_SPLikeFilter(NSString *pattern, BOOL caseSensitive)
+{
+	return [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterLike columnIndex:0 arguments:[NSArray arrayWithObject:pattern] caseSensitive:caseSensitive] autorelease];
+}
+
+@implementation SPDataStorageFilteringTests
+
+/**
+ * LIKE wildcards test case.
+ */
+- (void)testLikeWildcards
+{
+	NSDictionary *column = _SPStringColumnDefinition(@"utf8_general_ci");
+	SPDataStorageFilter *filter = _SPLikeFilter(@"a%c", YES);
+
+	STAssertTrue([filter matchesValue:@"abc" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'abc' should match 'a%%c'");
+	STAssertTrue([filter matchesValue:@"ac" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'ac' should match 'a%%c'");
+	STAssertTrue([filter matchesValue:@"abcbc" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'abcbc' should match 'a%%c'");
+	STAssertFalse([filter matchesValue:@"abd" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'abd' should not match 'a%%c'");
+
+	filter = _SPLikeFilter(@"a_c", YES);
+
+	STAssertTrue([filter matchesValue:@"abc" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'abc' should match 'a_c'");
+	STAssertTrue([filter matchesValue:[NSString stringWithUTF8String:"a\xc3\xa9" "c"] columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"A multibyte character should match '_'");
+	STAssertFalse([filter matchesValue:@"ac" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'ac' should not match 'a_c'");
+	STAssertFalse([filter matchesValue:@"abbc" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'abbc' should not match 'a_c'");
+
+	filter = _SPLikeFilter(@"%b%", YES);
+
+	STAssertTrue([filter matchesValue:@"abc" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'abc' should match '%%b%%'");
+	STAssertFalse([filter matchesValue:@"ac" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'ac' should not match '%%b%%'");
+	STAssertFalse([filter matchesValue:[NSNull null] columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"NULL should not match '%%b%%'");
+}
+
+/**
+ * Escaped LIKE wildcards test case.
+ */
+- (void)testEscapedWildcards
+{
+	NSDictionary *column = _SPStringColumnDefinition(@"utf8_general_ci");
+	SPDataStorageFilter *filter = [SPDataStorageFilter filterWithClause:@"LIKE '%${}%'" columnIndex:0 arguments:[NSArray arrayWithObject:@"50\\%"] caseSensitive:NO];
+
+	STAssertNotNil(filter, @"A LIKE clause should be evaluated locally");
+	STAssertEqualObjects([[filter arguments] objectAtIndex:0], @"%50\\%%", @"The escaped wildcard should be kept in the pattern");
+	STAssertTrue([filter matchesValue:@"save 50% now" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"An escaped %% should match a literal %%");
+	STAssertFalse([filter matchesValue:@"save 500 now" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"An escaped %% should not match other characters");
+
+	filter = [SPDataStorageFilter filterWithClause:@"LIKE '${}'" columnIndex:0 arguments:[NSArray arrayWithObject:@"a\\_c"] caseSensitive:NO];
+
+	STAssertTrue([filter matchesValue:@"a_c" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"An escaped _ should match a literal _");
+	STAssertFalse([filter matchesValue:@"abc" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"An escaped _ should not match other characters");
+}
+
+/**
+ * Case and diacritic folding test case.
+ */
+- (void)testCaseAndDiacriticFolding
+{
+	NSDictionary *column = _SPStringColumnDefinition(@"utf8_general_ci");
+	NSString *accented = [NSString stringWithUTF8String:"CAF\xc3\x89"];
+	SPDataStorageFilter *filter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterEquals columnIndex:0 arguments:[NSArray arrayWithObject:@"Cafe"] caseSensitive:NO] autorelease];
+
+	STAssertTrue([filter matchesValue:accented columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"Comparisons should ignore case and accents");
+	STAssertTrue([filter matchesValue:@"cafe  " columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"Comparisons should ignore trailing spaces");
+	STAssertFalse([filter matchesValue:@"cafes" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'cafes' should not equal 'Cafe'");
+	STAssertFalse([filter matchesValue:@"cafe" columnDefinition:_SPStringColumnDefinition(@"utf8_bin") stringEncoding:NSUTF8StringEncoding], @"Binary collations should not fold case");
+	STAssertFalse([filter matchesValue:@"cafe" columnDefinition:_SPStringColumnDefinition(@"latin1_general_cs") stringEncoding:NSUTF8StringEncoding], @"Case sensitive collations should not fold case");
+
+	filter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterEquals columnIndex:0 arguments:[NSArray arrayWithObject:@"Cafe"] caseSensitive:YES] autorelease];
+
+	STAssertFalse([filter matchesValue:@"cafe" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"Case sensitive filters should not fold case");
+
+	filter = _SPLikeFilter([NSString stringWithUTF8String:"%\xc3\x89" "CL%"], NO);
+
+	STAssertTrue([filter matchesValue:[NSString stringWithUTF8String:"une \xc3\xa9" "clair"] columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"LIKE patterns should ignore case and accents");
+	STAssertTrue([filter matchesValue:@"ECLAIR" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"LIKE patterns should ignore case and accents");
+	STAssertFalse([filter matchesValue:@"clair" columnDefinition:column stringEncoding:NSUTF8StringEncoding], @"'clair' should not match the pattern");
+}
+
+/**
+ * narrowsFilter: test case.
+ */
+- (void)testNarrowsFilter
+{
+	SPDataStorageFilter *equalsFilter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterEquals columnIndex:0 arguments:[NSArray arrayWithObject:@"a"] caseSensitive:NO] autorelease];
+	SPDataStorageFilter *otherEqualsFilter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterEquals columnIndex:0 arguments:[NSArray arrayWithObject:@"ab"] caseSensitive:NO] autorelease];
+	SPDataStorageFilter *notLikeFilter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterNotLike columnIndex:0 arguments:[NSArray arrayWithObject:@"%ab%"] caseSensitive:NO] autorelease];
+	SPDataStorageFilter *otherNotLikeFilter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterNotLike columnIndex:0 arguments:[NSArray arrayWithObject:@"%a%"] caseSensitive:NO] autorelease];
+	SPDataStorageFilter *otherColumnFilter = [[[SPDataStorageFilter alloc] initWithOperator:SPDataStorageFilterLike columnIndex:1 arguments:[NSArray arrayWithObject:@"%a%"] caseSensitive:NO] autorelease];
+
+	STAssertTrue([equalsFilter narrowsFilter:equalsFilter], @"A filter should narrow itself");
+	STAssertFalse([otherEqualsFilter narrowsFilter:equalsFilter], @"Comparisons should only narrow the same comparison");
+	STAssertFalse([notLikeFilter narrowsFilter:otherNotLikeFilter], @"NOT LIKE patterns should only narrow the same pattern");
+	STAssertFalse([equalsFilter narrowsFilter:nil], @"A filter should not narrow no filter");
+
+	STAssertTrue([_SPLikeFilter(@"ab%", NO) narrowsFilter:_SPLikeFilter(@"a%", NO)], @"Text added before a trailing wildcard should narrow the filter");
+	STAssertTrue([_SPLikeFilter(@"%ab", NO) narrowsFilter:_SPLikeFilter(@"%b", NO)], @"Text added after a leading wildcard should narrow the filter");
+	STAssertTrue([_SPLikeFilter(@"%xaby%", NO) narrowsFilter:_SPLikeFilter(@"%ab%", NO)], @"Text added within a pattern wildcarded at both ends should narrow the filter");
+	STAssertTrue([_SPLikeFilter(@"%a%", NO) narrowsFilter:_SPLikeFilter(@"%%", NO)], @"Any pattern should narrow a pattern matching everything");
+
+	STAssertFalse([_SPLikeFilter(@"a%", NO) narrowsFilter:_SPLikeFilter(@"ab%", NO)], @"Removing text should not narrow the filter");
+	STAssertFalse([_SPLikeFilter(@"%ba%", NO) narrowsFilter:_SPLikeFilter(@"%ab%", NO)], @"Different text should not narrow the filter");
+	STAssertFalse([_SPLikeFilter(@"ab\\%%", NO) narrowsFilter:_SPLikeFilter(@"a%", NO)], @"Patterns containing escapes should not narrow the filter");
+	STAssertFalse([_SPLikeFilter(@"%ab%", NO) narrowsFilter:otherColumnFilter], @"Filters on other columns should not be narrowed");
+	STAssertFalse([_SPLikeFilter(@"%ab%", YES) narrowsFilter:_SPLikeFilter(@"%a%", NO)], @"Filters with different case sensitivity should not be narrowed");
+}
+
+@end
@@ -0,0 +1,292 @@
+//
+//  $Id$
+//
+//  SPDataStorageSortingTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPDataStorageSortingTests.h"
+#import "SPDataStorageSorting.h"
+#import "SPDataStorageTestResultStore.h"
+
+/**
+ * Returns the definition of an integer column.
+ */
+static NSDictionary *_SPIntegerColumnDefinition(BOOL isUnsigned)
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:@"integer", @"typegrouping", @"INT", @"type", [NSNumber numberWithBool:isUnsigned], @"UNSIGNED_FLAG", nil];
+}
+
+/**
+ * Returns the definition of a text column with the supplied collation.
+ */
+static NSDictionary *_SPStringColumnDefinition(NSString *collation)
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:@"string", @"typegrouping", @"VARCHAR", @"type", collation, @"charset_collation", nil];
+}
+
+/**
+ * Returns a data storage instance holding the supplied rows of strings and NSNulls.
+ */
+static SPDataStorage *_SPDataStorageWithRows(NSArray *rows)
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:rows];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[resultStore release];
+
+	return [dataStorage autorelease];
+}
+
+/**
+ * Returns the values of a column of a data storage instance, in the order they're presented.
+ */
+static NSArray *_SPColumnValues(SPDataStorage *dataStorage, NSUInteger columnIndex)
+{
+	NSMutableArray *values = [NSMutableArray arrayWithCapacity:[dataStorage count]];
+	NSUInteger i;
+
+	for (i = 0; i < [dataStorage count]; i++) {
+		[values addObject:[dataStorage cellDataAtRow:i column:columnIndex]];
+	}
+
+	return values;
+}
+
+/**
+ * Sorts a data storage instance by the supplied columns, all ascending or all descending.
+ */
+static BOOL _SPSortDataStorage(SPDataStorage *dataStorage, NSArray *columnIndexes, BOOL descending, NSArray *columnDefinitions)
+{
+	NSMutableArray *descendingFlags = [NSMutableArray arrayWithCapacity:[columnIndexes count]];
+	NSUInteger i;
+
+	for (i = 0; i < [columnIndexes count]; i++) {
+		[descendingFlags addObject:[NSNumber numberWithBool:descending]];
+	}
+
+	return [dataStorage sortRowsByColumns:columnIndexes descending:descendingFlags columnDefinitions:columnDefinitions stringEncoding:NSUTF8StringEncoding];
+}
+
+@implementation SPDataStorageSortingTests
+
+/**
+ * Signed integers test case.
+ */
+- (void)testSortSignedIntegers
+{
+	NSNull *null = [NSNull null];
+	NSArray *rows = [NSArray arrayWithObjects:
+		[NSArray arrayWithObject:@"10"],
+		[NSArray arrayWithObject:@"-3"],
+		[NSArray arrayWithObject:null],
+		[NSArray arrayWithObject:@"2"],
+		[NSArray arrayWithObject:@"-20"],
+		nil];
+	NSArray *columnDefinitions = [NSArray arrayWithObject:_SPIntegerColumnDefinition(NO)];
+	NSArray *sortColumns = [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:0]];
+	SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+
+	STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, NO, columnDefinitions), @"Integer columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 0), ([NSArray arrayWithObjects:null, @"-20", @"-3", @"2", @"10", nil]), @"NULLs should sort first, and negative values numerically");
+
+	STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, YES, columnDefinitions), @"Integer columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 0), ([NSArray arrayWithObjects:@"10", @"2", @"-3", @"-20", null, nil]), @"A descending sort should reverse the order, with NULLs last");
+}
+
+/**
+ * Unsigned integers test case.
+ */
+- (void)testSortUnsignedIntegers
+{
+	NSArray *rows = [NSArray arrayWithObjects:
+		[NSArray arrayWithObject:@"18446744073709551615"],
+		[NSArray arrayWithObject:@"9223372036854775808"],
+		[NSArray arrayWithObject:@"1"],
+		nil];
+	NSArray *sortColumns = [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:0]];
+	SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+
+	STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, NO, [NSArray arrayWithObject:_SPIntegerColumnDefinition(YES)]), @"Integer columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 0), ([NSArray arrayWithObjects:@"1", @"9223372036854775808", @"18446744073709551615", nil]), @"Unsigned values beyond the signed range should sort last");
+}
+
+/**
+ * Multiple sort columns test case.
+ */
+- (void)testSortMultipleColumns
+{
+	NSArray *rows = [NSArray arrayWithObjects:
+		[NSArray arrayWithObjects:@"b", @"x", @"1", nil],
+		[NSArray arrayWithObjects:@"a", @"y", @"2", nil],
+		[NSArray arrayWithObjects:@"b", @"x", @"3", nil],
+		[NSArray arrayWithObjects:@"a", @"x", @"4", nil],
+		[NSArray arrayWithObjects:@"b", @"w", @"5", nil],
+		nil];
+	NSDictionary *stringColumn = _SPStringColumnDefinition(@"utf8_general_ci");
+	NSArray *columnDefinitions = [NSArray arrayWithObjects:stringColumn, stringColumn, _SPIntegerColumnDefinition(NO), nil];
+	NSArray *sortColumns = [NSArray arrayWithObjects:[NSNumber numberWithUnsignedInteger:0], [NSNumber numberWithUnsignedInteger:1], nil];
+	NSArray *descendingFlags = [NSArray arrayWithObjects:[NSNumber numberWithBool:NO], [NSNumber numberWithBool:YES], nil];
+	SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+
+	STAssertTrue([dataStorage sortRowsByColumns:sortColumns descending:descendingFlags columnDefinitions:columnDefinitions stringEncoding:NSUTF8StringEncoding], @"String columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 2), ([NSArray arrayWithObjects:@"2", @"4", @"1", @"3", @"5", nil]), @"Rows should be sorted by each column in turn, keeping the order of equal rows");
+}
+
+/**
+ * String collations test case.
+ */
+- (void)testSortStringCollations
+{
+	NSArray *rows = [NSArray arrayWithObjects:
+		[NSArray arrayWithObject:@"b"],
+		[NSArray arrayWithObject:@"A"],
+		[NSArray arrayWithObject:@"a"],
+		[NSArray arrayWithObject:@"B"],
+		nil];
+	NSArray *sortColumns = [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:0]];
+	SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+
+	STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, NO, [NSArray arrayWithObject:_SPStringColumnDefinition(@"utf8_general_ci")]), @"String columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 0), ([NSArray arrayWithObjects:@"A", @"a", @"b", @"B", nil]), @"A case insensitive collation should treat differing case as equal");
+
+	STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, NO, [NSArray arrayWithObject:_SPStringColumnDefinition(@"utf8_bin")]), @"String columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 0), ([NSArray arrayWithObjects:@"A", @"B", @"a", @"b", nil]), @"A binary collation should compare bytes");
+}
+
+/**
+ * Edited cells test case.
+ */
+- (void)testSortEditedCells
+{
+	NSArray *rows = [NSArray arrayWithObjects:
+		[NSArray arrayWithObject:@"1"],
+		[NSArray arrayWithObject:@"2"],
+		[NSArray arrayWithObject:@"3"],
+		nil];
+	NSArray *columnDefinitions = [NSArray arrayWithObject:_SPIntegerColumnDefinition(NO)];
+	NSArray *sortColumns = [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:0]];
+	SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+
+	[dataStorage replaceObjectInRow:0 column:0 withObject:@"5"];
+	[dataStorage addRowWithContents:[NSMutableArray arrayWithObject:@"0"]];
+
+	STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, NO, columnDefinitions), @"Integer columns should be sortable");
+	STAssertEqualObjects(_SPColumnValues(dataStorage, 0), ([NSArray arrayWithObjects:@"0", @"2", @"3", @"5", nil]), @"Edited cells and added rows should be sorted by their current values");
+}
+
+/**
+ * Large row counts test case, sorting enough rows to be merged from runs and split across
+ * threads.  The sort must produce a stable, ordered permutation of the rows.
+ */
+- (void)testSortLargeRowCounts
+{
+	NSArray *columnDefinitions = [NSArray arrayWithObjects:_SPIntegerColumnDefinition(NO), _SPIntegerColumnDefinition(YES), nil];
+	NSArray *sortColumns = [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:0]];
+	NSUInteger rowCounts[] = { 1000, 40000 };
+	NSUInteger i, j;
+
+	for (i = 0; i < sizeof(rowCounts) / sizeof(NSUInteger); i++) {
+		NSAutoreleasePool *loopPool = [[NSAutoreleasePool alloc] init];
+		NSUInteger rowCount = rowCounts[i];
+		NSMutableArray *rows = [NSMutableArray arrayWithCapacity:rowCount];
+		uint32_t seed = 12345;
+
+		for (j = 0; j < rowCount; j++) {
+			id value;
+			seed = seed * 1103515245 + 12345;
+			if ((seed >> 16) % 50 == 0) {
+				value = [NSNull null];
+			} else {
+				value = [NSString stringWithFormat:@"%ld", (long)((seed >> 16) % 2001) - 1000];
+			}
+			[rows addObject:[NSArray arrayWithObjects:value, [NSString stringWithFormat:@"%lu", (unsigned long)j], nil]];
+		}
+
+		SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+		STAssertTrue(_SPSortDataStorage(dataStorage, sortColumns, NO, columnDefinitions), @"Integer columns should be sortable");
+		STAssertEquals([dataStorage count], rowCount, @"Sorting should keep all %lu rows", (unsigned long)rowCount);
+
+		NSArray *values = _SPColumnValues(dataStorage, 0);
+		NSArray *originalIndexes = _SPColumnValues(dataStorage, 1);
+		BOOL *seen = calloc(rowCount, sizeof(BOOL));
+		BOOL ordered = YES, permutation = YES;
+
+		for (j = 0; j < rowCount; j++) {
+			NSUInteger originalIndex = (NSUInteger)[[originalIndexes objectAtIndex:j] integerValue];
+			if (originalIndex >= rowCount || seen[originalIndex]) {
+				permutation = NO;
+			} else {
+				seen[originalIndex] = YES;
+			}
+
+			if (!j) continue;
+
+			id previousValue = [values objectAtIndex:j - 1], value = [values objectAtIndex:j];
+			BOOL previousIsNull = [previousValue isKindOfClass:[NSNull class]], isNull = [value isKindOfClass:[NSNull class]];
+			NSInteger comparison;
+
+			if (previousIsNull || isNull) {
+				comparison = (NSInteger)isNull - (NSInteger)previousIsNull;
+				if (comparison > 0) ordered = NO;
+			} else {
+				comparison = [previousValue integerValue] - [value integerValue];
+				if (comparison > 0) ordered = NO;
+			}
+
+			// Equal values must keep their original order
+			if (!comparison && [[originalIndexes objectAtIndex:j - 1] integerValue] > [[originalIndexes objectAtIndex:j] integerValue]) ordered = NO;
+		}
+
+		free(seen);
+
+		STAssertTrue(permutation, @"Sorting %lu rows should present each row exactly once", (unsigned long)rowCount);
+		STAssertTrue(ordered, @"Sorting %lu rows should order the values, keeping the order of equal values", (unsigned long)rowCount);
+
+		[loopPool drain];
+	}
+}
+
+/**
+ * Unsortable columns test case.
+ */
+- (void)testSortUnsortableColumns
+{
+	NSArray *rows = [NSArray arrayWithObject:[NSArray arrayWithObject:@"a"]];
+	NSDictionary *enumColumn = [NSDictionary dictionaryWithObjectsAndKeys:@"enum", @"typegrouping", @"ENUM", @"type", nil];
+	SPDataStorage *dataStorage = _SPDataStorageWithRows(rows);
+
+	STAssertFalse(_SPSortDataStorage(dataStorage, [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:0]], NO, [NSArray arrayWithObject:enumColumn]), @"ENUM columns should be left to the server to sort");
+	STAssertFalse(_SPSortDataStorage(dataStorage, [NSArray arrayWithObject:[NSNumber numberWithUnsignedInteger:1]], NO, [NSArray arrayWithObject:enumColumn]), @"Columns beyond the row should not be sortable");
+	STAssertFalse([dataStorage hasRowIndexMap], @"A rejected sort should leave the rows in their original order");
+}
+
+@end
@@ -0,0 +1,67 @@
+//
+//  $Id$
+//
+//  SPDataStorageTestResultStore.h
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+/**
+ * @class SPDataStorageTestResultStore SPDataStorageTestResultStore.h
+ *
+ * A fully downloaded result store holding rows in memory, standing in for an
+ * SPMySQLStreamingResultStore so that SPDataStorage can be tested without a server.
+ * Cells are strings or NSNull, and are returned as raw bytes in UTF-8.
+ */
+@interface SPDataStorageTestResultStore : NSObject
+{
+	NSMutableArray *rows;
+	NSUInteger numberOfFields;
+}
+
+- (id)initWithRows:(NSArray *)theRows;
+- (void)setCellData:(id)value atRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
+
+// The result store methods used by SPDataStorage
+- (void)setDelegate:(id)theDelegate;
+- (NSUInteger)numberOfFields;
+- (unsigned long long)numberOfRows;
+- (BOOL)dataDownloaded;
+- (NSMutableArray *)rowContentsAtIndex:(NSUInteger)rowIndex;
+- (id)cellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
+- (id)cellPreviewAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex previewLength:(NSUInteger)previewLength;
+- (BOOL)cellIsNullAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex;
+- (const char *)rawCellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex length:(NSUInteger *)dataLength;
+- (void)addDummyRow;
+- (void)insertDummyRowAtIndex:(NSUInteger)anIndex;
+- (void)removeRowAtIndex:(NSUInteger)anIndex;
+- (void)removeRowsInRange:(NSRange)rangeToRemove;
+- (void)removeAllRows;
+
+@end
@@ -0,0 +1,183 @@
+//
+//  $Id$
+//
+//  SPDataStorageTestResultStore.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPDataStorageTestResultStore.h"
+
+@interface SPDataStorageTestResultStore (Private_API)
+
+- (NSMutableArray *)_dummyRow;
+
+@end
+
+@implementation SPDataStorageTestResultStore
+
+/**
+ * Initialise the store with the supplied rows, each an array of strings and NSNulls.
+ */
+- (id)initWithRows:(NSArray *)theRows
+{
+	if ((self = [super init])) {
+		rows = [[NSMutableArray alloc] initWithCapacity:[theRows count]];
+		for (NSArray *row in theRows) {
+			[rows addObject:[NSMutableArray arrayWithArray:row]];
+		}
+		numberOfFields = [theRows count] ? [[theRows objectAtIndex:0] count] : 0;
+	}
+
+	return self;
+}
+
+/**
+ * Change a cell in the store, as if the row had been reloaded with a different value.
+ */
+- (void)setCellData:(id)value atRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
+{
+	[[rows objectAtIndex:rowIndex] replaceObjectAtIndex:columnIndex withObject:value];
+}
+
+#pragma mark -
+#pragma mark Result store methods
+
+- (void)setDelegate:(id)theDelegate
+{
+}
+
+- (NSUInteger)numberOfFields
+{
+	return numberOfFields;
+}
+
+- (unsigned long long)numberOfRows
+{
+	return [rows count];
+}
+
+- (BOOL)dataDownloaded
+{
+	return YES;
+}
+
+- (NSMutableArray *)rowContentsAtIndex:(NSUInteger)rowIndex
+{
+	return [NSMutableArray arrayWithArray:[rows objectAtIndex:rowIndex]];
+}
+
+- (id)cellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
+{
+	return [[rows objectAtIndex:rowIndex] objectAtIndex:columnIndex];
+}
+
+- (id)cellPreviewAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex previewLength:(NSUInteger)previewLength
+{
+	return [self cellDataAtRow:rowIndex column:columnIndex];
+}
+
+- (BOOL)cellIsNullAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex
+{
+	return [[self cellDataAtRow:rowIndex column:columnIndex] isKindOfClass:[NSNull class]];
+}
+
+/**
+ * Returns the UTF-8 bytes of a cell, or NULL for NULL cells.  The bytes belong to the cell's
+ * string, which is held by the store, so they remain valid on any thread.
+ */
+- (const char *)rawCellDataAtRow:(NSUInteger)rowIndex column:(NSUInteger)columnIndex length:(NSUInteger *)dataLength
+{
+	id value = [self cellDataAtRow:rowIndex column:columnIndex];
+	const char *bytes;
+
+	if ([value isKindOfClass:[NSNull class]]) {
+		*dataLength = 0;
+		return NULL;
+	}
+
+	bytes = [(NSString *)value UTF8String];
+	*dataLength = strlen(bytes);
+
+	return bytes;
+}
+
+- (void)addDummyRow
+{
+	[rows addObject:[self _dummyRow]];
+}
+
+- (void)insertDummyRowAtIndex:(NSUInteger)anIndex
+{
+	[rows insertObject:[self _dummyRow] atIndex:anIndex];
+}
+
+- (void)removeRowAtIndex:(NSUInteger)anIndex
+{
+	[rows removeObjectAtIndex:anIndex];
+}
+
+- (void)removeRowsInRange:(NSRange)rangeToRemove
+{
+	[rows removeObjectsInRange:rangeToRemove];
+}
+
+- (void)removeAllRows
+{
+	[rows removeAllObjects];
+}
+
+#pragma mark -
+
+- (void)dealloc
+{
+	[rows release];
+
+	[super dealloc];
+}
+
+@end
+
+@implementation SPDataStorageTestResultStore (Private_API)
+
+/**
+ * Returns a row of NSNulls, standing in for a row added to the storage.
+ */
+- (NSMutableArray *)_dummyRow
+{
+	NSMutableArray *row = [NSMutableArray arrayWithCapacity:numberOfFields];
+	NSUInteger i;
+
+	for (i = 0; i < numberOfFields; i++) {
+		[row addObject:[NSNull null]];
+	}
+
+	return row;
+}
+
+@end
@@ -0,0 +1,182 @@
+//
+//  $Id$
+//
+//  SPDataStorageTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPDataStorageTests.h"
+#import "SPDataStorage.h"
+#import "SPDataStorageTestResultStore.h"
+
+/**
+ * Returns three rows of two columns, "a0" and "b0" through "a2" and "b2".
+ */
+static NSArray *_SPTestRows(void)
+{
+	return [NSArray arrayWithObjects:
+		[NSArray arrayWithObjects:@"a0", @"b0", nil],
+		[NSArray arrayWithObjects:@"a1", @"b1", nil],
+		[NSArray arrayWithObjects:@"a2", @"b2", nil],
+		nil];
+}
+
+@implementation SPDataStorageTests
+
+/**
+ * Edited cell overlay test case.
+ */
+- (void)testEditedCellOverlay
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:_SPTestRows()];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[dataStorage replaceObjectInRow:1 column:1 withObject:@"edited"];
+
+	STAssertEqualObjects([dataStorage cellDataAtRow:1 column:1], @"edited", @"An edited cell should return its edited value");
+	STAssertEqualObjects([dataStorage cellDataAtRow:1 column:0], @"a1", @"Other cells in an edited row should return their original values");
+	STAssertEqualObjects([dataStorage rowContentsAtIndex:1], ([NSArray arrayWithObjects:@"a1", @"edited", nil]), @"The row contents should include the edited cell");
+	STAssertEqualObjects([resultStore cellDataAtRow:1 column:1], @"b1", @"Editing a cell should not change the result store");
+
+	[dataStorage release];
+	[resultStore release];
+}
+
+/**
+ * Reverted cell test case.  Once a cell is edited back to its original value the result
+ * store's value should be returned, which is confirmed by changing the value in the store.
+ */
+- (void)testRevertedCell
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:_SPTestRows()];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[dataStorage replaceObjectInRow:0 column:0 withObject:@"edited"];
+	[dataStorage replaceObjectInRow:0 column:0 withObject:@"a0"];
+
+	[resultStore setCellData:@"reloaded" atRow:0 column:0];
+
+	STAssertEqualObjects([dataStorage cellDataAtRow:0 column:0], @"reloaded", @"A reverted cell should be read from the result store");
+	STAssertEqualObjects([dataStorage rowContentsAtIndex:0], ([NSArray arrayWithObjects:@"reloaded", @"b0", nil]), @"A reverted row should be read from the result store");
+
+	[dataStorage release];
+	[resultStore release];
+}
+
+/**
+ * Partially reverted row test case.
+ */
+- (void)testPartiallyRevertedRow
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:_SPTestRows()];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[dataStorage replaceObjectInRow:2 column:0 withObject:@"edited a"];
+	[dataStorage replaceObjectInRow:2 column:1 withObject:@"edited b"];
+	[dataStorage replaceObjectInRow:2 column:0 withObject:@"a2"];
+
+	[resultStore setCellData:@"reloaded a" atRow:2 column:0];
+	[resultStore setCellData:@"reloaded b" atRow:2 column:1];
+
+	STAssertEqualObjects([dataStorage cellDataAtRow:2 column:0], @"reloaded a", @"A reverted cell should be read from the result store");
+	STAssertEqualObjects([dataStorage cellDataAtRow:2 column:1], @"edited b", @"Reverting one cell should keep the other edits in the row");
+
+	[dataStorage release];
+	[resultStore release];
+}
+
+/**
+ * Replaced row test case.
+ */
+- (void)testReplaceRow
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:_SPTestRows()];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[dataStorage replaceRowAtIndex:1 withRowContents:[NSMutableArray arrayWithObjects:@"a1", @"edited", nil]];
+
+	[resultStore setCellData:@"reloaded" atRow:1 column:0];
+
+	STAssertEqualObjects([dataStorage cellDataAtRow:1 column:0], @"reloaded", @"Cells matching the original row should not be held as edits");
+	STAssertEqualObjects([dataStorage cellDataAtRow:1 column:1], @"edited", @"Cells differing from the original row should be held as edits");
+
+	[dataStorage release];
+	[resultStore release];
+}
+
+/**
+ * Removed row test case.
+ */
+- (void)testRemoveRow
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:_SPTestRows()];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[dataStorage replaceObjectInRow:2 column:1 withObject:@"edited"];
+	[dataStorage removeRowAtIndex:0];
+
+	STAssertEquals([dataStorage count], (NSUInteger)2, @"Removing a row should reduce the row count");
+	STAssertEquals([resultStore numberOfRows], 2ULL, @"Removing a row should remove it from the result store");
+	STAssertEqualObjects([dataStorage rowContentsAtIndex:0], ([NSArray arrayWithObjects:@"a1", @"b1", nil]), @"Later rows should move up");
+	STAssertEqualObjects([dataStorage rowContentsAtIndex:1], ([NSArray arrayWithObjects:@"a2", @"edited", nil]), @"Edits should move up with their rows");
+
+	[dataStorage release];
+	[resultStore release];
+}
+
+/**
+ * Removed row with a row index map test case.
+ */
+- (void)testRemoveMappedRow
+{
+	SPDataStorageTestResultStore *resultStore = [[SPDataStorageTestResultStore alloc] initWithRows:_SPTestRows()];
+	SPDataStorage *dataStorage = [[SPDataStorage alloc] init];
+	NSUInteger rowIndexMap[] = { 2, 0, 1 };
+
+	[dataStorage setDataStorage:(SPMySQLStreamingResultStore *)resultStore updatingExisting:NO];
+	[dataStorage setRowIndexMap:rowIndexMap count:3];
+	[dataStorage replaceObjectInRow:2 column:0 withObject:@"edited"];
+	[dataStorage removeRowAtIndex:1];
+
+	STAssertEquals([dataStorage count], (NSUInteger)2, @"Removing a mapped row should reduce the row count");
+	STAssertEqualObjects([dataStorage cellDataAtRow:0 column:0], @"a2", @"Mapped rows should be renumbered to their new underlying rows");
+	STAssertEqualObjects([dataStorage cellDataAtRow:1 column:0], @"edited", @"Edits should stay with their mapped rows");
+	STAssertEqualObjects([resultStore cellDataAtRow:0 column:0], @"a1", @"The mapped row should be removed from the result store");
+
+	[dataStorage release];
+	[resultStore release];
+}
+
+@end
@@ -0,0 +1,161 @@
+//
+//  $Id$
+//
+//  SPParallelDecompressorTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPParallelDecompressorTests.h"
+#import "SPParallelDecompressor.h"
+#import "bzlib.h"
+
+// Bytes making up the test data.  bzip2 records the bytes used in a block as a 16-bit map of
+// the 16-byte ranges used followed by a 16-bit map for each range used; with these bytes the
+// maps for the first three ranges spell out the block marker, 0x314159265359, so a false
+// block boundary is found within every block.
+static const char *SPTestBzip2ByteSet = "!#$'*-.13679;<?pqrstuvwxyz\x90\xf0";
+
+// Bit offset of the symbol map of the first block: the stream header, then the block's
+// marker, CRC, randomised flag and BWT origin pointer
+static const NSUInteger SPTestBzip2FirstSymbolMapBit = 32 + 48 + 32 + 1 + 24;
+
+/**
+ * Returns data of the supplied length made up of bytes from the supplied set, chosen by a
+ * fixed pseudo-random sequence.  No byte is repeated, so that bzip2's initial run length
+ * encoding doesn't add bytes outside the set.
+ */
+static NSData *_SPTestDataFromByteSet(const char *byteSet, NSUInteger length)
+{
+	NSMutableData *data = [NSMutableData dataWithLength:length];
+	unsigned char *bytes = [data mutableBytes];
+	NSUInteger byteSetLength = strlen(byteSet), i = 0;
+	uint32_t seed = 12345;
+	unsigned char byte;
+
+	while (i < length) {
+		seed = seed * 1103515245 + 12345;
+		byte = (unsigned char)byteSet[(seed >> 16) % byteSetLength];
+		if (i && byte == bytes[i - 1]) continue;
+		bytes[i++] = byte;
+	}
+
+	return data;
+}
+
+/**
+ * Returns the supplied data compressed as bzip2 with the smallest, 100k, block size.
+ */
+static NSData *_SPBzip2CompressedData(NSData *data)
+{
+	unsigned int compressedLength = (unsigned int)([data length] + [data length] / 100 + 600);
+	NSMutableData *compressedData = [NSMutableData dataWithLength:compressedLength];
+
+	if (BZ2_bzBuffToBuffCompress([compressedData mutableBytes], &compressedLength, (char *)[data bytes], (unsigned int)[data length], 1, 0, 0) != BZ_OK) return nil;
+	[compressedData setLength:compressedLength];
+
+	return compressedData;
+}
+
+/**
+ * Returns the supplied bzip2 data decompressed serially by reading it from a file with
+ * BZ2_bzread, as when importing a bzip2 file which can't be decompressed in parallel.
+ */
+static NSData *_SPBzip2DataReadSerially(NSData *compressedData)
+{
+	NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"SPParallelDecompressorTests.bz2"];
+	NSMutableData *data = [NSMutableData data];
+	char buffer[65536];
+	BZFILE *file;
+	int bytesRead;
+
+	if (![compressedData writeToFile:path atomically:NO]) return nil;
+	file = BZ2_bzopen([path fileSystemRepresentation], "rb");
+	if (file) {
+		while ((bytesRead = BZ2_bzread(file, buffer, sizeof(buffer))) > 0) {
+			[data appendBytes:buffer length:bytesRead];
+		}
+		BZ2_bzclose(file);
+	}
+	[[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+
+	return data;
+}
+
+/**
+ * Returns the supplied bzip2 data decompressed in parallel, or nil if the decompressor
+ * couldn't be used or failed.
+ */
+static NSData *_SPBzip2DataReadInParallel(NSData *compressedData)
+{
+	SPParallelDecompressor *decompressor = [[SPParallelDecompressor alloc] initWithBytes:[compressedData bytes] length:[compressedData length] owner:compressedData compressionFormat:SPBzip2Compression workerCount:4];
+	NSMutableData *data = [NSMutableData data];
+	char buffer[65536];
+	NSUInteger bytesRead;
+
+	if (!decompressor) return nil;
+	while ((bytesRead = [decompressor readBytes:buffer length:sizeof(buffer)])) {
+		[data appendBytes:buffer length:bytesRead];
+	}
+	if ([decompressor hasFailed]) data = nil;
+	[decompressor stop];
+	[decompressor release];
+
+	return data;
+}
+
+@implementation SPParallelDecompressorTests
+
+/**
+ * Multiple bzip2 blocks with false block boundaries test case.
+ */
+- (void)testMultipleBzip2BlocksWithFalseBoundaries
+{
+	NSData *data = _SPTestDataFromByteSet(SPTestBzip2ByteSet, 250000);
+	NSData *compressedData = _SPBzip2CompressedData(data);
+	const unsigned char *compressedBytes = [compressedData bytes];
+	unsigned long long symbolMap = 0;
+	NSUInteger i;
+
+	STAssertNotNil(compressedData, @"The test data should compress");
+
+	// Check that the first block's symbol map does spell out a block marker
+	for (i = SPTestBzip2FirstSymbolMapBit; i < SPTestBzip2FirstSymbolMapBit + 48; i++) {
+		symbolMap = (symbolMap << 1) | ((compressedBytes[i >> 3] >> (7 - (i & 7))) & 1);
+	}
+	STAssertEquals(symbolMap, 0x314159265359ULL, @"The first block's symbol map should match the block marker");
+
+	NSData *serialData = _SPBzip2DataReadSerially(compressedData);
+	NSData *parallelData = _SPBzip2DataReadInParallel(compressedData);
+
+	STAssertEqualObjects(serialData, data, @"BZ2_bzread should return the original data");
+	STAssertNotNil(parallelData, @"The decompressor should decode blocks containing false boundaries");
+	STAssertEqualObjects(parallelData, serialData, @"The decompressor should return the same data as BZ2_bzread");
+}
+
+@end
@@ -0,0 +1,139 @@
+//
+//  $Id$
+//
+//  SPSQLDumpReplayerTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+
+#import "SPSQLDumpReplayerTests.h"
+#import "SPSQLDumpReplayer.h"
+
+/**
+ * Returns the type of the supplied statement, ignoring any table name.
+ */
+static SPSQLDumpStatementType _SPStatementType(NSString *statement)
+{
+	NSString *tableName;
+
+	return [SPSQLDumpReplayer typeOfStatement:statement tableName:&tableName];
+}
+
+/**
+ * Returns the table name of the supplied statement, or nil if it isn't a single table statement.
+ */
+static NSString *_SPStatementTableName(NSString *statement)
+{
+	NSString *tableName;
+
+	if ([SPSQLDumpReplayer typeOfStatement:statement tableName:&tableName] != SPSQLDumpTableStatement) return nil;
+
+	return tableName;
+}
+
+@implementation SPSQLDumpReplayerTests
+
+/**
+ * Session and transaction statements test case.
+ */
+- (void)testSessionStatements
+{
+	STAssertTrue(_SPStatementType(@"") == SPSQLDumpEmptyStatement, @"An empty statement should be classified as empty");
+	STAssertTrue(_SPStatementType(@"-- Dump completed\n") == SPSQLDumpEmptyStatement, @"A comment should be classified as empty");
+	STAssertTrue(_SPStatementType(@"/*!40101 SET @OLD_CHARACTER_SET_CLIENT=@@CHARACTER_SET_CLIENT */") == SPSQLDumpSessionStatement, @"A versioned SET should be a session statement");
+	STAssertTrue(_SPStatementType(@"set names utf8") == SPSQLDumpSessionStatement, @"A lower case SET should be a session statement");
+	STAssertTrue(_SPStatementType(@"BEGIN") == SPSQLDumpTransactionStartStatement, @"BEGIN should start a transaction");
+	STAssertTrue(_SPStatementType(@"START TRANSACTION") == SPSQLDumpTransactionStartStatement, @"START TRANSACTION should start a transaction");
+	STAssertTrue(_SPStatementType(@"UNLOCK TABLES") == SPSQLDumpCurrentTableStatement, @"UNLOCK TABLES should follow the current table");
+	STAssertTrue(_SPStatementType(@"COMMIT") == SPSQLDumpCurrentTableStatement, @"COMMIT should follow the current table");
+}
+
+/**
+ * Table statements test case.
+ */
+- (void)testTableStatements
+{
+	STAssertEqualObjects(_SPStatementTableName(@"DROP TABLE IF EXISTS `users`"), @"users", @"DROP TABLE IF EXISTS should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"CREATE TABLE `users` (\n  `id` int(11) NOT NULL\n)"), @"users", @"CREATE TABLE should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"CREATE TEMPORARY TABLE IF NOT EXISTS users (id int)"), @"users", @"CREATE TEMPORARY TABLE should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO `users` VALUES (1),(2)"), @"users", @"INSERT ... VALUES should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT IGNORE INTO users (`id`, `name`) VALUES (1, 'a')"), @"users", @"INSERT with a column list should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"REPLACE INTO users SET id = 1"), @"users", @"REPLACE ... SET should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"LOCK TABLES `users` WRITE"), @"users", @"LOCK TABLES on one table should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"/*!40000 ALTER TABLE `users` DISABLE KEYS */"), @"users", @"A versioned ALTER TABLE should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"TRUNCATE TABLE users"), @"users", @"TRUNCATE TABLE should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"TRUNCATE users"), @"users", @"TRUNCATE should be a table statement");
+	STAssertEqualObjects(_SPStatementTableName(@"DROP VIEW IF EXISTS `user_names`"), @"user_names", @"DROP VIEW should be a table statement for the view's placeholder table");
+}
+
+/**
+ * Table grouping test case.  Statements for the same table must share a table name however
+ * the table was named.
+ */
+- (void)testTableGrouping
+{
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO Users VALUES (1)"), @"users", @"Unquoted names should be lower cased");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO `USERS` VALUES (1)"), @"users", @"Backtick quoted names should be unquoted and lower cased");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO \"Users\" VALUES (1)"), @"users", @"Double quoted names should be unquoted and lower cased");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO `shop`.`Users` VALUES (1)"), @"shop.users", @"Qualified names should keep their database");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO shop.`users` VALUES (1)"), @"shop.users", @"Partly quoted qualified names should match fully quoted names");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO `odd``name` VALUES (1)"), @"odd`name", @"Doubled quotes should stand for a single quote");
+	STAssertEqualObjects(_SPStatementTableName(@"INSERT INTO `a.b` VALUES (1)"), @"a.b", @"Quoted dots should be kept within the name");
+	STAssertEqualObjects(_SPStatementTableName(@"/* comment */ INSERT /* comment */ INTO -- comment\n users VALUES (1)"), @"users", @"Comments should be skipped");
+}
+
+/**
+ * Deferred statements test case.
+ */
+- (void)testDeferredStatements
+{
+	STAssertTrue(_SPStatementType(@"/*!50001 CREATE ALGORITHM=UNDEFINED */ /*!50013 DEFINER=`root`@`localhost` SQL SECURITY DEFINER */ /*!50001 VIEW `v` AS select 1 */") == SPSQLDumpDeferredStatement, @"CREATE VIEW should be deferred");
+	STAssertTrue(_SPStatementType(@"CREATE PROCEDURE p() BEGIN SELECT 1; END") == SPSQLDumpDeferredStatement, @"CREATE PROCEDURE should be deferred");
+	STAssertTrue(_SPStatementType(@"CREATE DEFINER=`root`@`localhost` TRIGGER t BEFORE INSERT ON users FOR EACH ROW SET @a = 1") == SPSQLDumpDeferredStatement, @"CREATE TRIGGER should be deferred");
+	STAssertTrue(_SPStatementType(@"DROP FUNCTION IF EXISTS f") == SPSQLDumpDeferredStatement, @"DROP FUNCTION should be deferred");
+}
+
+/**
+ * Barrier statements test case.
+ */
+- (void)testBarrierStatements
+{
+	STAssertTrue(_SPStatementType(@"USE `shop`") == SPSQLDumpBarrierStatement, @"USE should be a barrier");
+	STAssertTrue(_SPStatementType(@"CREATE DATABASE shop") == SPSQLDumpBarrierStatement, @"CREATE DATABASE should be a barrier");
+	STAssertTrue(_SPStatementType(@"DROP TABLE IF EXISTS a, b") == SPSQLDumpBarrierStatement, @"Dropping several tables should be a barrier");
+	STAssertTrue(_SPStatementType(@"LOCK TABLES a WRITE, b WRITE") == SPSQLDumpBarrierStatement, @"Locking several tables should be a barrier");
+	STAssertTrue(_SPStatementType(@"CREATE TABLE a LIKE b") == SPSQLDumpBarrierStatement, @"CREATE TABLE ... LIKE should be a barrier");
+	STAssertTrue(_SPStatementType(@"CREATE TABLE a AS SELECT * FROM b") == SPSQLDumpBarrierStatement, @"CREATE TABLE ... AS should be a barrier");
+	STAssertTrue(_SPStatementType(@"INSERT INTO a SELECT * FROM b") == SPSQLDumpBarrierStatement, @"INSERT ... SELECT should be a barrier");
+	STAssertTrue(_SPStatementType(@"INSERT INTO a (x) SELECT x FROM b") == SPSQLDumpBarrierStatement, @"INSERT ... SELECT with a column list should be a barrier");
+	STAssertTrue(_SPStatementType(@"START SLAVE") == SPSQLDumpBarrierStatement, @"Other START statements should be barriers");
+	STAssertTrue(_SPStatementType(@"(SELECT 1)") == SPSQLDumpBarrierStatement, @"Statements not starting with a keyword should be barriers");
+}
+
+@end
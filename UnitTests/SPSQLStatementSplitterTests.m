@@ -0,0 +1,172 @@
+//
+//  $Id$
+//
+//  SPSQLStatementSplitterTests.m
+//  sequel-pro
+//
+//  Created by the Sequel Pro team on October 19, 2026.
+//  Copyright (c) 2026 Sequel Pro Team. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation
+//  files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use,
+//  copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following
+//  conditions:
+//
+//  The above copyright notice and this permission notice shall be
+//  included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+//
+//  More info at <http://code.google.com/p/sequel-pro/>
+
+
+#import "SPSQLStatementSplitterTests.h"
+#import "SPSQLStatementSplitter.h"
+
+/**
+ * Split the supplied SQL in one go, returning all the statements.
+ */
+static NSArray *_SPSplitStatements(NSString *sql, BOOL supportDelimiters)
+{
+	SPSQLStatementSplitter *splitter = [[SPSQLStatementSplitter alloc] init];
+	NSMutableArray *statements = [NSMutableArray array];
+	NSString *statement;
+
+	[splitter setDelimiterSupport:supportDelimiters];
+	[splitter appendString:sql];
+
+	while ((statement = [splitter nextStatementWithDataComplete:YES]))
+	{
+		[statements addObject:statement];
+	}
+
+	[splitter release];
+
+	return statements;
+}
+
+@implementation SPSQLStatementSplitterTests
+
+/**
+ * DELIMITER commands test case.
+ */
+- (void)testDelimiterCommands
+{
+	NSArray *expectedArray = [NSArray arrayWithObjects:@"SELECT 1", @"CREATE PROCEDURE p() BEGIN SELECT 2; END", @"SELECT 3", nil];
+	NSArray *resultArray = _SPSplitStatements(@"SELECT 1;\nDELIMITER ;;\nCREATE PROCEDURE p() BEGIN SELECT 2; END;;\nDELIMITER ;\nSELECT 3;\n", YES);
+
+	STAssertEqualObjects(resultArray, expectedArray, @"The statements should look like: %@, but actually look like: %@", expectedArray, resultArray);
+
+	expectedArray = [NSArray arrayWithObjects:@"SELECT 1", @"DELIMITER $$\nSELECT 2$$\nSELECT 3", nil];
+	resultArray = _SPSplitStatements(@"SELECT 1;\nDELIMITER $$\nSELECT 2$$\nSELECT 3;\n", NO);
+
+	STAssertEqualObjects(resultArray, expectedArray, @"DELIMITER commands should only be recognised when supported; the statements should look like: %@, but actually look like: %@", expectedArray, resultArray);
+}
+
+/**
+ * MySQL-version specific comments test case.
+ */
+- (void)testVersionSpecificComments
+{
+	NSArray *expectedArray = [NSArray arrayWithObjects:
+		@"/*!40101 SET NAMES utf8 */",
+		@"/*!50003 CREATE TRIGGER t BEFORE INSERT ON x FOR EACH ROW SET @a = 1; */",
+		@"SELECT 1 /* ; */",
+		nil];
+	NSArray *resultArray = _SPSplitStatements(@"/*!40101 SET NAMES utf8 */;\n/*!50003 CREATE TRIGGER t BEFORE INSERT ON x FOR EACH ROW SET @a = 1; */;\nSELECT 1 /* ; */;\n", NO);
+
+	STAssertEqualObjects(resultArray, expectedArray, @"The statements should look like: %@, but actually look like: %@", expectedArray, resultArray);
+}
+
+/**
+ * Line comments test case.
+ */
+- (void)testLineComments
+{
+	NSArray *expectedArray = [NSArray arrayWithObjects:
+		@"-- comment; here\nSELECT 1",
+		@"# another; comment\nSELECT 2 -- trailing;\n",
+		@"SELECT 3--1",
+		nil];
+	NSArray *resultArray = _SPSplitStatements(@"-- comment; here\nSELECT 1;\n# another; comment\nSELECT 2 -- trailing;\n;\nSELECT 3--1;\n", NO);
+
+	STAssertEqualObjects(resultArray, expectedArray, @"The statements should look like: %@, but actually look like: %@", expectedArray, resultArray);
+}
+
+/**
+ * Escaped and doubled quotes test case.
+ */
+- (void)testQuotedStrings
+{
+	NSArray *expectedArray = [NSArray arrayWithObjects:
+		@"INSERT INTO t VALUES ('a;\\'b', \"c;\"\"d\", `e;``f`, 'g\\\\')",
+		@"SELECT 2",
+		nil];
+	NSArray *resultArray = _SPSplitStatements(@"INSERT INTO t VALUES ('a;\\'b', \"c;\"\"d\", `e;``f`, 'g\\\\');SELECT 2;", NO);
+
+	STAssertEqualObjects(resultArray, expectedArray, @"The statements should look like: %@, but actually look like: %@", expectedArray, resultArray);
+}
+
+/**
+ * Statements split across appended chunks test case.
+ */
+- (void)testAppendedChunks
+{
+	SPSQLStatementSplitter *splitter = [[SPSQLStatementSplitter alloc] init];
+	NSString *statement;
+
+	[splitter appendString:@"SELECT 'a;"];
+
+	STAssertNil([splitter nextStatementWithDataComplete:NO], @"An incomplete statement should not be returned");
+
+	[splitter appendString:@"b'; SELECT 2 -"];
+
+	statement = [splitter nextStatementWithDataComplete:NO];
+
+	STAssertEqualObjects(statement, @"SELECT 'a;b'", @"The statement should be 'SELECT 'a;b'', but is actually: %@", statement);
+	STAssertNil([splitter nextStatementWithDataComplete:NO], @"An incomplete statement should not be returned");
+
+	[splitter appendString:@"- c;\n;SELECT \"x\""];
+
+	statement = [splitter nextStatementWithDataComplete:NO];
+
+	STAssertEqualObjects(statement, @"SELECT 2 -- c;\n", @"The statement should be 'SELECT 2 -- c;\n', but is actually: %@", statement);
+	STAssertNil([splitter nextStatementWithDataComplete:NO], @"A statement ending in a possibly doubled quote should not be returned");
+
+	[splitter appendString:@"\"y\";"];
+
+	statement = [splitter nextStatementWithDataComplete:NO];
+
+	STAssertEqualObjects(statement, @"SELECT \"x\"\"y\"", @"The statement should be 'SELECT \"x\"\"y\"', but is actually: %@", statement);
+	STAssertNil([splitter nextStatementWithDataComplete:YES], @"No further statements should be returned");
+
+	[splitter release];
+
+	splitter = [[SPSQLStatementSplitter alloc] init];
+	[splitter setDelimiterSupport:YES];
+	[splitter appendString:@"DELIMITER $"];
+
+	STAssertNil([splitter nextStatementWithDataComplete:NO], @"An incomplete DELIMITER command should not be consumed");
+
+	[splitter appendString:@"$\nSELECT 1$$\n"];
+
+	statement = [splitter nextStatementWithDataComplete:NO];
+
+	STAssertEqualObjects(statement, @"SELECT 1", @"The statement should be 'SELECT 1', but is actually: %@", statement);
+	STAssertEqualObjects([splitter delimiter], @"$$", @"The delimiter should be '$$', but is actually: %@", [splitter delimiter]);
+
+	[splitter release];
+}
+
+@end